@@ -2,6 +2,25 @@
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <ctime>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <thread>
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LEDGER_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 // Transaction class to store transaction history
 class Transaction {
@@ -15,8 +34,8 @@ public:
     // Constructor
     Transaction(std::string transType, double transAmount, 
                 std::string transDescription, std::string transDate)
-        : type(transType), amount(transAmount), 
-          description(transDescription), date(transDate) {}
+        : type(std::move(transType)), amount(transAmount), 
+          description(std::move(transDescription)), date(std::move(transDate)) {}
     
     // Getter methods
     std::string getType() const { return type; }
@@ -33,6 +52,248 @@ public:
     }
 };
 
+// Transaction kinds as a one-byte tag instead of a string per record
+enum class TransactionType : uint8_t { Deposit, Withdrawal, Transfer, Interest };
+
+const char* transactionTypeName(TransactionType type) {
+    switch (type) {
+        case TransactionType::Deposit: return "deposit";
+        case TransactionType::Withdrawal: return "withdrawal";
+        case TransactionType::Transfer: return "transfer";
+        case TransactionType::Interest: return "interest";
+    }
+    return "unknown";
+}
+
+// Amounts are stored as whole cents so ledger sums are exact
+int64_t toCents(double amount) {
+    return static_cast<int64_t>(std::llround(amount * 100.0));
+}
+
+double fromCents(int64_t cents) {
+    return static_cast<double>(cents) / 100.0;
+}
+
+// Binary ledger record: 24 bytes, trivially copyable, so whole segments
+// can be written to and mapped back from a file as-is
+struct TransactionRecord {
+    int64_t amountCents;
+    int64_t timestamp;       // seconds since the Unix epoch
+    uint32_t description;    // index into the ledger's description pool
+    TransactionType type;
+};
+
+// Append-only transaction ledger.
+//
+// Records live in fixed-size segments that are allocated as the ledger
+// grows, so appending never moves or copies earlier history. Descriptions
+// are interned: each distinct text is stored once and records hold its
+// index. Optionally the oldest segments spill to a scratch file once more
+// than a set number are resident; they are read back through a read-only
+// memory mapping of that file. History is read a page at a time.
+class TransactionLedger {
+public:
+    static constexpr size_t segmentRecords = 4096;  // 96 KiB, a whole number of pages
+    static constexpr size_t segmentBytes = segmentRecords * sizeof(TransactionRecord);
+    
+private:
+    std::vector<std::unique_ptr<TransactionRecord[]>> segments;  // null once spilled
+    size_t recordCount = 0;
+    
+    std::vector<std::string> descriptions;
+    std::unordered_map<std::string, uint32_t> descriptionIndex;
+    
+    // Spill state: segments [0, spilledSegments) are in the spill file
+    size_t maxResidentSegments = std::numeric_limits<size_t>::max();
+    size_t spilledSegments = 0;
+    int spillFd = -1;
+    mutable const TransactionRecord* spillMap = nullptr;
+    mutable size_t spillMapBytes = 0;
+    
+    void unmapSpill() const {
+#ifdef LEDGER_HAS_MMAP
+        if (spillMap) {
+            munmap(const_cast<TransactionRecord*>(spillMap), spillMapBytes);
+        }
+#endif
+        spillMap = nullptr;
+        spillMapBytes = 0;
+    }
+    
+    // Writes the oldest resident full segments to the spill file
+    void spillColdSegments() {
+#ifdef LEDGER_HAS_MMAP
+        size_t resident = segments.size() - spilledSegments;
+        while (resident > maxResidentSegments && spilledSegments + 1 < segments.size()) {
+            const char* bytes = reinterpret_cast<const char*>(segments[spilledSegments].get());
+            size_t written = 0;
+            while (written < segmentBytes) {
+                ssize_t n = pwrite(spillFd, bytes + written, segmentBytes - written,
+                                   static_cast<off_t>(spilledSegments * segmentBytes + written));
+                if (n <= 0) {
+                    throw std::runtime_error("ledger spill write failed");
+                }
+                written += static_cast<size_t>(n);
+            }
+            segments[spilledSegments].reset();
+            ++spilledSegments;
+            --resident;
+        }
+#endif
+    }
+    
+    const TransactionRecord* segmentData(size_t segment) const {
+        if (segments[segment]) {
+            return segments[segment].get();
+        }
+#ifdef LEDGER_HAS_MMAP
+        // Map everything spilled so far; remap after further spills
+        size_t needed = spilledSegments * segmentBytes;
+        if (spillMapBytes < needed) {
+            unmapSpill();
+            void* mapped = mmap(nullptr, needed, PROT_READ, MAP_SHARED, spillFd, 0);
+            if (mapped == MAP_FAILED) {
+                throw std::runtime_error("ledger spill mapping failed");
+            }
+            spillMap = static_cast<const TransactionRecord*>(mapped);
+            spillMapBytes = needed;
+        }
+        return spillMap + segment * segmentRecords;
+#else
+        throw std::logic_error("ledger segment spilled without mmap support");
+#endif
+    }
+    
+public:
+    TransactionLedger() = default;
+    
+    ~TransactionLedger() {
+        unmapSpill();
+#ifdef LEDGER_HAS_MMAP
+        if (spillFd >= 0) {
+            close(spillFd);
+        }
+#endif
+    }
+    
+    TransactionLedger(const TransactionLedger&) = delete;
+    TransactionLedger& operator=(const TransactionLedger&) = delete;
+    
+    TransactionLedger(TransactionLedger&& other) noexcept { *this = std::move(other); }
+    
+    TransactionLedger& operator=(TransactionLedger&& other) noexcept {
+        if (this != &other) {
+            unmapSpill();
+#ifdef LEDGER_HAS_MMAP
+            if (spillFd >= 0) {
+                close(spillFd);
+            }
+#endif
+            segments = std::move(other.segments);
+            recordCount = std::exchange(other.recordCount, 0);
+            descriptions = std::move(other.descriptions);
+            descriptionIndex = std::move(other.descriptionIndex);
+            maxResidentSegments = other.maxResidentSegments;
+            spilledSegments = std::exchange(other.spilledSegments, 0);
+            spillFd = std::exchange(other.spillFd, -1);
+            spillMap = std::exchange(other.spillMap, nullptr);
+            spillMapBytes = std::exchange(other.spillMapBytes, 0);
+        }
+        return *this;
+    }
+    
+    // Keep at most maxResident segments in memory, spilling older ones to a
+    // scratch file in directory. Returns false where unsupported
+    bool enableSpill(const std::string& directory, size_t maxResident) {
+#ifdef LEDGER_HAS_MMAP
+        if (spillFd < 0) {
+            std::string path = directory + "/ledger-XXXXXX";
+            spillFd = mkstemp(&path[0]);
+            if (spillFd < 0) {
+                return false;
+            }
+            unlink(path.c_str());  // removed once the descriptor closes
+        }
+        maxResidentSegments = std::max<size_t>(maxResident, 1);
+        spillColdSegments();
+        return true;
+#else
+        (void)directory;
+        (void)maxResident;
+        return false;
+#endif
+    }
+    
+    uint32_t intern(const std::string& description) {
+        auto it = descriptionIndex.find(description);
+        if (it != descriptionIndex.end()) {
+            return it->second;
+        }
+        uint32_t index = static_cast<uint32_t>(descriptions.size());
+        descriptions.push_back(description);
+        descriptionIndex.emplace(description, index);
+        return index;
+    }
+    
+    void append(TransactionType type, int64_t amountCents, const std::string& description, int64_t timestamp) {
+        if (recordCount == segments.size() * segmentRecords) {
+            segments.push_back(std::make_unique<TransactionRecord[]>(segmentRecords));
+            spillColdSegments();
+        }
+        TransactionRecord& record = segments.back()[recordCount % segmentRecords];
+        record = TransactionRecord{amountCents, timestamp, intern(description), type};
+        ++recordCount;
+    }
+    
+    size_t size() const { return recordCount; }
+    size_t residentSegments() const { return segments.size() - spilledSegments; }
+    size_t spilledSegmentCount() const { return spilledSegments; }
+    size_t distinctDescriptions() const { return descriptions.size(); }
+    const std::string& description(const TransactionRecord& record) const { return descriptions[record.description]; }
+    
+    const TransactionRecord& operator[](size_t index) const {
+        return segmentData(index / segmentRecords)[index % segmentRecords];
+    }
+    
+    // Calls visit(record) for records [first, first + count), a segment at a time
+    template<typename Visitor>
+    void forEach(size_t first, size_t count, Visitor&& visit) const {
+        size_t last = std::min(first + count, recordCount);
+        while (first < last) {
+            size_t segment = first / segmentRecords;
+            const TransactionRecord* data = segmentData(segment);
+            size_t end = std::min(last, (segment + 1) * segmentRecords);
+            for (size_t i = first; i < end; ++i) {
+                visit(data[i % segmentRecords]);
+            }
+            first = end;
+        }
+    }
+};
+
+std::string formatDate(int64_t timestamp) {
+    std::time_t time = static_cast<std::time_t>(timestamp);
+    std::tm parts{};
+#if defined(_WIN32)
+    gmtime_s(&parts, &time);
+#else
+    gmtime_r(&time, &parts);
+#endif
+    char text[16];
+    std::strftime(text, sizeof(text), "%Y-%m-%d", &parts);
+    return text;
+}
+
+// Interest rate by account type
+double interestRateFor(const std::string& accountType) {
+    if (accountType == "savings") {
+        return 0.025;  // 2.5% for savings
+    } else if (accountType == "checking") {
+        return 0.001;  // 0.1% for checking
+    }
+    return 0.0;        // No interest for other types
+}
+
 // BankAccount class demonstrating encapsulation
 class BankAccount {
 private:
@@ -44,50 +305,38 @@ private:
     double interestRate;      // Annual interest rate (for savings accounts)
     std::string pin;          // PIN for account access
     bool locked;              // Account lock status
-    std::vector<Transaction> transactionHistory;
+    TransactionLedger ledger;
     
     // Private helper methods
-    bool validatePin(std::string enteredPin) const {
+    bool validatePin(const std::string& enteredPin) const {
         return enteredPin == pin;
     }
     
-    void recordTransaction(std::string type, double amount, std::string description) {
-        // In a real system, we would get the current date
-        std::string currentDate = "2025-06-27";  // Hardcoded for simplicity
-        
-        Transaction transaction(type, amount, description, currentDate);
-        transactionHistory.push_back(transaction);
+    void recordTransaction(TransactionType type, double amount, const std::string& description) {
+        ledger.append(type, toCents(amount), description, static_cast<int64_t>(std::time(nullptr)));
     }
     
 public:
     // Constructor
     BankAccount(std::string number, std::string holderName, 
                 std::string type, std::string initialPin)
-        : accountNumber(number), accountHolderName(holderName), 
-          accountType(type), pin(initialPin), locked(false) {
+        : accountNumber(std::move(number)), accountHolderName(std::move(holderName)), 
+          accountType(std::move(type)), pin(std::move(initialPin)), locked(false) {
         
         balance = 0.0;
-        
-        // Set interest rate based on account type
-        if (accountType == "savings") {
-            interestRate = 0.025;  // 2.5% for savings
-        } else if (accountType == "checking") {
-            interestRate = 0.001;  // 0.1% for checking
-        } else {
-            interestRate = 0.0;    // No interest for other types
-        }
+        interestRate = interestRateFor(accountType);
     }
     
     // Getter methods
-    std::string getAccountNumber() const {
+    const std::string& getAccountNumber() const {
         return accountNumber;
     }
     
-    std::string getAccountHolderName() const {
+    const std::string& getAccountHolderName() const {
         return accountHolderName;
     }
     
-    std::string getAccountType() const {
+    const std::string& getAccountType() const {
         return accountType;
     }
     
@@ -100,7 +349,7 @@ public:
     }
     
     // Balance can only be accessed after PIN verification
-    double getBalance(std::string enteredPin) const {
+    double getBalance(const std::string& enteredPin) const {
         if (validatePin(enteredPin)) {
             return balance;
         } else {
@@ -110,7 +359,7 @@ public:
     }
     
     // Setter methods
-    void setAccountHolderName(std::string newName, std::string enteredPin) {
+    void setAccountHolderName(const std::string& newName, const std::string& enteredPin) {
         if (validatePin(enteredPin)) {
             accountHolderName = newName;
             std::cout << "Account holder name updated successfully." << std::endl;
@@ -119,7 +368,7 @@ public:
         }
     }
     
-    void changePin(std::string currentPin, std::string newPin) {
+    void changePin(const std::string& currentPin, const std::string& newPin) {
         if (validatePin(currentPin)) {
             pin = newPin;
             std::cout << "PIN changed successfully." << std::endl;
@@ -129,7 +378,7 @@ public:
     }
     
     // Account operations
-    void deposit(double amount, std::string description = "Deposit") {
+    void deposit(double amount, const std::string& description = "Deposit") {
         if (locked) {
             std::cout << "Error: Account is locked. Cannot make deposit." << std::endl;
             return;
@@ -141,11 +390,11 @@ public:
         }
         
         balance += amount;
-        recordTransaction("deposit", amount, description);
+        recordTransaction(TransactionType::Deposit, amount, description);
         std::cout << "Deposit of $" << amount << " successful. New balance: $" << balance << std::endl;
     }
     
-    bool withdraw(double amount, std::string enteredPin, std::string description = "Withdrawal") {
+    bool withdraw(double amount, const std::string& enteredPin, const std::string& description = "Withdrawal") {
         if (locked) {
             std::cout << "Error: Account is locked. Cannot make withdrawal." << std::endl;
             return false;
@@ -167,13 +416,13 @@ public:
         }
         
         balance -= amount;
-        recordTransaction("withdrawal", -amount, description);
+        recordTransaction(TransactionType::Withdrawal, -amount, description);
         std::cout << "Withdrawal of $" << amount << " successful. New balance: $" << balance << std::endl;
         return true;
     }
     
-    bool transfer(BankAccount& recipient, double amount, std::string enteredPin, 
-                  std::string description = "Transfer") {
+    bool transfer(BankAccount& recipient, double amount, const std::string& enteredPin, 
+                  const std::string& description = "Transfer") {
         if (locked) {
             std::cout << "Error: Account is locked. Cannot make transfer." << std::endl;
             return false;
@@ -200,7 +449,7 @@ public:
         }
         
         balance -= amount;
-        recordTransaction("transfer", -amount, 
+        recordTransaction(TransactionType::Transfer, -amount, 
                           description + " to " + recipient.getAccountNumber());
         
         recipient.deposit(amount, "Transfer from " + accountNumber);
@@ -219,12 +468,12 @@ public:
         
         double interestAmount = balance * interestRate;
         balance += interestAmount;
-        recordTransaction("interest", interestAmount, "Interest payment");
+        recordTransaction(TransactionType::Interest, interestAmount, "Interest payment");
         std::cout << "Interest of $" << std::fixed << std::setprecision(2) << interestAmount 
                   << " applied. New balance: $" << balance << std::endl;
     }
     
-    void lockAccount(std::string enteredPin) {
+    void lockAccount(const std::string& enteredPin) {
         if (validatePin(enteredPin)) {
             locked = true;
             std::cout << "Account locked successfully." << std::endl;
@@ -233,7 +482,7 @@ public:
         }
     }
     
-    void unlockAccount(std::string enteredPin) {
+    void unlockAccount(const std::string& enteredPin) {
         if (validatePin(enteredPin)) {
             locked = false;
             std::cout << "Account unlocked successfully." << std::endl;
@@ -242,20 +491,46 @@ public:
         }
     }
     
-    void displayTransactionHistory(std::string enteredPin) const {
+    // Keep only the most recent transactions in memory (see TransactionLedger)
+    bool enableHistorySpill(const std::string& directory, size_t residentSegments) {
+        return ledger.enableSpill(directory, residentSegments);
+    }
+    
+    size_t getTransactionCount() const {
+        return ledger.size();
+    }
+    
+    // One page of history, oldest first; page 0 is the first pageSize entries
+    std::vector<Transaction> getTransactions(const std::string& enteredPin, size_t page, size_t pageSize) const {
+        std::vector<Transaction> transactions;
+        if (!validatePin(enteredPin)) {
+            std::cout << "Error: Invalid PIN. Cannot read transaction history." << std::endl;
+            return transactions;
+        }
+        
+        ledger.forEach(page * pageSize, pageSize, [&](const TransactionRecord& record) {
+            transactions.emplace_back(transactionTypeName(record.type), fromCents(record.amountCents),
+                                      ledger.description(record), formatDate(record.timestamp));
+        });
+        return transactions;
+    }
+    
+    void displayTransactionHistory(const std::string& enteredPin, size_t page = 0, size_t pageSize = 20) const {
         if (!validatePin(enteredPin)) {
             std::cout << "Error: Invalid PIN. Cannot display transaction history." << std::endl;
             return;
         }
         
-        std::cout << "\n===== Transaction History for Account " << accountNumber << " =====" << std::endl;
+        size_t pages = std::max<size_t>(1, (ledger.size() + pageSize - 1) / pageSize);
+        std::cout << "\n===== Transaction History for Account " << accountNumber 
+                  << " (page " << (page + 1) << " of " << pages << ") =====" << std::endl;
         std::cout << std::left << std::setw(12) << "Date" 
                   << std::setw(12) << "Type"
                   << std::right << std::setw(10) << "Amount"
                   << "  " << std::left << "Description" << std::endl;
         std::cout << std::string(60, '-') << std::endl;
         
-        for (const auto& transaction : transactionHistory) {
+        for (const auto& transaction : getTransactions(enteredPin, page, pageSize)) {
             transaction.display();
         }
         
@@ -263,7 +538,7 @@ public:
         std::cout << "Current Balance: $" << std::fixed << std::setprecision(2) << balance << std::endl;
     }
     
-    void displayAccountInfo(std::string enteredPin) const {
+    void displayAccountInfo(const std::string& enteredPin) const {
         if (!validatePin(enteredPin)) {
             std::cout << "Error: Invalid PIN. Cannot display account information." << std::endl;
             return;
@@ -276,7 +551,200 @@ public:
         std::cout << "Interest Rate: " << (interestRate * 100) << "%" << std::endl;
         std::cout << "Balance: $" << std::fixed << std::setprecision(2) << balance << std::endl;
         std::cout << "Status: " << (locked ? "Locked" : "Active") << std::endl;
-        std::cout << "Transaction Count: " << transactionHistory.size() << std::endl;
+        std::cout << "Transaction Count: " << ledger.size() << std::endl;
+    }
+};
+
+// Columnar store of many accounts for batch jobs (end-of-day interest,
+// bulk postings).
+//
+// Each field is its own array, so a pass over every balance touches only
+// balances, rates and lock flags, in order. Work is split into chunks of
+// chunkAccounts consecutive accounts; chunks can be processed on several
+// threads, and each produces one aggregated entry in the book's ledger
+// rather than one entry per account.
+// Batches are all-or-nothing: post() validates every posting before
+// changing any balance.
+class AccountBook {
+public:
+    static constexpr size_t chunkAccounts = 4096;
+    
+    // One deposit (positive) or withdrawal (negative) for one account
+    struct Posting {
+        uint32_t account;
+        int64_t amountCents;
+    };
+    
+    struct BatchResult {
+        bool applied = false;
+        size_t rejectedPosting = 0;  // index of the first invalid posting
+        std::string reason;
+        int64_t netCents = 0;
+    };
+    
+private:
+    std::vector<std::string> numbers;
+    std::vector<std::string> holders;
+    std::vector<int64_t> balances;  // cents
+    std::vector<double> rates;
+    std::vector<uint8_t> locked;
+    std::unordered_map<std::string, uint32_t> index;
+    TransactionLedger ledger;
+    
+    std::string chunkLabel(size_t chunk) const {
+        size_t first = chunk * chunkAccounts;
+        size_t last = std::min(first + chunkAccounts, balances.size()) - 1;
+        return "accounts " + std::to_string(first) + "-" + std::to_string(last);
+    }
+    
+    // Adds interest to every unlocked account in the chunk; returns the total
+    int64_t applyInterestToChunk(size_t chunk) {
+        size_t first = chunk * chunkAccounts;
+        size_t last = std::min(first + chunkAccounts, balances.size());
+        int64_t* balance = balances.data();
+        const double* rate = rates.data();
+        const uint8_t* isLocked = locked.data();
+        int64_t total = 0;
+        // Branch-free body over contiguous arrays. Balances never go
+        // negative, so adding 0.5 before truncating rounds half up
+        for (size_t i = first; i < last; ++i) {
+            int64_t interest = static_cast<int64_t>(static_cast<double>(balance[i]) * rate[i] + 0.5);
+            interest *= 1 - isLocked[i];
+            balance[i] += interest;
+            total += interest;
+        }
+        return total;
+    }
+    
+public:
+    uint32_t addAccount(const std::string& number, const std::string& holder,
+                        const std::string& type, double openingBalance = 0.0) {
+        auto found = index.find(number);
+        if (found != index.end()) {
+            return found->second;
+        }
+        uint32_t account = static_cast<uint32_t>(balances.size());
+        numbers.push_back(number);
+        holders.push_back(holder);
+        balances.push_back(std::max<int64_t>(0, toCents(openingBalance)));
+        rates.push_back(interestRateFor(type));
+        locked.push_back(0);
+        index.emplace(number, account);
+        return account;
+    }
+    
+    void reserve(size_t accounts) {
+        numbers.reserve(accounts);
+        holders.reserve(accounts);
+        balances.reserve(accounts);
+        rates.reserve(accounts);
+        locked.reserve(accounts);
+        index.reserve(accounts);
+    }
+    
+    size_t size() const { return balances.size(); }
+    
+    // Account index for a number, or size() if absent
+    uint32_t find(const std::string& number) const {
+        auto found = index.find(number);
+        return found != index.end() ? found->second : static_cast<uint32_t>(size());
+    }
+    
+    const std::string& accountNumber(uint32_t account) const { return numbers[account]; }
+    const std::string& holderName(uint32_t account) const { return holders[account]; }
+    double balance(uint32_t account) const { return fromCents(balances[account]); }
+    bool isLocked(uint32_t account) const { return locked[account] != 0; }
+    void setLocked(uint32_t account, bool value) { locked[account] = value ? 1 : 0; }
+    
+    double totalBalance() const {
+        int64_t total = 0;
+        for (int64_t cents : balances) {
+            total += cents;
+        }
+        return fromCents(total);
+    }
+    
+    const TransactionLedger& getLedger() const { return ledger; }
+    
+    // Applies one period's interest to every unlocked account, using up to
+    // threads threads (chunks never share an account, so no locking).
+    // Records one ledger entry per chunk and returns the total paid
+    double applyInterest(unsigned threads = 1) {
+        size_t chunks = (balances.size() + chunkAccounts - 1) / chunkAccounts;
+        std::vector<int64_t> chunkTotals(chunks, 0);
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, chunks)));
+        
+        auto work = [&](unsigned worker) {
+            for (size_t chunk = worker; chunk < chunks; chunk += threads) {
+                chunkTotals[chunk] = applyInterestToChunk(chunk);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned worker = 1; worker < threads; ++worker) {
+            workers.emplace_back(work, worker);
+        }
+        work(0);
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        
+        int64_t now = static_cast<int64_t>(std::time(nullptr));
+        int64_t total = 0;
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            ledger.append(TransactionType::Interest, chunkTotals[chunk], "Interest, " + chunkLabel(chunk), now);
+            total += chunkTotals[chunk];
+        }
+        return fromCents(total);
+    }
+    
+    // Applies a batch of postings in order, or none of them if any posting
+    // names an unknown or locked account, is zero, or would overdraw.
+    // Records one net ledger entry per chunk the batch touched
+    BatchResult post(const std::vector<Posting>& batch, const std::string& description) {
+        BatchResult result;
+        
+        // Validate against running balances of the accounts the batch touches
+        std::unordered_map<uint32_t, int64_t> running;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const Posting& posting = batch[i];
+            const char* problem = nullptr;
+            if (posting.account >= balances.size()) {
+                problem = "unknown account";
+            } else if (locked[posting.account]) {
+                problem = "account is locked";
+            } else if (posting.amountCents == 0) {
+                problem = "zero amount";
+            } else {
+                auto [entry, inserted] = running.try_emplace(posting.account, balances[posting.account]);
+                entry->second += posting.amountCents;
+                if (entry->second < 0) {
+                    problem = "insufficient funds";
+                }
+            }
+            if (problem) {
+                result.rejectedPosting = i;
+                result.reason = problem;
+                return result;
+            }
+        }
+        
+        // Commit, netting per chunk
+        std::unordered_map<size_t, int64_t> chunkNet;
+        for (const Posting& posting : batch) {
+            balances[posting.account] += posting.amountCents;
+            chunkNet[posting.account / chunkAccounts] += posting.amountCents;
+            result.netCents += posting.amountCents;
+        }
+        
+        std::vector<std::pair<size_t, int64_t>> entries(chunkNet.begin(), chunkNet.end());
+        std::sort(entries.begin(), entries.end());
+        int64_t now = static_cast<int64_t>(std::time(nullptr));
+        for (const auto& [chunk, net] : entries) {
+            ledger.append(net >= 0 ? TransactionType::Deposit : TransactionType::Withdrawal, net,
+                          description + ", " + chunkLabel(chunk), now);
+        }
+        result.applied = true;
+        return result;
     }
 };
 
@@ -342,12 +810,61 @@ int main() {
     checkingAccount.displayTransactionHistory("1234");
     savingsAccount.displayTransactionHistory("5678");
     
+    // Long histories: segmented ledger, spilled to disk, read a page at a time
+    std::cout << "\n10. Long transaction history:" << std::endl;
+    BankAccount busyAccount("B24680", "Jane Doe", "checking", "2468");
+    busyAccount.enableHistorySpill("/tmp", 4);
+    std::streambuf* console = std::cout.rdbuf(nullptr);  // silence per-deposit messages
+    for (int i = 0; i < 100000; ++i) {
+        busyAccount.deposit(1.0 + (i % 100) / 100.0, i % 2 ? "Card payment" : "Payroll");
+    }
+    std::cout.rdbuf(console);
+    std::cout << "Transactions recorded: " << busyAccount.getTransactionCount() << std::endl;
+    auto firstPage = busyAccount.getTransactions("2468", 0, 3);
+    std::cout << "First three (read back from the spill file):" << std::endl;
+    for (const auto& transaction : firstPage) {
+        transaction.display();
+    }
+    
     // Change PIN
-    std::cout << "\n10. Changing PIN:" << std::endl;
+    std::cout << "\n11. Changing PIN:" << std::endl;
     checkingAccount.changePin("1234", "4321");
     
     // Verify new PIN works
     checkingAccount.displayAccountInfo("4321");
     
+    // Batch jobs over many accounts at once
+    std::cout << "\n12. Batch interest and bulk posting:" << std::endl;
+    const size_t bookSize = 1000000;
+    AccountBook book;
+    book.reserve(bookSize);
+    for (size_t i = 0; i < bookSize; ++i) {
+        book.addAccount("A" + std::to_string(i), "Holder " + std::to_string(i),
+                        i % 3 ? "savings" : "checking", 100.0 + static_cast<double>(i % 1000));
+    }
+    
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+    double interest = book.applyInterest(threads);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Interest on " << bookSize << " accounts: $" << std::fixed << std::setprecision(2) << interest
+              << " in " << elapsedMs << " ms on " << threads << " thread(s), "
+              << book.getLedger().size() << " ledger entries" << std::endl;
+    
+    std::vector<AccountBook::Posting> payroll;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        payroll.push_back({static_cast<uint32_t>(i * 37 % bookSize), toCents(2500.0)});
+    }
+    auto payrollResult = book.post(payroll, "Payroll");
+    std::cout << "Payroll batch: " << (payrollResult.applied ? "applied" : "rejected")
+              << ", net $" << fromCents(payrollResult.netCents) << std::endl;
+    
+    double before = book.totalBalance();
+    std::vector<AccountBook::Posting> overdrawn = {{0, toCents(-50.0)}, {1, toCents(-1000000.0)}};
+    auto overdrawnResult = book.post(overdrawn, "Card settlements");
+    std::cout << "Settlement batch: " << (overdrawnResult.applied ? "applied" : "rejected")
+              << " at posting " << overdrawnResult.rejectedPosting << " (" << overdrawnResult.reason << "); "
+              << "balances " << (book.totalBalance() == before ? "unchanged" : "changed") << std::endl;
+    
     return 0;
 }
@@ -20,15 +20,11 @@ public:
     Book(const std::string& title, const std::string& id, const std::string& bookAuthor,
          const std::string& bookIsbn, int pages, const std::string& pub, 
          int year, const std::string& bookGenre)
-        : LibraryItem(title, id, 0.50, 21),  // $0.50 daily fine, 21 days loan period
+        : LibraryItem(ItemType::Book, title, id, 0.50, 21),  // $0.50 daily fine, 21 days loan period
           author(bookAuthor), isbn(bookIsbn), pageCount(pages),
           publisher(pub), publicationYear(year), genre(bookGenre) {}
     
     // Implementation of pure virtual methods
-    std::string getItemType() const override {
-        return "Book";
-    }
-    
     void displayDetails() const override {
         std::cout << "\n===== Book Details =====" << std::endl;
         std::cout << "Title: " << title << std::endl;
@@ -39,11 +35,12 @@ public:
         std::cout << "Publisher: " << publisher << std::endl;
         std::cout << "Publication Year: " << publicationYear << std::endl;
         std::cout << "Page Count: " << pageCount << std::endl;
-        std::cout << "Status: " << (checkedOut ? "Checked Out" : "Available") << std::endl;
+        Loan loan = getLoan();
+        std::cout << "Status: " << (loan.active ? "Checked Out" : "Available") << std::endl;
         
-        if (checkedOut) {
-            std::cout << "Borrower: " << borrowerName << std::endl;
-            std::cout << "Due Date: " << dueDate << std::endl;
+        if (loan.active) {
+            std::cout << "Borrower: " << loan.borrower << std::endl;
+            std::cout << "Due Date: " << loan.dueDate << std::endl;
         }
         
         std::cout << "Daily Fine: $" << std::fixed << std::setprecision(2) << dailyFine << std::endl;
@@ -51,12 +48,12 @@ public:
     }
     
     // Book-specific methods
-    std::string getAuthor() const { return author; }
-    std::string getIsbn() const { return isbn; }
+    const std::string& getAuthor() const { return author; }
+    const std::string& getIsbn() const { return isbn; }
     int getPageCount() const { return pageCount; }
-    std::string getPublisher() const { return publisher; }
+    const std::string& getPublisher() const { return publisher; }
     int getPublicationYear() const { return publicationYear; }
-    std::string getGenre() const { return genre; }
+    const std::string& getGenre() const { return genre; }
     
     void setAuthor(const std::string& newAuthor) { author = newAuthor; }
     void setIsbn(const std::string& newIsbn) { isbn = newIsbn; }
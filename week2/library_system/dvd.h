@@ -22,15 +22,11 @@ public:
     DVD(const std::string& title, const std::string& id, const std::string& dvdDirector,
         int minutes, int year, const std::string& dvdStudio, 
         const std::string& dvdGenre, const std::string& dvdRating)
-        : LibraryItem(title, id, 1.00, 7),  // $1.00 daily fine, 7 days loan period
+        : LibraryItem(ItemType::DVD, title, id, 1.00, 7),  // $1.00 daily fine, 7 days loan period
           director(dvdDirector), runtime(minutes), releaseYear(year),
           studio(dvdStudio), genre(dvdGenre), rating(dvdRating) {}
     
     // Implementation of pure virtual methods
-    std::string getItemType() const override {
-        return "DVD";
-    }
-    
     void displayDetails() const override {
         std::cout << "\n===== DVD Details =====" << std::endl;
         std::cout << "Title: " << title << std::endl;
@@ -53,11 +49,12 @@ public:
             std::cout << std::endl;
         }
         
-        std::cout << "Status: " << (checkedOut ? "Checked Out" : "Available") << std::endl;
+        Loan loan = getLoan();
+        std::cout << "Status: " << (loan.active ? "Checked Out" : "Available") << std::endl;
         
-        if (checkedOut) {
-            std::cout << "Borrower: " << borrowerName << std::endl;
-            std::cout << "Due Date: " << dueDate << std::endl;
+        if (loan.active) {
+            std::cout << "Borrower: " << loan.borrower << std::endl;
+            std::cout << "Due Date: " << loan.dueDate << std::endl;
         }
         
         std::cout << "Daily Fine: $" << std::fixed << std::setprecision(2) << dailyFine << std::endl;
@@ -69,12 +66,12 @@ public:
         actors.push_back(actor);
     }
     
-    std::string getDirector() const { return director; }
+    const std::string& getDirector() const { return director; }
     int getRuntime() const { return runtime; }
     int getReleaseYear() const { return releaseYear; }
-    std::string getStudio() const { return studio; }
-    std::string getGenre() const { return genre; }
-    std::string getRating() const { return rating; }
+    const std::string& getStudio() const { return studio; }
+    const std::string& getGenre() const { return genre; }
+    const std::string& getRating() const { return rating; }
     const std::vector<std::string>& getActors() const { return actors; }
     
     void setDirector(const std::string& newDirector) { director = newDirector; }
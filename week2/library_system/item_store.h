@@ -0,0 +1,304 @@
+#ifndef ITEM_STORE_H
+#define ITEM_STORE_H
+
+#include "library_item.h"
+#include "book.h"
+#include "dvd.h"
+#include "journal.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+// Compact storage for the library catalog, for bulk work over many items.
+//
+// The class hierarchy gives every item its own heap object full of
+// std::string members. ItemStore instead keeps:
+// - the fields every scan touches (type, due date, borrower) as parallel
+//   arrays indexed by item number, so "all overdue items" streams through
+//   one array of 32-bit due dates
+// - type-specific fields in one contiguous array per type (books, DVDs,
+//   journals), reached through each item's detail index
+// - all text in an append-only arena; accessors return string_view into it
+// - borrower names interned once, items storing a 32-bit borrower number
+// - dates packed as days since 1970-01-01; an item that is not checked out
+//   has due date noDueDate, which is never before any real date
+//
+// Item numbers are stable (the store only appends). Not synchronized: use
+// from one thread, or share it read-only.
+class ItemStore {
+public:
+    static constexpr uint32_t noDueDate = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t noBorrower = 0;
+
+    struct BookDetails {
+        std::string_view author;
+        std::string_view isbn;
+        std::string_view publisher;
+        std::string_view genre;
+        int32_t pageCount;
+        int32_t publicationYear;
+    };
+
+    struct DVDDetails {
+        std::string_view director;
+        std::string_view studio;
+        std::string_view genre;
+        std::string_view rating;
+        uint32_t firstActor;  // into actors()
+        uint32_t actorCount;
+        int32_t runtime;
+        int32_t releaseYear;
+    };
+
+    struct JournalDetails {
+        std::string_view publisher;
+        std::string_view subject;
+        int32_t volume;
+        int32_t issue;
+        int32_t publicationYear;
+        int32_t publicationMonth;
+        bool isAcademic;
+    };
+
+    // "YYYY-MM-DD" to days since 1970-01-01 (noDueDate if malformed)
+    static uint32_t packDate(std::string_view date) {
+        int year = 0, month = 0, day = 0;
+        if (date.size() != 10 || date[4] != '-' || date[7] != '-' ||
+            std::sscanf(std::string(date).c_str(), "%4d-%2d-%2d", &year, &month, &day) != 3 ||
+            month < 1 || month > 12 || day < 1 || day > 31 || year < 1970) {
+            return noDueDate;
+        }
+        // Days from civil date (proleptic Gregorian, March-based year)
+        year -= month <= 2;
+        int era = year / 400;
+        int yearOfEra = year - era * 400;
+        int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return static_cast<uint32_t>(era * 146097 + dayOfEra - 719468);
+    }
+
+    static std::string formatDate(uint32_t days) {
+        if (days == noDueDate) {
+            return "";
+        }
+        int z = static_cast<int>(days) + 719468;
+        int era = z / 146097;
+        int dayOfEra = z - era * 146097;
+        int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int shiftedMonth = (5 * dayOfYear + 2) / 153;
+        int day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        int month = shiftedMonth + (shiftedMonth < 10 ? 3 : -9);
+        int year = yearOfEra + era * 400 + (month <= 2);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%04d-%02d-%02d", year, month, day);
+        return text;
+    }
+
+    // Fine per overdue day by type, as charged by Book, DVD and Journal
+    static double dailyFine(ItemType type) {
+        switch (type) {
+            case ItemType::Book: return 0.50;
+            case ItemType::DVD: return 1.00;
+            case ItemType::Journal: return 0.75;
+        }
+        return 0.0;
+    }
+
+    ItemStore() {
+        borrowerNames.emplace_back();  // number 0: no borrower
+    }
+
+    ItemStore(const ItemStore&) = delete;
+    ItemStore& operator=(const ItemStore&) = delete;
+    ItemStore(ItemStore&&) = default;
+    ItemStore& operator=(ItemStore&&) = default;
+
+    // Copies an item (and its current loan) into the store; returns its number
+    uint32_t add(const LibraryItem& item) {
+        uint32_t detail = 0;
+        switch (item.getType()) {
+            case ItemType::Book: {
+                const auto& book = static_cast<const Book&>(item);
+                detail = static_cast<uint32_t>(books.size());
+                books.push_back({store(book.getAuthor()), store(book.getIsbn()), store(book.getPublisher()),
+                                 store(book.getGenre()), book.getPageCount(), book.getPublicationYear()});
+                break;
+            }
+            case ItemType::DVD: {
+                const auto& dvd = static_cast<const DVD&>(item);
+                detail = static_cast<uint32_t>(dvds.size());
+                uint32_t firstActor = static_cast<uint32_t>(actorNames.size());
+                for (const auto& actor : dvd.getActors()) {
+                    actorNames.push_back(store(actor));
+                }
+                dvds.push_back({store(dvd.getDirector()), store(dvd.getStudio()), store(dvd.getGenre()),
+                                store(dvd.getRating()), firstActor,
+                                static_cast<uint32_t>(dvd.getActors().size()),
+                                dvd.getRuntime(), dvd.getReleaseYear()});
+                break;
+            }
+            case ItemType::Journal: {
+                const auto& journal = static_cast<const Journal&>(item);
+                detail = static_cast<uint32_t>(journals.size());
+                journals.push_back({store(journal.getPublisher()), store(journal.getSubject()),
+                                    journal.getVolume(), journal.getIssue(), journal.getPublicationYear(),
+                                    journal.getPublicationMonth(), journal.getIsAcademic()});
+                break;
+            }
+        }
+
+        uint32_t number = static_cast<uint32_t>(types.size());
+        types.push_back(item.getType());
+        details.push_back(detail);
+        titles.push_back(store(item.getTitle()));
+        itemIds.push_back(store(item.getItemId()));
+        dueDates.push_back(noDueDate);
+        borrowers.push_back(noBorrower);
+        idIndex.emplace(itemIds.back(), number);
+
+        // A loan whose due date does not parse is kept, but never overdue
+        LibraryItem::Loan loan = item.getLoan();
+        if (loan.active) {
+            borrowers[number] = internBorrower(loan.borrower);
+            dueDates[number] = packDate(loan.dueDate);
+        }
+        return number;
+    }
+
+    size_t size() const { return types.size(); }
+
+    // Item number for an ID, or size() if absent
+    uint32_t find(std::string_view itemId) const {
+        auto it = idIndex.find(itemId);
+        return it != idIndex.end() ? it->second : static_cast<uint32_t>(size());
+    }
+
+    // Per-item accessors
+    ItemType type(uint32_t item) const { return types[item]; }
+    std::string_view title(uint32_t item) const { return titles[item]; }
+    std::string_view itemId(uint32_t item) const { return itemIds[item]; }
+    bool isCheckedOut(uint32_t item) const { return borrowers[item] != noBorrower; }
+    std::string_view borrower(uint32_t item) const { return borrowerNames[borrowers[item]]; }
+    uint32_t dueDate(uint32_t item) const { return dueDates[item]; }
+
+    const BookDetails& book(uint32_t item) const { return books[details[item]]; }
+    const DVDDetails& dvd(uint32_t item) const { return dvds[details[item]]; }
+    const JournalDetails& journal(uint32_t item) const { return journals[details[item]]; }
+    const std::string_view* actors(const DVDDetails& dvd) const { return actorNames.data() + dvd.firstActor; }
+
+    // Whole columns, for scans
+    const std::vector<uint32_t>& dueDateColumn() const { return dueDates; }
+    const std::vector<uint32_t>& borrowerColumn() const { return borrowers; }
+    const std::vector<ItemType>& typeColumn() const { return types; }
+
+    bool checkOut(uint32_t item, std::string_view borrowerName, std::string_view date) {
+        uint32_t due = packDate(date);
+        if (isCheckedOut(item) || due == noDueDate) {
+            return false;
+        }
+        borrowers[item] = internBorrower(borrowerName);
+        dueDates[item] = due;
+        return true;
+    }
+
+    bool returnItem(uint32_t item) {
+        if (!isCheckedOut(item)) {
+            return false;
+        }
+        borrowers[item] = noBorrower;
+        dueDates[item] = noDueDate;
+        return true;
+    }
+
+    // Items due before today (days since 1970-01-01), in item order. One
+    // pass over the due-date column; items on the shelf never match
+    std::vector<uint32_t> overdueItems(uint32_t today) const {
+        std::vector<uint32_t> overdue;
+        const uint32_t* due = dueDates.data();
+        for (uint32_t item = 0, count = static_cast<uint32_t>(dueDates.size()); item < count; ++item) {
+            if (due[item] < today) {
+                overdue.push_back(item);
+            }
+        }
+        return overdue;
+    }
+
+    // Fines owed on all overdue items as of today
+    double outstandingFines(uint32_t today) const {
+        double total = 0.0;
+        for (size_t item = 0; item < dueDates.size(); ++item) {
+            if (dueDates[item] < today) {
+                total += (today - dueDates[item]) * dailyFine(types[item]);
+            }
+        }
+        return total;
+    }
+
+    size_t distinctBorrowers() const { return borrowerNames.size() - 1; }
+
+private:
+    static constexpr size_t arenaBlockSize = 64 * 1024;
+
+    // Hot columns, one entry per item
+    std::vector<ItemType> types;
+    std::vector<uint32_t> dueDates;
+    std::vector<uint32_t> borrowers;
+    std::vector<uint32_t> details;
+    std::vector<std::string_view> titles;
+    std::vector<std::string_view> itemIds;
+
+    // Type-segregated details
+    std::vector<BookDetails> books;
+    std::vector<DVDDetails> dvds;
+    std::vector<JournalDetails> journals;
+    std::vector<std::string_view> actorNames;
+
+    std::unordered_map<std::string_view, uint32_t> idIndex;
+    std::unordered_map<std::string_view, uint32_t> borrowerIndex;
+    std::vector<std::string_view> borrowerNames;
+
+    // Text arena: blocks never move, so views into them stay valid
+    std::vector<std::unique_ptr<char[]>> arena;
+    std::vector<std::unique_ptr<char[]>> oversized;
+    size_t arenaUsed = arenaBlockSize;
+
+    std::string_view store(std::string_view text) {
+        if (text.empty()) {
+            return {};
+        }
+        if (text.size() > arenaBlockSize / 4) {
+            // Long text gets its own block, leaving the current one open
+            oversized.push_back(std::make_unique<char[]>(text.size()));
+            std::memcpy(oversized.back().get(), text.data(), text.size());
+            return std::string_view(oversized.back().get(), text.size());
+        }
+        if (arenaUsed + text.size() > arenaBlockSize) {
+            arena.push_back(std::make_unique<char[]>(arenaBlockSize));
+            arenaUsed = 0;
+        }
+        char* target = arena.back().get() + arenaUsed;
+        std::memcpy(target, text.data(), text.size());
+        arenaUsed += text.size();
+        return std::string_view(target, text.size());
+    }
+
+    uint32_t internBorrower(std::string_view name) {
+        auto it = borrowerIndex.find(name);
+        if (it != borrowerIndex.end()) {
+            return it->second;
+        }
+        uint32_t number = static_cast<uint32_t>(borrowerNames.size());
+        borrowerNames.push_back(store(name));
+        borrowerIndex.emplace(borrowerNames.back(), number);
+        return number;
+    }
+};
+
+#endif // ITEM_STORE_H
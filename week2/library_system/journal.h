@@ -21,16 +21,12 @@ public:
     Journal(const std::string& title, const std::string& id, const std::string& journalPublisher,
             int journalVolume, int journalIssue, int year, int month, 
             const std::string& journalSubject, bool academic)
-        : LibraryItem(title, id, 0.75, 14),  // $0.75 daily fine, 14 days loan period
+        : LibraryItem(ItemType::Journal, title, id, 0.75, 14),  // $0.75 daily fine, 14 days loan period
           publisher(journalPublisher), volume(journalVolume), issue(journalIssue),
           publicationYear(year), publicationMonth(month), 
           subject(journalSubject), isAcademic(academic) {}
     
     // Implementation of pure virtual methods
-    std::string getItemType() const override {
-        return "Journal";
-    }
-    
     void displayDetails() const override {
         std::cout << "\n===== Journal Details =====" << std::endl;
         std::cout << "Title: " << title << std::endl;
@@ -40,11 +36,12 @@ public:
         std::cout << "Publication Date: " << publicationMonth << "/" << publicationYear << std::endl;
         std::cout << "Subject: " << subject << std::endl;
         std::cout << "Type: " << (isAcademic ? "Academic" : "Popular") << std::endl;
-        std::cout << "Status: " << (checkedOut ? "Checked Out" : "Available") << std::endl;
+        Loan loan = getLoan();
+        std::cout << "Status: " << (loan.active ? "Checked Out" : "Available") << std::endl;
         
-        if (checkedOut) {
-            std::cout << "Borrower: " << borrowerName << std::endl;
-            std::cout << "Due Date: " << dueDate << std::endl;
+        if (loan.active) {
+            std::cout << "Borrower: " << loan.borrower << std::endl;
+            std::cout << "Due Date: " << loan.dueDate << std::endl;
         }
         
         std::cout << "Daily Fine: $" << std::fixed << std::setprecision(2) << dailyFine << std::endl;
@@ -52,12 +49,12 @@ public:
     }
     
     // Journal-specific methods
-    std::string getPublisher() const { return publisher; }
+    const std::string& getPublisher() const { return publisher; }
     int getVolume() const { return volume; }
     int getIssue() const { return issue; }
     int getPublicationYear() const { return publicationYear; }
     int getPublicationMonth() const { return publicationMonth; }
-    std::string getSubject() const { return subject; }
+    const std::string& getSubject() const { return subject; }
     bool getIsAcademic() const { return isAcademic; }
     
     void setPublisher(const std::string& newPublisher) { publisher = newPublisher; }
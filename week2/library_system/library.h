@@ -5,42 +5,231 @@
 #include "book.h"
 #include "dvd.h"
 #include "journal.h"
+#include "item_store.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <iterator>
 #include <iostream>
+#include <unordered_map>
+#include <cctype>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+
+// The catalog keeps items in insertion order in a slot vector, with two
+// indexes maintained by addItem/removeItem:
+// - itemId -> slot hash index, so lookups, check-outs and removals are O(1)
+// - a trigram inverted index over case-folded titles. Substring search
+//   intersects the posting lists of the query's trigrams and only checks
+//   the surviving candidates, instead of lowercasing every title per query
+// Titles are folded once at insert. Removal leaves an empty slot; stale
+// postings are skipped at query time and dropped when the catalog is
+// compacted (once empty slots outnumber live ones).
+// Titles changed through LibraryItem::setTitle after insertion are not
+// reindexed.
+//
+// All public methods may be called from several threads at once:
+// - The ID index is split into shards, each behind its own shared_mutex,
+//   and holds the item pointer as well as its slot. Check-out and return
+//   only take one shard's lock briefly for reading, then rely on the item's
+//   own loan state (see LibraryItem), so they scale with cores and never
+//   wait on the catalog
+// - catalogMutex guards the slot vector and title index. Searches share
+//   it; only adding, removing and compacting take it exclusively (catalog
+//   before shard, always in that order)
+// - The display methods copy the live item pointers under the shared lock
+//   and print without holding it, so slow output never blocks writers
+//
+// Statistics are counters updated as items are added, removed, checked out
+// and returned (items report loan changes to the library they belong to),
+// so getStatistics is O(1) however large the catalog is.
+
+struct LibraryStatistics {
+    size_t totalItems = 0;
+    std::array<size_t, itemTypeCount> itemsByType{};
+    size_t checkedOutItems = 0;
+    
+    size_t count(ItemType type) const { return itemsByType[static_cast<size_t>(type)]; }
+    size_t availableItems() const { return totalItems - checkedOutItems; }
+};
 
 class Library {
 private:
+    struct CatalogEntry {
+        std::shared_ptr<LibraryItem> item;  // null once removed
+        std::string foldedTitle;
+    };
+    
+    struct IdEntry {
+        size_t slot;  // only read or changed under catalogMutex held exclusively
+        std::shared_ptr<LibraryItem> item;
+    };
+    
+    struct IdShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, IdEntry> entries;
+    };
+    
+    static constexpr size_t idShardCount = 16;
+    
     std::string name;
     std::string address;
-    std::vector<std::shared_ptr<LibraryItem>> items;
+    
+    mutable std::shared_mutex catalogMutex;
+    std::vector<CatalogEntry> catalog;
+    std::unordered_map<uint32_t, std::vector<size_t>> titleTrigrams;  // ascending slots
+    size_t liveItems = 0;
+    
+    std::array<IdShard, idShardCount> idShards;
+    
+    std::array<std::atomic<size_t>, itemTypeCount> typeCounts{};
+    std::atomic<size_t> checkedOutCount{0};
+    
+    IdShard& shardFor(const std::string& itemId) {
+        return idShards[std::hash<std::string>{}(itemId) % idShardCount];
+    }
+    
+    const IdShard& shardFor(const std::string& itemId) const {
+        return idShards[std::hash<std::string>{}(itemId) % idShardCount];
+    }
+    
+    static std::string foldCase(const std::string& text) {
+        std::string folded = text;
+        std::transform(folded.begin(), folded.end(), folded.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return folded;
+    }
+    
+    static uint32_t trigramAt(const std::string& text, size_t pos) {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16) |
+               (static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8) |
+               static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+    }
+    
+    static std::vector<uint32_t> distinctTrigrams(const std::string& folded) {
+        std::vector<uint32_t> trigrams;
+        for (size_t pos = 0; pos + 3 <= folded.size(); ++pos) {
+            trigrams.push_back(trigramAt(folded, pos));
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        return trigrams;
+    }
+    
+    // Callers hold catalogMutex exclusively
+    void indexTitle(size_t slot) {
+        for (uint32_t trigram : distinctTrigrams(catalog[slot].foldedTitle)) {
+            titleTrigrams[trigram].push_back(slot);
+        }
+    }
+    
+    // Drops empty slots and renumbers both indexes; catalogMutex held exclusively
+    void compact() {
+        std::vector<CatalogEntry> live;
+        live.reserve(liveItems);
+        for (auto& entry : catalog) {
+            if (entry.item) {
+                live.push_back(std::move(entry));
+            }
+        }
+        catalog = std::move(live);
+        titleTrigrams.clear();
+        for (size_t slot = 0; slot < catalog.size(); ++slot) {
+            indexTitle(slot);
+            IdShard& shard = shardFor(catalog[slot].item->getItemId());
+            std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+            shard.entries.at(catalog[slot].item->getItemId()).slot = slot;
+        }
+    }
+    
+    // Live items in catalog order, copied under the shared lock
+    std::vector<std::shared_ptr<LibraryItem>> snapshotItems() const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        std::vector<std::shared_ptr<LibraryItem>> items;
+        items.reserve(liveItems);
+        for (const auto& entry : catalog) {
+            if (entry.item) {
+                items.push_back(entry.item);
+            }
+        }
+        return items;
+    }
     
 public:
     // Constructor
     Library(const std::string& libraryName, const std::string& libraryAddress)
         : name(libraryName), address(libraryAddress) {}
     
-    // Add an item to the library
+    // Items may outlive the library; stop them reporting to its counters
+    ~Library() {
+        for (auto& entry : catalog) {
+            if (entry.item) {
+                entry.item->detachLoanCounter(&checkedOutCount);
+            }
+        }
+    }
+    
+    Library(const Library&) = delete;
+    Library& operator=(const Library&) = delete;
+    
+    // Add an item to the library (item IDs are unique)
     void addItem(std::shared_ptr<LibraryItem> item) {
-        items.push_back(item);
+        const std::string& itemId = item->getItemId();
+        {
+            std::unique_lock<std::shared_mutex> catalogLock(catalogMutex);
+            IdShard& shard = shardFor(itemId);
+            std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+            if (shard.entries.count(itemId)) {
+                std::cout << "Error: Item with ID " << itemId << " already exists." << std::endl;
+                return;
+            }
+            if (!item->attachLoanCounter(&checkedOutCount)) {
+                std::cout << "Error: Item with ID " << itemId << " belongs to another library." << std::endl;
+                return;
+            }
+            
+            catalog.push_back({item, foldCase(item->getTitle())});
+            shard.entries.emplace(itemId, IdEntry{catalog.size() - 1, item});
+            shardLock.unlock();
+            indexTitle(catalog.size() - 1);
+            ++liveItems;
+            typeCounts[static_cast<size_t>(item->getType())].fetch_add(1, std::memory_order_relaxed);
+        }
         std::cout << item->getItemType() << " \"" << item->getTitle() 
                   << "\" added to the library." << std::endl;
     }
     
     // Remove an item from the library
     bool removeItem(const std::string& itemId) {
-        auto it = std::find_if(items.begin(), items.end(),
-                              [&itemId](const std::shared_ptr<LibraryItem>& item) {
-                                  return item->getItemId() == itemId;
-                              });
+        std::shared_ptr<LibraryItem> removed;
+        {
+            std::unique_lock<std::shared_mutex> catalogLock(catalogMutex);
+            IdShard& shard = shardFor(itemId);
+            std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+            auto it = shard.entries.find(itemId);
+            if (it != shard.entries.end()) {
+                CatalogEntry& entry = catalog[it->second.slot];
+                removed = std::move(entry.item);
+                entry.foldedTitle.clear();
+                shard.entries.erase(it);
+                shardLock.unlock();
+                --liveItems;
+                typeCounts[static_cast<size_t>(removed->getType())].fetch_sub(1, std::memory_order_relaxed);
+                removed->detachLoanCounter(&checkedOutCount);
+                if (catalog.size() - liveItems > liveItems) {
+                    compact();
+                }
+            }
+        }
         
-        if (it != items.end()) {
-            std::string title = (*it)->getTitle();
-            std::string type = (*it)->getItemType();
-            items.erase(it);
-            std::cout << type << " \"" << title << "\" removed from the library." << std::endl;
+        if (removed) {
+            std::cout << removed->getItemType() << " \"" << removed->getTitle()
+                      << "\" removed from the library." << std::endl;
             return true;
         }
         
@@ -50,33 +239,54 @@ public:
     
     // Find an item by ID
     std::shared_ptr<LibraryItem> findItem(const std::string& itemId) const {
-        auto it = std::find_if(items.begin(), items.end(),
-                              [&itemId](const std::shared_ptr<LibraryItem>& item) {
-                                  return item->getItemId() == itemId;
-                              });
-        
-        if (it != items.end()) {
-            return *it;
-        }
-        
-        return nullptr;
+        const IdShard& shard = shardFor(itemId);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(itemId);
+        return it != shard.entries.end() ? it->second.item : nullptr;
     }
     
-    // Search items by title (partial match)
+    // Search items by title (case-insensitive partial match), in catalog order
     std::vector<std::shared_ptr<LibraryItem>> searchByTitle(const std::string& titleQuery) const {
         std::vector<std::shared_ptr<LibraryItem>> results;
+        std::string query = foldCase(titleQuery);
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
         
-        for (const auto& item : items) {
-            // Case-insensitive search
-            std::string title = item->getTitle();
-            std::string query = titleQuery;
-            
-            // Convert both to lowercase for comparison
-            std::transform(title.begin(), title.end(), title.begin(), ::tolower);
-            std::transform(query.begin(), query.end(), query.begin(), ::tolower);
-            
-            if (title.find(query) != std::string::npos) {
-                results.push_back(item);
+        // Queries shorter than a trigram check the pre-folded titles directly
+        if (query.size() < 3) {
+            for (const auto& entry : catalog) {
+                if (entry.item && entry.foldedTitle.find(query) != std::string::npos) {
+                    results.push_back(entry.item);
+                }
+            }
+            return results;
+        }
+        
+        // Intersect posting lists, shortest first
+        std::vector<const std::vector<size_t>*> postings;
+        for (uint32_t trigram : distinctTrigrams(query)) {
+            auto it = titleTrigrams.find(trigram);
+            if (it == titleTrigrams.end()) {
+                return results;
+            }
+            postings.push_back(&it->second);
+        }
+        std::sort(postings.begin(), postings.end(),
+                  [](const auto* a, const auto* b) { return a->size() < b->size(); });
+        
+        std::vector<size_t> candidates = *postings.front();
+        std::vector<size_t> narrowed;
+        for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i) {
+            narrowed.clear();
+            std::set_intersection(candidates.begin(), candidates.end(),
+                                  postings[i]->begin(), postings[i]->end(), std::back_inserter(narrowed));
+            candidates.swap(narrowed);
+        }
+        
+        // Trigrams can match out of order; confirm the substring itself
+        for (size_t slot : candidates) {
+            const CatalogEntry& entry = catalog[slot];
+            if (entry.item && entry.foldedTitle.find(query) != std::string::npos) {
+                results.push_back(entry.item);
             }
         }
         
@@ -107,6 +317,7 @@ public:
     
     // Display all items in the library
     void displayAllItems() const {
+        auto items = snapshotItems();
         std::cout << "\n===== Library Inventory =====" << std::endl;
         std::cout << "Library: " << name << std::endl;
         std::cout << "Address: " << address << std::endl;
@@ -130,12 +341,17 @@ public:
         std::cout << "\n===== Checked Out Items =====" << std::endl;
         
         int count = 0;
-        for (const auto& item : items) {
-            if (item->isCheckedOut()) {
+        for (const auto& item : snapshotItems()) {
+            // Lock-free status check first; the loan snapshot is consistent
+            if (!item->isCheckedOut()) {
+                continue;
+            }
+            LibraryItem::Loan loan = item->getLoan();
+            if (loan.active) {
                 std::cout << "- " << item->getItemType() << ": " << item->getTitle() 
                           << " (ID: " << item->getItemId() << ")" << std::endl;
-                std::cout << "  Borrower: " << item->getBorrowerName() 
-                          << ", Due Date: " << item->getDueDate() << std::endl;
+                std::cout << "  Borrower: " << loan.borrower 
+                          << ", Due Date: " << loan.dueDate << std::endl;
                 count++;
             }
         }
@@ -147,35 +363,48 @@ public:
         }
     }
     
-    // Get library statistics
-    void displayStatistics() const {
-        int totalBooks = 0;
-        int totalDVDs = 0;
-        int totalJournals = 0;
-        int checkedOutItems = 0;
-        
-        for (const auto& item : items) {
-            if (item->getItemType() == "Book") totalBooks++;
-            else if (item->getItemType() == "DVD") totalDVDs++;
-            else if (item->getItemType() == "Journal") totalJournals++;
-            
-            if (item->isCheckedOut()) checkedOutItems++;
+    // Copy of the catalog in compact form, for bulk scans (see item_store.h)
+    ItemStore toItemStore() const {
+        ItemStore store;
+        for (const auto& item : snapshotItems()) {
+            store.add(*item);
         }
+        return store;
+    }
+    
+    // Current counts, read from counters without touching the catalog. Under
+    // concurrent updates each count is current but they are not one snapshot
+    LibraryStatistics getStatistics() const {
+        LibraryStatistics stats;
+        for (size_t i = 0; i < itemTypeCount; ++i) {
+            stats.itemsByType[i] = typeCounts[i].load(std::memory_order_relaxed);
+            stats.totalItems += stats.itemsByType[i];
+        }
+        stats.checkedOutItems = std::min(checkedOutCount.load(std::memory_order_relaxed), stats.totalItems);
+        return stats;
+    }
+    
+    // Display library statistics
+    void displayStatistics() const {
+        LibraryStatistics stats = getStatistics();
         
         std::cout << "\n===== Library Statistics =====" << std::endl;
         std::cout << "Library: " << name << std::endl;
-        std::cout << "Total Items: " << items.size() << std::endl;
-        std::cout << "Books: " << totalBooks << std::endl;
-        std::cout << "DVDs: " << totalDVDs << std::endl;
-        std::cout << "Journals: " << totalJournals << std::endl;
-        std::cout << "Checked Out Items: " << checkedOutItems << std::endl;
-        std::cout << "Available Items: " << (items.size() - checkedOutItems) << std::endl;
+        std::cout << "Total Items: " << stats.totalItems << std::endl;
+        std::cout << "Books: " << stats.count(ItemType::Book) << std::endl;
+        std::cout << "DVDs: " << stats.count(ItemType::DVD) << std::endl;
+        std::cout << "Journals: " << stats.count(ItemType::Journal) << std::endl;
+        std::cout << "Checked Out Items: " << stats.checkedOutItems << std::endl;
+        std::cout << "Available Items: " << stats.availableItems() << std::endl;
     }
     
     // Getter methods
     std::string getName() const { return name; }
     std::string getAddress() const { return address; }
-    size_t getItemCount() const { return items.size(); }
+    size_t getItemCount() const {
+        std::shared_lock<std::shared_mutex> lock(catalogMutex);
+        return liveItems;
+    }
 };
 
 #endif // LIBRARY_H
@@ -2,44 +2,123 @@
 #define LIBRARY_ITEM_H
 
 #include <string>
+#include <string_view>
 #include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
 
-// Abstract base class for all library items
+// Kind of library item. A one-byte tag stored in the item, so code that
+// only needs the type (statistics, filtering) avoids a virtual call and a
+// string comparison
+enum class ItemType : uint8_t { Book, DVD, Journal };
+
+constexpr size_t itemTypeCount = 3;
+
+constexpr std::string_view itemTypeName(ItemType type) {
+    switch (type) {
+        case ItemType::Book: return "Book";
+        case ItemType::DVD: return "DVD";
+        case ItemType::Journal: return "Journal";
+    }
+    return "Item";
+}
+
+// Abstract base class for all library items.
+// Check-out state is safe to use from several threads: checkedOut is an
+// atomic that readers poll without locking, while changes to it and to the
+// borrower/due date happen together under the item's own loanMutex, so
+// different items never contend. Title and ID are expected not to change
+// while other threads use the item.
 class LibraryItem {
+private:
+    friend class Library;
+    
+    // Checked-out counter of the Library holding this item, kept in step
+    // with checkedOut; guarded by loanMutex. An item reports to one library
+    // at a time.
+    std::atomic<size_t>* loanCounter = nullptr;
+    
+    // Start reporting this item's loan (if any) to counter; false if the
+    // item already reports to another library's counter
+    bool attachLoanCounter(std::atomic<size_t>* counter) {
+        std::lock_guard<std::mutex> lock(loanMutex);
+        if (loanCounter && loanCounter != counter) {
+            return false;
+        }
+        if (!loanCounter && checkedOut.load(std::memory_order_relaxed)) {
+            counter->fetch_add(1, std::memory_order_relaxed);
+        }
+        loanCounter = counter;
+        return true;
+    }
+    
+    // Stop reporting to counter, taking the loan (if any) off it; does
+    // nothing if the item reports elsewhere
+    void detachLoanCounter(std::atomic<size_t>* counter) {
+        std::lock_guard<std::mutex> lock(loanMutex);
+        if (loanCounter != counter) {
+            return;
+        }
+        if (checkedOut.load(std::memory_order_relaxed)) {
+            loanCounter->fetch_sub(1, std::memory_order_relaxed);
+        }
+        loanCounter = nullptr;
+    }
+    
 protected:
+    const ItemType type;
     std::string title;
     std::string itemId;
-    bool checkedOut;
-    std::string borrowerName;
-    std::string dueDate;
+    std::atomic<bool> checkedOut;
+    std::string borrowerName;  // guarded by loanMutex
+    std::string dueDate;       // guarded by loanMutex
+    mutable std::mutex loanMutex;
     double dailyFine;
     int maxLoanDays;
 
 public:
+    // Consistent snapshot of the check-out state
+    struct Loan {
+        bool active = false;
+        std::string borrower;
+        std::string dueDate;
+    };
+
     // Constructor
-    LibraryItem(const std::string& itemTitle, const std::string& id, double fine, int loanDays)
-        : title(itemTitle), itemId(id), checkedOut(false), 
+    LibraryItem(ItemType itemType, const std::string& itemTitle, const std::string& id, double fine, int loanDays)
+        : type(itemType), title(itemTitle), itemId(id), checkedOut(false), 
           borrowerName(""), dueDate(""), dailyFine(fine), maxLoanDays(loanDays) {}
     
     // Virtual destructor
     virtual ~LibraryItem() {}
     
-    // Pure virtual method to get item type
-    virtual std::string getItemType() const = 0;
+    // Item type, as a tag and as a display name
+    ItemType getType() const { return type; }
+    std::string_view getItemType() const { return itemTypeName(type); }
     
     // Pure virtual method to display details
     virtual void displayDetails() const = 0;
     
     // Check out item
     bool checkOut(const std::string& borrower, const std::string& date) {
-        if (checkedOut) {
+        // Fail fast without the lock; re-checked below under it
+        if (checkedOut.load(std::memory_order_acquire)) {
+            std::cout << "Error: Item is already checked out." << std::endl;
+            return false;
+        }
+        
+        std::lock_guard<std::mutex> lock(loanMutex);
+        if (checkedOut.load(std::memory_order_relaxed)) {
             std::cout << "Error: Item is already checked out." << std::endl;
             return false;
         }
         
-        checkedOut = true;
         borrowerName = borrower;
         dueDate = date;
+        checkedOut.store(true, std::memory_order_release);
+        if (loanCounter) loanCounter->fetch_add(1, std::memory_order_relaxed);
         std::cout << getItemType() << " \"" << title << "\" checked out to " 
                   << borrower << " until " << date << std::endl;
         return true;
@@ -47,12 +126,14 @@ public:
     
     // Return item
     bool returnItem() {
-        if (!checkedOut) {
+        std::lock_guard<std::mutex> lock(loanMutex);
+        if (!checkedOut.load(std::memory_order_relaxed)) {
             std::cout << "Error: Item is not checked out." << std::endl;
             return false;
         }
         
-        checkedOut = false;
+        checkedOut.store(false, std::memory_order_release);
+        if (loanCounter) loanCounter->fetch_sub(1, std::memory_order_relaxed);
         std::cout << getItemType() << " \"" << title << "\" returned by " 
                   << borrowerName << std::endl;
         borrowerName = "";
@@ -77,11 +158,16 @@ public:
     }
     
     // Getter methods
-    std::string getTitle() const { return title; }
-    std::string getItemId() const { return itemId; }
-    bool isCheckedOut() const { return checkedOut; }
-    std::string getBorrowerName() const { return borrowerName; }
-    std::string getDueDate() const { return dueDate; }
+    const std::string& getTitle() const { return title; }
+    const std::string& getItemId() const { return itemId; }
+    bool isCheckedOut() const { return checkedOut.load(std::memory_order_acquire); }
+    std::string getBorrowerName() const { return getLoan().borrower; }
+    std::string getDueDate() const { return getLoan().dueDate; }
+    
+    Loan getLoan() const {
+        std::lock_guard<std::mutex> lock(loanMutex);
+        return Loan{checkedOut.load(std::memory_order_relaxed), borrowerName, dueDate};
+    }
     double getDailyFine() const { return dailyFine; }
     int getMaxLoanDays() const { return maxLoanDays; }
     
@@ -6,6 +6,8 @@
 #include <memory>
 #include <string>
 #include <limits>
+#include <iomanip>
+#include <cstdint>
 
 // Function to display the menu
 void displayMenu() {
@@ -18,8 +20,9 @@ void displayMenu() {
     std::cout << "6. Return an item" << std::endl;
     std::cout << "7. Display checked out items" << std::endl;
     std::cout << "8. Display library statistics" << std::endl;
-    std::cout << "9. Exit" << std::endl;
-    std::cout << "Enter your choice (1-9): ";
+    std::cout << "9. Display overdue items" << std::endl;
+    std::cout << "10. Exit" << std::endl;
+    std::cout << "Enter your choice (1-10): ";
 }
 
 // Function to add a new book
@@ -278,6 +281,44 @@ void returnItem(Library& library) {
     library.returnItem(itemId);
 }
 
+// Function to list overdue items and the fines owed on them
+void displayOverdueItems(const Library& library) {
+    std::string today;
+    
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    
+    std::cout << "\n===== Overdue Items =====" << std::endl;
+    std::cout << "Enter today's date (e.g., 2025-07-20): ";
+    std::getline(std::cin, today);
+    
+    uint32_t todayDays = ItemStore::packDate(today);
+    if (todayDays == ItemStore::noDueDate) {
+        std::cout << "Invalid date." << std::endl;
+        return;
+    }
+    
+    // One scan over the compact store's due-date column
+    ItemStore store = library.toItemStore();
+    auto overdue = store.overdueItems(todayDays);
+    
+    if (overdue.empty()) {
+        std::cout << "No items are overdue." << std::endl;
+        return;
+    }
+    
+    for (uint32_t item : overdue) {
+        uint32_t daysLate = todayDays - store.dueDate(item);
+        std::cout << "- " << itemTypeName(store.type(item)) << ": " << store.title(item)
+                  << " (ID: " << store.itemId(item) << ")" << std::endl;
+        std::cout << "  Borrower: " << store.borrower(item)
+                  << ", Due: " << ItemStore::formatDate(store.dueDate(item))
+                  << ", " << daysLate << " day(s) late, fine $" << std::fixed << std::setprecision(2)
+                  << daysLate * ItemStore::dailyFine(store.type(item)) << std::endl;
+    }
+    std::cout << "Total overdue items: " << overdue.size() << ", fines owed: $" << std::fixed
+              << std::setprecision(2) << store.outstandingFines(todayDays) << std::endl;
+}
+
 // Main function
 int main() {
     // Create a library
@@ -348,6 +389,9 @@ int main() {
                 library.displayStatistics();
                 break;
             case 9:
+                displayOverdueItems(library);
+                break;
+            case 10:
                 std::cout << "Thank you for using the Library Management System. Goodbye!" << std::endl;
                 running = false;
                 break;
@@ -5,6 +5,11 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <deque>
+#include <limits>
+#include <list>
+#include <tuple>
+#include <array>
 #include <map>
 #include <unordered_map>
 #include <functional>
@@ -22,6 +27,36 @@
 #include <stdexcept>
 #include <algorithm>
 #include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <fstream>
+#include <cctype>
+#include <cmath>
+#include "../week4/flat_hash_map.hpp"
+#include "concurrent_counters.hpp"
+#include "expected.hpp"
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+// C++20 coroutine support (AsyncTask, TaskScheduler::spawn/sleepFor and
+// co_await on scheduled tasks) is compiled only where the compiler provides
+// coroutines; C++17 builds see none of it. Awaiting I/O readiness also needs
+// POSIX poll().
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define ADVANCED_TASK_SCHEDULER_COROUTINES 1
+#include <coroutine>
+#include <utility>
+#if __has_include(<poll.h>)
+#define ADVANCED_TASK_SCHEDULER_IO 1
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+#endif
 
 // Custom exceptions for the task scheduler
 class TaskSchedulerException : public std::runtime_error {
@@ -42,6 +77,21 @@ public:
         : TaskSchedulerException(message) {}
 };
 
+class QueueFullException : public TaskSchedulerException {
+public:
+    explicit QueueFullException(const std::string& message)
+        : TaskSchedulerException(message) {}
+};
+
+// Why a non-throwing TaskScheduler call (tryGetTaskStatus, tryGetTaskResult,
+// tryWaitForTask) failed; the throwing versions raise the exceptions above
+enum class SchedulerError {
+    TaskNotFound,
+    ResultTypeMismatch,
+    TaskFailed,      // getTaskResult(name).getResult() rethrows its exception
+    TaskCancelled
+};
+
 // Task priority levels
 enum class Priority {
     LOW,
@@ -111,6 +161,17 @@ public:
         return *result_;
     }
     
+    // Same as getResult, without copying the result
+    const ResultType& getResultRef() const {
+        if (hasException()) {
+            std::rethrow_exception(*exception_);
+        }
+        if (!hasResult()) {
+            throw TaskSchedulerException("Task has no result");
+        }
+        return *result_;
+    }
+    
     // Try to get result without throwing
     std::optional<ResultType> tryGetResult() const {
         return result_;
@@ -160,9 +221,62 @@ public:
 };
 
 // Base task interface using type erasure
-class TaskBase {
+class TaskBase : public std::enable_shared_from_this<TaskBase> {
+public:
+    // Told about every task it is attached to as that task finishes; unlike
+    // a continuation, attaching one allocates nothing
+    class FinishObserver {
+    public:
+        virtual void taskFinished(TaskBase& task) = 0;
+        
+    protected:
+        ~FinishObserver() = default;
+    };
+    
+private:
+    std::mutex continuationsMutex_;
+    std::vector<std::function<void()>> continuations_;
+    bool finished_ = false;
+    FinishObserver* observer_ = nullptr;
+    
+protected:
+    // Called once the task has completed, failed or been skipped as cancelled
+    void notifyFinished() {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::unique_lock<std::mutex> lock(continuationsMutex_);
+            finished_ = true;
+            continuations.swap(continuations_);
+        }
+        for (auto& continuation : continuations) {
+            continuation();
+        }
+        if (observer_) {
+            observer_->taskFinished(*this);
+        }
+    }
+    
 public:
     virtual ~TaskBase() = default;
+    
+    // Attach before the task can run; the observer must outlive the task's run
+    void setFinishObserver(FinishObserver* observer) {
+        observer_ = observer;
+    }
+    
+    // Run `continuation` on the thread that finishes this task, or right away
+    // on the calling thread if it has already finished
+    void whenFinished(std::function<void()> continuation) {
+        {
+            std::unique_lock<std::mutex> lock(continuationsMutex_);
+            if (!finished_) {
+                continuations_.push_back(std::move(continuation));
+                return;
+            }
+        }
+        continuation();
+    }
+    
     virtual void execute() = 0;
     virtual TaskStatus getStatus() const = 0;
     virtual std::string getName() const = 0;
@@ -200,6 +314,7 @@ public:
     
     void execute() override {
         if (status_ == TaskStatus::CANCELLED) {
+            notifyFinished();
             return;
         }
         
@@ -217,6 +332,7 @@ public:
             result_.setException(std::current_exception());
             status_ = TaskStatus::FAILED;
         }
+        notifyFinished();
     }
     
     TaskStatus getStatus() const override {
@@ -275,243 +391,2509 @@ struct TaskComparator {
     }
 };
 
-// Thread pool for executing tasks
-class ThreadPool {
+// Chase-Lev work-stealing deque (Le, Pop, Cohen & Zappa Nardelli, "Correct
+// and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013).
+// The owning thread pushes and pops at the bottom without locking; any other
+// thread may steal from the top. The ring buffer doubles when full; replaced
+// buffers stay alive until the deque is destroyed, since a concurrent thief
+// may still be reading one.
+template<typename T>
+class WorkStealingDeque {
 private:
-    std::vector<std::thread> workers_;
-    std::priority_queue<std::shared_ptr<TaskBase>, 
-                        std::vector<std::shared_ptr<TaskBase>>, 
-                        TaskComparator> tasks_;
-    std::mutex queueMutex_;
-    std::condition_variable condition_;
-    std::atomic<bool> stop_;
-    std::atomic<size_t> activeThreads_;
-    size_t maxThreads_;
-
+    struct RingBuffer {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+        
+        explicit RingBuffer(int64_t size) : capacity(size), slots(new std::atomic<T*>[size]) {}
+        
+        T* get(int64_t index) const { return slots[index & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t index, T* item) { slots[index & (capacity - 1)].store(item, std::memory_order_relaxed); }
+    };
+    
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<RingBuffer*> buffer_;
+    std::vector<std::unique_ptr<RingBuffer>> buffers_;   // current and retired, owner-only
+    
+    RingBuffer* grow(RingBuffer* old, int64_t top, int64_t bottom) {
+        buffers_.push_back(std::make_unique<RingBuffer>(old->capacity * 2));
+        RingBuffer* bigger = buffers_.back().get();
+        for (int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        buffer_.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+    
 public:
-    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
-        : stop_(false), activeThreads_(0), maxThreads_(threads) {
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        buffers_.push_back(std::make_unique<RingBuffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+    
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    
+    // Owner only
+    void push(T* item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        RingBuffer* buffer = buffer_.load(std::memory_order_relaxed);
+        if (bottom - top > buffer->capacity - 1) {
+            buffer = grow(buffer, top, bottom);
+        }
+        buffer->put(bottom, item);
+        // The paper's release fence + relaxed store, as one release store
+        // (same code on x86/ARM, and visible to ThreadSanitizer)
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+    
+    // Owner only: most recently pushed item, or nullptr when empty
+    T* pop() {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        RingBuffer* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
         
-        for (size_t i = 0; i < threads; ++i) {
-            workers_.emplace_back([this] {
-                while (true) {
-                    std::shared_ptr<TaskBase> task;
-                    
-                    {
-                        std::unique_lock<std::mutex> lock(queueMutex_);
-                        condition_.wait(lock, [this] { 
-                            return stop_ || !tasks_.empty(); 
-                        });
-                        
-                        if (stop_ && tasks_.empty()) {
-                            return;
-                        }
-                        
-                        task = tasks_.top();
-                        tasks_.pop();
-                    }
-                    
-                    ++activeThreads_;
-                    task->execute();
-                    --activeThreads_;
+        T* item = nullptr;
+        if (top <= bottom) {
+            item = buffer->get(bottom);
+            if (top == bottom) {
+                // Last item: race the thieves for it
+                if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed)) {
+                    item = nullptr;
                 }
-            });
+                bottom_.store(bottom + 1, std::memory_order_relaxed);
+            }
+        } else {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
         }
+        return item;
     }
     
-    ~ThreadPool() {
-        {
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            stop_ = true;
+    // Any thread: oldest item, or nullptr when empty or when another thread won the race
+    T* steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
         }
         
-        condition_.notify_all();
+        T* item = buffer_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+    
+    bool empty() const {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+};
+
+// Log-linear histogram of durations in nanoseconds, in the style of
+// HdrHistogram: values below 2^SUB_BITS each get a bucket, and above that
+// every power of two is split into 2^SUB_BITS buckets, so a bucket's width
+// is at most 1/16 of its values. It has one writer; readers take a
+// Snapshot at any time without locking (relaxed loads, so a snapshot taken
+// mid-record may be off by that one record).
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int MAX_EXPONENT = 44;   // about 4.9 hours; longer values land in the last bucket
+    static constexpr size_t BUCKETS = static_cast<size_t>(MAX_EXPONENT - SUB_BITS + 1) << SUB_BITS;
+    
+    static size_t bucketOf(uint64_t value) {
+        if (value < (uint64_t(1) << SUB_BITS)) {
+            return static_cast<size_t>(value);
+        }
+#if defined(__GNUC__)
+        int exponent = 63 - __builtin_clzll(value);
+#else
+        int exponent = 63;
+        while (!(value >> exponent)) --exponent;
+#endif
+        if (exponent >= MAX_EXPONENT) {
+            return BUCKETS - 1;
+        }
+        size_t group = static_cast<size_t>(exponent - SUB_BITS + 1);
+        size_t sub = static_cast<size_t>(value >> (exponent - SUB_BITS)) & ((size_t(1) << SUB_BITS) - 1);
+        return (group << SUB_BITS) + sub;
+    }
+    
+    // Largest value that falls in `bucket`
+    static uint64_t bucketUpperBound(size_t bucket) {
+        if (bucket < (size_t(1) << SUB_BITS)) {
+            return bucket;
+        }
+        size_t group = bucket >> SUB_BITS;
+        uint64_t sub = bucket & ((size_t(1) << SUB_BITS) - 1);
+        uint64_t lower = ((uint64_t(1) << SUB_BITS) + sub) << (group - 1);
+        return lower + (uint64_t(1) << (group - 1)) - 1;
+    }
+    
+    struct Snapshot {
+        std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS, 0);
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
         
-        for (std::thread& worker : workers_) {
-            if (worker.joinable()) {
-                worker.join();
+        void merge(const Snapshot& other) {
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                counts[i] += other.counts[i];
+            }
+            count += other.count;
+            sum += other.sum;
+            max = std::max(max, other.max);
+        }
+        
+        double mean() const {
+            return count ? static_cast<double>(sum) / count : 0.0;
+        }
+        
+        // Value at or below which `percent` of the records fall; reported
+        // as its bucket's upper bound (never above the largest record)
+        uint64_t percentile(double percent) const {
+            if (count == 0) {
+                return 0;
+            }
+            double rank = std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(count);
+            uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(rank)));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += counts[i];
+                if (seen >= target) {
+                    return std::min(bucketUpperBound(i), max);
+                }
             }
+            return max;
         }
+    };
+    
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+    
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
     }
     
-    void enqueue(std::shared_ptr<TaskBase> task) {
-        {
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            if (stop_) {
-                throw TaskSchedulerException("ThreadPool has been stopped");
-            }
-            tasks_.push(std::move(task));
+public:
+    // Single writer only: updates are plain load/store pairs, not RMWs
+    void record(uint64_t nanoseconds) {
+        bump(counts_[bucketOf(nanoseconds)], 1);
+        bump(sum_, nanoseconds);
+        if (nanoseconds > max_.load(std::memory_order_relaxed)) {
+            max_.store(nanoseconds, std::memory_order_relaxed);
         }
-        condition_.notify_one();
     }
     
-    size_t getQueueSize() const {
-        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(queueMutex_));
-        return tasks_.size();
+    void record(std::chrono::steady_clock::duration duration) {
+        record(static_cast<uint64_t>(std::max<int64_t>(0,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count())));
     }
     
-    size_t getActiveThreadCount() const {
-        return activeThreads_;
+    // Adds this histogram's current contents to `into`
+    void snapshotInto(Snapshot& into) const {
+        uint64_t count = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            uint64_t bucket = counts_[i].load(std::memory_order_relaxed);
+            into.counts[i] += bucket;
+            count += bucket;
+        }
+        into.count += count;
+        into.sum += sum_.load(std::memory_order_relaxed);
+        into.max = std::max(into.max, max_.load(std::memory_order_relaxed));
+    }
+};
+
+// What running a PoolItem amounted to, for the pool's counters
+enum class RunOutcome {
+    COMPLETED,
+    FAILED,
+    SKIPPED   // cancelled before it started
+};
+
+// Entry in the ThreadPool's queues. run() executes the work and releases
+// the item, so the pool never owns or allocates items itself.
+class PoolItem {
+public:
+    Priority priority = Priority::MEDIUM;
+    std::chrono::steady_clock::time_point enqueuedAt;   // set by ThreadPool when latency is measured
+    
+    virtual RunOutcome run() = 0;
+    
+    // Make a queued item skip its work when it is run; false if it cannot
+    // be cancelled (or already was)
+    virtual bool cancelQueued() {
+        return false;
     }
     
-    size_t getMaxThreadCount() const {
-        return maxThreads_;
+    // When the work became due, the start of its end-to-end latency
+    virtual std::chrono::steady_clock::time_point dueAt() const {
+        return enqueuedAt;
     }
+    
+protected:
+    ~PoolItem() = default;
 };
 
-// Main task scheduler class
-class TaskScheduler {
+// Move-only callable stored inline in a fixed buffer: constructing one never
+// allocates, and a callable that does not fit fails to compile.
+template<typename Signature, size_t Capacity = 48>
+class SmallFunction;
+
+template<typename R, typename... Args, size_t Capacity>
+class SmallFunction<R(Args...), Capacity> {
 private:
-    ThreadPool threadPool_;
-    std::unordered_map<std::string, std::shared_ptr<TaskBase>> tasks_;
-    std::mutex tasksMutex_;
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    R (*invoke_)(void*, Args&&...) = nullptr;
+    void (*relocate_)(void* target, void* source) = nullptr;   // target == nullptr: destroy only
     
-    // Task statistics
-    struct Statistics {
-        std::atomic<size_t> totalTasks{0};
-        std::atomic<size_t> completedTasks{0};
-        std::atomic<size_t> failedTasks{0};
-        std::atomic<size_t> cancelledTasks{0};
-    };
+    void moveFrom(SmallFunction& other) noexcept {
+        if (other.invoke_) {
+            other.relocate_(storage_, other.storage_);
+            invoke_ = other.invoke_;
+            relocate_ = other.relocate_;
+            other.invoke_ = nullptr;
+            other.relocate_ = nullptr;
+        }
+    }
     
-    Statistics stats_;
-
 public:
-    explicit TaskScheduler(size_t threadCount = std::thread::hardware_concurrency())
-        : threadPool_(threadCount) {}
+    SmallFunction() = default;
     
-    // Schedule a task with a result
-    template<typename ResultType>
-    std::shared_ptr<Task<ResultType>> scheduleTask(
-        const std::string& name,
-        std::function<ResultType()> function,
-        Priority priority = Priority::MEDIUM,
-        std::chrono::system_clock::time_point scheduledTime = std::chrono::system_clock::now(),
-        bool cancellable = true) {
-        
-        std::unique_lock<std::mutex> lock(tasksMutex_);
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, SmallFunction>>>
+    SmallFunction(F&& function) {
+        using Stored = std::decay_t<F>;
+        static_assert(sizeof(Stored) <= Capacity, "callable does not fit in SmallFunction");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t), "callable is over-aligned");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>, "callable must be nothrow movable");
         
-        if (tasks_.find(name) != tasks_.end()) {
-            throw DuplicateTaskException("Task with name '" + name + "' already exists");
+        new (storage_) Stored(std::forward<F>(function));
+        invoke_ = [](void* stored, Args&&... args) -> R {
+            return (*static_cast<Stored*>(stored))(std::forward<Args>(args)...);
+        };
+        relocate_ = [](void* target, void* source) {
+            if (target) {
+                new (target) Stored(std::move(*static_cast<Stored*>(source)));
+            }
+            static_cast<Stored*>(source)->~Stored();
+        };
+    }
+    
+    SmallFunction(SmallFunction&& other) noexcept { moveFrom(other); }
+    
+    SmallFunction& operator=(SmallFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
         }
-        
-        auto task = std::make_shared<Task<ResultType>>(
-            name, std::move(function), priority, scheduledTime, cancellable);
-        
-        tasks_[name] = task;
-        stats_.totalTasks++;
-        
-        // If the scheduled time is now or in the past, enqueue immediately
-        if (scheduledTime <= std::chrono::system_clock::now()) {
-            threadPool_.enqueue(task);
-        } else {
-            // Create a timer thread to enqueue the task at the scheduled time
-            std::thread([this, task, scheduledTime]() {
-                auto now = std::chrono::system_clock::now();
-                if (now < scheduledTime) {
-                    std::this_thread::sleep_until(scheduledTime);
-                }
-                threadPool_.enqueue(task);
-            }).detach();
+        return *this;
+    }
+    
+    SmallFunction(const SmallFunction&) = delete;
+    SmallFunction& operator=(const SmallFunction&) = delete;
+    
+    ~SmallFunction() { reset(); }
+    
+    void reset() {
+        if (relocate_) {
+            relocate_(nullptr, storage_);
+            invoke_ = nullptr;
+            relocate_ = nullptr;
         }
-        
-        return task;
     }
     
-    // Cancel a task by name
-    bool cancelTask(const std::string& name) {
-        std::unique_lock<std::mutex> lock(tasksMutex_);
+    explicit operator bool() const { return invoke_ != nullptr; }
+    
+    R operator()(Args... args) { return invoke_(storage_, std::forward<Args>(args)...); }
+};
+
+// Handle to a lightweight task: slot index plus the generation of the slot's
+// use it refers to. Once the task has finished the slot's generation moves on,
+// so a stale handle simply reads as done.
+struct TaskId {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+};
+
+// Pooled, fire-and-forget task submitted with TaskScheduler::submit.
+// The generation and the state share one atomic word, so claiming, cancelling
+// and recycling a slot can never act on a later use of the same slot.
+class LightTask final : public PoolItem {
+private:
+    friend class LightTaskPool;
+    friend class TaskScheduler;
+    
+    enum State : uint64_t { FREE, PENDING, RUNNING, CANCELLED };
+    static constexpr int STATE_BITS = 8;
+    
+    std::atomic<uint64_t> word_{0};   // generation << STATE_BITS | State
+    SmallFunction<void()> work_;
+    uint32_t index_ = 0;
+    LightTask* nextFree_ = nullptr;
+    
+    static uint64_t pack(uint64_t generation, State state) { return generation << STATE_BITS | state; }
+    
+public:
+    uint32_t generation() const { return static_cast<uint32_t>(word_.load(std::memory_order_acquire) >> STATE_BITS); }
+    
+    RunOutcome run() override;
+    
+    bool cancelQueued() override {
+        uint64_t generation = word_.load(std::memory_order_acquire) >> STATE_BITS;
+        uint64_t expected = pack(generation, PENDING);
+        return word_.compare_exchange_strong(expected, pack(generation, CANCELLED), std::memory_order_acq_rel);
+    }
+};
+
+// Slab of LightTask slots, grown a chunk at a time and never shrunk. Every
+// thread keeps a private free list and trades fixed-size batches with a shared
+// list, so in steady state acquiring and releasing a slot takes no lock and
+// allocates nothing.
+class LightTaskPool {
+private:
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t MAX_CHUNKS = 4096;
+    static constexpr size_t BATCH = 128;
+    
+    struct LocalCache {
+        LightTask* head = nullptr;
+        size_t count = 0;
         
-        auto it = tasks_.find(name);
-        if (it == tasks_.end()) {
-            throw TaskNotFoundException("Task '" + name + "' not found");
+        ~LocalCache() {
+            if (head) {
+                instance().giveBack(head, count);
+            }
         }
-        
-        auto task = it->second;
-        if (task->isCancellable() && task->getStatus() == TaskStatus::PENDING) {
-            task->cancel();
-            stats_.cancelledTasks++;
-            return true;
+    };
+    
+    std::array<std::atomic<LightTask*>, MAX_CHUNKS> chunks_{};
+    size_t chunkCount_ = 0;
+    std::mutex mutex_;
+    LightTask* shared_ = nullptr;
+    size_t sharedCount_ = 0;
+    
+    static LocalCache& local() {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+    
+    // Link a list of `count` slots into the shared list
+    void giveBack(LightTask* head, size_t count) {
+        LightTask* tail = head;
+        while (tail->nextFree_) {
+            tail = tail->nextFree_;
         }
-        
-        return false;
+        std::unique_lock<std::mutex> lock(mutex_);
+        tail->nextFree_ = shared_;
+        shared_ = head;
+        sharedCount_ += count;
     }
     
-    // Get task status by name
-    TaskStatus getTaskStatus(const std::string& name) const {
-        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
-        
-        auto it = tasks_.find(name);
-        if (it == tasks_.end()) {
-            throw TaskNotFoundException("Task '" + name + "' not found");
+    void refill(LocalCache& cache) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!shared_) {
+            if (chunkCount_ == MAX_CHUNKS) {
+                throw TaskSchedulerException("Too many lightweight tasks in flight");
+            }
+            LightTask* chunk = new LightTask[CHUNK_SIZE];
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                chunk[i].index_ = static_cast<uint32_t>(chunkCount_ * CHUNK_SIZE + i);
+                chunk[i].nextFree_ = i + 1 < CHUNK_SIZE ? &chunk[i + 1] : shared_;
+            }
+            chunks_[chunkCount_++].store(chunk, std::memory_order_release);
+            shared_ = chunk;
+            sharedCount_ += CHUNK_SIZE;
         }
         
-        auto status = it->second->getStatus();
-        
-        // Update statistics if needed
-        if (status == TaskStatus::COMPLETED && 
-            it->second->getStatus() != TaskStatus::COMPLETED) {
-            const_cast<std::atomic<size_t>&>(stats_.completedTasks)++;
-        } else if (status == TaskStatus::FAILED && 
-                  it->second->getStatus() != TaskStatus::FAILED) {
-            const_cast<std::atomic<size_t>&>(stats_.failedTasks)++;
+        while (shared_ && cache.count < BATCH) {
+            LightTask* slot = shared_;
+            shared_ = slot->nextFree_;
+            --sharedCount_;
+            slot->nextFree_ = cache.head;
+            cache.head = slot;
+            ++cache.count;
         }
-        
-        return status;
     }
     
-    // Get task result by name (type-erased version)
-    std::any getTaskResultAsAny(const std::string& name) const {
-        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
-        
-        auto it = tasks_.find(name);
-        if (it == tasks_.end()) {
-            throw TaskNotFoundException("Task '" + name + "' not found");
-        }
-        
-        return it->second->getResultAsAny();
+public:
+    static LightTaskPool& instance() {
+        static LightTaskPool pool;
+        return pool;
     }
     
-    // Get task result by name (typed version)
-    template<typename ResultType>
-    TaskResult<ResultType> getTaskResult(const std::string& name) const {
-        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
-        
-        auto it = tasks_.find(name);
-        if (it == tasks_.end()) {
-            throw TaskNotFoundException("Task '" + name + "' not found");
-        }
-        
-        auto typedTask = std::dynamic_pointer_cast<Task<ResultType>>(it->second);
-        if (!typedTask) {
-            throw TaskSchedulerException("Task result type mismatch");
+    ~LightTaskPool() {
+        for (size_t i = 0; i < chunkCount_; ++i) {
+            delete[] chunks_[i].load(std::memory_order_relaxed);
         }
-        
-        return typedTask->getResult();
     }
     
-    // Wait for a task to complete
-    template<typename ResultType>
-    ResultType waitForTask(const std::string& name) {
-        while (true) {
-            try {
-                auto status = getTaskStatus(name);
-                if (status == TaskStatus::COMPLETED) {
-                    return getTaskResult<ResultType>(name).getResult();
-                } else if (status == TaskStatus::FAILED) {
-                    getTaskResult<ResultType>(name).getResult(); // This will throw the original exception
-                } else if (status == TaskStatus::CANCELLED) {
-                    throw TaskSchedulerException("Task was cancelled");
-                }
-            } catch (const TaskNotFoundException&) {
-                throw;
-            }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    LightTask* acquire() {
+        LocalCache& cache = local();
+        if (!cache.head) {
+            refill(cache);
         }
+        LightTask* slot = cache.head;
+        cache.head = slot->nextFree_;
+        --cache.count;
+        slot->nextFree_ = nullptr;
+        return slot;
     }
     
-    // Wait for all tasks to complete
+    void release(LightTask* slot) {
+        LocalCache& cache = local();
+        slot->nextFree_ = cache.head;
+        cache.head = slot;
+        if (++cache.count < 2 * BATCH) {
+            return;
+        }
+        
+        // Hand a batch back so threads that only submit or only run tasks stay balanced
+        LightTask* batch = cache.head;
+        LightTask* tail = batch;
+        for (size_t i = 1; i < BATCH; ++i) {
+            tail = tail->nextFree_;
+        }
+        cache.head = tail->nextFree_;
+        cache.count -= BATCH;
+        tail->nextFree_ = nullptr;
+        giveBack(batch, BATCH);
+    }
+    
+    // The slot with this index, or null if no chunk holding it was allocated
+    LightTask* find(uint32_t index) {
+        if (index / CHUNK_SIZE >= MAX_CHUNKS) {
+            return nullptr;
+        }
+        LightTask* chunk = chunks_[index / CHUNK_SIZE].load(std::memory_order_acquire);
+        return chunk ? &chunk[index % CHUNK_SIZE] : nullptr;
+    }
+};
+
+// Work must not throw: like a std::thread body, an escaping exception terminates
+inline RunOutcome LightTask::run() {
+    uint64_t generation = word_.load(std::memory_order_acquire) >> STATE_BITS;
+    uint64_t expected = pack(generation, PENDING);
+    bool started = word_.compare_exchange_strong(expected, pack(generation, RUNNING), std::memory_order_acq_rel);
+    if (started) {
+        work_();
+    }
+    work_.reset();
+    word_.store(pack(static_cast<uint32_t>(generation + 1), FREE), std::memory_order_release);
+    LightTaskPool::instance().release(this);
+    return started ? RunOutcome::COMPLETED : RunOutcome::SKIPPED;
+}
+
+// CPUs the process may run on, grouped by NUMA node. On Linux the nodes
+// come from /sys/devices/system/node and are restricted to the process's
+// affinity mask; elsewhere (or without sysfs) everything is one node.
+class CpuTopology {
+private:
+    std::vector<std::vector<int>> nodes_;
+    
+    // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        size_t position = 0;
+        while (position < list.size()) {
+            size_t end = list.find(',', position);
+            if (end == std::string::npos) end = list.size();
+            std::string range = list.substr(position, end - position);
+            position = end + 1;
+            if (range.empty() || !std::isdigit(static_cast<unsigned char>(range[0]))) continue;
+            
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+    
+public:
+    explicit CpuTopology(std::vector<std::vector<int>> nodes) : nodes_(std::move(nodes)) {}
+    
+    static CpuTopology detect() {
+        std::vector<std::vector<int>> nodes;
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        for (int node = 0;; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) break;
+            std::string list;
+            std::getline(file, list);
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(list)) {
+                if (!haveMask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        }
+        if (nodes.empty() && haveMask) {
+            nodes.emplace_back();
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) nodes.back().push_back(cpu);
+            }
+        }
+#endif
+        if (nodes.empty()) {
+            nodes.emplace_back();
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+                nodes.back().push_back(static_cast<int>(cpu));
+            }
+        }
+        return CpuTopology(std::move(nodes));
+    }
+    
+    size_t nodeCount() const {
+        return nodes_.size();
+    }
+    
+    const std::vector<int>& cpus(size_t node) const {
+        return nodes_[node];
+    }
+    
+    size_t cpuCount() const {
+        size_t count = 0;
+        for (const auto& node : nodes_) count += node.size();
+        return count;
+    }
+};
+
+// Confine the calling thread to `cpus`; best effort, false where unsupported
+inline bool pinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// What submitting to a full priority queue does
+enum class OverloadPolicy {
+    BLOCK,        // wait until the queue has room
+    REJECT,       // throw QueueFullException
+    DROP_OLDEST   // cancel the oldest queued task of that priority to make room
+};
+
+// How a ThreadPool places its workers and bounds its queues. The default
+// is the old behaviour: unpinned threads stealing from any other worker,
+// unbounded queues, with low priorities aged so they cannot starve.
+struct ThreadPoolConfig {
+    size_t threads = std::thread::hardware_concurrency();
+    
+    // Pin each worker to one CPU. Workers fill the CPUs node by node, so a
+    // pool smaller than the machine stays on as few nodes as possible.
+    bool pinThreads = false;
+    
+    // Group workers by NUMA node: each worker is kept on its node (pinned
+    // to its CPU, or confined to the node's CPUs), allocates its queues
+    // there, steals from workers on its own node before crossing to
+    // another, and tasks from outside the pool go to workers on the
+    // submitter's current node.
+    bool numaAware = false;
+    
+    // Time every task's queue wait, execution and end-to-end latency into
+    // the per-worker histograms read by getMetrics(). This costs three clock
+    // reads per task (around 100ns); the per-worker outcome counters are
+    // kept either way.
+    bool measureLatency = true;
+    
+    // A worker serves its highest-priority lane first, but a lower lane
+    // that has waited gains a level of priority per agingInterval, so a
+    // stream of HIGH tasks cannot starve LOW ones. Zero turns aging off.
+    std::chrono::steady_clock::duration agingInterval = std::chrono::milliseconds(100);
+    
+    // Queued (not yet started) tasks allowed per priority, indexed by
+    // Priority, and what admitting one more does when a queue is full. The
+    // bound is soft: concurrent submitters may each push a queue one over.
+    std::array<size_t, 4> queueCapacity{{std::numeric_limits<size_t>::max(), std::numeric_limits<size_t>::max(),
+                                          std::numeric_limits<size_t>::max(), std::numeric_limits<size_t>::max()}};
+    OverloadPolicy overload = OverloadPolicy::BLOCK;
+};
+
+// Lock-free snapshot of a ThreadPool's counters and latency histograms
+struct PoolMetrics {
+    struct WorkerCounters {
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint64_t skipped = 0;   // cancelled before they started
+        size_t node = 0;
+    };
+    
+    std::vector<WorkerCounters> workers;
+    // Indexed by Priority. Queue wait runs from enqueue to start, execution
+    // from start to finish, and end-to-end from when the task was due (its
+    // scheduled time, for scheduler tasks) to finish.
+    std::array<LatencyHistogram::Snapshot, 4> queueWait;
+    std::array<LatencyHistogram::Snapshot, 4> execution;
+    std::array<LatencyHistogram::Snapshot, 4> endToEnd;
+    size_t queued = 0;
+    size_t active = 0;
+    uint64_t dropped = 0;   // cancelled by OverloadPolicy::DROP_OLDEST
+    
+    uint64_t completed() const {
+        uint64_t total = 0;
+        for (const auto& worker : workers) total += worker.completed;
+        return total;
+    }
+    
+    uint64_t failed() const {
+        uint64_t total = 0;
+        for (const auto& worker : workers) total += worker.failed;
+        return total;
+    }
+};
+
+// Thread pool for executing tasks.
+// Every worker owns one work-stealing deque per priority level. A task
+// enqueued from one of the pool's own workers goes straight onto that
+// worker's deque; tasks from other threads are spread round-robin over small
+// per-worker inboxes (so submitters contend on a fraction of the workers, not
+// on one queue) that their owner moves onto its deques. A worker runs its own
+// highest-priority task first and otherwise steals, highest priority first,
+// from randomly chosen victims. Priorities are therefore honoured per worker
+// rather than globally; idle workers sleep on a condition variable.
+// Queues hold intrusive PoolItems, so enqueueing one allocates nothing once
+// the queues have grown to their working size.
+class ThreadPool {
+private:
+    static constexpr size_t PRIORITY_LEVELS = 4;
+    static constexpr int IDLE_SPINS = 64;
+    
+    // Adapter that puts a shared TaskBase into the queues
+    class SharedTaskItem final : public PoolItem {
+    private:
+        std::shared_ptr<TaskBase> task_;
+        
+    public:
+        explicit SharedTaskItem(std::shared_ptr<TaskBase> task) : task_(std::move(task)) {
+            priority = task_->getPriority();
+        }
+        
+        bool cancelQueued() override {
+            if (!task_->isCancellable() || task_->getStatus() != TaskStatus::PENDING) {
+                return false;
+            }
+            task_->cancel();
+            return task_->getStatus() == TaskStatus::CANCELLED;
+        }
+        
+        RunOutcome run() override {
+            task_->execute();
+            TaskStatus status = task_->getStatus();
+            delete this;
+            if (status == TaskStatus::FAILED) return RunOutcome::FAILED;
+            if (status == TaskStatus::CANCELLED) return RunOutcome::SKIPPED;
+            return RunOutcome::COMPLETED;
+        }
+        
+        // The task's scheduled time, moved onto the steady clock through an
+        // offset taken once, so timing a task reads no extra clocks
+        std::chrono::steady_clock::time_point dueAt() const override {
+            static const auto offset = std::chrono::system_clock::now().time_since_epoch() -
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::steady_clock::now().time_since_epoch());
+            return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                task_->getScheduledTime().time_since_epoch() - offset));
+        }
+    };
+    
+    // One priority's share of an inbox, first in first out. A vector with a
+    // read position rather than a deque, so a warm inbox never allocates.
+    struct InboxLane {
+        std::vector<PoolItem*> items;
+        size_t head = 0;
+        
+        bool empty() const {
+            return head == items.size();
+        }
+        
+        PoolItem* take() {
+            PoolItem* item = items[head++];
+            if (empty()) {
+                items.clear();
+                head = 0;
+            }
+            return item;
+        }
+    };
+    
+    struct Worker {
+        std::array<WorkStealingDeque<PoolItem>, PRIORITY_LEVELS> lanes;
+        std::mutex inboxMutex;
+        std::array<InboxLane, PRIORITY_LEVELS> inbox;   // handed out by priority, then oldest first
+        std::vector<PoolItem*> drained;   // reused buffer for drainInbox
+        std::atomic<bool> hasInbox{false};
+        uint64_t randomState;
+        std::vector<size_t> nearVictims;   // same NUMA node (everyone, without numaAware)
+        std::vector<size_t> farVictims;
+        
+        // Metrics shard: written only by this worker, read by getMetrics()
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> failed{0};
+        std::atomic<uint64_t> skipped{0};
+        std::array<LatencyHistogram, PRIORITY_LEVELS> queueWait;
+        std::array<LatencyHistogram, PRIORITY_LEVELS> execution;
+        std::array<LatencyHistogram, PRIORITY_LEVELS> endToEnd;
+        
+        // Since when each lower lane has waited behind a higher one (epoch: not waiting)
+        std::array<std::chrono::steady_clock::time_point, PRIORITY_LEVELS> waitingSince{};
+    };
+    
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+    std::vector<size_t> allWorkers_;
+    std::vector<size_t> workerNode_;                 // worker -> topology node
+    std::vector<std::vector<size_t>> nodeWorkers_;   // topology node -> its workers
+    std::vector<int> cpuNode_;                      // cpu -> topology node, -1 if unused
+    bool numaAware_ = false;
+    bool measureLatency_ = true;
+    std::chrono::steady_clock::duration agingInterval_{};
+    
+    // Admission: queued tasks per priority against their capacity
+    std::array<std::atomic<size_t>, PRIORITY_LEVELS> queued_{};
+    std::array<size_t, PRIORITY_LEVELS> capacity_{};
+    OverloadPolicy overload_ = OverloadPolicy::BLOCK;
+    std::mutex spaceMutex_;
+    std::condition_variable spaceCondition_;
+    std::atomic<size_t> spaceWaiters_{0};
+    std::atomic<uint64_t> dropped_{0};
+    
+    std::mutex startMutex_;
+    std::condition_variable started_;
+    size_t ready_ = 0;
+    std::mutex sleepMutex_;
+    std::condition_variable condition_;
+    std::atomic<size_t> sleepers_{0};
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> nextInbox_{0};
+    std::atomic<bool> stop_;
+    std::atomic<size_t> activeThreads_;
+    size_t maxThreads_;
+    
+    // Identity of the calling thread when it is one of this pool's workers
+    static const ThreadPool*& currentPool() {
+        static thread_local const ThreadPool* pool = nullptr;
+        return pool;
+    }
+    static size_t& currentWorker() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+    
+    static size_t lane(Priority priority) {
+        return static_cast<size_t>(priority);
+    }
+    
+    // pending_ is raised before sleepers_ is read and a worker raises
+    // sleepers_ before re-checking pending_, so one of them sees the other
+    void wakeWorkers(size_t count) {
+        size_t sleeping = sleepers_;
+        if (sleeping == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        if (count >= sleeping) {
+            condition_.notify_all();
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                condition_.notify_one();
+            }
+        }
+    }
+    
+    // Move the worker's inbox onto its deques, keeping the order in which the
+    // inbox would have handed the tasks out (the owner pops newest first)
+    void drainInbox(Worker& worker) {
+        if (!worker.hasInbox.load(std::memory_order_acquire)) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(worker.inboxMutex);
+            for (size_t level = PRIORITY_LEVELS; level-- > 0;) {
+                InboxLane& inbox = worker.inbox[level];
+                worker.drained.insert(worker.drained.end(), inbox.items.begin() + static_cast<std::ptrdiff_t>(inbox.head),
+                                      inbox.items.end());
+                inbox.items.clear();
+                inbox.head = 0;
+            }
+            worker.hasInbox.store(false, std::memory_order_relaxed);
+        }
+        for (auto it = worker.drained.rbegin(); it != worker.drained.rend(); ++it) {
+            worker.lanes[lane((*it)->priority)].push(*it);
+        }
+        worker.drained.clear();
+    }
+    
+    // Take one task from a victim's inbox without waiting on its lock
+    static PoolItem* stealFromInbox(Worker& victim) {
+        if (!victim.hasInbox.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        std::unique_lock<std::mutex> lock(victim.inboxMutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return nullptr;
+        }
+        for (size_t level = PRIORITY_LEVELS; level-- > 0;) {
+            if (!victim.inbox[level].empty()) {
+                return takeFromInbox(victim, level);
+            }
+        }
+        return nullptr;
+    }
+    
+    // Call with the worker's inboxMutex held and that lane non-empty
+    static PoolItem* takeFromInbox(Worker& worker, size_t level) {
+        PoolItem* item = worker.inbox[level].take();
+        bool more = std::any_of(worker.inbox.begin(), worker.inbox.end(),
+                                [](const InboxLane& inbox) { return !inbox.empty(); });
+        worker.hasInbox.store(more, std::memory_order_relaxed);
+        return item;
+    }
+    
+    PoolItem* stealFrom(const std::vector<size_t>& victims, size_t start) {
+        if (victims.empty()) {
+            return nullptr;
+        }
+        for (size_t level = PRIORITY_LEVELS; level-- > 0;) {
+            for (size_t i = 0; i < victims.size(); ++i) {
+                size_t victim = victims[(start + i) % victims.size()];
+                if (PoolItem* item = queues_[victim]->lanes[level].steal()) {
+                    return item;
+                }
+            }
+        }
+        for (size_t i = 0; i < victims.size(); ++i) {
+            if (PoolItem* item = stealFromInbox(*queues_[victims[(start + i) % victims.size()]])) {
+                return item;
+            }
+        }
+        return nullptr;
+    }
+    
+    // A lower lane whose wait has aged it up to the highest non-empty one
+    // gives up its oldest task; otherwise the highest lane gives its newest
+    PoolItem* takeOwn(Worker& worker) {
+        size_t top = PRIORITY_LEVELS;
+        for (size_t level = PRIORITY_LEVELS; level-- > 0;) {
+            if (!worker.lanes[level].empty()) {
+                top = level;
+                break;
+            }
+        }
+        if (top == PRIORITY_LEVELS) {
+            return nullptr;
+        }
+        
+        if (agingInterval_ > std::chrono::steady_clock::duration::zero()) {
+            std::chrono::steady_clock::time_point now;
+            for (size_t level = 0; level < top; ++level) {
+                auto& since = worker.waitingSince[level];
+                if (worker.lanes[level].empty()) {
+                    since = {};
+                    continue;
+                }
+                if (now == std::chrono::steady_clock::time_point{}) {
+                    now = std::chrono::steady_clock::now();
+                }
+                if (since == std::chrono::steady_clock::time_point{}) {
+                    since = now;
+                } else if (now - since >= agingInterval_ * static_cast<int64_t>(top - level)) {
+                    if (PoolItem* item = worker.lanes[level].steal()) {
+                        since = now;   // the next one waits its turn again
+                        return item;
+                    }
+                }
+            }
+        }
+        
+        for (size_t level = top + 1; level-- > 0;) {
+            if (PoolItem* item = worker.lanes[level].pop()) {
+                worker.waitingSince[level] = {};
+                return item;
+            }
+        }
+        return nullptr;
+    }
+    
+    PoolItem* findTask(size_t self) {
+        Worker& worker = *queues_[self];
+        drainInbox(worker);
+        
+        if (PoolItem* item = takeOwn(worker)) {
+            return item;
+        }
+        
+        // Steal, from this node before crossing to another: start at a
+        // random victim so thieves spread out
+        worker.randomState ^= worker.randomState << 13;
+        worker.randomState ^= worker.randomState >> 7;
+        worker.randomState ^= worker.randomState << 17;
+        size_t start = static_cast<size_t>(worker.randomState);
+        if (PoolItem* item = stealFrom(worker.nearVictims, start)) {
+            return item;
+        }
+        return stealFrom(worker.farVictims, start);
+    }
+    
+    // Workers that take tasks submitted from outside the pool: those on the
+    // submitter's current node when placement is NUMA-aware
+    const std::vector<size_t>& submitTargets() const {
+#if defined(__linux__)
+        if (numaAware_ && nodeWorkers_.size() > 1) {
+            int cpu = sched_getcpu();
+            if (cpu >= 0 && static_cast<size_t>(cpu) < cpuNode_.size() && cpuNode_[cpu] >= 0 &&
+                !nodeWorkers_[cpuNode_[cpu]].empty()) {
+                return nodeWorkers_[cpuNode_[cpu]];
+            }
+        }
+#endif
+        return allWorkers_;
+    }
+    
+    // Runs on the new worker thread: pin it, then allocate its queues there
+    // (first touch places them on the worker's node) and wait for the others
+    void startWorker(size_t self, std::vector<int> cpus, std::vector<size_t> near, std::vector<size_t> far) {
+        if (!cpus.empty()) {
+            pinCurrentThread(cpus);
+        }
+        auto worker = std::make_unique<Worker>();
+        worker->randomState = 0x9E3779B97F4A7C15ull * (self + 1);
+        worker->nearVictims = std::move(near);
+        worker->farVictims = std::move(far);
+        
+        std::unique_lock<std::mutex> lock(startMutex_);
+        queues_[self] = std::move(worker);
+        ++ready_;
+        started_.notify_all();
+        started_.wait(lock, [this] { return ready_ == queues_.size(); });
+    }
+    
+    // Room for `count` more, or an empty queue (so an oversized batch still goes)
+    bool fits(size_t level, size_t count) const {
+        size_t queued = queued_[level];
+        return queued == 0 || queued + count <= capacity_[level];
+    }
+    
+    // queued_ drops before spaceWaiters_ is read and a blocked submitter
+    // raises spaceWaiters_ before re-checking queued_, as with pending_
+    void leaveQueue(Priority priority) {
+        --queued_[lane(priority)];
+        if (spaceWaiters_ > 0) {
+            std::unique_lock<std::mutex> lock(spaceMutex_);
+            spaceCondition_.notify_all();
+        }
+    }
+    
+    // Oldest task of one priority: deques hold what workers took from their
+    // inboxes earlier, so they are searched before the inboxes
+    PoolItem* takeOldest(size_t level) {
+        for (auto& worker : queues_) {
+            if (PoolItem* item = worker->lanes[level].steal()) {
+                return item;
+            }
+        }
+        for (auto& worker : queues_) {
+            std::unique_lock<std::mutex> lock(worker->inboxMutex);
+            if (!worker->inbox[level].empty()) {
+                return takeFromInbox(*worker, level);
+            }
+        }
+        return nullptr;
+    }
+    
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    
+    // Run one item, counting its outcome (and timing it) in the worker's shard
+    void runItem(Worker& worker, PoolItem* item) {
+        if (!measureLatency_) {
+            countOutcome(worker, item->run());
+            return;
+        }
+        size_t level = lane(item->priority);
+        auto due = item->dueAt();
+        auto enqueued = item->enqueuedAt;
+        auto start = std::chrono::steady_clock::now();
+        RunOutcome outcome = item->run();   // the item is gone after this
+        auto end = std::chrono::steady_clock::now();
+        countOutcome(worker, outcome);
+        if (outcome != RunOutcome::SKIPPED) {
+            worker.queueWait[level].record(start - enqueued);
+            worker.execution[level].record(end - start);
+            worker.endToEnd[level].record(end - std::min(due, enqueued));
+        }
+    }
+    
+    static void countOutcome(Worker& worker, RunOutcome outcome) {
+        switch (outcome) {
+            case RunOutcome::COMPLETED: bump(worker.completed); break;
+            case RunOutcome::FAILED: bump(worker.failed); break;
+            case RunOutcome::SKIPPED: bump(worker.skipped); break;
+        }
+    }
+    
+    void workerLoop(size_t self, std::vector<int> cpus, std::vector<size_t> near, std::vector<size_t> far) {
+        startWorker(self, std::move(cpus), std::move(near), std::move(far));
+        currentPool() = this;
+        currentWorker() = self;
+        
+        int idle = 0;
+        while (true) {
+            if (PoolItem* item = findTask(self)) {
+                leaveQueue(item->priority);
+                --pending_;
+                idle = 0;
+                ++activeThreads_;
+                runItem(*queues_[self], item);
+                --activeThreads_;
+                continue;
+            }
+            
+            // A task can be counted in pending_ while a thief holds it
+            // between its deque and pending_ decrement; spin briefly first
+            if (++idle < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+            idle = 0;
+            
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            ++sleepers_;
+            condition_.wait(lock, [this] { return stop_ || pending_ > 0; });
+            --sleepers_;
+            if (stop_ && pending_ == 0) {
+                return;
+            }
+        }
+    }
+    
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency())
+        : ThreadPool(ThreadPoolConfig{threads}) {}
+    
+    explicit ThreadPool(const ThreadPoolConfig& config,
+                        const CpuTopology& topology = CpuTopology::detect())
+        : stop_(false), activeThreads_(0), maxThreads_(config.threads) {
+        
+        numaAware_ = config.numaAware;
+        measureLatency_ = config.measureLatency;
+        agingInterval_ = config.agingInterval;
+        capacity_ = config.queueCapacity;
+        overload_ = config.overload;
+        size_t threads = config.threads;
+        queues_.resize(threads);
+        
+        // Worker i takes the i-th CPU counting node by node
+        std::vector<std::pair<int, size_t>> cpus;   // (cpu, node)
+        nodeWorkers_.resize(topology.nodeCount());
+        for (size_t node = 0; node < topology.nodeCount(); ++node) {
+            for (int cpu : topology.cpus(node)) {
+                cpus.emplace_back(cpu, node);
+                if (static_cast<size_t>(cpu) >= cpuNode_.size()) cpuNode_.resize(cpu + 1, -1);
+                cpuNode_[cpu] = static_cast<int>(node);
+            }
+        }
+        workerNode_.resize(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workerNode_[i] = cpus[i % cpus.size()].second;
+            nodeWorkers_[workerNode_[i]].push_back(i);
+            allWorkers_.push_back(i);
+        }
+        
+        for (size_t i = 0; i < threads; ++i) {
+            std::vector<int> pinned;
+            if (config.pinThreads) {
+                pinned.push_back(cpus[i % cpus.size()].first);
+            } else if (config.numaAware) {
+                pinned = topology.cpus(workerNode_[i]);
+            }
+            
+            std::vector<size_t> near, far;
+            for (size_t other = 0; other < threads; ++other) {
+                if (other == i) continue;
+                (!numaAware_ || workerNode_[other] == workerNode_[i] ? near : far).push_back(other);
+            }
+            workers_.emplace_back([this, i, pinned = std::move(pinned), near = std::move(near), far = std::move(far)]() mutable {
+                workerLoop(i, std::move(pinned), std::move(near), std::move(far));
+            });
+        }
+        
+        std::unique_lock<std::mutex> lock(startMutex_);
+        started_.wait(lock, [this] { return ready_ == queues_.size(); });
+    }
+    
+    // Runs everything still queued before the workers exit
+    ~ThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            stop_ = true;
+        }
+        
+        condition_.notify_all();
+        {
+            std::unique_lock<std::mutex> lock(spaceMutex_);
+            spaceCondition_.notify_all();
+        }
+        
+        for (std::thread& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+    
+    void enqueue(std::shared_ptr<TaskBase> task) {
+        auto item = std::make_unique<SharedTaskItem>(std::move(task));
+        enqueue(item.get());
+        item.release();
+    }
+    
+    // Queue an item; it is run (and releases itself) exactly once
+    void enqueue(PoolItem* item) {
+        // Workers may still enqueue (e.g. dependent tasks) while the pool drains
+        if (stop_ && currentPool() != this) {
+            throw TaskSchedulerException("ThreadPool has been stopped");
+        }
+        if (queues_.empty()) {
+            throw TaskSchedulerException("ThreadPool has no worker threads");
+        }
+        
+        if (measureLatency_) {
+            item->enqueuedAt = std::chrono::steady_clock::now();
+        }
+        ++queued_[lane(item->priority)];
+        ++pending_;
+        if (currentPool() == this) {
+            queues_[currentWorker()]->lanes[lane(item->priority)].push(item);
+        } else {
+            const std::vector<size_t>& targets = submitTargets();
+            size_t sequence = nextInbox_++;
+            Worker& worker = *queues_[targets[sequence % targets.size()]];
+            std::unique_lock<std::mutex> lock(worker.inboxMutex);
+            worker.inbox[lane(item->priority)].items.push_back(item);
+            worker.hasInbox.store(true, std::memory_order_release);
+        }
+        
+        wakeWorkers(1);
+    }
+    
+    // Queue a whole batch: one pending_ update, each inbox locked once, and
+    // as many sleeping workers woken as there are items (at most all of them)
+    void enqueueBatch(const std::vector<PoolItem*>& items) {
+        if (stop_ && currentPool() != this) {
+            throw TaskSchedulerException("ThreadPool has been stopped");
+        }
+        if (queues_.empty()) {
+            throw TaskSchedulerException("ThreadPool has no worker threads");
+        }
+        if (items.empty()) {
+            return;
+        }
+        
+        auto now = measureLatency_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+        for (PoolItem* item : items) {
+            item->enqueuedAt = now;
+            ++queued_[lane(item->priority)];
+        }
+        pending_ += items.size();
+        if (currentPool() == this) {
+            // Idle workers steal from here
+            Worker& worker = *queues_[currentWorker()];
+            for (PoolItem* item : items) {
+                worker.lanes[lane(item->priority)].push(item);
+            }
+        } else {
+            // Deal the items out exactly as one-by-one enqueues would have
+            const std::vector<size_t>& targets = submitTargets();
+            size_t first = nextInbox_.fetch_add(items.size());
+            size_t workers = targets.size();
+            for (size_t offset = 0; offset < std::min(workers, items.size()); ++offset) {
+                Worker& worker = *queues_[targets[(first + offset) % workers]];
+                std::unique_lock<std::mutex> lock(worker.inboxMutex);
+                for (size_t i = offset; i < items.size(); i += workers) {
+                    worker.inbox[lane(items[i]->priority)].items.push_back(items[i]);
+                }
+                worker.hasInbox.store(true, std::memory_order_release);
+            }
+        }
+        wakeWorkers(items.size());
+    }
+    
+    template<typename TaskType>
+    void enqueueBatch(const std::vector<std::shared_ptr<TaskType>>& tasks) {
+        std::vector<std::unique_ptr<SharedTaskItem>> owned;
+        std::vector<PoolItem*> items;
+        owned.reserve(tasks.size());
+        items.reserve(tasks.size());
+        for (const auto& task : tasks) {
+            owned.push_back(std::make_unique<SharedTaskItem>(task));
+            items.push_back(owned.back().get());
+        }
+        enqueueBatch(items);
+        for (auto& item : owned) {
+            item.release();
+        }
+    }
+    
+    // Gate for new work of `priority` (count tasks of it), applied by
+    // TaskScheduler before it enqueues: waits, refuses or drops the oldest
+    // queued tasks of that priority, per the overload policy, while the
+    // queue is full. With mayBlock false a full queue just returns false.
+    // Work submitted from the pool's own workers, and work the scheduler
+    // re-enqueues itself (timers, dependents, coroutines), is always let in,
+    // so a full queue cannot deadlock the workers that drain it.
+    bool admit(Priority priority, size_t count = 1, bool mayBlock = true) {
+        size_t level = lane(priority);
+        if (currentPool() == this || fits(level, count)) {
+            return true;
+        }
+        if (!mayBlock || overload_ == OverloadPolicy::REJECT) {
+            return false;
+        }
+        
+        if (overload_ == OverloadPolicy::DROP_OLDEST) {
+            for (size_t dropped = 0; dropped < count && !fits(level, count); ++dropped) {
+                PoolItem* victim = takeOldest(level);
+                if (!victim) {
+                    break;   // all taken by workers meanwhile
+                }
+                leaveQueue(victim->priority);
+                --pending_;
+                if (victim->cancelQueued()) {
+                    ++dropped_;
+                }
+                victim->run();   // releases it; one that cannot be cancelled runs here instead
+            }
+            return true;
+        }
+        
+        std::unique_lock<std::mutex> lock(spaceMutex_);
+        ++spaceWaiters_;
+        spaceCondition_.wait(lock, [this, level, count] { return stop_ || fits(level, count); });
+        --spaceWaiters_;
+        return true;
+    }
+    
+    size_t getQueueSize() const {
+        return pending_;
+    }
+    
+    size_t getActiveThreadCount() const {
+        return activeThreads_;
+    }
+    
+    size_t getMaxThreadCount() const {
+        return maxThreads_;
+    }
+    
+    // Read without any lock: each worker's shard is summed as it stands
+    PoolMetrics getMetrics() const {
+        PoolMetrics metrics;
+        metrics.workers.reserve(queues_.size());
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            const Worker& worker = *queues_[i];
+            metrics.workers.push_back({worker.completed.load(std::memory_order_relaxed),
+                                       worker.failed.load(std::memory_order_relaxed),
+                                       worker.skipped.load(std::memory_order_relaxed),
+                                       workerNode_[i]});
+            for (size_t level = 0; level < PRIORITY_LEVELS; ++level) {
+                worker.queueWait[level].snapshotInto(metrics.queueWait[level]);
+                worker.execution[level].snapshotInto(metrics.execution[level]);
+                worker.endToEnd[level].snapshotInto(metrics.endToEnd[level]);
+            }
+        }
+        metrics.queued = pending_;
+        metrics.active = activeThreads_;
+        metrics.dropped = dropped_;
+        return metrics;
+    }
+    
+    // Topology node each worker was placed on
+    size_t getWorkerNode(size_t worker) const {
+        return workerNode_.at(worker);
+    }
+};
+
+// Hierarchical timing wheel (Varghese & Lauck) that hands tasks to a
+// callback once their scheduled time has come, all from one timer thread.
+// Four levels of 64 slots cover 64^4 ticks; a timer goes into the level whose
+// span fits its remaining delay and drops down a level each time the level
+// below wraps around. Scheduling and cancelling are O(1). The timer thread
+// sleeps until the next non-empty slot, or indefinitely when nothing is due.
+class TimerWheel {
+public:
+    using Callback = std::function<void(std::shared_ptr<TaskBase>)>;
+    
+private:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int64_t SLOTS = int64_t(1) << SLOT_BITS;
+    static constexpr size_t LEVELS = 4;
+    
+    struct Timer {
+        uint64_t id;
+        int64_t expiry;   // in ticks
+        std::shared_ptr<TaskBase> task;
+    };
+    using Slot = std::list<Timer>;
+    
+    struct Location {
+        Slot* slot;
+        Slot::iterator timer;
+    };
+    
+    Callback onDue_;
+    std::chrono::steady_clock::duration tick_;
+    std::chrono::steady_clock::time_point start_;
+    std::array<std::array<Slot, SLOTS>, LEVELS> wheel_;
+    std::unordered_map<uint64_t, Location> timers_;
+    int64_t current_ = 0;   // last tick processed
+    uint64_t nextId_ = 1;
+    
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stop_ = false;
+    std::thread thread_;
+    
+    int64_t ticksNow() const {
+        return (std::chrono::steady_clock::now() - start_) / tick_;
+    }
+    
+    // Slot for a timer relative to current_, for the level whose span fits the delay
+    Slot& slotFor(int64_t expiry) {
+        int64_t delay = expiry - current_;
+        for (size_t level = 0; level < LEVELS; ++level) {
+            int shift = SLOT_BITS * static_cast<int>(level);
+            if (delay < (SLOTS << shift)) {
+                return wheel_[level][(expiry >> shift) & (SLOTS - 1)];
+            }
+        }
+        // Beyond the wheel: park in the farthest top-level slot and re-place on cascade
+        int shift = SLOT_BITS * static_cast<int>(LEVELS - 1);
+        return wheel_[LEVELS - 1][((current_ >> shift) + SLOTS - 1) & (SLOTS - 1)];
+    }
+    
+    void place(Slot& from, Slot::iterator timer) {
+        Slot& to = slotFor(timer->expiry);
+        to.splice(to.end(), from, timer);
+        timers_[timer->id] = {&to, timer};
+    }
+    
+    // Process ticks up to and including `target`; returns the timers that fell due
+    std::vector<std::shared_ptr<TaskBase>> advanceTo(int64_t target) {
+        std::vector<std::shared_ptr<TaskBase>> due;
+        if (timers_.empty()) {
+            current_ = std::max(current_, target);
+            return due;
+        }
+        
+        while (current_ < target) {
+            ++current_;
+            // Each level that wrapped around pours its next slot into the levels below
+            for (size_t level = 1; level < LEVELS; ++level) {
+                int shift = SLOT_BITS * static_cast<int>(level);
+                if (current_ & ((int64_t(1) << shift) - 1)) break;
+                Slot& slot = wheel_[level][(current_ >> shift) & (SLOTS - 1)];
+                while (!slot.empty()) {
+                    place(slot, slot.begin());
+                }
+            }
+            
+            Slot& slot = wheel_[0][current_ & (SLOTS - 1)];
+            for (Timer& timer : slot) {
+                due.push_back(std::move(timer.task));
+                timers_.erase(timer.id);
+            }
+            slot.clear();
+        }
+        return due;
+    }
+    
+    // First tick that may need work: a non-empty level-0 slot or the next cascade
+    int64_t nextEventTick() const {
+        for (int64_t tick = current_ + 1;; ++tick) {
+            if ((tick & (SLOTS - 1)) == 0 || !wheel_[0][tick & (SLOTS - 1)].empty()) {
+                return tick;
+            }
+        }
+    }
+    
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            auto due = advanceTo(ticksNow());
+            if (!due.empty()) {
+                lock.unlock();
+                for (auto& task : due) {
+                    onDue_(std::move(task));
+                }
+                lock.lock();
+                continue;
+            }
+            
+            if (timers_.empty()) {
+                condition_.wait(lock);
+            } else {
+                condition_.wait_until(lock, start_ + nextEventTick() * tick_);
+            }
+        }
+    }
+    
+public:
+    explicit TimerWheel(Callback onDue,
+                        std::chrono::steady_clock::duration tick = std::chrono::milliseconds(1))
+        : onDue_(std::move(onDue))
+        , tick_(tick)
+        , start_(std::chrono::steady_clock::now()) {
+        thread_ = std::thread([this] { run(); });
+    }
+    
+    // Timers still pending at destruction are dropped without firing
+    ~TimerWheel() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_one();
+        thread_.join();
+    }
+    
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    
+    // Returns an id for cancel(); a time already past fires on the next tick
+    uint64_t schedule(std::shared_ptr<TaskBase> task, std::chrono::system_clock::time_point when) {
+        auto delay = when - std::chrono::system_clock::now();
+        auto due = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+        // Round up, so a timer never fires before its time
+        int64_t expiry = ((due - start_) + tick_ - std::chrono::steady_clock::duration(1)) / tick_;
+        
+        uint64_t id;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (timers_.empty()) {
+                current_ = std::max(current_, ticksNow());   // nothing placed against the old tick
+            }
+            id = nextId_++;
+            expiry = std::max(expiry, current_ + 1);
+            Slot& slot = slotFor(expiry);
+            slot.push_back({id, expiry, std::move(task)});
+            timers_[id] = {&slot, std::prev(slot.end())};
+        }
+        condition_.notify_one();
+        return id;
+    }
+    
+    // Remove a pending timer; false if it already fired or was cancelled
+    bool cancel(uint64_t id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = timers_.find(id);
+        if (it == timers_.end()) {
+            return false;
+        }
+        it->second.slot->erase(it->second.timer);
+        timers_.erase(it);
+        return true;
+    }
+    
+    size_t size() const {
+        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(mutex_));
+        return timers_.size();
+    }
+};
+
+// Upstream tasks of a dependent task, built with dependsOn(...)
+template<typename... Results>
+struct TaskDependencies {
+    std::tuple<std::shared_ptr<Task<Results>>...> tasks;
+};
+
+template<typename... Results>
+TaskDependencies<Results...> dependsOn(std::shared_ptr<Task<Results>>... tasks) {
+    return {std::make_tuple(std::move(tasks)...)};
+}
+
+// Latch over a set of tasks for fan-out/fan-in. Each task counts itself
+// off through a continuation when it finishes, so wait() sleeps until the
+// count reaches zero instead of polling the tasks. Tasks may be added while
+// earlier ones are finishing, including ones that have already finished.
+class TaskGroup {
+private:
+    struct State {
+        std::atomic<size_t> remaining{0};
+        std::atomic<size_t> failed{0};
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    
+    // Shared with the continuations, which may run after the group is gone
+    std::shared_ptr<State> state_;
+    
+public:
+    TaskGroup() : state_(std::make_shared<State>()) {}
+    
+    void add(const std::shared_ptr<TaskBase>& task) {
+        state_->remaining.fetch_add(1, std::memory_order_relaxed);
+        TaskBase* finished = task.get();   // alive while its continuations run
+        task->whenFinished([state = state_, finished] {
+            if (finished->getStatus() == TaskStatus::FAILED) {
+                state->failed.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        });
+    }
+    
+    template<typename TaskType>
+    void add(const std::vector<std::shared_ptr<TaskType>>& tasks) {
+        for (const auto& task : tasks) {
+            add(task);
+        }
+    }
+    
+    // Block until every task added so far has completed, failed or been cancelled
+    void wait() const {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->done.wait(lock, [this] { return state_->remaining.load(std::memory_order_acquire) == 0; });
+    }
+    
+    // False if tasks were still outstanding when the timeout ran out
+    template<typename Rep, typename Period>
+    bool waitFor(std::chrono::duration<Rep, Period> timeout) const {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        return state_->done.wait_for(lock, timeout, [this] {
+            return state_->remaining.load(std::memory_order_acquire) == 0;
+        });
+    }
+    
+    size_t remaining() const {
+        return state_->remaining.load(std::memory_order_acquire);
+    }
+    
+    size_t failed() const {
+        return state_->failed.load(std::memory_order_acquire);
+    }
+};
+
+#ifdef ADVANCED_TASK_SCHEDULER_COROUTINES
+class TaskScheduler;
+
+// State shared by the promises of scheduler coroutines
+struct CoroutinePromiseBase {
+    TaskScheduler* scheduler = nullptr;     // resumes the coroutine after it suspends
+    std::coroutine_handle<> continuation;   // coroutine awaiting this one, if any
+    std::exception_ptr exception;
+    
+    void unhandled_exception() {
+        exception = std::current_exception();
+    }
+};
+
+template<typename T>
+struct AsyncTaskResult : CoroutinePromiseBase {
+    std::optional<T> value;
+    
+    void return_value(T result) {
+        value.emplace(std::move(result));
+    }
+    
+    T take() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+};
+
+template<>
+struct AsyncTaskResult<void> : CoroutinePromiseBase {
+    void return_void() {}
+    
+    void take() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+// Coroutine that runs on the scheduler's pool threads and can co_await
+// scheduled tasks, other AsyncTasks, scheduler.sleepFor(...) and, where
+// poll() exists, scheduler.readable(fd) / writable(fd):
+//   AsyncTask<int> total(TaskScheduler& scheduler, std::shared_ptr<Task<int>> a) {
+//       int value = co_await a;
+//       co_await scheduler.sleepFor(std::chrono::milliseconds(10));
+//       co_return value + 1;
+//   }
+// It starts when it is co_awaited or handed to TaskScheduler::spawn. While
+// suspended it holds no thread, so a small pool drives many of them. Take
+// parameters by value: the coroutine outlives the call that created it.
+template<typename T = void>
+class AsyncTask {
+public:
+    struct promise_type : AsyncTaskResult<T> {
+        AsyncTask get_return_object() {
+            return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        
+        // Transfers straight back to the awaiting coroutine, if there is one
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                    std::coroutine_handle<> continuation = self.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+    };
+    
+private:
+    std::coroutine_handle<promise_type> handle_;
+    
+    explicit AsyncTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    
+public:
+    AsyncTask(AsyncTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    
+    AsyncTask& operator=(AsyncTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+    
+    ~AsyncTask() {
+        if (handle_) handle_.destroy();
+    }
+    
+    // Runs the task on the awaiting coroutine's thread; the awaiter resumes
+    // with its result once it finishes
+    class Awaiter {
+    private:
+        std::coroutine_handle<promise_type> handle_;
+        
+    public:
+        explicit Awaiter(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+        
+        bool await_ready() const noexcept {
+            return handle_.done();
+        }
+        
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) noexcept {
+            handle_.promise().continuation = awaiting;
+            handle_.promise().scheduler = awaiting.promise().scheduler;
+            return handle_;
+        }
+        
+        T await_resume() {
+            return handle_.promise().take();
+        }
+    };
+    
+    Awaiter operator co_await() noexcept {
+        return Awaiter(handle_);
+    }
+};
+
+#ifdef ADVANCED_TASK_SCHEDULER_IO
+// One thread blocked in poll() over every descriptor a coroutine is waiting
+// on, plus a self-pipe for waking it when a new wait is registered. A ready
+// descriptor's coroutine is handed to the callback (which resumes it on the
+// pool) and its registration dropped. Waits still registered at destruction
+// are dropped without resuming.
+class IoReactor {
+public:
+    using Callback = std::function<void(std::coroutine_handle<>)>;
+    
+private:
+    struct Watch {
+        int fd;
+        short events;
+        std::coroutine_handle<> coroutine;
+    };
+    
+    Callback onReady_;
+    int wakeRead_ = -1;
+    int wakeWrite_ = -1;
+    std::vector<Watch> watches_;   // only the reactor thread removes entries
+    std::mutex mutex_;
+    bool stop_ = false;
+    std::thread thread_;
+    
+    void wake() {
+        char byte = 0;
+        // A full pipe already has a wake-up pending
+        [[maybe_unused]] ssize_t written = ::write(wakeWrite_, &byte, 1);
+    }
+    
+    void run() {
+        std::vector<pollfd> fds;
+        std::vector<std::coroutine_handle<>> ready;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            size_t polled = watches_.size();
+            fds.resize(polled + 1);
+            fds[0] = {wakeRead_, POLLIN, 0};
+            for (size_t i = 0; i < polled; ++i) {
+                fds[i + 1] = {watches_[i].fd, watches_[i].events, 0};
+            }
+            lock.unlock();
+            
+            int result = ::poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+            bool failed = result < 0 && errno != EINTR;
+            if (fds[0].revents & POLLIN) {
+                char buffer[64];
+                while (::read(wakeRead_, buffer, sizeof(buffer)) > 0) {}
+            }
+            
+            // Entries past `polled` were added meanwhile and wait for the next round.
+            // If poll() itself failed, every waiter resumes and meets the error on its own call.
+            lock.lock();
+            ready.clear();
+            size_t kept = 0;
+            for (size_t i = 0; i < watches_.size(); ++i) {
+                if (i < polled && (failed || fds[i + 1].revents != 0)) {
+                    ready.push_back(watches_[i].coroutine);
+                } else {
+                    watches_[kept++] = watches_[i];
+                }
+            }
+            watches_.resize(kept);
+            
+            if (!ready.empty()) {
+                lock.unlock();
+                for (auto coroutine : ready) {
+                    onReady_(coroutine);
+                }
+                lock.lock();
+            }
+        }
+    }
+    
+public:
+    explicit IoReactor(Callback onReady) : onReady_(std::move(onReady)) {
+        int pipeFds[2];
+        if (::pipe(pipeFds) != 0) {
+            throw TaskSchedulerException("Cannot create the I/O reactor's wake-up pipe");
+        }
+        wakeRead_ = pipeFds[0];
+        wakeWrite_ = pipeFds[1];
+        for (int fd : pipeFds) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        }
+        thread_ = std::thread([this] { run(); });
+    }
+    
+    ~IoReactor() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake();
+        thread_.join();
+        ::close(wakeRead_);
+        ::close(wakeWrite_);
+    }
+    
+    IoReactor(const IoReactor&) = delete;
+    IoReactor& operator=(const IoReactor&) = delete;
+    
+    // Resume `coroutine` once `fd` reports any of `events` (or an error)
+    void watch(int fd, short events, std::coroutine_handle<> coroutine) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            watches_.push_back({fd, events, coroutine});
+        }
+        wake();
+    }
+    
+    size_t size() const {
+        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(mutex_));
+        return watches_.size();
+    }
+};
+#endif // ADVANCED_TASK_SCHEDULER_IO
+#endif // ADVANCED_TASK_SCHEDULER_COROUTINES
+
+// How many finished tasks a TaskScheduler keeps for status and result
+// lookups. Tasks past either limit are reclaimed (and lookups of them throw
+// TaskNotFoundException). The default keeps every task until cleanup().
+struct RetentionPolicy {
+    size_t maxFinished = std::numeric_limits<size_t>::max();   // keep the last N
+    std::chrono::steady_clock::duration ttl = std::chrono::steady_clock::duration::max();
+    
+    bool keepsEverything() const {
+        return maxFinished == std::numeric_limits<size_t>::max() &&
+               ttl == std::chrono::steady_clock::duration::max();
+    }
+};
+
+// Main task scheduler class
+class TaskScheduler {
+private:
+    // Finished tasks in the order they finished, for retention. Declared
+    // before the pool so that it outlives the tasks the pool still runs
+    // while shutting down; `owner` is cleared first, so those tasks no
+    // longer reach into the scheduler.
+    struct FinishedTasks final : TaskBase::FinishObserver {
+        std::mutex mutex;
+        std::deque<std::pair<std::shared_ptr<TaskBase>, std::chrono::steady_clock::time_point>> queue;
+        TaskScheduler* owner = nullptr;
+        
+        // Also reclaims, if the task map is free right now: never waiting
+        // keeps workers off the submission lock, and lock order is
+        // tasksMutex_ before this mutex everywhere else
+        void taskFinished(TaskBase& task) override {
+            auto finishedAt = std::chrono::steady_clock::now();
+            std::shared_ptr<TaskBase> shared = task.shared_from_this();
+            std::unique_lock<std::mutex> lock(mutex);
+            queue.emplace_back(std::move(shared), finishedAt);
+            if (owner && owner->tasksMutex_.try_lock()) {
+                std::unique_lock<std::mutex> tasksLock(owner->tasksMutex_, std::adopt_lock);
+                owner->reclaimFinished(RECLAIM_PER_TASK);
+            }
+        }
+    };
+    
+    FinishedTasks finished_;
+    RetentionPolicy retention_;   // guarded by tasksMutex_
+    ThreadPool threadPool_;
+    TimerWheel timers_;   // after threadPool_: stops before the pool it feeds
+    string_flat_hash_map<std::shared_ptr<TaskBase>> tasks_;
+    std::unordered_map<std::string, uint64_t> delayedTasks_;   // name -> timer id
+    std::mutex tasksMutex_;
+#ifdef ADVANCED_TASK_SCHEDULER_IO
+    std::unique_ptr<IoReactor> reactor_;   // started on first use; stops before the pool
+    std::once_flag reactorOnce_;
+#endif
+    
+    // Task statistics, sharded so that threads submitting and cancelling
+    // at once do not all contend on one cache line
+    struct Statistics {
+        ShardedCounter totalTasks;
+        ShardedCounter completedTasks;
+        ShardedCounter failedTasks;
+        ShardedCounter cancelledTasks;
+    };
+    
+    Statistics stats_;
+    
+    // Argument a dependent task receives from one dependency: its result by
+    // const reference, or nothing for a void task. A failed dependency
+    // rethrows its exception, so it fails the dependent task too.
+    template<typename DependencyResult>
+    static auto dependencyArgument(const std::shared_ptr<Task<DependencyResult>>& dependency) {
+        if (dependency->getStatus() == TaskStatus::CANCELLED) {
+            throw TaskSchedulerException("Dependency '" + dependency->getName() + "' was cancelled");
+        }
+        if constexpr (std::is_void_v<DependencyResult>) {
+            dependency->getResult().getResult();
+            return std::tuple<>();
+        } else {
+            return std::tuple<const DependencyResult&>(dependency->getResult().getResultRef());
+        }
+    }
+    
+    void registerTask(const std::string& name, std::shared_ptr<TaskBase> task) {
+        std::unique_lock<std::mutex> lock(tasksMutex_);
+        
+        if (tasks_.find(name) != tasks_.end()) {
+            throw DuplicateTaskException("Task with name '" + name + "' already exists");
+        }
+        
+        retain(*task);
+        tasks_[name] = std::move(task);
+        stats_.totalTasks.add();
+        reclaimSome(RECLAIM_PER_TASK);
+    }
+    
+    // Finished tasks reclaimed per task registered: more than one, so that a
+    // backlog drains while tasks keep arriving, and bounded, so that no
+    // registration pays for a long walk
+    static constexpr size_t RECLAIM_PER_TASK = 2;
+    
+    // Call with tasksMutex_ held, before the task can run
+    void retain(TaskBase& task) {
+        if (!retention_.keepsEverything()) {
+            task.setFinishObserver(&finished_);
+        }
+    }
+    
+    // Call with tasksMutex_ held
+    void reclaimSome(size_t budget) {
+        if (!retention_.keepsEverything()) {
+            std::unique_lock<std::mutex> lock(finished_.mutex);
+            reclaimFinished(budget);
+        }
+    }
+    
+    // Drop up to `budget` of the oldest finished tasks that are past the
+    // retention limits; call with tasksMutex_ and finished_.mutex held
+    void reclaimFinished(size_t budget) {
+        if (retention_.keepsEverything()) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        for (; budget > 0 && !finished_.queue.empty(); --budget) {
+            auto& [task, finishedAt] = finished_.queue.front();
+            if (finished_.queue.size() <= retention_.maxFinished && now - finishedAt < retention_.ttl) {
+                break;   // everything behind it finished later
+            }
+            // The name may already be gone (cleanup) or taken by a newer task
+            std::string name = task->getName();
+            auto it = tasks_.find(name);
+            if (it != tasks_.end() && it->second == task) {
+                tasks_.erase(it);
+                delayedTasks_.erase(name);
+            }
+            finished_.queue.pop_front();
+        }
+    }
+    
+#ifdef ADVANCED_TASK_SCHEDULER_COROUTINES
+    // Detached coroutine that drives a spawned AsyncTask and fulfils its
+    // promise; its frame frees itself when it finishes
+    struct SpawnedCoroutine {
+        struct promise_type : CoroutinePromiseBase {
+            SpawnedCoroutine get_return_object() {
+                return {std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+        };
+        
+        std::coroutine_handle<promise_type> handle;
+    };
+    
+    template<typename T>
+    static SpawnedCoroutine runSpawned(AsyncTask<T> task, std::promise<T> promise) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+                promise.set_value();
+            } else {
+                promise.set_value(co_await task);
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+    
+#ifdef ADVANCED_TASK_SCHEDULER_IO
+    IoReactor& reactor() {
+        std::call_once(reactorOnce_, [this] {
+            reactor_ = std::make_unique<IoReactor>([this](std::coroutine_handle<> coroutine) {
+                resumeOnPool(coroutine);
+            });
+        });
+        return *reactor_;
+    }
+#endif
+#endif
+
+    // The exception a throwing lookup raises for an error from its try version
+    [[noreturn]] static void throwSchedulerError(SchedulerError error, const std::string& name) {
+        switch (error) {
+            case SchedulerError::TaskNotFound:
+                throw TaskNotFoundException("Task '" + name + "' not found");
+            case SchedulerError::ResultTypeMismatch:
+                throw TaskSchedulerException("Task result type mismatch");
+            case SchedulerError::TaskCancelled:
+                throw TaskSchedulerException("Task was cancelled");
+            case SchedulerError::TaskFailed:
+                break;
+        }
+        throw TaskSchedulerException("Task '" + name + "' failed");
+    }
+    
+public:
+    explicit TaskScheduler(size_t threadCount = std::thread::hardware_concurrency())
+        : TaskScheduler(ThreadPoolConfig{threadCount}) {}
+    
+    // Worker count and placement (core pinning, NUMA grouping) for the pool
+    explicit TaskScheduler(const ThreadPoolConfig& config)
+        : threadPool_(config)
+        , timers_([this](std::shared_ptr<TaskBase> task) { threadPool_.enqueue(std::move(task)); }) {
+        finished_.owner = this;
+    }
+    
+    ~TaskScheduler() {
+        std::unique_lock<std::mutex> lock(finished_.mutex);
+        finished_.owner = nullptr;
+    }
+    
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+    
+    // Schedule a task with a result
+    template<typename ResultType>
+    std::shared_ptr<Task<ResultType>> scheduleTask(
+        const std::string& name,
+        std::function<ResultType()> function,
+        Priority priority = Priority::MEDIUM,
+        std::chrono::system_clock::time_point scheduledTime = std::chrono::system_clock::now(),
+        bool cancellable = true) {
+        
+        // Delayed tasks are admitted to the queues when they fall due
+        if (scheduledTime <= std::chrono::system_clock::now()) {
+            admitOrThrow(priority);
+        }
+        
+        std::unique_lock<std::mutex> lock(tasksMutex_);
+        
+        if (tasks_.find(name) != tasks_.end()) {
+            throw DuplicateTaskException("Task with name '" + name + "' already exists");
+        }
+        
+        auto task = std::make_shared<Task<ResultType>>(
+            name, std::move(function), priority, scheduledTime, cancellable);
+        
+        retain(*task);
+        tasks_[name] = task;
+        stats_.totalTasks.add();
+        reclaimSome(RECLAIM_PER_TASK);
+        
+        // If the scheduled time is now or in the past, enqueue immediately
+        if (scheduledTime <= std::chrono::system_clock::now()) {
+            threadPool_.enqueue(task);
+        } else {
+            // The timer wheel enqueues the task at the scheduled time
+            delayedTasks_[name] = timers_.schedule(task, scheduledTime);
+        }
+        
+        return task;
+    }
+    
+    // Schedule many tasks at once: the names are registered under one lock
+    // and the pool queues them in one batch, waking workers in one go. If any
+    // name is taken (or repeated in the batch) nothing is scheduled.
+    // Fan-out/fan-in:
+    //   TaskGroup group;
+    //   group.add(scheduler.scheduleBatch<int>(std::move(jobs)));
+    //   group.wait();
+    template<typename ResultType>
+    std::vector<std::shared_ptr<Task<ResultType>>> scheduleBatch(
+        std::vector<std::pair<std::string, std::function<ResultType()>>> jobs,
+        Priority priority = Priority::MEDIUM,
+        bool cancellable = true) {
+        
+        admitOrThrow(priority, jobs.size());
+        
+        std::vector<std::shared_ptr<Task<ResultType>>> tasks;
+        tasks.reserve(jobs.size());
+        auto now = std::chrono::system_clock::now();
+        for (auto& job : jobs) {
+            tasks.push_back(std::make_shared<Task<ResultType>>(
+                std::move(job.first), std::move(job.second), priority, now, cancellable));
+        }
+        
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex_);
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                if (!tasks_.emplace(tasks[i]->getName(), tasks[i]).second) {
+                    for (size_t j = 0; j < i; ++j) {
+                        tasks_.erase(tasks[j]->getName());
+                    }
+                    throw DuplicateTaskException("Task with name '" + tasks[i]->getName() + "' already exists");
+                }
+            }
+            for (const auto& task : tasks) {
+                retain(*task);
+            }
+            stats_.totalTasks.add(static_cast<int64_t>(tasks.size()));
+            reclaimSome(RECLAIM_PER_TASK * tasks.size());
+        }
+        
+        threadPool_.enqueueBatch(tasks);
+        return tasks;
+    }
+    
+    // Like scheduleTask for a task due now, but never waits or drops: returns
+    // nullptr when the priority's queue is full, whatever the overload policy
+    template<typename ResultType>
+    std::shared_ptr<Task<ResultType>> trySchedule(
+        const std::string& name,
+        std::function<ResultType()> function,
+        Priority priority = Priority::MEDIUM,
+        bool cancellable = true) {
+        
+        if (!threadPool_.admit(priority, 1, false)) {
+            return nullptr;
+        }
+        auto task = std::make_shared<Task<ResultType>>(
+            name, std::move(function), priority, std::chrono::system_clock::now(), cancellable);
+        registerTask(name, task);
+        threadPool_.enqueue(task);
+        return task;
+    }
+    
+    // Schedule a task that runs once all of its dependencies have finished,
+    // called with their results (void dependencies contribute no argument):
+    //   auto sum = scheduler.scheduleTask<int>("sum", dependsOn(a, b),
+    //                                          [](const int& x, const int& y) { return x + y; });
+    // The task is enqueued by the thread that finishes the last dependency,
+    // so on a pool worker it lands on that worker's own deque.
+    template<typename ResultType, typename... DependencyResults, typename Function>
+    std::shared_ptr<Task<ResultType>> scheduleTask(
+        const std::string& name,
+        TaskDependencies<DependencyResults...> dependencies,
+        Function function,
+        Priority priority = Priority::MEDIUM,
+        bool cancellable = true) {
+        
+        auto body = [inputs = dependencies.tasks, function = std::move(function)]() -> ResultType {
+            auto arguments = std::apply([](const auto&... dependency) {
+                return std::tuple_cat(dependencyArgument(dependency)...);
+            }, inputs);
+            return std::apply(function, arguments);
+        };
+        auto task = std::make_shared<Task<ResultType>>(
+            name, std::function<ResultType()>(std::move(body)), priority,
+            std::chrono::system_clock::now(), cancellable);
+        registerTask(name, task);
+        
+        // One count per dependency plus one held until every continuation is registered
+        auto remaining = std::make_shared<std::atomic<size_t>>(sizeof...(DependencyResults) + 1);
+        auto release = [this, task, remaining] {
+            if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                threadPool_.enqueue(task);
+            }
+        };
+        std::apply([&release](const auto&... dependency) {
+            (dependency->whenFinished(release), ...);
+        }, dependencies.tasks);
+        release();
+        
+        return task;
+    }
+    
+    // Lightweight submission: no name, no result, no std::function. The
+    // callable is stored inline in a pooled task slot (it must fit in
+    // SmallFunction's buffer and must not throw), and the returned id is
+    // checked through isDone/wait/cancel. Once the pool and the slot cache
+    // are warm, submitting allocates nothing. Light tasks are not listed in
+    // the scheduler's statistics.
+    template<typename Function>
+    TaskId submit(Function&& work, Priority priority = Priority::MEDIUM) {
+        admitOrThrow(priority);
+        return enqueueLight(std::forward<Function>(work), priority);
+    }
+    
+private:
+    void admitOrThrow(Priority priority, size_t count = 1) {
+        if (!threadPool_.admit(priority, count)) {
+            static const char* const names[] = {"LOW", "MEDIUM", "HIGH", "CRITICAL"};
+            throw QueueFullException(std::string("Queue for priority ") + names[static_cast<int>(priority)] + " is full");
+        }
+    }
+    
+    template<typename Function>
+    TaskId enqueueLight(Function&& work, Priority priority) {
+        LightTask* task = LightTaskPool::instance().acquire();
+        task->work_ = SmallFunction<void()>(std::forward<Function>(work));
+        task->priority = priority;
+        uint64_t generation = task->word_.load(std::memory_order_relaxed) >> LightTask::STATE_BITS;
+        task->word_.store(LightTask::pack(generation, LightTask::PENDING), std::memory_order_release);
+        
+        TaskId id{task->index_, static_cast<uint32_t>(generation)};
+        threadPool_.enqueue(task);
+        return id;
+    }
+    
+public:
+    
+    // True once the task has run or been skipped after cancel(); false for
+    // an id this pool never issued
+    bool isDone(TaskId id) const {
+        LightTask* task = LightTaskPool::instance().find(id.index);
+        return task && task->generation() != id.generation;
+    }
+    
+    // Returns at once for an id this pool never issued
+    void wait(TaskId id) const {
+        if (!LightTaskPool::instance().find(id.index)) {
+            return;
+        }
+        for (int spins = 0; !isDone(id); ++spins) {
+            if (spins < 1024) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+    
+    // Stop a lightweight task that has not started yet
+    bool cancel(TaskId id) {
+        LightTask* task = LightTaskPool::instance().find(id.index);
+        if (!task) {
+            return false;
+        }
+        uint64_t expected = LightTask::pack(id.generation, LightTask::PENDING);
+        return task->word_.compare_exchange_strong(
+            expected, LightTask::pack(id.generation, LightTask::CANCELLED), std::memory_order_acq_rel);
+    }
+    
+#ifdef ADVANCED_TASK_SCHEDULER_COROUTINES
+    // Coroutines. A suspended coroutine holds no thread: whatever it waits
+    // for (a task, a timer, a descriptor) resumes it later through
+    // resumeOnPool, so waiting does not tie up a worker the way waitForTask
+    // does. Like light tasks, coroutines are not listed in the statistics.
+    
+    // Resume a suspended coroutine on a pool thread
+    void resumeOnPool(std::coroutine_handle<> coroutine, Priority priority = Priority::MEDIUM) {
+        enqueueLight([coroutine] { coroutine.resume(); }, priority);
+    }
+    
+    // Start a coroutine on the pool; the future receives its result or exception
+    template<typename T>
+    std::future<T> spawn(AsyncTask<T> task) {
+        std::promise<T> promise;
+        std::future<T> future = promise.get_future();
+        SpawnedCoroutine spawned = runSpawned(std::move(task), std::move(promise));
+        spawned.handle.promise().scheduler = this;
+        resumeOnPool(spawned.handle);
+        return future;
+    }
+    
+    struct SleepAwaiter {
+        TaskScheduler& scheduler;
+        std::chrono::system_clock::time_point until;
+        
+        bool await_ready() const {
+            return until <= std::chrono::system_clock::now();
+        }
+        
+        // The timer wheel fires a task that resumes the coroutine on the pool
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            auto wakeUp = std::make_shared<Task<void>>(
+                "sleep", [coroutine] { coroutine.resume(); }, Priority::MEDIUM, until, false);
+            scheduler.timers_.schedule(std::move(wakeUp), until);
+        }
+        
+        void await_resume() const {}
+    };
+    
+    // co_await scheduler.sleepFor(delay) suspends the coroutine on the timer wheel
+    template<typename Rep, typename Period>
+    SleepAwaiter sleepFor(std::chrono::duration<Rep, Period> delay) {
+        return sleepUntil(std::chrono::system_clock::now() +
+                          std::chrono::duration_cast<std::chrono::system_clock::duration>(delay));
+    }
+    
+    SleepAwaiter sleepUntil(std::chrono::system_clock::time_point when) {
+        return {*this, when};
+    }
+    
+#ifdef ADVANCED_TASK_SCHEDULER_IO
+    struct IoAwaiter {
+        TaskScheduler& scheduler;
+        int fd;
+        short events;
+        
+        bool await_ready() const { return false; }
+        
+        void await_suspend(std::coroutine_handle<> coroutine) {
+            scheduler.reactor().watch(fd, events, coroutine);
+        }
+        
+        void await_resume() const {}
+    };
+    
+    // co_await scheduler.readable(fd) / writable(fd) resumes once poll()
+    // reports the descriptor ready, or in error so that the next read or
+    // write surfaces it. Use non-blocking descriptors.
+    IoAwaiter readable(int fd) {
+        return {*this, fd, POLLIN};
+    }
+    
+    IoAwaiter writable(int fd) {
+        return {*this, fd, POLLOUT};
+    }
+#endif
+#endif
+    
+    // Cancel a task by name
+    bool cancelTask(const std::string& name) {
+        std::unique_lock<std::mutex> lock(tasksMutex_);
+        
+        auto it = tasks_.find(name);
+        if (it == tasks_.end()) {
+            throw TaskNotFoundException("Task '" + name + "' not found");
+        }
+        
+        auto task = it->second;
+        if (task->isCancellable() && task->getStatus() == TaskStatus::PENDING) {
+            task->cancel();
+            stats_.cancelledTasks.add();
+            
+            // A delayed task that has not fired yet gives up its timer slot now;
+            // it still passes through the pool so its dependents are released
+            auto delayed = delayedTasks_.find(name);
+            if (delayed != delayedTasks_.end()) {
+                if (timers_.cancel(delayed->second)) {
+                    threadPool_.enqueue(task);
+                }
+                delayedTasks_.erase(delayed);
+            }
+            return true;
+        }
+        
+        return false;
+    }
+    
+    // Get task status by name
+    TaskStatus getTaskStatus(const std::string& name) const {
+        auto status = tryGetTaskStatus(name);
+        if (!status) {
+            throwSchedulerError(status.error(), name);
+        }
+        return *status;
+    }
+    
+    // As getTaskStatus, reporting an unknown name instead of throwing
+    stdx::expected<TaskStatus, SchedulerError> tryGetTaskStatus(const std::string& name) const {
+        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
+        
+        auto it = tasks_.find(name);
+        if (it == tasks_.end()) {
+            return stdx::unexpected(SchedulerError::TaskNotFound);
+        }
+        
+        auto status = it->second->getStatus();
+        
+        // Update statistics if needed
+        if (status == TaskStatus::COMPLETED && 
+            it->second->getStatus() != TaskStatus::COMPLETED) {
+            const_cast<ShardedCounter&>(stats_.completedTasks).add();
+        } else if (status == TaskStatus::FAILED && 
+                  it->second->getStatus() != TaskStatus::FAILED) {
+            const_cast<ShardedCounter&>(stats_.failedTasks).add();
+        }
+        
+        return status;
+    }
+    
+    // Get task result by name (type-erased version)
+    std::any getTaskResultAsAny(const std::string& name) const {
+        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
+        
+        auto it = tasks_.find(name);
+        if (it == tasks_.end()) {
+            throw TaskNotFoundException("Task '" + name + "' not found");
+        }
+        
+        return it->second->getResultAsAny();
+    }
+    
+    // Get task result by name (typed version)
+    template<typename ResultType>
+    TaskResult<ResultType> getTaskResult(const std::string& name) const {
+        auto result = tryGetTaskResult<ResultType>(name);
+        if (!result) {
+            throwSchedulerError(result.error(), name);
+        }
+        return *std::move(result);
+    }
+    
+    // As getTaskResult, reporting an unknown name or a different result
+    // type instead of throwing
+    template<typename ResultType>
+    stdx::expected<TaskResult<ResultType>, SchedulerError> tryGetTaskResult(const std::string& name) const {
+        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
+        
+        auto it = tasks_.find(name);
+        if (it == tasks_.end()) {
+            return stdx::unexpected(SchedulerError::TaskNotFound);
+        }
+        
+        auto typedTask = std::dynamic_pointer_cast<Task<ResultType>>(it->second);
+        if (!typedTask) {
+            return stdx::unexpected(SchedulerError::ResultTypeMismatch);
+        }
+        
+        return typedTask->getResult();
+    }
+    
+    // Wait for a task to complete
+    template<typename ResultType>
+    ResultType waitForTask(const std::string& name) {
+        auto result = tryWaitForTask<ResultType>(name);
+        if (!result) {
+            if (result.error() == SchedulerError::TaskFailed) {
+                getTaskResult<ResultType>(name).getResult(); // This will throw the original exception
+            }
+            throwSchedulerError(result.error(), name);
+        }
+        return *std::move(result);
+    }
+    
+    // As waitForTask, reporting failure, cancellation or an unknown name as
+    // an error instead of throwing
+    template<typename ResultType>
+    stdx::expected<ResultType, SchedulerError> tryWaitForTask(const std::string& name) {
+        while (true) {
+            auto status = tryGetTaskStatus(name);
+            if (!status) {
+                return stdx::unexpected(status.error());
+            }
+            if (*status == TaskStatus::COMPLETED) {
+                auto result = tryGetTaskResult<ResultType>(name);
+                if (!result) {
+                    return stdx::unexpected(result.error());
+                }
+                if constexpr (std::is_void_v<ResultType>) {
+                    return {};
+                } else {
+                    return result->getResult();
+                }
+            } else if (*status == TaskStatus::FAILED) {
+                return stdx::unexpected(SchedulerError::TaskFailed);
+            } else if (*status == TaskStatus::CANCELLED) {
+                return stdx::unexpected(SchedulerError::TaskCancelled);
+            }
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    
+    // Wait for all tasks to complete
     void waitForAll() {
         bool allDone = false;
         
@@ -553,16 +2935,31 @@ public:
         }
         
         return {
-            stats_.totalTasks,
-            stats_.completedTasks,
-            stats_.failedTasks,
-            stats_.cancelledTasks,
+            static_cast<size_t>(stats_.totalTasks.read()),
+            static_cast<size_t>(stats_.completedTasks.read()),
+            static_cast<size_t>(stats_.failedTasks.read()),
+            static_cast<size_t>(stats_.cancelledTasks.read()),
             pending,
             threadPool_.getActiveThreadCount(),
             threadPool_.getMaxThreadCount()
         };
     }
     
+    // Monitoring snapshot that takes no scheduler lock: scheduler-wide
+    // counters plus the pool's per-worker counters and per-priority latency
+    // histograms. The pool's figures cover everything it runs, light tasks
+    // and coroutine resumptions included.
+    struct SchedulerMetrics {
+        size_t totalTasks;
+        size_t cancelledTasks;
+        PoolMetrics pool;
+    };
+    
+    SchedulerMetrics getMetrics() const {
+        return {static_cast<size_t>(stats_.totalTasks.read()), static_cast<size_t>(stats_.cancelledTasks.read()),
+                threadPool_.getMetrics()};
+    }
+    
     // List all tasks with their status
     std::vector<std::pair<std::string, TaskStatus>> listTasks() const {
         std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(tasksMutex_));
@@ -577,15 +2974,36 @@ public:
         return result;
     }
     
+    // Keep at most policy.maxFinished finished tasks, each for at most
+    // policy.ttl. Applies to tasks registered from now on; finished tasks
+    // past the limits are reclaimed a few at a time as new tasks arrive,
+    // so neither this nor any later call walks the task map.
+    void setRetention(const RetentionPolicy& policy) {
+        std::unique_lock<std::mutex> lock(tasksMutex_);
+        retention_ = policy;
+    }
+    
+    // Number of finished tasks awaiting reclamation under the retention policy
+    size_t getRetainedCount() const {
+        std::unique_lock<std::mutex> lock(const_cast<std::mutex&>(finished_.mutex));
+        return finished_.queue.size();
+    }
+    
     // Remove completed/failed/cancelled tasks
     void cleanup() {
         std::unique_lock<std::mutex> lock(tasksMutex_);
+        {
+            // Every finished task goes below, so none is left to reclaim
+            std::unique_lock<std::mutex> finishedLock(finished_.mutex);
+            finished_.queue.clear();
+        }
         
         for (auto it = tasks_.begin(); it != tasks_.end();) {
             auto status = it->second->getStatus();
             if (status == TaskStatus::COMPLETED || 
                 status == TaskStatus::FAILED || 
                 status == TaskStatus::CANCELLED) {
+                delayedTasks_.erase(it->first);
                 it = tasks_.erase(it);
             } else {
                 ++it;
@@ -594,4 +3012,45 @@ public:
     }
 };
 
+#ifdef ADVANCED_TASK_SCHEDULER_COROUTINES
+// co_await on a scheduled task suspends until it finishes, then resumes on a
+// pool thread with its result; a failed task rethrows its exception and a
+// cancelled one throws TaskSchedulerException
+template<typename ResultType>
+class TaskAwaiter {
+private:
+    std::shared_ptr<Task<ResultType>> task_;
+    
+public:
+    explicit TaskAwaiter(std::shared_ptr<Task<ResultType>> task) : task_(std::move(task)) {}
+    
+    bool await_ready() const {
+        TaskStatus status = task_->getStatus();
+        return status == TaskStatus::COMPLETED || status == TaskStatus::FAILED ||
+               status == TaskStatus::CANCELLED;
+    }
+    
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> awaiting) {
+        TaskScheduler* scheduler = awaiting.promise().scheduler;
+        if (!scheduler) {
+            throw TaskSchedulerException("Only spawned coroutines can await tasks");
+        }
+        task_->whenFinished([scheduler, awaiting] { scheduler->resumeOnPool(awaiting); });
+    }
+    
+    ResultType await_resume() const {
+        if (task_->getStatus() == TaskStatus::CANCELLED) {
+            throw TaskSchedulerException("Task '" + task_->getName() + "' was cancelled");
+        }
+        return task_->getResult().getResult();
+    }
+};
+
+template<typename ResultType>
+TaskAwaiter<ResultType> operator co_await(std::shared_ptr<Task<ResultType>> task) {
+    return TaskAwaiter<ResultType>(std::move(task));
+}
+#endif
+
 #endif // ADVANCED_TASK_SCHEDULER_HPP
@@ -6,6 +6,29 @@
 #include <random>
 #include <chrono>
 #include <thread>
+#include <numeric>
+#include <cstdlib>
+
+// Global allocation counter for the submission benchmark below. The
+// replacements are kept out of line so GCC does not pair the inlined malloc
+// with operator delete and warn about mismatched allocation functions.
+static std::atomic<size_t> allocationCount{0};
+
+[[gnu::noinline]] void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
 
 // Helper function to convert TaskStatus to string
 std::string statusToString(TaskStatus status) {
@@ -111,6 +134,15 @@ void failingTask() {
     throw std::runtime_error("This task is designed to fail");
 }
 
+#ifdef ADVANCED_TASK_SCHEDULER_COROUTINES
+// A logical request: wait on a shared upstream task, then back off for a while
+AsyncTask<int> handleRequest(TaskScheduler& scheduler, std::shared_ptr<Task<int>> config, int id) {
+    int base = co_await config;
+    co_await scheduler.sleepFor(std::chrono::milliseconds(20 + id % 30));
+    co_return base + id % 10;
+}
+#endif
+
 int main() {
     std::cout << "===== Advanced Task Scheduler Demo =====\n\n";
     
@@ -212,6 +244,13 @@ int main() {
         std::cout << "Expected exception from failing_task: " << e.what() << "\n";
     }
     
+    // The try versions report failures as values, without a throw
+    auto missing = scheduler.tryGetTaskStatus("no_such_task");
+    auto failed = scheduler.tryWaitForTask<void>("failing_task");
+    std::cout << "\ntryGetTaskStatus(no_such_task) found: " << (missing ? "yes" : "no")
+              << ", tryWaitForTask(failing_task) failed: "
+              << (!failed && failed.error() == SchedulerError::TaskFailed ? "yes" : "no") << "\n";
+    
     // Wait for all remaining tasks
     std::cout << "\nWaiting for all remaining tasks to complete...\n";
     scheduler.waitForAll();
@@ -242,6 +281,203 @@ int main() {
     // Print final task list after cleanup
     printTaskList(scheduler.listTasks());
     
+    // Dependent tasks receive their upstream results without blocking a worker
+    {
+        TaskScheduler graph(4);
+        auto extract = graph.scheduleTask<std::vector<int>>(
+            "extract", std::function<std::vector<int>()>([] { return std::vector<int>{4, 8, 15, 16, 23, 42}; }));
+        auto total = graph.scheduleTask<int>("total", dependsOn(extract), [](const std::vector<int>& values) {
+            return std::accumulate(values.begin(), values.end(), 0);
+        });
+        auto largest = graph.scheduleTask<int>("largest", dependsOn(extract), [](const std::vector<int>& values) {
+            return *std::max_element(values.begin(), values.end());
+        });
+        auto report = graph.scheduleTask<std::string>("report", dependsOn(total, largest), [](int sum, int max) {
+            return "sum=" + std::to_string(sum) + " max=" + std::to_string(max);
+        });
+        std::cout << "\nTask graph result: " << graph.waitForTask<std::string>("report") << "\n";
+    }
+    
+    // Many delayed tasks share the scheduler's single timer thread
+    {
+        TaskScheduler delayed(2);
+        std::atomic<int> ran{0};
+        auto when = std::chrono::system_clock::now() + std::chrono::milliseconds(200);
+        for (int i = 0; i < 10000; ++i) {
+            delayed.scheduleTask<void>("retry_" + std::to_string(i), [&ran] { ++ran; },
+                                       Priority::MEDIUM, when);
+        }
+        for (int i = 0; i < 10000; i += 2) {
+            delayed.cancelTask("retry_" + std::to_string(i));
+        }
+        delayed.waitForAll();
+        std::cout << "\nDelayed retries: " << ran << " ran, "
+                  << delayed.getStatistics().cancelledTasks << " cancelled\n";
+    }
+    
+    // Throughput of many tiny tasks on the work-stealing pool, unpinned and
+    // with workers pinned and grouped by NUMA node
+    {
+        CpuTopology topology = CpuTopology::detect();
+        std::cout << "\nTopology: " << topology.nodeCount() << " NUMA node(s), "
+                  << topology.cpuCount() << " CPU(s)\n";
+                  
+        ThreadPoolConfig placed;
+        placed.threads = 4;
+        placed.pinThreads = true;
+        placed.numaAware = true;
+        for (const ThreadPoolConfig& config : {ThreadPoolConfig{4}, placed}) {
+            constexpr size_t taskCount = 200000;
+            std::atomic<size_t> finished{0};
+            auto start = std::chrono::steady_clock::now();
+            {
+                ThreadPool pool(config, topology);
+                for (size_t i = 0; i < taskCount; ++i) {
+                    pool.enqueue(std::make_shared<Task<void>>(
+                        "tiny", [&finished] { finished.fetch_add(1, std::memory_order_relaxed); },
+                        static_cast<Priority>(i % 4)));
+                }
+            } // the destructor runs every queued task before joining
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << (config.numaAware ? "Pinned, NUMA-aware: ran " : "Unpinned: ran ") << finished
+                      << " tiny tasks in " << std::fixed << std::setprecision(1) << elapsed * 1000
+                      << " ms (" << static_cast<size_t>(taskCount / elapsed) << " tasks/sec)\n";
+        }
+    }
+    
+    // Fan-out/fan-in: one batch, one bulk wait
+    {
+        TaskScheduler batch(4);
+        constexpr int jobCount = 10000;
+        std::vector<std::pair<std::string, std::function<long()>>> jobs;
+        jobs.reserve(jobCount);
+        for (int i = 0; i < jobCount; ++i) {
+            jobs.emplace_back("square_" + std::to_string(i), [i] { return static_cast<long>(i) * i; });
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        TaskGroup group;
+        auto squares = batch.scheduleBatch<long>(std::move(jobs));
+        group.add(squares);
+        group.wait();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        long total = 0;
+        for (const auto& square : squares) {
+            total += square->getResult().getResult();
+        }
+        std::cout << "\nBatch of " << jobCount << " tasks fanned in after " << std::fixed
+                  << std::setprecision(1) << elapsed * 1000 << " ms, sum of squares " << total << "\n";
+                  
+        // Lock-free metrics, as a monitoring scrape would read them
+        auto metrics = batch.getMetrics();
+        const auto& wait = metrics.pool.queueWait[static_cast<size_t>(Priority::MEDIUM)];
+        const auto& run = metrics.pool.execution[static_cast<size_t>(Priority::MEDIUM)];
+        std::cout << "Queue wait p50/p99: " << wait.percentile(50) / 1000.0 << " / " << wait.percentile(99) / 1000.0
+                  << " us, execution p99: " << run.percentile(99) / 1000.0 << " us, "
+                  << metrics.pool.completed() << " completed on " << metrics.pool.workers.size() << " workers\n";
+    }
+    
+    // Retention: keep only the last 1,000 finished tasks of a long stream
+    {
+        TaskScheduler service(4);
+        RetentionPolicy retention;
+        retention.maxFinished = 1000;
+        service.setRetention(retention);
+        
+        constexpr int streamLength = 50000;
+        for (int i = 0; i < streamLength; ++i) {
+            service.scheduleTask<int>("request_" + std::to_string(i), std::function<int()>([i] { return i; }));
+        }
+        service.waitForAll();
+        std::cout << "\nRetention: " << streamLength << " tasks scheduled, " << service.listTasks().size()
+                  << " still tracked\n";
+    }
+    
+    // Backpressure: a bounded LOW queue sheds a burst instead of growing
+    {
+        ThreadPoolConfig config;
+        config.threads = 2;
+        config.queueCapacity[static_cast<size_t>(Priority::LOW)] = 64;
+        TaskScheduler bounded(config);
+        
+        constexpr int burst = 10000;
+        int accepted = 0;
+        for (int i = 0; i < burst; ++i) {
+            auto task = bounded.trySchedule<void>("bulk_" + std::to_string(i), std::function<void()>([] {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }), Priority::LOW);
+            if (task) {
+                ++accepted;
+            }
+        }
+        bounded.waitForAll();
+        std::cout << "\nBackpressure: " << accepted << " of " << burst
+                  << " LOW tasks admitted with a queue bound of 64\n";
+    }
+    
+    // Allocations per task: named scheduleTask vs. pooled submit
+    {
+        TaskScheduler light(4);
+        constexpr size_t taskCount = 100000;
+        std::atomic<size_t> counter{0};
+        std::vector<TaskId> ids(taskCount);
+        auto submitRound = [&] {
+            for (size_t i = 0; i < taskCount; ++i) {
+                ids[i] = light.submit([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+            for (TaskId id : ids) {
+                light.wait(id);
+            }
+        };
+        submitRound();   // warm up the slot pool and the queues
+        submitRound();
+        
+        size_t before = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        submitRound();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t submitAllocations = allocationCount - before;
+        
+        before = allocationCount;
+        for (size_t i = 0; i < 1000; ++i) {
+            light.scheduleTask<void>("named_" + std::to_string(i),
+                                     std::function<void()>([&counter] { ++counter; }));
+        }
+        light.waitForAll();
+        double namedAllocations = (allocationCount - before) / 1000.0;
+        
+        std::cout << "\nsubmit(): " << taskCount << " tasks, " << submitAllocations << " allocations, "
+                  << static_cast<size_t>(taskCount / elapsed) << " tasks/sec\n";
+        std::cout << "scheduleTask(): " << std::setprecision(1) << namedAllocations << " allocations per task\n";
+    }
+
+#ifdef ADVANCED_TASK_SCHEDULER_COROUTINES
+    // Coroutines (built with -std=c++20): 10,000 in-flight waits on 2 threads
+    {
+        TaskScheduler coroutines(2);
+        auto config = coroutines.scheduleTask<int>("config", [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return 100;
+        });
+        
+        constexpr int requestCount = 10000;
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<int>> replies;
+        replies.reserve(requestCount);
+        for (int id = 0; id < requestCount; ++id) {
+            replies.push_back(coroutines.spawn(handleRequest(coroutines, config, id)));
+        }
+        long total = 0;
+        for (auto& reply : replies) {
+            total += reply.get();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nCoroutines: " << requestCount << " requests on 2 threads in " << std::fixed
+                  << std::setprecision(1) << elapsed * 1000 << " ms, total " << total << "\n";
+    }
+#endif
+    
     std::cout << "\n===== Advanced Task Scheduler Demo Complete =====\n";
     return 0;
 }
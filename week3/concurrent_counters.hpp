@@ -0,0 +1,290 @@
+/*
+ * concurrent_counters.hpp - Sharded Counters and Histograms
+ *
+ * A single std::atomic counter stays correct under contention but not
+ * fast: every increment needs exclusive ownership of the one cache line
+ * holding it, so that line bounces between the cores of all the threads
+ * that count. ShardedCounter splits the count into slots a cache line
+ * apart; each thread adds to its own slot with a relaxed fetch_add, and a
+ * read sums the slots. ConcurrentHistogram shards its buckets the same way.
+ *
+ *   ShardedCounter rows;
+ *   rows.add(batch.size());          // from any thread
+ *   int64_t total = rows.read();
+ *
+ * - A thread's slot is its ordinal (threads are numbered as they first
+ *   count anything) modulo the shard count, so up to shardCount() threads
+ *   never share a slot and more share them two or three to a line. Slots
+ *   are per thread rather than per CPU: asking which CPU we are on costs
+ *   more than an uncontended add, and a thread can migrate mid-add anyway
+ * - read() is not a snapshot: an add racing with it may or may not be
+ *   included, but nothing is ever lost and once the writers stop the
+ *   result is exact
+ * - Each counter takes one cache line per shard; shards default to the
+ *   hardware thread count rounded up to a power of two (at most 256)
+ */
+
+#ifndef CONCURRENT_COUNTERS_HPP
+#define CONCURRENT_COUNTERS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace counter_detail {
+    inline constexpr size_t CACHE_LINE = 64;
+    inline constexpr size_t MAX_SHARDS = 256;
+    
+    // Number of the calling thread, assigned the first time it asks
+    inline size_t threadOrdinal() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t ordinal = next.fetch_add(1, std::memory_order_relaxed);
+        return ordinal;
+    }
+    
+    // Smallest power of two at or above shards, within [1, MAX_SHARDS]
+    inline size_t roundShards(size_t shards) {
+        size_t rounded = 1;
+        while (rounded < shards && rounded < MAX_SHARDS) {
+            rounded *= 2;
+        }
+        return rounded;
+    }
+    
+    inline size_t defaultShards() {
+        return roundShards(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    
+    // Eight 64-bit atomics filling one cache line
+    struct alignas(CACHE_LINE) Line {
+        std::atomic<uint64_t> values[CACHE_LINE / sizeof(uint64_t)] = {};
+    };
+    
+    inline uint64_t bitsOf(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+    
+    inline double doubleOf(uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+// Counter for many concurrent writers and occasional readers
+class ShardedCounter {
+private:
+    struct alignas(counter_detail::CACHE_LINE) Slot {
+        std::atomic<int64_t> value{0};
+    };
+    
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    
+public:
+    // shards is rounded up to a power of two
+    explicit ShardedCounter(size_t shards = counter_detail::defaultShards())
+        : slots_(new Slot[counter_detail::roundShards(shards)]), mask_(counter_detail::roundShards(shards) - 1) {}
+    
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+    
+    void add(int64_t amount = 1) {
+        slots_[counter_detail::threadOrdinal() & mask_].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    ShardedCounter& operator++() {
+        add(1);
+        return *this;
+    }
+    
+    ShardedCounter& operator+=(int64_t amount) {
+        add(amount);
+        return *this;
+    }
+    
+    int64_t read() const {
+        int64_t total = 0;
+        for (size_t i = 0; i <= mask_; ++i) {
+            total += slots_[i].value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+    
+    // Zero every slot; adds racing with this may or may not survive it
+    void reset() {
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    size_t shardCount() const {
+        return mask_ + 1;
+    }
+};
+
+// Histogram over fixed bucket bounds for many concurrent writers: bucket i
+// counts the values above bounds[i - 1] up to and including bounds[i], and
+// one last bucket those above every bound (and NaNs). NaNs are left out
+// of the sum, maximum and mean. Each shard keeps its own bucket counts,
+// sum and maximum in cache lines no other shard uses.
+class ConcurrentHistogram {
+public:
+    struct Snapshot {
+        std::vector<double> bounds;
+        std::vector<uint64_t> counts;   // bounds.size() + 1 buckets
+        uint64_t count = 0;
+        uint64_t nans = 0;   // included in count and the last bucket
+        double sum = 0.0;
+        double max = -std::numeric_limits<double>::infinity();
+        
+        double mean() const {
+            return count > nans ? sum / static_cast<double>(count - nans) : 0.0;
+        }
+        
+        // Value at or below which `percent` of the records fall, reported as
+        // its bucket's upper bound (the maximum for the last bucket, or when
+        // that is lower); 0 for an empty histogram
+        double percentile(double percent) const {
+            if (count == 0) {
+                return 0.0;
+            }
+            double rank = std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(count);
+            uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(rank)));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < bounds.size(); ++i) {
+                seen += counts[i];
+                if (seen >= target) {
+                    return std::min(bounds[i], max);
+                }
+            }
+            return max;
+        }
+    };
+    
+    // count bounds: start, start * factor, start * factor^2, ...
+    static std::vector<double> exponentialBounds(double start, double factor, size_t count) {
+        std::vector<double> bounds;
+        for (double bound = start; bounds.size() < count; bound *= factor) {
+            bounds.push_back(bound);
+        }
+        return bounds;
+    }
+    
+    // count bounds: start, start + width, start + 2 * width, ...
+    static std::vector<double> linearBounds(double start, double width, size_t count) {
+        std::vector<double> bounds;
+        for (size_t i = 0; i < count; ++i) {
+            bounds.push_back(start + width * static_cast<double>(i));
+        }
+        return bounds;
+    }
+    
+private:
+    static constexpr size_t PER_LINE = counter_detail::CACHE_LINE / sizeof(uint64_t);
+    
+    std::vector<double> bounds_;
+    size_t shards_;
+    size_t stride_;   // cells per shard (buckets, sum, max, NaNs), in whole lines
+    std::unique_ptr<counter_detail::Line[]> lines_;
+    
+    size_t sumCell() const { return bounds_.size() + 1; }
+    size_t maxCell() const { return bounds_.size() + 2; }
+    size_t nanCell() const { return bounds_.size() + 3; }
+    
+    std::atomic<uint64_t>& cell(size_t shard, size_t index) const {
+        size_t position = shard * stride_ + index;
+        return lines_[position / PER_LINE].values[position % PER_LINE];
+    }
+    
+public:
+    // bounds must be ascending; shards is rounded up to a power of two
+    explicit ConcurrentHistogram(std::vector<double> bounds, size_t shards = counter_detail::defaultShards())
+        : bounds_(std::move(bounds)), shards_(counter_detail::roundShards(shards)) {
+        if (!std::is_sorted(bounds_.begin(), bounds_.end())) {
+            throw std::invalid_argument("Histogram bounds must be ascending");
+        }
+        stride_ = (bounds_.size() + 4 + PER_LINE - 1) / PER_LINE * PER_LINE;
+        lines_.reset(new counter_detail::Line[shards_ * stride_ / PER_LINE]);
+        reset();
+    }
+    
+    ConcurrentHistogram(const ConcurrentHistogram&) = delete;
+    ConcurrentHistogram& operator=(const ConcurrentHistogram&) = delete;
+    
+    void record(double value) {
+        size_t shard = counter_detail::threadOrdinal() & (shards_ - 1);
+        if (std::isnan(value)) {
+            cell(shard, bounds_.size()).fetch_add(1, std::memory_order_relaxed);
+            cell(shard, nanCell()).fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t bucket = static_cast<size_t>(std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+        cell(shard, bucket).fetch_add(1, std::memory_order_relaxed);
+        
+        // Sum and maximum as double bit patterns; the slot is usually this
+        // thread's alone, so the exchange succeeds first time
+        std::atomic<uint64_t>& sum = cell(shard, sumCell());
+        uint64_t seen = sum.load(std::memory_order_relaxed);
+        while (!sum.compare_exchange_weak(seen, counter_detail::bitsOf(counter_detail::doubleOf(seen) + value),
+                                          std::memory_order_relaxed)) {
+        }
+        std::atomic<uint64_t>& max = cell(shard, maxCell());
+        seen = max.load(std::memory_order_relaxed);
+        while (value > counter_detail::doubleOf(seen) &&
+               !max.compare_exchange_weak(seen, counter_detail::bitsOf(value), std::memory_order_relaxed)) {
+        }
+    }
+    
+    // Bucket counts, sum and maximum over all shards (not atomic as a
+    // whole: a record racing with it may be partly included)
+    Snapshot snapshot() const {
+        Snapshot result;
+        result.bounds = bounds_;
+        result.counts.assign(bounds_.size() + 1, 0);
+        for (size_t shard = 0; shard < shards_; ++shard) {
+            for (size_t bucket = 0; bucket <= bounds_.size(); ++bucket) {
+                result.counts[bucket] += cell(shard, bucket).load(std::memory_order_relaxed);
+            }
+            result.nans += cell(shard, nanCell()).load(std::memory_order_relaxed);
+            result.sum += counter_detail::doubleOf(cell(shard, sumCell()).load(std::memory_order_relaxed));
+            result.max = std::max(result.max, counter_detail::doubleOf(cell(shard, maxCell()).load(std::memory_order_relaxed)));
+        }
+        for (uint64_t count : result.counts) {
+            result.count += count;
+        }
+        return result;
+    }
+    
+    void reset() {
+        for (size_t shard = 0; shard < shards_; ++shard) {
+            for (size_t bucket = 0; bucket <= bounds_.size(); ++bucket) {
+                cell(shard, bucket).store(0, std::memory_order_relaxed);
+            }
+            cell(shard, nanCell()).store(0, std::memory_order_relaxed);
+            cell(shard, sumCell()).store(counter_detail::bitsOf(0.0), std::memory_order_relaxed);
+            cell(shard, maxCell()).store(counter_detail::bitsOf(-std::numeric_limits<double>::infinity()),
+                                         std::memory_order_relaxed);
+        }
+    }
+    
+    const std::vector<double>& bounds() const {
+        return bounds_;
+    }
+    
+    size_t shardCount() const {
+        return shards_;
+    }
+};
+
+#endif // CONCURRENT_COUNTERS_HPP
@@ -0,0 +1,361 @@
+/*
+ * directory_crawler.hpp - Parallel Directory Crawler
+ *
+ * Walks a directory tree on the ThreadPool from advanced_task_scheduler.hpp.
+ * Every directory is one pool task, and the subdirectories it finds are
+ * queued from the worker that found them: they land on that worker's own
+ * deque, where idle workers steal them, so wide and deep trees alike keep
+ * every thread busy. Matching files are reported as they are found:
+ *
+ *   CrawlOptions options;
+ *   options.extensions = {".csv"};
+ *   DirectoryCrawler crawler(options);
+ *   crawler.crawl("shards", [](const CrawlEntry& file) { ... });   // called from the workers
+ *   std::vector<CrawlEntry> files = crawler.list("shards");       // sorted by path
+ *
+ * - On Linux a directory is read with getdents64 into a 64 KiB buffer,
+ *   hundreds of entries per call, and each entry's type comes from d_type:
+ *   subdirectories and files that do not match cost no stat at all
+ * - A matching file costs one statx, relative to the already open
+ *   directory, asking only for size and modification time and passing
+ *   AT_STATX_DONT_SYNC so network filesystems answer from cached
+ *   attributes instead of asking the server
+ * - Elsewhere std::filesystem::directory_iterator, whose entries cache
+ *   their type (and on Windows their size and time) from the listing
+ * - Symlinks are not followed, and names starting with '.' are skipped
+ *   unless includeHidden is set. A subdirectory that cannot be read is
+ *   skipped and listed in CrawlStats::errors; a root that cannot be read
+ *   throws std::runtime_error, as does an exception escaping the callback
+ *   (rethrown after the walk has stopped)
+ */
+
+#ifndef DIRECTORY_CRAWLER_HPP
+#define DIRECTORY_CRAWLER_HPP
+
+#include "advanced_task_scheduler.hpp"
+#include <filesystem>
+#include <string_view>
+#if defined(__linux__)
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// A file found by the crawler
+struct CrawlEntry {
+    std::string path;
+    uint64_t size = 0;
+    std::chrono::system_clock::time_point modified;
+};
+
+struct CrawlOptions {
+    // File name endings to match (".csv"); empty matches every regular file
+    std::vector<std::string> extensions;
+    bool recursive = true;
+    bool includeHidden = false;
+    // Threads of the crawler's own pool (0: hardware concurrency)
+    size_t threads = 0;
+};
+
+struct CrawlStats {
+    size_t directories = 0;
+    size_t entries = 0;     // every name read, matching or not
+    size_t files = 0;       // matching files reported
+    size_t statCalls = 0;
+    std::vector<std::string> errors;   // subdirectories that could not be read
+};
+
+class DirectoryCrawler {
+public:
+    using FileCallback = std::function<void(const CrawlEntry&)>;
+    
+private:
+    CrawlOptions options_;
+    
+    // State shared by the tasks of one crawl
+    struct Walk {
+        const DirectoryCrawler& crawler;
+        const FileCallback& onFile;
+        ThreadPool& pool;
+        
+        std::atomic<size_t> outstanding{0};
+        std::atomic<size_t> directories{0};
+        std::atomic<size_t> entries{0};
+        std::atomic<size_t> files{0};
+        std::atomic<size_t> statCalls{0};
+        std::atomic<bool> stopped{false};
+        
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::vector<std::string> errors;
+        std::exception_ptr failure;
+        
+        Walk(const DirectoryCrawler& c, const FileCallback& f, ThreadPool& p) : crawler(c), onFile(f), pool(p) {}
+    };
+    
+    // One directory to read; queued as a PoolItem so a task allocates
+    // nothing beyond itself
+    class DirectoryItem final : public PoolItem {
+    private:
+        Walk& walk_;
+        std::string path_;
+        
+    public:
+        DirectoryItem(Walk& walk, std::string path) : walk_(walk), path_(std::move(path)) {}
+        
+        RunOutcome run() override {
+            Walk& walk = walk_;
+            if (!walk.stopped.load(std::memory_order_relaxed)) {
+                visit(walk, path_);
+            }
+            delete this;
+            
+            // Under the lock: once outstanding reads 0 the crawl may return
+            // and destroy walk, so nothing may touch it after this
+            std::lock_guard<std::mutex> lock(walk.mutex);
+            if (--walk.outstanding == 0) {
+                walk.finished.notify_all();
+            }
+            return RunOutcome::COMPLETED;
+        }
+    };
+    
+    static void queue(Walk& walk, std::string path) {
+        ++walk.outstanding;
+        walk.pool.enqueue(new DirectoryItem(walk, std::move(path)));
+    }
+    
+    static std::string join(const std::string& directory, std::string_view name) {
+        std::string path;
+        path.reserve(directory.size() + 1 + name.size());
+        path += directory;
+        if (path.empty() || path.back() != '/') {
+            path += '/';
+        }
+        path += name;
+        return path;
+    }
+    
+    static void recordError(Walk& walk, const std::string& path, const std::string& reason) {
+        std::lock_guard<std::mutex> lock(walk.mutex);
+        walk.errors.push_back(path + ": " + reason);
+    }
+    
+    static void report(Walk& walk, const CrawlEntry& entry) {
+        ++walk.files;
+        try {
+            walk.onFile(entry);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(walk.mutex);
+            if (!walk.failure) {
+                walk.failure = std::current_exception();
+            }
+            walk.stopped = true;
+        }
+    }
+    
+    // Skip ".", ".." and (unless asked for) hidden names
+    bool skipped(std::string_view name) const {
+        return name == "." || name == ".." || (!options_.includeHidden && name.front() == '.');
+    }
+
+#if defined(__linux__)
+    struct LinuxDirent64 {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+    
+    static constexpr size_t LISTING_BYTES = 64 * 1024;
+    
+    static void visit(Walk& walk, const std::string& path) {
+        const DirectoryCrawler& crawler = walk.crawler;
+        int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            recordError(walk, path, std::error_code(errno, std::generic_category()).message());
+            return;
+        }
+        ++walk.directories;
+        
+        thread_local std::vector<char> listing(LISTING_BYTES);
+        while (!walk.stopped.load(std::memory_order_relaxed)) {
+            long bytes = ::syscall(SYS_getdents64, fd, listing.data(), listing.size());
+            if (bytes <= 0) {
+                if (bytes < 0) recordError(walk, path, std::error_code(errno, std::generic_category()).message());
+                break;
+            }
+            
+            for (long offset = 0; offset < bytes;) {
+                const auto* entry = reinterpret_cast<const LinuxDirent64*>(listing.data() + offset);
+                offset += entry->d_reclen;
+                std::string_view name(entry->d_name);
+                if (crawler.skipped(name)) continue;
+                ++walk.entries;
+                
+                unsigned char type = entry->d_type;
+                bool match = crawler.matches(name);
+                if (type == DT_DIR) {
+                    if (crawler.options_.recursive) queue(walk, join(path, name));
+                    continue;
+                }
+                if ((type != DT_REG && type != DT_UNKNOWN) || (type == DT_REG && !match)) {
+                    continue;
+                }
+                
+                // DT_UNKNOWN (some filesystems never fill d_type): the statx
+                // that fetches size and time tells the type too
+                CrawlEntry file;
+                if (!statEntry(walk, fd, name, type == DT_UNKNOWN, file, type)) continue;
+                if (type == DT_DIR) {
+                    if (crawler.options_.recursive) queue(walk, join(path, name));
+                } else if (type == DT_REG && match) {
+                    file.path = join(path, name);
+                    report(walk, file);
+                }
+            }
+        }
+        ::close(fd);
+    }
+    
+    // Size and modification time of name in the directory fd; type is set
+    // from the result when wantType. False if the entry vanished meanwhile.
+    static bool statEntry(Walk& walk, int fd, std::string_view name, bool wantType,
+                          CrawlEntry& file, unsigned char& type) {
+        ++walk.statCalls;
+        std::string terminated(name);
+#if defined(STATX_SIZE)
+        struct statx status;
+        unsigned mask = STATX_SIZE | STATX_MTIME | (wantType ? STATX_TYPE : 0);
+        if (::statx(fd, terminated.c_str(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, mask, &status) != 0) {
+            return false;
+        }
+        auto mode = status.stx_mode;
+        file.size = status.stx_size;
+        file.modified = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(status.stx_mtime.tv_sec) + std::chrono::nanoseconds(status.stx_mtime.tv_nsec)));
+#else
+        struct stat status;
+        if (::fstatat(fd, terminated.c_str(), &status, AT_SYMLINK_NOFOLLOW) != 0) {
+            return false;
+        }
+        auto mode = status.st_mode;
+        file.size = status.st_size;
+        file.modified = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds(status.st_mtim.tv_sec) + std::chrono::nanoseconds(status.st_mtim.tv_nsec)));
+#endif
+        if (wantType) {
+            type = S_ISDIR(mode) ? DT_DIR : S_ISREG(mode) ? DT_REG : DT_UNKNOWN;
+        }
+        return true;
+    }
+#else
+    static void visit(Walk& walk, const std::string& path) {
+        namespace fs = std::filesystem;
+        const DirectoryCrawler& crawler = walk.crawler;
+        std::error_code error;
+        fs::directory_iterator it(path, error);
+        if (error) {
+            recordError(walk, path, error.message());
+            return;
+        }
+        ++walk.directories;
+        
+        for (; it != fs::directory_iterator() && !walk.stopped.load(std::memory_order_relaxed); it.increment(error)) {
+            if (error) {
+                recordError(walk, path, error.message());
+                break;
+            }
+            const fs::directory_entry& entry = *it;
+            std::string name = entry.path().filename().string();
+            if (crawler.skipped(name)) continue;
+            ++walk.entries;
+            
+            std::error_code status;
+            if (entry.is_symlink(status)) continue;
+            if (entry.is_directory(status)) {
+                if (crawler.options_.recursive) queue(walk, join(path, name));
+            } else if (entry.is_regular_file(status) && crawler.matches(name)) {
+                ++walk.statCalls;
+                CrawlEntry file;
+                file.path = join(path, name);
+                file.size = entry.file_size(status);
+                auto written = entry.last_write_time(status);
+                file.modified = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                    written - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+                report(walk, file);
+            }
+        }
+    }
+#endif
+
+public:
+    explicit DirectoryCrawler(CrawlOptions options = CrawlOptions()) : options_(std::move(options)) {}
+    
+    const CrawlOptions& options() const { return options_; }
+    
+    bool matches(std::string_view name) const {
+        if (options_.extensions.empty()) return true;
+        return std::any_of(options_.extensions.begin(), options_.extensions.end(), [name](const std::string& ending) {
+            return name.size() >= ending.size() && name.substr(name.size() - ending.size()) == ending;
+        });
+    }
+    
+    // Calls onFile for every matching file under root, from the pool's
+    // threads and in no particular order, and returns once the whole tree
+    // has been walked. With a caller's pool, onFile may queue more work on
+    // it (see DataSet::load_from_csv_directory); crawl must not be called
+    // from one of that pool's own tasks.
+    CrawlStats crawl(const std::string& root, const FileCallback& onFile, ThreadPool& pool) const {
+        std::string start = root;
+        while (start.size() > 1 && start.back() == '/') {
+            start.pop_back();
+        }
+        std::error_code error;
+        if (!std::filesystem::is_directory(start, error)) {
+            throw std::runtime_error("Cannot read directory: " + root);
+        }
+        
+        Walk walk(*this, onFile, pool);
+        queue(walk, start);
+        {
+            std::unique_lock<std::mutex> lock(walk.mutex);
+            walk.finished.wait(lock, [&walk] { return walk.outstanding.load() == 0; });
+        }
+        if (walk.failure) {
+            std::rethrow_exception(walk.failure);
+        }
+        
+        CrawlStats stats;
+        stats.directories = walk.directories;
+        stats.entries = walk.entries;
+        stats.files = walk.files;
+        stats.statCalls = walk.statCalls;
+        stats.errors = std::move(walk.errors);
+        return stats;
+    }
+    
+    CrawlStats crawl(const std::string& root, const FileCallback& onFile) const {
+        ThreadPool pool(options_.threads ? options_.threads : std::max(1u, std::thread::hardware_concurrency()));
+        return crawl(root, onFile, pool);
+    }
+    
+    // Every matching file under root, sorted by path
+    std::vector<CrawlEntry> list(const std::string& root, CrawlStats* stats = nullptr) const {
+        std::mutex mutex;
+        std::vector<CrawlEntry> files;
+        CrawlStats result = crawl(root, [&](const CrawlEntry& file) {
+            std::lock_guard<std::mutex> lock(mutex);
+            files.push_back(file);
+        });
+        std::sort(files.begin(), files.end(), [](const CrawlEntry& a, const CrawlEntry& b) { return a.path < b.path; });
+        if (stats) *stats = std::move(result);
+        return files;
+    }
+};
+
+#endif // DIRECTORY_CRAWLER_HPP
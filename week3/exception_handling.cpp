@@ -5,6 +5,7 @@
 #include <fstream>
 #include <stdexcept>
 #include <functional>
+#include "expected.hpp"
 
 // Custom exception classes
 class FileException : public std::exception {
@@ -33,22 +34,63 @@ public:
     }
 };
 
-// RAII file wrapper
+// Why a FileHandler operation failed, for the non-throwing versions
+enum class FileError {
+    OpenFailed,
+    NotOpen,
+    WriteFailed,
+    ReadFailed
+};
+
+const char* describe(FileError error) {
+    switch (error) {
+        case FileError::OpenFailed:  return "Failed to open file";
+        case FileError::NotOpen:     return "File is not open";
+        case FileError::WriteFailed: return "Write operation failed";
+        case FileError::ReadFailed:  return "Read operation failed";
+    }
+    return "Unknown error";
+}
+
+// RAII file wrapper. Each operation comes in two forms: the throwing one,
+// and one returning stdx::expected for callers that expect failures often
+// enough that a throw per failure would cost too much. The throwing forms
+// are wrappers around the others.
 class FileHandler {
 private:
     std::fstream file;
     std::string filename;
     bool isOpen;
     
+    struct Unopened {};
+    
+    FileHandler(Unopened, const std::string& name) : filename(name), isOpen(false) {}
+    
+    bool openFile(std::ios_base::openmode mode) {
+        file.open(filename, mode);
+        isOpen = file.is_open();
+        if (isOpen) {
+            std::cout << "File '" << filename << "' opened successfully." << std::endl;
+        }
+        return isOpen;
+    }
+    
 public:
     explicit FileHandler(const std::string& name, std::ios_base::openmode mode = std::ios_base::in)
-        : filename(name), isOpen(false) {
-        file.open(filename, mode);
-        if (!file.is_open()) {
-            throw FileException(filename, "Failed to open file");
+        : FileHandler(Unopened{}, name) {
+        if (!openFile(mode)) {
+            throw FileException(filename, describe(FileError::OpenFailed));
         }
-        isOpen = true;
-        std::cout << "File '" << filename << "' opened successfully." << std::endl;
+    }
+    
+    // Open without throwing
+    static stdx::expected<FileHandler, FileError> open(const std::string& name,
+                                                       std::ios_base::openmode mode = std::ios_base::in) {
+        FileHandler handler(Unopened{}, name);
+        if (!handler.openFile(mode)) {
+            return stdx::unexpected(FileError::OpenFailed);
+        }
+        return handler;
     }
     
     ~FileHandler() {
@@ -82,18 +124,34 @@ public:
     }
     
     void write(const std::string& data) {
+        auto written = tryWrite(data);
+        if (!written) {
+            throw FileException(filename, describe(written.error()));
+        }
+    }
+    
+    stdx::expected<void, FileError> tryWrite(const std::string& data) {
         if (!isOpen) {
-            throw FileException(filename, "File is not open");
+            return stdx::unexpected(FileError::NotOpen);
         }
         file << data;
         if (file.fail()) {
-            throw FileException(filename, "Write operation failed");
+            return stdx::unexpected(FileError::WriteFailed);
         }
+        return {};
     }
     
     std::string read() {
+        auto content = tryRead();
+        if (!content) {
+            throw FileException(filename, describe(content.error()));
+        }
+        return *std::move(content);
+    }
+    
+    stdx::expected<std::string, FileError> tryRead() {
         if (!isOpen) {
-            throw FileException(filename, "File is not open");
+            return stdx::unexpected(FileError::NotOpen);
         }
         
         std::string content;
@@ -103,7 +161,7 @@ public:
         }
         
         if (file.bad()) {
-            throw FileException(filename, "Read operation failed");
+            return stdx::unexpected(FileError::ReadFailed);
         }
         
         return content;
@@ -329,6 +387,12 @@ int main() {
         catch (const FileException& e) {
             std::cout << "Caught file exception: " << e.what() << std::endl;
         }
+        
+        // The same failure as a return value: nothing is thrown
+        auto missing = FileHandler::open("non_existent_file.txt");
+        if (!missing) {
+            std::cout << "FileHandler::open reported: " << describe(missing.error()) << std::endl;
+        }
     }
     catch (const std::exception& e) {
         std::cout << "Exception caught: " << e.what() << std::endl;
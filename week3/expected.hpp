@@ -0,0 +1,209 @@
+/*
+ * expected.hpp - Value-or-Error Results Without Exceptions
+ *
+ * stdx::expected<T, E> holds either a T or the E explaining why there is
+ * none, so a call that fails routinely (a cell that is not a number, a
+ * lookup that misses) can report it as an ordinary return value instead
+ * of paying for a throw and an unwind on every failure.
+ *
+ *   stdx::expected<int, ParseError> parse(std::string_view text);
+ *
+ *   auto number = parse(cell);
+ *   if (!number) {
+ *       log(number.error());
+ *   }
+ *   int value = number.value_or(0);
+ *   return stdx::unexpected(ParseError::Empty);   // failing
+ *
+ * With C++23's <expected> these are the std types; under C++17 they are a
+ * backport of the part of the std interface used here: construction from a
+ * value or stdx::unexpected, has_value / operator bool, operator* and ->,
+ * value() (throws stdx::bad_expected_access<E> when there is none),
+ * error(), value_or, and expected<void, E>. Code written against that
+ * subset compiles either way.
+ */
+
+#ifndef EXPECTED_HPP
+#define EXPECTED_HPP
+
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202211L
+#include <expected>
+#endif
+
+namespace stdx {
+
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202211L
+
+using std::bad_expected_access;
+using std::expected;
+using std::unexpect;
+using std::unexpect_t;
+using std::unexpected;
+
+#else
+
+// The error half of an expected, wrapped so that it converts to one
+template<typename E>
+class unexpected {
+private:
+    E error_;
+    
+public:
+    explicit unexpected(E error) : error_(std::move(error)) {}
+    
+    const E& error() const& { return error_; }
+    E& error() & { return error_; }
+    E&& error() && { return std::move(error_); }
+};
+
+template<typename E>
+unexpected(E) -> unexpected<E>;
+
+// Thrown by value() on an expected that holds an error
+template<typename E>
+class bad_expected_access : public std::exception {
+private:
+    E error_;
+    
+public:
+    explicit bad_expected_access(E error) : error_(std::move(error)) {}
+    
+    const char* what() const noexcept override {
+        return "bad access to expected without a value";
+    }
+    
+    const E& error() const& { return error_; }
+    E& error() & { return error_; }
+};
+
+// Tag for constructing an expected's error in place
+struct unexpect_t {
+    explicit unexpect_t() = default;
+};
+
+inline constexpr unexpect_t unexpect{};
+
+template<typename T, typename E>
+class expected {
+private:
+    std::variant<T, E> storage_;   // index 0: value, 1: error
+    
+    template<typename U>
+    static constexpr bool is_value_argument_v =
+        std::is_constructible_v<T, U> &&
+        !std::is_same_v<std::decay_t<U>, expected> &&
+        !std::is_same_v<std::decay_t<U>, unexpect_t> &&
+        !std::is_same_v<std::decay_t<U>, std::in_place_t>;
+    
+public:
+    using value_type = T;
+    using error_type = E;
+    
+    expected() : storage_(std::in_place_index<0>) {}
+    
+    template<typename U = T, typename = std::enable_if_t<is_value_argument_v<U>>>
+    expected(U&& value) : storage_(std::in_place_index<0>, std::forward<U>(value)) {}
+    
+    template<typename... Args>
+    explicit expected(std::in_place_t, Args&&... args)
+        : storage_(std::in_place_index<0>, std::forward<Args>(args)...) {}
+    
+    template<typename G>
+    expected(const unexpected<G>& error) : storage_(std::in_place_index<1>, error.error()) {}
+    
+    template<typename G>
+    expected(unexpected<G>&& error) : storage_(std::in_place_index<1>, std::move(error).error()) {}
+    
+    template<typename... Args>
+    explicit expected(unexpect_t, Args&&... args)
+        : storage_(std::in_place_index<1>, std::forward<Args>(args)...) {}
+    
+    bool has_value() const noexcept { return storage_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+    
+    // Unchecked access: the expected must hold a value
+    T& operator*() & { return *std::get_if<0>(&storage_); }
+    const T& operator*() const& { return *std::get_if<0>(&storage_); }
+    T&& operator*() && { return std::move(*std::get_if<0>(&storage_)); }
+    T* operator->() { return std::get_if<0>(&storage_); }
+    const T* operator->() const { return std::get_if<0>(&storage_); }
+    
+    T& value() & {
+        if (!has_value()) throw bad_expected_access<E>(error());
+        return **this;
+    }
+    
+    const T& value() const& {
+        if (!has_value()) throw bad_expected_access<E>(error());
+        return **this;
+    }
+    
+    T&& value() && {
+        if (!has_value()) throw bad_expected_access<E>(error());
+        return std::move(**this);
+    }
+    
+    // Unchecked access: the expected must hold an error
+    E& error() & { return *std::get_if<1>(&storage_); }
+    const E& error() const& { return *std::get_if<1>(&storage_); }
+    E&& error() && { return std::move(*std::get_if<1>(&storage_)); }
+    
+    template<typename U>
+    T value_or(U&& fallback) const& {
+        return has_value() ? **this : static_cast<T>(std::forward<U>(fallback));
+    }
+    
+    template<typename U>
+    T value_or(U&& fallback) && {
+        return has_value() ? std::move(**this) : static_cast<T>(std::forward<U>(fallback));
+    }
+};
+
+// Success carries nothing; only the error is stored
+template<typename E>
+class expected<void, E> {
+private:
+    std::optional<E> error_;
+    
+public:
+    using value_type = void;
+    using error_type = E;
+    
+    expected() = default;
+    
+    template<typename G>
+    expected(const unexpected<G>& error) : error_(std::in_place, error.error()) {}
+    
+    template<typename G>
+    expected(unexpected<G>&& error) : error_(std::in_place, std::move(error).error()) {}
+    
+    template<typename... Args>
+    explicit expected(unexpect_t, Args&&... args) : error_(std::in_place, std::forward<Args>(args)...) {}
+    
+    bool has_value() const noexcept { return !error_; }
+    explicit operator bool() const noexcept { return has_value(); }
+    
+    void operator*() const noexcept {}
+    
+    void value() const {
+        if (error_) throw bad_expected_access<E>(*error_);
+    }
+    
+    E& error() & { return *error_; }
+    const E& error() const& { return *error_; }
+    E&& error() && { return std::move(*error_); }
+};
+
+#endif
+
+} // namespace stdx
+
+#endif // EXPECTED_HPP
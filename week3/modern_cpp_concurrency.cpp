@@ -10,6 +10,10 @@
 #include <atomic>
 #include <random>
 #include <iomanip>
+#include <limits>
+#include <string>
+#include "parallel_algorithms.hpp"
+#include "concurrent_counters.hpp"
 
 // Helper function to print a line separator
 void printSeparator(const std::string& title) {
@@ -78,12 +82,79 @@ void demonstrateAlgorithms() {
     std::cout << "accumulate time: " << accumulateTime << " microseconds" << std::endl;
 }
 
+// Function to benchmark the parallel algorithms at each thread count
+void demonstrateParallelScaling() {
+    printSeparator("Parallel Algorithm Scaling");
+    
+    const size_t dataSize = 4000000;
+    const int repeats = 3;
+    auto data = generateRandomData(dataSize);
+    std::vector<long long> output(dataSize);
+    
+    // Best of a few runs of sort, transform and transform_reduce under policy
+    auto timeAll = [&](const auto& policy) {
+        std::vector<long long> best(3, std::numeric_limits<long long>::max());
+        for (int run = 0; run < repeats; ++run) {
+            auto copy = data;
+            best[0] = std::min(best[0], measureExecutionTime([&]() {
+                parallel::sort(policy, copy.begin(), copy.end());
+            }));
+            best[1] = std::min(best[1], measureExecutionTime([&]() {
+                parallel::transform(policy, data.begin(), data.end(), output.begin(),
+                                    [](int x) { return static_cast<long long>(x) * x; });
+            }));
+            best[2] = std::min(best[2], measureExecutionTime([&]() {
+                volatile long long sum = parallel::transform_reduce(policy, data.begin(), data.end(), 0LL,
+                    std::plus<>(), [](int x) { return static_cast<long long>(x) * x; });
+                (void)sum;
+            }));
+        }
+        return best;
+    };
+    
+    std::cout << "Sorting, squaring and summing the squares of " << dataSize << " integers ("
+              << (parallel::usesStdBackend ? "standard library backend" : "fallback pool") << ")" << std::endl;
+    std::vector<long long> sequential = timeAll(parallel::seq);
+    
+    auto printRow = [&](const std::string& label, const std::vector<long long>& times) {
+        std::cout << std::left << std::setw(10) << label << std::right;
+        for (size_t i = 0; i < times.size(); ++i) {
+            std::cout << std::setw(10) << times[i] << " us " << std::fixed << std::setprecision(2)
+                      << std::setw(5) << static_cast<double>(sequential[i]) / times[i] << "x";
+        }
+        std::cout << std::endl;
+    };
+    std::cout << std::left << std::setw(10) << "" << std::right << std::setw(20) << "sort"
+              << std::setw(20) << "transform" << std::setw(20) << "transform_reduce" << std::endl;
+    printRow("seq", sequential);
+    
+    // The std backend sizes its own thread pool, so it gets a single row
+    if (parallel::usesStdBackend) {
+        printRow("par", timeAll(parallel::par));
+        return;
+    }
+    
+    size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < hardwareThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+    
+    size_t originalThreads = parallel::threadCount();
+    for (size_t threads : threadCounts) {
+        parallel::setThreadCount(threads);
+        printRow("par x" + std::to_string(threads), timeAll(parallel::par));
+    }
+    parallel::setThreadCount(originalThreads);
+}
+
 // Thread-safe counter using mutex
 class MutexCounter {
 private:
     std::mutex mutex;
     int value = 0;
-
+    
 public:
     void increment() {
         std::lock_guard<std::mutex> lock(mutex);
@@ -100,7 +171,7 @@ public:
 class AtomicCounter {
 private:
     std::atomic<int> value{0};
-
+    
 public:
     void increment() {
         ++value;
@@ -111,57 +182,88 @@ public:
     }
 };
 
-// Function to demonstrate concurrency features
-void demonstrateConcurrency() {
-    printSeparator("Modern Concurrency Features");
-    
-    // Compare mutex vs atomic performance
-    const int numIncrements = 1000000;
-    const int numThreads = 10;
-    
-    MutexCounter mutexCounter;
-    AtomicCounter atomicCounter;
-    
-    std::cout << "Comparing mutex vs atomic for " << numIncrements 
-              << " increments across " << numThreads << " threads..." << std::endl;
-    
-    // Test mutex counter
-    long long mutexTime = measureExecutionTime([&]() {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([&mutexCounter, numIncrements]() {
-                for (int j = 0; j < numIncrements / 10; ++j) {
-                    mutexCounter.increment();
-                }
-            });
-        }
-        
-        for (auto& t : threads) {
-            t.join();
-        }
-    });
+// Runs increment() perThread times on each of numThreads threads and
+// returns the microseconds from the moment all of them are ready to go
+// until the last one finishes
+template<typename Increment>
+long long runContended(int numThreads, int perThread, Increment increment) {
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&]() {
+            ++ready;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int j = 0; j < perThread; ++j) {
+                increment();
+            }
+        });
+    }
+    while (ready.load() < numThreads) {
+        std::this_thread::yield();
+    }
     
-    // Test atomic counter
-    long long atomicTime = measureExecutionTime([&]() {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([&atomicCounter, numIncrements]() {
-                for (int j = 0; j < numIncrements / 10; ++j) {
-                    atomicCounter.increment();
-                }
-            });
-        }
-        
+    return measureExecutionTime([&]() {
+        go.store(true, std::memory_order_release);
         for (auto& t : threads) {
             t.join();
         }
     });
+}
+
+// Function to demonstrate concurrency features
+void demonstrateConcurrency() {
+    printSeparator("Modern Concurrency Features");
     
-    std::cout << "Mutex counter result: " << mutexCounter.get() << std::endl;
-    std::cout << "Atomic counter result: " << atomicCounter.get() << std::endl;
-    std::cout << "Mutex time: " << mutexTime << " microseconds" << std::endl;
-    std::cout << "Atomic time: " << atomicTime << " microseconds" << std::endl;
-    std::cout << "Speedup (atomic vs mutex): " << static_cast<double>(mutexTime) / atomicTime << "x" << std::endl;
+    // Contention benchmark: the same number of increments spread over more
+    // and more threads, on a mutex, one atomic, a sharded counter and a
+    // sharded histogram. Results are in millions of increments per second.
+    const int totalIncrements = 4000000;
+    std::cout << "Counting " << totalIncrements << " increments split across 1 to 128 threads "
+              << "(millions per second, " << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+    std::cout << std::setw(8) << "Threads" << std::setw(12) << "Mutex" << std::setw(12) << "Atomic"
+              << std::setw(12) << "Sharded" << std::setw(12) << "Histogram" << std::endl;
+    
+    bool exact = true;
+    for (int numThreads = 1; numThreads <= 128; numThreads *= 2) {
+        const int perThread = totalIncrements / numThreads;
+        const long long expected = static_cast<long long>(perThread) * numThreads;
+        auto rate = [perThread, numThreads](long long micros) {
+            return static_cast<double>(perThread) * numThreads / std::max(1LL, micros);
+        };
+    
+        MutexCounter mutexCounter;
+        AtomicCounter atomicCounter;
+        ShardedCounter shardedCounter;
+        ConcurrentHistogram histogram(ConcurrentHistogram::linearBounds(0, 1, 8));
+    
+        long long mutexTime = runContended(numThreads, perThread, [&]() { mutexCounter.increment(); });
+        long long atomicTime = runContended(numThreads, perThread, [&]() { atomicCounter.increment(); });
+        long long shardedTime = runContended(numThreads, perThread, [&]() { shardedCounter.add(); });
+        long long histogramTime = runContended(numThreads, perThread, [&]() { histogram.record(3.0); });
+    
+        exact = exact && mutexCounter.get() == expected && atomicCounter.get() == expected &&
+                shardedCounter.read() == expected && histogram.snapshot().count == static_cast<uint64_t>(expected);
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << numThreads
+                  << std::setw(12) << rate(mutexTime) << std::setw(12) << rate(atomicTime)
+                  << std::setw(12) << rate(shardedTime) << std::setw(12) << rate(histogramTime) << std::endl;
+    }
+    std::cout << std::defaultfloat << "All counts exact: " << std::boolalpha << exact << std::endl;
+    
+    // A NaN lands in the last bucket and stays out of the sum and mean
+    ConcurrentHistogram latencies({1.0, 2.0, 3.0});
+    latencies.record(std::numeric_limits<double>::quiet_NaN());
+    latencies.record(5.0);
+    latencies.record(1.5);
+    ConcurrentHistogram::Snapshot recorded = latencies.snapshot();
+    std::cout << "Buckets after recording NaN, 5 and 1.5:";
+    for (uint64_t count : recorded.counts) {
+        std::cout << " " << count;
+    }
+    std::cout << " (mean " << std::setprecision(3) << recorded.mean() << ", NaN in the last bucket: "
+              << (recorded.counts == std::vector<uint64_t>{0, 1, 0, 2} && recorded.mean() == 3.25) << ")" << std::endl;
     
     // Demonstrate std::future and std::async
     printSeparator("std::future and std::async");
@@ -286,6 +388,7 @@ int main() {
     std::cout << "===== Modern C++ Part 5: Concurrency and Parallel Algorithms =====" << std::endl;
     
     demonstrateAlgorithms();
+    demonstrateParallelScaling();
     demonstrateConcurrency();
     
     return 0;
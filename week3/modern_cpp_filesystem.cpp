@@ -7,6 +7,7 @@
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include "directory_crawler.hpp"
 
 namespace fs = std::filesystem;
 
@@ -15,10 +16,12 @@ void printSeparator(const std::string& title) {
     std::cout << "\n--- " << title << " ---" << std::endl;
 }
 
-// Helper function to print file information
+// Helper function to print file information. The directory_entry member
+// functions use the status the iterator already has where they can; the
+// free functions (fs::file_size(entry), ...) always ask the filesystem again
 void printFileInfo(const fs::directory_entry& entry) {
     try {
-        auto lastWriteTime = fs::last_write_time(entry);
+        auto lastWriteTime = entry.last_write_time();
         auto timePoint = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
             lastWriteTime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
         
@@ -26,15 +29,15 @@ void printFileInfo(const fs::directory_entry& entry) {
         
         std::cout << std::left << std::setw(40) << entry.path().filename().string();
         
-        if (fs::is_regular_file(entry)) {
-            std::cout << std::setw(10) << fs::file_size(entry) << " bytes";
+        if (entry.is_regular_file()) {
+            std::cout << std::setw(10) << entry.file_size() << " bytes";
         } else {
             std::cout << std::setw(10) << "<DIR>";
         }
         
         std::cout << "  " << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
         
-        if (fs::is_symlink(entry)) {
+        if (entry.is_symlink()) {
             std::cout << " -> " << fs::read_symlink(entry);
         }
         
@@ -198,7 +201,7 @@ void demonstrateFilesystem() {
         // Clean up
         fs::remove_all(tempDir);
         std::cout << "\nRemoved directory: " << tempDir << std::endl;
-        
+    
     } catch (const fs::filesystem_error& e) {
         std::cout << "Filesystem error: " << e.what() << std::endl;
     } catch (const std::exception& e) {
@@ -206,11 +209,72 @@ void demonstrateFilesystem() {
     }
 }
 
+// Function to compare a recursive_directory_iterator walk with the
+// parallel crawler on a tree of many small files
+void demonstrateParallelCrawl() {
+    printSeparator("Parallel directory crawl");
+    
+    fs::path root = fs::current_path() / "crawl_demo";
+    const int directories = 50;
+    const int filesPerDirectory = 40;
+    try {
+        fs::remove_all(root);
+        for (int d = 0; d < directories; ++d) {
+            fs::path dir = root / ("day-" + std::to_string(d)) / "hourly";
+            fs::create_directories(dir);
+            for (int f = 0; f < filesPerDirectory; ++f) {
+                std::ofstream(dir / ("shard-" + std::to_string(f) + (f % 4 == 0 ? ".log" : ".csv"))) << "id,value\n" << f << ",1\n";
+            }
+        }
+        
+        // Serial walk: one stat per entry for the type, then more for size and time
+        size_t serialFiles = 0;
+        uintmax_t serialBytes = 0;
+        fs::file_time_type newest{};
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& entry : fs::recursive_directory_iterator(root)) {
+            if (fs::is_regular_file(entry.path()) && entry.path().extension() == ".csv") {
+                serialBytes += fs::file_size(entry.path());
+                newest = std::max(newest, fs::last_write_time(entry.path()));
+                ++serialFiles;
+            }
+        }
+        double serialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        // Parallel crawl: types from the listing, one statx per matching file
+        CrawlOptions options;
+        options.extensions = {".csv"};
+        DirectoryCrawler crawler(options);
+        CrawlStats stats;
+        start = std::chrono::steady_clock::now();
+        std::vector<CrawlEntry> files = crawler.list(root.string(), &stats);
+        double crawlMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        uintmax_t crawlBytes = 0;
+        for (const auto& file : files) {
+            crawlBytes += file.size;
+        }
+        
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "recursive_directory_iterator: " << serialFiles << " .csv files, " << serialBytes
+                  << " bytes in " << serialMs << " ms" << std::endl;
+        std::cout << "DirectoryCrawler:             " << files.size() << " .csv files, " << crawlBytes
+                  << " bytes in " << crawlMs << " ms (" << stats.directories << " directories, "
+                  << stats.entries << " entries, " << stats.statCalls << " stat calls)" << std::endl;
+        std::cout << "First file: " << (files.empty() ? "none" : files.front().path) << std::endl;
+        
+        fs::remove_all(root);
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+}
+
 int main() {
     std::cout << "===== Modern C++ Part 4: string_view and filesystem =====" << std::endl;
     
     demonstrateStringView();
     demonstrateFilesystem();
+    demonstrateParallelCrawl();
     
     return 0;
 }
@@ -0,0 +1,425 @@
+/*
+ * parallel_algorithms.hpp - Execution Policies With a Fallback Pool
+ *
+ * The C++17 execution-policy overloads of the std algorithms, forwarded to
+ * the standard library where it can run them and to a small fork-join pool
+ * where it cannot:
+ *
+ *   parallel::sort(parallel::par, values.begin(), values.end());
+ *   double total = parallel::transform_reduce(parallel::par, points.begin(), points.end(),
+ *                                             0.0, std::plus<>(), [](const Point& p) { return p.value; });
+ *
+ * - parallel::seq, par and par_unseq are std::execution's policy objects
+ *   when the std backend is in use, stand-in tags otherwise; code written
+ *   against parallel:: compiles either way
+ * - libstdc++ runs the policy overloads on TBB, and merely including
+ *   <execution> makes a program need -ltbb. The std backend is therefore
+ *   used with MSVC, or when PARALLEL_ALGORITHMS_TBB is defined (and -ltbb
+ *   given); otherwise par and par_unseq split the range into one chunk per
+ *   thread of the fallback pool, and par_unseq is treated as par
+ * - seq always runs the plain sequential algorithm; seq transform_reduce is
+ *   a left fold, so it gives std::accumulate's result to the bit
+ * - As with std::execution::par, functions passed with par are called from
+ *   several threads at once and must not race. The fallback pool rethrows
+ *   the first exception on the calling thread (std calls std::terminate)
+ * - The parallel paths need random-access iterators
+ */
+
+#ifndef PARALLEL_ALGORITHMS_HPP
+#define PARALLEL_ALGORITHMS_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// The feature macros can already be set by an earlier <version>, so the
+// backend is only chosen where <execution> itself was included
+#if defined(_MSC_VER) || defined(PARALLEL_ALGORITHMS_TBB)
+#if __has_include(<execution>)
+#include <execution>
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
+#define PARALLEL_ALGORITHMS_STD_BACKEND 1
+#endif
+#endif
+#endif
+
+namespace parallel {
+
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+using std::execution::sequenced_policy;
+using std::execution::parallel_policy;
+using std::execution::parallel_unsequenced_policy;
+using std::execution::seq;
+using std::execution::par;
+using std::execution::par_unseq;
+
+inline constexpr bool usesStdBackend = true;
+#else
+struct sequenced_policy {};
+struct parallel_policy {};
+struct parallel_unsequenced_policy {};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+inline constexpr parallel_unsequenced_policy par_unseq{};
+
+inline constexpr bool usesStdBackend = false;
+#endif
+
+template<typename T>
+inline constexpr bool is_execution_policy_v =
+    std::is_same_v<std::decay_t<T>, sequenced_policy> ||
+    std::is_same_v<std::decay_t<T>, parallel_policy> ||
+    std::is_same_v<std::decay_t<T>, parallel_unsequenced_policy>;
+
+// Fork-join pool for the fallback path: run(tasks, fn) calls fn(0) ..
+// fn(tasks - 1) on the workers and the calling thread, and returns when
+// all of them have finished. Runs from several threads take turns; a run
+// started from inside a task executes inline on that task's thread.
+class FallbackPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable done;
+    std::mutex runMutex;
+    
+    const std::function<void(size_t)>* job = nullptr;
+    size_t taskCount = 0;
+    size_t nextTask = 0;
+    size_t finished = 0;
+    std::exception_ptr error;
+    bool stopping = false;
+    
+    static bool& insideTask() {
+        thread_local bool inside = false;
+        return inside;
+    }
+    
+    // Claims and runs tasks of the current job until none are left
+    void drain(std::unique_lock<std::mutex>& lock) {
+        while (nextTask < taskCount) {
+            size_t task = nextTask++;
+            lock.unlock();
+            std::exception_ptr failure;
+            insideTask() = true;
+            try {
+                (*job)(task);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            insideTask() = false;
+            lock.lock();
+            if (failure && !error) {
+                error = failure;
+            }
+            if (++finished == taskCount) {
+                done.notify_one();
+            }
+        }
+    }
+    
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            work.wait(lock, [this] { return stopping || nextTask < taskCount; });
+            if (stopping) {
+                return;
+            }
+            drain(lock);
+        }
+    }
+    
+    void start(size_t threads) {
+        stopping = false;
+        for (size_t i = 1; i < threads; ++i) {
+            workers.emplace_back(&FallbackPool::workerLoop, this);
+        }
+    }
+    
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+    
+public:
+    explicit FallbackPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        start(std::max<size_t>(threads, 1));
+    }
+    
+    ~FallbackPool() {
+        stop();
+    }
+    
+    FallbackPool(const FallbackPool&) = delete;
+    FallbackPool& operator=(const FallbackPool&) = delete;
+    
+    // Threads a run uses, the calling thread included
+    size_t threadCount() const {
+        return workers.size() + 1;
+    }
+    
+    void resize(size_t threads) {
+        std::lock_guard<std::mutex> turn(runMutex);
+        stop();
+        start(std::max<size_t>(threads, 1));
+    }
+    
+    void run(size_t tasks, const std::function<void(size_t)>& fn) {
+        if (tasks == 0) {
+            return;
+        }
+        if (tasks == 1 || workers.empty() || insideTask()) {
+            for (size_t task = 0; task < tasks; ++task) {
+                fn(task);
+            }
+            return;
+        }
+        
+        std::lock_guard<std::mutex> turn(runMutex);
+        std::unique_lock<std::mutex> lock(mutex);
+        job = &fn;
+        taskCount = tasks;
+        nextTask = finished = 0;
+        error = nullptr;
+        work.notify_all();
+        
+        drain(lock);
+        done.wait(lock, [this] { return finished == taskCount; });
+        
+        std::exception_ptr failure = error;
+        job = nullptr;
+        taskCount = nextTask = finished = 0;
+        error = nullptr;
+        lock.unlock();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+};
+
+inline FallbackPool& fallbackPool() {
+    static FallbackPool pool;
+    return pool;
+}
+
+// Threads the fallback pool's parallel algorithms use (hardware
+// concurrency by default); not to be called while one runs. The std
+// backend picks its own.
+inline void setThreadCount(size_t threads) {
+    fallbackPool().resize(threads);
+}
+
+inline size_t threadCount() {
+    return fallbackPool().threadCount();
+}
+
+namespace detail {
+    template<typename Policy>
+    inline constexpr bool isSequenced = std::is_same_v<std::decay_t<Policy>, sequenced_policy>;
+    
+    // Ranges shorter than this per thread are not worth splitting
+    inline constexpr size_t MIN_CHUNK = 4096;
+    
+    inline size_t chunkCount(size_t count) {
+        return std::max<size_t>(1, std::min(threadCount(), count / MIN_CHUNK));
+    }
+    
+    // Start offset of each of chunks chunks over count elements, followed by count
+    inline std::vector<size_t> chunkBounds(size_t count, size_t chunks) {
+        std::vector<size_t> bounds(chunks + 1);
+        for (size_t i = 0; i <= chunks; ++i) {
+            bounds[i] = count * i / chunks;
+        }
+        return bounds;
+    }
+    
+    // Calls fn(chunk, begin, end) for each chunk of [0, count) on the pool
+    template<typename Fn>
+    void forChunks(size_t count, size_t chunks, Fn&& fn) {
+        std::vector<size_t> bounds = chunkBounds(count, chunks);
+        fallbackPool().run(chunks, [&](size_t chunk) {
+            fn(chunk, bounds[chunk], bounds[chunk + 1]);
+        });
+    }
+}
+
+template<typename Policy, typename InputIt, typename OutputIt, typename UnaryOp>
+OutputIt transform([[maybe_unused]] Policy&& policy, InputIt first, InputIt last, OutputIt out, UnaryOp op) {
+    if constexpr (detail::isSequenced<Policy>) {
+        return std::transform(first, last, out, op);
+    } else {
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+        return std::transform(std::forward<Policy>(policy), first, last, out, op);
+#else
+        size_t count = std::distance(first, last);
+        detail::forChunks(count, detail::chunkCount(count), [&](size_t, size_t begin, size_t end) {
+            std::transform(first + begin, first + end, out + begin, op);
+        });
+        return out + count;
+#endif
+    }
+}
+
+// Reduces transform(element) over the range onto init. Parallel policies
+// fold each chunk separately and combine the partial results in order, so
+// reduce must be associative (floating-point sums differ in rounding).
+template<typename Policy, typename InputIt, typename T, typename BinaryOp, typename UnaryOp>
+T transform_reduce([[maybe_unused]] Policy&& policy, InputIt first, InputIt last, T init, BinaryOp reduce, UnaryOp transform) {
+    if constexpr (detail::isSequenced<Policy>) {
+        for (; first != last; ++first) {
+            init = reduce(std::move(init), transform(*first));
+        }
+        return init;
+    } else {
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+        return std::transform_reduce(std::forward<Policy>(policy), first, last, std::move(init), reduce, transform);
+#else
+        size_t count = std::distance(first, last);
+        if (count == 0) {
+            return init;
+        }
+        size_t chunks = detail::chunkCount(count);
+        std::vector<std::optional<T>> partials(chunks);
+        detail::forChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+            T partial = transform(first[begin]);
+            for (size_t i = begin + 1; i < end; ++i) {
+                partial = reduce(std::move(partial), transform(first[i]));
+            }
+            partials[chunk] = std::move(partial);
+        });
+        for (auto& partial : partials) {
+            init = reduce(std::move(init), std::move(*partial));
+        }
+        return init;
+#endif
+    }
+}
+
+// Fallback: each chunk is sorted on its own thread, then neighbouring
+// chunks are merged pairwise, the merges of a round running in parallel
+template<typename Policy, typename RandomIt, typename Compare = std::less<>>
+void sort([[maybe_unused]] Policy&& policy, RandomIt first, RandomIt last, Compare comp = Compare()) {
+    if constexpr (detail::isSequenced<Policy>) {
+        std::sort(first, last, comp);
+    } else {
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+        std::sort(std::forward<Policy>(policy), first, last, comp);
+#else
+        size_t count = std::distance(first, last);
+        size_t chunks = detail::chunkCount(count);
+        std::vector<size_t> bounds = detail::chunkBounds(count, chunks);
+        fallbackPool().run(chunks, [&](size_t chunk) {
+            std::sort(first + bounds[chunk], first + bounds[chunk + 1], comp);
+        });
+        
+        while (bounds.size() > 2) {
+            size_t merges = (bounds.size() - 1) / 2;
+            fallbackPool().run(merges, [&](size_t merge) {
+                std::inplace_merge(first + bounds[2 * merge], first + bounds[2 * merge + 1],
+                                   first + bounds[2 * merge + 2], comp);
+            });
+            std::vector<size_t> merged;
+            for (size_t i = 0; i < bounds.size(); i += 2) {
+                merged.push_back(bounds[i]);
+            }
+            if (merged.back() != count) {
+                merged.push_back(count);
+            }
+            bounds = std::move(merged);
+        }
+#endif
+    }
+}
+
+// Like std::minmax_element: the first smallest and the last largest element
+template<typename Policy, typename ForwardIt, typename Compare = std::less<>>
+std::pair<ForwardIt, ForwardIt> minmax_element([[maybe_unused]] Policy&& policy, ForwardIt first, ForwardIt last,
+                                               Compare comp = Compare()) {
+    if constexpr (detail::isSequenced<Policy>) {
+        return std::minmax_element(first, last, comp);
+    } else {
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+        return std::minmax_element(std::forward<Policy>(policy), first, last, comp);
+#else
+        size_t count = std::distance(first, last);
+        size_t chunks = detail::chunkCount(count);
+        std::vector<std::pair<ForwardIt, ForwardIt>> partials(chunks, {last, last});
+        detail::forChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+            partials[chunk] = std::minmax_element(first + begin, first + end, comp);
+        });
+        std::pair<ForwardIt, ForwardIt> result = partials[0];
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            if (comp(*partials[chunk].first, *result.first)) {
+                result.first = partials[chunk].first;
+            }
+            if (!comp(*partials[chunk].second, *result.second)) {
+                result.second = partials[chunk].second;
+            }
+        }
+        return result;
+#endif
+    }
+}
+
+// Fallback: each chunk copies its matches into a buffer of its own; the
+// buffers are then moved to out in order, so out may be any output iterator
+template<typename Policy, typename InputIt, typename OutputIt, typename Predicate>
+OutputIt copy_if([[maybe_unused]] Policy&& policy, InputIt first, InputIt last, OutputIt out, Predicate pred) {
+    if constexpr (detail::isSequenced<Policy>) {
+        return std::copy_if(first, last, out, pred);
+    } else {
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+        return std::copy_if(std::forward<Policy>(policy), first, last, out, pred);
+#else
+        using Value = typename std::iterator_traits<InputIt>::value_type;
+        size_t count = std::distance(first, last);
+        size_t chunks = detail::chunkCount(count);
+        std::vector<std::vector<Value>> matches(chunks);
+        detail::forChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+            std::copy_if(first + begin, first + end, std::back_inserter(matches[chunk]), pred);
+        });
+        for (auto& chunk : matches) {
+            out = std::move(chunk.begin(), chunk.end(), out);
+        }
+        return out;
+#endif
+    }
+}
+
+template<typename Policy, typename ForwardIt, typename UnaryFn>
+void for_each([[maybe_unused]] Policy&& policy, ForwardIt first, ForwardIt last, UnaryFn fn) {
+    if constexpr (detail::isSequenced<Policy>) {
+        std::for_each(first, last, fn);
+    } else {
+#ifdef PARALLEL_ALGORITHMS_STD_BACKEND
+        std::for_each(std::forward<Policy>(policy), first, last, fn);
+#else
+        size_t count = std::distance(first, last);
+        detail::forChunks(count, detail::chunkCount(count), [&](size_t, size_t begin, size_t end) {
+            std::for_each(first + begin, first + end, fn);
+        });
+#endif
+    }
+}
+
+} // namespace parallel
+
+#endif // PARALLEL_ALGORITHMS_HPP
@@ -13,6 +13,7 @@
 #include <random>
 #include <functional>
 #include <memory>
+#include "parallel_algorithms.hpp"
 
 // Data structures for a simple data analysis system
 struct DataPoint {
@@ -131,49 +132,77 @@ public:
         return categories;
     }
     
-    // Calculate statistics for all data
-    void calculateStatistics() const {
+    // Summary of all data, computed with the given execution policy
+    // (parallel::seq, par or par_unseq); min and max are null if there is no data
+    struct Summary {
+        size_t count = 0;
+        const DataPoint* min = nullptr;
+        const DataPoint* max = nullptr;
+        double average = 0.0;
+        double median = 0.0;
+        double stdDev = 0.0;
+    };
+    
+    template<typename Policy>
+    Summary summarize(Policy&& policy) const {
+        Summary summary;
+        summary.count = data.size();
         if (data.empty()) {
-            std::cout << "No data available for statistics\n";
-            return;
+            return summary;
         }
         
         // Calculate min, max, average using STL algorithms
-        auto minmax = std::minmax_element(data.begin(), data.end(), 
+        auto minmax = parallel::minmax_element(policy, data.begin(), data.end(), 
             [](const DataPoint& a, const DataPoint& b) { return a.value < b.value; });
-            
-        double sum = std::accumulate(data.begin(), data.end(), 0.0, 
-            [](double acc, const DataPoint& dp) { return acc + dp.value; });
-            
-        double average = sum / data.size();
+        summary.min = &*minmax.first;
+        summary.max = &*minmax.second;
         
-        std::cout << "Statistics for all data:\n";
-        std::cout << "  Count: " << data.size() << "\n";
-        std::cout << "  Minimum value: " << minmax.first->value << " (ID: " << minmax.first->id << ")\n";
-        std::cout << "  Maximum value: " << minmax.second->value << " (ID: " << minmax.second->id << ")\n";
-        std::cout << "  Average value: " << std::fixed << std::setprecision(2) << average << "\n";
+        double sum = parallel::transform_reduce(policy, data.begin(), data.end(), 0.0, std::plus<>(),
+            [](const DataPoint& dp) { return dp.value; });
+        
+        summary.average = sum / data.size();
         
         // Calculate median
-        std::vector<double> values;
-        std::transform(data.begin(), data.end(), std::back_inserter(values),
+        std::vector<double> values(data.size());
+        parallel::transform(policy, data.begin(), data.end(), values.begin(),
             [](const DataPoint& dp) { return dp.value; });
-            
-        std::sort(values.begin(), values.end());
-        double median;
+        
+        parallel::sort(policy, values.begin(), values.end());
         if (values.size() % 2 == 0) {
-            median = (values[values.size() / 2 - 1] + values[values.size() / 2]) / 2;
+            summary.median = (values[values.size() / 2 - 1] + values[values.size() / 2]) / 2;
         } else {
-            median = values[values.size() / 2];
+            summary.median = values[values.size() / 2];
         }
         
-        std::cout << "  Median value: " << std::fixed << std::setprecision(2) << median << "\n";
-        
         // Calculate standard deviation
-        double sq_sum = std::accumulate(values.begin(), values.end(), 0.0,
-            [average](double acc, double val) { return acc + (val - average) * (val - average); });
-            
-        double std_dev = std::sqrt(sq_sum / values.size());
-        std::cout << "  Standard deviation: " << std::fixed << std::setprecision(2) << std_dev << "\n";
+        double average = summary.average;
+        double sq_sum = parallel::transform_reduce(policy, values.begin(), values.end(), 0.0, std::plus<>(),
+            [average](double val) { return (val - average) * (val - average); });
+        
+        summary.stdDev = std::sqrt(sq_sum / values.size());
+        return summary;
+    }
+    
+    // Calculate statistics for all data
+    template<typename Policy>
+    void calculateStatistics(Policy&& policy) const {
+        if (data.empty()) {
+            std::cout << "No data available for statistics\n";
+            return;
+        }
+        
+        Summary summary = summarize(policy);
+        std::cout << "Statistics for all data:\n";
+        std::cout << "  Count: " << summary.count << "\n";
+        std::cout << "  Minimum value: " << summary.min->value << " (ID: " << summary.min->id << ")\n";
+        std::cout << "  Maximum value: " << summary.max->value << " (ID: " << summary.max->id << ")\n";
+        std::cout << "  Average value: " << std::fixed << std::setprecision(2) << summary.average << "\n";
+        std::cout << "  Median value: " << std::fixed << std::setprecision(2) << summary.median << "\n";
+        std::cout << "  Standard deviation: " << std::fixed << std::setprecision(2) << summary.stdDev << "\n";
+    }
+    
+    void calculateStatistics() const {
+        calculateStatistics(parallel::seq);
     }
     
     // Calculate statistics by category
@@ -204,28 +233,38 @@ public:
     }
     
     // Find data points within a value range
-    std::vector<DataPoint> findDataInRange(double minValue, double maxValue) const {
+    template<typename Policy>
+    std::vector<DataPoint> findDataInRange(Policy&& policy, double minValue, double maxValue) const {
         std::vector<DataPoint> result;
-        std::copy_if(data.begin(), data.end(), std::back_inserter(result),
+        parallel::copy_if(policy, data.begin(), data.end(), std::back_inserter(result),
             [minValue, maxValue](const DataPoint& dp) {
                 return dp.value >= minValue && dp.value <= maxValue;
             });
         return result;
     }
     
+    std::vector<DataPoint> findDataInRange(double minValue, double maxValue) const {
+        return findDataInRange(parallel::seq, minValue, maxValue);
+    }
+    
     // Sort data by value (ascending or descending)
-    std::vector<DataPoint> getSortedByValue(bool ascending = true) const {
+    template<typename Policy, typename = std::enable_if_t<parallel::is_execution_policy_v<Policy>>>
+    std::vector<DataPoint> getSortedByValue(Policy&& policy, bool ascending = true) const {
         std::vector<DataPoint> sortedData = data;
         if (ascending) {
-            std::sort(sortedData.begin(), sortedData.end(),
+            parallel::sort(policy, sortedData.begin(), sortedData.end(),
                 [](const DataPoint& a, const DataPoint& b) { return a.value < b.value; });
         } else {
-            std::sort(sortedData.begin(), sortedData.end(),
+            parallel::sort(policy, sortedData.begin(), sortedData.end(),
                 [](const DataPoint& a, const DataPoint& b) { return a.value > b.value; });
         }
         return sortedData;
     }
     
+    std::vector<DataPoint> getSortedByValue(bool ascending = true) const {
+        return getSortedByValue(parallel::seq, ascending);
+    }
+    
     // Get top N data points by value
     std::vector<DataPoint> getTopN(int n) const {
         if (n <= 0 || data.empty()) return {};
@@ -271,20 +310,31 @@ public:
         std::cout << "Data exported to " << filename << std::endl;
     }
     
-    // Filter data using a predicate function
+    // Filter data using a predicate function; with a parallel policy the
+    // predicate is called from several threads at once
+    template<typename Policy, typename Predicate>
+    std::vector<DataPoint> filterData(Policy&& policy, Predicate predicate) const {
+        std::vector<DataPoint> result;
+        parallel::copy_if(policy, data.begin(), data.end(), std::back_inserter(result), predicate);
+        return result;
+    }
+    
     template<typename Predicate>
     std::vector<DataPoint> filterData(Predicate predicate) const {
-        std::vector<DataPoint> result;
-        std::copy_if(data.begin(), data.end(), std::back_inserter(result), predicate);
+        return filterData(parallel::seq, predicate);
+    }
+    
+    // Transform data using a transformation function (same threading rule)
+    template<typename Policy, typename Transform>
+    std::vector<DataPoint> transformData(Policy&& policy, Transform transform) const {
+        std::vector<DataPoint> result = data;
+        parallel::transform(policy, data.begin(), data.end(), result.begin(), transform);
         return result;
     }
     
-    // Transform data using a transformation function
     template<typename Transform>
     std::vector<DataPoint> transformData(Transform transform) const {
-        std::vector<DataPoint> result = data;
-        std::transform(data.begin(), data.end(), result.begin(), transform);
-        return result;
+        return transformData(parallel::seq, transform);
     }
 };
 
@@ -335,6 +385,30 @@ void runDataAnalysisDemo() {
     
     // Export data to CSV
     analyzer.exportToCSV("data_analysis.csv");
+    
+    // Same statistics over a larger data set, sequentially and in parallel
+    std::cout << "\n6. Sequential vs parallel statistics on " << parallel::threadCount() << " threads";
+    std::cout << (parallel::usesStdBackend ? " (standard library backend):\n" : " (fallback pool):\n");
+    DataAnalyzer large;
+    large.generateRandomData(200000);
+    
+    auto timeSummary = [&large](const auto& policy, DataAnalyzer::Summary& summary) {
+        auto start = std::chrono::steady_clock::now();
+        summary = large.summarize(policy);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    DataAnalyzer::Summary sequential, parallelSummary;
+    double seqMs = timeSummary(parallel::seq, sequential);
+    double parMs = timeSummary(parallel::par, parallelSummary);
+    
+    std::cout << "  seq: " << std::fixed << std::setprecision(2) << seqMs << " ms\n";
+    std::cout << "  par: " << parMs << " ms (" << seqMs / parMs << "x)\n";
+    std::cout << "  Same min, max and median: " << std::boolalpha
+              << (sequential.min == parallelSummary.min && sequential.max == parallelSummary.max &&
+                  sequential.median == parallelSummary.median) << "\n";
+    std::cout << "  Average differs by " << std::scientific << std::setprecision(1)
+              << std::abs(sequential.average - parallelSummary.average) << " (summation order)\n";
+    std::cout << std::defaultfloat;
 }
 
 int main() {
@@ -0,0 +1,487 @@
+/*
+ * Allocator Benchmark
+ *
+ * Runs the allocators from custom_allocators.hpp against std::allocator
+ * (glibc malloc) and the std::pmr resources on workloads shaped like real
+ * container traffic, and prints one machine-readable row per
+ * (workload, allocator) pair.
+ *
+ * Workloads:
+ * - scratch_lifo:      nested temporary buffers freed in LIFO order
+ * - list_churn:        std::list push/pop at both ends (node allocations)
+ * - map_churn:         random std::map insert/erase (node allocations)
+ * - vector_growth:     std::vector built by push_back and dropped
+ * - mixed_sizes:       random-size blocks with random lifetimes
+ * - producer_consumer: blocks allocated on one thread, freed on another
+ * - fragmentation:     small blocks, mostly freed, then larger ones
+ *
+ * Each run happens in a forked child so that its peak RSS is its own.
+ * peak_rss_kib is the high-water mark above the child's starting RSS;
+ * retained_rss_kib is what is still resident once the workload has freed
+ * everything but the allocator (and its pool or resource) still exists.
+ *
+ * Usage: allocator_benchmark [--json] [--scale=F] [--workload=NAME] [--allocator=NAME]
+ */
+
+#include "custom_allocators.hpp"
+#include <list>
+#include <map>
+#include <deque>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <memory_resource>
+#include <cstdio>
+#include <cstring>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Allocator cases: T-generic allocator type, a factory, and what it supports
+struct StdCase {
+    static constexpr const char* name = "std_allocator";
+    static constexpr bool thread_safe = true;
+    static constexpr bool lifo_only = false;
+    
+    template<typename T> using allocator = std::allocator<T>;
+    template<typename T> allocator<T> make() { return {}; }
+};
+
+struct LoggingCase {
+    static constexpr const char* name = "logging";
+    static constexpr bool thread_safe = false;   // unsynchronized counters
+    static constexpr bool lifo_only = false;
+    
+    template<typename T> using allocator = LoggingAllocator<T>;
+    template<typename T> allocator<T> make() {
+        LoggingAllocator<T>::set_verbose(false);
+        return {};
+    }
+};
+
+// Size classes of 16 to 256 bytes with per-thread caches, jemalloc style
+struct PoolCase {
+    static constexpr const char* name = "pool_size_classes";
+    static constexpr bool thread_safe = true;
+    static constexpr bool lifo_only = false;
+    
+    std::shared_ptr<PoolResource> pool = std::make_shared<PoolResource>(1024);
+    
+    template<typename T> using allocator = PoolAllocator<T, 1024>;
+    template<typename T> allocator<T> make() { return allocator<T>(pool); }
+};
+
+struct StackCase {
+    static constexpr const char* name = "stack";
+    static constexpr bool thread_safe = false;
+    static constexpr bool lifo_only = true;   // frees anything but the top are lost
+    static constexpr size_t BYTES = 1 << 20;
+    
+    // The buffer lives inside the allocator, so the one instance is shared
+    std::unique_ptr<StackAllocator<char, BYTES>> stack = std::make_unique<StackAllocator<char, BYTES>>();
+    
+    template<typename T> using allocator = StackAllocator<T, BYTES / sizeof(T)>;
+    template<typename T> allocator<T>& make() {
+        static_assert(std::is_same_v<T, char>, "the stack case only hands out bytes");
+        return *stack;
+    }
+};
+
+struct AlignedCase {
+    static constexpr const char* name = "aligned_64";
+    static constexpr bool thread_safe = true;
+    static constexpr bool lifo_only = false;
+    
+    template<typename T> using allocator = AlignedAllocator<T, 64>;
+    template<typename T> allocator<T> make() { return {}; }
+};
+
+template<typename Resource, bool ThreadSafe>
+struct PmrCase {
+    static constexpr bool thread_safe = ThreadSafe;
+    static constexpr bool lifo_only = false;
+    
+    Resource resource;
+    
+    template<typename T> using allocator = std::pmr::polymorphic_allocator<T>;
+    template<typename T> allocator<T> make() { return allocator<T>(&resource); }
+};
+
+struct PmrUnsyncPoolCase : PmrCase<std::pmr::unsynchronized_pool_resource, false> {
+    static constexpr const char* name = "pmr_unsync_pool";
+};
+
+struct PmrSyncPoolCase : PmrCase<std::pmr::synchronized_pool_resource, true> {
+    static constexpr const char* name = "pmr_sync_pool";
+};
+
+// Never reuses freed memory: growth here is the cost of skipping frees
+struct PmrMonotonicCase : PmrCase<std::pmr::monotonic_buffer_resource, false> {
+    static constexpr const char* name = "pmr_monotonic";
+};
+
+// Sizes skewed toward small objects, like a typical heap: 80% 16-64 bytes,
+// 15% 64-256 bytes, 5% up to 4 KiB
+size_t draw_size(std::mt19937& rng) {
+    uint32_t pick = rng() % 100;
+    if (pick < 80) return 16 + rng() % 49;
+    if (pick < 95) return 64 + rng() % 193;
+    return 256 + rng() % 3841;
+}
+
+// Workloads: each returns the number of allocator operations it performed
+template<typename Case>
+size_t scratch_lifo(Case& c, size_t iterations) {
+    auto&& alloc = c.template make<char>();
+    using Traits = std::allocator_traits<std::decay_t<decltype(alloc)>>;
+    std::mt19937 rng(1);
+    std::array<std::pair<char*, size_t>, 8> frames;
+    
+    for (size_t i = 0; i < iterations; ++i) {
+        for (auto& frame : frames) {
+            frame.second = 1024 + rng() % (15 * 1024);
+            frame.first = Traits::allocate(alloc, frame.second);
+            frame.first[0] = static_cast<char>(i);
+        }
+        for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+            Traits::deallocate(alloc, it->first, it->second);
+        }
+    }
+    return iterations * frames.size() * 2;
+}
+
+template<typename Case>
+size_t list_churn(Case& c, size_t operations) {
+    using Alloc = typename Case::template allocator<uint64_t>;
+    std::list<uint64_t, Alloc> list(c.template make<uint64_t>());
+    std::mt19937 rng(2);
+    
+    for (size_t i = 0; i < operations; ++i) {
+        uint32_t pick = rng() % 4;
+        if (pick == 0 || list.empty()) {
+            list.push_back(i);
+        } else if (pick == 1) {
+            list.push_front(i);
+        } else if (pick == 2 && list.size() > 1000) {
+            list.pop_front();
+        } else {
+            list.pop_back();
+        }
+    }
+    return operations;
+}
+
+template<typename Case>
+size_t map_churn(Case& c, size_t operations) {
+    using Value = std::pair<const uint32_t, uint64_t>;
+    using Alloc = typename Case::template allocator<Value>;
+    std::map<uint32_t, uint64_t, std::less<uint32_t>, Alloc> map(c.template make<Value>());
+    std::mt19937 rng(3);
+    
+    for (size_t i = 0; i < operations; ++i) {
+        uint32_t key = rng() & 0xFFFF;
+        if (rng() & 1) {
+            map[key] = i;
+        } else {
+            map.erase(key);
+        }
+    }
+    return operations;
+}
+
+template<typename Case>
+size_t vector_growth(Case& c, size_t vectors) {
+    using Alloc = typename Case::template allocator<uint32_t>;
+    std::mt19937 rng(4);
+    size_t operations = 0;
+    
+    for (size_t i = 0; i < vectors; ++i) {
+        std::vector<uint32_t, Alloc> values(c.template make<uint32_t>());
+        size_t length = 1 + rng() % 4096;
+        for (size_t j = 0; j < length; ++j) {
+            values.push_back(static_cast<uint32_t>(j));
+        }
+        operations += length;
+    }
+    return operations;
+}
+
+template<typename Case>
+size_t mixed_sizes(Case& c, size_t operations) {
+    auto alloc = c.template make<char>();
+    using Traits = std::allocator_traits<decltype(alloc)>;
+    std::vector<std::pair<char*, size_t>> live(16384, {nullptr, 0});
+    std::mt19937 rng(5);
+    
+    for (size_t i = 0; i < operations; ++i) {
+        auto& slot = live[rng() % live.size()];
+        if (slot.first) {
+            Traits::deallocate(alloc, slot.first, slot.second);
+        }
+        slot.second = draw_size(rng);
+        slot.first = Traits::allocate(alloc, slot.second);
+        std::memset(slot.first, 0, std::min<size_t>(slot.second, 64));
+    }
+    for (auto& slot : live) {
+        if (slot.first) Traits::deallocate(alloc, slot.first, slot.second);
+    }
+    return operations * 2;
+}
+
+template<typename Case>
+size_t producer_consumer(Case& c, size_t blocks) {
+    auto alloc = c.template make<char>();
+    using Traits = std::allocator_traits<decltype(alloc)>;
+    using Batch = std::vector<std::pair<char*, size_t>>;
+    constexpr size_t BATCH = 256;
+    constexpr size_t MAX_QUEUED = 64;
+    
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Batch> queue;
+    bool done = false;
+    
+    std::thread consumer([&] {
+        auto local = alloc;
+        for (;;) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return done || !queue.empty(); });
+                if (queue.empty()) return;
+                batch = std::move(queue.front());
+                queue.pop_front();
+            }
+            changed.notify_all();
+            for (auto& block : batch) {
+                Traits::deallocate(local, block.first, block.second);
+            }
+        }
+    });
+    
+    std::mt19937 rng(6);
+    Batch batch;
+    auto flush = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return queue.size() < MAX_QUEUED; });
+        queue.push_back(std::move(batch));
+        batch = Batch();
+        changed.notify_all();
+    };
+    for (size_t i = 0; i < blocks; ++i) {
+        size_t size = 16 + rng() % 241;
+        char* block = Traits::allocate(alloc, size);
+        block[0] = static_cast<char>(i);
+        batch.emplace_back(block, size);
+        if (batch.size() == BATCH) flush();
+    }
+    if (!batch.empty()) flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    changed.notify_all();
+    consumer.join();
+    return blocks * 2;
+}
+
+template<typename Case>
+size_t fragmentation(Case& c, size_t blocks) {
+    auto alloc = c.template make<char>();
+    using Traits = std::allocator_traits<decltype(alloc)>;
+    std::mt19937 rng(7);
+    std::vector<std::pair<char*, size_t>> small(blocks), large(blocks / 4);
+    
+    // Many small blocks, two thirds freed at random: holes too small to
+    // serve the larger blocks that follow
+    for (auto& block : small) {
+        block.second = 16 + rng() % 241;
+        block.first = Traits::allocate(alloc, block.second);
+        std::memset(block.first, 1, block.second);
+    }
+    size_t operations = small.size();
+    for (auto& block : small) {
+        if (rng() % 3 != 0) {
+            Traits::deallocate(alloc, block.first, block.second);
+            block.first = nullptr;
+            ++operations;
+        }
+    }
+    for (auto& block : large) {
+        block.second = 512 + rng() % 1537;
+        block.first = Traits::allocate(alloc, block.second);
+        std::memset(block.first, 1, block.second);
+    }
+    operations += large.size();
+    
+    for (auto* blocks_left : {&small, &large}) {
+        for (auto& block : *blocks_left) {
+            if (block.first) {
+                Traits::deallocate(alloc, block.first, block.second);
+                ++operations;
+            }
+        }
+    }
+    return operations;
+}
+
+// Harness
+struct Options {
+    bool json = false;
+    double scale = 1.0;
+    std::string workload;
+    std::string allocator;
+};
+
+struct Row {
+    std::string workload;
+    std::string allocator;
+    std::string status;
+    size_t operations = 0;
+    double seconds = 0.0;
+    long peak_rss_kib = 0;
+    long retained_rss_kib = 0;
+};
+
+long resident_kib() {
+    long pages = 0, resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(statm);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long peak_resident_kib() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;   // KiB on Linux
+}
+
+void print_header(const Options& options) {
+    if (!options.json) {
+        std::printf("workload,allocator,status,operations,seconds,ns_per_op,peak_rss_kib,retained_rss_kib\n");
+    }
+}
+
+void print_row(const Options& options, const Row& row) {
+    double ns_per_op = row.operations ? row.seconds * 1e9 / static_cast<double>(row.operations) : 0.0;
+    if (options.json) {
+        std::printf("{\"workload\":\"%s\",\"allocator\":\"%s\",\"status\":\"%s\",\"operations\":%zu,"
+                    "\"seconds\":%.6f,\"ns_per_op\":%.2f,\"peak_rss_kib\":%ld,\"retained_rss_kib\":%ld}\n",
+                    row.workload.c_str(), row.allocator.c_str(), row.status.c_str(), row.operations,
+                    row.seconds, ns_per_op, row.peak_rss_kib, row.retained_rss_kib);
+    } else {
+        std::printf("%s,%s,%s,%zu,%.6f,%.2f,%ld,%ld\n", row.workload.c_str(), row.allocator.c_str(),
+                    row.status.c_str(), row.operations, row.seconds, ns_per_op,
+                    row.peak_rss_kib, row.retained_rss_kib);
+    }
+    std::fflush(stdout);
+}
+
+bool selected(const Options& options, const std::string& workload, const std::string& allocator) {
+    return (options.workload.empty() || options.workload == workload) &&
+           (options.allocator.empty() || options.allocator == allocator);
+}
+
+void skip(const Options& options, const std::string& workload, const char* allocator, const char* reason) {
+    if (selected(options, workload, allocator)) {
+        Row row;
+        row.workload = workload;
+        row.allocator = allocator;
+        row.status = std::string("skipped:") + reason;
+        print_row(options, row);
+    }
+}
+
+// Run one workload on a fresh allocator in a child process
+template<typename Case, typename Workload>
+void measure(const Options& options, const std::string& workload, size_t size, Workload run) {
+    if (!selected(options, workload, Case::name)) return;
+    size = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(size) * options.scale));
+    
+    std::fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        Row row;
+        row.workload = workload;
+        row.allocator = Case::name;
+        row.status = "ok";
+        long start_rss = resident_kib();
+        {
+            Case allocator_case;
+            auto start = std::chrono::steady_clock::now();
+            row.operations = run(allocator_case, size);
+            row.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            row.retained_rss_kib = std::max(0L, resident_kib() - start_rss);
+        }
+        // ru_maxrss is sampled lazily by the kernel, so it can trail statm
+        row.peak_rss_kib = std::max(row.retained_rss_kib, peak_resident_kib() - start_rss);
+        print_row(options, row);
+        _exit(0);
+    }
+    
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        skip(options, workload, Case::name, "failed");
+    }
+}
+
+template<typename Case>
+void run_case(const Options& options) {
+    measure<Case>(options, "scratch_lifo", 100000,
+                  [](Case& c, size_t n) { return scratch_lifo(c, n); });
+                  
+    if constexpr (Case::lifo_only) {
+        for (const char* workload : {"list_churn", "map_churn", "vector_growth", "mixed_sizes",
+                                     "producer_consumer", "fragmentation"}) {
+            skip(options, workload, Case::name, "lifo_only");
+        }
+    } else {
+        measure<Case>(options, "list_churn", 2000000, [](Case& c, size_t n) { return list_churn(c, n); });
+        measure<Case>(options, "map_churn", 2000000, [](Case& c, size_t n) { return map_churn(c, n); });
+        measure<Case>(options, "vector_growth", 20000, [](Case& c, size_t n) { return vector_growth(c, n); });
+        measure<Case>(options, "mixed_sizes", 2000000, [](Case& c, size_t n) { return mixed_sizes(c, n); });
+        if constexpr (Case::thread_safe) {
+            measure<Case>(options, "producer_consumer", 2000000,
+                          [](Case& c, size_t n) { return producer_consumer(c, n); });
+        } else {
+            skip(options, "producer_consumer", Case::name, "not_thread_safe");
+        }
+        measure<Case>(options, "fragmentation", 400000, [](Case& c, size_t n) { return fragmentation(c, n); });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            options.json = true;
+        } else if (arg.rfind("--scale=", 0) == 0) {
+            options.scale = std::stod(arg.substr(8));
+        } else if (arg.rfind("--workload=", 0) == 0) {
+            options.workload = arg.substr(11);
+        } else if (arg.rfind("--allocator=", 0) == 0) {
+            options.allocator = arg.substr(12);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--json] [--scale=F] [--workload=NAME] [--allocator=NAME]\n", argv[0]);
+            return 1;
+        }
+    }
+    
+    print_header(options);
+    run_case<StdCase>(options);
+    run_case<LoggingCase>(options);
+    run_case<PoolCase>(options);
+    run_case<StackCase>(options);
+    run_case<AlignedCase>(options);
+    run_case<PmrUnsyncPoolCase>(options);
+    run_case<PmrSyncPoolCase>(options);
+    run_case<PmrMonotonicCase>(options);
+    
+    return 0;
+}
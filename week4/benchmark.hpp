@@ -0,0 +1,501 @@
+/*
+ * benchmark.hpp - Micro-Benchmark Harness
+ *
+ * Timing a block once with high_resolution_clock mostly measures noise:
+ * cold caches, frequency ramp-up and whatever else the machine is doing.
+ * This harness runs each benchmark as
+ *
+ *   warmup runs (discarded) -> N trials, each repeating the body enough
+ *   times to last at least min_trial_ms -> per-iteration time per trial
+ *
+ * and reports the median and percentiles over trials, which are stable
+ * to a few percent where a single shot varies by tens of percent.
+ *
+ *   bench::Suite suite(bench::Config::from_args(argc, argv));
+ *   suite.run("vector/push_back", [&] { ... });
+ *   suite.sweep("vector/sum", {1 << 10, 1 << 16, 1 << 20}, [&](size_t n) {
+ *       return [&, n] { bench::do_not_optimize(sum(data, n)); };
+ *   });
+ *   suite.report();   // table, CSV or JSON lines
+ *
+ * - do_not_optimize(value) and clobber_memory() stop the compiler from
+ *   deleting or hoisting the work being measured
+ * - run_with_setup() re-runs an untimed setup before every timed call,
+ *   for bodies that consume their input (sorting a copy, draining a queue)
+ * - With --counters on Linux, cycles, instructions, cache misses and
+ *   branch misses are read through perf_event_open around each trial and
+ *   reported per iteration; where the kernel refuses (perf_event_paranoid,
+ *   containers) the columns are simply absent
+ * - Command line: --format=table|csv|json --out=FILE --trials=N
+ *   --warmup=N --min-time=MS --filter=SUBSTRING --counters
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+// Optimization barriers
+#if defined(__GNUC__) || defined(__clang__)
+    // Pretend to read value (and, for lvalues, to write it) so its
+    // computation cannot be elided or moved out of the timed loop
+    template<typename T>
+    inline void do_not_optimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    template<typename T>
+    inline void do_not_optimize(T& value) {
+        asm volatile("" : "+r,m"(value) : : "memory");
+    }
+
+    // Every write so far must reach memory before anything after it
+    inline void clobber_memory() {
+        asm volatile("" : : : "memory");
+    }
+#else
+    template<typename T>
+    inline void do_not_optimize(const T& value) {
+        static volatile const void* sink;
+        sink = &value;
+    }
+
+    inline void clobber_memory() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+#endif
+
+enum class Format { Table, Csv, Json };
+
+struct Config {
+    size_t warmup = 1;           // untimed runs before the trials
+    size_t trials = 15;          // timed samples per benchmark
+    double min_trial_ms = 2.0;   // a trial repeats the body until it lasts this long
+    bool counters = false;       // read hardware counters around each trial
+    Format format = Format::Table;
+    std::string filter;          // only benchmarks whose name contains this
+    std::string out;             // report file; empty writes to stdout
+
+    // Parse the options above; unrecognized arguments are left for the
+    // program (and returned through rest when given)
+    static Config from_args(int argc, char* argv[], std::vector<std::string>* rest = nullptr) {
+        Config config;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&arg](const char* prefix) -> const char* {
+                size_t length = std::strlen(prefix);
+                return arg.compare(0, length, prefix) == 0 ? arg.c_str() + length : nullptr;
+            };
+            if (const char* v = value("--format=")) {
+                std::string format = v;
+                config.format = format == "csv" ? Format::Csv : format == "json" ? Format::Json : Format::Table;
+            } else if (const char* v = value("--out=")) {
+                config.out = v;
+            } else if (const char* v = value("--trials=")) {
+                config.trials = std::max<size_t>(1, std::strtoul(v, nullptr, 10));
+            } else if (const char* v = value("--warmup=")) {
+                config.warmup = std::strtoul(v, nullptr, 10);
+            } else if (const char* v = value("--min-time=")) {
+                config.min_trial_ms = std::strtod(v, nullptr);
+            } else if (const char* v = value("--filter=")) {
+                config.filter = v;
+            } else if (arg == "--counters") {
+                config.counters = true;
+            } else if (rest) {
+                rest->push_back(arg);
+            }
+        }
+        return config;
+    }
+};
+
+// Hardware counters for one thread, read as a group so they cover the
+// same instructions
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, CacheMisses, BranchMisses, EventCount };
+
+    static const char* name(size_t event) {
+        static const char* const names[EventCount] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+        return names[event];
+    }
+
+private:
+    int fds_[EventCount] = {-1, -1, -1, -1};
+    bool available_ = false;
+
+#if defined(__linux__)
+    static int open_event(uint64_t config, int group) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        const uint64_t configs[EventCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                              PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (size_t i = 0; i < EventCount; ++i) {
+            fds_[i] = open_event(configs[i], i == 0 ? -1 : fds_[0]);
+            if (fds_[i] < 0) {
+                close_all();
+                return;
+            }
+        }
+        available_ = true;
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() { close_all(); }
+
+    bool available() const noexcept { return available_; }
+
+    void start() {
+#if defined(__linux__)
+        if (available_) {
+            ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    // Counts since start(); false if the counters could not be read
+    bool stop(uint64_t (&values)[EventCount]) {
+#if defined(__linux__)
+        if (available_) {
+            ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t buffer[1 + EventCount] = {};
+            if (read(fds_[0], buffer, sizeof(buffer)) == static_cast<ssize_t>(sizeof(buffer)) &&
+                buffer[0] == EventCount) {
+                std::copy(buffer + 1, buffer + 1 + EventCount, values);
+                return true;
+            }
+        }
+#endif
+        (void)values;
+        return false;
+    }
+
+private:
+    void close_all() {
+#if defined(__linux__)
+        for (int& fd : fds_) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+#endif
+        available_ = false;
+    }
+};
+
+// Summary of one benchmark: times are nanoseconds per iteration
+struct Result {
+    std::string name;
+    int64_t param = -1;          // sweep parameter, -1 when there is none
+    size_t iterations = 0;       // body calls per trial
+    std::vector<double> samples; // one per trial
+    double min = 0, median = 0, mean = 0, p10 = 0, p90 = 0, max = 0, stddev = 0;
+    bool has_counters = false;
+    double counters[PerfCounters::EventCount] = {};   // per iteration, median over trials
+
+    // Median time of one body call in milliseconds
+    double median_ms() const { return median / 1e6; }
+
+    // Coefficient of variation: how much the trials disagree
+    double cv() const { return mean > 0 ? stddev / mean : 0.0; }
+
+    std::string label() const { return param < 0 ? name : name + "/" + std::to_string(param); }
+};
+
+namespace detail {
+    // Linear interpolation between closest ranks of sorted values
+    inline double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        double rank = p * static_cast<double>(sorted.size() - 1);
+        size_t low = static_cast<size_t>(rank);
+        size_t high = std::min(low + 1, sorted.size() - 1);
+        return sorted[low] + (sorted[high] - sorted[low]) * (rank - static_cast<double>(low));
+    }
+
+    inline void summarize(Result& result) {
+        std::vector<double> sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        result.min = sorted.front();
+        result.max = sorted.back();
+        result.median = percentile(sorted, 0.5);
+        result.p10 = percentile(sorted, 0.1);
+        result.p90 = percentile(sorted, 0.9);
+        double sum = 0.0;
+        for (double s : sorted) sum += s;
+        result.mean = sum / static_cast<double>(sorted.size());
+        double squares = 0.0;
+        for (double s : sorted) squares += (s - result.mean) * (s - result.mean);
+        result.stddev = sorted.size() > 1 ? std::sqrt(squares / static_cast<double>(sorted.size() - 1)) : 0.0;
+    }
+
+    inline std::string json_escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    inline std::string csv_field(const std::string& text) {
+        if (text.find_first_of(",\"\n") == std::string::npos) {
+            return text;
+        }
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+class Suite {
+private:
+    using clock = std::chrono::steady_clock;
+
+    Config config_;
+    std::vector<Result> results_;
+    std::unique_ptr<PerfCounters> counters_;
+
+    bool selected(const std::string& name) const {
+        return config_.filter.empty() || name.find(config_.filter) != std::string::npos;
+    }
+
+    // Time iterations calls of body, plus hardware counts when enabled
+    template<typename Body>
+    double time_trial(Body& body, size_t iterations, uint64_t (&counts)[PerfCounters::EventCount], bool& counted) {
+        if (counters_) counters_->start();
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            body();
+            clobber_memory();
+        }
+        auto elapsed = clock::now() - start;
+        counted = counters_ && counters_->stop(counts);
+        return std::chrono::duration<double, std::nano>(elapsed).count();
+    }
+
+    // Collect the trials for result: setup (if any) runs untimed before
+    // each trial and forces one iteration per trial
+    template<typename Setup, typename Body>
+    Result& measure(Result result, Setup* setup, Body& body) {
+        for (size_t i = 0; i < config_.warmup; ++i) {
+            if (setup) (*setup)();
+            body();
+        }
+
+        // Calibrate: double the iteration count until a trial is long
+        // enough for the clock to resolve it
+        size_t iterations = 1;
+        uint64_t counts[PerfCounters::EventCount];
+        bool counted = false;
+        if (!setup) {
+            double target = config_.min_trial_ms * 1e6;
+            double ns = time_trial(body, iterations, counts, counted);
+            while (ns < target && iterations < (size_t(1) << 30)) {
+                size_t next = ns > 0 ? static_cast<size_t>(static_cast<double>(iterations) * target / ns * 1.2) : iterations * 10;
+                iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+                ns = time_trial(body, iterations, counts, counted);
+            }
+        }
+        result.iterations = iterations;
+
+        std::vector<double> per_counter[PerfCounters::EventCount];
+        for (size_t t = 0; t < config_.trials; ++t) {
+            if (setup) (*setup)();
+            double ns = time_trial(body, iterations, counts, counted);
+            result.samples.push_back(ns / static_cast<double>(iterations));
+            if (counted) {
+                for (size_t e = 0; e < PerfCounters::EventCount; ++e) {
+                    per_counter[e].push_back(static_cast<double>(counts[e]) / static_cast<double>(iterations));
+                }
+            }
+        }
+
+        detail::summarize(result);
+        if (!per_counter[0].empty()) {
+            result.has_counters = true;
+            for (size_t e = 0; e < PerfCounters::EventCount; ++e) {
+                std::sort(per_counter[e].begin(), per_counter[e].end());
+                result.counters[e] = detail::percentile(per_counter[e], 0.5);
+            }
+        }
+        results_.push_back(std::move(result));
+        return results_.back();
+    }
+
+public:
+    explicit Suite(Config config = Config()) : config_(std::move(config)) {
+        if (config_.counters) {
+            counters_ = std::make_unique<PerfCounters>();
+            if (!counters_->available()) {
+                std::cerr << "bench: hardware counters unavailable (perf_event_open refused)" << std::endl;
+                counters_.reset();
+            }
+        }
+    }
+
+    const Config& config() const noexcept { return config_; }
+    const std::vector<Result>& results() const noexcept { return results_; }
+
+    // Benchmark body(); filtered-out names return an empty result
+    template<typename Body>
+    Result run(const std::string& name, Body&& body, int64_t param = -1) {
+        Result result;
+        result.name = name;
+        result.param = param;
+        if (!selected(name)) {
+            return result;
+        }
+        std::function<void()>* no_setup = nullptr;
+        return measure(std::move(result), no_setup, body);
+    }
+
+    // One timed call per trial, each after an untimed setup()
+    template<typename Setup, typename Body>
+    Result run_with_setup(const std::string& name, Setup&& setup, Body&& body, int64_t param = -1) {
+        Result result;
+        result.name = name;
+        result.param = param;
+        if (!selected(name)) {
+            return result;
+        }
+        return measure(std::move(result), &setup, body);
+    }
+
+    // Run make(param)() for every param; make builds the body for one size
+    template<typename Make>
+    std::vector<Result> sweep(const std::string& name, const std::vector<size_t>& params, Make&& make) {
+        std::vector<Result> sweep_results;
+        for (size_t param : params) {
+            auto body = make(param);
+            sweep_results.push_back(run(name, body, static_cast<int64_t>(param)));
+        }
+        return sweep_results;
+    }
+
+    // Write every result in the configured format, to --out or stdout
+    void report() const {
+        if (config_.out.empty()) {
+            report(std::cout);
+        } else {
+            std::ofstream file(config_.out);
+            report(file);
+        }
+    }
+
+    void report(std::ostream& out) const {
+        bool counters = std::any_of(results_.begin(), results_.end(), [](const Result& r) { return r.has_counters; });
+
+        if (config_.format == Format::Json) {
+            // One object per line, like allocator_benchmark --json
+            for (const auto& r : results_) {
+                out << "{\"name\":\"" << detail::json_escape(r.name) << "\",\"param\":" << r.param
+                    << ",\"iterations\":" << r.iterations << ",\"trials\":" << r.samples.size()
+                    << std::fixed << std::setprecision(2)
+                    << ",\"median_ns\":" << r.median << ",\"mean_ns\":" << r.mean
+                    << ",\"min_ns\":" << r.min << ",\"p10_ns\":" << r.p10 << ",\"p90_ns\":" << r.p90
+                    << ",\"max_ns\":" << r.max << ",\"stddev_ns\":" << r.stddev;
+                if (r.has_counters) {
+                    for (size_t e = 0; e < PerfCounters::EventCount; ++e) {
+                        out << ",\"" << PerfCounters::name(e) << "\":" << r.counters[e];
+                    }
+                }
+                out << "}\n";
+            }
+        } else if (config_.format == Format::Csv) {
+            out << "name,param,iterations,trials,median_ns,mean_ns,min_ns,p10_ns,p90_ns,max_ns,stddev_ns";
+            if (counters) {
+                for (size_t e = 0; e < PerfCounters::EventCount; ++e) out << "," << PerfCounters::name(e);
+            }
+            out << "\n" << std::fixed << std::setprecision(2);
+            for (const auto& r : results_) {
+                out << detail::csv_field(r.name) << "," << r.param << "," << r.iterations << ","
+                    << r.samples.size() << "," << r.median << "," << r.mean << "," << r.min << ","
+                    << r.p10 << "," << r.p90 << "," << r.max << "," << r.stddev;
+                if (counters) {
+                    for (size_t e = 0; e < PerfCounters::EventCount; ++e) {
+                        out << ",";
+                        if (r.has_counters) out << r.counters[e];
+                    }
+                }
+                out << "\n";
+            }
+        } else {
+            size_t width = 12;
+            for (const auto& r : results_) width = std::max(width, r.label().size() + 2);
+            out << std::left << std::setw(static_cast<int>(width)) << "Benchmark" << std::right
+                << std::setw(14) << "median ns" << std::setw(14) << "p10 ns" << std::setw(14) << "p90 ns"
+                << std::setw(8) << "cv %";
+            if (counters) {
+                out << std::setw(12) << "cycles" << std::setw(12) << "instr" << std::setw(12) << "cache-miss"
+                    << std::setw(12) << "branch-miss";
+            }
+            out << "\n" << std::string(width + 50 + (counters ? 48 : 0), '-') << "\n";
+            out << std::fixed;
+            for (const auto& r : results_) {
+                out << std::left << std::setw(static_cast<int>(width)) << r.label() << std::right
+                    << std::setprecision(1) << std::setw(14) << r.median << std::setw(14) << r.p10
+                    << std::setw(14) << r.p90 << std::setw(8) << r.cv() * 100.0;
+                if (r.has_counters) {
+                    for (double c : r.counters) out << std::setw(12) << c;
+                }
+                out << "\n";
+            }
+        }
+        out.flush();
+    }
+};
+
+// Sizes from first to last, multiplying by factor: {1k, 4k, 16k, ...}
+inline std::vector<size_t> geometric_sizes(size_t first, size_t last, size_t factor = 4) {
+    std::vector<size_t> sizes;
+    for (size_t size = first; size <= last && factor > 1; size *= factor) {
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+}  // namespace bench
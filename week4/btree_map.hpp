@@ -0,0 +1,718 @@
+/*
+ * btree_map / btree_set - Cache-Friendly B+-Trees
+ *
+ * Ordered containers for indexes that take a steady stream of inserts
+ * and still serve range scans. Where a red-black tree spends one heap
+ * node (and one likely cache miss) per element, a B+-tree packs many
+ * keys into each node:
+ *
+ * - Node fan-out is derived from the element size so that a node spans
+ *   a few cache lines (NodeBytes, 256 by default): 64 ints per leaf, a
+ *   minimum of 8 slots for large records
+ * - All values live in the leaves, which are chained left to right, so
+ *   iteration and range() scans walk arrays and follow one pointer per
+ *   leaf instead of climbing the tree
+ * - The range constructor sorts once and builds the tree bottom up with
+ *   full leaves (sorted_unique skips the sort)
+ * - Takes any strict weak ordering, including stateful comparators such
+ *   as MemberComparator; heterogeneous lookup when Compare::is_transparent
+ * - erase() does not rebalance: leaves may run underfull (or empty) and
+ *   lookups stay correct, since separator keys remain valid bounds.
+ *   compact() rebuilds a densely packed tree after heavy deletion
+ * - Inserts invalidate iterators into the leaf they split; erase
+ *   invalidates iterators into the leaf it touches
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flat_map.hpp"   // sorted_unique_t, iterator_range
+
+namespace btree_detail {
+    using flat_sorted_detail::identity_key;
+    using flat_sorted_detail::iterator_range;
+
+    // Map elements are stored with a mutable key so leaves can shift them;
+    // the iterators only hand out the key as const
+    struct map_key {
+        template<typename Pair>
+        const typename Pair::first_type& operator()(const Pair& value) const noexcept { return value.first; }
+    };
+
+    constexpr size_t slots_for(size_t element_bytes, size_t node_bytes) {
+        size_t slots = node_bytes / element_bytes;
+        return slots < 8 ? 8 : slots;
+    }
+
+    // Key is what internal nodes hold as separators; Value is what leaves
+    // hold and iterators point to
+    template<typename Key, typename Value, typename KeyOf, typename Compare, size_t NodeBytes>
+    class btree {
+    public:
+        static constexpr size_t leaf_slots = slots_for(sizeof(Value), NodeBytes);
+        static constexpr size_t internal_slots = slots_for(sizeof(Key) + sizeof(void*), NodeBytes);
+
+    private:
+        struct node {
+            bool leaf;
+            uint32_t count = 0;   // values in a leaf, separator keys in an internal node
+
+            explicit node(bool is_leaf) : leaf(is_leaf) {}
+        };
+
+        // Slots are raw storage, so Value needs no default constructor
+        struct leaf_node : node {
+            leaf_node* next = nullptr;
+            alignas(Value) unsigned char storage[leaf_slots * sizeof(Value)];
+
+            leaf_node() : node(true) {}
+
+            Value* values() noexcept { return std::launder(reinterpret_cast<Value*>(storage)); }
+            const Value* values() const noexcept { return std::launder(reinterpret_cast<const Value*>(storage)); }
+        };
+
+        // children[i] holds keys < keys[i] <= children[i + 1]
+        struct internal_node : node {
+            node* children[internal_slots + 1];
+            alignas(Key) unsigned char storage[internal_slots * sizeof(Key)];
+
+            internal_node() : node(false) {}
+
+            Key* keys() noexcept { return std::launder(reinterpret_cast<Key*>(storage)); }
+            const Key* keys() const noexcept { return std::launder(reinterpret_cast<const Key*>(storage)); }
+        };
+
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using key_compare = Compare;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+
+        template<bool Const>
+        class basic_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<Const, const Value&, Value&>;
+            using pointer = std::conditional_t<Const, const Value*, Value*>;
+
+        private:
+            leaf_node* leaf_ = nullptr;
+            uint32_t index_ = 0;
+
+            // Step over empty leaves left behind by erase
+            void settle() {
+                while (leaf_ && index_ >= leaf_->count) {
+                    leaf_ = leaf_->next;
+                    index_ = 0;
+                }
+            }
+
+            friend class btree;
+            template<bool> friend class basic_iterator;
+
+        public:
+            basic_iterator() = default;
+
+            basic_iterator(leaf_node* leaf, uint32_t index) : leaf_(leaf), index_(index) { settle(); }
+
+            template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+            basic_iterator(const basic_iterator<OtherConst>& other) : leaf_(other.leaf_), index_(other.index_) {}
+
+            reference operator*() const { return leaf_->values()[index_]; }
+            pointer operator->() const { return leaf_->values() + index_; }
+
+            basic_iterator& operator++() {
+                ++index_;
+                settle();
+                return *this;
+            }
+
+            basic_iterator operator++(int) {
+                basic_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            friend bool operator==(const basic_iterator& a, const basic_iterator& b) {
+                return a.leaf_ == b.leaf_ && a.index_ == b.index_;
+            }
+
+            friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return !(a == b); }
+        };
+
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+
+    private:
+        node* root_ = nullptr;
+        leaf_node* first_leaf_ = nullptr;
+        size_t size_ = 0;
+        size_t height_ = 0;
+        Compare comp_;
+
+        // First slot in [0, count) whose key is not less than key
+        template<typename K, typename Slot, typename Project>
+        uint32_t lower_slot(const Slot* slots, uint32_t count, const K& key, Project project) const {
+            uint32_t first = 0;
+            while (count > 0) {
+                uint32_t half = count / 2;
+                if (comp_(project(slots[first + half]), key)) {
+                    first += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return first;
+        }
+
+        // Child of an internal node whose subtree may hold key
+        template<typename K>
+        uint32_t child_for(const internal_node* n, const K& key) const {
+            uint32_t first = 0;
+            uint32_t count = n->count;
+            while (count > 0) {
+                uint32_t half = count / 2;
+                if (!comp_(key, n->keys()[first + half])) {
+                    first += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return first;
+        }
+
+        template<typename K>
+        leaf_node* leaf_for(const K& key) const {
+            node* n = root_;
+            while (n && !n->leaf) {
+                auto* in = static_cast<internal_node*>(n);
+                n = in->children[child_for(in, key)];
+            }
+            return static_cast<leaf_node*>(n);
+        }
+
+        template<typename K>
+        iterator lower_bound_impl(const K& key) const {
+            leaf_node* leaf = leaf_for(key);
+            if (!leaf) {
+                return iterator();
+            }
+            uint32_t slot = lower_slot(leaf->values(), leaf->count, key, KeyOf());
+            return iterator(leaf, slot);
+        }
+
+        template<typename K>
+        iterator upper_bound_impl(const K& key) const {
+            iterator it = lower_bound_impl(key);
+            if (it.leaf_ && !comp_(key, KeyOf()(*it))) {
+                ++it;
+            }
+            return it;
+        }
+
+        template<typename K>
+        iterator find_impl(const K& key) const {
+            iterator it = lower_bound_impl(key);
+            if (it.leaf_ && !comp_(key, KeyOf()(*it))) {
+                return it;
+            }
+            return iterator();
+        }
+
+        static void destroy(node* n) noexcept {
+            if (!n) {
+                return;
+            }
+            if (n->leaf) {
+                auto* leaf = static_cast<leaf_node*>(n);
+                std::destroy_n(leaf->values(), leaf->count);
+                delete leaf;
+            } else {
+                auto* in = static_cast<internal_node*>(n);
+                for (uint32_t i = 0; i <= in->count; ++i) {
+                    destroy(in->children[i]);
+                }
+                std::destroy_n(in->keys(), in->count);
+                delete in;
+            }
+        }
+
+        // Shift slots [from, count) one place right to open slot from
+        template<typename T>
+        static void open_slot(T* slots, uint32_t count, uint32_t from) {
+            if (from == count) {
+                return;
+            }
+            new (slots + count) T(std::move(slots[count - 1]));
+            std::move_backward(slots + from, slots + count - 1, slots + count);
+            slots[from].~T();
+        }
+
+        // Move slots [from, count) into the empty array dest
+        template<typename T>
+        static void move_tail(T* slots, uint32_t from, uint32_t count, T* dest) {
+            std::uninitialized_move(slots + from, slots + count, dest);
+            std::destroy(slots + from, slots + count);
+        }
+
+        // Split a full leaf at its midpoint; returns the new right sibling
+        leaf_node* split_leaf(leaf_node* leaf) {
+            auto* right = new leaf_node();
+            uint32_t keep = leaf->count / 2;
+            move_tail(leaf->values(), keep, leaf->count, right->values());
+            right->count = leaf->count - keep;
+            leaf->count = keep;
+            right->next = leaf->next;
+            leaf->next = right;
+            return right;
+        }
+
+        // Split a full internal node; the middle separator moves up into
+        // *separator (raw storage the caller destroys)
+        internal_node* split_internal(internal_node* in, Key* separator) {
+            auto* right = new internal_node();
+            uint32_t mid = in->count / 2;
+            new (separator) Key(std::move(in->keys()[mid]));
+            move_tail(in->keys(), mid + 1, in->count, right->keys());
+            std::copy(in->children + mid + 1, in->children + in->count + 1, right->children);
+            right->count = in->count - mid - 1;
+            in->keys()[mid].~Key();
+            in->count = mid;
+            return right;
+        }
+
+        // Put separator/right after child index slot of parent, which has room
+        static void insert_child(internal_node* parent, uint32_t slot, Key&& separator, node* right) {
+            open_slot(parent->keys(), parent->count, slot);
+            new (parent->keys() + slot) Key(std::move(separator));
+            std::copy_backward(parent->children + slot + 1, parent->children + parent->count + 1,
+                               parent->children + parent->count + 2);
+            parent->children[slot + 1] = right;
+            ++parent->count;
+        }
+
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> emplace_with_key(const K& key, Args&&... args) {
+            if (!root_) {
+                first_leaf_ = new leaf_node();
+                root_ = first_leaf_;
+                height_ = 1;
+            }
+
+            // Descend, remembering the path for splits
+            internal_node* path[64];
+            uint32_t path_slot[64];
+            size_t depth = 0;
+            node* n = root_;
+            while (!n->leaf) {
+                auto* in = static_cast<internal_node*>(n);
+                uint32_t slot = child_for(in, key);
+                path[depth] = in;
+                path_slot[depth] = slot;
+                ++depth;
+                n = in->children[slot];
+            }
+
+            auto* leaf = static_cast<leaf_node*>(n);
+            uint32_t slot = lower_slot(leaf->values(), leaf->count, key, KeyOf());
+            if (slot < leaf->count && !comp_(key, KeyOf()(leaf->values()[slot]))) {
+                return {iterator(leaf, slot), false};
+            }
+
+            // Build first so a throwing constructor leaves the tree as it was
+            Value value(std::forward<Args>(args)...);
+
+            if (leaf->count == leaf_slots) {
+                leaf_node* right = split_leaf(leaf);
+                alignas(Key) unsigned char raw[sizeof(Key)];
+                Key* separator = new (raw) Key(KeyOf()(right->values()[0]));
+                if (slot > leaf->count) {
+                    slot -= leaf->count;
+                    leaf = right;
+                }
+                insert_separator(path, path_slot, depth, separator, right);
+            }
+
+            open_slot(leaf->values(), leaf->count, slot);
+            new (leaf->values() + slot) Value(std::move(value));
+            ++leaf->count;
+            ++size_;
+            return {iterator(leaf, slot), true};
+        }
+
+        // Push separator/right up the recorded path, splitting full parents
+        // and growing a new root when the split reaches the top
+        void insert_separator(internal_node** path, uint32_t* path_slot, size_t depth, Key* separator, node* right) {
+            alignas(Key) unsigned char raw[sizeof(Key)];
+            while (depth > 0) {
+                --depth;
+                internal_node* parent = path[depth];
+                uint32_t slot = path_slot[depth];
+                if (parent->count < internal_slots) {
+                    insert_child(parent, slot, std::move(*separator), right);
+                    separator->~Key();
+                    return;
+                }
+                internal_node* sibling = split_internal(parent, reinterpret_cast<Key*>(raw));
+                Key* up = std::launder(reinterpret_cast<Key*>(raw));
+                if (slot <= parent->count) {
+                    insert_child(parent, slot, std::move(*separator), right);
+                } else {
+                    insert_child(sibling, slot - parent->count - 1, std::move(*separator), right);
+                }
+                separator->~Key();
+                new (separator) Key(std::move(*up));
+                up->~Key();
+                right = sibling;
+            }
+
+            auto* root = new internal_node();
+            root->children[0] = root_;
+            root->children[1] = right;
+            new (root->keys()) Key(std::move(*separator));
+            separator->~Key();
+            root->count = 1;
+            root_ = root;
+            ++height_;
+        }
+
+        // Build the tree bottom up from sorted, unique values
+        void build(std::vector<Value>&& values) {
+            clear();
+            if (values.empty()) {
+                return;
+            }
+
+            // Spread the values evenly over the fewest leaves that hold them
+            size_t leaf_count = (values.size() + leaf_slots - 1) / leaf_slots;
+            std::vector<node*> level;
+            std::vector<const Key*> lows;   // smallest key under each node of the level
+            level.reserve(leaf_count);
+            lows.reserve(leaf_count);
+            leaf_node* prev = nullptr;
+            size_t consumed = 0;
+            for (size_t i = 0; i < leaf_count; ++i) {
+                size_t take = (values.size() - consumed) / (leaf_count - i);
+                auto* leaf = new leaf_node();
+                std::uninitialized_move(values.begin() + static_cast<difference_type>(consumed),
+                                        values.begin() + static_cast<difference_type>(consumed + take),
+                                        leaf->values());
+                leaf->count = static_cast<uint32_t>(take);
+                consumed += take;
+                if (prev) {
+                    prev->next = leaf;
+                } else {
+                    first_leaf_ = leaf;
+                }
+                prev = leaf;
+                level.push_back(leaf);
+                lows.push_back(&KeyOf()(leaf->values()[0]));
+            }
+            size_ = values.size();
+            height_ = 1;
+
+            while (level.size() > 1) {
+                size_t fan = internal_slots + 1;
+                size_t parent_count = (level.size() + fan - 1) / fan;
+                std::vector<node*> parents;
+                std::vector<const Key*> parent_lows;
+                size_t used = 0;
+                for (size_t i = 0; i < parent_count; ++i) {
+                    size_t take = (level.size() - used) / (parent_count - i);
+                    auto* in = new internal_node();
+                    for (size_t c = 0; c < take; ++c) {
+                        in->children[c] = level[used + c];
+                        if (c > 0) {
+                            new (in->keys() + c - 1) Key(*lows[used + c]);
+                        }
+                    }
+                    in->count = static_cast<uint32_t>(take - 1);
+                    parents.push_back(in);
+                    parent_lows.push_back(lows[used]);
+                    used += take;
+                }
+                level = std::move(parents);
+                lows = std::move(parent_lows);
+                ++height_;
+            }
+            root_ = level.front();
+        }
+
+        std::vector<Value> sorted_unique_values(std::vector<Value>&& values) const {
+            auto by_key = [this](const Value& a, const Value& b) { return comp_(KeyOf()(a), KeyOf()(b)); };
+            std::stable_sort(values.begin(), values.end(), by_key);
+            auto last = std::unique(values.begin(), values.end(), [this](const Value& a, const Value& b) {
+                return !comp_(KeyOf()(a), KeyOf()(b)) && !comp_(KeyOf()(b), KeyOf()(a));
+            });
+            values.erase(last, values.end());
+            return std::move(values);
+        }
+
+    protected:
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> emplace_key(const K& key, Args&&... args) {
+            return emplace_with_key(key, std::forward<Args>(args)...);
+        }
+
+    public:
+        btree() = default;
+
+        explicit btree(const Compare& comp) : comp_(comp) {}
+
+        template<typename InputIt>
+        btree(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+            build(sorted_unique_values(std::vector<Value>(first, last)));
+        }
+
+        template<typename InputIt>
+        btree(sorted_unique_t, InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+            build(std::vector<Value>(first, last));
+        }
+
+        btree(std::initializer_list<Value> values, const Compare& comp = Compare()) : comp_(comp) {
+            build(sorted_unique_values(std::vector<Value>(values)));
+        }
+
+        btree(const btree& other) : comp_(other.comp_) {
+            build(std::vector<Value>(other.begin(), other.end()));
+        }
+
+        btree(btree&& other) noexcept
+            : root_(other.root_), first_leaf_(other.first_leaf_), size_(other.size_),
+              height_(other.height_), comp_(std::move(other.comp_)) {
+            other.root_ = nullptr;
+            other.first_leaf_ = nullptr;
+            other.size_ = other.height_ = 0;
+        }
+
+        btree& operator=(btree other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~btree() { destroy(root_); }
+
+        void swap(btree& other) noexcept {
+            using std::swap;
+            swap(root_, other.root_);
+            swap(first_leaf_, other.first_leaf_);
+            swap(size_, other.size_);
+            swap(height_, other.height_);
+            swap(comp_, other.comp_);
+        }
+
+        friend void swap(btree& a, btree& b) noexcept { a.swap(b); }
+
+        // Iterators
+        iterator begin() { return iterator(first_leaf_, 0); }
+        iterator end() { return iterator(); }
+        const_iterator begin() const { return const_iterator(iterator(first_leaf_, 0)); }
+        const_iterator end() const { return const_iterator(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        // Capacity
+        size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        size_t height() const noexcept { return height_; }
+
+        void clear() noexcept {
+            destroy(root_);
+            root_ = nullptr;
+            first_leaf_ = nullptr;
+            size_ = height_ = 0;
+        }
+
+        // Bulk insertion: merge with the current contents and rebuild. Keys
+        // already present keep their current value
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            std::vector<Value> values;
+            values.reserve(size_);
+            for (iterator it = begin(); it != end(); ++it) {
+                values.push_back(std::move(*it));
+            }
+            values.insert(values.end(), first, last);
+            build(sorted_unique_values(std::move(values)));
+        }
+
+        // Repack underfull leaves left by erase
+        void compact() {
+            std::vector<Value> values;
+            values.reserve(size_);
+            for (iterator it = begin(); it != end(); ++it) {
+                values.push_back(std::move(*it));
+            }
+            build(std::move(values));
+        }
+
+        // Lookup
+        iterator lower_bound(const Key& key) { return lower_bound_impl(key); }
+        const_iterator lower_bound(const Key& key) const { return lower_bound_impl(key); }
+        iterator upper_bound(const Key& key) { return upper_bound_impl(key); }
+        const_iterator upper_bound(const Key& key) const { return upper_bound_impl(key); }
+        iterator find(const Key& key) { return find_impl(key); }
+        const_iterator find(const Key& key) const { return find_impl(key); }
+        bool contains(const Key& key) const { return find_impl(key) != iterator(); }
+        size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+        template<typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator lower_bound(const K& key) const { return lower_bound_impl(key); }
+        template<typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator upper_bound(const K& key) const { return upper_bound_impl(key); }
+        template<typename K, typename C = Compare, typename = typename C::is_transparent>
+        const_iterator find(const K& key) const { return find_impl(key); }
+        template<typename K, typename C = Compare, typename = typename C::is_transparent>
+        bool contains(const K& key) const { return find_impl(key) != iterator(); }
+
+        // Range scan over keys in [low, high): one descent, then a walk
+        // along the leaf chain
+        iterator_range<const_iterator> range(const Key& low, const Key& high) const {
+            return {lower_bound(low), lower_bound(high)};
+        }
+
+        template<typename K, typename C = Compare, typename = typename C::is_transparent>
+        iterator_range<const_iterator> range(const K& low, const K& high) const {
+            return {lower_bound_impl(low), lower_bound_impl(high)};
+        }
+
+        // Removal (no rebalancing; see compact())
+        size_t erase(const Key& key) {
+            iterator it = find_impl(key);
+            if (it == iterator()) {
+                return 0;
+            }
+            erase(it);
+            return 1;
+        }
+
+        iterator erase(const_iterator position) {
+            leaf_node* leaf = position.leaf_;
+            uint32_t slot = position.index_;
+            Value* values = leaf->values();
+            std::move(values + slot + 1, values + leaf->count, values + slot);
+            values[leaf->count - 1].~Value();
+            --leaf->count;
+            --size_;
+            return iterator(leaf, slot);
+        }
+
+        iterator erase(iterator position) { return erase(const_iterator(position)); }
+
+        key_compare key_comp() const { return comp_; }
+
+        friend bool operator==(const btree& a, const btree& b) {
+            return a.size_ == b.size_ && std::equal(a.begin(), a.end(), b.begin());
+        }
+
+        friend bool operator!=(const btree& a, const btree& b) { return !(a == b); }
+    };
+}
+
+// B+-tree map. Elements are std::pair<Key, T>; never modify a key through
+// an iterator
+template<typename Key, typename T, typename Compare = std::less<Key>, size_t NodeBytes = 256>
+class btree_map
+    : public btree_detail::btree<Key, std::pair<Key, T>, btree_detail::map_key, Compare, NodeBytes> {
+private:
+    using base = btree_detail::btree<Key, std::pair<Key, T>, btree_detail::map_key, Compare, NodeBytes>;
+
+public:
+    using mapped_type = T;
+    using typename base::value_type;
+    using typename base::iterator;
+    using typename base::const_iterator;
+
+    using base::base;
+    using base::insert;
+
+    btree_map() = default;
+
+    std::pair<iterator, bool> insert(const value_type& value) { return this->emplace_key(value.first, value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return this->emplace_key(value.first, std::move(value)); }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return this->emplace_key(value.first, std::move(value));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& mapped) {
+        auto result = try_emplace(key, std::forward<M>(mapped));
+        if (!result.second) {
+            result.first->second = std::forward<M>(mapped);
+        }
+        return result;
+    }
+
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+
+    T& at(const Key& key) {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            throw std::out_of_range("btree_map::at: key not found");
+        }
+        return it->second;
+    }
+
+    const T& at(const Key& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            throw std::out_of_range("btree_map::at: key not found");
+        }
+        return it->second;
+    }
+};
+
+template<typename Key, typename Compare = std::less<Key>, size_t NodeBytes = 256>
+class btree_set
+    : public btree_detail::btree<Key, Key, btree_detail::identity_key, Compare, NodeBytes> {
+private:
+    using base = btree_detail::btree<Key, Key, btree_detail::identity_key, Compare, NodeBytes>;
+
+public:
+    using typename base::value_type;
+    using iterator = typename base::const_iterator;
+    using const_iterator = typename base::const_iterator;
+
+    using base::base;
+    using base::insert;
+
+    btree_set() = default;
+
+    const_iterator begin() const { return base::begin(); }
+    const_iterator end() const { return base::end(); }
+
+    std::pair<const_iterator, bool> insert(const Key& key) { return this->emplace_key(key, key); }
+    std::pair<const_iterator, bool> insert(Key&& key) { return this->emplace_key(key, std::move(key)); }
+
+    template<typename... Args>
+    std::pair<const_iterator, bool> emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        return this->emplace_key(key, std::move(key));
+    }
+};
@@ -10,6 +10,12 @@
  * - Deque: Fast insertion/deletion at ends, slower random access than vector
  * - Set/Map: Logarithmic operations, ordered data
  * - Unordered_set/map: Average constant time operations, unordered data
+ * - flat_hash_map: the same operations without a node per element
+ * - flat_set/btree_set: ordered like std::set, with contiguous or
+ *   cache-line-sized nodes for faster lookups and range scans
+ *
+ * Timings go through benchmark.hpp: warmup, repeated trials and the
+ * median, with CSV/JSON output and optional hardware counters.
  */
 
 #include <iostream>
@@ -20,27 +26,28 @@
 #include <unordered_set>
 #include <map>
 #include <unordered_map>
-#include <chrono>
 #include <random>
 #include <algorithm>
 #include <iomanip>
+#include "benchmark.hpp"
+#include "flat_hash_map.hpp"
+#include "flat_map.hpp"
+#include "btree_map.hpp"
 
 class PerformanceTester {
 private:
     std::random_device rd;
     std::mt19937 gen;
     std::uniform_int_distribution<> dis;
+    bench::Suite& suite;
     
 public:
-    PerformanceTester() : gen(rd()), dis(1, 100000) {}
+    explicit PerformanceTester(bench::Suite& s) : gen(rd()), dis(1, 100000), suite(s) {}
     
+    // Median milliseconds per call over the suite's trials
     template<typename Func>
-    double measureTime(Func&& func) {
-        auto start = std::chrono::high_resolution_clock::now();
-        func();
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        return duration.count() / 1000.0; // Return milliseconds
+    double measureTime(const std::string& name, Func&& func) {
+        return suite.run(name, std::forward<Func>(func)).median_ms();
     }
     
     void printHeader(const std::string& title) {
@@ -67,7 +74,7 @@ public:
         std::list<int> lst;
         std::deque<int> deq;
         
-        double vecTime = measureTime([&]() {
+        double vecTime = measureTime("back_insertion/vector", [&]() {
             vec.clear();
             vec.reserve(size); // Pre-allocate for fair comparison
             for (size_t i = 0; i < size; ++i) {
@@ -75,14 +82,14 @@ public:
             }
         });
         
-        double lstTime = measureTime([&]() {
+        double lstTime = measureTime("back_insertion/list", [&]() {
             lst.clear();
             for (size_t i = 0; i < size; ++i) {
                 lst.push_back(dis(gen));
             }
         });
         
-        double deqTime = measureTime([&]() {
+        double deqTime = measureTime("back_insertion/deque", [&]() {
             deq.clear();
             for (size_t i = 0; i < size; ++i) {
                 deq.push_back(dis(gen));
@@ -95,20 +102,22 @@ public:
                   << std::setw(12) << deqTime << " ms" << std::endl;
         
         // Test 2: Random access (only vector and deque)
-        vecTime = measureTime([&]() {
-            volatile int sum = 0;
+        vecTime = measureTime("random_access/vector", [&]() {
+            int sum = 0;
             for (size_t i = 0; i < iterations; ++i) {
                 size_t idx = dis(gen) % vec.size();
                 sum += vec[idx];
             }
+            bench::do_not_optimize(sum);
         });
         
-        deqTime = measureTime([&]() {
-            volatile int sum = 0;
+        deqTime = measureTime("random_access/deque", [&]() {
+            int sum = 0;
             for (size_t i = 0; i < iterations; ++i) {
                 size_t idx = dis(gen) % deq.size();
                 sum += deq[idx];
             }
+            bench::do_not_optimize(sum);
         });
         
         std::cout << std::setw(20) << "Random Access" 
@@ -117,14 +126,14 @@ public:
                   << std::setw(12) << deqTime << " ms" << std::endl;
         
         // Test 3: Middle insertion
-        vecTime = measureTime([&]() {
+        vecTime = measureTime("middle_insertion/vector", [&]() {
             for (size_t i = 0; i < iterations / 10; ++i) {
                 auto it = vec.begin() + vec.size() / 2;
                 vec.insert(it, dis(gen));
             }
         });
         
-        lstTime = measureTime([&]() {
+        lstTime = measureTime("middle_insertion/list", [&]() {
             for (size_t i = 0; i < iterations / 10; ++i) {
                 auto it = lst.begin();
                 std::advance(it, lst.size() / 2);
@@ -132,7 +141,7 @@ public:
             }
         });
         
-        deqTime = measureTime([&]() {
+        deqTime = measureTime("middle_insertion/deque", [&]() {
             for (size_t i = 0; i < iterations / 10; ++i) {
                 auto it = deq.begin() + deq.size() / 2;
                 deq.insert(it, dis(gen));
@@ -145,25 +154,28 @@ public:
                   << std::setw(12) << deqTime << " ms" << std::endl;
         
         // Test 4: Sequential iteration
-        vecTime = measureTime([&]() {
-            volatile long long sum = 0;
+        vecTime = measureTime("sequential_iteration/vector", [&]() {
+            long long sum = 0;
             for (const auto& val : vec) {
                 sum += val;
             }
+            bench::do_not_optimize(sum);
         });
         
-        lstTime = measureTime([&]() {
-            volatile long long sum = 0;
+        lstTime = measureTime("sequential_iteration/list", [&]() {
+            long long sum = 0;
             for (const auto& val : lst) {
                 sum += val;
             }
+            bench::do_not_optimize(sum);
         });
         
-        deqTime = measureTime([&]() {
-            volatile long long sum = 0;
+        deqTime = measureTime("sequential_iteration/deque", [&]() {
+            long long sum = 0;
             for (const auto& val : deq) {
                 sum += val;
             }
+            bench::do_not_optimize(sum);
         });
         
         std::cout << std::setw(20) << "Sequential Iteration" 
@@ -177,35 +189,64 @@ public:
         
         const size_t size = 50000;
         const size_t lookups = 10000;
+        const size_t scans = 1000;
         
         std::cout << std::fixed << std::setprecision(3);
         std::cout << std::setw(20) << "Operation" 
                   << std::setw(15) << "std::set" 
-                  << std::setw(15) << "std::unordered_set" << std::endl;
-        std::cout << std::string(50, '-') << std::endl;
+                  << std::setw(20) << "std::unordered_set"
+                  << std::setw(12) << "flat_set"
+                  << std::setw(12) << "btree_set" << std::endl;
+        std::cout << std::string(79, '-') << std::endl;
+        
+        auto printRow = [](const char* label, double set, double unordered, double flat, double btree) {
+            std::cout << std::setw(20) << label 
+                      << std::setw(15) << set 
+                      << std::setw(20) << unordered
+                      << std::setw(12) << flat
+                      << std::setw(12) << btree << " ms" << std::endl;
+        };
         
         std::set<int> orderedSet;
         std::unordered_set<int> unorderedSet;
+        flat_set<int> flatSet;
+        btree_set<int> btreeSet;
         
-        // Test 1: Insertion
-        double setTime = measureTime([&]() {
+        std::vector<int> values;
+        for (size_t i = 0; i < size; ++i) {
+            values.push_back(dis(gen));
+        }
+        
+        // Test 1: Insertion (flat_set is bulk-built: one sort instead of
+        // shifting the tail per element)
+        double setTime = measureTime("insertion/std::set", [&]() {
             orderedSet.clear();
-            for (size_t i = 0; i < size; ++i) {
-                orderedSet.insert(dis(gen));
+            for (int val : values) {
+                orderedSet.insert(val);
             }
         });
         
-        double unorderedSetTime = measureTime([&]() {
+        double unorderedSetTime = measureTime("insertion/std::unordered_set", [&]() {
             unorderedSet.clear();
             unorderedSet.reserve(size);
-            for (size_t i = 0; i < size; ++i) {
-                unorderedSet.insert(dis(gen));
+            for (int val : values) {
+                unorderedSet.insert(val);
             }
         });
         
-        std::cout << std::setw(20) << "Insertion" 
-                  << std::setw(15) << setTime 
-                  << std::setw(15) << unorderedSetTime << " ms" << std::endl;
+        double flatSetTime = measureTime("insertion/flat_set", [&]() {
+            flatSet.clear();
+            flatSet.insert(values.begin(), values.end());
+        });
+        
+        double btreeSetTime = measureTime("insertion/btree_set", [&]() {
+            btreeSet.clear();
+            for (int val : values) {
+                btreeSet.insert(val);
+            }
+        });
+        
+        printRow("Insertion", setTime, unorderedSetTime, flatSetTime, btreeSetTime);
         
         // Test 2: Lookup
         std::vector<int> lookupValues;
@@ -213,46 +254,69 @@ public:
             lookupValues.push_back(dis(gen));
         }
         
-        setTime = measureTime([&]() {
-            volatile size_t found = 0;
-            for (int val : lookupValues) {
-                if (orderedSet.find(val) != orderedSet.end()) {
-                    ++found;
+        auto lookupAll = [&](const char* name, const auto& container) {
+            return measureTime(std::string("lookup/") + name, [&]() {
+                size_t found = 0;
+                for (int val : lookupValues) {
+                    if (container.find(val) != container.end()) {
+                        ++found;
+                    }
                 }
-            }
-        });
+                bench::do_not_optimize(found);
+            });
+        };
         
-        unorderedSetTime = measureTime([&]() {
-            volatile size_t found = 0;
-            for (int val : lookupValues) {
-                if (unorderedSet.find(val) != unorderedSet.end()) {
-                    ++found;
-                }
-            }
-        });
-        
-        std::cout << std::setw(20) << "Lookup" 
-                  << std::setw(15) << setTime 
-                  << std::setw(15) << unorderedSetTime << " ms" << std::endl;
+        printRow("Lookup", lookupAll("std::set", orderedSet), lookupAll("std::unordered_set", unorderedSet),
+                 lookupAll("flat_set", flatSet), lookupAll("btree_set", btreeSet));
         
         // Test 3: Iteration (ordered vs unordered)
-        setTime = measureTime([&]() {
-            volatile long long sum = 0;
-            for (const auto& val : orderedSet) {
-                sum += val;
-            }
-        });
+        auto iterateAll = [&](const char* name, const auto& container) {
+            return measureTime(std::string("iteration/") + name, [&]() {
+                long long sum = 0;
+                for (const auto& val : container) {
+                    sum += val;
+                }
+                bench::do_not_optimize(sum);
+            });
+        };
+        
+        printRow("Iteration", iterateAll("std::set", orderedSet), iterateAll("std::unordered_set", unorderedSet),
+                 iterateAll("flat_set", flatSet), iterateAll("btree_set", btreeSet));
+        
+        // Test 4: Range scans over [low, low + 2000); the unordered set has
+        // to filter everything
+        std::vector<int> scanStarts;
+        for (size_t i = 0; i < scans; ++i) {
+            scanStarts.push_back(dis(gen));
+        }
         
-        unorderedSetTime = measureTime([&]() {
-            volatile long long sum = 0;
-            for (const auto& val : unorderedSet) {
-                sum += val;
+        auto scanOrdered = [&](const char* name, const auto& container) {
+            return measureTime(std::string("range_scan/") + name, [&]() {
+                long long sum = 0;
+                for (int low : scanStarts) {
+                    auto last = container.lower_bound(low + 2000);
+                    for (auto it = container.lower_bound(low); it != last; ++it) {
+                        sum += *it;
+                    }
+                }
+                bench::do_not_optimize(sum);
+            });
+        };
+        
+        setTime = scanOrdered("std::set", orderedSet);
+        unorderedSetTime = measureTime("range_scan/std::unordered_set", [&]() {
+            long long sum = 0;
+            for (int low : scanStarts) {
+                for (int val : unorderedSet) {
+                    if (val >= low && val < low + 2000) {
+                        sum += val;
+                    }
+                }
             }
+            bench::do_not_optimize(sum);
         });
         
-        std::cout << std::setw(20) << "Iteration" 
-                  << std::setw(15) << setTime 
-                  << std::setw(15) << unorderedSetTime << " ms" << std::endl;
+        printRow("Range Scan", setTime, unorderedSetTime, scanOrdered("flat_set", flatSet), scanOrdered("btree_set", btreeSet));
     }
     
     void testMapPerformance() {
@@ -264,11 +328,13 @@ public:
         std::cout << std::fixed << std::setprecision(3);
         std::cout << std::setw(20) << "Operation" 
                   << std::setw(15) << "std::map" 
-                  << std::setw(15) << "std::unordered_map" << std::endl;
-        std::cout << std::string(50, '-') << std::endl;
+                  << std::setw(20) << "std::unordered_map"
+                  << std::setw(16) << "flat_hash_map" << std::endl;
+        std::cout << std::string(71, '-') << std::endl;
         
         std::map<int, std::string> orderedMap;
         std::unordered_map<int, std::string> unorderedMap;
+        flat_hash_map<int, std::string> flatMap;
         
         // Generate test data
         std::vector<std::pair<int, std::string>> testData;
@@ -277,14 +343,14 @@ public:
         }
         
         // Test 1: Insertion
-        double mapTime = measureTime([&]() {
+        double mapTime = measureTime("insertion/std::map", [&]() {
             orderedMap.clear();
             for (const auto& pair : testData) {
                 orderedMap[pair.first] = pair.second;
             }
         });
         
-        double unorderedMapTime = measureTime([&]() {
+        double unorderedMapTime = measureTime("insertion/std::unordered_map", [&]() {
             unorderedMap.clear();
             unorderedMap.reserve(size);
             for (const auto& pair : testData) {
@@ -292,9 +358,18 @@ public:
             }
         });
         
+        double flatMapTime = measureTime("insertion/flat_hash_map", [&]() {
+            flatMap.clear();
+            flatMap.reserve(size);
+            for (const auto& pair : testData) {
+                flatMap[pair.first] = pair.second;
+            }
+        });
+        
         std::cout << std::setw(20) << "Insertion" 
                   << std::setw(15) << mapTime 
-                  << std::setw(15) << unorderedMapTime << " ms" << std::endl;
+                  << std::setw(20) << unorderedMapTime
+                  << std::setw(16) << flatMapTime << " ms" << std::endl;
         
         // Test 2: Lookup
         std::vector<int> keys;
@@ -302,50 +377,132 @@ public:
             keys.push_back(dis(gen));
         }
         
-        mapTime = measureTime([&]() {
-            volatile size_t found = 0;
+        mapTime = measureTime("lookup/std::map", [&]() {
+            size_t found = 0;
             for (int key : keys) {
                 if (orderedMap.find(key) != orderedMap.end()) {
                     ++found;
                 }
             }
+            bench::do_not_optimize(found);
         });
         
-        unorderedMapTime = measureTime([&]() {
-            volatile size_t found = 0;
+        unorderedMapTime = measureTime("lookup/std::unordered_map", [&]() {
+            size_t found = 0;
             for (int key : keys) {
                 if (unorderedMap.find(key) != unorderedMap.end()) {
                     ++found;
                 }
             }
+            bench::do_not_optimize(found);
+        });
+        
+        flatMapTime = measureTime("lookup/flat_hash_map", [&]() {
+            size_t found = 0;
+            for (int key : keys) {
+                if (flatMap.find(key) != flatMap.end()) {
+                    ++found;
+                }
+            }
+            bench::do_not_optimize(found);
         });
         
         std::cout << std::setw(20) << "Lookup" 
                   << std::setw(15) << mapTime 
-                  << std::setw(15) << unorderedMapTime << " ms" << std::endl;
+                  << std::setw(20) << unorderedMapTime
+                  << std::setw(16) << flatMapTime << " ms" << std::endl;
         
         // Test 3: Range iteration
-        mapTime = measureTime([&]() {
-            volatile size_t count = 0;
+        mapTime = measureTime("range_iteration/std::map", [&]() {
+            size_t count = 0;
             for (const auto& pair : orderedMap) {
                 if (pair.first > 50000) {
                     ++count;
                 }
             }
+            bench::do_not_optimize(count);
         });
         
-        unorderedMapTime = measureTime([&]() {
-            volatile size_t count = 0;
+        unorderedMapTime = measureTime("range_iteration/std::unordered_map", [&]() {
+            size_t count = 0;
             for (const auto& pair : unorderedMap) {
                 if (pair.first > 50000) {
                     ++count;
                 }
             }
+            bench::do_not_optimize(count);
+        });
+        
+        flatMapTime = measureTime("range_iteration/flat_hash_map", [&]() {
+            size_t count = 0;
+            for (const auto& pair : flatMap) {
+                if (pair.first > 50000) {
+                    ++count;
+                }
+            }
+            bench::do_not_optimize(count);
         });
         
         std::cout << std::setw(20) << "Range Iteration" 
                   << std::setw(15) << mapTime 
-                  << std::setw(15) << unorderedMapTime << " ms" << std::endl;
+                  << std::setw(20) << unorderedMapTime
+                  << std::setw(16) << flatMapTime << " ms" << std::endl;
+        
+        // A frozen table is read-only and sized for short probe sequences
+        flatMap.freeze();
+        flatMapTime = measureTime("lookup_frozen/flat_hash_map", [&]() {
+            size_t found = 0;
+            for (int key : keys) {
+                if (flatMap.contains(key)) {
+                    ++found;
+                }
+            }
+            bench::do_not_optimize(found);
+        });
+        std::cout << std::setw(20) << "Lookup (frozen)" 
+                  << std::setw(15) << "-" 
+                  << std::setw(20) << "-"
+                  << std::setw(16) << flatMapTime << " ms" << std::endl;
+    }
+    
+    // Per-element cost of a full scan as the working set outgrows each
+    // cache level: contiguous storage stays flat, node-based containers
+    // climb once their nodes no longer fit
+    void testSizeSweep() {
+        printHeader("Iteration Cost vs Container Size (ns per element)");
+        
+        std::vector<size_t> sizes = bench::geometric_sizes(1 << 10, 1 << 20, 4);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << std::setw(12) << "Elements" << std::setw(12) << "vector" << std::setw(12) << "list"
+                  << std::setw(12) << "std::set" << std::setw(12) << "flat_set" << std::setw(12) << "btree_set" << std::endl;
+        std::cout << std::string(72, '-') << std::endl;
+        
+        for (size_t n : sizes) {
+            std::vector<int> values(n);
+            for (auto& value : values) {
+                value = dis(gen);
+            }
+            std::vector<int> vec(values.begin(), values.end());
+            std::list<int> lst(values.begin(), values.end());
+            std::set<int> set(values.begin(), values.end());
+            flat_set<int> flat(values.begin(), values.end());
+            btree_set<int> btree(values.begin(), values.end());
+            
+            auto scan = [&](const char* name, const auto& container) {
+                bench::Result result = suite.run(std::string("scan/") + name, [&]() {
+                    long long sum = 0;
+                    for (int value : container) {
+                        sum += value;
+                    }
+                    bench::do_not_optimize(sum);
+                }, static_cast<int64_t>(n));
+                return result.median / static_cast<double>(container.size());
+            };
+            
+            std::cout << std::setw(12) << n << std::setw(12) << scan("vector", vec) << std::setw(12) << scan("list", lst)
+                      << std::setw(12) << scan("std::set", set) << std::setw(12) << scan("flat_set", flat)
+                      << std::setw(12) << scan("btree_set", btree) << std::endl;
+        }
     }
     
     void demonstrateMemoryUsage() {
@@ -428,20 +585,32 @@ void demonstrateContainerChoice() {
     std::cout << "   - You have a good hash function" << std::endl;
 }
 
-int main() {
+// Usage: container_performance [--format=table|csv|json] [--out=FILE] [--trials=N]
+//                              [--warmup=N] [--min-time=MS] [--filter=NAME] [--counters]
+int main(int argc, char* argv[]) {
     std::cout << "===== STL Container Performance Analysis =====" << std::endl;
     std::cout << "This program analyzes the performance characteristics of different STL containers." << std::endl;
     std::cout << "Understanding these differences is crucial for writing efficient C++ code." << std::endl;
     
-    PerformanceTester tester;
+    bench::Suite suite(bench::Config::from_args(argc, argv));
+    std::cout << "Each time is the median of " << suite.config().trials << " trials after "
+              << suite.config().warmup << " warmup run(s)." << std::endl;
+    
+    PerformanceTester tester(suite);
     
     tester.testSequentialContainers();
     tester.testAssociativeContainers();
     tester.testMapPerformance();
+    tester.testSizeSweep();
     tester.demonstrateMemoryUsage();
     
     demonstrateContainerChoice();
     
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "  Benchmark Report" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    suite.report();
+    
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "Performance testing complete!" << std::endl;
     std::cout << "Note: Results may vary based on compiler optimizations and hardware." << std::endl;
@@ -13,306 +13,15 @@
  * - Performance implications
  */
 
-#include <iostream>
-#include <vector>
+#include "custom_allocators.hpp"
+#include "benchmark.hpp"
 #include <list>
-#include <memory>
+#include <map>
 #include <chrono>
-#include <iomanip>
 #include <cassert>
-#include <cstdlib>
-#include <new>
-
-// 1. Logging Allocator - tracks all allocations
-template<typename T>
-class LoggingAllocator {
-public:
-    using value_type = T;
-    using size_type = std::size_t;
-    using difference_type = std::ptrdiff_t;
-    using propagate_on_container_copy_assignment = std::true_type;
-    using propagate_on_container_move_assignment = std::true_type;
-    using propagate_on_container_swap = std::true_type;
-    
-private:
-    static size_type allocation_count_;
-    static size_type deallocation_count_;
-    static size_type bytes_allocated_;
-    static size_type bytes_deallocated_;
-    
-public:
-    LoggingAllocator() = default;
-    
-    template<typename U>
-    LoggingAllocator(const LoggingAllocator<U>&) noexcept {}
-    
-    T* allocate(size_type n) {
-        size_type bytes = n * sizeof(T);
-        T* ptr = static_cast<T*>(std::malloc(bytes));
-        
-        if (!ptr) {
-            throw std::bad_alloc();
-        }
-        
-        ++allocation_count_;
-        bytes_allocated_ += bytes;
-        
-        std::cout << "[ALLOC] " << n << " objects of " << sizeof(T) 
-                  << " bytes each = " << bytes << " bytes at " << ptr << std::endl;
-        
-        return ptr;
-    }
-    
-    void deallocate(T* ptr, size_type n) {
-        size_type bytes = n * sizeof(T);
-        
-        ++deallocation_count_;
-        bytes_deallocated_ += bytes;
-        
-        std::cout << "[DEALLOC] " << n << " objects = " << bytes 
-                  << " bytes at " << ptr << std::endl;
-        
-        std::free(ptr);
-    }
-    
-    template<typename U>
-    bool operator==(const LoggingAllocator<U>&) const noexcept { return true; }
-    
-    template<typename U>
-    bool operator!=(const LoggingAllocator<U>&) const noexcept { return false; }
-    
-    static void print_stats() {
-        std::cout << "\n=== Allocation Statistics ===" << std::endl;
-        std::cout << "Allocations: " << allocation_count_ << std::endl;
-        std::cout << "Deallocations: " << deallocation_count_ << std::endl;
-        std::cout << "Bytes allocated: " << bytes_allocated_ << std::endl;
-        std::cout << "Bytes deallocated: " << bytes_deallocated_ << std::endl;
-        std::cout << "Net bytes: " << (bytes_allocated_ - bytes_deallocated_) << std::endl;
-        std::cout << "=============================" << std::endl;
-    }
-    
-    static void reset_stats() {
-        allocation_count_ = 0;
-        deallocation_count_ = 0;
-        bytes_allocated_ = 0;
-        bytes_deallocated_ = 0;
-    }
-};
-
-// Static member definitions
-template<typename T>
-typename LoggingAllocator<T>::size_type LoggingAllocator<T>::allocation_count_ = 0;
-
-template<typename T>
-typename LoggingAllocator<T>::size_type LoggingAllocator<T>::deallocation_count_ = 0;
-
-template<typename T>
-typename LoggingAllocator<T>::size_type LoggingAllocator<T>::bytes_allocated_ = 0;
-
-template<typename T>
-typename LoggingAllocator<T>::size_type LoggingAllocator<T>::bytes_deallocated_ = 0;
-
-// 2. Memory Pool Allocator
-template<typename T, size_t BlockSize = 1024>
-class PoolAllocator {
-public:
-    using value_type = T;
-    using size_type = std::size_t;
-    using difference_type = std::ptrdiff_t;
-    using propagate_on_container_copy_assignment = std::false_type;
-    using propagate_on_container_move_assignment = std::false_type;
-    using propagate_on_container_swap = std::false_type;
-    
-private:
-    struct Block {
-        alignas(T) char data[BlockSize * sizeof(T)];
-        Block* next;
-        size_type used;
-        
-        Block() : next(nullptr), used(0) {}
-        
-        T* allocate() {
-            if (used >= BlockSize) {
-                return nullptr;
-            }
-            T* ptr = reinterpret_cast<T*>(data + used * sizeof(T));
-            ++used;
-            return ptr;
-        }
-        
-        bool contains(T* ptr) const {
-            return ptr >= reinterpret_cast<const T*>(data) && 
-                   ptr < reinterpret_cast<const T*>(data + BlockSize * sizeof(T));
-        }
-    };
-    
-    mutable Block* current_block_;
-    mutable std::vector<std::unique_ptr<Block>> blocks_;
-    
-    Block* allocate_new_block() const {
-        blocks_.push_back(std::make_unique<Block>());
-        current_block_ = blocks_.back().get();
-        return current_block_;
-    }
-    
-public:
-    PoolAllocator() : current_block_(nullptr) {}
-    
-    template<typename U>
-    PoolAllocator(const PoolAllocator<U, BlockSize>& other) noexcept 
-        : current_block_(nullptr) {}
-    
-    T* allocate(size_type n) {
-        if (n != 1) {
-            // For simplicity, only support single object allocation
-            throw std::bad_alloc();
-        }
-        
-        if (!current_block_ || current_block_->used >= BlockSize) {
-            allocate_new_block();
-        }
-        
-        T* ptr = current_block_->allocate();
-        if (!ptr) {
-            allocate_new_block();
-            ptr = current_block_->allocate();
-        }
-        
-        if (!ptr) {
-            throw std::bad_alloc();
-        }
-        
-        return ptr;
-    }
-    
-    void deallocate(T* ptr, size_type n) {
-        // Pool allocator doesn't deallocate individual objects
-        // Memory is freed when the allocator is destroyed
-    }
-    
-    template<typename U>
-    bool operator==(const PoolAllocator<U, BlockSize>&) const noexcept { return false; }
-    
-    template<typename U>
-    bool operator!=(const PoolAllocator<U, BlockSize>&) const noexcept { return true; }
-    
-    size_type get_block_count() const { return blocks_.size(); }
-    size_type get_total_capacity() const { return blocks_.size() * BlockSize; }
-    
-    void print_stats() const {
-        std::cout << "Pool Allocator Stats:" << std::endl;
-        std::cout << "  Blocks: " << blocks_.size() << std::endl;
-        std::cout << "  Total capacity: " << get_total_capacity() << " objects" << std::endl;
-        std::cout << "  Memory usage: " << blocks_.size() * sizeof(Block) << " bytes" << std::endl;
-    }
-};
-
-// 3. Stack Allocator (uses pre-allocated buffer)
-template<typename T, size_t N>
-class StackAllocator {
-public:
-    using value_type = T;
-    using size_type = std::size_t;
-    using difference_type = std::ptrdiff_t;
-    using propagate_on_container_copy_assignment = std::false_type;
-    using propagate_on_container_move_assignment = std::false_type;
-    using propagate_on_container_swap = std::false_type;
-    
-private:
-    alignas(T) mutable char buffer_[N * sizeof(T)];
-    mutable size_type used_;
-    
-public:
-    StackAllocator() : used_(0) {}
-    
-    template<typename U>
-    StackAllocator(const StackAllocator<U, N>&) noexcept : used_(0) {}
-    
-    T* allocate(size_type n) {
-        if (used_ + n > N) {
-            throw std::bad_alloc();
-        }
-        
-        T* ptr = reinterpret_cast<T*>(buffer_ + used_ * sizeof(T));
-        used_ += n;
-        return ptr;
-    }
-    
-    void deallocate(T* ptr, size_type n) {
-        // Stack allocator doesn't support individual deallocation
-        // Only supports LIFO deallocation pattern
-        if (ptr + n == reinterpret_cast<T*>(buffer_ + used_ * sizeof(T))) {
-            used_ -= n;
-        }
-    }
-    
-    template<typename U>
-    bool operator==(const StackAllocator<U, N>&) const noexcept { return false; }
-    
-    template<typename U>
-    bool operator!=(const StackAllocator<U, N>&) const noexcept { return true; }
-    
-    size_type capacity() const { return N; }
-    size_type size() const { return used_; }
-    size_type available() const { return N - used_; }
-    
-    void reset() { used_ = 0; }
-    
-    void print_stats() const {
-        std::cout << "Stack Allocator Stats:" << std::endl;
-        std::cout << "  Capacity: " << N << " objects" << std::endl;
-        std::cout << "  Used: " << used_ << " objects" << std::endl;
-        std::cout << "  Available: " << available() << " objects" << std::endl;
-        std::cout << "  Usage: " << std::fixed << std::setprecision(1) 
-                  << (100.0 * used_ / N) << "%" << std::endl;
-    }
-};
-
-// 4. Aligned Allocator (for SIMD operations)
-template<typename T, size_t Alignment = 32>
-class AlignedAllocator {
-public:
-    using value_type = T;
-    using size_type = std::size_t;
-    using difference_type = std::ptrdiff_t;
-    using propagate_on_container_copy_assignment = std::true_type;
-    using propagate_on_container_move_assignment = std::true_type;
-    using propagate_on_container_swap = std::true_type;
-    
-    static_assert(Alignment >= alignof(T), "Alignment must be at least alignof(T)");
-    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be power of 2");
-    
-public:
-    AlignedAllocator() = default;
-    
-    template<typename U>
-    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
-    
-    T* allocate(size_type n) {
-        size_type bytes = n * sizeof(T);
-        
-        // Use aligned_alloc (C++17) or fallback to malloc + manual alignment
-        void* ptr = std::aligned_alloc(Alignment, bytes);
-        
-        if (!ptr) {
-            throw std::bad_alloc();
-        }
-        
-        return static_cast<T*>(ptr);
-    }
-    
-    void deallocate(T* ptr, size_type n) {
-        std::free(ptr);
-    }
-    
-    template<typename U>
-    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
-    
-    template<typename U>
-    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
-    
-    static constexpr size_type alignment() { return Alignment; }
-};
+#include <thread>
+#include <fstream>
+#include <string>
 
 void demonstrateLoggingAllocator() {
     std::cout << "\n" << std::string(60, '=') << std::endl;
@@ -349,10 +58,12 @@ void demonstratePoolAllocator() {
     std::cout << "  Pool Allocator Demonstration" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
     
-    const size_t num_elements = 2500; // More than one block
+    const size_t num_elements = 2500; // More than one chunk
+    auto pool = std::make_shared<PoolResource>(1000);
+    PoolAllocator<int, 1000> alloc(pool);
     
     {
-        std::list<int, PoolAllocator<int, 1000>> pool_list;
+        std::list<int, PoolAllocator<int, 1000>> pool_list(alloc);
         
         std::cout << "Adding " << num_elements << " elements to list with pool allocator:" << std::endl;
         
@@ -361,9 +72,6 @@ void demonstratePoolAllocator() {
         }
         
         std::cout << "List size: " << pool_list.size() << std::endl;
-        
-        // Access the allocator to print stats
-        auto alloc = pool_list.get_allocator();
         alloc.print_stats();
         
         std::cout << "\nFirst 10 elements: ";
@@ -372,6 +80,40 @@ void demonstratePoolAllocator() {
             std::cout << *it << " ";
         }
         std::cout << std::endl;
+        
+        // Freed nodes go back on the free lists and are handed out again
+        size_t chunks = pool->chunk_count();
+        for (int round = 0; round < 10; ++round) {
+            pool_list.clear();
+            for (size_t i = 0; i < num_elements; ++i) {
+                pool_list.push_back(static_cast<int>(i));
+            }
+        }
+        std::cout << "\nAfter 10 clear/refill rounds: " << pool->chunk_count() << " chunks (was "
+                  << chunks << ")" << std::endl;
+                  
+        // Same pool, so move-assignment steals the nodes instead of copying them
+        std::list<int, PoolAllocator<int, 1000>> other(alloc);
+        const int* first = &pool_list.front();
+        other = std::move(pool_list);
+        std::cout << "Move-assigned list kept its nodes: " << (&other.front() == first ? "Yes" : "No") << std::endl;
+        
+        // Nodes freed on another thread return through the shared depot
+        std::thread consumer([list = std::move(other)]() mutable { list.clear(); });
+        consumer.join();
+        std::list<int, PoolAllocator<int, 1000>> refilled(alloc);
+        for (size_t i = 0; i < num_elements; ++i) {
+            refilled.push_back(static_cast<int>(i));
+        }
+        std::cout << "Refilled after a cross-thread free: " << pool->chunk_count() << " chunks" << std::endl;
+        
+        // Rebinding shares the pool: map nodes use their own size class
+        std::map<int, int, std::less<int>, PoolAllocator<std::pair<const int, int>, 1000>> index(alloc);
+        for (int i = 0; i < static_cast<int>(num_elements); ++i) {
+            index[i] = i * i;
+        }
+        std::cout << "Map of " << index.size() << " entries on the same pool: " << pool->chunk_count()
+                  << " chunks" << std::endl;
     }
     
     std::cout << "Pool allocator destroyed (all memory freed)" << std::endl;
@@ -387,6 +129,10 @@ void demonstrateStackAllocator() {
         
         std::cout << "Creating vector with stack allocator (capacity: 100):" << std::endl;
         
+        // Reserve up front: growth frees the old buffer out of LIFO order,
+        // and a bump allocator cannot reclaim that space
+        stack_vec.reserve(50);
+        
         // Add elements
         for (int i = 0; i < 50; ++i) {
             stack_vec.push_back(i * 2);
@@ -443,32 +189,80 @@ void demonstrateAlignedAllocator() {
         }
         std::cout << std::endl;
     }
+    
+    // Counters bumped by different threads: packed ones share a cache line
+    // and bounce it between cores, padded ones each own a line
+    {
+        const int threads = 4;
+        const long increments = 5000000;
+        auto time_counters = [&](auto& counters) {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&counters, t, increments] {
+                    for (long i = 0; i < increments; ++i) {
+                        counters[t].value.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            for (auto& worker : workers) worker.join();
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+        
+        struct Packed { std::atomic<long> value{0}; };
+        std::vector<Packed> packed(threads);
+        std::vector<CachePadded<std::atomic<long>>, AlignedAllocator<CachePadded<std::atomic<long>>, CACHE_LINE_SIZE>> padded(threads);
+        
+        std::cout << "\nPer-thread counters (" << threads << " threads x " << increments << " increments):" << std::endl;
+        std::cout << "  Packed (" << sizeof(Packed) << " bytes each): " << std::setprecision(1)
+                  << time_counters(packed) << " ms" << std::endl;
+        std::cout << "  Padded (" << sizeof(CachePadded<std::atomic<long>>) << " bytes each): "
+                  << time_counters(padded) << " ms" << std::endl;
+    }
+    
+    // A large column buffer mapped on 2 MiB boundaries with a THP hint
+    {
+        auto alloc = AlignedAllocator<double, 64>::huge_pages(16 * 1024 * 1024);
+        std::vector<double, AlignedAllocator<double, 64>> column(alloc);
+        column.resize(8 * 1024 * 1024, 1.0);   // 64 MiB
+        
+        uintptr_t addr = reinterpret_cast<uintptr_t>(column.data());
+        std::cout << "\nHuge-page column of " << column.size() * sizeof(double) / (1024 * 1024) << " MiB" << std::endl;
+        std::cout << "Mapped instead of aligned_alloc: "
+                  << (column.get_allocator().uses_huge_pages(column.capacity()) ? "Yes" : "No") << std::endl;
+        std::cout << "Starts on a 2 MiB boundary: " << (addr % HUGE_PAGE_SIZE == 0 ? "Yes" : "No") << std::endl;
+        
+        // Whether the kernel actually backed it with huge pages depends on
+        // /sys/kernel/mm/transparent_hugepage/enabled
+        std::ifstream rollup("/proc/self/smaps_rollup");
+        std::string line;
+        while (std::getline(rollup, line)) {
+            if (line.rfind("AnonHugePages:", 0) == 0) {
+                std::cout << "Process " << line << std::endl;
+            }
+        }
+    }
 }
 
-void demonstratePerformanceComparison() {
+void demonstratePerformanceComparison(const bench::Config& benchConfig) {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "  Performance Comparison" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
     
     const size_t num_operations = 100000;
     
-    auto measureTime = [](auto func) {
-        auto start = std::chrono::high_resolution_clock::now();
-        func();
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        return duration.count() / 1000.0; // Return milliseconds
-    };
+    bench::Suite suite(benchConfig);
+    auto measureTime = [&suite](const char* name, auto func) { return suite.run(name, func).median_ms(); };
     
     // Test 1: Vector with frequent push_back
-    double std_time = measureTime([&]() {
+    double std_time = measureTime("vector_push_back/std_allocator", [&]() {
         std::vector<int> vec;
         for (size_t i = 0; i < num_operations; ++i) {
             vec.push_back(static_cast<int>(i));
         }
     });
     
-    double pool_time = measureTime([&]() {
+    double pool_time = measureTime("vector_push_back/pool", [&]() {
         std::vector<int, PoolAllocator<int, 1000>> vec;
         for (size_t i = 0; i < num_operations; ++i) {
             vec.push_back(static_cast<int>(i));
@@ -476,14 +270,14 @@ void demonstratePerformanceComparison() {
     });
     
     // Test 2: List with frequent insertions
-    double std_list_time = measureTime([&]() {
+    double std_list_time = measureTime("list_push_back/std_allocator", [&]() {
         std::list<int> lst;
         for (size_t i = 0; i < num_operations / 10; ++i) { // Fewer operations for list
             lst.push_back(static_cast<int>(i));
         }
     });
     
-    double pool_list_time = measureTime([&]() {
+    double pool_list_time = measureTime("list_push_back/pool", [&]() {
         std::list<int, PoolAllocator<int, 1000>> lst;
         for (size_t i = 0; i < num_operations / 10; ++i) {
             lst.push_back(static_cast<int>(i));
@@ -538,7 +332,8 @@ void demonstrateAllocatorRebinding() {
     LoggingAllocator<int>::print_stats();
 }
 
-int main() {
+// Usage: custom_allocators [--trials=N] [--warmup=N] [--counters] (see benchmark.hpp)
+int main(int argc, char* argv[]) {
     std::cout << "===== Custom Allocators Implementation =====" << std::endl;
     std::cout << "This program demonstrates various custom allocator implementations" << std::endl;
     std::cout << "and their use cases in STL containers." << std::endl;
@@ -547,7 +342,7 @@ int main() {
     demonstratePoolAllocator();
     demonstrateStackAllocator();
     demonstrateAlignedAllocator();
-    demonstratePerformanceComparison();
+    demonstratePerformanceComparison(bench::Config::from_args(argc, argv));
     demonstrateAllocatorRebinding();
     
     std::cout << "\n" << std::string(60, '=') << std::endl;
@@ -555,7 +350,7 @@ int main() {
     std::cout << "1. Logging Allocator: Debug memory usage and detect leaks" << std::endl;
     std::cout << "2. Pool Allocator: Optimize frequent small allocations" << std::endl;
     std::cout << "3. Stack Allocator: Use stack memory for temporary containers" << std::endl;
-    std::cout << "4. Aligned Allocator: Ensure proper alignment for SIMD operations" << std::endl;
+    std::cout << "4. Aligned Allocator: SIMD alignment, cache-line padding, huge pages" << std::endl;
     std::cout << "5. Custom allocators can significantly improve performance" << std::endl;
     std::cout << "6. Always measure performance impact in your specific use case" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
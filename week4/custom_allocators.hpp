@@ -0,0 +1,711 @@
+/*
+ * Custom Allocators
+ *
+ * Allocator implementations shared by the allocator demonstrations
+ * (custom_allocators.cpp) and the allocator benchmark (allocator_benchmark.cpp):
+ * - LoggingAllocator: logs and counts every allocation
+ * - PoolAllocator: size-class pool with per-thread magazines (PoolResource)
+ * - StackAllocator: bump allocation from an inline buffer
+ * - AlignedAllocator: over-aligned storage for SIMD code, optionally on
+ *   transparent huge pages and a preferred NUMA node; CachePadded
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 1. Logging Allocator - tracks all allocations
+
+// Printing switch shared by every rebound LoggingAllocator, so one call
+// silences a container's node allocations too
+inline bool& logging_allocator_verbose() {
+    static bool enabled = true;
+    return enabled;
+}
+
+template<typename T>
+class LoggingAllocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    
+private:
+    static size_type allocation_count_;
+    static size_type deallocation_count_;
+    static size_type bytes_allocated_;
+    static size_type bytes_deallocated_;
+    
+public:
+    LoggingAllocator() = default;
+    
+    template<typename U>
+    LoggingAllocator(const LoggingAllocator<U>&) noexcept {}
+    
+    T* allocate(size_type n) {
+        size_type bytes = n * sizeof(T);
+        T* ptr = static_cast<T*>(std::malloc(bytes));
+        
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        
+        ++allocation_count_;
+        bytes_allocated_ += bytes;
+        
+        if (logging_allocator_verbose()) {
+            std::cout << "[ALLOC] " << n << " objects of " << sizeof(T) 
+                      << " bytes each = " << bytes << " bytes at " << ptr << std::endl;
+        }
+        
+        return ptr;
+    }
+    
+    void deallocate(T* ptr, size_type n) {
+        size_type bytes = n * sizeof(T);
+        
+        ++deallocation_count_;
+        bytes_deallocated_ += bytes;
+        
+        if (logging_allocator_verbose()) {
+            std::cout << "[DEALLOC] " << n << " objects = " << bytes 
+                      << " bytes at " << ptr << std::endl;
+        }
+        
+        std::free(ptr);
+    }
+    
+    template<typename U>
+    bool operator==(const LoggingAllocator<U>&) const noexcept { return true; }
+    
+    template<typename U>
+    bool operator!=(const LoggingAllocator<U>&) const noexcept { return false; }
+    
+    static void print_stats() {
+        std::cout << "\n=== Allocation Statistics ===" << std::endl;
+        std::cout << "Allocations: " << allocation_count_ << std::endl;
+        std::cout << "Deallocations: " << deallocation_count_ << std::endl;
+        std::cout << "Bytes allocated: " << bytes_allocated_ << std::endl;
+        std::cout << "Bytes deallocated: " << bytes_deallocated_ << std::endl;
+        std::cout << "Net bytes: " << (bytes_allocated_ - bytes_deallocated_) << std::endl;
+        std::cout << "=============================" << std::endl;
+    }
+    
+    // Keep counting but stop printing (e.g. for benchmarks)
+    static void set_verbose(bool enabled) { logging_allocator_verbose() = enabled; }
+    static size_type allocation_count() { return allocation_count_; }
+    
+    static void reset_stats() {
+        allocation_count_ = 0;
+        deallocation_count_ = 0;
+        bytes_allocated_ = 0;
+        bytes_deallocated_ = 0;
+    }
+};
+
+// Static member definitions
+template<typename T>
+typename LoggingAllocator<T>::size_type LoggingAllocator<T>::allocation_count_ = 0;
+
+template<typename T>
+typename LoggingAllocator<T>::size_type LoggingAllocator<T>::deallocation_count_ = 0;
+
+template<typename T>
+typename LoggingAllocator<T>::size_type LoggingAllocator<T>::bytes_allocated_ = 0;
+
+template<typename T>
+typename LoggingAllocator<T>::size_type LoggingAllocator<T>::bytes_deallocated_ = 0;
+
+// 2. Memory Pool Allocator
+//
+// PoolResource hands out fixed-size blocks from size classes of 16 to 256
+// bytes, carved out of large chunks. A free block stores the pointer to the
+// next free block in its own first word (an intrusive free list), and free
+// lists are grouped into magazines of up to MAGAZINE_SIZE blocks. Every
+// thread keeps two magazines per size class, so almost all allocations and
+// frees touch no lock; full and empty magazines are swapped with a per-class
+// depot under a mutex, which is also how blocks freed on one thread get back
+// to the others. Bigger or over-aligned requests go to operator new.
+class PoolResource {
+public:
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAX_POOLED = 256;
+    static constexpr size_t CLASS_COUNT = MAX_POOLED / GRANULE;
+    static constexpr size_t MAGAZINE_SIZE = 64;
+    
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    
+    struct Magazine {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+        
+        void push(void* ptr) {
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->next = head;
+            head = block;
+            ++count;
+        }
+        
+        void* pop() {
+            FreeBlock* block = head;
+            head = block->next;
+            --count;
+            return block;
+        }
+    };
+    
+    // The part thread caches refer to. It outlives the resource while any
+    // thread still has a cache entry for it; the chunks themselves do not.
+    struct State {
+        struct Depot {
+            std::mutex mutex;
+            std::vector<Magazine> magazines;   // all non-empty
+        };
+        
+        std::array<Depot, CLASS_COUNT> depots;
+        std::atomic<bool> retired{false};
+    };
+    
+    struct ThreadCache {
+        struct Entry {
+            std::shared_ptr<State> state;
+            std::array<Magazine, CLASS_COUNT> loaded;
+            std::array<Magazine, CLASS_COUNT> previous;
+        };
+        
+        std::vector<std::unique_ptr<Entry>> entries;
+        Entry* last = nullptr;
+        
+        Entry& find(const std::shared_ptr<State>& state) {
+            if (last && last->state == state) {
+                return *last;
+            }
+            for (auto& entry : entries) {
+                if (entry->state == state) {
+                    last = entry.get();
+                    return *last;
+                }
+            }
+            // New pool on this thread: forget pools that have gone away
+            entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                         [](const std::unique_ptr<Entry>& entry) {
+                                             return entry->state->retired.load(std::memory_order_acquire);
+                                         }),
+                          entries.end());
+            entries.push_back(std::make_unique<Entry>());
+            entries.back()->state = state;
+            last = entries.back().get();
+            return *last;
+        }
+        
+        // Thread exit: hand cached blocks to the depots for other threads
+        ~ThreadCache() {
+            for (auto& entry : entries) {
+                if (entry->state->retired.load(std::memory_order_acquire)) {
+                    continue;
+                }
+                for (size_t size_class = 0; size_class < CLASS_COUNT; ++size_class) {
+                    give_back(*entry->state, size_class, entry->loaded[size_class]);
+                    give_back(*entry->state, size_class, entry->previous[size_class]);
+                }
+            }
+            alive() = false;
+        }
+        
+        // Trivially destructible, so still readable after the cache is gone
+        static bool& alive() {
+            thread_local bool flag = true;
+            return flag;
+        }
+    };
+    
+    std::shared_ptr<State> state_;
+    size_t blocks_per_chunk_;
+    std::mutex chunk_mutex_;
+    std::vector<void*> chunks_;
+    std::atomic<size_t> reserved_bytes_{0};
+    std::atomic<size_t> unpooled_allocations_{0};
+    
+    static ThreadCache* thread_cache() {
+        thread_local ThreadCache cache;
+        return ThreadCache::alive() ? &cache : nullptr;
+    }
+    
+    static size_t block_size(size_t size_class) {
+        return (size_class + 1) * GRANULE;
+    }
+    
+    static void give_back(State& state, size_t size_class, Magazine& magazine) {
+        if (magazine.count == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(state.depots[size_class].mutex);
+        state.depots[size_class].magazines.push_back(magazine);
+        magazine = Magazine();
+    }
+    
+    // Fill an empty magazine from the depot, or from a new chunk
+    void refill(size_t size_class, Magazine& magazine) {
+        State::Depot& depot = state_->depots[size_class];
+        {
+            std::lock_guard<std::mutex> lock(depot.mutex);
+            if (!depot.magazines.empty()) {
+                magazine = depot.magazines.back();
+                depot.magazines.pop_back();
+                return;
+            }
+        }
+        
+        size_t size = block_size(size_class);
+        size_t bytes = blocks_per_chunk_ * size;
+        char* chunk = static_cast<char*>(::operator new(bytes));
+        {
+            std::lock_guard<std::mutex> lock(chunk_mutex_);
+            chunks_.push_back(chunk);
+        }
+        reserved_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        
+        // The first magazine's worth stays with this thread, the rest is shared
+        Magazine spare;
+        std::lock_guard<std::mutex> lock(depot.mutex);
+        for (size_t i = blocks_per_chunk_; i-- > 0;) {
+            Magazine& target = magazine.count < MAGAZINE_SIZE ? magazine : spare;
+            target.push(chunk + i * size);
+            if (spare.count == MAGAZINE_SIZE) {
+                depot.magazines.push_back(spare);
+                spare = Magazine();
+            }
+        }
+        if (spare.count > 0) {
+            depot.magazines.push_back(spare);
+        }
+    }
+    
+    static bool pooled(size_t bytes, size_t alignment) {
+        return bytes <= MAX_POOLED && alignment <= GRANULE;
+    }
+    
+public:
+    explicit PoolResource(size_t blocks_per_chunk = 1024)
+        : state_(std::make_shared<State>()), blocks_per_chunk_(std::max(blocks_per_chunk, MAGAZINE_SIZE)) {}
+        
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+    
+    // Blocks still cached by threads belong to the chunks, so they are
+    // released here too; the caches notice the retired flag and drop them
+    ~PoolResource() {
+        state_->retired.store(true, std::memory_order_release);
+        for (void* chunk : chunks_) {
+            ::operator delete(chunk);
+        }
+    }
+    
+    void* allocate(size_t bytes, size_t alignment) {
+        if (!pooled(bytes, alignment)) {
+            unpooled_allocations_.fetch_add(1, std::memory_order_relaxed);
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return ::operator new(bytes, std::align_val_t(alignment));
+            }
+            return ::operator new(bytes);
+        }
+        
+        size_t size_class = bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+        ThreadCache* cache = thread_cache();
+        if (!cache) {
+            // Called during thread teardown: go straight to the depot
+            Magazine magazine;
+            refill(size_class, magazine);
+            void* ptr = magazine.pop();
+            give_back(*state_, size_class, magazine);
+            return ptr;
+        }
+        
+        ThreadCache::Entry& entry = cache->find(state_);
+        Magazine& loaded = entry.loaded[size_class];
+        if (loaded.count == 0) {
+            if (entry.previous[size_class].count > 0) {
+                std::swap(loaded, entry.previous[size_class]);
+            } else {
+                refill(size_class, loaded);
+            }
+        }
+        return loaded.pop();
+    }
+    
+    void deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+        if (!pooled(bytes, alignment)) {
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(ptr, std::align_val_t(alignment));
+            } else {
+                ::operator delete(ptr);
+            }
+            return;
+        }
+        
+        size_t size_class = bytes == 0 ? 0 : (bytes - 1) / GRANULE;
+        ThreadCache* cache = thread_cache();
+        if (!cache) {
+            Magazine magazine;
+            magazine.push(ptr);
+            give_back(*state_, size_class, magazine);
+            return;
+        }
+        
+        ThreadCache::Entry& entry = cache->find(state_);
+        Magazine& loaded = entry.loaded[size_class];
+        if (loaded.count == MAGAZINE_SIZE) {
+            Magazine& previous = entry.previous[size_class];
+            if (previous.count == 0) {
+                std::swap(loaded, previous);
+            } else {
+                give_back(*state_, size_class, loaded);
+            }
+        }
+        loaded.push(ptr);
+    }
+    
+    size_t chunk_count() {
+        std::lock_guard<std::mutex> lock(chunk_mutex_);
+        return chunks_.size();
+    }
+    
+    size_t reserved_bytes() const { return reserved_bytes_.load(std::memory_order_relaxed); }
+    size_t unpooled_allocations() const { return unpooled_allocations_.load(std::memory_order_relaxed); }
+};
+
+// One process-wide pool per chunk size, used by default-constructed allocators
+template<size_t BlockSize>
+const std::shared_ptr<PoolResource>& default_pool_resource() {
+    static const std::shared_ptr<PoolResource> resource = std::make_shared<PoolResource>(BlockSize);
+    return resource;
+}
+
+// Standard allocator over a shared PoolResource. Copies and rebinds share
+// the pool and compare equal, so containers on the same pool move and swap
+// by stealing nodes; the pool travels with the container on assignment.
+template<typename T, size_t BlockSize = 1024>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+    
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U, BlockSize>;
+    };
+    
+private:
+    template<typename U, size_t B>
+    friend class PoolAllocator;
+    
+    std::shared_ptr<PoolResource> resource_;
+    
+public:
+    PoolAllocator() : resource_(default_pool_resource<BlockSize>()) {}
+    
+    explicit PoolAllocator(std::shared_ptr<PoolResource> resource) : resource_(std::move(resource)) {}
+    
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U, BlockSize>& other) noexcept 
+        : resource_(other.resource_) {}
+        
+    T* allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+    }
+    
+    void deallocate(T* ptr, size_type n) noexcept {
+        resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+    
+    template<typename U>
+    bool operator==(const PoolAllocator<U, BlockSize>& other) const noexcept { return resource_ == other.resource_; }
+    
+    template<typename U>
+    bool operator!=(const PoolAllocator<U, BlockSize>& other) const noexcept { return resource_ != other.resource_; }
+    
+    PoolResource& resource() const { return *resource_; }
+    size_type get_block_count() const { return resource_->chunk_count(); }
+    
+    void print_stats() const {
+        std::cout << "Pool Allocator Stats:" << std::endl;
+        std::cout << "  Chunks: " << resource_->chunk_count() << std::endl;
+        std::cout << "  Memory reserved: " << resource_->reserved_bytes() << " bytes" << std::endl;
+        std::cout << "  Unpooled allocations: " << resource_->unpooled_allocations() << std::endl;
+    }
+};
+
+// 3. Stack Allocator (uses pre-allocated buffer)
+template<typename T, size_t N>
+class StackAllocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    
+    template<typename U>
+    struct rebind {
+        using other = StackAllocator<U, N>;
+    };
+    
+private:
+    alignas(T) mutable char buffer_[N * sizeof(T)];
+    mutable size_type used_;
+    
+public:
+    StackAllocator() : used_(0) {}
+    
+    template<typename U>
+    StackAllocator(const StackAllocator<U, N>&) noexcept : used_(0) {}
+    
+    T* allocate(size_type n) {
+        if (used_ + n > N) {
+            throw std::bad_alloc();
+        }
+        
+        T* ptr = reinterpret_cast<T*>(buffer_ + used_ * sizeof(T));
+        used_ += n;
+        return ptr;
+    }
+    
+    void deallocate(T* ptr, size_type n) {
+        // Stack allocator doesn't support individual deallocation
+        // Only supports LIFO deallocation pattern
+        if (ptr + n == reinterpret_cast<T*>(buffer_ + used_ * sizeof(T))) {
+            used_ -= n;
+        }
+    }
+    
+    template<typename U>
+    bool operator==(const StackAllocator<U, N>&) const noexcept { return false; }
+    
+    template<typename U>
+    bool operator!=(const StackAllocator<U, N>&) const noexcept { return true; }
+    
+    size_type capacity() const { return N; }
+    size_type size() const { return used_; }
+    size_type available() const { return N - used_; }
+    
+    void reset() { used_ = 0; }
+    
+    void print_stats() const {
+        std::cout << "Stack Allocator Stats:" << std::endl;
+        std::cout << "  Capacity: " << N << " objects" << std::endl;
+        std::cout << "  Used: " << used_ << " objects" << std::endl;
+        std::cout << "  Available: " << available() << " objects" << std::endl;
+        std::cout << "  Usage: " << std::fixed << std::setprecision(1) 
+                  << (100.0 * used_ / N) << "%" << std::endl;
+    }
+};
+
+// 4. Aligned Allocator (for SIMD operations)
+//
+// Every block starts on an Alignment boundary and is padded to a multiple of
+// it, so with Alignment = CACHE_LINE_SIZE two buffers never share a line.
+// Large blocks can instead be mapped on 2 MiB boundaries and advised for
+// transparent huge pages, which cuts TLB misses on big column buffers, and
+// their pages can be preferred on one NUMA node.
+inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+inline constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Gives a value a cache line of its own, e.g. per-thread counters that would
+// otherwise false-share
+template<typename T>
+struct alignas(CACHE_LINE_SIZE) CachePadded {
+    T value{};
+};
+
+struct AlignedAllocatorOptions {
+    // Blocks of at least this many bytes are mapped on huge-page boundaries;
+    // the default keeps everything on aligned_alloc
+    std::size_t huge_page_threshold = std::numeric_limits<std::size_t>::max();
+    // Preferred node for the pages of mapped blocks, -1 for the default policy
+    int numa_node = -1;
+    // Fault mapped blocks in on the allocating thread (first-touch placement)
+    bool prefault = false;
+    
+    bool operator==(const AlignedAllocatorOptions& other) const noexcept {
+        return huge_page_threshold == other.huge_page_threshold &&
+               numa_node == other.numa_node && prefault == other.prefault;
+    }
+};
+
+namespace aligned_detail {
+    inline std::size_t round_up(std::size_t bytes, std::size_t multiple) {
+        if (bytes > std::numeric_limits<std::size_t>::max() - (multiple - 1)) {
+            throw std::bad_alloc();
+        }
+        return (bytes + multiple - 1) & ~(multiple - 1);
+    }
+    
+    // bytes is a multiple of HUGE_PAGE_SIZE
+    inline void* map_huge(std::size_t bytes, const AlignedAllocatorOptions& options) {
+#if defined(__linux__)
+        // Over-map by one huge page, then trim both ends to a 2 MiB boundary
+        std::size_t span = bytes + HUGE_PAGE_SIZE;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* start = static_cast<char*>(raw);
+        char* aligned = reinterpret_cast<char*>(
+            round_up(reinterpret_cast<std::uintptr_t>(start), HUGE_PAGE_SIZE));
+        if (aligned > start) {
+            munmap(start, static_cast<std::size_t>(aligned - start));
+        }
+        std::size_t tail = static_cast<std::size_t>(start + span - (aligned + bytes));
+        if (tail) {
+            munmap(aligned + bytes, tail);
+        }
+        
+        // Both are hints: THP may be disabled and the node may not exist
+        madvise(aligned, bytes, MADV_HUGEPAGE);
+        if (options.numa_node >= 0 && options.numa_node < 64) {
+            constexpr int MPOL_PREFERRED_MODE = 1;
+            unsigned long nodes = 1UL << options.numa_node;
+            // The kernel reads maxnode - 1 bits of the mask
+            syscall(SYS_mbind, aligned, bytes, MPOL_PREFERRED_MODE, &nodes, sizeof(nodes) * 8 + 1, 0);
+        }
+        if (options.prefault) {
+            long page = sysconf(_SC_PAGESIZE);
+            for (std::size_t offset = 0; offset < bytes; offset += static_cast<std::size_t>(page)) {
+                aligned[offset] = 0;
+            }
+        }
+        return aligned;
+#else
+        (void)options;
+        void* ptr = std::aligned_alloc(HUGE_PAGE_SIZE, bytes);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+#endif
+    }
+    
+    inline void unmap_huge(void* ptr, std::size_t bytes) {
+#if defined(__linux__)
+        munmap(ptr, bytes);
+#else
+        (void)bytes;
+        std::free(ptr);
+#endif
+    }
+}
+
+template<typename T, size_t Alignment = 32>
+class AlignedAllocator {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+    
+    static_assert(Alignment >= alignof(T), "Alignment must be at least alignof(T)");
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be power of 2");
+    
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+    
+private:
+    AlignedAllocatorOptions options_;
+    
+public:
+    AlignedAllocator() = default;
+    
+    explicit AlignedAllocator(const AlignedAllocatorOptions& options) noexcept : options_(options) {}
+    
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& other) noexcept : options_(other.options()) {}
+    
+    // Blocks of at least threshold bytes go on huge pages, optionally on one node
+    static AlignedAllocator huge_pages(size_type threshold = HUGE_PAGE_SIZE, int numa_node = -1) {
+        AlignedAllocatorOptions options;
+        options.huge_page_threshold = threshold;
+        options.numa_node = numa_node;
+        options.prefault = numa_node >= 0;
+        return AlignedAllocator(options);
+    }
+    
+    T* allocate(size_type n) {
+        if (n > std::numeric_limits<size_type>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        size_type bytes = n * sizeof(T);
+        
+        if (uses_huge_pages(n)) {
+            return static_cast<T*>(aligned_detail::map_huge(
+                aligned_detail::round_up(bytes, HUGE_PAGE_SIZE), options_));
+        }
+        
+        // aligned_alloc requires the size to be a multiple of the alignment
+        void* ptr = std::aligned_alloc(Alignment, aligned_detail::round_up(std::max<size_type>(bytes, 1), Alignment));
+        
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        
+        return static_cast<T*>(ptr);
+    }
+    
+    void deallocate(T* ptr, size_type n) {
+        if (uses_huge_pages(n)) {
+            aligned_detail::unmap_huge(ptr, aligned_detail::round_up(n * sizeof(T), HUGE_PAGE_SIZE));
+        } else {
+            std::free(ptr);
+        }
+    }
+    
+    bool uses_huge_pages(size_type n) const noexcept {
+        return n * sizeof(T) >= options_.huge_page_threshold;
+    }
+    
+    const AlignedAllocatorOptions& options() const noexcept { return options_; }
+    
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>& other) const noexcept { return options_ == other.options(); }
+    
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>& other) const noexcept { return !(*this == other); }
+    
+    static constexpr size_type alignment() { return Alignment; }
+};
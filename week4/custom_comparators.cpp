@@ -22,6 +22,12 @@
 #include <functional>
 #include <string>
 #include <iomanip>
+#include <chrono>
+#include <string_view>
+#include "benchmark.hpp"
+#include "flat_hash_map.hpp"
+#include "flat_map.hpp"
+#include "btree_map.hpp"
 
 // Example class for demonstration
 struct Person {
@@ -106,22 +112,26 @@ struct PersonAdvancedHasher {
 };
 
 // 3. Generic Comparator Factory
+// Transparent: ordered containers keyed on T can also be searched by a bare
+// member value, e.g. byAge.lower_bound(30)
 template<typename T, typename MemberType>
 class MemberComparator {
 private:
     MemberType T::*member;
     bool ascending;
     
+    bool less(const MemberType& a, const MemberType& b) const {
+        return ascending ? a < b : b < a;
+    }
+    
 public:
+    using is_transparent = void;
+    
     MemberComparator(MemberType T::*m, bool asc = true) : member(m), ascending(asc) {}
     
-    bool operator()(const T& a, const T& b) const {
-        if (ascending) {
-            return a.*member < b.*member;
-        } else {
-            return a.*member > b.*member;
-        }
-    }
+    bool operator()(const T& a, const T& b) const { return less(a.*member, b.*member); }
+    bool operator()(const T& a, const MemberType& b) const { return less(a.*member, b); }
+    bool operator()(const MemberType& a, const T& b) const { return less(a, b.*member); }
 };
 
 // Helper function to create member comparators
@@ -274,6 +284,24 @@ void demonstrateSetWithComparators() {
     for (const auto& person : peopleBySalary) {
         person.print();
     }
+    
+    // The same comparators drive the cache-friendly ordered containers
+    flat_set<Person, PersonMultiComparator> flatMulti(people.begin(), people.end());
+    btree_set<Person, MemberComparator<Person, int>> treeByAge(make_member_comparator(&Person::age));
+    for (const auto& person : people) {
+        treeByAge.insert(person);
+    }
+    
+    std::cout << "\nflat_set ordered by department, salary (desc), age:" << std::endl;
+    for (const auto& person : flatMulti) {
+        person.print();
+    }
+    
+    // MemberComparator is transparent, so the range bounds are plain ages
+    std::cout << "\nbtree_set range scan, ages in [28, 33):" << std::endl;
+    for (const auto& person : treeByAge.range(28, 33)) {
+        person.print();
+    }
 }
 
 void demonstrateHashFunctions() {
@@ -362,9 +390,24 @@ void demonstrateUnorderedMapWithCustomHash() {
     } else {
         std::cout << "Person not found!" << std::endl;
     }
+    
+    // The same hasher and operator== plug into the flat open-addressing map
+    flat_hash_map<Person, std::string, PersonAdvancedHasher> flatRoles(personRoles.begin(), personRoles.end());
+    std::cout << "\nflat_hash_map with PersonAdvancedHasher: " << flatRoles.size() << " entries, "
+              << lookupPerson.name << " -> " << flatRoles.at(lookupPerson) << std::endl;
+    
+    // Department lookup table keyed by std::string, probed with string_view
+    string_flat_hash_map<int> headcount;
+    for (const auto& person : people) {
+        ++headcount[person.department];
+    }
+    headcount.freeze();
+    std::string_view department = "Engineering";
+    std::cout << department << " headcount (string_view lookup, frozen table): "
+              << headcount.at(department) << std::endl;
 }
 
-void demonstratePerformanceComparison() {
+void demonstratePerformanceComparison(const bench::Config& benchConfig) {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "  Performance Comparison: Function Objects vs Lambdas" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
@@ -385,36 +428,28 @@ void demonstratePerformanceComparison() {
         );
     }
     
-    auto measureTime = [](auto func) {
-        auto start = std::chrono::high_resolution_clock::now();
-        func();
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        return duration.count() / 1000.0; // Return milliseconds
+    // Each trial sorts a fresh copy: sorting already sorted input would
+    // flatter every variant after the first trial
+    bench::Suite suite(benchConfig);
+    std::vector<Person> scratch;
+    auto measureSort = [&](const char* name, auto comparator) {
+        return suite.run_with_setup(name, [&]() { scratch = people; }, [&]() {
+            std::sort(scratch.begin(), scratch.end(), comparator);
+        }).median_ms();
     };
     
     // Test function object
-    auto people1 = people;
-    double funcObjTime = measureTime([&]() {
-        std::sort(people1.begin(), people1.end(), PersonAgeComparator{});
-    });
+    double funcObjTime = measureSort("sort/function_object", PersonAgeComparator{});
     
     // Test lambda
-    auto people2 = people;
-    double lambdaTime = measureTime([&]() {
-        std::sort(people2.begin(), people2.end(), 
-                  [](const Person& a, const Person& b) { return a.age < b.age; });
-    });
+    double lambdaTime = measureSort("sort/lambda",
+                                    [](const Person& a, const Person& b) { return a.age < b.age; });
     
     // Test generic comparator
-    auto people3 = people;
-    double genericTime = measureTime([&]() {
-        std::sort(people3.begin(), people3.end(), 
-                  make_member_comparator(&Person::age));
-    });
+    double genericTime = measureSort("sort/member_comparator", make_member_comparator(&Person::age));
     
     std::cout << std::fixed << std::setprecision(3);
-    std::cout << "Sorting " << size << " Person objects by age:" << std::endl;
+    std::cout << "Sorting " << size << " Person objects by age (median of " << benchConfig.trials << " trials):" << std::endl;
     std::cout << "Function Object: " << funcObjTime << " ms" << std::endl;
     std::cout << "Lambda:          " << lambdaTime << " ms" << std::endl;
     std::cout << "Generic:         " << genericTime << " ms" << std::endl;
@@ -423,7 +458,8 @@ void demonstratePerformanceComparison() {
     std::cout << "Choose based on readability and maintainability requirements." << std::endl;
 }
 
-int main() {
+// Usage: custom_comparators [--trials=N] [--warmup=N] [--counters] (see benchmark.hpp)
+int main(int argc, char* argv[]) {
     std::cout << "===== Custom Comparators and Hash Functions =====" << std::endl;
     std::cout << "This program demonstrates various ways to customize sorting and hashing" << std::endl;
     std::cout << "behavior for user-defined types in STL containers." << std::endl;
@@ -433,7 +469,7 @@ int main() {
     demonstrateSetWithComparators();
     demonstrateHashFunctions();
     demonstrateUnorderedMapWithCustomHash();
-    demonstratePerformanceComparison();
+    demonstratePerformanceComparison(bench::Config::from_args(argc, argv));
     
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "Key Takeaways:" << std::endl;
@@ -13,24 +13,46 @@
  */
 
 #include <iostream>
+#include <string>
 #include <vector>
 #include <algorithm>
+#include <numeric>
 #include <iterator>
 #include <memory>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include "benchmark.hpp"
+#include "range_adaptors.hpp"
 
 // Forward declarations
-template<typename T> class SimpleVector;
+template<typename T, size_t N = 8> class SimpleVector;
 template<typename T> class SimpleVectorIterator;
 template<typename T> class RangeIterator;
 
-// 1. Simple Vector with Custom Iterator
+// Types whose objects can be moved to new storage with memcpy, the old bytes
+// then simply forgotten instead of destroyed. Trivially copyable types
+// always qualify; specialize for other types that do (most types that hold
+// no pointers into themselves)
 template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// 1. Simple Vector with Custom Iterator
+// A small vector: the first N elements live inside the object, so short
+// sequences (records with a handful of fields) never allocate. Larger ones
+// move to malloc'd storage. Trivially copyable elements are copied with
+// memcpy, and trivially relocatable ones grow in place with realloc
+template<typename T, size_t N>
 class SimpleVector {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "heap storage comes from malloc/realloc");
+    
 private:
-    std::unique_ptr<T[]> data_;
+    T* data_;
     size_t size_;
     size_t capacity_;
+    alignas(T) unsigned char inline_[N > 0 ? N * sizeof(T) : 1];
     
 public:
     using value_type = T;
@@ -43,81 +65,249 @@ public:
     using iterator = SimpleVectorIterator<T>;
     using const_iterator = SimpleVectorIterator<const T>;
     
-    SimpleVector() : data_(nullptr), size_(0), capacity_(0) {}
+    static constexpr size_t inline_capacity = N;
     
-    explicit SimpleVector(size_t capacity) 
-        : data_(std::make_unique<T[]>(capacity)), size_(0), capacity_(capacity) {}
+    SimpleVector() : data_(inline_data()), size_(0), capacity_(N) {}
     
-    ~SimpleVector() = default;
+    // Reserves capacity; the vector starts empty
+    explicit SimpleVector(size_t capacity) : SimpleVector() { reserve(capacity); }
     
-    // Move constructor and assignment
-    SimpleVector(SimpleVector&& other) noexcept
-        : data_(std::move(other.data_)), size_(other.size_), capacity_(other.capacity_) {
-        other.size_ = 0;
-        other.capacity_ = 0;
+    SimpleVector(std::initializer_list<T> values) : SimpleVector() {
+        append_copy(values.begin(), values.size());
+    }
+    
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    SimpleVector(InputIt first, InputIt last) : SimpleVector() { append(first, last); }
+    
+    ~SimpleVector() {
+        std::destroy(data_, data_ + size_);
+        release();
     }
     
-    SimpleVector& operator=(SimpleVector&& other) noexcept {
+    SimpleVector(const SimpleVector& other) : SimpleVector() { append_copy(other.data_, other.size_); }
+    
+    SimpleVector& operator=(const SimpleVector& other) {
         if (this != &other) {
-            data_ = std::move(other.data_);
-            size_ = other.size_;
-            capacity_ = other.capacity_;
-            other.size_ = 0;
-            other.capacity_ = 0;
+            clear();
+            append_copy(other.data_, other.size_);
         }
         return *this;
     }
     
-    // Disable copy for simplicity
-    SimpleVector(const SimpleVector&) = delete;
-    SimpleVector& operator=(const SimpleVector&) = delete;
+    // A heap buffer changes owner; inline elements have to be relocated
+    SimpleVector(SimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) : SimpleVector() { take(std::move(other)); }
     
-    void push_back(const T& value) {
-        if (size_ >= capacity_) {
-            resize(capacity_ == 0 ? 1 : capacity_ * 2);
+    SimpleVector& operator=(SimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            clear();
+            release();
+            data_ = inline_data();
+            capacity_ = N;
+            take(std::move(other));
         }
-        data_[size_++] = value;
+        return *this;
     }
     
-    void push_back(T&& value) {
-        if (size_ >= capacity_) {
-            resize(capacity_ == 0 ? 1 : capacity_ * 2);
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // Build first: args may refer to an element about to move
+            T value(std::forward<Args>(args)...);
+            reallocate(grown_capacity(size_ + 1));
+            return *::new (static_cast<void*>(data_ + size_++)) T(std::move(value));
+        }
+        return *::new (static_cast<void*>(data_ + size_++)) T(std::forward<Args>(args)...);
+    }
+    
+    void pop_back() { data_[--size_].~T(); }
+    
+    template<typename InputIt>
+    void append(InputIt first, InputIt last) {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_pointer_v<InputIt> ||
+                      std::is_same_v<InputIt, iterator> || std::is_same_v<InputIt, const_iterator>) {
+            const T* source = nullptr;
+            if constexpr (std::is_pointer_v<InputIt>) {
+                source = first;
+            } else {
+                source = first.operator->();
+            }
+            append_copy(source, static_cast<size_t>(last - first));
+        } else if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+            size_t count = static_cast<size_t>(std::distance(first, last));
+            if (size_ + count > capacity_) {
+                // Copy into the new buffer before the old one goes: the
+                // range may point into this vector
+                SimpleVector grown(grown_capacity(size_ + count));
+                std::uninitialized_copy(first, last, grown.data_ + size_);
+                try {
+                    relocate(data_, size_, grown.data_);
+                } catch (...) {
+                    std::destroy(grown.data_ + size_, grown.data_ + size_ + count);
+                    throw;
+                }
+                grown.size_ = size_ + count;
+                size_ = 0;
+                *this = std::move(grown);
+                return;
+            }
+            std::uninitialized_copy(first, last, data_ + size_);
+            size_ += count;
+        } else {
+            for (; first != last; ++first) {
+                emplace_back(*first);
+            }
         }
-        data_[size_++] = std::move(value);
+    }
+    
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            reallocate(capacity);
+        }
+    }
+    
+    // Grows with value-initialized elements or shrinks from the back
+    void resize(size_t count) {
+        if (count < size_) {
+            std::destroy(data_ + count, data_ + size_);
+        } else if (count > size_) {
+            reserve(count);
+            std::uninitialized_value_construct(data_ + size_, data_ + count);
+        }
+        size_ = count;
+    }
+    
+    void clear() noexcept {
+        std::destroy(data_, data_ + size_);
+        size_ = 0;
     }
     
     T& operator[](size_t index) { return data_[index]; }
     const T& operator[](size_t index) const { return data_[index]; }
     
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
     size_t size() const { return size_; }
     size_t capacity() const { return capacity_; }
     bool empty() const { return size_ == 0; }
     
+    // True while the elements still fit in the inline buffer
+    bool is_inline() const noexcept { return data_ == inline_data(); }
+    
     // Iterator interface
-    iterator begin() { return iterator(data_.get()); }
-    iterator end() { return iterator(data_.get() + size_); }
-    const_iterator begin() const { return const_iterator(data_.get()); }
-    const_iterator end() const { return const_iterator(data_.get() + size_); }
-    const_iterator cbegin() const { return const_iterator(data_.get()); }
-    const_iterator cend() const { return const_iterator(data_.get() + size_); }
+    iterator begin() { return iterator(data_); }
+    iterator end() { return iterator(data_ + size_); }
+    const_iterator begin() const { return const_iterator(data_); }
+    const_iterator end() const { return const_iterator(data_ + size_); }
+    const_iterator cbegin() const { return const_iterator(data_); }
+    const_iterator cend() const { return const_iterator(data_ + size_); }
     
 private:
-    void resize(size_t new_capacity) {
-        auto new_data = std::make_unique<T[]>(new_capacity);
-        for (size_t i = 0; i < size_; ++i) {
-            new_data[i] = std::move(data_[i]);
+    T* inline_data() noexcept { return reinterpret_cast<T*>(inline_); }
+    const T* inline_data() const noexcept { return reinterpret_cast<const T*>(inline_); }
+    
+    size_t grown_capacity(size_t required) const {
+        size_t doubled = capacity_ == 0 ? 1 : capacity_ * 2;
+        return doubled < required ? required : doubled;
+    }
+    
+    void release() noexcept {
+        if (!is_inline()) {
+            std::free(data_);
+        }
+    }
+    
+    // Copies count elements from storage that is not our own spare capacity
+    void append_copy(const T* source, size_t count) {
+        if (size_ + count > capacity_) {
+            if (source >= data_ && source < data_ + size_) {
+                SimpleVector copy(source, source + count);
+                append_copy(copy.data_, count);
+                return;
+            }
+            reallocate(grown_capacity(size_ + count));
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(data_ + size_), source, count * sizeof(T));
+            }
+        } else {
+            std::uninitialized_copy(source, source + count, data_ + size_);
+        }
+        size_ += count;
+    }
+    
+    // Moves count elements from source into uninitialized target and ends
+    // the source objects' lifetimes
+    static void relocate(T* source, size_t count, T* target) {
+        if constexpr (is_trivially_relocatable<T>::value) {
+            if (count > 0) {
+                std::memcpy(static_cast<void*>(target), static_cast<const void*>(source), count * sizeof(T));
+            }
+        } else {
+            std::uninitialized_move(source, source + count, target);
+            std::destroy(source, source + count);
+        }
+    }
+    
+    void take(SimpleVector&& other) {
+        if (other.is_inline()) {
+            relocate(other.data_, other.size_, data_);
+        } else {
+            data_ = other.data_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inline_data();
+            other.capacity_ = N;
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+    }
+    
+    void reallocate(size_t new_capacity) {
+        if constexpr (is_trivially_relocatable<T>::value) {
+            if (!is_inline()) {
+                void* grown = std::realloc(data_, new_capacity * sizeof(T));
+                if (!grown) {
+                    throw std::bad_alloc();
+                }
+                data_ = static_cast<T*>(grown);
+                capacity_ = new_capacity;
+                return;
+            }
+        }
+        
+        T* fresh = static_cast<T*>(std::malloc(new_capacity * sizeof(T)));
+        if (!fresh) {
+            throw std::bad_alloc();
         }
-        data_ = std::move(new_data);
+        try {
+            relocate(data_, size_, fresh);
+        } catch (...) {
+            std::free(fresh);
+            throw;
+        }
+        release();
+        data_ = fresh;
         capacity_ = new_capacity;
     }
 };
 
 // 2. Random Access Iterator Implementation
+// The elements are contiguous, which C++20 can express: ranges algorithms
+// then see through the iterator to the pointer (std::to_address uses
+// operator->) and lower copies of trivially copyable types to memmove
 template<typename T>
 class SimpleVectorIterator {
 public:
     using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus >= 202002L
+    using iterator_concept = std::contiguous_iterator_tag;
+#endif
     using value_type = std::remove_cv_t<T>;
+    using element_type = T;
     using difference_type = ptrdiff_t;
     using pointer = T*;
     using reference = T&;
@@ -126,6 +316,7 @@ private:
     pointer ptr_;
     
 public:
+    SimpleVectorIterator() : ptr_(nullptr) {}
     explicit SimpleVectorIterator(pointer ptr) : ptr_(ptr) {}
     
     // Copy constructor and assignment
@@ -320,7 +511,7 @@ void demonstrateSimpleVector() {
     
     // Transform
     SimpleVector<int> doubled(vec.size());
-    std::transform(vec.begin(), vec.end(), doubled.begin(), 
+    std::transform(vec.begin(), vec.end(), std::back_inserter(doubled), 
                    [](int x) { return x * 2; });
     
     std::cout << "Doubled values: ";
@@ -336,6 +527,18 @@ void demonstrateSimpleVector() {
         std::cout << value << " ";
     }
     std::cout << std::endl;
+    
+    // Small-buffer storage: a short record stays inside the object
+    SimpleVector<std::string> fields = {"id", "name", "age", "salary", "department"};
+    std::cout << "\nRecord with " << fields.size() << " fields: "
+              << (fields.is_inline() ? "inline" : "heap") << " storage (inline capacity "
+              << SimpleVector<std::string>::inline_capacity << ")" << std::endl;
+    for (int i = 0; i < 4; ++i) {
+        fields.push_back("extra_" + std::to_string(i));
+    }
+    std::cout << "After growing to " << fields.size() << " fields: "
+              << (fields.is_inline() ? "inline" : "heap") << " storage, capacity "
+              << fields.capacity() << std::endl;
 }
 
 void demonstrateRangeIterator() {
@@ -457,10 +660,9 @@ void demonstrateTransformIterator() {
     std::cout << "Sum of squares: " << sum_of_squares << std::endl;
     
     // Combine transform and filter
-    auto even_squares_begin = make_filter_iterator(square_begin, square_end, 
-                                                   [](int x) { return x % 2 == 0; });
-    auto even_squares_end = make_filter_iterator(square_end, square_end, 
-                                                 [](int x) { return x % 2 == 0; });
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto even_squares_begin = make_filter_iterator(square_begin, square_end, is_even);
+    auto even_squares_end = make_filter_iterator(square_end, square_end, is_even);
     
     std::cout << "Even squares: ";
     for (auto it = even_squares_begin; it != even_squares_end; ++it) {
@@ -469,6 +671,92 @@ void demonstrateTransformIterator() {
     std::cout << std::endl;
 }
 
+void demonstrateRangeAdaptors(const bench::Config& benchConfig) {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "  Lazy Range Adaptors" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    using namespace lazy;
+    
+    std::vector<int> numbers = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto square = [](int x) { return x * x; };
+    
+    // The filter + transform combination above, as one pipeline
+    std::cout << "Even squares: ";
+    for (int n : numbers | views::filter(is_even) | views::transform(square)) {
+        std::cout << n << " ";
+    }
+    std::cout << std::endl;
+    
+    // Adaptor chains are values: name one and apply it to several ranges
+    auto first_even_squares = views::filter(is_even) | views::transform(square) | views::take(3);
+    SimpleVector<int> custom;
+    for (int i = 10; i < 19; ++i) {
+        custom.push_back(i);
+    }
+    std::cout << "First three even squares of a SimpleVector: ";
+    for (int n : custom | first_even_squares) {
+        std::cout << n << " ";
+    }
+    std::cout << std::endl;
+    
+    std::vector<std::string> labels = {"one", "two", "three"};
+    std::cout << "zip + enumerate: ";
+    for (auto [index, pair] : views::zip(labels, numbers) | views::enumerate) {
+        std::cout << index << ":" << pair.first << "=" << pair.second << " ";
+    }
+    std::cout << std::endl;
+    
+    std::cout << "chunk(4) spans: ";
+    for (span<int> block : numbers | views::chunk(4)) {
+        std::cout << "[" << fold(block, 0) << "] ";
+    }
+    std::cout << std::endl;
+    
+    // Captureless function objects are stored through the empty base
+    // optimization: a filter view over a vector is just the reference
+    std::cout << "sizeof(filter_view over vector&): " << sizeof(numbers | views::filter(is_even))
+              << " bytes (pointer: " << sizeof(void*) << ")" << std::endl;
+    
+    // Eager (intermediate vectors per stage) vs lazy (one pass)
+    const size_t size = 1000000;
+    std::vector<int> data(size);
+    std::iota(data.begin(), data.end(), 0);
+    
+    bench::Suite suite(benchConfig);
+    double eager_time = suite.run("pipeline/eager_vectors", [&]() {
+        std::vector<int> evens;
+        std::copy_if(data.begin(), data.end(), std::back_inserter(evens), is_even);
+        std::vector<long long> squares(evens.size());
+        std::transform(evens.begin(), evens.end(), squares.begin(),
+                       [](int x) { return static_cast<long long>(x) * x; });
+        bench::do_not_optimize(std::accumulate(squares.begin(), squares.end(), 0LL));
+    }).median_ms();
+    
+    double lazy_time = suite.run("pipeline/lazy_adaptors", [&]() {
+        auto squares = data | views::filter(is_even)
+                            | views::transform([](int x) { return static_cast<long long>(x) * x; });
+        bench::do_not_optimize(fold(squares, 0LL));
+    }).median_ms();
+    
+    double loop_time = suite.run("pipeline/hand_written_loop", [&]() {
+        long long total = 0;
+        for (int x : data) {
+            if (is_even(x)) {
+                total += static_cast<long long>(x) * x;
+            }
+        }
+        bench::do_not_optimize(total);
+    }).median_ms();
+    
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "\nfilter | transform | sum over " << size << " elements:" << std::endl;
+    std::cout << "  Eager (intermediate vectors): " << eager_time << " ms" << std::endl;
+    std::cout << "  Lazy adaptors:                " << lazy_time << " ms" << std::endl;
+    std::cout << "  Hand-written loop:            " << loop_time << " ms" << std::endl;
+}
+
 void demonstrateIteratorTraits() {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "  Iterator Traits and Categories" << std::endl;
@@ -521,20 +809,15 @@ void demonstrateIteratorTraits() {
     test_iterator_category(std_vec.begin());
 }
 
-void demonstratePerformanceComparison() {
+void demonstratePerformanceComparison(const bench::Config& benchConfig) {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "  Performance Comparison" << std::endl;
     std::cout << std::string(60, '=') << std::endl;
     
     const size_t size = 1000000;
     
-    auto measureTime = [](auto func) {
-        auto start = std::chrono::high_resolution_clock::now();
-        func();
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        return duration.count() / 1000.0; // Return milliseconds
-    };
+    bench::Suite suite(benchConfig);
+    auto measureTime = [&suite](const char* name, auto func) { return suite.run(name, func).median_ms(); };
     
     // Prepare data
     SimpleVector<int> custom_vec(size);
@@ -548,18 +831,20 @@ void demonstratePerformanceComparison() {
     }
     
     // Test iteration performance
-    double custom_time = measureTime([&]() {
-        volatile long long sum = 0;
+    double custom_time = measureTime("iterate/simple_vector", [&]() {
+        long long sum = 0;
         for (auto it = custom_vec.begin(); it != custom_vec.end(); ++it) {
             sum += *it;
         }
+        bench::do_not_optimize(sum);
     });
     
-    double std_time = measureTime([&]() {
-        volatile long long sum = 0;
+    double std_time = measureTime("iterate/std::vector", [&]() {
+        long long sum = 0;
         for (auto it = std_vec.begin(); it != std_vec.end(); ++it) {
             sum += *it;
         }
+        bench::do_not_optimize(sum);
     });
     
     std::cout << std::fixed << std::setprecision(3);
@@ -574,27 +859,77 @@ void demonstratePerformanceComparison() {
         indices.push_back(i * (size / 10000));
     }
     
-    double custom_random = measureTime([&]() {
-        volatile long long sum = 0;
+    double custom_random = measureTime("random_access/simple_vector", [&]() {
+        long long sum = 0;
         for (size_t idx : indices) {
             sum += custom_vec[idx];
         }
+        bench::do_not_optimize(sum);
     });
     
-    double std_random = measureTime([&]() {
-        volatile long long sum = 0;
+    double std_random = measureTime("random_access/std::vector", [&]() {
+        long long sum = 0;
         for (size_t idx : indices) {
             sum += std_vec[idx];
         }
+        bench::do_not_optimize(sum);
     });
     
     std::cout << "\nRandom access performance (10,000 accesses):" << std::endl;
     std::cout << "  Custom iterator: " << custom_random << " ms" << std::endl;
     std::cout << "  std::vector:     " << std_random << " ms" << std::endl;
     std::cout << "  Ratio:           " << custom_random / std_random << "x" << std::endl;
+    
+    // Copies of trivially copyable elements are one memcpy
+    double custom_copy = measureTime("copy/simple_vector", [&]() {
+        SimpleVector<int> copy(custom_vec);
+        bench::do_not_optimize(copy.data());
+    });
+    
+    double std_copy = measureTime("copy/std::vector", [&]() {
+        std::vector<int> copy(std_vec);
+        bench::do_not_optimize(copy.data());
+    });
+    
+    std::cout << "\nCopy performance (" << size << " elements):" << std::endl;
+    std::cout << "  SimpleVector:    " << custom_copy << " ms" << std::endl;
+    std::cout << "  std::vector:     " << std_copy << " ms" << std::endl;
+    
+    // Many short sequences: inline storage skips one allocation each
+    const size_t records = 100000;
+    double custom_small = measureTime("small_records/simple_vector", [&]() {
+        long long sum = 0;
+        for (size_t r = 0; r < records; ++r) {
+            SimpleVector<int> fields;
+            for (int f = 0; f < 6; ++f) {
+                fields.push_back(f + static_cast<int>(r));
+            }
+            sum += fields[5];
+        }
+        bench::do_not_optimize(sum);
+    });
+    
+    double std_small = measureTime("small_records/std::vector", [&]() {
+        long long sum = 0;
+        for (size_t r = 0; r < records; ++r) {
+            std::vector<int> fields;
+            fields.reserve(6);
+            for (int f = 0; f < 6; ++f) {
+                fields.push_back(f + static_cast<int>(r));
+            }
+            sum += fields[5];
+        }
+        bench::do_not_optimize(sum);
+    });
+    
+    std::cout << "\nBuilding " << records << " six-field records:" << std::endl;
+    std::cout << "  SimpleVector (inline): " << custom_small << " ms" << std::endl;
+    std::cout << "  std::vector (heap):    " << std_small << " ms" << std::endl;
+    std::cout << "  Ratio:                 " << custom_small / std_small << "x" << std::endl;
 }
 
-int main() {
+// Usage: custom_iterators [--trials=N] [--warmup=N] [--counters] (see benchmark.hpp)
+int main(int argc, char* argv[]) {
     std::cout << "===== Custom Iterators Implementation =====" << std::endl;
     std::cout << "This program demonstrates how to implement custom iterators" << std::endl;
     std::cout << "that are compatible with STL algorithms and containers." << std::endl;
@@ -602,9 +937,12 @@ int main() {
     demonstrateSimpleVector();
     demonstrateRangeIterator();
     demonstrateFilterIterator();
+    bench::Config benchConfig = bench::Config::from_args(argc, argv);
+    
     demonstrateTransformIterator();
+    demonstrateRangeAdaptors(benchConfig);
     demonstrateIteratorTraits();
-    demonstratePerformanceComparison();
+    demonstratePerformanceComparison(benchConfig);
     
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "Key Iterator Implementation Guidelines:" << std::endl;
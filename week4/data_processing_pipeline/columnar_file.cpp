@@ -0,0 +1,628 @@
+/*
+ * Data Processing Pipeline - Columnar Files Implementation
+ *
+ * Implements the writer and memory-mapped reader for the binary columnar
+ * format described in columnar_file.hpp, and DataSet::save_columnar /
+ * load_columnar on top of them.
+ */
+
+#include "columnar_file.hpp"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+namespace DataProcessing {
+
+namespace {
+    constexpr char FILE_MAGIC[8] = {'D', 'P', 'C', 'O', 'L', 'U', 'M', 'N'};
+    constexpr char FOOTER_MAGIC[8] = {'D', 'P', 'C', 'O', 'L', 'E', 'N', 'D'};
+    
+    // Tags of Mixed cells (DataValue::Kind order)
+    constexpr uint8_t TAG_INT = 0, TAG_DOUBLE = 1, TAG_STRING = 2, TAG_NULL = 3;
+    
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+    
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+    
+    // Append-only byte buffer for one chunk (or the footer)
+    class ByteWriter {
+    private:
+        std::string bytes_;
+    
+    public:
+        template<typename T>
+        void put(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            bytes_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+        
+        void put_bytes(const void* data, size_t size) {
+            bytes_.append(static_cast<const char*>(data), size);
+        }
+        
+        void put_varint(uint64_t value) {
+            while (value >= 0x80) {
+                bytes_.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            bytes_.push_back(static_cast<char>(value));
+        }
+        
+        void put_string(std::string_view text, ColumnarEncoding encoding) {
+            if (encoding == ColumnarEncoding::Varint) {
+                put_varint(text.size());
+            } else {
+                put<uint64_t>(text.size());
+            }
+            bytes_.append(text);
+        }
+        
+        const std::string& bytes() const { return bytes_; }
+        void clear() { bytes_.clear(); }
+    };
+    
+    // Bounds-checked cursor over a byte range of the mapped file
+    class ByteReader {
+    private:
+        const char* cursor_;
+        const char* end_;
+        
+        void require(size_t size) const {
+            if (static_cast<size_t>(end_ - cursor_) < size) {
+                throw std::runtime_error("Corrupt columnar file: read past the end of a section");
+            }
+        }
+    
+    public:
+        explicit ByteReader(std::string_view bytes) : cursor_(bytes.data()), end_(bytes.data() + bytes.size()) {}
+        
+        template<typename T>
+        T get() {
+            require(sizeof(T));
+            T value;
+            std::memcpy(&value, cursor_, sizeof(T));
+            cursor_ += sizeof(T);
+            return value;
+        }
+        
+        const char* take(size_t size) {
+            require(size);
+            const char* start = cursor_;
+            cursor_ += size;
+            return start;
+        }
+        
+        uint64_t get_varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t byte = get<uint8_t>();
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return value;
+            }
+            throw std::runtime_error("Corrupt columnar file: varint too long");
+        }
+        
+        std::string_view get_string(ColumnarEncoding encoding) {
+            uint64_t size = encoding == ColumnarEncoding::Varint ? get_varint() : get<uint64_t>();
+            require(size);
+            return std::string_view(take(size), size);
+        }
+    };
+    
+    // Encode rows [begin, end) of column; fills the chunk's statistics
+    void encode_chunk(const Column& column, size_t begin, size_t end, ColumnarEncoding encoding,
+                      ByteWriter& out, ColumnChunkInfo& info) {
+        bool varint = encoding == ColumnarEncoding::Varint;
+        switch (column.type()) {
+            case ColumnType::Int64: {
+                const int64_t* cells = column.ints().data();
+                if (varint) {
+                    int64_t previous = 0;
+                    for (size_t row = begin; row < end; ++row) {
+                        // Wrapping subtraction: any delta round-trips
+                        out.put_varint(zigzag(static_cast<int64_t>(
+                            static_cast<uint64_t>(cells[row]) - static_cast<uint64_t>(previous))));
+                        previous = cells[row];
+                    }
+                } else {
+                    out.put_bytes(cells + begin, (end - begin) * sizeof(int64_t));
+                }
+                if (begin < end) {
+                    auto [low, high] = std::minmax_element(cells + begin, cells + end);
+                    info.has_range = true;
+                    info.min_val = static_cast<double>(*low);
+                    info.max_val = static_cast<double>(*high);
+                }
+                break;
+            }
+            case ColumnType::Double: {
+                const double* cells = column.doubles().data();
+                out.put_bytes(cells + begin, (end - begin) * sizeof(double));
+                double low = std::numeric_limits<double>::infinity();
+                double high = -low;
+                bool has_nan = false;
+                for (size_t row = begin; row < end; ++row) {
+                    low = std::min(low, cells[row]);
+                    high = std::max(high, cells[row]);
+                    has_nan |= std::isnan(cells[row]);
+                }
+                // NaN passes greater-than tests, so a range that leaves it
+                // out would let a scan skip a matching chunk
+                if (low <= high && !has_nan) {
+                    info.has_range = true;
+                    info.min_val = low;
+                    info.max_val = high;
+                }
+                break;
+            }
+            case ColumnType::String: {
+                const auto& cells = column.strings();
+                for (size_t row = begin; row < end; ++row) {
+                    out.put_string(cells[row], encoding);
+                }
+                break;
+            }
+            case ColumnType::Dictionary: {
+                const auto& codes = column.dictionary().codes;
+                if (varint) {
+                    for (size_t row = begin; row < end; ++row) {
+                        out.put_varint(codes[row]);
+                    }
+                } else {
+                    out.put_bytes(codes.data() + begin, (end - begin) * sizeof(uint32_t));
+                }
+                break;
+            }
+            case ColumnType::Mixed: {
+                const auto& cells = column.values();
+                for (size_t row = begin; row < end; ++row) {
+                    const DataValue& cell = cells[row];
+                    if (cell.is_int()) {
+                        out.put(TAG_INT);
+                        out.put<int64_t>(cell.as_int());
+                    } else if (cell.is_double()) {
+                        out.put(TAG_DOUBLE);
+                        out.put(cell.as_double());
+                    } else if (cell.is_string()) {
+                        out.put(TAG_STRING);
+                        out.put_string(cell.as_string(), encoding);
+                    } else {
+                        out.put(TAG_NULL);
+                    }
+                }
+                break;
+            }
+        }
+    }
+    
+    Column::Storage make_storage(ColumnType type, Column::Allocator alloc) {
+        switch (type) {
+            case ColumnType::Int64:      return std::pmr::vector<int64_t>(alloc);
+            case ColumnType::Double:     return std::pmr::vector<double>(alloc);
+            case ColumnType::String:     return std::pmr::vector<std::pmr::string>(alloc);
+            case ColumnType::Dictionary: return DictionaryColumn(alloc);
+            case ColumnType::Mixed:      break;
+        }
+        return std::pmr::vector<DataValue>(alloc);
+    }
+}
+
+// Columnar::write
+namespace Columnar {
+    void write(const DataSet& dataset, const std::string& filename, const ColumnarOptions& options) {
+        // Written under a temporary name and renamed into place, so a reader
+        // never sees a half-written cache file
+        std::string partial = filename + ".partial";
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Cannot create file: " + filename);
+        }
+        
+        size_t chunk_rows = std::max<size_t>(options.chunk_rows, 1);
+        uint64_t offset = 0;
+        auto emit = [&](const std::string& bytes) {
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            offset += bytes.size();
+        };
+        
+        out.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+        offset += sizeof(FILE_MAGIC);
+        
+        ByteWriter buffer;
+        std::vector<ColumnInfo> infos;
+        for (size_t i = 0; i < dataset.get_columns().size(); ++i) {
+            const Column& column = dataset.column_at(i);
+            ColumnInfo info;
+            info.name = dataset.get_columns()[i];
+            info.type = column.type();
+            info.encoding = options.encoding;
+            
+            if (column.type() == ColumnType::Dictionary) {
+                const StringDictionary& dictionary = *column.dictionary().dictionary;
+                buffer.clear();
+                buffer.put_varint(dictionary.size());
+                for (size_t code = 0; code < dictionary.size(); ++code) {
+                    buffer.put_string(dictionary[static_cast<uint32_t>(code)], ColumnarEncoding::Varint);
+                }
+                info.dictionary_offset = offset;
+                info.dictionary_bytes = buffer.bytes().size();
+                emit(buffer.bytes());
+            }
+            
+            for (size_t begin = 0; begin < dataset.size(); begin += chunk_rows) {
+                size_t end = std::min(begin + chunk_rows, dataset.size());
+                ColumnChunkInfo chunk;
+                buffer.clear();
+                encode_chunk(column, begin, end, options.encoding, buffer, chunk);
+                chunk.offset = offset;
+                chunk.bytes = buffer.bytes().size();
+                chunk.rows = end - begin;
+                emit(buffer.bytes());
+                info.chunks.push_back(chunk);
+            }
+            infos.push_back(std::move(info));
+        }
+        
+        ByteWriter footer;
+        footer.put<uint64_t>(dataset.size());
+        footer.put<uint64_t>(chunk_rows);
+        footer.put<uint32_t>(static_cast<uint32_t>(infos.size()));
+        for (const ColumnInfo& info : infos) {
+            footer.put_string(info.name, ColumnarEncoding::Varint);
+            footer.put(static_cast<uint8_t>(info.type));
+            footer.put(static_cast<uint8_t>(info.encoding));
+            footer.put(info.dictionary_offset);
+            footer.put(info.dictionary_bytes);
+            footer.put<uint64_t>(info.chunks.size());
+            for (const ColumnChunkInfo& chunk : info.chunks) {
+                footer.put(chunk.offset);
+                footer.put(chunk.bytes);
+                footer.put(chunk.rows);
+                footer.put<uint8_t>(chunk.has_range);
+                footer.put(chunk.min_val);
+                footer.put(chunk.max_val);
+            }
+        }
+        footer.put<uint64_t>(footer.bytes().size());
+        footer.put_bytes(FOOTER_MAGIC, sizeof(FOOTER_MAGIC));
+        emit(footer.bytes());
+        
+        out.close();
+        if (!out) {
+            std::filesystem::remove(partial);
+            throw std::runtime_error("Failed writing columnar file: " + filename);
+        }
+        std::filesystem::rename(partial, filename);
+    }
+}
+
+// ColumnarFile implementations
+ColumnarFile::ColumnarFile(const std::string& filename) : file_(filename) {
+    std::string_view bytes = file_.view();
+    constexpr size_t TRAILER = sizeof(uint64_t) + sizeof(FOOTER_MAGIC);
+    if (bytes.size() < sizeof(FILE_MAGIC) + TRAILER ||
+        std::memcmp(bytes.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        std::memcmp(bytes.data() + bytes.size() - sizeof(FOOTER_MAGIC), FOOTER_MAGIC, sizeof(FOOTER_MAGIC)) != 0) {
+        throw std::runtime_error("Not a columnar file: " + filename);
+    }
+    
+    uint64_t footer_size;
+    std::memcpy(&footer_size, bytes.data() + bytes.size() - TRAILER, sizeof(footer_size));
+    if (footer_size > bytes.size() - sizeof(FILE_MAGIC) - TRAILER) {
+        throw std::runtime_error("Corrupt columnar file: " + filename);
+    }
+    size_t data_end = bytes.size() - TRAILER - footer_size;
+    
+    ByteReader footer(bytes.substr(data_end, footer_size));
+    rows_ = footer.get<uint64_t>();
+    chunk_rows_ = footer.get<uint64_t>();
+    uint32_t column_count = footer.get<uint32_t>();
+    for (uint32_t i = 0; i < column_count; ++i) {
+        ColumnInfo info;
+        info.name = std::string(footer.get_string(ColumnarEncoding::Varint));
+        uint8_t type = footer.get<uint8_t>();
+        uint8_t encoding = footer.get<uint8_t>();
+        if (type > static_cast<uint8_t>(ColumnType::Dictionary) ||
+            encoding > static_cast<uint8_t>(ColumnarEncoding::Varint)) {
+            throw std::runtime_error("Corrupt columnar file: " + filename);
+        }
+        info.type = static_cast<ColumnType>(type);
+        info.encoding = static_cast<ColumnarEncoding>(encoding);
+        info.dictionary_offset = footer.get<uint64_t>();
+        info.dictionary_bytes = footer.get<uint64_t>();
+        
+        uint64_t chunk_count = footer.get<uint64_t>();
+        uint64_t rows = 0;
+        for (uint64_t c = 0; c < chunk_count; ++c) {
+            ColumnChunkInfo chunk;
+            chunk.offset = footer.get<uint64_t>();
+            chunk.bytes = footer.get<uint64_t>();
+            chunk.rows = footer.get<uint64_t>();
+            chunk.has_range = footer.get<uint8_t>() != 0;
+            chunk.min_val = footer.get<double>();
+            chunk.max_val = footer.get<double>();
+            if (chunk.offset > data_end || chunk.bytes > data_end - chunk.offset) {
+                throw std::runtime_error("Corrupt columnar file: " + filename);
+            }
+            rows += chunk.rows;
+            info.chunks.push_back(chunk);
+        }
+        if (rows != rows_ || info.dictionary_offset > data_end ||
+            info.dictionary_bytes > data_end - info.dictionary_offset) {
+            throw std::runtime_error("Corrupt columnar file: " + filename);
+        }
+        columns_.push_back(std::move(info));
+    }
+}
+
+const ColumnInfo& ColumnarFile::column_info(const std::string& name) const {
+    for (const ColumnInfo& info : columns_) {
+        if (info.name == name) return info;
+    }
+    throw std::invalid_argument("Column not found: " + name);
+}
+
+std::shared_ptr<StringDictionary> ColumnarFile::read_dictionary(const ColumnInfo& info) const {
+    ByteReader in(file_.view().substr(info.dictionary_offset, info.dictionary_bytes));
+    auto dictionary = std::make_shared<StringDictionary>();
+    uint64_t count = in.get_varint();
+    for (uint64_t code = 0; code < count; ++code) {
+        dictionary->intern(in.get_string(ColumnarEncoding::Varint));
+    }
+    if (dictionary->size() != count) {
+        throw std::runtime_error("Corrupt columnar file: duplicate dictionary value");
+    }
+    return dictionary;
+}
+
+void ColumnarFile::read_chunk(const ColumnInfo& info, size_t chunk, Column::Storage& storage) const {
+    const ColumnChunkInfo& entry = info.chunks.at(chunk);
+    ByteReader in(file_.view().substr(entry.offset, entry.bytes));
+    size_t rows = entry.rows;
+    bool varint = info.encoding == ColumnarEncoding::Varint;
+    
+    switch (info.type) {
+        case ColumnType::Int64: {
+            auto& cells = std::get<std::pmr::vector<int64_t>>(storage);
+            size_t start = cells.size();
+            cells.resize(start + rows);
+            if (varint) {
+                int64_t previous = 0;
+                for (size_t row = 0; row < rows; ++row) {
+                    previous = static_cast<int64_t>(static_cast<uint64_t>(previous) +
+                                                    static_cast<uint64_t>(unzigzag(in.get_varint())));
+                    cells[start + row] = previous;
+                }
+            } else {
+                std::memcpy(cells.data() + start, in.take(rows * sizeof(int64_t)), rows * sizeof(int64_t));
+            }
+            break;
+        }
+        case ColumnType::Double: {
+            auto& cells = std::get<std::pmr::vector<double>>(storage);
+            size_t start = cells.size();
+            cells.resize(start + rows);
+            std::memcpy(cells.data() + start, in.take(rows * sizeof(double)), rows * sizeof(double));
+            break;
+        }
+        case ColumnType::String: {
+            auto& cells = std::get<std::pmr::vector<std::pmr::string>>(storage);
+            for (size_t row = 0; row < rows; ++row) {
+                cells.emplace_back(in.get_string(info.encoding));
+            }
+            break;
+        }
+        case ColumnType::Dictionary: {
+            auto& column = std::get<DictionaryColumn>(storage);
+            auto& codes = column.codes;
+            size_t start = codes.size();
+            codes.resize(start + rows);
+            if (varint) {
+                for (size_t row = 0; row < rows; ++row) {
+                    codes[start + row] = static_cast<uint32_t>(in.get_varint());
+                }
+            } else {
+                std::memcpy(codes.data() + start, in.take(rows * sizeof(uint32_t)), rows * sizeof(uint32_t));
+            }
+            size_t dictionary_size = column.dictionary->size();
+            for (size_t row = start; row < codes.size(); ++row) {
+                if (codes[row] >= dictionary_size) {
+                    throw std::runtime_error("Corrupt columnar file: dictionary code out of range");
+                }
+            }
+            break;
+        }
+        case ColumnType::Mixed: {
+            auto& cells = std::get<std::pmr::vector<DataValue>>(storage);
+            for (size_t row = 0; row < rows; ++row) {
+                switch (in.get<uint8_t>()) {
+                    case TAG_INT:    cells.emplace_back(in.get<int64_t>()); break;
+                    case TAG_DOUBLE: cells.emplace_back(in.get<double>()); break;
+                    case TAG_STRING: cells.emplace_back(in.get_string(info.encoding)); break;
+                    case TAG_NULL:   cells.emplace_back(); break;
+                    default: throw std::runtime_error("Corrupt columnar file: bad cell tag");
+                }
+            }
+            break;
+        }
+    }
+}
+
+Column ColumnarFile::read_column(const std::string& name, Column::Allocator alloc) const {
+    std::vector<size_t> chunks(chunk_count());
+    std::iota(chunks.begin(), chunks.end(), 0);
+    return read_column(name, chunks, alloc);
+}
+
+Column ColumnarFile::read_column(const std::string& name, const std::vector<size_t>& chunks,
+                                 Column::Allocator alloc) const {
+    const ColumnInfo& info = column_info(name);
+    Column::Storage storage = make_storage(info.type, alloc);
+    if (info.type == ColumnType::Dictionary) {
+        std::get<DictionaryColumn>(storage).dictionary = read_dictionary(info);
+    }
+    
+    size_t rows = 0;
+    for (size_t chunk : chunks) {
+        rows += info.chunks.at(chunk).rows;
+    }
+    std::visit([rows](auto& cells) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(cells)>, DictionaryColumn>) {
+            cells.codes.reserve(rows);
+        } else {
+            cells.reserve(rows);
+        }
+    }, storage);
+    
+    for (size_t chunk : chunks) {
+        read_chunk(info, chunk, storage);
+    }
+    return Column(std::move(storage));
+}
+
+DataSet ColumnarFile::read(const std::vector<std::string>& columns) const {
+    std::vector<size_t> chunks(chunk_count());
+    std::iota(chunks.begin(), chunks.end(), 0);
+    return read(columns, chunks);
+}
+
+DataSet ColumnarFile::read(const std::vector<std::string>& columns, const std::vector<size_t>& chunks) const {
+    std::vector<std::string> names = columns;
+    if (names.empty()) {
+        for (const ColumnInfo& info : columns_) {
+            names.push_back(info.name);
+        }
+    }
+    
+    std::vector<Column> data;
+    data.reserve(names.size());
+    for (const std::string& name : names) {
+        data.push_back(read_column(name, chunks));
+    }
+    return DataSet(std::move(names), std::move(data));
+}
+
+std::vector<uint8_t> ColumnarFile::chunk_mask(const Filters::Expression& expression) const {
+    using Op = Filters::Expression::Op;
+    size_t chunks = chunk_count();
+    
+    if (!expression.is_comparison()) {
+        if (expression.op == Op::Not) {
+            return std::vector<uint8_t>(chunks, 1);   // a range says nothing about its complement
+        }
+        std::vector<uint8_t> mask = chunk_mask(*expression.children[0]);
+        for (size_t child = 1; child < expression.children.size(); ++child) {
+            std::vector<uint8_t> other = chunk_mask(*expression.children[child]);
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                mask[chunk] = expression.op == Op::And ? (mask[chunk] & other[chunk]) : (mask[chunk] | other[chunk]);
+            }
+        }
+        return mask;
+    }
+    
+    auto found = std::find_if(columns_.begin(), columns_.end(),
+                              [&](const ColumnInfo& info) { return info.name == expression.column; });
+    if (found == columns_.end()) {
+        return std::vector<uint8_t>(chunks, 0);   // comparisons fail on a missing column
+    }
+    const ColumnInfo& info = *found;
+    
+    if (info.type == ColumnType::Dictionary) {
+        std::vector<uint8_t> matches = read_dictionary(info)->matches(expression.cell_test());
+        bool any = std::find(matches.begin(), matches.end(), 1) != matches.end();
+        return std::vector<uint8_t>(chunks, any);
+    }
+    
+    // Ranges only decide numeric comparisons: against a string, cells are
+    // compared as text
+    std::vector<uint8_t> mask(chunks, 1);
+    bool numeric = expression.value.is_numeric();
+    if (!numeric || expression.op == Op::Contains) {
+        return mask;
+    }
+    double value = ValueOps::to_double(expression.value);
+    if (std::isnan(value)) {
+        return mask;
+    }
+    // Equality compares std::to_string forms, which keep six decimals
+    double tolerance = 1e-6 + std::abs(value) * 1e-12;
+    
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        const ColumnChunkInfo& entry = info.chunks[chunk];
+        if (entry.rows == 0) {
+            mask[chunk] = 0;
+            continue;
+        }
+        if (!entry.has_range) continue;
+        // Int64 ranges may have been rounded on the way to double
+        double low = std::nextafter(entry.min_val, -std::numeric_limits<double>::infinity());
+        double high = std::nextafter(entry.max_val, std::numeric_limits<double>::infinity());
+        switch (expression.op) {
+            case Op::LessThan:    mask[chunk] = low < value; break;
+            case Op::GreaterThan: mask[chunk] = high >= value; break;
+            case Op::Equals:      mask[chunk] = low <= value + tolerance && high >= value - tolerance; break;
+            default: break;
+        }
+    }
+    return mask;
+}
+
+std::vector<size_t> ColumnarFile::candidate_chunks(const FilterPredicate& predicate) const {
+    std::vector<size_t> chunks;
+    auto expression = Filters::expression_of(predicate);
+    if (!expression) {
+        chunks.resize(chunk_count());
+        std::iota(chunks.begin(), chunks.end(), 0);
+        return chunks;
+    }
+    std::vector<uint8_t> mask = chunk_mask(*expression);
+    for (size_t chunk = 0; chunk < mask.size(); ++chunk) {
+        if (mask[chunk]) chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+DataSet ColumnarFile::scan(const FilterPredicate& predicate, const std::vector<std::string>& columns) const {
+    std::vector<size_t> chunks = candidate_chunks(predicate);
+    auto reads = Filters::columns_read(predicate);
+    if (columns.empty() || !reads) {
+        DataSet all = read({}, chunks).filter(predicate);
+        return columns.empty() ? all : all.select(columns);
+    }
+    
+    // The predicate's columns are read too, then dropped after filtering
+    std::vector<std::string> names = columns;
+    for (const std::string& name : *reads) {
+        bool stored = std::any_of(columns_.begin(), columns_.end(),
+                                  [&](const ColumnInfo& info) { return info.name == name; });
+        if (stored && std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(name);
+        }
+    }
+    DataSet matching = read(names, chunks).filter(predicate);
+    return names.size() == columns.size() ? matching : matching.select(columns);
+}
+
+// DataSet columnar I/O
+DataSet DataSet::load_columnar(const std::string& filename, const std::vector<std::string>& columns) {
+    return ColumnarFile(filename).read(columns);
+}
+
+DataSet DataSet::load_columnar(const std::string& filename, const FilterPredicate& predicate,
+                               const std::vector<std::string>& columns) {
+    return ColumnarFile(filename).scan(predicate, columns);
+}
+
+void DataSet::save_columnar(const std::string& filename) const {
+    Columnar::write(*this, filename);
+}
+
+void DataSet::save_columnar(const std::string& filename, const ColumnarOptions& options) const {
+    Columnar::write(*this, filename, options);
+}
+
+} // namespace DataProcessing
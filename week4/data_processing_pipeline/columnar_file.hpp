@@ -0,0 +1,107 @@
+/*
+ * Data Processing Pipeline - Columnar Files
+ *
+ * A native binary format for caching DataSets between job stages. Cells are
+ * stored column by column in chunks of a fixed number of rows, typed the way
+ * the Column buffers are, so loading is a copy (or a varint decode) per chunk
+ * instead of parsing text. A footer at the end of the file indexes every
+ * chunk with its offset and min/max statistics; readers memory-map the file,
+ * parse only the footer, and touch only the pages of the columns they read.
+ *
+ * File layout:
+ *   "DPCOLUMN"
+ *   chunk data, each column's chunks in row order, a dictionary column's
+ *   values right before its first chunk
+ *   footer: row count, chunk_rows, then per column its name, type, encoding,
+ *   dictionary position and one (offset, bytes, rows, min, max) per chunk
+ *   footer size (8 bytes), "DPCOLEND"
+ *
+ * Numbers are in native byte order: these files are a cache for the machine
+ * that wrote them, not an interchange format.
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+#include "csv_reader.hpp"
+
+namespace DataProcessing {
+
+// How Int64 cells, dictionary codes and string lengths are stored in a chunk.
+// Varint writes Int64 cells as zigzag-encoded deltas from the previous cell
+// and everything else as plain LEB128 varints; doubles are always raw.
+enum class ColumnarEncoding : uint8_t { Plain, Varint };
+
+struct ColumnarOptions {
+    size_t chunk_rows = 64 * 1024;
+    ColumnarEncoding encoding = ColumnarEncoding::Varint;
+};
+
+// Footer entry for one chunk of one column. Chunk i of every column covers
+// the same rows, [i * chunk_rows, i * chunk_rows + rows).
+struct ColumnChunkInfo {
+    uint64_t offset = 0;
+    uint64_t bytes = 0;
+    uint64_t rows = 0;
+    
+    // Range of the chunk's values; numeric columns with rows and no NaN only
+    bool has_range = false;
+    double min_val = 0.0;
+    double max_val = 0.0;
+};
+
+struct ColumnInfo {
+    std::string name;
+    ColumnType type = ColumnType::Int64;
+    ColumnarEncoding encoding = ColumnarEncoding::Plain;
+    uint64_t dictionary_offset = 0;   // Dictionary columns only
+    uint64_t dictionary_bytes = 0;
+    std::vector<ColumnChunkInfo> chunks;
+};
+
+namespace Columnar {
+    void write(const DataSet& dataset, const std::string& filename,
+               const ColumnarOptions& options = ColumnarOptions());
+}
+
+// Read-only, memory-mapped columnar file
+class ColumnarFile {
+private:
+    MappedFile file_;
+    uint64_t rows_ = 0;
+    uint64_t chunk_rows_ = 0;
+    std::vector<ColumnInfo> columns_;
+    
+    std::shared_ptr<StringDictionary> read_dictionary(const ColumnInfo& info) const;
+    void read_chunk(const ColumnInfo& info, size_t chunk, Column::Storage& storage) const;
+    std::vector<uint8_t> chunk_mask(const Filters::Expression& expression) const;
+    
+public:
+    explicit ColumnarFile(const std::string& filename);
+    
+    size_t rows() const { return rows_; }
+    size_t chunk_rows() const { return chunk_rows_; }
+    size_t chunk_count() const { return columns_.empty() ? 0 : columns_.front().chunks.size(); }
+    const std::vector<ColumnInfo>& columns() const { return columns_; }
+    const ColumnInfo& column_info(const std::string& name) const;
+    
+    // Whole columns, or only the given chunks (ascending) concatenated
+    Column read_column(const std::string& name, Column::Allocator alloc = {}) const;
+    Column read_column(const std::string& name, const std::vector<size_t>& chunks,
+                       Column::Allocator alloc = {}) const;
+    
+    // The named columns (all when empty), optionally restricted to chunks
+    DataSet read(const std::vector<std::string>& columns = {}) const;
+    DataSet read(const std::vector<std::string>& columns, const std::vector<size_t>& chunks) const;
+    
+    // Chunks (ascending) that may hold rows matching predicate, judged from
+    // the chunk ranges and dictionaries in the footer. Every chunk when the
+    // predicate is not a Filters expression.
+    std::vector<size_t> candidate_chunks(const FilterPredicate& predicate) const;
+    
+    // Rows matching predicate with the named columns (all when empty),
+    // reading only the candidate chunks
+    DataSet scan(const FilterPredicate& predicate, const std::vector<std::string>& columns = {}) const;
+};
+
+} // namespace DataProcessing
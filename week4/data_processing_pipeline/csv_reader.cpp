@@ -0,0 +1,400 @@
+/*
+ * Data Processing Pipeline - CSV Reader Implementation
+ *
+ * Implements the memory-mapped CSV loader used by DataSet::load_from_csv,
+ * its chunked parallel variant and the directory-of-shards loader.
+ */
+
+#include "csv_reader.hpp"
+#include "advanced_task_scheduler.hpp"
+#include "directory_crawler.hpp"
+#include <charconv>
+#include <cstring>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DataProcessing {
+
+// MappedFile implementations
+MappedFile::MappedFile(const std::string& filename) {
+    Result<void> opened = open(filename);
+    if (!opened) {
+        throw std::runtime_error(opened.error().message());
+    }
+}
+
+Result<void> MappedFile::open(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return stdx::unexpected(Error{ErrorCode::CannotOpenFile, filename});
+    }
+    
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* address = ::mmap(nullptr, static_cast<size_t>(info.st_size),
+                               PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            ::madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(address);
+            size_ = static_cast<size_t>(info.st_size);
+            mapped_ = true;
+        }
+    }
+    
+    // Pipes, empty files and failed mappings are read into memory instead
+    if (!mapped_) {
+        char buffer[1 << 16];
+        ssize_t count;
+        while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+            fallback_.append(buffer, static_cast<size_t>(count));
+        }
+        data_ = fallback_.data();
+        size_ = fallback_.size();
+    }
+    
+    ::close(fd);
+    return {};
+}
+
+MappedFile::~MappedFile() {
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+namespace Csv {
+    namespace {
+        // Only attempt numeric parsing on cells that look like numbers, so
+        // text such as "nan" or "Infinity" in a name column stays a string
+        bool looks_numeric(std::string_view cell) {
+            if (cell.empty()) return false;
+            char first = cell.front() == '-' ? (cell.size() > 1 ? cell[1] : '\0') : cell.front();
+            return (first >= '0' && first <= '9') || first == '.';
+        }
+        
+        template<typename Number>
+        ParseResult<Number> parse_number(std::string_view cell) {
+            if (!looks_numeric(cell)) return stdx::unexpected(ErrorCode::NotANumber);
+            Number value;
+            auto [end, error] = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+            if (error == std::errc::result_out_of_range) return stdx::unexpected(ErrorCode::NumberOutOfRange);
+            if (error != std::errc() || end != cell.data() + cell.size()) return stdx::unexpected(ErrorCode::NotANumber);
+            return value;
+        }
+        
+        bool parse_int(std::string_view cell, int64_t& value) {
+            ParseResult<int64_t> parsed = parse_number<int64_t>(cell);
+            if (parsed) value = *parsed;
+            return parsed.has_value();
+        }
+        
+        bool parse_double(std::string_view cell, double& value) {
+            ParseResult<double> parsed = parse_number<double>(cell);
+            if (parsed) value = *parsed;
+            return parsed.has_value();
+        }
+    }
+    
+    ParseResult<int64_t> try_parse_int(std::string_view cell) {
+        return parse_number<int64_t>(cell);
+    }
+    
+    ParseResult<double> try_parse_double(std::string_view cell) {
+        return parse_number<double>(cell);
+    }
+    
+    std::string_view trim(std::string_view text) {
+        constexpr std::string_view whitespace = " \t\r\n";
+        size_t first = text.find_first_not_of(whitespace);
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        size_t last = text.find_last_not_of(whitespace);
+        return text.substr(first, last - first + 1);
+    }
+    
+    std::string_view next_line(std::string_view& text) {
+        size_t newline = text.find('\n');
+        std::string_view line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+        return line;
+    }
+    
+    void split_line(std::string_view line, std::vector<std::string_view>& fields) {
+        // Same field boundaries as std::getline(stream, cell, ','): an empty
+        // line has no fields and a trailing comma does not start a new one
+        fields.clear();
+        while (!line.empty()) {
+            size_t comma = line.find(',');
+            fields.push_back(trim(line.substr(0, comma)));
+            if (comma == std::string_view::npos) break;
+            line.remove_prefix(comma + 1);
+        }
+    }
+    
+    std::vector<std::string> read_header(std::string_view& body) {
+        std::vector<std::string_view> header;
+        if (!body.empty()) {
+            split_line(next_line(body), header);
+        }
+        return std::vector<std::string>(header.begin(), header.end());
+    }
+    
+    DataValue parse_cell(std::string_view cell) {
+        int64_t int_value;
+        if (parse_int(cell, int_value)) {
+            return int_value;
+        }
+        double double_value;
+        if (parse_double(cell, double_value)) {
+            return double_value;
+        }
+        return std::string(cell);
+    }
+    
+    std::vector<ColumnType> infer_types(std::string_view body, size_t column_count,
+                                        size_t sample_rows) {
+        // Every column starts as the narrowest type and widens as needed:
+        // Int64 -> Double -> String. Empty cells carry no type information.
+        std::vector<ColumnType> types(column_count, ColumnType::Int64);
+        std::vector<bool> seen(column_count, false);
+        std::vector<size_t> cells(column_count, 0);
+        std::vector<std::unordered_set<std::string_view>> distinct(column_count);
+        std::vector<std::string_view> fields;
+        
+        for (size_t row = 0; row < sample_rows && !body.empty(); ++row) {
+            split_line(next_line(body), fields);
+            for (size_t i = 0; i < column_count && i < fields.size(); ++i) {
+                std::string_view cell = fields[i];
+                if (cell.empty()) continue;
+                ++cells[i];
+                distinct[i].insert(cell);
+                if (types[i] == ColumnType::String) continue;
+                seen[i] = true;
+                
+                int64_t int_value;
+                double double_value;
+                if (types[i] == ColumnType::Int64 && parse_int(cell, int_value)) continue;
+                types[i] = parse_double(cell, double_value) ? ColumnType::Double : ColumnType::String;
+            }
+        }
+        
+        for (size_t i = 0; i < column_count; ++i) {
+            if (!seen[i]) types[i] = ColumnType::String;
+            if (types[i] == ColumnType::String && cells[i] >= DICTIONARY_MIN_CELLS &&
+                distinct[i].size() * DICTIONARY_MAX_DISTINCT_RATIO <= cells[i]) {
+                types[i] = ColumnType::Dictionary;
+            }
+        }
+        return types;
+    }
+    
+    std::vector<Column> parse_rows(std::string_view body, const std::vector<ColumnType>& types,
+                                   Column::Allocator alloc) {
+        std::vector<Column> columns;
+        columns.reserve(types.size());
+        for (ColumnType type : types) {
+            columns.emplace_back(type, alloc);
+        }
+        
+        // Count lines up front (a memchr-speed scan) so each buffer is allocated once
+        size_t estimated_rows = static_cast<size_t>(std::count(body.begin(), body.end(), '\n')) + 1;
+        for (auto& column : columns) {
+            column.reserve(estimated_rows);
+        }
+        
+        std::vector<std::string_view> fields;
+        while (!body.empty()) {
+            split_line(next_line(body), fields);
+            
+            for (size_t i = 0; i < columns.size(); ++i) {
+                // Short rows are padded with empty values
+                std::string_view cell = i < fields.size() ? fields[i] : std::string_view();
+                Column& column = columns[i];
+                
+                bool appended = false;
+                switch (column.type()) {
+                    case ColumnType::Int64: {
+                        int64_t value;
+                        if ((appended = parse_int(cell, value))) column.append_int64(value);
+                        break;
+                    }
+                    case ColumnType::Double: {
+                        double value;
+                        if ((appended = parse_double(cell, value))) column.append_double(value);
+                        break;
+                    }
+                    case ColumnType::String:
+                    case ColumnType::Dictionary:
+                        column.append_string(cell);
+                        appended = true;
+                        break;
+                    case ColumnType::Mixed:
+                        break;
+                }
+                
+                // Cells that do not fit the inferred type demote the column to Mixed
+                if (!appended) {
+                    column.append(parse_cell(cell));
+                }
+            }
+        }
+        
+        return columns;
+    }
+    
+    std::vector<std::string_view> split_chunks(std::string_view body, size_t count) {
+        std::vector<std::string_view> chunks;
+        size_t target = body.size() / std::max<size_t>(count, 1) + 1;
+        
+        while (!body.empty()) {
+            size_t end = std::min(target, body.size());
+            
+            // Extend the range to the end of the line it stops in
+            size_t newline = body.find('\n', end - 1);
+            end = (newline == std::string_view::npos) ? body.size() : newline + 1;
+            
+            chunks.push_back(body.substr(0, end));
+            body.remove_prefix(end);
+        }
+        
+        return chunks;
+    }
+}
+
+// DataSet::load_from_csv - memory-mapped, exception-free tokenizer; the
+// throwing version wraps try_load_from_csv
+DataSet DataSet::load_from_csv(const std::string& filename) {
+    Result<DataSet> dataset = try_load_from_csv(filename);
+    if (!dataset) {
+        throw std::runtime_error(dataset.error().message());
+    }
+    return *std::move(dataset);
+}
+
+Result<DataSet> DataSet::try_load_from_csv(const std::string& filename) {
+    MappedFile file;
+    if (Result<void> opened = file.open(filename); !opened) {
+        return stdx::unexpected(std::move(opened).error());
+    }
+    std::string_view body = file.view();
+    
+    std::vector<std::string> columns = Csv::read_header(body);
+    std::vector<ColumnType> types = Csv::infer_types(body, columns.size());
+    return DataSet(std::move(columns), Csv::parse_rows(body, types));
+}
+
+// DataSet::load_from_csv_parallel - chunked ingest on a ThreadPool.
+// The body is split at newline boundaries, every chunk is parsed with the
+// column types inferred from the start of the file, and the chunk columns
+// are concatenated in file order, so the result matches load_from_csv.
+DataSet DataSet::load_from_csv_parallel(const std::string& filename, size_t threads) {
+    MappedFile file(filename);
+    std::string_view body = file.view();
+    
+    std::vector<std::string> columns = Csv::read_header(body);
+    std::vector<ColumnType> types = Csv::infer_types(body, columns.size());
+    
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunk_count = std::min(threads, body.size() / Csv::PARALLEL_MIN_CHUNK_BYTES + 1);
+    if (chunk_count <= 1) {
+        return DataSet(std::move(columns), Csv::parse_rows(body, types));
+    }
+    
+    std::vector<std::string_view> chunks = Csv::split_chunks(body, chunk_count);
+    std::vector<std::future<std::vector<Column>>> parts;
+    parts.reserve(chunks.size());
+    
+    {
+        ThreadPool pool(chunk_count);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            auto job = std::make_shared<std::packaged_task<std::vector<Column>()>>(
+                [chunk = chunks[i], &types] { return Csv::parse_rows(chunk, types); });
+            parts.push_back(job->get_future());
+            pool.enqueue(std::make_shared<Task<void>>(
+                "csv-chunk-" + std::to_string(i), [job] { (*job)(); }));
+        }
+        
+        // Stitch chunk outputs together in file order as they complete
+        std::vector<Column> data = parts[0].get();
+        for (size_t i = 1; i < parts.size(); ++i) {
+            std::vector<Column> part = parts[i].get();
+            for (size_t c = 0; c < data.size(); ++c) {
+                data[c].extend(std::move(part[c]));
+            }
+        }
+        return DataSet(std::move(columns), std::move(data));
+    }
+}
+
+// DataSet::load_from_csv_directory - one load from a tree of CSV shards.
+// The crawler (directory_crawler.hpp) walks the tree on a ThreadPool and
+// queues each shard's parse on the same pool as soon as it finds the file,
+// so listing and parsing overlap; a shard is parsed by one task. Each shard
+// infers its own column types, and columns typed differently in different
+// shards are joined the way Column::extend joins them.
+DataSet DataSet::load_from_csv_directory(const std::string& directory, size_t threads) {
+    struct Shard {
+        std::vector<std::string> columns;
+        std::vector<Column> data;
+    };
+    
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    CrawlOptions options;
+    options.extensions = {".csv"};
+    DirectoryCrawler crawler(options);
+    
+    std::mutex mutex;
+    std::vector<std::pair<std::string, std::future<Shard>>> parts;
+    ThreadPool pool(threads);
+    crawler.crawl(directory, [&](const CrawlEntry& file) {
+        auto job = std::make_shared<std::packaged_task<Shard()>>([path = file.path] {
+            MappedFile mapped(path);
+            std::string_view body = mapped.view();
+            Shard shard;
+            shard.columns = Csv::read_header(body);
+            shard.data = Csv::parse_rows(body, Csv::infer_types(body, shard.columns.size()));
+            return shard;
+        });
+        std::lock_guard<std::mutex> lock(mutex);
+        parts.emplace_back(file.path, job->get_future());
+        pool.enqueue(std::make_shared<Task<void>>("csv-shard-" + std::to_string(parts.size() - 1),
+                                                  [job] { (*job)(); }));
+    }, pool);
+    
+    std::sort(parts.begin(), parts.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    // Stitch the shards together in path order; empty files are skipped
+    std::vector<std::string> columns;
+    std::vector<Column> data;
+    std::string first;
+    for (auto& [path, part] : parts) {
+        Shard shard = part.get();
+        if (shard.columns.empty()) continue;
+        if (first.empty()) {
+            first = path;
+            columns = std::move(shard.columns);
+            data = std::move(shard.data);
+            continue;
+        }
+        if (shard.columns != columns) {
+            throw std::runtime_error("CSV shard " + path + " has a different header than " + first);
+        }
+        for (size_t c = 0; c < data.size(); ++c) {
+            data[c].extend(std::move(shard.data[c]));
+        }
+    }
+    if (first.empty()) {
+        return DataSet();
+    }
+    return DataSet(std::move(columns), std::move(data));
+}
+
+} // namespace DataProcessing
@@ -0,0 +1,91 @@
+/*
+ * Data Processing Pipeline - CSV Reader
+ * 
+ * Zero-copy CSV loading: the input file is memory-mapped and tokenized in
+ * place with std::string_view, numbers are parsed with std::from_chars and
+ * each column gets one type inferred from a sample of rows instead of
+ * probing every cell with exceptions.
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+#include <string_view>
+
+namespace DataProcessing {
+
+// Read-only view of a whole file, memory-mapped when possible
+class MappedFile {
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string fallback_;   // used when the file cannot be mapped
+    
+public:
+    // Unopened (empty view) until open() is called
+    MappedFile() = default;
+    // Throws std::runtime_error when the file cannot be opened
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    
+    // Map (or read) filename into this unopened MappedFile
+    Result<void> open(const std::string& filename);
+    
+    std::string_view view() const { return std::string_view(data_, size_); }
+    size_t size() const { return size_; }
+    
+    // Disable copy and move (the view points into this object)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+};
+
+namespace Csv {
+    // Number of data rows used to infer column types
+    constexpr size_t TYPE_SAMPLE_ROWS = 1024;
+    
+    // A String column whose sample has at least DICTIONARY_MIN_CELLS values,
+    // no more than one in DICTIONARY_MAX_DISTINCT_RATIO of them distinct,
+    // is loaded dictionary-encoded
+    constexpr size_t DICTIONARY_MIN_CELLS = 16;
+    constexpr size_t DICTIONARY_MAX_DISTINCT_RATIO = 4;
+    
+    // Smallest byte range worth handing to a separate reader thread
+    constexpr size_t PARALLEL_MIN_CHUNK_BYTES = 1 << 20;
+    
+    std::string_view trim(std::string_view text);
+    
+    // Pop the next line off the front of `text` (without the '\n')
+    std::string_view next_line(std::string_view& text);
+    
+    // Split a line into trimmed fields, reusing the caller's buffer
+    void split_line(std::string_view line, std::vector<std::string_view>& fields);
+    
+    // Pop and split the header line off the front of body
+    std::vector<std::string> read_header(std::string_view& body);
+    
+    // A whole cell as a number with std::from_chars: NotANumber for text
+    // (including "nan" and "inf", which stay strings), NumberOutOfRange for
+    // a number that does not fit
+    ParseResult<int64_t> try_parse_int(std::string_view cell);
+    ParseResult<double> try_parse_double(std::string_view cell);
+    
+    // Type a single cell: int, then double, otherwise string (never throws)
+    DataValue parse_cell(std::string_view cell);
+    
+    // Infer one ColumnType per column from the first `sample_rows` lines of body;
+    // low-cardinality text columns come back as ColumnType::Dictionary
+    std::vector<ColumnType> infer_types(std::string_view body, size_t column_count,
+                                        size_t sample_rows = TYPE_SAMPLE_ROWS);
+                                        
+    // Parse every line of body into columns of the given types, allocated with alloc
+    std::vector<Column> parse_rows(std::string_view body, const std::vector<ColumnType>& types,
+                                   Column::Allocator alloc = {});
+    
+    // Cut body into at most `count` byte ranges that each end on a line boundary
+    std::vector<std::string_view> split_chunks(std::string_view body, size_t count);
+}
+
+} // namespace DataProcessing
@@ -6,50 +6,83 @@
  */
 
 #include "data_processor.hpp"
+#include "csv_reader.hpp"
+#include "simd_kernels.hpp"
+#include "expressions.hpp"
 #include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <stdexcept>
 
 namespace DataProcessing {
 
+std::string Error::message() const {
+    switch (code) {
+        case ErrorCode::NotANumber:       return "Not a number: " + subject;
+        case ErrorCode::NumberOutOfRange: return "Number out of range: " + subject;
+        case ErrorCode::ColumnNotFound:   return "Column not found: " + subject;
+        case ErrorCode::CannotOpenFile:   return "Cannot open file: " + subject;
+    }
+    return subject;
+}
+
 // ValueOps implementations
 namespace ValueOps {
+    ParseResult<double> try_to_double(const DataValue& value) {
+        switch (value.kind()) {
+            case DataValue::Kind::Int:    return static_cast<double>(value.as_int());
+            case DataValue::Kind::Double: return value.as_double();
+            case DataValue::Kind::String: return Csv::try_parse_double(Csv::trim(value.as_string()));
+            case DataValue::Kind::Null:   break;
+        }
+        return stdx::unexpected(ErrorCode::NotANumber);
+    }
+    
     double to_double(const DataValue& value) {
-        return std::visit([](const auto& v) -> double {
-            if constexpr (std::is_same_v<std::decay_t<decltype(v)>, int>) {
-                return static_cast<double>(v);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(v)>, double>) {
-                return v;
-            } else {
-                try {
-                    return std::stod(v);
-                } catch (...) {
-                    return 0.0;
-                }
+        return try_to_double(value).value_or(0.0);
+    }
+    
+    std::string_view text_of(const DataValue& value, TextBuffer& buffer) {
+        switch (value.kind()) {
+            case DataValue::Kind::Int: {
+                auto end = std::to_chars(buffer.data, buffer.data + sizeof(buffer.data), value.as_int()).ptr;
+                return std::string_view(buffer.data, static_cast<size_t>(end - buffer.data));
+            }
+            case DataValue::Kind::Double: {
+                // The format std::to_string uses
+                int length = std::snprintf(buffer.data, sizeof(buffer.data), "%f", value.as_double());
+                return std::string_view(buffer.data, static_cast<size_t>(length));
             }
-        }, value);
+            case DataValue::Kind::String:
+                return value.as_string();
+            case DataValue::Kind::Null:
+                break;
+        }
+        return {};
     }
     
     std::string to_string(const DataValue& value) {
-        return std::visit([](const auto& v) -> std::string {
-            if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>) {
-                return v;
-            } else {
-                return std::to_string(v);
-            }
-        }, value);
+        TextBuffer buffer;
+        return std::string(text_of(value, buffer));
+    }
+    
+    void append_to(std::string& out, const DataValue& value) {
+        TextBuffer buffer;
+        out.append(text_of(value, buffer));
     }
     
     bool is_numeric(const DataValue& value) {
-        return std::holds_alternative<int>(value) || std::holds_alternative<double>(value);
+        return value.is_numeric();
     }
     
     DataValue add(const DataValue& a, const DataValue& b) {
         if (is_numeric(a) && is_numeric(b)) {
             return to_double(a) + to_double(b);
         }
-        return to_string(a) + to_string(b);
+        TextBuffer a_buffer, b_buffer;
+        return DataValue::concat(text_of(a, a_buffer), text_of(b, b_buffer));
     }
     
     DataValue multiply(const DataValue& a, const DataValue& b) {
@@ -59,45 +92,625 @@ namespace ValueOps {
         throw std::invalid_argument("Cannot multiply non-numeric values");
     }
     
+    DataValue multiply_add(const DataValue& a, const DataValue& b, const DataValue& c) {
+        if (is_numeric(a) && is_numeric(b) && is_numeric(c)) {
+            double product = to_double(a) * to_double(b);
+            return product + to_double(c);
+        }
+        return add(multiply(a, b), c);
+    }
+    
     bool compare_less(const DataValue& a, const DataValue& b) {
         if (is_numeric(a) && is_numeric(b)) {
             return to_double(a) < to_double(b);
         }
-        return to_string(a) < to_string(b);
+        TextBuffer a_buffer, b_buffer;
+        return text_of(a, a_buffer) < text_of(b, b_buffer);
+    }
+}
+
+// StringDictionary implementations
+uint32_t StringDictionary::intern(std::string_view value) {
+    auto it = codes_.find(value);
+    if (it != codes_.end()) {
+        return it->second;
+    }
+    if (values_.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Dictionary is full");
+    }
+    uint32_t code = static_cast<uint32_t>(values_.size());
+    values_.emplace_back(value);
+    codes_.try_emplace(values_.back(), code);
+    return code;
+}
+
+std::optional<uint32_t> StringDictionary::find(std::string_view value) const {
+    auto it = codes_.find(value);
+    if (it == codes_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<uint8_t> StringDictionary::matches(const std::function<bool(const DataValue&)>& predicate) const {
+    std::vector<uint8_t> result(values_.size());
+    for (size_t code = 0; code < values_.size(); ++code) {
+        result[code] = predicate(values_[code]) ? 1 : 0;
+    }
+    return result;
+}
+
+std::vector<uint32_t> StringDictionary::sort_ranks() const {
+    std::vector<uint32_t> order(values_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return values_[a] < values_[b]; });
+    
+    std::vector<uint32_t> ranks(values_.size());
+    for (uint32_t rank = 0; rank < order.size(); ++rank) {
+        ranks[order[rank]] = rank;
+    }
+    return ranks;
+}
+
+// MonotonicArena implementations
+MonotonicArena::MonotonicArena(size_t initial_chunk_size, std::pmr::memory_resource* upstream)
+    : upstream_(upstream), next_chunk_size_(std::max(initial_chunk_size, sizeof(Chunk) * 2)) {}
+
+void MonotonicArena::add_chunk(size_t bytes, size_t alignment) {
+    size_t size = std::max(next_chunk_size_, sizeof(Chunk) + bytes + alignment);
+    Chunk* chunk = static_cast<Chunk*>(upstream_->allocate(size, alignof(std::max_align_t)));
+    chunk->next = chunks_;
+    chunk->size = size;
+    chunks_ = chunk;
+    
+    cursor_ = reinterpret_cast<char*>(chunk + 1);
+    remaining_ = size - sizeof(Chunk);
+    bytes_reserved_ += size;
+    next_chunk_size_ = size * 2;
+}
+
+void* MonotonicArena::do_allocate(size_t bytes, size_t alignment) {
+    void* ptr = cursor_;
+    size_t space = remaining_;
+    if (!cursor_ || !std::align(alignment, bytes, ptr, space)) {
+        add_chunk(bytes, alignment);
+        ptr = cursor_;
+        space = remaining_;
+        std::align(alignment, bytes, ptr, space);   // fits: the chunk has room for the padding
+    }
+    cursor_ = static_cast<char*>(ptr) + bytes;
+    remaining_ = space - bytes;
+    bytes_allocated_ += bytes;
+    return ptr;
+}
+
+void MonotonicArena::release() {
+    while (chunks_) {
+        Chunk* next = chunks_->next;
+        upstream_->deallocate(chunks_, chunks_->size, alignof(std::max_align_t));
+        chunks_ = next;
+    }
+    cursor_ = nullptr;
+    remaining_ = 0;
+    bytes_allocated_ = 0;
+    bytes_reserved_ = 0;
+}
+
+void MonotonicArena::reset() {
+    if (!chunks_) return;
+    
+    // The newest chunk is the largest: keep it and free the rest
+    Chunk* keep = chunks_;
+    chunks_ = keep->next;
+    size_t kept_size = keep->size;
+    release();
+    
+    keep->next = nullptr;
+    chunks_ = keep;
+    cursor_ = reinterpret_cast<char*>(keep + 1);
+    remaining_ = kept_size - sizeof(Chunk);
+    bytes_reserved_ = kept_size;
+}
+
+uint32_t DictionaryColumn::code_of(std::string_view value) {
+    if (dictionary.use_count() > 1) {
+        if (auto code = dictionary->find(value)) {
+            return *code;
+        }
+        dictionary = std::make_shared<StringDictionary>(*dictionary);   // copy on write
+    }
+    return dictionary->intern(value);
+}
+
+// Column implementations
+namespace {
+    // Null cells only fit a Mixed column
+    ColumnType column_type_of(const DataValue& value) {
+        switch (value.kind()) {
+            case DataValue::Kind::Int:    return ColumnType::Int64;
+            case DataValue::Kind::Double: return ColumnType::Double;
+            case DataValue::Kind::String: return ColumnType::String;
+            case DataValue::Kind::Null:   break;
+        }
+        return ColumnType::Mixed;
+    }
+    
+    Column::Storage make_storage(ColumnType type, Column::Allocator alloc) {
+        switch (type) {
+            case ColumnType::Int64:      return std::pmr::vector<int64_t>(alloc);
+            case ColumnType::Double:     return std::pmr::vector<double>(alloc);
+            case ColumnType::String:     return std::pmr::vector<std::pmr::string>(alloc);
+            case ColumnType::Dictionary: return DictionaryColumn(alloc);
+            case ColumnType::Mixed:      break;
+        }
+        return std::pmr::vector<DataValue>(alloc);
+    }
+    
+    template<typename T>
+    constexpr bool is_dictionary = std::is_same_v<std::decay_t<T>, DictionaryColumn>;
+}
+
+Column::Column(Allocator alloc) : data_(std::in_place_index<0>, alloc) {}
+
+Column::Column(ColumnType type, Allocator alloc) : data_(make_storage(type, alloc)), typed_(true) {}
+
+Column::Column(Storage data) : data_(std::move(data)), typed_(true) {}
+
+Column::Allocator Column::get_allocator() const {
+    return std::visit([](const auto& values) -> Allocator {
+        if constexpr (is_dictionary<decltype(values)>) {
+            return values.codes.get_allocator();
+        } else {
+            return values.get_allocator();
+        }
+    }, data_);
+}
+
+Column Column::repeat(const DataValue& value, size_t count) {
+    Column column(column_type_of(value));
+    column.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        column.append(value);
+    }
+    return column;
+}
+
+size_t Column::size() const {
+    return std::visit([](const auto& values) {
+        if constexpr (is_dictionary<decltype(values)>) {
+            return values.codes.size();
+        } else {
+            return values.size();
+        }
+    }, data_);
+}
+
+size_t Column::cell_bytes() const {
+    return std::visit([](const auto& values) {
+        if constexpr (is_dictionary<decltype(values)>) {
+            return values.codes.size() * sizeof(values.codes[0]);
+        } else {
+            return values.size() * sizeof(values[0]);
+        }
+    }, data_);
+}
+
+void Column::reserve(size_t capacity) {
+    std::visit([capacity](auto& values) {
+        if constexpr (is_dictionary<decltype(values)>) {
+            values.codes.reserve(capacity);
+        } else {
+            values.reserve(capacity);
+        }
+    }, data_);
+}
+
+void Column::make_mixed() {
+    if (type() == ColumnType::Mixed) return;
+    std::vector<DataValue> cells = to_values();
+    std::pmr::vector<DataValue> mixed(get_allocator());
+    mixed.assign(std::make_move_iterator(cells.begin()), std::make_move_iterator(cells.end()));
+    data_ = std::move(mixed);
+}
+
+bool Column::accepts(const DataValue& value) const {
+    ColumnType value_type = column_type_of(value);
+    return type() == ColumnType::Mixed || type() == value_type ||
+           (type() == ColumnType::Dictionary && value_type == ColumnType::String);
+}
+
+DataValue Column::get(size_t row) const {
+    return std::visit([row](const auto& values) -> DataValue {
+        if constexpr (is_dictionary<decltype(values)>) {
+            return values.at(row);
+        } else {
+            return values[row];
+        }
+    }, data_);
+}
+
+std::optional<double> Column::numeric_at(size_t row) const {
+    switch (type()) {
+        case ColumnType::Int64:      return static_cast<double>(ints()[row]);
+        case ColumnType::Double:     return doubles()[row];
+        case ColumnType::String:
+        case ColumnType::Dictionary: return std::nullopt;
+        case ColumnType::Mixed:      break;
+    }
+    const DataValue& value = values()[row];
+    if (!ValueOps::is_numeric(value)) return std::nullopt;
+    return ValueOps::to_double(value);
+}
+
+void Column::set(size_t row, const DataValue& value) {
+    if (!accepts(value)) {
+        make_mixed();
+    }
+    std::visit([&](auto& values) {
+        if constexpr (is_dictionary<decltype(values)>) {
+            values.codes[row] = values.code_of(value.as_string());
+        } else {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            if constexpr (std::is_same_v<T, DataValue>) {
+                values[row] = value;
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                values[row] = value.as_int();
+            } else if constexpr (std::is_same_v<T, std::pmr::string>) {
+                values[row] = value.as_string();
+            } else {
+                values[row] = value.as_double();
+            }
+        }
+    }, data_);
+}
+
+void Column::append_int64(int64_t value) {
+    if (!typed_ || type() == ColumnType::Int64) {
+        if (!typed_) *this = Column(ColumnType::Int64, get_allocator());
+        std::get<std::pmr::vector<int64_t>>(data_).push_back(value);
+    } else {
+        append(value);
+    }
+}
+
+void Column::append_double(double value) {
+    if (!typed_ || type() == ColumnType::Double) {
+        if (!typed_) *this = Column(ColumnType::Double, get_allocator());
+        std::get<std::pmr::vector<double>>(data_).push_back(value);
+    } else {
+        append(value);
+    }
+}
+
+void Column::append_string(std::string_view value) {
+    if (type() == ColumnType::Dictionary && typed_) {
+        std::get<DictionaryColumn>(data_).append(value);
+    } else if (!typed_ || type() == ColumnType::String) {
+        if (!typed_) *this = Column(ColumnType::String, get_allocator());
+        std::get<std::pmr::vector<std::pmr::string>>(data_).emplace_back(value);
+    } else {
+        append(DataValue(value));
+    }
+}
+
+void Column::append(const DataValue& value) {
+    if (!typed_) {
+        data_ = make_storage(column_type_of(value), get_allocator());
+        typed_ = true;
+    } else if (!accepts(value)) {
+        make_mixed();
+    }
+    std::visit([&](auto& values) {
+        if constexpr (is_dictionary<decltype(values)>) {
+            values.append(value.as_string());
+        } else {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            if constexpr (std::is_same_v<T, DataValue>) {
+                values.push_back(value);
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                values.push_back(value.as_int());
+            } else if constexpr (std::is_same_v<T, std::pmr::string>) {
+                values.emplace_back(value.as_string());
+            } else {
+                values.push_back(value.as_double());
+            }
+        }
+    }, data_);
+}
+
+void Column::extend(Column other) {
+    if (!other.typed_ || other.empty()) return;
+    if (!typed_ || empty()) {
+        *this = std::move(other);
+        return;
+    }
+    
+    // Plain and dictionary-encoded strings mix without leaving the text types
+    if (is_text() && other.is_text() && type() != other.type()) {
+        if (type() == ColumnType::Dictionary) {
+            other.encode_dictionary();
+        } else {
+            other.decode_dictionary();
+        }
     }
+    if (type() != other.type()) {
+        make_mixed();
+        other.make_mixed();
+    }
+    
+    std::visit([&other](auto& values) {
+        auto& source = std::get<std::decay_t<decltype(values)>>(other.data_);
+        if constexpr (is_dictionary<decltype(values)>) {
+            if (source.dictionary == values.dictionary) {
+                values.codes.insert(values.codes.end(), source.codes.begin(), source.codes.end());
+            } else {
+                // Re-code through a table built once per distinct value
+                std::vector<uint32_t> remap(source.dictionary->size());
+                for (size_t code = 0; code < remap.size(); ++code) {
+                    remap[code] = values.code_of((*source.dictionary)[static_cast<uint32_t>(code)]);
+                }
+                values.codes.reserve(values.codes.size() + source.codes.size());
+                for (uint32_t code : source.codes) {
+                    values.codes.push_back(remap[code]);
+                }
+            }
+        } else {
+            values.insert(values.end(),
+                          std::make_move_iterator(source.begin()),
+                          std::make_move_iterator(source.end()));
+        }
+    }, data_);
+}
+
+Column Column::take(const std::vector<size_t>& rows, Allocator alloc) const {
+    Column result;
+    result.typed_ = typed_;
+    result.data_ = std::visit([&rows, alloc](const auto& values) -> Storage {
+        if constexpr (is_dictionary<decltype(values)>) {
+            DictionaryColumn selected(values.dictionary, std::pmr::vector<uint32_t>(alloc));
+            selected.codes.reserve(rows.size());
+            for (size_t row : rows) {
+                selected.codes.push_back(values.codes[row]);
+            }
+            return selected;
+        } else {
+            std::decay_t<decltype(values)> selected(alloc);
+            selected.reserve(rows.size());
+            for (size_t row : rows) {
+                selected.push_back(values[row]);
+            }
+            return selected;
+        }
+    }, data_);
+    return result;
+}
+
+Column Column::slice(size_t begin, size_t end, Allocator alloc) const {
+    Column result;
+    result.typed_ = typed_;
+    result.data_ = std::visit([begin, end, alloc](const auto& values) -> Storage {
+        if constexpr (is_dictionary<decltype(values)>) {
+            return DictionaryColumn(values.dictionary, std::pmr::vector<uint32_t>(
+                values.codes.begin() + begin, values.codes.begin() + end, alloc));
+        } else {
+            return std::decay_t<decltype(values)>(values.begin() + begin, values.begin() + end, alloc);
+        }
+    }, data_);
+    return result;
+}
+
+std::vector<DataValue> Column::to_values() const {
+    return std::visit([](const auto& values) {
+        std::vector<DataValue> result;
+        if constexpr (is_dictionary<decltype(values)>) {
+            result.reserve(values.codes.size());
+            for (size_t row = 0; row < values.codes.size(); ++row) {
+                result.push_back(values.at(row));
+            }
+        } else {
+            result.reserve(values.size());
+            for (const auto& value : values) {
+                result.push_back(value);
+            }
+        }
+        return result;
+    }, data_);
+}
+
+void Column::encode_dictionary() {
+    if (type() != ColumnType::String) return;
+    
+    DictionaryColumn encoded(get_allocator());
+    encoded.codes.reserve(strings().size());
+    for (const auto& value : strings()) {
+        encoded.append(value);
+    }
+    data_ = std::move(encoded);
+}
+
+Column Column::dictionary_ranks() const {
+    const DictionaryColumn& encoded = dictionary();
+    std::vector<uint32_t> ranks = encoded.dictionary->sort_ranks();
+    
+    Column result(ColumnType::Int64, get_allocator());
+    result.reserve(encoded.codes.size());
+    for (uint32_t code : encoded.codes) {
+        result.append_int64(ranks[code]);
+    }
+    return result;
+}
+
+void Column::decode_dictionary() {
+    if (type() != ColumnType::Dictionary) return;
+    
+    const DictionaryColumn& encoded = dictionary();
+    std::pmr::vector<std::pmr::string> decoded(get_allocator());
+    decoded.reserve(encoded.codes.size());
+    for (size_t row = 0; row < encoded.codes.size(); ++row) {
+        decoded.emplace_back(encoded.at(row));
+    }
+    data_ = std::move(decoded);
+}
+
+// CellRef implementations
+CellRef& CellRef::operator=(const DataValue& value) {
+    if (detached_) {
+        *detached_ = value;
+    } else if (writable_) {
+        const_cast<DataSet*>(dataset_)->column_at(column_).set(row_, value);
+    } else {
+        throw std::logic_error("Cannot modify a row of a const DataSet");
+    }
+    return *this;
+}
+
+DataValue CellRef::get() const {
+    return detached_ ? *detached_ : dataset_->column_at(column_).get(row_);
+}
+
+// RowOverlay implementations
+RowOverlay::RowOverlay(std::vector<std::string> columns)
+    : columns_(std::move(columns)), values_(columns_.size()), present_(columns_.size(), false) {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        index_[columns_[i]] = i;
+    }
+}
+
+std::optional<size_t> RowOverlay::slot(const std::string& column) const {
+    auto it = index_.find(column);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const DataValue* RowOverlay::find(const std::string& column) const {
+    auto it = index_.find(column);
+    if (it == index_.end() || !present_[it->second]) {
+        return nullptr;
+    }
+    return &values_[it->second];
+}
+
+void RowOverlay::set(size_t slot, DataValue value) {
+    values_[slot] = std::move(value);
+    present_[slot] = true;
 }
 
 // DataRecord implementations
-const DataValue& DataRecord::operator[](const std::string& column) const {
+CellRef DataRecord::operator[](const std::string& column) {
+    if (!dataset_) {
+        return CellRef(data_[column]);
+    }
+    if (writable_ && !dataset_->has_column(column)) {
+        const_cast<DataSet*>(dataset_)->add_column(column);
+    }
+    auto index = dataset_->find_column(column);
+    if (!index) {
+        throw std::out_of_range("Column not found: " + column);
+    }
+    return CellRef(*dataset_, *index, row_, writable_);
+}
+
+DataValue DataRecord::operator[](const std::string& column) const {
+    Result<DataValue> value = try_get(column);
+    if (!value) {
+        throw std::out_of_range(value.error().message());
+    }
+    return *std::move(value);
+}
+
+Result<DataValue> DataRecord::try_get(const std::string& column) const {
+    if (dataset_) {
+        if (overlay_) {
+            if (const DataValue* pending = overlay_->find(column)) {
+                return *pending;
+            }
+        }
+        auto index = dataset_->find_column(column);
+        if (!index) {
+            return stdx::unexpected(Error{ErrorCode::ColumnNotFound, column});
+        }
+        return dataset_->column_at(*index).get(row_);
+    }
     auto it = data_.find(column);
     if (it == data_.end()) {
-        throw std::out_of_range("Column not found: " + column);
+        return stdx::unexpected(Error{ErrorCode::ColumnNotFound, column});
     }
     return it->second;
 }
 
 bool DataRecord::has_column(const std::string& column) const {
+    if (dataset_) {
+        return dataset_->has_column(column) || (overlay_ && overlay_->find(column));
+    }
     return data_.find(column) != data_.end();
 }
 
 std::vector<std::string> DataRecord::get_columns() const {
     std::vector<std::string> columns;
-    columns.reserve(data_.size());
-    for (const auto& [key, value] : data_) {
-        columns.push_back(key);
+    if (dataset_) {
+        columns = dataset_->get_columns();
+        if (overlay_) {
+            for (const auto& column : overlay_->get_columns()) {
+                if (overlay_->find(column) && !dataset_->has_column(column)) {
+                    columns.push_back(column);
+                }
+            }
+        }
+    } else {
+        columns.reserve(data_.size());
+        for (const auto& [key, value] : data_) {
+            columns.push_back(key);
+        }
     }
     std::sort(columns.begin(), columns.end());
     return columns;
 }
 
+size_t DataRecord::size() const {
+    if (overlay_) {
+        return get_columns().size();
+    }
+    return dataset_ ? dataset_->get_columns().size() : data_.size();
+}
+
+DataRow DataRecord::to_row() const {
+    if (!dataset_) {
+        return data_;
+    }
+    DataRow row;
+    const auto& columns = dataset_->get_columns();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        row[columns[i]] = dataset_->column_at(i).get(row_);
+    }
+    if (overlay_) {
+        for (const auto& column : overlay_->get_columns()) {
+            if (const DataValue* pending = overlay_->find(column)) {
+                row[column] = *pending;
+            }
+        }
+    }
+    return row;
+}
+
 std::string DataRecord::to_string() const {
     std::ostringstream oss;
     oss << "{";
     bool first = true;
-    for (const auto& [key, value] : data_) {
-        if (!first) oss << ", ";
-        oss << key << ": " << ValueOps::to_string(value);
-        first = false;
+    if (dataset_ && !overlay_) {
+        const auto& columns = dataset_->get_columns();
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (!first) oss << ", ";
+            oss << columns[i] << ": " << ValueOps::to_string(dataset_->column_at(i).get(row_));
+            first = false;
+        }
+    } else {
+        for (const auto& [key, value] : to_row()) {
+            if (!first) oss << ", ";
+            oss << key << ": " << ValueOps::to_string(value);
+            first = false;
+        }
     }
     oss << "}";
     return oss.str();
@@ -108,79 +721,250 @@ std::ostream& operator<<(std::ostream& os, const DataRecord& record) {
 }
 
 // DataSet implementations
-void DataSet::add_record(DataRecord record) {
-    // Ensure all columns exist
-    for (const auto& column : columns_) {
-        if (!record.has_column(column)) {
-            record[column] = std::string(""); // Default empty value
+DataSet::DataSet(std::vector<std::string> columns) {
+    for (auto& name : columns) {
+        add_column(name);
+    }
+}
+
+DataSet::DataSet(std::vector<std::string> columns, std::vector<Column> data) {
+    if (columns.size() != data.size()) {
+        throw std::invalid_argument("Column names and buffers differ in count");
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        set_column(columns[i], std::move(data[i]));
+    }
+}
+
+void DataSet::add_record(const DataRecord& record) {
+    // Columns the record carries but the set lacks become new columns
+    for (const auto& column : record.get_columns()) {
+        if (!has_column(column)) {
+            add_column(column);
+        }
+    }
+    
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (record.has_column(columns_[i])) {
+            data_[i].append(record[columns_[i]]);
+        } else {
+            data_[i].append(std::string("")); // Default empty value
         }
     }
-    records_.push_back(std::move(record));
+    ++rows_;
+}
+
+void DataSet::reserve(size_t capacity) {
+    for (auto& column : data_) {
+        column.reserve(capacity);
+    }
+}
+
+size_t DataSet::cell_bytes() const {
+    size_t bytes = 0;
+    for (const auto& column : data_) {
+        bytes += column.cell_bytes();
+    }
+    return bytes;
 }
 
 void DataSet::add_column(const std::string& name) {
-    if (std::find(columns_.begin(), columns_.end(), name) == columns_.end()) {
+    if (!has_column(name)) {
+        column_index_[name] = columns_.size();
         columns_.push_back(name);
         
         // Add empty values to existing records
-        for (auto& record : records_) {
-            if (!record.has_column(name)) {
-                record[name] = std::string("");
-            }
-        }
+        data_.push_back(Column::repeat(std::string(""), rows_));
     }
 }
 
 bool DataSet::has_column(const std::string& name) const {
-    return std::find(columns_.begin(), columns_.end(), name) != columns_.end();
+    return column_index_.find(name) != column_index_.end();
+}
+
+std::optional<size_t> DataSet::find_column(const std::string& name) const {
+    auto it = column_index_.find(name);
+    if (it == column_index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const Column& DataSet::column(const std::string& name) const {
+    auto index = find_column(name);
+    if (!index) {
+        throw std::invalid_argument("Column not found: " + name);
+    }
+    return data_[*index];
+}
+
+void DataSet::set_column(const std::string& name, Column values) {
+    if (!columns_.empty() && values.size() != rows_) {
+        throw std::invalid_argument("Column size mismatch: " + name);
+    }
+    if (columns_.empty()) {
+        rows_ = values.size();
+    }
+    
+    if (auto index = find_column(name)) {
+        data_[*index] = std::move(values);
+    } else {
+        column_index_[name] = columns_.size();
+        columns_.push_back(name);
+        data_.push_back(std::move(values));
+    }
+}
+
+void DataSet::encode_dictionary(const std::string& name) {
+    auto index = find_column(name);
+    if (!index) {
+        throw std::invalid_argument("Column not found: " + name);
+    }
+    data_[*index].encode_dictionary();
+}
+
+namespace {
+    // Per-code outcome of a single-column predicate over a dictionary column
+    // of input, which is then evaluated once per distinct value rather than
+    // once per row. Empty when the predicate or the column does not qualify.
+    std::vector<uint8_t> dictionary_matches(const DataSet& input, const FilterPredicate& predicate) {
+        const auto* known = predicate.target<Filters::ColumnPredicate>();
+        if (!known || !known->cell || known->columns.size() != 1 || !input.has_column(known->columns[0])) {
+            return {};
+        }
+        const Column& column = input.column(known->columns[0]);
+        if (column.type() != ColumnType::Dictionary) {
+            return {};
+        }
+        return column.dictionary().dictionary->matches(known->cell);
+    }
 }
 
 DataSet DataSet::filter(FilterPredicate predicate) const {
-    DataSet result(columns_);
-    result.reserve(records_.size() / 2); // Reasonable initial capacity
+    return take(select_rows(predicate, 0, rows_));
+}
+
+std::vector<size_t> DataSet::select_rows(const FilterPredicate& predicate, size_t begin, size_t end) const {
+    std::vector<size_t> selected;
+    selected.reserve((end - begin) / 2); // Reasonable initial capacity
+    
+    if (auto expression = Filters::expression_of(predicate)) {
+        Expressions::CompiledFilter compiled(*expression, *this);
+        std::vector<size_t> batch;
+        for (size_t first = begin; first < end; first += Expressions::batch_rows) {
+            batch.resize(std::min(Expressions::batch_rows, end - first));
+            std::iota(batch.begin(), batch.end(), first);
+            compiled.refine(batch);
+            selected.insert(selected.end(), batch.begin(), batch.end());
+        }
+        return selected;
+    }
     
-    std::copy_if(records_.begin(), records_.end(), 
-                 std::back_inserter(result.records_), predicate);
+    std::vector<uint8_t> matches = dictionary_matches(*this, predicate);
+    if (!matches.empty()) {
+        const auto& codes = column(predicate.target<Filters::ColumnPredicate>()->columns[0]).dictionary().codes;
+        for (size_t row = begin; row < end; ++row) {
+            if (matches[codes[row]]) selected.push_back(row);
+        }
+        return selected;
+    }
+    
+    for (size_t row = begin; row < end; ++row) {
+        if (predicate(DataRecord(*this, row))) {
+            selected.push_back(row);
+        }
+    }
+    
+    return selected;
+}
+
+DataSet DataSet::take(const std::vector<size_t>& rows, Column::Allocator alloc) const {
+    DataSet result;
+    result.columns_ = columns_;
+    result.column_index_ = column_index_;
+    result.rows_ = rows.size();
+    result.data_.reserve(data_.size());
+    
+    for (const auto& column : data_) {
+        result.data_.push_back(column.take(rows, alloc));
+    }
     
     return result;
 }
 
-void DataSet::transform_column(const std::string& column, TransformFunction func) {
-    if (!has_column(column)) {
-        throw std::invalid_argument("Column not found: " + column);
+DataSet DataSet::slice(size_t begin, size_t end, Column::Allocator alloc) const {
+    end = std::min(end, rows_);
+    begin = std::min(begin, end);
+    
+    DataSet result;
+    result.columns_ = columns_;
+    result.column_index_ = column_index_;
+    result.rows_ = end - begin;
+    result.data_.reserve(data_.size());
+    
+    for (const auto& column : data_) {
+        result.data_.push_back(column.slice(begin, end, alloc));
     }
     
-    std::for_each(records_.begin(), records_.end(), 
-                  [&](DataRecord& record) {
-                      record[column] = func(record[column]);
-                  });
+    return result;
 }
 
-void DataSet::sort_by_column(const std::string& column, bool ascending) {
-    if (!has_column(column)) {
-        throw std::invalid_argument("Column not found: " + column);
+DataSet DataSet::select(const std::vector<std::string>& columns, Column::Allocator alloc) const {
+    std::vector<Column> data;
+    data.reserve(columns.size());
+    for (const auto& name : columns) {
+        data.push_back(column(name).slice(0, rows_, alloc));
     }
     
-    std::sort(records_.begin(), records_.end(), 
-              [&](const DataRecord& a, const DataRecord& b) {
-                  bool less = ValueOps::compare_less(a[column], b[column]);
-                  return ascending ? less : !less;
-              });
+    DataSet result(columns, std::move(data));
+    result.rows_ = rows_;   // keeps the row count when no columns are selected
+    return result;
 }
 
-DataValue DataSet::aggregate_column(const std::string& column, AggregateFunction func) const {
-    if (!has_column(column)) {
-        throw std::invalid_argument("Column not found: " + column);
+void DataSet::append(DataSet other) {
+    if (columns_.empty()) {
+        *this = std::move(other);
+        return;
+    }
+    if (other.columns_ != columns_) {
+        throw std::invalid_argument("Cannot append a DataSet with different columns");
     }
     
-    std::vector<DataValue> values;
-    values.reserve(records_.size());
+    for (size_t i = 0; i < data_.size(); ++i) {
+        data_[i].extend(std::move(other.data_[i]));
+    }
+    rows_ += other.rows_;
+}
+
+void DataSet::transform_column(const std::string& column, TransformFunction func) {
+    const Column& source = this->column(column);
+    
+    if (const auto* numeric = func.target<Expressions::NumericTransform>()) {
+        if (auto compiled = Expressions::CompiledArithmetic::compile(*numeric->node, *this, &source)) {
+            std::pmr::vector<double> values(rows_);
+            compiled->evaluate(0, rows_, values.data());
+            data_[*find_column(column)] = Column(std::move(values));
+            return;
+        }
+    }
     
-    std::transform(records_.begin(), records_.end(), 
-                   std::back_inserter(values),
-                   [&](const DataRecord& record) { return record[column]; });
+    Column transformed;
+    transformed.reserve(rows_);
+    for (size_t row = 0; row < rows_; ++row) {
+        transformed.append(func(source.get(row)));
+    }
+    
+    data_[*find_column(column)] = std::move(transformed);
+}
+
+DataValue DataSet::aggregate_column(const std::string& column, AggregateFunction func) const {
+    const Column& values = this->column(column);
     
-    return func(values);
+    // Built-in aggregates over numeric buffers skip the DataValue copies
+    if (const auto* builtin = func.target<Aggregates::Builtin>(); builtin && values.is_numeric()) {
+        return builtin->on_column(values);
+    }
+    return func(values.to_values());
 }
 
 std::unordered_map<std::string, DataValue> DataSet::group_by_aggregate(
@@ -192,142 +976,249 @@ std::unordered_map<std::string, DataValue> DataSet::group_by_aggregate(
         throw std::invalid_argument("Column not found");
     }
     
-    std::unordered_map<std::string, std::vector<DataValue>> groups;
+    const Column& keys = column(group_column);
+    const Column& values = column(value_column);
+    
+    // Built-in aggregates run on the hash aggregation engine without
+    // buffering each group's values. Only Int64 and String keys take this
+    // path: their typed equality is exactly equality of the key text.
+    const auto* builtin = func.target<Aggregates::Builtin>();
+    if (builtin && (keys.type() == ColumnType::Int64 || keys.is_text())) {
+        std::string name = group_column + "_" + Aggregates::kind_name(builtin->kind);
+        DataSet grouped = group_by({group_column}, {{value_column, builtin->kind, name}});
+        
+        std::unordered_map<std::string, DataValue> result;
+        result.reserve(grouped.size());
+        for (size_t group = 0; group < grouped.size(); ++group) {
+            result[ValueOps::to_string(grouped.column_at(0).get(group))] = grouped.column_at(1).get(group);
+        }
+        return result;
+    }
+    
+    string_flat_hash_map<std::vector<DataValue>> groups;
     
     // Group the data
-    for (const auto& record : records_) {
-        std::string group_key = ValueOps::to_string(record[group_column]);
-        groups[group_key].push_back(record[value_column]);
+    for (size_t row = 0; row < rows_; ++row) {
+        groups[ValueOps::to_string(keys.get(row))].push_back(values.get(row));
     }
     
     // Apply aggregation function to each group
     std::unordered_map<std::string, DataValue> result;
-    for (const auto& [group, values] : groups) {
-        result[group] = func(values);
+    for (const auto& [group, group_values] : groups) {
+        result[group] = func(group_values);
     }
     
     return result;
 }
 
-DataSet DataSet::load_from_csv(const std::string& filename) {
-    std::ifstream file(filename);
+// DataSet::load_from_csv is implemented in csv_reader.cpp, load_columnar and
+// save_columnar in columnar_file.cpp
+
+void DataSet::save_to_csv(const std::string& filename) const {
+    std::ofstream file(filename);
     if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filename);
+        throw std::runtime_error("Cannot create file: " + filename);
     }
     
-    std::string line;
-    std::vector<std::string> columns;
+    write_csv(file);
+}
+
+void DataSet::write_csv(std::ostream& out, bool include_header) const {
+    // Write header
+    if (include_header) {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) out << ",";
+            out << columns_[i];
+        }
+        out << "\n";
+    }
     
-    // Read header
-    if (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string column;
-        while (std::getline(iss, column, ',')) {
-            // Trim whitespace
-            column.erase(0, column.find_first_not_of(" \t\r\n"));
-            column.erase(column.find_last_not_of(" \t\r\n") + 1);
-            columns.push_back(column);
+    // Write data
+    for (size_t row = 0; row < rows_; ++row) {
+        for (size_t i = 0; i < data_.size(); ++i) {
+            if (i > 0) out << ",";
+            out << ValueOps::to_string(data_[i].get(row));
         }
+        out << "\n";
     }
+}
+
+std::string DataSet::to_string(size_t max_rows) const {
+    std::ostringstream oss;
+    oss << "DataSet (" << rows_ << " rows, " << columns_.size() << " columns)\n";
     
-    DataSet dataset(columns);
+    // Print header
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (i > 0) oss << "\t";
+        oss << std::setw(12) << columns_[i];
+    }
+    oss << "\n" << std::string(columns_.size() * 13, '-') << "\n";
     
-    // Read data rows
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string cell;
-        DataRow row;
-        size_t col_index = 0;
-        
-        while (std::getline(iss, cell, ',') && col_index < columns.size()) {
-            // Trim whitespace
-            cell.erase(0, cell.find_first_not_of(" \t\r\n"));
-            cell.erase(cell.find_last_not_of(" \t\r\n") + 1);
-            
-            // Try to parse as number
-            DataValue value;
-            try {
-                if (cell.find('.') != std::string::npos) {
-                    value = std::stod(cell);
-                } else {
-                    value = std::stoi(cell);
-                }
-            } catch (...) {
-                value = cell; // Keep as string
-            }
-            
-            row[columns[col_index]] = value;
-            ++col_index;
+    // Print data rows
+    size_t rows_to_show = std::min(max_rows, rows_);
+    for (size_t i = 0; i < rows_to_show; ++i) {
+        for (size_t j = 0; j < data_.size(); ++j) {
+            if (j > 0) oss << "\t";
+            oss << std::setw(12) << ValueOps::to_string(data_[j].get(i));
         }
-        
-        dataset.add_record(DataRecord(std::move(row)));
+        oss << "\n";
     }
     
-    return dataset;
+    if (rows_ > max_rows) {
+        oss << "... (" << (rows_ - max_rows) << " more rows)\n";
+    }
+    
+    return oss.str();
 }
 
-void DataSet::save_to_csv(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot create file: " + filename);
+std::ostream& operator<<(std::ostream& os, const DataSet& dataset) {
+    return os << dataset.to_string();
+}
+
+// QuantileSketch implementations
+QuantileSketch::QuantileSketch(size_t k) : k_(std::max<size_t>(k, 8)), levels_(1) {}
+
+size_t QuantileSketch::capacity(size_t level) const {
+    // Capacities shrink geometrically (by 2/3) from the top level down
+    size_t depth = levels_.size() - 1 - level;
+    return std::max<size_t>(2, static_cast<size_t>(std::ceil(k_ * std::pow(2.0 / 3.0, depth))));
+}
+
+void QuantileSketch::compress() {
+    while (true) {
+        size_t total_capacity = 0;
+        for (size_t level = 0; level < levels_.size(); ++level) {
+            total_capacity += capacity(level);
+        }
+        if (retained() < total_capacity || !compact_one()) {
+            return;
+        }
     }
-    
-    // Write header
-    for (size_t i = 0; i < columns_.size(); ++i) {
-        if (i > 0) file << ",";
-        file << columns_[i];
+}
+
+bool QuantileSketch::compact_one() {
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        if (levels_[level].size() < capacity(level)) continue;
+        if (level + 1 == levels_.size()) {
+            levels_.emplace_back();
+        }
+        
+        // Sort, promote every other sample of an even-sized prefix (each
+        // promoted sample now stands for two) and keep any odd one out
+        random_state_ ^= random_state_ << 13;
+        random_state_ ^= random_state_ >> 7;
+        random_state_ ^= random_state_ << 17;
+        
+        auto& items = levels_[level];
+        std::sort(items.begin(), items.end());
+        size_t paired = items.size() - items.size() % 2;
+        for (size_t i = random_state_ & 1; i < paired; i += 2) {
+            levels_[level + 1].push_back(items[i]);
+        }
+        items.erase(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(paired));
+        return true;
+    }
+    return false;
+}
+
+void QuantileSketch::add(double value) {
+    levels_[0].push_back(value);
+    ++count_;
+    compress();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.levels_.size() > levels_.size()) {
+        levels_.resize(other.levels_.size());
+    }
+    for (size_t level = 0; level < other.levels_.size(); ++level) {
+        levels_[level].insert(levels_[level].end(), other.levels_[level].begin(),
+                              other.levels_[level].end());
+    }
+    count_ += other.count_;
+    compress();
+}
+
+double QuantileSketch::quantile(double fraction) const {
+    if (count_ == 0) {
+        return 0.0;
     }
-    file << "\n";
     
-    // Write data
-    for (const auto& record : records_) {
-        for (size_t i = 0; i < columns_.size(); ++i) {
-            if (i > 0) file << ",";
-            if (record.has_column(columns_[i])) {
-                file << ValueOps::to_string(record[columns_[i]]);
-            }
+    std::vector<std::pair<double, size_t>> weighted;
+    weighted.reserve(retained());
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        for (double value : levels_[level]) {
+            weighted.emplace_back(value, size_t(1) << level);
         }
-        file << "\n";
     }
-}
-
-std::string DataSet::to_string(size_t max_rows) const {
-    std::ostringstream oss;
-    oss << "DataSet (" << records_.size() << " rows, " << columns_.size() << " columns)\n";
+    std::sort(weighted.begin(), weighted.end());
     
-    // Print header
-    for (size_t i = 0; i < columns_.size(); ++i) {
-        if (i > 0) oss << "\t";
-        oss << std::setw(12) << columns_[i];
-    }
-    oss << "\n" << std::string(columns_.size() * 13, '-') << "\n";
+    size_t total = 0;
+    for (const auto& item : weighted) total += item.second;
+    double target = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total - 1);
     
-    // Print data rows
-    size_t rows_to_show = std::min(max_rows, records_.size());
-    for (size_t i = 0; i < rows_to_show; ++i) {
-        for (size_t j = 0; j < columns_.size(); ++j) {
-            if (j > 0) oss << "\t";
-            if (records_[i].has_column(columns_[j])) {
-                oss << std::setw(12) << ValueOps::to_string(records_[i][columns_[j]]);
-            } else {
-                oss << std::setw(12) << "";
-            }
+    size_t cumulative = 0;
+    for (const auto& [value, weight] : weighted) {
+        cumulative += weight;
+        if (static_cast<double>(cumulative) > target) {
+            return value;
         }
-        oss << "\n";
     }
-    
-    if (records_.size() > max_rows) {
-        oss << "... (" << (records_.size() - max_rows) << " more rows)\n";
+    return weighted.back().first;
+}
+
+size_t QuantileSketch::retained() const {
+    size_t total = 0;
+    for (const auto& level : levels_) {
+        total += level.size();
+    }
+    return total;
+}
+
+// Statistics implementations
+void Statistics::Accumulator::add(double value) {
+    ++count_;
+    double delta = value - mean_;
+    mean_ += delta / count_;
+    m2_ += delta * (value - mean_);
+    
+    // Neumaier's variant of Kahan summation
+    double total = sum_ + value;
+    compensation_ += std::abs(sum_) >= std::abs(value) ? (sum_ - total) + value : (value - total) + sum_;
+    sum_ = total;
+    
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void Statistics::Accumulator::merge(const Accumulator& other) {
+    if (other.count_ == 0) return;
+    if (count_ == 0) {
+        *this = other;
+        return;
     }
     
-    return oss.str();
+    // Chan et al.'s pairwise combination of mean and M2
+    double n = static_cast<double>(count_ + other.count_);
+    double delta = other.mean_ - mean_;
+    mean_ += delta * (other.count_ / n);
+    m2_ += other.m2_ + delta * delta * (static_cast<double>(count_) * other.count_ / n);
+    
+    double total = sum_ + other.sum_;
+    compensation_ += std::abs(sum_) >= std::abs(other.sum_) ? (sum_ - total) + other.sum_
+                                                            : (other.sum_ - total) + sum_;
+    compensation_ += other.compensation_;
+    sum_ = total;
+    
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
 }
 
-std::ostream& operator<<(std::ostream& os, const DataSet& dataset) {
-    return os << dataset.to_string();
+double Statistics::Accumulator::std_dev() const {
+    return std::sqrt(variance());
 }
 
-// Statistics implementations
 std::string Statistics::DescriptiveStats::to_string() const {
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
@@ -336,124 +1227,130 @@ std::string Statistics::DescriptiveStats::to_string() const {
     return oss.str();
 }
 
-Statistics::DescriptiveStats Statistics::calculate(const std::vector<DataValue>& values) {
-    if (values.empty()) {
-        return {0.0, 0.0, 0.0, 0.0, 0.0, 0};
-    }
-    
-    // Convert to doubles and filter numeric values
-    std::vector<double> numeric_values;
-    for (const auto& value : values) {
-        if (ValueOps::is_numeric(value)) {
-            numeric_values.push_back(ValueOps::to_double(value));
+namespace {
+    // Call f(double) for every numeric cell of a column, without copying
+    template<typename F>
+    void for_each_numeric(const Column& column, F&& f) {
+        switch (column.type()) {
+            case ColumnType::Int64:
+                for (int64_t value : column.ints()) f(static_cast<double>(value));
+                break;
+            case ColumnType::Double:
+                for (double value : column.doubles()) f(value);
+                break;
+            case ColumnType::String:
+            case ColumnType::Dictionary:
+                break;
+            case ColumnType::Mixed:
+                for (const auto& value : column.values()) {
+                    if (ValueOps::is_numeric(value)) f(ValueOps::to_double(value));
+                }
+                break;
         }
     }
     
-    if (numeric_values.empty()) {
-        return {0.0, 0.0, 0.0, 0.0, 0.0, 0};
+    // Copy the numeric cells of a column into a plain double buffer
+    std::vector<double> numeric_cells(const Column& column) {
+        std::vector<double> result;
+        result.reserve(column.is_numeric() ? column.size() : 0);
+        for_each_numeric(column, [&result](double value) { result.push_back(value); });
+        return result;
     }
     
-    DescriptiveStats stats;
-    stats.count = numeric_values.size();
-    
-    // Calculate mean
-    stats.mean = std::accumulate(numeric_values.begin(), numeric_values.end(), 0.0) / stats.count;
-    
-    // Calculate min and max
-    auto [min_it, max_it] = std::minmax_element(numeric_values.begin(), numeric_values.end());
-    stats.min_val = *min_it;
-    stats.max_val = *max_it;
-    
-    // Calculate median
-    std::vector<double> sorted_values = numeric_values;
-    std::sort(sorted_values.begin(), sorted_values.end());
-    if (sorted_values.size() % 2 == 0) {
-        stats.median = (sorted_values[sorted_values.size() / 2 - 1] + 
-                       sorted_values[sorted_values.size() / 2]) / 2.0;
-    } else {
-        stats.median = sorted_values[sorted_values.size() / 2];
+    // Interpolated quantile by selection; reorders the buffer
+    double select_quantile(std::vector<double>& values, double fraction) {
+        if (values.empty()) {
+            return 0.0;
+        }
+        double position = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(values.size() - 1);
+        size_t lower = static_cast<size_t>(position);
+        double weight = position - static_cast<double>(lower);
+        
+        auto nth = values.begin() + static_cast<std::ptrdiff_t>(lower);
+        std::nth_element(values.begin(), nth, values.end());
+        if (weight == 0.0) {
+            return *nth;
+        }
+        // Everything after nth is >= it, so the next rank is the minimum there
+        double upper = *std::min_element(nth + 1, values.end());
+        return *nth * (1.0 - weight) + upper * weight;
     }
     
-    // Calculate standard deviation
-    double variance = std::accumulate(numeric_values.begin(), numeric_values.end(), 0.0,
-        [mean = stats.mean](double acc, double val) {
-            return acc + (val - mean) * (val - mean);
-        }) / stats.count;
-    stats.std_dev = std::sqrt(variance);
-    
-    return stats;
-}
-
-Statistics::DescriptiveStats Statistics::calculate_column(const DataSet& dataset, const std::string& column) {
-    if (!dataset.has_column(column)) {
-        throw std::invalid_argument("Column not found: " + column);
+    Statistics::DescriptiveStats describe(const Statistics::Accumulator& accumulator, double median) {
+        return {accumulator.mean(), median, accumulator.std_dev(),
+                accumulator.min(), accumulator.max(), accumulator.count()};
     }
-    
-    std::vector<DataValue> values;
-    values.reserve(dataset.size());
-    
-    std::transform(dataset.begin(), dataset.end(), std::back_inserter(values),
-                   [&](const DataRecord& record) { return record[column]; });
-    
-    return calculate(values);
 }
 
-double Statistics::correlation(const DataSet& dataset, const std::string& col1, const std::string& col2) {
-    if (!dataset.has_column(col1) || !dataset.has_column(col2)) {
-        throw std::invalid_argument("Column not found");
-    }
-    
-    std::vector<double> x_values, y_values;
-    
-    for (const auto& record : dataset) {
-        if (ValueOps::is_numeric(record[col1]) && ValueOps::is_numeric(record[col2])) {
-            x_values.push_back(ValueOps::to_double(record[col1]));
-            y_values.push_back(ValueOps::to_double(record[col2]));
+Statistics::DescriptiveStats Statistics::calculate(const std::vector<DataValue>& values) {
+    // One pass for the moments; the copy is needed only for the median
+    Accumulator accumulator;
+    std::vector<double> numeric_values;
+    numeric_values.reserve(values.size());
+    for (const auto& value : values) {
+        if (ValueOps::is_numeric(value)) {
+            double number = ValueOps::to_double(value);
+            accumulator.add(number);
+            numeric_values.push_back(number);
         }
     }
     
-    if (x_values.size() < 2) {
-        return 0.0;
+    return describe(accumulator, select_quantile(numeric_values, 0.5));
+}
+
+Statistics::DescriptiveStats Statistics::calculate_column(const DataSet& dataset, const std::string& column,
+                                                          Precision precision) {
+    const Column& values = dataset.column(column);
+    if (precision == Precision::Approximate) {
+        RunningStats running;
+        running.update(values);
+        return running.stats();
     }
     
-    double mean_x = std::accumulate(x_values.begin(), x_values.end(), 0.0) / x_values.size();
-    double mean_y = std::accumulate(y_values.begin(), y_values.end(), 0.0) / y_values.size();
-    
-    double numerator = 0.0, sum_sq_x = 0.0, sum_sq_y = 0.0;
-    
-    for (size_t i = 0; i < x_values.size(); ++i) {
-        double dx = x_values[i] - mean_x;
-        double dy = y_values[i] - mean_y;
-        numerator += dx * dy;
-        sum_sq_x += dx * dx;
-        sum_sq_y += dy * dy;
+    Accumulator accumulator;
+    std::vector<double> numeric_values = numeric_cells(values);
+    for (double value : numeric_values) {
+        accumulator.add(value);
     }
-    
-    double denominator = std::sqrt(sum_sq_x * sum_sq_y);
-    return (denominator == 0.0) ? 0.0 : numerator / denominator;
+    return describe(accumulator, select_quantile(numeric_values, 0.5));
 }
 
-std::unordered_map<std::string, size_t> Statistics::frequency_count(
-    const DataSet& dataset, const std::string& column) {
-    
-    if (!dataset.has_column(column)) {
-        throw std::invalid_argument("Column not found: " + column);
-    }
-    
-    std::unordered_map<std::string, size_t> frequencies;
-    
-    for (const auto& record : dataset) {
-        std::string value = ValueOps::to_string(record[column]);
-        ++frequencies[value];
+void Statistics::RunningStats::update(const Column& values) {
+    for_each_numeric(values, [this](double value) {
+        accumulator_.add(value);
+        sketch_.add(value);
+    });
+}
+
+void Statistics::RunningStats::merge(const RunningStats& other) {
+    accumulator_.merge(other.accumulator_);
+    sketch_.merge(other.sketch_);
+}
+
+Statistics::DescriptiveStats Statistics::RunningStats::stats() const {
+    return describe(accumulator_, sketch_.quantile(0.5));
+}
+
+double Statistics::percentile(const DataSet& dataset, const std::string& column, double fraction,
+                              Precision precision) {
+    if (precision == Precision::Approximate) {
+        return sketch_column(dataset, column).quantile(fraction);
     }
-    
-    return frequencies;
+    std::vector<double> numeric_values = numeric_cells(dataset.column(column));
+    return select_quantile(numeric_values, fraction);
+}
+
+QuantileSketch Statistics::sketch_column(const DataSet& dataset, const std::string& column, size_t k) {
+    QuantileSketch sketch(k);
+    for_each_numeric(dataset.column(column), [&sketch](double value) { sketch.add(value); });
+    return sketch;
 }
 
 // PerformanceMonitor implementations
 PerformanceMonitor::PerformanceMonitor(std::string operation_name) 
     : start_time_(std::chrono::high_resolution_clock::now()), 
-      operation_name_(std::move(operation_name)) {
+      operation_name_(std::move(operation_name)),
+      span_(Tracing::enabled() ? Tracing::intern(operation_name_) : "", "monitor") {
     std::cout << "[PERF] Starting: " << operation_name_ << std::endl;
 }
 
@@ -471,135 +1368,649 @@ double PerformanceMonitor::elapsed_ms() const {
 
 // Pipeline implementations
 Pipeline& Pipeline::filter(FilterPredicate predicate) {
-    operations_.push_back([predicate](DataSet& dataset) {
-        dataset = dataset.filter(predicate);
-    });
+    Stage stage(Stage::Kind::Filter);
+    stage.reads = Filters::columns_read(predicate);
+    stage.predicate = std::move(predicate);
+    operations_.push_back(std::move(stage));
     return *this;
 }
 
 Pipeline& Pipeline::transform(const std::string& column, TransformFunction func) {
-    operations_.push_back([column, func](DataSet& dataset) {
-        dataset.transform_column(column, func);
-    });
+    Stage stage(Stage::Kind::Transform);
+    stage.column = column;
+    stage.transform = std::move(func);
+    operations_.push_back(std::move(stage));
     return *this;
 }
 
 Pipeline& Pipeline::sort_by(const std::string& column, bool ascending) {
-    operations_.push_back([column, ascending](DataSet& dataset) {
-        dataset.sort_by_column(column, ascending);
-    });
+    return sort_by({{column, ascending}});
+}
+
+Pipeline& Pipeline::sort_by(std::vector<SortKey> keys) {
+    Stage stage(Stage::Kind::Sort);
+    stage.keys = std::move(keys);
+    operations_.push_back(std::move(stage));
+    return *this;
+}
+
+Pipeline& Pipeline::top_k(const std::string& column, size_t k, bool ascending) {
+    return top_k({{column, ascending}}, k);
+}
+
+Pipeline& Pipeline::top_k(std::vector<SortKey> keys, size_t k) {
+    Stage stage(Stage::Kind::TopK);
+    stage.keys = std::move(keys);
+    stage.limit = k;
+    operations_.push_back(std::move(stage));
     return *this;
 }
 
 Pipeline& Pipeline::add_column(const std::string& name, 
                               std::function<DataValue(const DataRecord&)> calculator) {
-    operations_.push_back([name, calculator](DataSet& dataset) {
-        dataset.add_column(name);
-        for (auto& record : dataset) {
-            record[name] = calculator(record);
-        }
-    });
+    Stage stage(Stage::Kind::AddColumn);
+    stage.column = name;
+    stage.calculator = std::move(calculator);
+    operations_.push_back(std::move(stage));
     return *this;
 }
 
-DataSet Pipeline::execute(DataSet input) const {
-    MONITOR_PERFORMANCE("Pipeline execution");
+Pipeline& Pipeline::select(std::vector<std::string> columns) {
+    Stage stage(Stage::Kind::Select);
+    stage.columns = std::move(columns);
+    operations_.push_back(std::move(stage));
+    return *this;
+}
+
+std::string Pipeline::Stage::describe() const {
+    auto join = [](const std::vector<std::string>& names) {
+        std::string text;
+        for (size_t i = 0; i < names.size(); ++i) {
+            text += (i ? ", " : "") + names[i];
+        }
+        return text;
+    };
+    
+    switch (kind) {
+        case Kind::Filter:
+            if (auto expression = Filters::expression_of(predicate)) {
+                return "filter(" + expression->to_string() + ")";
+            }
+            return "filter(" + (reads ? join(*reads) : std::string("?")) + ")";
+        case Kind::Transform:
+            if (const auto* numeric = transform.target<Expressions::NumericTransform>()) {
+                return "transform(" + column + " = " + numeric->node->to_string() + ")";
+            }
+            return "transform(" + column + ")";
+        case Kind::AddColumn:
+            if (const auto* arithmetic = calculator.target<Expressions::Arithmetic>()) {
+                return "add_column(" + column + " = " + arithmetic->node()->to_string() + ")";
+            }
+            return "add_column(" + column + ")";
+        case Kind::Select:    return "select(" + join(columns) + ")";
+        case Kind::Sort:
+        case Kind::TopK: {
+            std::string text;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                text += (i ? "; " : "") + keys[i].column + (keys[i].ascending ? ", asc" : ", desc");
+            }
+            if (kind == Kind::TopK) {
+                return "top_k(" + std::to_string(limit) + " by " + text + ")";
+            }
+            return "sort_by(" + text + ")";
+        }
+    }
+    return "";
+}
+
+std::string Pipeline::PlanStep::describe() const {
+    std::string text;
+    if (!fused.empty()) {
+        text += "fused pass:";
+        for (size_t i = 0; i < fused.size(); ++i) {
+            text += (i ? " -> " : " ") + fused[i]->describe();
+        }
+    }
+    if (boundary()) {
+        text += (fused.empty() ? "" : "; then ") + boundary()->describe();
+    }
+    return text;
+}
+
+const char* Pipeline::PlanStep::trace_name() const {
+    return Tracing::enabled() ? Tracing::intern(describe()) : "";
+}
+
+std::vector<Pipeline::PlanStep> Pipeline::plan() const {
+    std::vector<PlanStep> steps(1);
+    
+    // A filter may run before an earlier stage when it provably does not
+    // depend on it: row-local writes to columns it does not read, a stable
+    // sort, or a projection that keeps every column it reads
+    auto independent = [](const Stage& filter, const Stage& earlier) {
+        const auto& reads = *filter.reads;
+        auto reads_column = [&reads](const std::string& column) {
+            return std::find(reads.begin(), reads.end(), column) != reads.end();
+        };
+        switch (earlier.kind) {
+            case Stage::Kind::Transform:
+            case Stage::Kind::AddColumn:
+                return !reads_column(earlier.column);
+            case Stage::Kind::Sort:
+                return true;
+            case Stage::Kind::TopK:
+                return false;   // decides which rows survive
+            case Stage::Kind::Select:
+                return std::all_of(reads.begin(), reads.end(), [&earlier](const std::string& column) {
+                    return std::find(earlier.columns.begin(), earlier.columns.end(), column) !=
+                           earlier.columns.end();
+                });
+            case Stage::Kind::Filter:
+                return false;   // keep the user's filter order
+        }
+        return false;
+    };
+    
+    for (const auto& stage : operations_) {
+        switch (stage.kind) {
+            case Stage::Kind::Filter: {
+                size_t step = steps.size() - 1;
+                size_t position = steps[step].fused.size();
+                while (stage.reads) {
+                    if (position > 0) {
+                        if (!independent(stage, *steps[step].fused[position - 1])) break;
+                        --position;
+                    } else if (step > 0 && independent(stage, *steps[step - 1].boundary())) {
+                        --step;   // move into the previous step, past its boundary
+                        position = steps[step].fused.size();
+                    } else {
+                        break;
+                    }
+                }
+                auto& fused = steps[step].fused;
+                fused.insert(fused.begin() + static_cast<std::ptrdiff_t>(position), &stage);
+                break;
+            }
+            case Stage::Kind::Transform:
+            case Stage::Kind::AddColumn:
+                steps.back().fused.push_back(&stage);
+                break;
+            case Stage::Kind::Select:
+                steps.back().projection = &stage;
+                steps.emplace_back();
+                break;
+            case Stage::Kind::Sort:
+            case Stage::Kind::TopK:
+                steps.back().blocking = &stage;
+                steps.emplace_back();
+                break;
+        }
+    }
+    
+    // Drop steps that ended up with nothing to do
+    steps.erase(std::remove_if(steps.begin(), steps.end(), [](const PlanStep& step) {
+        return step.fused.empty() && !step.projection && !step.blocking;
+    }), steps.end());
+    return steps;
+}
+
+DataSet Pipeline::run_fused(const DataSet& input, const PlanStep& step, size_t begin, size_t end,
+                            Column::Allocator alloc) {
+    end = std::min(end, input.size());
+    begin = std::min(begin, end);
+    if (step.fused.empty()) {
+        if (begin == 0 && end == input.size()) {
+            return step.projection ? input.select(step.projection->columns, alloc) : input.slice(begin, end, alloc);
+        }
+        DataSet range = input.slice(begin, end, alloc);
+        return step.projection ? range.select(step.projection->columns, alloc) : range;
+    }
+    
+    // Columns written by the step, in the order they are first written
+    std::vector<std::string> written;
+    for (const Stage* stage : step.fused) {
+        if (stage->kind == Stage::Kind::Filter) continue;
+        if (stage->kind == Stage::Kind::Transform && !input.has_column(stage->column) &&
+            std::find(written.begin(), written.end(), stage->column) == written.end()) {
+            throw std::invalid_argument("Column not found: " + stage->column);
+        }
+        if (std::find(written.begin(), written.end(), stage->column) == written.end()) {
+            written.push_back(stage->column);
+        }
+    }
+    
+    RowOverlay overlay(written);
+    std::vector<size_t> slots(step.fused.size());
+    std::vector<const Column*> sources(step.fused.size(), nullptr);
+    std::vector<std::vector<uint8_t>> matches(step.fused.size());
+    for (size_t i = 0; i < step.fused.size(); ++i) {
+        const Stage& stage = *step.fused[i];
+        if (stage.kind == Stage::Kind::Filter) {
+            // Filters on dictionary columns no earlier stage rewrites test codes
+            auto reads = Filters::columns_read(stage.predicate);
+            if (reads && reads->size() == 1 &&
+                std::find(written.begin(), written.end(), (*reads)[0]) == written.end()) {
+                matches[i] = dictionary_matches(input, stage.predicate);
+                if (!matches[i].empty()) sources[i] = &input.column((*reads)[0]);
+            }
+            continue;
+        }
+        slots[i] = *overlay.slot(stage.column);
+        if (stage.kind == Stage::Kind::Transform && input.has_column(stage.column)) {
+            sources[i] = &input.column(stage.column);
+        }
+    }
+    
+    // Leading stages that compile against the input (Filters expressions,
+    // Expressions::Arithmetic calculators, numeric transforms of typed
+    // columns) run a batch of rows at a time: filters narrow a selection
+    // vector and arithmetic fills one buffer per stage. The first stage that
+    // does not compile, or reads a column an earlier stage wrote, ends them.
+    struct CompiledStage {
+        std::optional<Expressions::CompiledFilter> filter;
+        std::optional<Expressions::CompiledArithmetic> arithmetic;
+        std::vector<double> values;
+    };
+    std::vector<CompiledStage> compiled;
+    std::vector<std::string> compiled_writes;
+    auto reads_written = [&compiled_writes](const std::vector<std::string>& reads) {
+        return std::any_of(reads.begin(), reads.end(), [&](const std::string& column) {
+            return std::find(compiled_writes.begin(), compiled_writes.end(), column) != compiled_writes.end();
+        });
+    };
+    for (const Stage* stage : step.fused) {
+        CompiledStage entry;
+        if (stage->kind == Stage::Kind::Filter) {
+            auto expression = Filters::expression_of(stage->predicate);
+            if (!expression || !stage->reads || reads_written(*stage->reads)) break;
+            entry.filter.emplace(*expression, input);
+        } else {
+            const auto* numeric = stage->transform.target<Expressions::NumericTransform>();
+            const auto* arithmetic = stage->calculator.target<Expressions::Arithmetic>();
+            if (stage->kind == Stage::Kind::Transform && numeric && input.has_column(stage->column) &&
+                !reads_written({stage->column})) {
+                entry.arithmetic = Expressions::CompiledArithmetic::compile(*numeric->node, input,
+                                                                            &input.column(stage->column));
+            } else if (stage->kind == Stage::Kind::AddColumn && arithmetic && !reads_written(arithmetic->columns())) {
+                entry.arithmetic = Expressions::CompiledArithmetic::compile(*arithmetic->node(), input);
+            }
+            if (!entry.arithmetic) break;
+            entry.values.resize(Expressions::batch_rows);
+            compiled_writes.push_back(stage->column);
+        }
+        compiled.push_back(std::move(entry));
+    }
+    const size_t leading = compiled.size();
+    const bool all_compiled = leading == step.fused.size();
+    
+    // Compiled stage whose value each written column ends up with
+    std::vector<size_t> last_writer(written.size());
+    for (size_t i = 0; i < leading; ++i) {
+        if (!compiled[i].filter) last_writer[slots[i]] = i;
+    }
+    
+    // One pass over each batch: every stage sees the row with the writes of
+    // the stages before it, and a rejected row stops being processed at once
+    std::vector<Column> outputs;
+    outputs.reserve(written.size());
+    for (size_t slot = 0; slot < written.size(); ++slot) {
+        // Not copies: those would leave alloc's resource
+        if (all_compiled) {
+            outputs.emplace_back(ColumnType::Double, alloc);
+        } else {
+            outputs.emplace_back(alloc);
+        }
+    }
+    std::vector<size_t> kept;
+    std::vector<size_t> selection;
+    for (size_t batch = begin; batch < end; batch += Expressions::batch_rows) {
+        size_t batch_end = std::min(end, batch + Expressions::batch_rows);
+        selection.resize(batch_end - batch);
+        std::iota(selection.begin(), selection.end(), batch);
+        for (size_t i = 0; i < leading && !selection.empty(); ++i) {
+            if (compiled[i].filter) {
+                compiled[i].filter->refine(selection);
+            } else {
+                compiled[i].arithmetic->evaluate(batch, batch_end, compiled[i].values.data());
+            }
+        }
+        
+        if (all_compiled) {
+            kept.insert(kept.end(), selection.begin(), selection.end());
+            for (size_t slot = 0; slot < written.size(); ++slot) {
+                const double* values = compiled[last_writer[slot]].values.data();
+                for (size_t row : selection) {
+                    outputs[slot].append_double(values[row - batch]);
+                }
+            }
+            continue;
+        }
+        
+        for (size_t row : selection) {
+            overlay.clear();
+            const DataRecord record(input, row, overlay);
+            for (size_t i = 0; i < leading; ++i) {
+                if (!compiled[i].filter) overlay.set(slots[i], compiled[i].values[row - batch]);
+            }
+        
+            bool keep = true;
+            for (size_t i = leading; i < step.fused.size() && keep; ++i) {
+                const Stage& stage = *step.fused[i];
+                switch (stage.kind) {
+                    case Stage::Kind::Filter:
+                        keep = sources[i] ? matches[i][sources[i]->dictionary().codes[row]] != 0
+                                          : stage.predicate(record);
+                        break;
+                    case Stage::Kind::Transform:
+                        overlay.set(slots[i], stage.transform(overlay.is_set(slots[i])
+                            ? overlay.value(slots[i]) : sources[i]->get(row)));
+                        break;
+                    case Stage::Kind::AddColumn:
+                        overlay.set(slots[i], stage.calculator(record));
+                        break;
+                    default:
+                        break;
+                }
+            }
+        
+            if (keep) {
+                kept.push_back(row);
+                for (size_t slot = 0; slot < written.size(); ++slot) {
+                    outputs[slot].append(overlay.value(slot));
+                }
+            }
+        }
+    }
+    
+    // Late materialization: columns the step never wrote are gathered once
+    std::vector<std::string> names = step.projection ? step.projection->columns : input.get_columns();
+    if (!step.projection) {
+        for (const auto& column : written) {
+            if (!input.has_column(column)) names.push_back(column);
+        }
+    }
     
-    for (const auto& operation : operations_) {
-        operation(input);
+    std::vector<Column> data;
+    data.reserve(names.size());
+    for (const auto& name : names) {
+        if (auto slot = overlay.slot(name)) {
+            data.push_back(std::move(outputs[*slot]));
+        } else {
+            data.push_back(input.column(name).take(kept, alloc));
+        }
+    }
+    return DataSet(std::move(names), std::move(data));
+}
+
+void Pipeline::run_blocking(DataSet& dataset, const Stage& stage) {
+    if (stage.kind == Stage::Kind::Sort) {
+        dataset.sort_by(stage.keys);
+    } else if (stage.kind == Stage::Kind::TopK) {
+        dataset = dataset.top_k(stage.keys, stage.limit);
+    }
+}
+
+DataSet Pipeline::execute(DataSet input) const {
+    Tracing::Span span("Pipeline::execute");
+    span.add_bytes(input.cell_bytes());
+    
+    for (const auto& step : plan()) {
+        Tracing::Span step_span(step.trace_name());
+        step_span.add_bytes(input.cell_bytes());
+        if (!step.fused.empty() || step.projection) {
+            input = run_fused(input, step);
+        }
+        if (step.blocking) {
+            run_blocking(input, *step.blocking);
+        }
+        step_span.set_rows(input.size());
     }
     
+    span.set_rows(input.size());
     return input;
 }
 
+std::string Pipeline::explain() const {
+    std::ostringstream oss;
+    auto steps = plan();
+    oss << "Plan (" << operations_.size() << " operations, " << steps.size() << " steps):\n";
+    
+    for (size_t i = 0; i < steps.size(); ++i) {
+        std::string step = steps[i].describe();
+        oss << "  " << (i + 1) << "." << (step.empty() ? "" : " ") << step << "\n";
+    }
+    return oss.str();
+}
+
+// Pipeline::execute_streaming is implemented in streaming.cpp
+
 // Aggregate functions
 namespace Aggregates {
-    const AggregateFunction Sum = [](const std::vector<DataValue>& values) -> DataValue {
-        double sum = 0.0;
-        for (const auto& value : values) {
-            if (ValueOps::is_numeric(value)) {
-                sum += ValueOps::to_double(value);
+    namespace {
+        std::vector<double> numeric_values(const std::vector<DataValue>& values) {
+            std::vector<double> result;
+            result.reserve(values.size());
+            for (const auto& value : values) {
+                if (ValueOps::is_numeric(value)) {
+                    result.push_back(ValueOps::to_double(value));
+                }
             }
+            return result;
         }
-        return sum;
-    };
-    
-    const AggregateFunction Mean = [](const std::vector<DataValue>& values) -> DataValue {
-        if (values.empty()) return 0.0;
-        double sum = ValueOps::to_double(Sum(values));
-        return sum / values.size();
-    };
+        
+        double std_dev(const std::vector<double>& values) {
+            return std::sqrt(Kernels::variance(values.data(), values.size()));
+        }
+    }
     
-    const AggregateFunction Min = [](const std::vector<DataValue>& values) -> DataValue {
-        if (values.empty()) return 0.0;
-        auto min_val = std::min_element(values.begin(), values.end(), ValueOps::compare_less);
-        return *min_val;
-    };
+    DataValue Builtin::operator()(const std::vector<DataValue>& values) const {
+        switch (kind) {
+            case Kind::Sum: {
+                auto numbers = numeric_values(values);
+                return Kernels::sum(numbers.data(), numbers.size());
+            }
+            case Kind::Mean: {
+                if (values.empty()) return 0.0;
+                auto numbers = numeric_values(values);
+                return Kernels::sum(numbers.data(), numbers.size()) / values.size();
+            }
+            case Kind::Min: {
+                if (values.empty()) return 0.0;
+                return *std::min_element(values.begin(), values.end(), ValueOps::compare_less);
+            }
+            case Kind::Max: {
+                if (values.empty()) return 0.0;
+                return *std::max_element(values.begin(), values.end(), ValueOps::compare_less);
+            }
+            case Kind::Count:
+                return static_cast<int64_t>(values.size());
+            case Kind::StdDev:
+                return std_dev(numeric_values(values));
+        }
+        return 0.0;
+    }
     
-    const AggregateFunction Max = [](const std::vector<DataValue>& values) -> DataValue {
-        if (values.empty()) return 0.0;
-        auto max_val = std::max_element(values.begin(), values.end(), ValueOps::compare_less);
-        return *max_val;
-    };
+    DataValue Builtin::on_column(const Column& column) const {
+        size_t count = column.size();
+        if (kind == Kind::Count) {
+            return static_cast<int64_t>(count);
+        }
+        if (count == 0) {
+            return 0.0;
+        }
+        
+        if (column.type() == ColumnType::Int64) {
+            const int64_t* ints = column.ints().data();
+            switch (kind) {
+                case Kind::Sum:  return static_cast<double>(Kernels::sum(ints, count));
+                case Kind::Mean: return static_cast<double>(Kernels::sum(ints, count)) / count;
+                case Kind::Min:  return Kernels::min(ints, count);
+                case Kind::Max:  return Kernels::max(ints, count);
+                default:
+                    return std_dev(std::vector<double>(column.ints().begin(), column.ints().end()));
+            }
+        }
+        
+        const double* doubles = column.doubles().data();
+        switch (kind) {
+            case Kind::Sum:  return Kernels::sum(doubles, count);
+            case Kind::Mean: return Kernels::sum(doubles, count) / count;
+            case Kind::Min:  return Kernels::min(doubles, count);
+            case Kind::Max:  return Kernels::max(doubles, count);
+            default:         return std::sqrt(Kernels::variance(doubles, count));
+        }
+    }
     
-    const AggregateFunction Count = [](const std::vector<DataValue>& values) -> DataValue {
-        return static_cast<int>(values.size());
-    };
+    const char* kind_name(Kind kind) {
+        switch (kind) {
+            case Kind::Sum:    return "sum";
+            case Kind::Mean:   return "mean";
+            case Kind::Min:    return "min";
+            case Kind::Max:    return "max";
+            case Kind::Count:  return "count";
+            case Kind::StdDev: return "std_dev";
+        }
+        return "unknown";
+    }
     
-    const AggregateFunction StdDev = [](const std::vector<DataValue>& values) -> DataValue {
-        auto stats = Statistics::calculate(values);
-        return stats.std_dev;
-    };
+    const AggregateFunction Sum = Builtin{Kind::Sum};
+    const AggregateFunction Mean = Builtin{Kind::Mean};
+    const AggregateFunction Min = Builtin{Kind::Min};
+    const AggregateFunction Max = Builtin{Kind::Max};
+    const AggregateFunction Count = Builtin{Kind::Count};
+    const AggregateFunction StdDev = Builtin{Kind::StdDev};
 }
 
 // Filter predicates
 namespace Filters {
-    FilterPredicate column_equals(const std::string& column, const DataValue& value) {
-        return [column, value](const DataRecord& record) {
-            return record.has_column(column) && 
-                   ValueOps::to_string(record[column]) == ValueOps::to_string(value);
+    std::function<bool(const DataValue&)> Expression::cell_test() const {
+        switch (op) {
+            case Op::Equals:
+                return [expected = ValueOps::to_string(value)](const DataValue& cell) {
+                    ValueOps::TextBuffer buffer;
+                    return ValueOps::text_of(cell, buffer) == expected;
+                };
+            case Op::GreaterThan:
+                return [value = value, text = ValueOps::to_string(value)](const DataValue& cell) {
+                    ValueOps::TextBuffer buffer;
+                    return !ValueOps::compare_less(cell, value) && ValueOps::text_of(cell, buffer) != text;
+                };
+            case Op::LessThan:
+                return [value = value](const DataValue& cell) {
+                    return ValueOps::compare_less(cell, value);
+                };
+            case Op::Contains:
+                return [substring = ValueOps::to_string(value)](const DataValue& cell) {
+                    ValueOps::TextBuffer buffer;
+                    return ValueOps::text_of(cell, buffer).find(substring) != std::string_view::npos;
+                };
+            case Op::And:
+            case Op::Or:
+            case Op::Not:
+                break;
+        }
+        throw std::logic_error("Only comparisons have a cell test");
+    }
+    
+    std::string Expression::to_string() const {
+        auto quoted = [this] {
+            return value.is_string() ? "'" + ValueOps::to_string(value) + "'" : ValueOps::to_string(value);
         };
+        switch (op) {
+            case Op::Equals:      return column + " == " + quoted();
+            case Op::GreaterThan: return column + " > " + quoted();
+            case Op::LessThan:    return column + " < " + quoted();
+            case Op::Contains:    return column + " contains " + quoted();
+            case Op::And:         return "(" + children[0]->to_string() + " and " + children[1]->to_string() + ")";
+            case Op::Or:          return "(" + children[0]->to_string() + " or " + children[1]->to_string() + ")";
+            case Op::Not:         return "not " + children[0]->to_string();
+        }
+        return "";
+    }
+    
+    std::optional<std::vector<std::string>> columns_read(const FilterPredicate& predicate) {
+        if (const auto* known = predicate.target<ColumnPredicate>()) {
+            return known->columns;
+        }
+        return std::nullopt;
+    }
+    
+    std::shared_ptr<const Expression> expression_of(const FilterPredicate& predicate) {
+        if (const auto* known = predicate.target<ColumnPredicate>()) {
+            return known->expression;
+        }
+        return nullptr;
+    }
+    
+    namespace {
+        // Combine predicates under a logical node, keeping the read set when
+        // all are known and the expression when all are inspectable
+        FilterPredicate combine(Expression::Op op, const std::vector<FilterPredicate>& operands,
+                                std::function<bool(const DataRecord&)> test) {
+            std::vector<std::string> reads;
+            auto node = std::make_shared<Expression>(Expression{op, {}, {}, {}});
+            for (const auto& operand : operands) {
+                auto operand_reads = columns_read(operand);
+                if (!operand_reads) {
+                    return test;
+                }
+                for (const auto& column : *operand_reads) {
+                    if (std::find(reads.begin(), reads.end(), column) == reads.end()) {
+                        reads.push_back(column);
+                    }
+                }
+                auto child = expression_of(operand);
+                if (node && child) {
+                    node->children.push_back(std::move(child));
+                } else {
+                    node = nullptr;
+                }
+            }
+            return ColumnPredicate{std::move(reads), std::move(test), nullptr, std::move(node)};
+        }
+        
+        FilterPredicate comparison(Expression::Op op, const std::string& column, const DataValue& value) {
+            auto expression = std::make_shared<const Expression>(Expression{op, column, value, {}});
+            auto cell = expression->cell_test();
+            auto test = [column, cell](const DataRecord& record) {
+                return record.has_column(column) && cell(record[column]);
+            };
+            return ColumnPredicate{{column}, std::move(test), std::move(cell), std::move(expression)};
+        }
+    }
+    
+    FilterPredicate column_equals(const std::string& column, const DataValue& value) {
+        return comparison(Expression::Op::Equals, column, value);
     }
     
     FilterPredicate column_greater_than(const std::string& column, const DataValue& value) {
-        return [column, value](const DataRecord& record) {
-            return record.has_column(column) && 
-                   !ValueOps::compare_less(record[column], value) &&
-                   ValueOps::to_string(record[column]) != ValueOps::to_string(value);
-        };
+        return comparison(Expression::Op::GreaterThan, column, value);
     }
     
     FilterPredicate column_less_than(const std::string& column, const DataValue& value) {
-        return [column, value](const DataRecord& record) {
-            return record.has_column(column) && 
-                   ValueOps::compare_less(record[column], value);
-        };
+        return comparison(Expression::Op::LessThan, column, value);
     }
     
     FilterPredicate column_contains(const std::string& column, const std::string& substring) {
-        return [column, substring](const DataRecord& record) {
-            if (!record.has_column(column)) return false;
-            std::string value = ValueOps::to_string(record[column]);
-            return value.find(substring) != std::string::npos;
-        };
+        return comparison(Expression::Op::Contains, column, substring);
     }
     
     FilterPredicate logical_and(FilterPredicate a, FilterPredicate b) {
-        return [a, b](const DataRecord& record) {
+        return combine(Expression::Op::And, {a, b}, [a, b](const DataRecord& record) {
             return a(record) && b(record);
-        };
+        });
     }
     
     FilterPredicate logical_or(FilterPredicate a, FilterPredicate b) {
-        return [a, b](const DataRecord& record) {
+        return combine(Expression::Op::Or, {a, b}, [a, b](const DataRecord& record) {
             return a(record) || b(record);
-        };
+        });
     }
     
     FilterPredicate logical_not(FilterPredicate pred) {
-        return [pred](const DataRecord& record) {
+        return combine(Expression::Op::Not, {pred}, [pred](const DataRecord& record) {
             return !pred(record);
-        };
+        });
     }
 }
 
@@ -617,46 +2028,23 @@ namespace Transforms {
         return str;
     };
     
-    const TransformFunction Square = [](const DataValue& value) -> DataValue {
-        if (ValueOps::is_numeric(value)) {
-            double val = ValueOps::to_double(value);
-            return val * val;
-        }
-        return value;
-    };
+    // The numeric transforms are arithmetic over the input value, so the
+    // pipeline can compile them for typed columns
+    const TransformFunction Square =
+        Expressions::NumericTransform{(Expressions::input() * Expressions::input()).node()};
     
-    const TransformFunction SquareRoot = [](const DataValue& value) -> DataValue {
-        if (ValueOps::is_numeric(value)) {
-            double val = ValueOps::to_double(value);
-            return std::sqrt(std::abs(val));
-        }
-        return value;
-    };
+    const TransformFunction SquareRoot =
+        Expressions::NumericTransform{Expressions::sqrt(Expressions::abs(Expressions::input())).node()};
     
-    const TransformFunction Absolute = [](const DataValue& value) -> DataValue {
-        if (ValueOps::is_numeric(value)) {
-            double val = ValueOps::to_double(value);
-            return std::abs(val);
-        }
-        return value;
-    };
+    const TransformFunction Absolute =
+        Expressions::NumericTransform{Expressions::abs(Expressions::input()).node()};
     
     TransformFunction multiply_by(double factor) {
-        return [factor](const DataValue& value) -> DataValue {
-            if (ValueOps::is_numeric(value)) {
-                return ValueOps::to_double(value) * factor;
-            }
-            return value;
-        };
+        return Expressions::NumericTransform{(Expressions::input() * factor).node()};
     }
     
     TransformFunction add_constant(double constant) {
-        return [constant](const DataValue& value) -> DataValue {
-            if (ValueOps::is_numeric(value)) {
-                return ValueOps::to_double(value) + constant;
-            }
-            return value;
-        };
+        return Expressions::NumericTransform{(Expressions::input() + constant).node()};
     }
     
     TransformFunction string_replace(const std::string& from, const std::string& to) {
@@ -5,6 +5,7 @@
  * advanced STL usage, custom iterators, allocators, and modern C++ features.
  * 
  * The pipeline supports:
+ * - Columnar, typed storage with lightweight row views
  * - CSV data loading and parsing
  * - Data transformation and filtering
  * - Statistical analysis
@@ -17,6 +18,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <algorithm>
 #include <numeric>
@@ -28,6 +30,16 @@
 #include <optional>
 #include <variant>
 #include <type_traits>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include "../flat_hash_map.hpp"
+#include "../range_adaptors.hpp"
+#include "concurrent_counters.hpp"
+#include "expected.hpp"
+#include "data_value.hpp"
+#include "tracing.hpp"
 
 namespace DataProcessing {
 
@@ -36,52 +48,374 @@ class DataRecord;
 class DataSet;
 class Pipeline;
 class Statistics;
+class BatchSource;
+class BatchSink;
+struct StreamingOptions;
+struct ColumnarOptions;
+struct GroupAggregate;
+class GroupByState;
+class IncrementalPipeline;
+struct PipelineCounters;
+namespace Joins { struct Matches; }
+
+// Options for the parallel overloads of Pipeline::execute, filter,
+// transform_column, aggregate_column, sort_by_column, sort_order, top_k,
+// join, group_by_aggregate and Statistics::covariance_matrix (implemented
+// in parallel_execution.cpp)
+struct ExecutionPolicy {
+    size_t threads = 0;              // 0: std::thread::hardware_concurrency()
+    size_t morsel_rows = 64 * 1024;  // rows handed to a worker at a time
+    PipelineCounters* counters = nullptr;   // progress of Pipeline::execute, if wanted
+};
+
+// Progress of a Pipeline::execute run, updated by its fused passes as
+// each morsel finishes and readable from any thread meanwhile. Counters
+// accumulate over runs until reset.
+struct PipelineCounters {
+    ShardedCounter rows_in;    // rows fed to fused passes, summed over plan steps
+    ShardedCounter rows_out;   // rows those passes produced
+    ShardedCounter morsels;
+    ConcurrentHistogram morsel_micros{ConcurrentHistogram::exponentialBounds(16, 2, 20)};
+    
+    void reset() {
+        rows_in.reset();
+        rows_out.reset();
+        morsels.reset();
+        morsel_micros.reset();
+    }
+};
+
+// One key of a multi-column sort
+struct SortKey {
+    std::string column;
+    bool ascending = true;
+};
+
+// Rows produced by DataSet::join
+enum class JoinKind {
+    Inner,   // one per matching pair of rows
+    Left,    // as Inner, plus each unmatched left row with empty right cells
+    Semi     // each left row that has a match, once, with the left columns only
+};
 
 // Type aliases for better readability
-using DataValue = std::variant<int, double, std::string>;
-using DataRow = std::unordered_map<std::string, DataValue>;
+using DataRow = string_flat_hash_map<DataValue>;
 using TransformFunction = std::function<DataValue(const DataValue&)>;
 using FilterPredicate = std::function<bool(const DataRecord&)>;
 using AggregateFunction = std::function<DataValue(const std::vector<DataValue>&)>;
 
+// Why a non-throwing (try_) operation failed
+enum class ErrorCode {
+    NotANumber,         // text that does not parse as the number asked for
+    NumberOutOfRange,   // a number too large for the type asked for
+    ColumnNotFound,
+    CannotOpenFile
+};
+
+// Failure of a lookup or file operation; subject names the column or file
+struct Error {
+    ErrorCode code;
+    std::string subject;
+    
+    // The message the throwing version of the operation reports
+    std::string message() const;
+};
+
+// Results of the try_ operations. Number parsing reports a bare ErrorCode,
+// which is cheaper to return per cell; the caller already has the text.
+template<typename T>
+using Result = stdx::expected<T, Error>;
+template<typename T>
+using ParseResult = stdx::expected<T, ErrorCode>;
+
 // Utility functions for DataValue operations
 namespace ValueOps {
+    // Numbers as themselves, strings parsed as a whole (surrounding
+    // whitespace aside) with std::from_chars
+    ParseResult<double> try_to_double(const DataValue& value);
+    // As try_to_double, with 0.0 for a string that is not a number (or null)
     double to_double(const DataValue& value);
+    // Integers in decimal, doubles with six decimals, null as ""
     std::string to_string(const DataValue& value);
     bool is_numeric(const DataValue& value);
     DataValue add(const DataValue& a, const DataValue& b);
     DataValue multiply(const DataValue& a, const DataValue& b);
     bool compare_less(const DataValue& a, const DataValue& b);
+    
+    // Allocation-free forms, for per-cell loops
+    
+    // Room for any number to_string prints (a double can take 317 characters)
+    struct TextBuffer {
+        char data[320];
+    };
+    
+    // The text to_string returns, as a view of a string's own characters or
+    // of a number printed into buffer
+    std::string_view text_of(const DataValue& value, TextBuffer& buffer);
+    // Append to_string(value) to out
+    void append_to(std::string& out, const DataValue& value);
+    // add(multiply(a, b), c), without the intermediate value
+    DataValue multiply_add(const DataValue& a, const DataValue& b, const DataValue& c);
 }
 
-// Data Record - represents a single row of data
+// Growable monotonic arena: allocation bumps a pointer through chunks taken
+// from an upstream resource (each twice the size of the last), deallocation
+// does nothing, and all memory is given back at once. Used for per-batch
+// memory in Pipeline::execute_streaming. Not thread-safe.
+class MonotonicArena : public std::pmr::memory_resource {
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;   // including this header
+    };
+    
+    std::pmr::memory_resource* upstream_;
+    Chunk* chunks_ = nullptr;   // newest (and largest) first
+    char* cursor_ = nullptr;
+    size_t remaining_ = 0;
+    size_t next_chunk_size_;
+    size_t bytes_allocated_ = 0;
+    size_t bytes_reserved_ = 0;
+    
+    void add_chunk(size_t bytes, size_t alignment);
+    
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    
+public:
+    explicit MonotonicArena(size_t initial_chunk_size = 64 * 1024,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~MonotonicArena() override { release(); }
+    
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+    
+    // Give every chunk back to the upstream resource
+    void release();
+    
+    // Rewind for reuse, keeping only the largest chunk, so a steady stream
+    // of similar batches stops touching the upstream resource
+    void reset();
+    
+    size_t bytes_allocated() const { return bytes_allocated_; }   // since the last reset/release
+    size_t bytes_reserved() const { return bytes_reserved_; }     // held from upstream
+};
+
+// Storage type of a Column buffer (matches the Column::Storage alternative order)
+enum class ColumnType { Int64, Double, String, Mixed, Dictionary };
+
+// Intern table of a dictionary-encoded string column: every distinct value
+// is stored once and identified by a 32-bit code in order of first use
+class StringDictionary {
+private:
+    std::vector<std::string> values_;
+    string_flat_hash_map<uint32_t> codes_;   // looked up by string_view
+    
+public:
+    uint32_t intern(std::string_view value);
+    std::optional<uint32_t> find(std::string_view value) const;
+    
+    const std::string& operator[](uint32_t code) const { return values_[code]; }
+    size_t size() const { return values_.size(); }
+    
+    // Evaluate a cell predicate once per distinct value (one flag per code)
+    std::vector<uint8_t> matches(const std::function<bool(const DataValue&)>& predicate) const;
+    
+    // Position of every code in the sorted order of the values, so that
+    // codes can be compared as integers instead of as strings
+    std::vector<uint32_t> sort_ranks() const;
+};
+
+// Cells of a dictionary-encoded column. Columns derived by take/slice share
+// the dictionary; it is copied before being extended if it is shared.
+struct DictionaryColumn {
+    std::shared_ptr<StringDictionary> dictionary = std::make_shared<StringDictionary>();
+    std::pmr::vector<uint32_t> codes;
+    
+    DictionaryColumn() = default;
+    explicit DictionaryColumn(std::pmr::polymorphic_allocator<std::byte> alloc) : codes(alloc) {}
+    DictionaryColumn(std::shared_ptr<StringDictionary> shared, std::pmr::vector<uint32_t> cells)
+        : dictionary(std::move(shared)), codes(std::move(cells)) {}
+    
+    uint32_t code_of(std::string_view value);   // interns the value if new
+    void append(std::string_view value) { codes.push_back(code_of(value)); }
+    const std::string& at(size_t row) const { return (*dictionary)[codes[row]]; }
+};
+
+// Column - contiguous, typed storage for one column of a DataSet.
+// An untyped column takes the type of the first value appended to it; a value
+// of a different type later demotes the column to Mixed (one DataValue per
+// cell), so no information is lost. String columns can also be stored
+// dictionary-encoded, which behaves exactly like a String column.
+//
+// Buffers (and the text of String cells) come from a std::pmr resource,
+// the default one unless an allocator is given. Columns derived by the
+// column itself (retyping, dictionary encoding) stay on its resource and
+// take/slice use the allocator passed to them; copies follow the usual pmr
+// rule and land on the default resource, so a copy may outlive an arena.
+class Column {
+public:
+    using Allocator = std::pmr::polymorphic_allocator<std::byte>;
+    using Storage = std::variant<std::pmr::vector<int64_t>,
+                                 std::pmr::vector<double>,
+                                 std::pmr::vector<std::pmr::string>,
+                                 std::pmr::vector<DataValue>,
+                                 DictionaryColumn>;
+    
+private:
+    Storage data_;
+    bool typed_ = false;
+    
+    void make_mixed();
+    bool accepts(const DataValue& value) const;
+    
+public:
+    Column() = default;
+    explicit Column(Allocator alloc);
+    explicit Column(ColumnType type, Allocator alloc = {});
+    explicit Column(Storage data);   // adopt a filled buffer (used by loaders)
+    static Column repeat(const DataValue& value, size_t count);
+    
+    Allocator get_allocator() const;
+    
+    // Type and size
+    ColumnType type() const { return static_cast<ColumnType>(data_.index()); }
+    bool is_numeric() const { return type() == ColumnType::Int64 || type() == ColumnType::Double; }
+    bool is_text() const { return type() == ColumnType::String || type() == ColumnType::Dictionary; }
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    void reserve(size_t capacity);
+    
+    // Bytes of the cell buffer: 8 per number, 4 per dictionary code, the
+    // string or DataValue objects otherwise (not text stored outside them)
+    size_t cell_bytes() const;
+    
+    // Cell access
+    DataValue get(size_t row) const;
+    std::optional<double> numeric_at(size_t row) const;
+    void set(size_t row, const DataValue& value);
+    void append(const DataValue& value);
+    
+    // Typed append fast paths for loaders (fall back to append() on a type mismatch)
+    void append_int64(int64_t value);
+    void append_double(double value);
+    void append_string(std::string_view value);
+    
+    // Append all cells of another column (used to stitch parallel load chunks)
+    void extend(Column other);
+    
+    // Row selection (used by filter and sort to rebuild columns in one pass)
+    Column take(const std::vector<size_t>& rows, Allocator alloc = {}) const;
+    Column slice(size_t begin, size_t end, Allocator alloc = {}) const;
+    std::vector<DataValue> to_values() const;
+    
+    // Switch a String column to dictionary encoding and back (no-op otherwise)
+    void encode_dictionary();
+    void decode_dictionary();
+    
+    // Dictionary columns only: each cell's rank among the dictionary's sorted
+    // values, so sorting rows by this Int64 column orders them like the strings
+    Column dictionary_ranks() const;
+    
+    // Typed buffer access - throws std::bad_variant_access on a type mismatch
+    const std::pmr::vector<int64_t>& ints() const { return std::get<std::pmr::vector<int64_t>>(data_); }
+    const std::pmr::vector<double>& doubles() const { return std::get<std::pmr::vector<double>>(data_); }
+    const std::pmr::vector<std::pmr::string>& strings() const {
+        return std::get<std::pmr::vector<std::pmr::string>>(data_);
+    }
+    const std::pmr::vector<DataValue>& values() const { return std::get<std::pmr::vector<DataValue>>(data_); }
+    const DictionaryColumn& dictionary() const { return std::get<DictionaryColumn>(data_); }
+    const Storage& storage() const { return data_; }
+};
+
+// Assignable reference to a single cell, returned by the non-const
+// DataRecord::operator[] so writes go straight into the column buffer
+class CellRef {
+private:
+    DataValue* detached_ = nullptr;
+    const DataSet* dataset_ = nullptr;
+    size_t column_ = 0;
+    size_t row_ = 0;
+    bool writable_ = false;
+    
+public:
+    explicit CellRef(DataValue& value) : detached_(&value), writable_(true) {}
+    CellRef(const DataSet& dataset, size_t column, size_t row, bool writable)
+        : dataset_(&dataset), column_(column), row_(row), writable_(writable) {}
+    
+    CellRef& operator=(const DataValue& value);
+    CellRef& operator=(const CellRef& other) { return *this = other.get(); }
+    
+    DataValue get() const;
+    operator DataValue() const { return get(); }
+};
+
+// Pending cell values for the row currently flowing through a fused pipeline
+// pass. A DataRecord viewed through an overlay sees these values in place of
+// the underlying cells (or as extra columns when the name is new).
+class RowOverlay {
+private:
+    std::vector<std::string> columns_;
+    string_flat_hash_map<size_t> index_;
+    std::vector<DataValue> values_;
+    std::vector<bool> present_;
+    
+public:
+    explicit RowOverlay(std::vector<std::string> columns);
+    
+    const std::vector<std::string>& get_columns() const { return columns_; }
+    std::optional<size_t> slot(const std::string& column) const;
+    const DataValue* find(const std::string& column) const;
+    bool is_set(size_t slot) const { return present_[slot]; }
+    const DataValue& value(size_t slot) const { return values_[slot]; }
+    
+    void set(size_t slot, DataValue value);
+    void clear() { std::fill(present_.begin(), present_.end(), false); }
+};
+
+// Data Record - represents a single row of data.
+// A record is normally a lightweight view of one row of a DataSet; a record
+// built from a DataRow is detached and owns its cells (e.g. for add_record).
 class DataRecord {
 private:
-    DataRow data_;
+    DataRow data_;                      // cells of a detached record
+    const DataSet* dataset_ = nullptr;  // viewed DataSet, nullptr when detached
+    const RowOverlay* overlay_ = nullptr;
+    size_t row_ = 0;
+    bool writable_ = false;
     
 public:
     DataRecord() = default;
     explicit DataRecord(DataRow data) : data_(std::move(data)) {}
+    DataRecord(DataSet& dataset, size_t row) : dataset_(&dataset), row_(row), writable_(true) {}
+    DataRecord(const DataSet& dataset, size_t row) : dataset_(&dataset), row_(row) {}
+    DataRecord(const DataSet& dataset, size_t row, const RowOverlay& overlay)
+        : dataset_(&dataset), overlay_(&overlay), row_(row) {}
     
     // Access operators
-    DataValue& operator[](const std::string& column) { return data_[column]; }
-    const DataValue& operator[](const std::string& column) const;
+    CellRef operator[](const std::string& column);
+    DataValue operator[](const std::string& column) const;
+    // As the const operator[], reporting a missing column instead of throwing
+    Result<DataValue> try_get(const std::string& column) const;
     
     // Utility methods
     bool has_column(const std::string& column) const;
     std::vector<std::string> get_columns() const;
-    size_t size() const { return data_.size(); }
-    bool empty() const { return data_.empty(); }
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+    
+    // View information
+    bool is_view() const { return dataset_ != nullptr; }
+    size_t row_index() const { return row_; }
     
-    // Iteration support
-    auto begin() { return data_.begin(); }
-    auto end() { return data_.end(); }
-    auto begin() const { return data_.begin(); }
-    auto end() const { return data_.end(); }
+    // Copy the cells out into an owning row
+    DataRow to_row() const;
     
     // Comparison operators
-    bool operator==(const DataRecord& other) const { return data_ == other.data_; }
-    bool operator!=(const DataRecord& other) const { return data_ != other.data_; }
+    bool operator==(const DataRecord& other) const { return to_row() == other.to_row(); }
+    bool operator!=(const DataRecord& other) const { return !(*this == other); }
     
     // String representation
     std::string to_string() const;
@@ -89,109 +423,194 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const DataRecord& record);
 };
 
-// Custom iterator for filtered data access
-template<typename Iterator, typename Predicate>
-class FilteredIterator {
+// Random access iterator over the rows of a DataSet, yielding DataRecord views
+template<typename DataSetType>
+class RowIterator {
 public:
-    using iterator_category = std::forward_iterator_tag;
-    using value_type = typename std::iterator_traits<Iterator>::value_type;
-    using difference_type = typename std::iterator_traits<Iterator>::difference_type;
-    using pointer = typename std::iterator_traits<Iterator>::pointer;
-    using reference = typename std::iterator_traits<Iterator>::reference;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = DataRecord;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = DataRecord;
     
 private:
-    Iterator current_;
-    Iterator end_;
-    Predicate predicate_;
-    
-    void advance_to_valid() {
-        while (current_ != end_ && !predicate_(*current_)) {
-            ++current_;
-        }
-    }
+    DataSetType* dataset_ = nullptr;
+    size_t row_ = 0;
     
 public:
-    FilteredIterator(Iterator current, Iterator end, Predicate pred)
-        : current_(current), end_(end), predicate_(pred) {
-        advance_to_valid();
-    }
-    
-    reference operator*() const { return *current_; }
-    pointer operator->() const { return current_.operator->(); }
+    RowIterator() = default;
+    RowIterator(DataSetType* dataset, size_t row) : dataset_(dataset), row_(row) {}
     
-    FilteredIterator& operator++() {
-        ++current_;
-        advance_to_valid();
-        return *this;
-    }
+    reference operator*() const { return DataRecord(*dataset_, row_); }
+    reference operator[](difference_type n) const { return DataRecord(*dataset_, row_ + n); }
     
-    FilteredIterator operator++(int) {
-        auto temp = *this;
-        ++(*this);
-        return temp;
+    RowIterator& operator++() { ++row_; return *this; }
+    RowIterator operator++(int) { auto temp = *this; ++row_; return temp; }
+    RowIterator& operator--() { --row_; return *this; }
+    RowIterator operator--(int) { auto temp = *this; --row_; return temp; }
+    RowIterator& operator+=(difference_type n) { row_ += n; return *this; }
+    RowIterator& operator-=(difference_type n) { row_ -= n; return *this; }
+    RowIterator operator+(difference_type n) const { return RowIterator(dataset_, row_ + n); }
+    RowIterator operator-(difference_type n) const { return RowIterator(dataset_, row_ - n); }
+    difference_type operator-(const RowIterator& other) const {
+        return static_cast<difference_type>(row_) - static_cast<difference_type>(other.row_);
     }
     
-    bool operator==(const FilteredIterator& other) const { return current_ == other.current_; }
-    bool operator!=(const FilteredIterator& other) const { return current_ != other.current_; }
+    bool operator==(const RowIterator& other) const { return row_ == other.row_; }
+    bool operator!=(const RowIterator& other) const { return row_ != other.row_; }
+    bool operator<(const RowIterator& other) const { return row_ < other.row_; }
 };
 
-// Data Set - collection of data records with processing capabilities
+// Data Set - collection of data records with processing capabilities.
+// Storage is columnar: one typed Column per column name, all of equal length.
 class DataSet {
 private:
-    std::vector<DataRecord> records_;
     std::vector<std::string> columns_;
+    std::vector<Column> data_;
+    string_flat_hash_map<size_t> column_index_;
+    size_t rows_ = 0;
+    
+    friend class GroupByState;
+    
+    DataSet joined(const DataSet& right, const std::vector<std::string>& left_keys,
+                   const std::vector<std::string>& right_keys, JoinKind kind,
+                   const Joins::Matches& matches) const;
+    
+    // Rows in [begin, end) that match predicate, in order
+    std::vector<size_t> select_rows(const FilterPredicate& predicate, size_t begin, size_t end) const;
     
 public:
+    using iterator = RowIterator<DataSet>;
+    using const_iterator = RowIterator<const DataSet>;
+    
     DataSet() = default;
-    explicit DataSet(std::vector<std::string> columns) : columns_(std::move(columns)) {}
+    explicit DataSet(std::vector<std::string> columns);
+    DataSet(std::vector<std::string> columns, std::vector<Column> data);
     
     // Data access
-    void add_record(DataRecord record);
-    const DataRecord& operator[](size_t index) const { return records_[index]; }
-    DataRecord& operator[](size_t index) { return records_[index]; }
+    void add_record(const DataRecord& record);
+    DataRecord operator[](size_t index) const { return DataRecord(*this, index); }
+    DataRecord operator[](size_t index) { return DataRecord(*this, index); }
     
     // Size and capacity
-    size_t size() const { return records_.size(); }
-    bool empty() const { return records_.empty(); }
-    void reserve(size_t capacity) { records_.reserve(capacity); }
+    size_t size() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+    void reserve(size_t capacity);
+    size_t cell_bytes() const;   // of all columns, see Column::cell_bytes
     
     // Column management
     const std::vector<std::string>& get_columns() const { return columns_; }
     void add_column(const std::string& name);
     bool has_column(const std::string& name) const;
+    std::optional<size_t> find_column(const std::string& name) const;
+    
+    // Column buffer access
+    const Column& column(const std::string& name) const;
+    const Column& column_at(size_t index) const { return data_[index]; }
+    Column& column_at(size_t index) { return data_[index]; }
+    void set_column(const std::string& name, Column values);
+    void encode_dictionary(const std::string& name);
     
     // Iteration
-    auto begin() { return records_.begin(); }
-    auto end() { return records_.end(); }
-    auto begin() const { return records_.begin(); }
-    auto end() const { return records_.end(); }
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, rows_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, rows_); }
     
-    // Filtered iteration
+    // Filtered iteration: a lazy view over the rows matching pred, or any
+    // other adaptor chain from range_adaptors.hpp, e.g.
+    //   dataset | lazy::views::filter(pred) | lazy::views::take(10)
     template<typename Predicate>
-    auto filtered_begin(Predicate pred) {
-        return FilteredIterator(records_.begin(), records_.end(), pred);
+    auto filtered(Predicate pred) {
+        return lazy::views::filter(*this, std::move(pred));
     }
     
     template<typename Predicate>
-    auto filtered_end(Predicate pred) {
-        return FilteredIterator(records_.end(), records_.end(), pred);
+    auto filtered(Predicate pred) const {
+        return lazy::views::filter(*this, std::move(pred));
     }
     
-    // Data operations
+    // Data operations. The ExecutionPolicy overloads of filter,
+    // transform_column and aggregate_column run by morsel; their predicate
+    // or function is called from several threads at once.
     DataSet filter(FilterPredicate predicate) const;
+    DataSet filter(FilterPredicate predicate, const ExecutionPolicy& policy) const;
+    DataSet take(const std::vector<size_t>& rows, Column::Allocator alloc = {}) const;
+    DataSet slice(size_t begin, size_t end, Column::Allocator alloc = {}) const;
+    DataSet select(const std::vector<std::string>& columns, Column::Allocator alloc = {}) const;
+    void append(DataSet other);
     void transform_column(const std::string& column, TransformFunction func);
+    void transform_column(const std::string& column, TransformFunction func, const ExecutionPolicy& policy);
     void sort_by_column(const std::string& column, bool ascending = true);
+    void sort_by_column(const std::string& column, bool ascending, const ExecutionPolicy& policy);
+    
+    // Stable sort by several keys, the first most significant (see sorting.hpp)
+    void sort_by(const std::vector<SortKey>& keys);
+    void sort_by(const std::vector<SortKey>& keys, const ExecutionPolicy& policy);
+    
+    // The permutation sort_by applies: row order[i] moves to position i
+    std::vector<size_t> sort_order(const std::vector<SortKey>& keys) const;
+    std::vector<size_t> sort_order(const std::vector<SortKey>& keys, const ExecutionPolicy& policy) const;
+    
+    // The first k rows sort_by(keys) would produce, without sorting the rest
+    DataSet top_k(const std::vector<SortKey>& keys, size_t k) const;
+    DataSet top_k(const std::vector<SortKey>& keys, size_t k, const ExecutionPolicy& policy) const;
     
     // Aggregation operations
     DataValue aggregate_column(const std::string& column, AggregateFunction func) const;
+    // Built-in aggregates of numeric columns combine per-morsel partials
+    // (Sum, Mean and StdDev to rounding); any other runs serially
+    DataValue aggregate_column(const std::string& column, AggregateFunction func,
+                               const ExecutionPolicy& policy) const;
     std::unordered_map<std::string, DataValue> group_by_aggregate(
         const std::string& group_column, 
         const std::string& value_column, 
         AggregateFunction func) const;
+    std::unordered_map<std::string, DataValue> group_by_aggregate(
+        const std::string& group_column, 
+        const std::string& value_column, 
+        AggregateFunction func,
+        const ExecutionPolicy& policy) const;
+    
+    // Hash aggregation over one or more key columns (see group_by.cpp):
+    // one row per distinct key in order of first appearance, the key
+    // columns followed by one column per aggregate
+    DataSet group_by(const std::vector<std::string>& key_columns,
+                     const std::vector<GroupAggregate>& aggregates) const;
+    
+    // Hash join with right as the build side (see join.hpp); left key
+    // column i matches right key column i. Rows come in this DataSet's
+    // order, a row's matches in right's order. The output has this
+    // DataSet's columns, then (but for Semi) right's, less the keys named
+    // like the left key they match; other clashing names get "_right".
+    DataSet join(const DataSet& right, const std::vector<std::string>& keys,
+                 JoinKind kind = JoinKind::Inner) const;
+    DataSet join(const DataSet& right, const std::vector<std::string>& left_keys,
+                 const std::vector<std::string>& right_keys, JoinKind kind = JoinKind::Inner) const;
+    DataSet join(const DataSet& right, const std::vector<std::string>& left_keys,
+                 const std::vector<std::string>& right_keys, JoinKind kind,
+                 const ExecutionPolicy& policy) const;
     
     // I/O operations
     static DataSet load_from_csv(const std::string& filename);
+    // As load_from_csv, reporting a file that cannot be opened instead of throwing
+    static Result<DataSet> try_load_from_csv(const std::string& filename);
+    static DataSet load_from_csv_parallel(const std::string& filename, size_t threads = 0);
+    // Every .csv file under directory (subdirectories included) as one
+    // DataSet, concatenated in path order; the files must share a header
+    static DataSet load_from_csv_directory(const std::string& directory, size_t threads = 0);
     void save_to_csv(const std::string& filename) const;
+    void write_csv(std::ostream& out, bool include_header = true) const;
+    
+    // Binary columnar cache files (see columnar_file.hpp); loading reads only
+    // the named columns (all when empty)
+    static DataSet load_columnar(const std::string& filename,
+                                 const std::vector<std::string>& columns = {});
+    // Rows matching predicate, skipping chunks whose statistics rule it out
+    static DataSet load_columnar(const std::string& filename, const FilterPredicate& predicate,
+                                 const std::vector<std::string>& columns = {});
+    void save_columnar(const std::string& filename) const;
+    void save_columnar(const std::string& filename, const ColumnarOptions& options) const;
     
     // String representation
     std::string to_string(size_t max_rows = 10) const;
@@ -199,7 +618,110 @@ public:
     friend std::ostream& operator<<(std::ostream& os, const DataSet& dataset);
 };
 
-// Statistics calculator
+// Approximate quantiles in bounded memory (a KLL sketch). Level h holds
+// samples of weight 2^h; once the sketch is full the lowest over-capacity
+// level is sorted and every other sample promoted, which keeps O(k) samples
+// per ~log(n / k) levels. Which half survives comes from a fixed-seed
+// generator, so results are reproducible.
+class QuantileSketch {
+private:
+    size_t k_;
+    size_t count_ = 0;
+    uint64_t random_state_ = 0x9E3779B97F4A7C15ull;
+    std::vector<std::vector<double>> levels_;
+    
+    size_t capacity(size_t level) const;
+    void compress();
+    bool compact_one();
+    
+public:
+    explicit QuantileSketch(size_t k = 200);
+    
+    void add(double value);
+    void merge(const QuantileSketch& other);
+    
+    // Value at the given fraction (0..1) of the sorted input
+    double quantile(double fraction) const;
+    
+    size_t count() const { return count_; }
+    size_t retained() const;
+};
+
+// Approximate counts of values in fixed memory (a Count-Min sketch): depth
+// rows of width counters; a value adds to one counter per row, picked by a
+// hash seeded per row, and its estimate is the smallest of them. An
+// estimate is never below the true count, and exceeds it by more than
+// e * total() / width with probability at most e^-depth. Values are told
+// apart by type and content: a String and a dictionary-encoded column count
+// the same text alike, while 5 and 5.0 are different values.
+class CountMinSketch {
+private:
+    size_t width_;
+    size_t depth_;
+    uint64_t total_ = 0;
+    std::vector<uint64_t> counters_;   // depth_ rows of width_
+    
+    void add_hash(uint64_t hash, uint64_t count);
+    uint64_t estimate_hash(uint64_t hash) const;
+    
+public:
+    explicit CountMinSketch(size_t width = 2048, size_t depth = 4);
+    
+    // Every cell; a dictionary column adds each code once, with its count
+    void add(const Column& values);
+    void add(const DataValue& value, uint64_t count = 1);
+    // Sketches of the same width and depth only (std::invalid_argument otherwise)
+    void merge(const CountMinSketch& other);
+    
+    uint64_t estimate(const DataValue& value) const;
+    uint64_t total() const { return total_; }
+};
+
+// The most frequent values in bounded memory (Space-Saving): one counter
+// per value for up to capacity values. A value without a counter once all
+// are taken replaces the value with the smallest count and starts from that
+// count, which it records as its error. A counter is never below its
+// value's true count nor above it by more than its error, and every value
+// seen more than total() / capacity times has one. Values are told apart
+// by a 64-bit hash of their type and content, as in CountMinSketch.
+class HeavyHitters {
+public:
+    struct Entry {
+        DataValue value;
+        uint64_t count = 0;
+        uint64_t error = 0;   // count exceeds the true count by at most this
+    };
+    
+private:
+    size_t capacity_;
+    uint64_t total_ = 0;
+    std::vector<Entry> entries_;
+    std::vector<uint64_t> hashes_;             // of each entry's value
+    std::vector<size_t> heap_;                 // entry indices, min-heap on count
+    std::vector<size_t> heap_slot_;            // each entry's position in heap_
+    flat_hash_map<uint64_t, size_t> index_;    // value hash -> entry
+    
+    DataValue* offer(uint64_t hash, uint64_t count);
+    void sift_up(size_t slot);
+    void sift_down(size_t slot);
+    void rebuild();
+    
+public:
+    explicit HeavyHitters(size_t capacity = 64);
+    
+    // Every cell; a dictionary column offers each code once, with its count
+    void add(const Column& values);
+    void add(const DataValue& value, uint64_t count = 1);
+    // Missing counters count as the other summary's smallest one when it
+    // is full, so the merged counters keep both bounds
+    void merge(const HeavyHitters& other);
+    
+    // The k largest counts, largest first
+    std::vector<Entry> top(size_t k) const;
+    uint64_t total() const { return total_; }
+    size_t capacity() const { return capacity_; }
+};
+
 class Statistics {
 public:
     struct DescriptiveStats {
@@ -213,24 +735,129 @@ public:
         std::string to_string() const;
     };
     
+    // Single-pass count/mean/variance/min/max in O(1) memory (Welford's
+    // update, plus a Kahan-compensated sum); accumulators can be merged
+    class Accumulator {
+    private:
+        size_t count_ = 0;
+        double mean_ = 0.0;
+        double m2_ = 0.0;
+        double sum_ = 0.0;
+        double compensation_ = 0.0;
+        double min_ = std::numeric_limits<double>::infinity();
+        double max_ = -std::numeric_limits<double>::infinity();
+        
+    public:
+        void add(double value);
+        void merge(const Accumulator& other);
+        
+        size_t count() const { return count_; }
+        double sum() const { return sum_ + compensation_; }
+        double mean() const { return mean_; }
+        double variance() const { return count_ ? m2_ / count_ : 0.0; }   // population
+        double std_dev() const;
+        double min() const { return count_ ? min_ : 0.0; }
+        double max() const { return count_ ? max_ : 0.0; }
+    };
+    
+    // Descriptive statistics of the numeric cells of one column, folded in
+    // batch by batch: an Accumulator and a QuantileSketch, so the median is
+    // approximate. States of separate rows merge into that of all of them.
+    class RunningStats {
+    private:
+        Accumulator accumulator_;
+        QuantileSketch sketch_;
+        
+    public:
+        explicit RunningStats(size_t k = 200) : sketch_(k) {}
+        
+        void update(const Column& values);
+        void merge(const RunningStats& other);
+        DescriptiveStats stats() const;
+        
+        const Accumulator& accumulator() const { return accumulator_; }
+        const QuantileSketch& sketch() const { return sketch_; }
+    };
+    
+    // Covariance and correlation of every pair of a set of columns, in one
+    // pass over the rows. A pair uses the rows where both of its cells are
+    // numeric, as correlation() does. Rows are taken in blocks: the block's
+    // cells are gathered to doubles and centred on their block means, the
+    // co-moments of every pair of columns numeric throughout the block come
+    // from Kernels::dot_products, and the block is merged into the running
+    // moments by Chan's formula (other pairs take a scalar pass). States of
+    // separate rows merge into that of all of them to rounding, so threads
+    // can each take a range of rows.
+    class CovarianceMatrix {
+    private:
+        struct Moments {
+            size_t count = 0;
+            double mean_x = 0.0;
+            double mean_y = 0.0;
+            double m2_x = 0.0;
+            double m2_y = 0.0;
+            double c_xy = 0.0;
+            
+            void merge(const Moments& other);
+        };
+        
+        std::vector<std::string> columns_;
+        std::vector<Moments> pairs_;   // upper triangle, diagonal included, row by row
+        
+        size_t pair_index(size_t i, size_t j) const;
+        
+    public:
+        explicit CovarianceMatrix(std::vector<std::string> columns);
+        
+        void update(const DataSet& rows);
+        void update(const DataSet& rows, size_t begin, size_t end);   // rows [begin, end)
+        void merge(const CovarianceMatrix& other);                     // same columns
+        
+        const std::vector<std::string>& columns() const { return columns_; }
+        size_t count(size_t i, size_t j) const { return pairs_[pair_index(i, j)].count; }
+        double covariance(size_t i, size_t j) const;    // population
+        double correlation(size_t i, size_t j) const;   // 0 below two rows or for a constant column
+    };
+    
+    // Exact: nth_element over one copy of the numeric cells.
+    // Approximate: a QuantileSketch, for columns too large to copy.
+    enum class Precision { Exact, Approximate };
+    
     static DescriptiveStats calculate(const std::vector<DataValue>& values);
-    static DescriptiveStats calculate_column(const DataSet& dataset, const std::string& column);
+    static DescriptiveStats calculate_column(const DataSet& dataset, const std::string& column,
+                                             Precision precision = Precision::Exact);
+    
+    // Percentile with linear interpolation between ranks (fraction in 0..1)
+    static double percentile(const DataSet& dataset, const std::string& column, double fraction,
+                             Precision precision = Precision::Exact);
+    static QuantileSketch sketch_column(const DataSet& dataset, const std::string& column,
+                                        size_t k = 200);
     
-    // Correlation analysis
+    // Correlation analysis (the statistics functions below are implemented
+    // in statistics.cpp)
     static double correlation(const DataSet& dataset, 
                             const std::string& col1, 
                             const std::string& col2);
+    static CovarianceMatrix covariance_matrix(const DataSet& dataset, const std::vector<std::string>& columns);
+    // One state per morsel, merged in morsel order (parallel_execution.cpp)
+    static CovarianceMatrix covariance_matrix(const DataSet& dataset, const std::vector<std::string>& columns,
+                                              const ExecutionPolicy& policy);
     
-    // Frequency analysis
+    // Frequency analysis: exact counts keyed by each value's text. Typed
+    // columns count their numbers or dictionary codes and format each
+    // distinct value once.
     static std::unordered_map<std::string, size_t> frequency_count(
         const DataSet& dataset, const std::string& column);
+    static HeavyHitters heavy_hitters(const DataSet& dataset, const std::string& column, size_t capacity = 64);
 };
 
-// Performance monitor
+// Performance monitor: prints the time an operation took and records it
+// as a span (category "monitor") in the trace, see tracing.hpp
 class PerformanceMonitor {
 private:
     std::chrono::high_resolution_clock::time_point start_time_;
     std::string operation_name_;
+    Tracing::Span span_;
     
 public:
     explicit PerformanceMonitor(std::string operation_name);
@@ -248,10 +875,58 @@ public:
 // Macro for easy performance monitoring
 #define MONITOR_PERFORMANCE(name) PerformanceMonitor _monitor(name)
 
-// Processing Pipeline - chains operations together
+// Processing Pipeline - chains operations together.
+// Operations are recorded as a logical plan and only planned when the
+// pipeline runs: filters whose columns are known (those built by the Filters
+// namespace) move ahead of add_column/transform stages they do not depend on,
+// each run of row-local stages executes as one fused pass per record, and
+// columns untouched by the run are gathered once at its end.
 class Pipeline {
 private:
-    std::vector<std::function<void(DataSet&)>> operations_;
+    friend class IncrementalPipeline;
+    
+    struct Stage {
+        enum class Kind { Filter, Transform, AddColumn, Select, Sort, TopK };
+        
+        Kind kind;
+        std::string column;                          // transform/add_column target
+        FilterPredicate predicate;
+        std::optional<std::vector<std::string>> reads;  // filter columns, when known
+        TransformFunction transform;
+        std::function<DataValue(const DataRecord&)> calculator;
+        std::vector<std::string> columns;            // select list
+        std::vector<SortKey> keys;                   // sort/top_k keys
+        size_t limit = 0;                            // top_k row count
+        
+        explicit Stage(Kind stage_kind) : kind(stage_kind) {}
+        
+        // Needs the whole input
+        bool blocking() const { return kind == Kind::Sort || kind == Kind::TopK; }
+        std::string describe() const;
+    };
+    
+    // One step of the physical plan: row-local stages fused into a single
+    // pass, ended by either a projection (select) or a blocking stage
+    struct PlanStep {
+        std::vector<const Stage*> fused;
+        const Stage* projection = nullptr;
+        const Stage* blocking = nullptr;
+        
+        const Stage* boundary() const { return projection ? projection : blocking; }
+        std::string describe() const;
+        // describe(), interned as a span name; "" while tracing is off
+        const char* trace_name() const;
+    };
+    
+    std::vector<Stage> operations_;
+    
+    std::vector<PlanStep> plan() const;
+    static DataSet run_fused(const DataSet& input, const PlanStep& step,
+                             size_t begin = 0, size_t end = static_cast<size_t>(-1),
+                             Column::Allocator alloc = {});
+    static void run_blocking(DataSet& dataset, const Stage& stage);
+    void run_streaming(BatchSource& source, const std::vector<PlanStep>& steps, size_t first_step,
+                       BatchSink& sink, const StreamingOptions& options) const;
     
 public:
     Pipeline() = default;
@@ -260,12 +935,31 @@ public:
     Pipeline& filter(FilterPredicate predicate);
     Pipeline& transform(const std::string& column, TransformFunction func);
     Pipeline& sort_by(const std::string& column, bool ascending = true);
+    Pipeline& sort_by(std::vector<SortKey> keys);
+    Pipeline& top_k(const std::string& column, size_t k, bool ascending = true);
+    Pipeline& top_k(std::vector<SortKey> keys, size_t k);
     Pipeline& add_column(const std::string& name, 
                         std::function<DataValue(const DataRecord&)> calculator);
+    Pipeline& select(std::vector<std::string> columns);
     
     // Execute the pipeline
     DataSet execute(DataSet input) const;
     
+    // Execute on a thread pool: fused passes run per morsel and blocking
+    // stages use a parallel merge sort. The result matches execute(input);
+    // filters, transforms and calculators must be safe to call concurrently.
+    DataSet execute(DataSet input, const ExecutionPolicy& policy) const;
+    
+    // Execute in bounded batches pulled from source and pushed into sink
+    // (see streaming.hpp); top_k keeps only its best rows, sort_by sorts
+    // within a memory budget and merges spilled runs beyond it
+    void execute_streaming(BatchSource& source, BatchSink& sink) const;
+    void execute_streaming(BatchSource& source, BatchSink& sink,
+                           const StreamingOptions& options) const;
+    
+    // Describe the optimized physical plan
+    std::string explain() const;
+    
     // Clear the pipeline
     void clear() { operations_.clear(); }
     
@@ -275,6 +969,20 @@ public:
 
 // Common aggregate functions
 namespace Aggregates {
+    // The built-in aggregates are Builtin functors, which lets
+    // DataSet::aggregate_column run them straight on a numeric column buffer
+    // with the kernels from simd_kernels.hpp instead of per-value dispatch
+    enum class Kind { Sum, Mean, Min, Max, Count, StdDev };
+    
+    struct Builtin {
+        Kind kind;
+        
+        DataValue operator()(const std::vector<DataValue>& values) const;
+        DataValue on_column(const Column& column) const;   // column.is_numeric()
+    };
+    
+    const char* kind_name(Kind kind);
+    
     extern const AggregateFunction Sum;
     extern const AggregateFunction Mean;
     extern const AggregateFunction Min;
@@ -283,8 +991,97 @@ namespace Aggregates {
     extern const AggregateFunction StdDev;
 }
 
+// One output column of DataSet::group_by
+struct GroupAggregate {
+    std::string column;
+    Aggregates::Kind kind;
+    std::string name;   // output column name; empty: "<column>_<kind>"
+};
+
+// Running state of DataSet::group_by (see group_by.cpp) that rows are
+// folded into batch by batch, in memory proportional to the number of
+// groups. result() is group_by over every row seen, as if the batches had
+// been appended into one DataSet; merge() adds another state's groups as
+// if its rows came after this state's. (Min and Max of a column that ends
+// up Mixed depend on row order when it holds NaN, or numbers and strings;
+// after merge() they can then differ from those of a single pass.)
+class GroupByState {
+private:
+    class GroupTable;
+    class AggregateColumn;
+    
+    std::vector<std::string> key_columns_;
+    std::vector<GroupAggregate> aggregates_;
+    std::vector<std::string> names_;        // output columns
+    DataSet keys_;                          // key cells of each group
+    std::vector<bool> by_text_;             // key columns compared by their text
+    std::unique_ptr<GroupTable> table_;
+    std::vector<AggregateColumn> outputs_;
+    
+    void compare_by_text(const std::vector<const Column*>& incoming);
+    template<typename Fold>
+    void add_rows(const DataSet& rows, const std::vector<const Column*>& key_cells, Fold&& fold);
+    
+public:
+    GroupByState(std::vector<std::string> key_columns, std::vector<GroupAggregate> aggregates);
+    GroupByState(const GroupByState& other);
+    GroupByState& operator=(const GroupByState& other);
+    GroupByState(GroupByState&&) noexcept;
+    GroupByState& operator=(GroupByState&&) noexcept;
+    ~GroupByState();
+    
+    void update(const DataSet& rows);
+    void merge(const GroupByState& other);   // same keys and aggregates
+    void clear();                            // drop every group
+    DataSet result() const;
+    size_t groups() const;
+};
+
 // Common filter predicates
 namespace Filters {
+    // Inspectable form of the predicates built below: comparisons of one
+    // column against a constant, combined by logical nodes. Scans over
+    // chunked storage read it to skip chunks whose statistics rule out a
+    // match (see ColumnarFile::candidate_chunks).
+    struct Expression {
+        enum class Op { Equals, GreaterThan, LessThan, Contains, And, Or, Not };
+        
+        Op op;
+        std::string column;   // comparisons
+        DataValue value;      // comparisons; the substring for Contains
+        std::vector<std::shared_ptr<const Expression>> children;   // And, Or, Not
+        
+        bool is_comparison() const { return op < Op::And; }
+        
+        // The test a comparison applies to one cell of its column
+        std::function<bool(const DataValue&)> cell_test() const;
+        
+        std::string to_string() const;
+    };
+    
+    // Predicate that records which columns it reads, so the Pipeline planner
+    // can reorder it. The functions below wrap their lambdas in it; custom
+    // predicates can do the same to take part in filter pushdown.
+    struct ColumnPredicate {
+        std::vector<std::string> columns;
+        std::function<bool(const DataRecord&)> test;
+        
+        // Set when the predicate is a test of columns[0]'s value alone; lets a
+        // dictionary column be filtered by testing each distinct value once
+        std::function<bool(const DataValue&)> cell;
+        
+        // Set when the predicate was built from Filters functions only
+        std::shared_ptr<const Expression> expression;
+        
+        bool operator()(const DataRecord& record) const { return test(record); }
+    };
+    
+    // Columns a predicate reads, if it is known
+    std::optional<std::vector<std::string>> columns_read(const FilterPredicate& predicate);
+    
+    // Expression tree of a predicate, or nullptr for an opaque one
+    std::shared_ptr<const Expression> expression_of(const FilterPredicate& predicate);
+    
     FilterPredicate column_equals(const std::string& column, const DataValue& value);
     FilterPredicate column_greater_than(const std::string& column, const DataValue& value);
     FilterPredicate column_less_than(const std::string& column, const DataValue& value);
@@ -0,0 +1,251 @@
+/*
+ * Data Processing Pipeline - DataValue
+ *
+ * One cell of a row: a 64-bit integer, a double, a string or null, in 16
+ * bytes (std::variant<int, double, std::string> took 40). The kind sits in
+ * the last byte. A string of up to 14 bytes is stored inline, with its
+ * length in the byte before the kind, so short text costs no allocation.
+ * A longer one lives in a reference-counted immutable block, and copying
+ * the value only bumps the count.
+ *
+ *   DataValue id = int64_t{4'000'000'000};
+ *   DataValue name = "Alice";              // inline
+ *   if (name.is_string()) use(name.as_string());
+ *   value.visit([](auto cell) { ... });    // int64_t, double, string_view or Null
+ *
+ * - Kinds are numbered as the variant's alternatives were (Int, Double,
+ *   String) with Null after them, so index() keeps its meaning
+ * - Comparisons follow std::variant: kinds order first (Int < Double <
+ *   String < Null), then values; an Int never equals a Double
+ * - A long string is allocated from the memory resource passed when the
+ *   value is built (the default resource otherwise) and handed back to it
+ *   by the last copy. Every copy of such a value must therefore be gone
+ *   before the resource is.
+ * - The counts are atomic, so copies of one value can be used and dropped
+ *   on different threads
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace DataProcessing {
+
+class DataValue {
+public:
+    enum class Kind : uint8_t { Int, Double, String, Null };
+    
+    // What visit passes for a null value
+    struct Null {};
+    
+    static constexpr size_t INLINE_CAPACITY = 14;
+    
+private:
+    // Header of a long string's block; the characters follow it
+    struct LongString {
+        std::atomic<uint32_t> references;
+        size_t size;
+        std::pmr::memory_resource* resource;
+        
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+    
+    static constexpr uint8_t LONG = 0xFF;   // length byte of a long string
+    static constexpr size_t LENGTH = 14;
+    static constexpr size_t KIND = 15;
+    
+    // Payload in bytes 0-7 (an int64_t, double or LongString*) or 0-13
+    // (inline characters), the inline length in byte 14, the kind in 15
+    alignas(8) unsigned char bytes_[16];
+    
+    template<typename T>
+    T load() const {
+        T value;
+        std::memcpy(&value, bytes_, sizeof(T));
+        return value;
+    }
+    
+    template<typename T>
+    void store(T value) {
+        std::memcpy(bytes_, &value, sizeof(T));
+    }
+    
+    void set_kind(Kind kind) { bytes_[KIND] = static_cast<unsigned char>(kind); }
+    bool is_long() const { return is_string() && bytes_[LENGTH] == LONG; }
+    LongString* block() const { return load<LongString*>(); }
+    
+    // Make this a string of size characters, uninitialized, and return them;
+    // the kind is set last, so a failed allocation leaves the value as it was
+    char* allocate_string(size_t size, std::pmr::memory_resource* resource) {
+        if (size <= INLINE_CAPACITY) {
+            bytes_[LENGTH] = static_cast<unsigned char>(size);
+            set_kind(Kind::String);
+            return reinterpret_cast<char*>(bytes_);
+        }
+        void* memory = resource->allocate(sizeof(LongString) + size, alignof(LongString));
+        LongString* block = new (memory) LongString{{1}, size, resource};
+        store(block);
+        bytes_[LENGTH] = LONG;
+        set_kind(Kind::String);
+        return block->data();
+    }
+    
+    void release() noexcept {
+        if (is_long()) {
+            LongString* string = block();
+            if (string->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                size_t size = string->size;
+                std::pmr::memory_resource* resource = string->resource;
+                string->~LongString();
+                resource->deallocate(string, sizeof(LongString) + size, alignof(LongString));
+            }
+        }
+    }
+    
+public:
+    DataValue() noexcept { set_kind(Kind::Null); }
+    
+    template<typename Integer,
+             std::enable_if_t<std::is_integral_v<Integer> && !std::is_same_v<Integer, bool>, int> = 0>
+    DataValue(Integer value) noexcept {
+        store(static_cast<int64_t>(value));
+        set_kind(Kind::Int);
+    }
+    
+    template<typename Real, std::enable_if_t<std::is_floating_point_v<Real>, int> = 0>
+    DataValue(Real value) noexcept {
+        store(static_cast<double>(value));
+        set_kind(Kind::Double);
+    }
+    
+    DataValue(std::string_view text, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        char* characters = allocate_string(text.size(), resource);
+        if (!text.empty()) {
+            std::memcpy(characters, text.data(), text.size());
+        }
+    }
+    
+    DataValue(const char* text) : DataValue(std::string_view(text)) {}
+    
+    template<typename Allocator>
+    DataValue(const std::basic_string<char, std::char_traits<char>, Allocator>& text)
+        : DataValue(std::string_view(text)) {}
+    
+    DataValue(bool) = delete;
+    
+    DataValue(const DataValue& other) noexcept {
+        std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+        if (is_long()) {
+            block()->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    DataValue(DataValue&& other) noexcept {
+        std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+        other.set_kind(Kind::Null);
+    }
+    
+    DataValue& operator=(const DataValue& other) noexcept {
+        if (this != &other) {
+            DataValue copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    
+    DataValue& operator=(DataValue&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::memcpy(bytes_, other.bytes_, sizeof(bytes_));
+            other.set_kind(Kind::Null);
+        }
+        return *this;
+    }
+    
+    ~DataValue() { release(); }
+    
+    // The string a + b, built with at most one allocation
+    static DataValue concat(std::string_view a, std::string_view b,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        DataValue result;
+        char* characters = result.allocate_string(a.size() + b.size(), resource);
+        if (!a.empty()) std::memcpy(characters, a.data(), a.size());
+        if (!b.empty()) std::memcpy(characters + a.size(), b.data(), b.size());
+        return result;
+    }
+    
+    Kind kind() const { return static_cast<Kind>(bytes_[KIND]); }
+    size_t index() const { return static_cast<size_t>(kind()); }
+    
+    bool is_int() const { return kind() == Kind::Int; }
+    bool is_double() const { return kind() == Kind::Double; }
+    bool is_string() const { return kind() == Kind::String; }
+    bool is_null() const { return kind() == Kind::Null; }
+    bool is_numeric() const { return is_int() || is_double(); }
+    
+    // Unchecked access: the value must be of the kind asked for
+    int64_t as_int() const { return load<int64_t>(); }
+    double as_double() const { return load<double>(); }
+    std::string_view as_string() const {
+        if (is_long()) {
+            LongString* string = block();
+            return std::string_view(string->data(), string->size);
+        }
+        return std::string_view(reinterpret_cast<const char*>(bytes_), bytes_[LENGTH]);
+    }
+    
+    // True for a string held in a shared block rather than inline
+    bool is_long_string() const { return is_long(); }
+    
+    // f(int64_t), f(double), f(std::string_view) or f(Null{})
+    template<typename Function>
+    decltype(auto) visit(Function&& f) const {
+        switch (kind()) {
+            case Kind::Int:    return f(as_int());
+            case Kind::Double: return f(as_double());
+            case Kind::String: return f(as_string());
+            case Kind::Null:   break;
+        }
+        return f(Null{});
+    }
+    
+    friend bool operator==(const DataValue& a, const DataValue& b) {
+        if (a.kind() != b.kind()) return false;
+        switch (a.kind()) {
+            case Kind::Int:    return a.as_int() == b.as_int();
+            case Kind::Double: return a.as_double() == b.as_double();
+            case Kind::String: return a.as_string() == b.as_string();
+            case Kind::Null:   break;
+        }
+        return true;
+    }
+    
+    friend bool operator<(const DataValue& a, const DataValue& b) {
+        if (a.kind() != b.kind()) return a.kind() < b.kind();
+        switch (a.kind()) {
+            case Kind::Int:    return a.as_int() < b.as_int();
+            case Kind::Double: return a.as_double() < b.as_double();
+            case Kind::String: return a.as_string() < b.as_string();
+            case Kind::Null:   break;
+        }
+        return false;
+    }
+    
+    friend bool operator!=(const DataValue& a, const DataValue& b) { return !(a == b); }
+    friend bool operator>(const DataValue& a, const DataValue& b) { return b < a; }
+    friend bool operator<=(const DataValue& a, const DataValue& b) { return !(b < a); }
+    friend bool operator>=(const DataValue& a, const DataValue& b) { return !(a < b); }
+};
+
+static_assert(sizeof(DataValue) == 16, "DataValue should fit in 16 bytes");
+
+} // namespace DataProcessing
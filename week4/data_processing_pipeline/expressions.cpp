@@ -0,0 +1,453 @@
+/*
+ * Data Processing Pipeline - Compiled Expressions Implementation
+ *
+ * Builders and row-at-a-time evaluation for Expressions::Arithmetic, and the
+ * batch evaluators CompiledFilter and CompiledArithmetic.
+ */
+
+#include "expressions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace DataProcessing {
+namespace Expressions {
+
+namespace {
+    using Op = Node::Op;
+    using FilterOp = Filters::Expression::Op;
+    
+    std::shared_ptr<const Node> make_node(Op op, std::vector<std::shared_ptr<const Node>> children) {
+        return std::make_shared<const Node>(Node{op, {}, 0.0, std::move(children)});
+    }
+    
+    Arithmetic binary(Op op, const Arithmetic& a, const Arithmetic& b) {
+        return Arithmetic(make_node(op, {a.node(), b.node()}));
+    }
+    
+    Arithmetic unary(Op op, const Arithmetic& a) {
+        return Arithmetic(make_node(op, {a.node()}));
+    }
+    
+    // Evaluate node for one row; leaf supplies Column and Input values
+    template <typename Leaf>
+    double evaluate_row(const Node& node, const Leaf& leaf) {
+        switch (node.op) {
+            case Op::Column:
+            case Op::Input:    return leaf(node);
+            case Op::Constant: return node.constant;
+            case Op::Add:      return evaluate_row(*node.children[0], leaf) + evaluate_row(*node.children[1], leaf);
+            case Op::Subtract: return evaluate_row(*node.children[0], leaf) - evaluate_row(*node.children[1], leaf);
+            case Op::Multiply: return evaluate_row(*node.children[0], leaf) * evaluate_row(*node.children[1], leaf);
+            case Op::Divide:   return evaluate_row(*node.children[0], leaf) / evaluate_row(*node.children[1], leaf);
+            case Op::Negate:   return -evaluate_row(*node.children[0], leaf);
+            case Op::Abs:      return std::abs(evaluate_row(*node.children[0], leaf));
+            case Op::Sqrt:     return std::sqrt(evaluate_row(*node.children[0], leaf));
+        }
+        return 0.0;
+    }
+    
+    void collect_columns(const Node& node, std::vector<std::string>& columns) {
+        if (node.op == Op::Column &&
+            std::find(columns.begin(), columns.end(), node.column) == columns.end()) {
+            columns.push_back(node.column);
+        }
+        for (const auto& child : node.children) {
+            collect_columns(*child, columns);
+        }
+    }
+    
+    // out[i] = keep(rows[i]), for one comparison over a column buffer
+    template <typename Keep>
+    void fill(const size_t* rows, size_t count, uint8_t* out, Keep keep) {
+        if (count > 0 && rows[count - 1] - rows[0] == count - 1) {
+            // A run of consecutive rows (every batch, until a filter narrows
+            // it) indexes the column directly, which lets the loop vectorize
+            size_t first = rows[0];
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = keep(first + i) ? 1 : 0;
+            }
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = keep(rows[i]) ? 1 : 0;
+        }
+    }
+    
+    // ValueOps::to_string prints doubles with six decimals, so two doubles
+    // further apart than this never print the same
+    constexpr double print_resolution = 2e-6;
+}
+
+std::string Node::to_string() const {
+    auto child = [this](size_t i) { return children[i]->to_string(); };
+    switch (op) {
+        case Op::Column:   return column;
+        case Op::Input:    return "value";
+        case Op::Constant: {
+            std::ostringstream oss;
+            oss << constant;
+            return oss.str();
+        }
+        case Op::Add:      return "(" + child(0) + " + " + child(1) + ")";
+        case Op::Subtract: return "(" + child(0) + " - " + child(1) + ")";
+        case Op::Multiply: return "(" + child(0) + " * " + child(1) + ")";
+        case Op::Divide:   return "(" + child(0) + " / " + child(1) + ")";
+        case Op::Negate:   return "-" + child(0);
+        case Op::Abs:      return "abs(" + child(0) + ")";
+        case Op::Sqrt:     return "sqrt(" + child(0) + ")";
+    }
+    return "";
+}
+
+// Arithmetic
+std::vector<std::string> Arithmetic::columns() const {
+    std::vector<std::string> names;
+    collect_columns(*node_, names);
+    return names;
+}
+
+DataValue Arithmetic::operator()(const DataRecord& record) const {
+    return evaluate_row(*node_, [&record](const Node& leaf) {
+        if (leaf.op == Op::Input) {
+            throw std::logic_error("Arithmetic over a transform input used as a calculator");
+        }
+        return ValueOps::to_double(record[leaf.column]);
+    });
+}
+
+Arithmetic::Arithmetic(double value) : node_(constant(value).node()) {}
+
+Arithmetic column(const std::string& name) {
+    return Arithmetic(std::make_shared<const Node>(Node{Op::Column, name, 0.0, {}}));
+}
+
+Arithmetic constant(double value) {
+    return Arithmetic(std::make_shared<const Node>(Node{Op::Constant, {}, value, {}}));
+}
+
+Arithmetic input() {
+    return Arithmetic(std::make_shared<const Node>(Node{Op::Input, {}, 0.0, {}}));
+}
+
+Arithmetic operator+(const Arithmetic& a, const Arithmetic& b) { return binary(Op::Add, a, b); }
+Arithmetic operator-(const Arithmetic& a, const Arithmetic& b) { return binary(Op::Subtract, a, b); }
+Arithmetic operator*(const Arithmetic& a, const Arithmetic& b) { return binary(Op::Multiply, a, b); }
+Arithmetic operator/(const Arithmetic& a, const Arithmetic& b) { return binary(Op::Divide, a, b); }
+Arithmetic operator-(const Arithmetic& a) { return unary(Op::Negate, a); }
+Arithmetic abs(const Arithmetic& a) { return unary(Op::Abs, a); }
+Arithmetic sqrt(const Arithmetic& a) { return unary(Op::Sqrt, a); }
+
+DataValue NumericTransform::operator()(const DataValue& value) const {
+    if (!ValueOps::is_numeric(value)) {
+        return value;
+    }
+    double input = ValueOps::to_double(value);
+    return evaluate_row(*node, [input](const Node& leaf) {
+        if (leaf.op == Op::Column) {
+            throw std::logic_error("Numeric transform reads column " + leaf.column);
+        }
+        return input;
+    });
+}
+
+// CompiledFilter
+struct CompiledFilter::Term {
+    FilterOp op;
+    std::vector<std::shared_ptr<const Term>> children;   // And, Or, Not
+    
+    // Comparisons; column is null when input has no such column
+    const Column* column = nullptr;
+    DataValue value;
+    std::string text;                               // ValueOps::to_string(value)
+    std::function<bool(const DataValue&)> cell;     // exact test of one cell
+    std::vector<uint8_t> code_matches;              // dictionary columns
+    
+    void refine(std::vector<size_t>& selection) const;
+    
+    // out[i] = whether rows[i] matches
+    void test(const size_t* rows, size_t count, uint8_t* out) const;
+    void test_numeric(const size_t* rows, size_t count, uint8_t* out) const;
+};
+
+CompiledFilter::CompiledFilter(const Filters::Expression& expression, const DataSet& input)
+    : root_(compile(expression, input)) {}
+
+void CompiledFilter::refine(std::vector<size_t>& selection) const {
+    root_->refine(selection);
+}
+
+std::shared_ptr<const CompiledFilter::Term> CompiledFilter::compile(const Filters::Expression& expression,
+                                                                    const DataSet& input) {
+    auto term = std::make_shared<Term>();
+    term->op = expression.op;
+    if (!expression.is_comparison()) {
+        for (const auto& child : expression.children) {
+            term->children.push_back(compile(*child, input));
+        }
+        return term;
+    }
+    
+    term->value = expression.value;
+    term->text = ValueOps::to_string(expression.value);
+    term->cell = expression.cell_test();
+    if (input.has_column(expression.column)) {
+        term->column = &input.column(expression.column);
+        if (term->column->type() == ColumnType::Dictionary) {
+            term->code_matches = term->column->dictionary().dictionary->matches(term->cell);
+        }
+    }
+    return term;
+}
+
+void CompiledFilter::Term::refine(std::vector<size_t>& selection) const {
+    if (op == FilterOp::And) {
+        // Each side only sees the rows the ones before it kept
+        children[0]->refine(selection);
+        children[1]->refine(selection);
+        return;
+    }
+    std::vector<uint8_t> mask(selection.size());
+    test(selection.data(), selection.size(), mask.data());
+    
+    // Rows are written unconditionally and the write position advanced by
+    // the outcome, so the loop has no data-dependent branch
+    size_t kept = 0;
+    for (size_t i = 0; i < selection.size(); ++i) {
+        selection[kept] = selection[i];
+        kept += mask[i];
+    }
+    selection.resize(kept);
+}
+
+void CompiledFilter::Term::test(const size_t* rows, size_t count, uint8_t* out) const {
+    switch (op) {
+        case FilterOp::And:
+        case FilterOp::Or: {
+            children[0]->test(rows, count, out);
+            std::vector<uint8_t> other(count);
+            children[1]->test(rows, count, other.data());
+            if (op == FilterOp::And) {
+                for (size_t i = 0; i < count; ++i) out[i] &= other[i];
+            } else {
+                for (size_t i = 0; i < count; ++i) out[i] |= other[i];
+            }
+            return;
+        }
+        case FilterOp::Not:
+            children[0]->test(rows, count, out);
+            for (size_t i = 0; i < count; ++i) out[i] ^= 1;
+            return;
+        default:
+            break;
+    }
+    
+    if (!column) {
+        std::fill(out, out + count, 0);   // comparisons fail on a missing column
+        return;
+    }
+    switch (column->type()) {
+        case ColumnType::Int64:
+        case ColumnType::Double:
+            if (ValueOps::is_numeric(value) && op != FilterOp::Contains) {
+                test_numeric(rows, count, out);
+            } else {
+                fill(rows, count, out, [this](size_t row) { return cell(column->get(row)); });
+            }
+            break;
+        case ColumnType::String: {
+            // Every comparison of a string cell is a comparison of text
+            const auto& cells = column->strings();
+            std::string_view target = text;
+            switch (op) {
+                case FilterOp::Equals:
+                    fill(rows, count, out, [&](size_t row) { return std::string_view(cells[row]) == target; });
+                    break;
+                case FilterOp::GreaterThan:
+                    fill(rows, count, out, [&](size_t row) { return std::string_view(cells[row]) > target; });
+                    break;
+                case FilterOp::LessThan:
+                    fill(rows, count, out, [&](size_t row) { return std::string_view(cells[row]) < target; });
+                    break;
+                default:
+                    fill(rows, count, out, [&](size_t row) {
+                        return std::string_view(cells[row]).find(target) != std::string_view::npos;
+                    });
+                    break;
+            }
+            break;
+        }
+        case ColumnType::Dictionary: {
+            const uint32_t* codes = column->dictionary().codes.data();
+            const uint8_t* matches = code_matches.data();
+            fill(rows, count, out, [=](size_t row) { return matches[codes[row]] != 0; });
+            break;
+        }
+        case ColumnType::Mixed: {
+            const auto& cells = column->values();
+            fill(rows, count, out, [&](size_t row) { return cell(cells[row]); });
+            break;
+        }
+    }
+}
+
+// A numeric column against a numeric constant. Int64 cells read as int and
+// print without a decimal point, doubles always print with one, so a cell
+// and the constant can only print the same when both are ints or both are
+// doubles; for two doubles only a cell within print_resolution needs the
+// exact test.
+void CompiledFilter::Term::test_numeric(const size_t* rows, size_t count, uint8_t* out) const {
+    double v = ValueOps::to_double(value);
+    bool int_cells = column->type() == ColumnType::Int64;
+    bool int_value = value.is_int();
+    
+    auto numeric_pass = [&](auto load) {
+        if (int_cells == int_value) {
+            if (int_cells) {
+                // Two ints print the same exactly when they are equal
+                switch (op) {
+                    case FilterOp::Equals:      fill(rows, count, out, [&](size_t row) { return load(row) == v; }); break;
+                    case FilterOp::GreaterThan: fill(rows, count, out, [&](size_t row) { return load(row) > v; }); break;
+                    default:                    fill(rows, count, out, [&](size_t row) { return load(row) < v; }); break;
+                }
+                return;
+            }
+            if (op == FilterOp::LessThan) {
+                fill(rows, count, out, [&](size_t row) { return load(row) < v; });
+                return;
+            }
+            if (!std::isfinite(v)) {
+                fill(rows, count, out, [&](size_t row) { return cell(load(row)); });
+                return;
+            }
+            // A numeric pass first; then the few cells near v get the exact
+            // test, so the first loop has no calls in it
+            auto near = [&](double x) { return std::abs(x - v) <= print_resolution; };
+            if (op == FilterOp::Equals) {
+                fill(rows, count, out, [&](size_t row) { return near(load(row)); });
+                for (size_t i = 0; i < count; ++i) {
+                    if (out[i]) out[i] = std::to_string(load(rows[i])) == text;
+                }
+            } else {
+                fill(rows, count, out, [&](size_t row) { return !(load(row) < v); });
+                for (size_t i = 0; i < count; ++i) {
+                    if (out[i] && near(load(rows[i]))) out[i] = std::to_string(load(rows[i])) != text;
+                }
+            }
+            return;
+        }
+        switch (op) {
+            case FilterOp::Equals:      std::fill(out, out + count, 0); break;
+            case FilterOp::GreaterThan: fill(rows, count, out, [&](size_t row) { return !(load(row) < v); }); break;
+            default:                    fill(rows, count, out, [&](size_t row) { return load(row) < v; }); break;
+        }
+    };
+    
+    if (int_cells) {
+        const int64_t* cells = column->ints().data();
+        numeric_pass([cells](size_t row) { return static_cast<double>(cells[row]); });
+    } else {
+        const double* cells = column->doubles().data();
+        numeric_pass([cells](size_t row) { return cells[row]; });
+    }
+}
+
+// CompiledArithmetic
+std::optional<CompiledArithmetic> CompiledArithmetic::compile(const Node& node, const DataSet& input,
+                                                              const Column* input_column) {
+    CompiledArithmetic compiled;
+    size_t depth = 0;
+    
+    // Emit node in postfix order, tracking the stack depth it reaches
+    std::function<bool(const Node&)> emit = [&](const Node& current) {
+        for (const auto& child : current.children) {
+            if (!emit(*child)) return false;
+        }
+        Instruction instruction{current.op};
+        if (current.op == Op::Column || current.op == Op::Input) {
+            const Column* source = current.op == Op::Input ? input_column
+                : input.has_column(current.column) ? &input.column(current.column) : nullptr;
+            if (!source || !source->is_numeric()) return false;
+            if (source->type() == ColumnType::Int64) {
+                instruction.ints = source->ints().data();
+            } else {
+                instruction.doubles = source->doubles().data();
+            }
+        } else if (current.op == Op::Constant) {
+            instruction.constant = current.constant;
+        }
+        
+        if (current.children.empty()) {
+            compiled.depth_ = std::max(compiled.depth_, ++depth);
+        } else if (current.children.size() == 2) {
+            --depth;
+        }
+        compiled.program_.push_back(instruction);
+        return true;
+    };
+    
+    if (!emit(node)) {
+        return std::nullopt;
+    }
+    compiled.stack_.resize(compiled.depth_ * batch_rows);
+    return compiled;
+}
+
+void CompiledArithmetic::evaluate(size_t begin, size_t end, double* out) {
+    for (size_t batch = begin; batch < end; batch += batch_rows) {
+        size_t count = std::min(batch_rows, end - batch);
+        size_t top = 0;   // stack entries in use
+        auto slot = [this](size_t entry) { return stack_.data() + entry * batch_rows; };
+        
+        for (const Instruction& instruction : program_) {
+            switch (instruction.op) {
+                case Op::Column:
+                case Op::Input: {
+                    double* target = slot(top++);
+                    if (instruction.ints) {
+                        const int64_t* cells = instruction.ints + batch;
+                        for (size_t i = 0; i < count; ++i) {
+                            target[i] = static_cast<double>(cells[i]);
+                        }
+                    } else {
+                        std::copy(instruction.doubles + batch, instruction.doubles + batch + count, target);
+                    }
+                    break;
+                }
+                case Op::Constant:
+                    std::fill(slot(top), slot(top) + count, instruction.constant);
+                    ++top;
+                    break;
+                case Op::Negate:
+                case Op::Abs:
+                case Op::Sqrt: {
+                    double* a = slot(top - 1);
+                    if (instruction.op == Op::Negate) {
+                        for (size_t i = 0; i < count; ++i) a[i] = -a[i];
+                    } else if (instruction.op == Op::Abs) {
+                        for (size_t i = 0; i < count; ++i) a[i] = std::abs(a[i]);
+                    } else {
+                        for (size_t i = 0; i < count; ++i) a[i] = std::sqrt(a[i]);
+                    }
+                    break;
+                }
+                default: {
+                    double* a = slot(top - 2);
+                    const double* b = slot(top - 1);
+                    switch (instruction.op) {
+                        case Op::Add:      for (size_t i = 0; i < count; ++i) a[i] += b[i]; break;
+                        case Op::Subtract: for (size_t i = 0; i < count; ++i) a[i] -= b[i]; break;
+                        case Op::Multiply: for (size_t i = 0; i < count; ++i) a[i] *= b[i]; break;
+                        default:           for (size_t i = 0; i < count; ++i) a[i] /= b[i]; break;
+                    }
+                    --top;
+                    break;
+                }
+            }
+        }
+        std::copy(slot(0), slot(0) + count, out + (batch - begin));
+    }
+}
+
+}
+} // namespace DataProcessing
@@ -0,0 +1,120 @@
+/*
+ * Data Processing Pipeline - Compiled Expressions
+ *
+ * A small expression IR for filters, transforms and add_column calculators.
+ * Row-at-a-time evaluation goes through std::function, DataRecord's by-name
+ * lookups and DataValue visits for every cell; compiling an expression
+ * against a DataSet instead binds each column name to its typed buffer once
+ * and evaluates a batch of rows per call:
+ * - filters (Filters::Expression trees) narrow a selection vector of row
+ *   numbers, with one tight loop per comparison over the column's buffer
+ * - arithmetic (Expressions::Arithmetic, and the numeric Transforms) runs as
+ *   a small stack program over batches of doubles
+ *
+ * Compiled results match row-at-a-time evaluation exactly; cells whose
+ * outcome depends on ValueOps' string forms are decided by the same
+ * comparison the Filters functions make.
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+
+namespace DataProcessing {
+namespace Expressions {
+    // Rows per batch for compiled evaluation: selection vectors and
+    // arithmetic scratch for a batch stay in the L1/L2 cache
+    constexpr size_t batch_rows = 1024;
+    
+    // Arithmetic over numeric cells, evaluated in double
+    struct Node {
+        enum class Op { Column, Input, Constant, Add, Subtract, Multiply, Divide, Negate, Abs, Sqrt };
+        
+        Op op;
+        std::string column;     // Column
+        double constant = 0.0;  // Constant
+        std::vector<std::shared_ptr<const Node>> children;
+        
+        std::string to_string() const;
+    };
+    
+    // Builder and add_column calculator: column("price") * column("qty") + 5.
+    // Called on a record it reads each column's cell with ValueOps::to_double.
+    class Arithmetic {
+    private:
+        std::shared_ptr<const Node> node_;
+    
+    public:
+        explicit Arithmetic(std::shared_ptr<const Node> node) : node_(std::move(node)) {}
+        Arithmetic(double value);   // a constant, so that column("x") * 2 reads naturally
+        
+        const std::shared_ptr<const Node>& node() const { return node_; }
+        std::vector<std::string> columns() const;
+        
+        DataValue operator()(const DataRecord& record) const;
+    };
+    
+    Arithmetic column(const std::string& name);
+    Arithmetic constant(double value);
+    Arithmetic input();   // the value a NumericTransform is applied to
+    
+    Arithmetic operator+(const Arithmetic& a, const Arithmetic& b);
+    Arithmetic operator-(const Arithmetic& a, const Arithmetic& b);
+    Arithmetic operator*(const Arithmetic& a, const Arithmetic& b);
+    Arithmetic operator/(const Arithmetic& a, const Arithmetic& b);
+    Arithmetic operator-(const Arithmetic& a);
+    Arithmetic abs(const Arithmetic& a);
+    Arithmetic sqrt(const Arithmetic& a);
+    
+    // Transform of one value written as arithmetic over Op::Input; numeric
+    // values are replaced by the result, others pass through unchanged.
+    // The numeric Transforms are built this way.
+    struct NumericTransform {
+        std::shared_ptr<const Node> node;
+        
+        DataValue operator()(const DataValue& value) const;
+    };
+    
+    // Filter expression bound to a DataSet's columns
+    class CompiledFilter {
+    private:
+        struct Term;
+        std::shared_ptr<const Term> root_;
+        
+        static std::shared_ptr<const Term> compile(const Filters::Expression& expression, const DataSet& input);
+    
+    public:
+        CompiledFilter(const Filters::Expression& expression, const DataSet& input);
+        
+        // Drop the rows of selection (ascending row numbers) that do not match
+        void refine(std::vector<size_t>& selection) const;
+    };
+    
+    // Arithmetic bound to a DataSet's numeric columns, evaluated for ranges
+    // of rows. Not thread-safe: it keeps scratch space for its stack.
+    class CompiledArithmetic {
+    private:
+        struct Instruction {
+            Node::Op op;
+            const int64_t* ints = nullptr;
+            const double* doubles = nullptr;
+            double constant = 0.0;
+        };
+        
+        std::vector<Instruction> program_;   // postfix
+        size_t depth_ = 0;
+        std::vector<double> stack_;
+        
+        CompiledArithmetic() = default;
+    
+    public:
+        // Fails (nullopt) unless every column read is an Int64 or Double
+        // column of input; input_column stands in for Op::Input
+        static std::optional<CompiledArithmetic> compile(const Node& node, const DataSet& input,
+                                                         const Column* input_column = nullptr);
+        
+        // Values for rows [begin, end) into out[0, end - begin)
+        void evaluate(size_t begin, size_t end, double* out);
+    };
+}
+} // namespace DataProcessing
@@ -0,0 +1,564 @@
+/*
+ * Data Processing Pipeline - Hash Aggregation
+ *
+ * DataSet::group_by runs on a GroupByState. The state maps every row to a
+ * group through an open-addressing hash table keyed on the typed key cells
+ * themselves. A group keeps its key cells, and probing compares them with
+ * the row's cells in the typed buffers, so no key strings are built. Each
+ * group keeps running aggregate state (row count plus a
+ * Statistics::Accumulator), so memory is proportional to the number of
+ * groups rather than the number of rows.
+ *
+ * A GroupByState outlives its input: rows can be folded in batch by batch,
+ * for instance as they are appended to a file. Key and value columns may
+ * come with a different type in a later batch. The state then behaves as
+ * group_by over the batches appended into one DataSet, where such a column
+ * would be Mixed: its keys compare by their text from then on, and min/max
+ * compare DataValues.
+ */
+
+#include "data_processor.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace DataProcessing {
+
+namespace {
+    uint64_t mix(uint64_t value) {
+        // splitmix64 finalizer
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+    
+    uint64_t hash_text(std::string_view text) {
+        return std::hash<std::string_view>()(text);
+    }
+    
+    // Text of a String or Dictionary cell
+    std::string_view text_at(const Column& column, size_t row) {
+        if (column.type() == ColumnType::Dictionary) {
+            return column.dictionary().at(row);
+        }
+        return column.strings()[row];
+    }
+    
+    // Hashing over the cells of one key column. Cells of different columns
+    // (a new batch and the stored group keys) hash alike when they are
+    // equal: typed columns by value, text by its characters whether
+    // dictionary-encoded or not, and Mixed columns by their text.
+    class KeyColumn {
+    private:
+        const Column* column_;
+        bool by_text_;
+        std::vector<uint64_t> code_hashes_;   // Dictionary: hash of each value
+        
+    public:
+        KeyColumn(const Column& column, bool by_text)
+            : column_(&column), by_text_(by_text && !column.is_text()) {
+            if (column.type() == ColumnType::Dictionary) {
+                const StringDictionary& dictionary = *column.dictionary().dictionary;
+                code_hashes_.reserve(dictionary.size());
+                for (uint32_t code = 0; code < dictionary.size(); ++code) {
+                    code_hashes_.push_back(hash_text(dictionary[code]));
+                }
+            }
+        }
+        
+        uint64_t hash(size_t row) const {
+            switch (by_text_ ? ColumnType::Mixed : column_->type()) {
+                case ColumnType::Int64:
+                    return mix(static_cast<uint64_t>(column_->ints()[row]));
+                case ColumnType::Double: {
+                    uint64_t bits;
+                    std::memcpy(&bits, &column_->doubles()[row], sizeof(bits));
+                    return mix(bits);
+                }
+                case ColumnType::String:
+                    return hash_text(column_->strings()[row]);
+                case ColumnType::Dictionary:
+                    return code_hashes_[column_->dictionary().codes[row]];
+                case ColumnType::Mixed:
+                    break;
+            }
+            // Mixed cells group by their text, like group_by_aggregate
+            return hash_text(ValueOps::to_string(column_->get(row)));
+        }
+    };
+    
+    // Equality of a cell of one key column with a cell of another (or the
+    // same) column, set up once per pair of columns
+    class KeyMatch {
+    private:
+        enum class Mode { Int64, Double, Codes, Text, ByText };
+        
+        const Column* a_;
+        const Column* b_;
+        Mode mode_;
+        
+    public:
+        KeyMatch(const Column& a, const Column& b, bool by_text) : a_(&a), b_(&b) {
+            if (a.is_text() && b.is_text()) {
+                bool shared = a.type() == ColumnType::Dictionary && b.type() == ColumnType::Dictionary &&
+                              a.dictionary().dictionary == b.dictionary().dictionary;
+                mode_ = shared ? Mode::Codes : Mode::Text;
+            } else if (by_text) {
+                mode_ = Mode::ByText;
+            } else {
+                mode_ = a.type() == ColumnType::Int64 ? Mode::Int64 : Mode::Double;
+            }
+        }
+        
+        bool operator()(size_t row_a, size_t row_b) const {
+            switch (mode_) {
+                case Mode::Int64:
+                    return a_->ints()[row_a] == b_->ints()[row_b];
+                case Mode::Double:
+                    // Bitwise, so NaN keys form one group
+                    return std::memcmp(&a_->doubles()[row_a], &b_->doubles()[row_b], sizeof(double)) == 0;
+                case Mode::Codes:
+                    return a_->dictionary().codes[row_a] == b_->dictionary().codes[row_b];
+                case Mode::Text:
+                    return text_at(*a_, row_a) == text_at(*b_, row_b);
+                case Mode::ByText:
+                    break;
+            }
+            return ValueOps::to_string(a_->get(row_a)) == ValueOps::to_string(b_->get(row_b));
+        }
+    };
+    
+    uint64_t hash_row(const std::vector<KeyColumn>& keys, size_t row) {
+        uint64_t hash = 0;
+        for (const auto& key : keys) {
+            hash = mix(hash ^ key.hash(row));
+        }
+        return hash;
+    }
+    
+    bool equal_rows(const std::vector<KeyMatch>& keys, size_t row_a, size_t row_b) {
+        for (const auto& key : keys) {
+            if (!key(row_a, row_b)) return false;
+        }
+        return true;
+    }
+}
+
+// Open-addressing (linear probing) table from key hash to group index.
+// Slots hold group index + 1 so that zero marks an empty slot; the table
+// doubles when half full, rehashing from the stored group hashes.
+class GroupByState::GroupTable {
+private:
+    std::vector<uint32_t> slots_;
+    std::vector<uint64_t> hashes_;
+    size_t mask_;
+    
+    void grow() {
+        std::vector<uint32_t> slots(slots_.size() * 2, 0);
+        size_t mask = slots.size() - 1;
+        for (size_t group = 0; group < hashes_.size(); ++group) {
+            size_t slot = hashes_[group] & mask;
+            while (slots[slot] != 0) slot = (slot + 1) & mask;
+            slots[slot] = static_cast<uint32_t>(group + 1);
+        }
+        slots_.swap(slots);
+        mask_ = mask;
+    }
+    
+public:
+    GroupTable() : slots_(64, 0), mask_(63) {}
+    
+    size_t size() const { return hashes_.size(); }
+    
+    // Group whose key matches (per same_key(group)), inserting a new one if none does
+    template<typename SameKey>
+    size_t find_or_insert(uint64_t hash, SameKey&& same_key, bool& inserted) {
+        size_t slot = hash & mask_;
+        while (slots_[slot] != 0) {
+            size_t group = slots_[slot] - 1;
+            if (hashes_[group] == hash && same_key(group)) {
+                inserted = false;
+                return group;
+            }
+            slot = (slot + 1) & mask_;
+        }
+        
+        size_t group = hashes_.size();
+        if (group >= std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Too many groups");
+        }
+        hashes_.push_back(hash);
+        slots_[slot] = static_cast<uint32_t>(group + 1);
+        if (hashes_.size() * 2 > slots_.size()) {
+            grow();
+        }
+        inserted = true;
+        return group;
+    }
+};
+
+// Running state of one aggregate for every group
+class GroupByState::AggregateColumn {
+private:
+    // Running state of one aggregate for one group
+    struct GroupState {
+        size_t rows = 0;
+        Statistics::Accumulator numbers;
+        std::optional<DataValue> min, max;   // non-numeric columns only
+        bool first_nan = false;              // Double columns: the first value was NaN
+    };
+    
+    Aggregates::Kind kind_;
+    std::optional<ColumnType> type_;   // of the value column over all rows so far
+    bool has_rows_ = false;
+    std::vector<GroupState> states_;
+    
+    // The value column of the batch being folded in, and its buffer when
+    // it is numeric and the column has been so far
+    const Column* column_ = nullptr;
+    const int64_t* ints_ = nullptr;
+    const double* doubles_ = nullptr;
+    
+    bool numeric() const { return type_ == ColumnType::Int64 || type_ == ColumnType::Double; }
+    bool keeps_values() const { return kind_ == Aggregates::Kind::Min || kind_ == Aggregates::Kind::Max; }
+    
+    void add_value(GroupState& state, const DataValue& value) {
+        if (ValueOps::is_numeric(value)) {
+            state.numbers.add(ValueOps::to_double(value));
+        }
+        if (keeps_values()) {
+            if (!state.min || ValueOps::compare_less(value, *state.min)) state.min = value;
+            if (!state.max || ValueOps::compare_less(*state.max, value)) state.max = value;
+        }
+    }
+    
+    // Fold the numeric rows of from into the DataValue extremes of state,
+    // with the result add_value would have had row by row: a leading NaN
+    // sticks, later ones are passed over
+    void add_extremes(GroupState& state, const GroupState& from, bool integer) {
+        auto fold = [&state](const DataValue& value) {
+            if (!state.min || ValueOps::compare_less(value, *state.min)) state.min = value;
+            if (!state.max || ValueOps::compare_less(*state.max, value)) state.max = value;
+        };
+        auto value = [integer](double number) -> DataValue {
+            if (integer) return static_cast<int64_t>(number);
+            return number;
+        };
+        if (from.first_nan) {
+            fold(std::numeric_limits<double>::quiet_NaN());
+        }
+        if (from.numbers.count() > 0 && from.numbers.min() <= from.numbers.max()) {   // not all NaN
+            fold(value(from.numbers.min()));
+            fold(value(from.numbers.max()));
+        }
+    }
+    
+    // Rows of another type make the column Mixed: numeric extremes so far
+    // become DataValues
+    void adopt_type(ColumnType type) {
+        if (!type_ || !has_rows_) {
+            type_ = type;
+            return;
+        }
+        bool both_text = (*type_ == ColumnType::String || *type_ == ColumnType::Dictionary) &&
+                         (type == ColumnType::String || type == ColumnType::Dictionary);
+        if (*type_ == type || both_text) {
+            return;
+        }
+        if (numeric() && keeps_values()) {
+            bool integer = *type_ == ColumnType::Int64;
+            for (auto& state : states_) {
+                add_extremes(state, state, integer);
+            }
+        }
+        type_ = ColumnType::Mixed;
+    }
+    
+public:
+    explicit AggregateColumn(Aggregates::Kind kind) : kind_(kind) {}
+    
+    void add_group() { states_.emplace_back(); }
+    
+    // Take the value column of the next batch (an empty one sets the type
+    // only while there are no rows yet)
+    void bind(const Column& column) {
+        if (!column.empty() || !has_rows_) adopt_type(column.type());
+        column_ = &column;
+        bool buffer = column.type() == type_;
+        ints_ = buffer && type_ == ColumnType::Int64 ? column.ints().data() : nullptr;
+        doubles_ = buffer && type_ == ColumnType::Double ? column.doubles().data() : nullptr;
+    }
+    
+    // Take the type of another state's column, before merging its groups
+    void adopt_type_of(const AggregateColumn& other) {
+        if (other.type_ && (other.has_rows_ || !has_rows_)) adopt_type(*other.type_);
+    }
+    
+    // Fold row of the bound column into group
+    void update(size_t group, size_t row) {
+        GroupState& state = states_[group];
+        ++state.rows;
+        has_rows_ = true;
+        if (ints_) {
+            state.numbers.add(static_cast<double>(ints_[row]));
+        } else if (doubles_) {
+            if (state.rows == 1) state.first_nan = std::isnan(doubles_[row]);
+            state.numbers.add(doubles_[row]);
+        } else {
+            add_value(state, column_->get(row));
+        }
+    }
+    
+    void merge(size_t group, const AggregateColumn& other, size_t other_group) {
+        has_rows_ = true;
+        GroupState& state = states_[group];
+        const GroupState& from = other.states_[other_group];
+        if (state.rows == 0) state.first_nan = from.first_nan;
+        state.rows += from.rows;
+        state.numbers.merge(from.numbers);
+        if (!keeps_values() || numeric()) {
+            return;
+        }
+        if (other.numeric()) {
+            add_extremes(state, from, *other.type_ == ColumnType::Int64);
+        } else if (from.min) {
+            if (!state.min || ValueOps::compare_less(*from.min, *state.min)) state.min = from.min;
+            if (!state.max || ValueOps::compare_less(*state.max, *from.max)) state.max = from.max;
+        }
+    }
+    
+    Column finish() const {
+        Column result;
+        switch (kind_) {
+            case Aggregates::Kind::Count:
+                result = Column(ColumnType::Int64);
+                break;
+            case Aggregates::Kind::Min:
+            case Aggregates::Kind::Max:
+                if (numeric()) result = Column(*type_);
+                break;
+            default:
+                result = Column(ColumnType::Double);
+                break;
+        }
+        result.reserve(states_.size());
+        for (const auto& state : states_) {
+            switch (kind_) {
+                case Aggregates::Kind::Sum:
+                    result.append_double(state.numbers.sum());
+                    break;
+                case Aggregates::Kind::Mean:
+                    result.append_double(state.rows ? state.numbers.sum() / state.rows : 0.0);
+                    break;
+                case Aggregates::Kind::Count:
+                    result.append_int64(static_cast<int64_t>(state.rows));
+                    break;
+                case Aggregates::Kind::StdDev:
+                    result.append_double(state.numbers.std_dev());
+                    break;
+                case Aggregates::Kind::Min:
+                case Aggregates::Kind::Max: {
+                    bool is_min = kind_ == Aggregates::Kind::Min;
+                    if (type_ == ColumnType::Int64) {
+                        result.append_int64(static_cast<int64_t>(is_min ? state.numbers.min() : state.numbers.max()));
+                    } else if (type_ == ColumnType::Double) {
+                        result.append_double(is_min ? state.numbers.min() : state.numbers.max());
+                    } else {
+                        result.append(is_min ? *state.min : *state.max);
+                    }
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+};
+
+GroupByState::GroupByState(std::vector<std::string> key_columns, std::vector<GroupAggregate> aggregates)
+    : key_columns_(std::move(key_columns)), aggregates_(std::move(aggregates)),
+      by_text_(key_columns_.size(), false), table_(std::make_unique<GroupTable>()) {
+    names_ = key_columns_;
+    for (const auto& aggregate : aggregates_) {
+        outputs_.emplace_back(aggregate.kind);
+        names_.push_back(aggregate.name.empty()
+            ? aggregate.column + "_" + Aggregates::kind_name(aggregate.kind) : aggregate.name);
+    }
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (std::find(names_.begin() + static_cast<std::ptrdiff_t>(i) + 1, names_.end(), names_[i]) != names_.end()) {
+            throw std::invalid_argument("Duplicate output column: " + names_[i]);
+        }
+    }
+}
+
+GroupByState::GroupByState(const GroupByState& other)
+    : key_columns_(other.key_columns_), aggregates_(other.aggregates_), names_(other.names_),
+      keys_(other.keys_), by_text_(other.by_text_),
+      table_(std::make_unique<GroupTable>(*other.table_)), outputs_(other.outputs_) {}
+
+GroupByState& GroupByState::operator=(const GroupByState& other) {
+    if (this != &other) {
+        GroupByState copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+GroupByState::GroupByState(GroupByState&&) noexcept = default;
+GroupByState& GroupByState::operator=(GroupByState&&) noexcept = default;
+GroupByState::~GroupByState() = default;
+
+size_t GroupByState::groups() const {
+    return table_->size();
+}
+
+void GroupByState::compare_by_text(const std::vector<const Column*>& incoming) {
+    bool changed = false;
+    for (size_t i = 0; i < key_columns_.size(); ++i) {
+        if (by_text_[i] || incoming[i]->empty()) continue;
+        const Column* stored = keys_.get_columns().empty() ? nullptr : &keys_.column_at(i);
+        bool mixed = incoming[i]->type() == ColumnType::Mixed ||
+                     (stored && !stored->empty() && stored->type() != incoming[i]->type() &&
+                      !(stored->is_text() && incoming[i]->is_text()));
+        if (mixed) {
+            by_text_[i] = true;
+            changed = true;
+        }
+    }
+    if (!changed || table_->size() == 0) {
+        return;
+    }
+    
+    // Rehash the groups so far the new way; they keep their order
+    std::vector<KeyColumn> stored;
+    for (size_t i = 0; i < key_columns_.size(); ++i) {
+        stored.emplace_back(keys_.column_at(i), by_text_[i]);
+    }
+    auto table = std::make_unique<GroupTable>();
+    bool inserted = false;
+    for (size_t group = 0; group < keys_.size(); ++group) {
+        table->find_or_insert(hash_row(stored, group), [](size_t) { return false; }, inserted);
+    }
+    table_ = std::move(table);
+}
+
+template<typename Fold>
+void GroupByState::add_rows(const DataSet& rows, const std::vector<const Column*>& key_cells, Fold&& fold) {
+    compare_by_text(key_cells);
+    
+    std::vector<KeyColumn> incoming;
+    std::vector<KeyMatch> same_batch, with_stored;
+    for (size_t i = 0; i < key_columns_.size(); ++i) {
+        incoming.emplace_back(*key_cells[i], by_text_[i]);
+        same_batch.emplace_back(*key_cells[i], *key_cells[i], by_text_[i]);
+        if (!keys_.get_columns().empty()) with_stored.emplace_back(*key_cells[i], keys_.column_at(i), by_text_[i]);
+    }
+    
+    // Groups below known_groups have their keys in keys_; the rest are new
+    // and have theirs at first_rows in rows
+    size_t known_groups = table_->size();
+    std::vector<size_t> first_rows;
+    for (size_t row = 0; row < rows.size(); ++row) {
+        bool inserted = false;
+        size_t group = table_->find_or_insert(hash_row(incoming, row), [&](size_t candidate) {
+            return candidate < known_groups ? equal_rows(with_stored, row, candidate)
+                                            : equal_rows(same_batch, row, first_rows[candidate - known_groups]);
+        }, inserted);
+        
+        if (inserted) {
+            first_rows.push_back(row);
+            for (auto& output : outputs_) output.add_group();
+        }
+        fold(group, row);
+    }
+    
+    // Until there are groups, the (empty) key columns take the latest types
+    if (known_groups == 0 || !first_rows.empty()) {
+        std::vector<Column> data;
+        for (const Column* cells : key_cells) {
+            data.push_back(cells->take(first_rows));
+        }
+        DataSet new_keys(key_columns_, std::move(data));
+        new_keys.rows_ = first_rows.size();   // also right when there are no key columns at all
+        if (known_groups == 0) {
+            keys_ = std::move(new_keys);
+        } else {
+            keys_.append(std::move(new_keys));
+        }
+    }
+}
+
+void GroupByState::update(const DataSet& rows) {
+    std::vector<const Column*> key_cells;
+    for (const auto& name : key_columns_) {
+        key_cells.push_back(&rows.column(name));
+    }
+    for (size_t i = 0; i < aggregates_.size(); ++i) {
+        outputs_[i].bind(rows.column(aggregates_[i].column));
+    }
+    
+    add_rows(rows, key_cells, [&](size_t group, size_t row) {
+        for (auto& output : outputs_) {
+            output.update(group, row);
+        }
+    });
+}
+
+void GroupByState::merge(const GroupByState& other) {
+    if (other.key_columns_ != key_columns_ || other.names_ != names_) {
+        throw std::invalid_argument("Cannot merge group_by states with different keys or aggregates");
+    }
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+        outputs_[i].adopt_type_of(other.outputs_[i]);
+    }
+    if (other.groups() == 0) {
+        // Only the types of its (empty) key columns can carry over
+        if (groups() == 0 && !other.keys_.get_columns().empty()) keys_ = other.keys_;
+        return;
+    }
+    
+    std::vector<const Column*> key_cells;
+    for (size_t i = 0; i < key_columns_.size(); ++i) {
+        key_cells.push_back(&other.keys_.column_at(i));
+    }
+    add_rows(other.keys_, key_cells, [&](size_t group, size_t other_group) {
+        for (size_t i = 0; i < outputs_.size(); ++i) {
+            outputs_[i].merge(group, other.outputs_[i], other_group);
+        }
+    });
+}
+
+void GroupByState::clear() {
+    keys_ = DataSet();
+    by_text_.assign(key_columns_.size(), false);
+    table_ = std::make_unique<GroupTable>();
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+        outputs_[i] = AggregateColumn(aggregates_[i].kind);
+    }
+}
+
+DataSet GroupByState::result() const {
+    std::vector<Column> data;
+    data.reserve(names_.size());
+    for (size_t i = 0; i < key_columns_.size(); ++i) {
+        data.push_back(keys_.get_columns().empty() ? Column() : keys_.column_at(i));   // empty before any update
+    }
+    for (const auto& output : outputs_) {
+        data.push_back(output.finish());
+    }
+    
+    DataSet result(names_, std::move(data));
+    result.rows_ = groups();   // also right when there are no columns at all
+    return result;
+}
+
+DataSet DataSet::group_by(const std::vector<std::string>& key_columns,
+                          const std::vector<GroupAggregate>& aggregates) const {
+    GroupByState state(key_columns, aggregates);
+    state.update(*this);
+    return state.result();
+}
+
+} // namespace DataProcessing
@@ -0,0 +1,302 @@
+/*
+ * Data Processing Pipeline - Incremental Execution Implementation
+ *
+ * CsvTail's reads of a growing file, and IncrementalPipeline's runs: the
+ * change of each plan step's input (appended rows, replaced rows or none)
+ * decides whether the step processes the new rows alone, merges them into
+ * a blocking stage's output, runs again or is skipped.
+ */
+
+#include "incremental.hpp"
+#include "csv_reader.hpp"
+#include "sorting.hpp"
+
+namespace DataProcessing {
+
+namespace {
+    uint64_t combine(uint64_t seed, uint64_t value) {
+        return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+    }
+    
+    uint64_t hash_text(std::string_view text) {
+        return std::hash<std::string_view>()(text);
+    }
+    
+    // Stable merge of added (sorted by keys) into sorted: on ties the rows
+    // already in sorted go first, as they came first in the input
+    void merge_sorted(DataSet& sorted, DataSet added, const std::vector<SortKey>& keys) {
+        std::vector<const Column*> old_keys, new_keys;
+        for (const auto& key : keys) {
+            old_keys.push_back(&sorted.column(key.column));
+            new_keys.push_back(&added.column(key.column));
+        }
+        auto added_first = [&](size_t new_row, size_t old_row) {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                int order = Sorting::compare_cells(*new_keys[i], new_row, *old_keys[i], old_row);
+                if (order != 0) {
+                    return keys[i].ascending ? order < 0 : order > 0;
+                }
+            }
+            return false;
+        };
+        
+        size_t old_rows = sorted.size();
+        size_t new_rows = added.size();
+        std::vector<size_t> order;
+        order.reserve(old_rows + new_rows);
+        size_t old_row = 0, new_row = 0;
+        while (old_row < old_rows && new_row < new_rows) {
+            if (added_first(new_row, old_row)) {
+                order.push_back(old_rows + new_row++);
+            } else {
+                order.push_back(old_row++);
+            }
+        }
+        while (old_row < old_rows) order.push_back(old_row++);
+        while (new_row < new_rows) order.push_back(old_rows + new_row++);
+        
+        sorted.append(std::move(added));
+        sorted = sorted.take(order);
+    }
+}
+
+// CsvTail implementations
+uint64_t CsvTail::fingerprint(std::string_view text) const {
+    return combine(hash_text(text.substr(0, header_end_)),
+                   hash_text(text.substr(last_line_, offset_ - last_line_)));
+}
+
+DataSet CsvTail::read() {
+    MappedFile file(filename_);
+    std::string_view text = file.view();
+    
+    // Rewritten since the last read: start over
+    restarted_ = false;
+    if (offset_ > 0 && (text.size() < offset_ || fingerprint(text) != fingerprint_)) {
+        columns_.clear();
+        types_.clear();
+        header_end_ = offset_ = last_line_ = 0;
+        rows_ = 0;
+        restarted_ = true;
+    }
+    
+    if (offset_ == 0) {
+        size_t newline = text.find('\n');
+        if (newline == std::string_view::npos) {
+            return DataSet(columns_);   // no complete header yet
+        }
+        std::string_view body = text;
+        columns_ = Csv::read_header(body);
+        header_end_ = offset_ = newline + 1;
+    }
+    
+    // Complete lines only
+    std::string_view rest = text.substr(offset_);
+    size_t end = rest.rfind('\n');
+    if (end == std::string_view::npos) {
+        return DataSet(columns_);
+    }
+    std::string_view lines = rest.substr(0, end + 1);
+    
+    if (types_.empty()) {
+        types_ = Csv::infer_types(lines, columns_.size());
+    }
+    DataSet rows(columns_, Csv::parse_rows(lines, types_));
+    
+    size_t last_newline = lines.rfind('\n', lines.size() - 2);
+    last_line_ = offset_ + (last_newline == std::string_view::npos ? 0 : last_newline + 1);
+    offset_ += lines.size();
+    fingerprint_ = fingerprint(text);
+    rows_ += rows.size();
+    return rows;
+}
+
+// IncrementalPipeline implementations
+IncrementalPipeline::IncrementalPipeline(Pipeline pipeline)
+    : pipeline_(std::move(pipeline)), outputs_(std::max<size_t>(pipeline_.plan().size(), 1)) {}
+
+size_t IncrementalPipeline::add_group_by(std::vector<std::string> key_columns,
+                                         std::vector<GroupAggregate> aggregates) {
+    group_states_.emplace_back(std::move(key_columns), std::move(aggregates));
+    if (rows_seen_ > 0) {
+        group_states_.back().update(result());
+    }
+    return group_states_.size() - 1;
+}
+
+size_t IncrementalPipeline::add_statistics(std::string column) {
+    statistics_.emplace_back(std::move(column), Statistics::RunningStats());
+    if (rows_seen_ > 0) {
+        statistics_.back().second.update(result().column(statistics_.back().first));
+    }
+    return statistics_.size() - 1;
+}
+
+uint64_t IncrementalPipeline::row_hash(const DataSet& rows, size_t row) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < rows.get_columns().size(); ++i) {
+        hash = combine(hash, hash_text(ValueOps::to_string(rows.column_at(i).get(row))));
+    }
+    return hash;
+}
+
+const DataSet& IncrementalPipeline::append(DataSet rows) {
+    if (rows_seen_ > 0 && rows.get_columns() != input_columns_) {
+        throw std::invalid_argument("Appended rows have different columns");
+    }
+    last_run_ = RunInfo();
+    last_run_.new_rows = rows.size();
+    
+    if (!rows.empty()) {
+        if (rows_seen_ == 0) {
+            input_columns_ = rows.get_columns();
+            first_row_ = row_hash(rows, 0);
+        }
+        last_row_ = row_hash(rows, rows.size() - 1);
+        rows_seen_ += rows.size();
+    }
+    run(std::move(rows));
+    return result();
+}
+
+const DataSet& IncrementalPipeline::refresh(const DataSet& input) {
+    bool restarted = false;
+    if (rows_seen_ > 0 && (input.size() < rows_seen_ || input.get_columns() != input_columns_ ||
+                           row_hash(input, 0) != first_row_ || row_hash(input, rows_seen_ - 1) != last_row_)) {
+        reset();
+        restarted = true;
+    }
+    
+    append(rows_seen_ == 0 ? input : input.slice(rows_seen_, input.size()));
+    last_run_.restarted = restarted;
+    return result();
+}
+
+const DataSet& IncrementalPipeline::refresh(CsvTail& source) {
+    DataSet rows = source.read();
+    if (source.restarted()) {
+        reset();
+    }
+    append(std::move(rows));
+    last_run_.restarted = source.restarted();
+    return result();
+}
+
+void IncrementalPipeline::reset() {
+    for (auto& output : outputs_) {
+        output = DataSet();
+    }
+    for (auto& state : group_states_) {
+        state.clear();
+    }
+    for (auto& [column, running] : statistics_) {
+        running = Statistics::RunningStats();
+    }
+    input_columns_.clear();
+    rows_seen_ = 0;
+    first_row_ = last_row_ = 0;
+}
+
+const DataSet& IncrementalPipeline::result() const {
+    return outputs_.back();
+}
+
+void IncrementalPipeline::run(DataSet rows) {
+    Tracing::Span span("IncrementalPipeline::run");
+    span.add_bytes(rows.cell_bytes());
+    
+    using Stage = Pipeline::Stage;
+    std::vector<Pipeline::PlanStep> steps = pipeline_.plan();
+    if (steps.empty()) {
+        outputs_[0].append(rows);
+        update_aggregates(Change::Appended, rows);
+        span.set_rows(result().size());
+        return;
+    }
+    
+    // rows: the rows appended to the input of step i, while change is Appended
+    Change change = Change::Appended;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const Pipeline::PlanStep& step = steps[i];
+        DataSet& output = outputs_[i];
+        
+        // An output without columns has never been computed
+        bool computed = !output.get_columns().empty();
+        if (change == Change::None || (change == Change::Appended && rows.empty() && computed)) {
+            change = Change::None;
+            ++last_run_.reused_steps;
+            continue;
+        }
+        
+        Tracing::Span step_span(step.trace_name());
+        if (change == Change::Replaced) {
+            // Only a blocking step replaces its output, so i > 0
+            DataSet input = outputs_[i - 1];
+            step_span.add_bytes(input.cell_bytes());
+            if (!step.fused.empty() || step.projection) {
+                input = Pipeline::run_fused(input, step);
+            }
+            if (step.blocking) {
+                Pipeline::run_blocking(input, *step.blocking);
+            }
+            output = std::move(input);
+            ++last_run_.recomputed_steps;
+            step_span.set_rows(output.size());
+            continue;
+        }
+        
+        step_span.add_bytes(rows.cell_bytes());
+        if (!step.fused.empty() || step.projection) {
+            rows = Pipeline::run_fused(rows, step);
+        }
+        ++last_run_.incremental_steps;
+        
+        if (!step.blocking) {
+            output.append(rows);
+        } else if (!computed) {
+            Pipeline::run_blocking(rows, *step.blocking);
+            output = std::move(rows);
+            change = Change::Replaced;
+        } else if (step.blocking->kind == Stage::Kind::TopK) {
+            // The best of the rows kept and the new ones; the output changes
+            // only if a new row makes it in
+            size_t kept = output.size();
+            DataSet candidates = output;
+            candidates.append(std::move(rows));
+            std::vector<size_t> best = Sorting::top(candidates, step.blocking->keys, step.blocking->limit);
+            if (std::any_of(best.begin(), best.end(), [kept](size_t row) { return row >= kept; })) {
+                output = candidates.take(best);
+                change = Change::Replaced;
+            } else {
+                change = Change::None;
+            }
+        } else {
+            rows.sort_by(step.blocking->keys);
+            merge_sorted(output, std::move(rows), step.blocking->keys);
+            change = Change::Replaced;
+        }
+        step_span.set_rows(output.size());
+    }
+    
+    update_aggregates(change, rows);
+    span.set_rows(result().size());
+}
+
+void IncrementalPipeline::update_aggregates(Change change, const DataSet& added) {
+    if (change == Change::None) {
+        return;
+    }
+    
+    // Replaced: fold the whole output into fresh states
+    const DataSet& rows = change == Change::Appended ? added : result();
+    for (auto& state : group_states_) {
+        if (change == Change::Replaced) state.clear();
+        state.update(rows);
+    }
+    for (auto& [column, running] : statistics_) {
+        if (change == Change::Replaced) running = Statistics::RunningStats();
+        running.update(rows.column(column));
+    }
+}
+
+} // namespace DataProcessing
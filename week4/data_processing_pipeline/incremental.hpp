@@ -0,0 +1,133 @@
+/*
+ * Data Processing Pipeline - Incremental Execution
+ *
+ * Re-running a Pipeline over an input that only grows, at a cost that
+ * follows the rows added since the last run rather than the whole history.
+ * IncrementalPipeline keeps the output of every step of the pipeline's
+ * plan, and what a run does to each step depends on how the step's input
+ * changed:
+ * - appended rows go through the step's row-local stages (filter,
+ *   transform, add_column, select) alone, and their output is appended to
+ *   the step's memoized output
+ * - top_k picks its k rows from the ones it kept and the new candidates
+ * - sort_by sorts the new rows and merges them into its sorted output
+ *   (the merge rewrites that output, so it is linear in its size)
+ * - an input whose rows were replaced, like the output of a sort that
+ *   took new rows, makes the step run again over all of it
+ * - an unchanged input leaves the step's output as it is
+ * The output of every run is what Pipeline::execute returns for the whole
+ * input. This relies on the stages being functions of one row: a stage
+ * that counts or samples the rows it sees would give other results.
+ *
+ * Aggregates over the output are kept the same way: a GroupByState or
+ * Statistics::RunningStats folds in the rows appended to the output, and
+ * is rebuilt only when the output was replaced.
+ *
+ * refresh() takes the whole input again and runs on the rows past those
+ * already seen, after checking a fingerprint of the seen rows (their count
+ * and the cells of the first and last of them) against the previous run.
+ * An input that fails the check is taken to have been rewritten and is
+ * processed from scratch. CsvTail reads only the rows appended to a CSV
+ * file since its previous read, so a file that grows between runs is not
+ * parsed again either.
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+
+namespace DataProcessing {
+
+// Reads a CSV file that grows by appended rows: each read() returns the
+// complete lines added since the previous one (a last line without its
+// '\n' may still be being written and waits for the next read). Column
+// types are inferred once, from the first rows read; later cells that do
+// not fit demote their column to Mixed as in Csv::parse_rows. A file that
+// shrank, or whose header or last read line changed, was rewritten: read()
+// then returns all of it and restarted() is true.
+class CsvTail {
+private:
+    std::string filename_;
+    std::vector<std::string> columns_;
+    std::vector<ColumnType> types_;
+    size_t header_end_ = 0;     // bytes of the header line
+    size_t offset_ = 0;         // bytes consumed, header included
+    size_t last_line_ = 0;      // offset of the last consumed line
+    uint64_t fingerprint_ = 0;  // of the header and the last consumed line
+    size_t rows_ = 0;
+    bool restarted_ = false;
+    
+    uint64_t fingerprint(std::string_view text) const;
+    
+public:
+    explicit CsvTail(std::string filename) : filename_(std::move(filename)) {}
+    
+    DataSet read();
+    
+    bool restarted() const { return restarted_; }   // by the last read()
+    size_t rows() const { return rows_; }           // read since the file was (re)started
+    const std::vector<std::string>& get_columns() const { return columns_; }
+};
+
+class IncrementalPipeline {
+public:
+    // What the last run did
+    struct RunInfo {
+        size_t new_rows = 0;           // input rows processed
+        size_t incremental_steps = 0;  // steps that processed the new rows only
+        size_t recomputed_steps = 0;   // steps run again over their whole input
+        size_t reused_steps = 0;       // steps whose memoized output was kept
+        bool restarted = false;        // the input was rewritten, all of it was processed
+    };
+    
+private:
+    // How a step's input changed in this run
+    enum class Change { None, Appended, Replaced };
+    
+    Pipeline pipeline_;
+    std::vector<DataSet> outputs_;   // memoized output of each plan step (the input if none)
+    
+    std::vector<GroupByState> group_states_;
+    std::vector<std::pair<std::string, Statistics::RunningStats>> statistics_;
+    
+    // The input so far: its columns, rows, and hashes of its first and
+    // last row (refresh()'s fingerprint)
+    std::vector<std::string> input_columns_;
+    size_t rows_seen_ = 0;
+    uint64_t first_row_ = 0;
+    uint64_t last_row_ = 0;
+    RunInfo last_run_;
+    
+    void run(DataSet rows);
+    void update_aggregates(Change change, const DataSet& added);
+    static uint64_t row_hash(const DataSet& rows, size_t row);
+    
+public:
+    explicit IncrementalPipeline(Pipeline pipeline);
+    
+    // Aggregates kept over the output; returns the index to read them by
+    size_t add_group_by(std::vector<std::string> key_columns, std::vector<GroupAggregate> aggregates);
+    size_t add_statistics(std::string column);
+    
+    // Run on rows appended to the input since the previous run
+    const DataSet& append(DataSet rows);
+    
+    // Run on the whole input, only on its rows past those already seen if
+    // the fingerprint of the seen ones matches
+    const DataSet& refresh(const DataSet& input);
+    
+    // Run on the rows source read; starts over if the file was rewritten
+    const DataSet& refresh(CsvTail& source);
+    
+    // Forget every row seen (the aggregates stay registered)
+    void reset();
+    
+    const DataSet& result() const;
+    DataSet group_by(size_t index) const { return group_states_.at(index).result(); }
+    Statistics::DescriptiveStats statistics(size_t index) const { return statistics_.at(index).second.stats(); }
+    
+    size_t rows_seen() const { return rows_seen_; }
+    const RunInfo& last_run() const { return last_run_; }
+};
+
+} // namespace DataProcessing
@@ -0,0 +1,520 @@
+/*
+ * Data Processing Pipeline - Hash Join Implementation
+ *
+ * Key hashing and comparison across the two sides, the build table, the
+ * unpartitioned and radix-partitioned probes described in join.hpp, and the
+ * serial DataSet::join on top of them.
+ */
+
+#include "join.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace DataProcessing {
+namespace Joins {
+
+namespace {
+    // Smaller build sides get a single table: partitioning would cost a
+    // pass over both sides for little gain in cache hits
+    constexpr size_t partition_min_rows = 4 * partition_rows;
+    constexpr size_t max_partition_bits = 12;
+    
+    constexpr double two_to_63 = 9223372036854775808.0;
+    
+    uint64_t mix(uint64_t value) {
+        // splitmix64 finalizer
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+    
+    // The integer an integral double in int64 range equals
+    std::optional<int64_t> as_integer(double value) {
+        if (value == std::trunc(value) && value >= -two_to_63 && value < two_to_63) {
+            return static_cast<int64_t>(value);
+        }
+        return std::nullopt;
+    }
+    
+    uint64_t hash_integer(int64_t value) {
+        return mix(static_cast<uint64_t>(value));
+    }
+    
+    uint64_t hash_double(double value) {
+        if (auto integer = as_integer(value)) {
+            return hash_integer(*integer);   // like the Int64 it equals (and -0.0 like 0.0)
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return mix(bits);
+    }
+    
+    uint64_t hash_text(std::string_view text) {
+        return mix(std::hash<std::string_view>()(text));
+    }
+    
+    // One key cell, whatever its column's storage
+    struct Cell {
+        enum class Kind { Integer, Real, Text, Null };
+        
+        Kind kind = Kind::Integer;
+        int64_t integer = 0;
+        double real = 0.0;
+        std::string_view text;
+    };
+    
+    Cell cell_at(const Column& column, size_t row) {
+        Cell cell;
+        switch (column.type()) {
+            case ColumnType::Int64:
+                cell.integer = column.ints()[row];
+                return cell;
+            case ColumnType::Double:
+                cell.kind = Cell::Kind::Real;
+                cell.real = column.doubles()[row];
+                return cell;
+            case ColumnType::String:
+                cell.kind = Cell::Kind::Text;
+                cell.text = column.strings()[row];
+                return cell;
+            case ColumnType::Dictionary:
+                cell.kind = Cell::Kind::Text;
+                cell.text = column.dictionary().at(row);
+                return cell;
+            case ColumnType::Mixed:
+                break;
+        }
+        const DataValue& value = column.values()[row];
+        switch (value.kind()) {
+            case DataValue::Kind::Int:
+                cell.integer = value.as_int();
+                break;
+            case DataValue::Kind::Double:
+                cell.kind = Cell::Kind::Real;
+                cell.real = value.as_double();
+                break;
+            case DataValue::Kind::String:
+                cell.kind = Cell::Kind::Text;
+                cell.text = value.as_string();
+                break;
+            case DataValue::Kind::Null:
+                cell.kind = Cell::Kind::Null;
+                break;
+        }
+        return cell;
+    }
+    
+    uint64_t hash_cell(const Cell& cell) {
+        switch (cell.kind) {
+            case Cell::Kind::Integer: return hash_integer(cell.integer);
+            case Cell::Kind::Real:    return hash_double(cell.real);
+            case Cell::Kind::Text:    return hash_text(cell.text);
+            case Cell::Kind::Null:    break;
+        }
+        return 0;
+    }
+    
+    bool equal_cells(const Cell& a, const Cell& b) {
+        if (a.kind == Cell::Kind::Null || b.kind == Cell::Kind::Null) {
+            return false;   // as in SQL, a null key matches nothing
+        }
+        if (a.kind == Cell::Kind::Text || b.kind == Cell::Kind::Text) {
+            return a.kind == b.kind && a.text == b.text;
+        }
+        if (a.kind == Cell::Kind::Integer && b.kind == Cell::Kind::Integer) {
+            return a.integer == b.integer;
+        }
+        if (a.kind == Cell::Kind::Real && b.kind == Cell::Kind::Real) {
+            return a.real == b.real;
+        }
+        const Cell& integer = a.kind == Cell::Kind::Integer ? a : b;
+        auto value = as_integer(a.kind == Cell::Kind::Integer ? b.real : a.real);
+        return value && *value == integer.integer;
+    }
+    
+    bool equal_cells(const Column& a, size_t row_a, const Column& b, size_t row_b) {
+        if (a.type() == ColumnType::Int64 && b.type() == ColumnType::Int64) {
+            return a.ints()[row_a] == b.ints()[row_b];
+        }
+        if (a.type() == ColumnType::Dictionary && b.type() == ColumnType::Dictionary &&
+            a.dictionary().dictionary == b.dictionary().dictionary) {
+            return a.dictionary().codes[row_a] == b.dictionary().codes[row_b];
+        }
+        return equal_cells(cell_at(a, row_a), cell_at(b, row_b));
+    }
+    
+    // One key column of one side. Typed columns hash straight from their
+    // buffers; a dictionary column hashes each distinct value once.
+    class KeyColumn {
+    private:
+        const Column* column_;
+        std::vector<uint64_t> code_hashes_;
+        
+    public:
+        explicit KeyColumn(const Column& column) : column_(&column) {
+            if (column.type() == ColumnType::Dictionary) {
+                const StringDictionary& dictionary = *column.dictionary().dictionary;
+                code_hashes_.reserve(dictionary.size());
+                for (uint32_t code = 0; code < dictionary.size(); ++code) {
+                    code_hashes_.push_back(hash_text(dictionary[code]));
+                }
+            }
+        }
+        
+        const Column& column() const { return *column_; }
+        
+        uint64_t hash(size_t row) const {
+            switch (column_->type()) {
+                case ColumnType::Int64:      return hash_integer(column_->ints()[row]);
+                case ColumnType::Double:     return hash_double(column_->doubles()[row]);
+                case ColumnType::String:     return hash_text(column_->strings()[row]);
+                case ColumnType::Dictionary: return code_hashes_[column_->dictionary().codes[row]];
+                case ColumnType::Mixed:      break;
+            }
+            return hash_cell(cell_at(*column_, row));
+        }
+    };
+    
+    bool equal_rows(const std::vector<KeyColumn>& a, size_t row_a,
+                    const std::vector<KeyColumn>& b, size_t row_b) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (!equal_cells(a[i].column(), row_a, b[i].column(), row_b)) return false;
+        }
+        return true;
+    }
+    
+    // Run work(begin, end) over [0, rows) in runs of run_rows, on run_tasks
+    // when given
+    template <typename Work>
+    void for_runs(size_t rows, size_t run_rows, const RunTasks& run_tasks, Work work) {
+        if (!run_tasks || run_rows == 0 || rows <= run_rows) {
+            work(size_t(0), rows);
+            return;
+        }
+        std::vector<std::function<void()>> tasks;
+        for (size_t begin = 0; begin < rows; begin += run_rows) {
+            tasks.push_back([&work, begin, end = std::min(rows, begin + run_rows)] { work(begin, end); });
+        }
+        run_tasks(tasks);
+    }
+    
+    std::vector<uint64_t> hash_rows(const std::vector<KeyColumn>& keys, size_t rows,
+                                    size_t run_rows, const RunTasks& run_tasks) {
+        std::vector<uint64_t> hashes(rows);
+        for_runs(rows, run_rows, run_tasks, [&](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; ++row) {
+                uint64_t hash = 0;
+                for (const auto& key : keys) {
+                    hash = mix(hash ^ key.hash(row));
+                }
+                hashes[row] = hash;
+            }
+        });
+        return hashes;
+    }
+    
+    // Open-addressing (linear probing) table over build rows, one entry per
+    // distinct key holding its hash and its first and last row; next[row]
+    // chains each row to the following row with the same key. Sized up
+    // front for its rows, so it is never more than half full.
+    class BuildTable {
+    private:
+        std::vector<uint32_t> slots_;   // entry + 1; 0 marks an empty slot
+        std::vector<uint64_t> hashes_;
+        std::vector<size_t> first_;
+        std::vector<size_t> last_;
+        size_t mask_;
+        
+    public:
+        explicit BuildTable(size_t rows) {
+            size_t slots = 16;
+            while (slots < rows * 2) slots *= 2;
+            slots_.assign(slots, 0);
+            mask_ = slots - 1;
+            hashes_.reserve(rows);
+            first_.reserve(rows);
+            last_.reserve(rows);
+        }
+        
+        // Add row, chaining it behind the rows whose key matches per
+        // same_key(first row of an entry)
+        template<typename SameKey>
+        void insert(uint64_t hash, size_t row, std::vector<size_t>& next, SameKey&& same_key) {
+            size_t slot = hash & mask_;
+            while (slots_[slot] != 0) {
+                size_t entry = slots_[slot] - 1;
+                if (hashes_[entry] == hash && same_key(first_[entry])) {
+                    next[last_[entry]] = row;
+                    last_[entry] = row;
+                    return;
+                }
+                slot = (slot + 1) & mask_;
+            }
+            
+            if (hashes_.size() >= std::numeric_limits<uint32_t>::max()) {
+                throw std::length_error("Too many distinct join keys");
+            }
+            slots_[slot] = static_cast<uint32_t>(hashes_.size() + 1);
+            hashes_.push_back(hash);
+            first_.push_back(row);
+            last_.push_back(row);
+        }
+        
+        // The entry whose key matches, or Matches::no_match
+        template<typename SameKey>
+        size_t find(uint64_t hash, SameKey&& same_key) const {
+            size_t slot = hash & mask_;
+            while (slots_[slot] != 0) {
+                size_t entry = slots_[slot] - 1;
+                if (hashes_[entry] == hash && same_key(first_[entry])) {
+                    return entry;
+                }
+                slot = (slot + 1) & mask_;
+            }
+            return Matches::no_match;
+        }
+        
+        size_t first(size_t entry) const { return first_[entry]; }
+        size_t last(size_t entry) const { return last_[entry]; }
+    };
+    
+    // Everything one join reads: the key columns and row hashes of both
+    // sides, and the chains of build rows
+    struct JoinInput {
+        std::vector<KeyColumn> left_keys;
+        std::vector<KeyColumn> right_keys;
+        std::vector<uint64_t> left_hashes;
+        std::vector<uint64_t> right_hashes;
+        std::vector<size_t> next;
+        JoinKind kind;
+        // A single Int64 key on both sides: mix is a bijection, so equal
+        // hashes mean equal keys and the key cells need not be read
+        bool hash_is_key = false;
+        
+        void build(BuildTable& table, size_t row, uint64_t hash) {
+            table.insert(hash, row, next, [this, row](size_t first) {
+                return hash_is_key || equal_rows(right_keys, first, right_keys, row);
+            });
+        }
+        
+        // Append the pairs of left row (whose key hashes to hash) to out
+        void probe(const BuildTable& table, size_t row, uint64_t hash, Matches& out) const {
+            size_t entry = table.find(hash, [this, row](size_t first) {
+                return hash_is_key || equal_rows(left_keys, row, right_keys, first);
+            });
+            if (kind == JoinKind::Semi) {
+                if (entry != Matches::no_match) out.left.push_back(row);
+                return;
+            }
+            if (entry == Matches::no_match) {
+                if (kind == JoinKind::Left) {
+                    out.left.push_back(row);
+                    out.right.push_back(Matches::no_match);
+                }
+                return;
+            }
+            // next is only read for keys with more than one row
+            for (size_t match = table.first(entry); ; match = next[match]) {
+                out.left.push_back(row);
+                out.right.push_back(match);
+                if (match == table.last(entry)) break;
+            }
+        }
+    };
+    
+    // Rows grouped by partition (the top bits of their hash), ascending
+    // within each, with their hashes alongside in rows_hashes; partition p
+    // is rows[bounds[p], bounds[p + 1])
+    void partition(const std::vector<uint64_t>& hashes, size_t bits, std::vector<size_t>& rows,
+                   std::vector<uint64_t>& rows_hashes, std::vector<size_t>& bounds) {
+        size_t shift = 64 - bits;
+        bounds.assign((size_t(1) << bits) + 1, 0);
+        for (uint64_t hash : hashes) {
+            ++bounds[(hash >> shift) + 1];
+        }
+        for (size_t p = 1; p < bounds.size(); ++p) {
+            bounds[p] += bounds[p - 1];
+        }
+        
+        std::vector<size_t> cursor(bounds.begin(), bounds.end() - 1);
+        rows.resize(hashes.size());
+        rows_hashes.resize(hashes.size());
+        for (size_t row = 0; row < hashes.size(); ++row) {
+            size_t position = cursor[hashes[row] >> shift]++;
+            rows[position] = row;
+            rows_hashes[position] = hashes[row];
+        }
+    }
+    
+    void run_all(std::vector<std::function<void()>>& tasks, const RunTasks& run_tasks) {
+        if (run_tasks) {
+            run_tasks(tasks);
+        } else {
+            for (auto& task : tasks) task();
+        }
+    }
+    
+    // Cells of rows, with an empty cell (what CSV loading gives a missing
+    // value) where a row is Matches::no_match
+    Column take_or_empty(const Column& column, const std::vector<size_t>& rows) {
+        if (column.empty()) {
+            return Column::repeat(std::string(), rows.size());
+        }
+        std::vector<size_t> present(rows);
+        std::replace(present.begin(), present.end(), Matches::no_match, size_t(0));
+        Column result = column.take(present);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if (rows[i] == Matches::no_match) result.set(i, std::string());
+        }
+        return result;
+    }
+}
+
+Matches match(const DataSet& left, const DataSet& right,
+              const std::vector<std::string>& left_keys, const std::vector<std::string>& right_keys,
+              JoinKind kind, size_t run_rows, const RunTasks& run_tasks) {
+    if (left_keys.empty() || left_keys.size() != right_keys.size()) {
+        throw std::invalid_argument("A join needs one or more key columns on each side, as many left as right");
+    }
+    
+    JoinInput input;
+    input.kind = kind;
+    for (const auto& name : left_keys) input.left_keys.emplace_back(left.column(name));
+    for (const auto& name : right_keys) input.right_keys.emplace_back(right.column(name));
+    input.left_hashes = hash_rows(input.left_keys, left.size(), run_rows, run_tasks);
+    input.right_hashes = hash_rows(input.right_keys, right.size(), run_rows, run_tasks);
+    input.next.assign(right.size(), Matches::no_match);
+    input.hash_is_key = left_keys.size() == 1 &&
+                        input.left_keys[0].column().type() == ColumnType::Int64 &&
+                        input.right_keys[0].column().type() == ColumnType::Int64;
+    
+    size_t bits = 0;
+    if (right.size() >= partition_min_rows) {
+        while (bits < max_partition_bits && (right.size() >> bits) > partition_rows) ++bits;
+    }
+    
+    if (bits == 0) {
+        // One table; the left side probes it in runs whose pairs are
+        // concatenated in run order
+        BuildTable table(right.size());
+        for (size_t row = 0; row < right.size(); ++row) {
+            input.build(table, row, input.right_hashes[row]);
+        }
+        
+        bool split = run_tasks && run_rows != 0 && left.size() > run_rows;
+        std::vector<Matches> parts(split ? (left.size() + run_rows - 1) / run_rows : 1);
+        for_runs(left.size(), run_rows, run_tasks, [&](size_t begin, size_t end) {
+            Matches& part = parts[split ? begin / run_rows : 0];
+            for (size_t row = begin; row < end; ++row) {
+                input.probe(table, row, input.left_hashes[row], part);
+            }
+        });
+        
+        Matches result = std::move(parts.front());
+        for (size_t i = 1; i < parts.size(); ++i) {
+            result.left.insert(result.left.end(), parts[i].left.begin(), parts[i].left.end());
+            result.right.insert(result.right.end(), parts[i].right.begin(), parts[i].right.end());
+        }
+        return result;
+    }
+    
+    // Partitioned: each partition's build and probe rows meet in a table
+    // of their own
+    std::vector<size_t> build_rows, build_bounds, probe_rows, probe_bounds;
+    std::vector<uint64_t> build_hashes, probe_hashes;
+    partition(input.right_hashes, bits, build_rows, build_hashes, build_bounds);
+    partition(input.left_hashes, bits, probe_rows, probe_hashes, probe_bounds);
+    
+    size_t partitions = size_t(1) << bits;
+    std::vector<Matches> parts(partitions);
+    std::vector<std::function<void()>> tasks;
+    for (size_t p = 0; p < partitions; ++p) {
+        tasks.push_back([&, p] {
+            BuildTable table(build_bounds[p + 1] - build_bounds[p]);
+            for (size_t i = build_bounds[p]; i < build_bounds[p + 1]; ++i) {
+                input.build(table, build_rows[i], build_hashes[i]);
+            }
+            for (size_t i = probe_bounds[p]; i < probe_bounds[p + 1]; ++i) {
+                input.probe(table, probe_rows[i], probe_hashes[i], parts[p]);
+            }
+        });
+    }
+    run_all(tasks, run_tasks);
+    
+    // Back to left row order: count each left row's pairs, then move every
+    // partition's pairs to their row's place (a left row lives in exactly
+    // one partition, so partitions write disjoint places)
+    std::vector<size_t> offsets(left.size() + 1, 0);
+    for (const Matches& part : parts) {
+        for (size_t row : part.left) ++offsets[row + 1];
+    }
+    for (size_t row = 1; row < offsets.size(); ++row) {
+        offsets[row] += offsets[row - 1];
+    }
+    
+    Matches result;
+    result.left.resize(offsets.back());
+    result.right.resize(kind == JoinKind::Semi ? 0 : offsets.back());
+    tasks.clear();
+    for (size_t p = 0; p < partitions; ++p) {
+        tasks.push_back([&, p] {
+            const Matches& part = parts[p];
+            for (size_t i = 0; i < part.left.size(); ++i) {
+                size_t position = offsets[part.left[i]]++;
+                result.left[position] = part.left[i];
+                if (!part.right.empty()) result.right[position] = part.right[i];
+            }
+        });
+    }
+    run_all(tasks, run_tasks);
+    return result;
+}
+
+}
+
+// DataSet joins (the ExecutionPolicy overload is in parallel_execution.cpp)
+DataSet DataSet::join(const DataSet& right, const std::vector<std::string>& keys, JoinKind kind) const {
+    return join(right, keys, keys, kind);
+}
+
+DataSet DataSet::join(const DataSet& right, const std::vector<std::string>& left_keys,
+                      const std::vector<std::string>& right_keys, JoinKind kind) const {
+    return joined(right, left_keys, right_keys, kind, Joins::match(*this, right, left_keys, right_keys, kind));
+}
+
+DataSet DataSet::joined(const DataSet& right, const std::vector<std::string>& left_keys,
+                        const std::vector<std::string>& right_keys, JoinKind kind,
+                        const Joins::Matches& matches) const {
+    std::vector<std::string> names = columns_;
+    std::vector<Column> data;
+    for (const auto& column : data_) {
+        data.push_back(column.take(matches.left));
+    }
+    
+    if (kind != JoinKind::Semi) {
+        bool unmatched = std::find(matches.right.begin(), matches.right.end(), Joins::Matches::no_match) !=
+                         matches.right.end();
+        for (size_t i = 0; i < right.columns_.size(); ++i) {
+            std::string name = right.columns_[i];
+            auto key = std::find(right_keys.begin(), right_keys.end(), name);
+            if (key != right_keys.end() && left_keys[static_cast<size_t>(key - right_keys.begin())] == name) {
+                continue;   // same values as the left key
+            }
+            while (std::find(names.begin(), names.end(), name) != names.end()) {
+                name += "_right";
+            }
+            names.push_back(name);
+            data.push_back(unmatched ? Joins::take_or_empty(right.data_[i], matches.right)
+                                     : right.data_[i].take(matches.right));
+        }
+    }
+    
+    DataSet result(std::move(names), std::move(data));
+    result.rows_ = matches.left.size();   // also right when there are no columns at all
+    return result;
+}
+
+} // namespace DataProcessing
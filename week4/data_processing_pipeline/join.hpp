@@ -0,0 +1,52 @@
+/*
+ * Data Processing Pipeline - Hash Join
+ *
+ * The engine behind DataSet::join, shared with the parallel executor like
+ * the sort engine. The right DataSet is the build side: its rows go into an
+ * open-addressing table with one entry per distinct key, and rows sharing a
+ * key are chained in row order. The left rows then probe the table and
+ * every match is emitted as a pair of row numbers; DataSet::join gathers
+ * the output columns from those pairs with one take per column.
+ *
+ * A build side of more than a few partition_rows is radix-partitioned on
+ * the top bits of the key hashes first. Each partition gets its own table,
+ * small enough to stay in cache while the left rows of the same partition
+ * probe it, and partitions are built and probed independently.
+ *
+ * Key cells match when they are equal values: numbers by value (Int64 5
+ * matches Double 5.0), text by its characters whether dictionary-encoded
+ * or not. NaN matches nothing, and a number never matches text.
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+
+namespace DataProcessing {
+namespace Joins {
+    // Runs every task to completion, possibly concurrently (as Sorting::RunTasks)
+    using RunTasks = std::function<void(std::vector<std::function<void()>>& tasks)>;
+    
+    // Build rows per partition of a partitioned join: about half a megabyte
+    // of table, which stays in a core's L2 cache
+    constexpr size_t partition_rows = 16 * 1024;
+    
+    // Matching row pairs, left[i] with right[i], in left row order and for
+    // one left row in right row order. A Left join pairs unmatched left rows
+    // with no_match; a Semi join lists each matching left row once and
+    // leaves right empty.
+    struct Matches {
+        static constexpr size_t no_match = static_cast<size_t>(-1);
+        
+        std::vector<size_t> left;
+        std::vector<size_t> right;
+    };
+    
+    // With run_tasks, rows are hashed in runs of run_rows, partitions are
+    // built and probed as separate tasks, and an unpartitioned table is
+    // probed in runs of run_rows.
+    Matches match(const DataSet& left, const DataSet& right,
+                  const std::vector<std::string>& left_keys, const std::vector<std::string>& right_keys,
+                  JoinKind kind, size_t run_rows = 0, const RunTasks& run_tasks = nullptr);
+}
+} // namespace DataProcessing
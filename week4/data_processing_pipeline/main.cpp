@@ -6,12 +6,33 @@
  */
 
 #include "data_processor.hpp"
+#include "streaming.hpp"
+#include "simd_kernels.hpp"
+#include "columnar_file.hpp"
+#include "expressions.hpp"
+#include "incremental.hpp"
+#include "typed_dataset.hpp"
 #include <iostream>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <random>
+#include <filesystem>
+#include <numeric>
+#include <thread>
 
 using namespace DataProcessing;
 
+// Schema of the fixed-format feed in demonstrate_performance_monitoring
+namespace Feed {
+    DATA_COLUMN(id, int64_t);
+    DATA_COLUMN(department, Dict);
+    DATA_COLUMN(salary, double);
+    DATA_COLUMN(performance_score, double);
+}
+using FeedRecords = TypedDataSet<Schema<Feed::id, Feed::department, Feed::salary, Feed::performance_score>>;
+static_assert(FeedRecords::schema::index_of("salary") == 2);
+
 // Generate sample data for demonstration
 void generate_sample_data(const std::string& filename) {
     std::ofstream file(filename);
@@ -68,6 +89,14 @@ void demonstrate_basic_operations() {
     std::cout << "Loaded dataset:" << std::endl;
     std::cout << dataset << std::endl;
     
+    // Low-cardinality text columns are loaded dictionary-encoded
+    const Column& departments = dataset.column("department");
+    if (departments.type() == ColumnType::Dictionary) {
+        std::cout << "\nDepartment column: dictionary-encoded, "
+                  << departments.dictionary().dictionary->size() << " distinct values for "
+                  << departments.size() << " rows" << std::endl;
+    }
+    
     // Basic statistics
     auto age_stats = Statistics::calculate_column(dataset, "age");
     auto salary_stats = Statistics::calculate_column(dataset, "salary");
@@ -165,6 +194,38 @@ void demonstrate_aggregation() {
     std::cout << "  Average performance: " << std::fixed << std::setprecision(2) 
               << ValueOps::to_double(avg_performance) << std::endl;
     std::cout << "  Maximum age: " << ValueOps::to_double(max_age) << std::endl;
+    
+    // Several aggregates over several key columns in one hash-aggregation pass
+    DataSet banded = Pipeline()
+        .add_column("age_band", [](const DataRecord& record) -> DataValue {
+            return ValueOps::to_double(record["age"]) < 40 ? std::string("under 40") : std::string("40+");
+        })
+        .execute(dataset);
+    DataSet summary = banded.group_by({"department", "age_band"}, {
+        {"salary", Aggregates::Kind::Mean, "avg_salary"},
+        {"salary", Aggregates::Kind::Max, "max_salary"},
+        {"age", Aggregates::Kind::StdDev, ""},
+        {"id", Aggregates::Kind::Count, "employees"}
+    });
+    summary.sort_by_column("avg_salary", false);
+    
+    std::cout << "\nSalary by department and age band:" << std::endl;
+    std::cout << summary << std::endl;
+    
+    // Hash joins against a small department table (the build side)
+    DataSet budgets({"department", "budget", "floor"}, {
+        Column(std::pmr::vector<std::pmr::string>{"Engineering", "Sales", "Finance", "Legal"}),
+        Column(std::pmr::vector<int64_t>{2500000, 900000, 700000, 400000}),
+        Column(std::pmr::vector<int64_t>{3, 1, 2, 2})
+    });
+    DataSet staffed = dataset.join(budgets, {"department"});
+    DataSet unbudgeted = dataset.join(budgets, {"department"}, JoinKind::Left)
+                             .filter(Filters::column_equals("budget", std::string()));
+    std::cout << "\nJoined with department budgets: " << staffed.size() << " of " << dataset.size()
+              << " employees matched; " << unbudgeted.size() << " in departments without a budget; "
+              << dataset.join(budgets, {"department"}, JoinKind::Semi).size()
+              << " kept by a semi join" << std::endl;
+    std::cout << staffed.select({"name", "department", "budget", "floor"}).to_string(3) << std::endl;
 }
 
 void demonstrate_pipeline_processing() {
@@ -180,12 +241,10 @@ void demonstrate_pipeline_processing() {
     analysis_pipeline
         // Filter for employees with good performance
         .filter(Filters::column_greater_than("performance_score", 3.5))
-        // Add bonus calculation
-        .add_column("bonus", [](const DataRecord& record) -> DataValue {
-            double salary = ValueOps::to_double(record["salary"]);
-            double performance = ValueOps::to_double(record["performance_score"]);
-            return salary * 0.1 * (performance / 5.0); // 10% of salary scaled by performance
-        })
+        // Add bonus calculation: 10% of salary scaled by performance. Written
+        // as Expressions arithmetic, it is compiled to run over column buffers
+        .add_column("bonus", Expressions::column("salary") * 0.1 *
+                             (Expressions::column("performance_score") / 5.0))
         // Add total compensation
         .add_column("total_compensation", [](const DataRecord& record) -> DataValue {
             return ValueOps::to_double(record["salary"]) + ValueOps::to_double(record["bonus"]);
@@ -193,6 +252,7 @@ void demonstrate_pipeline_processing() {
         // Sort by total compensation (descending)
         .sort_by("total_compensation", false);
     
+    std::cout << analysis_pipeline.explain() << std::endl;
     auto processed_dataset = analysis_pipeline.execute(dataset);
     
     std::cout << "Top performers with bonus calculations:" << std::endl;
@@ -201,6 +261,21 @@ void demonstrate_pipeline_processing() {
     // Save processed data
     processed_dataset.save_to_csv("processed_data.csv");
     std::cout << "\nProcessed data saved to 'processed_data.csv'" << std::endl;
+    
+    // The planner moves filters ahead of stages they do not depend on, so
+    // the department filter runs before the bonus is computed and sorted
+    Pipeline reordered_pipeline;
+    reordered_pipeline
+        .add_column("bonus", [](const DataRecord& record) -> DataValue {
+            return ValueOps::to_double(record["salary"]) * 0.1;
+        })
+        .sort_by("bonus", false)
+        .filter(Filters::column_equals("department", std::string("Engineering")))
+        .select({"name", "department", "bonus"});
+    
+    std::cout << "\nReordered pipeline:" << std::endl;
+    std::cout << reordered_pipeline.explain() << std::endl;
+    std::cout << reordered_pipeline.execute(dataset) << std::endl;
 }
 
 void demonstrate_correlation_analysis() {
@@ -210,24 +285,89 @@ void demonstrate_correlation_analysis() {
     
     DataSet dataset = DataSet::load_from_csv("sample_data.csv");
     
-    // Calculate correlations between numeric columns
+    // Correlations between numeric columns, all pairs in one pass
     std::vector<std::string> numeric_columns = {"age", "salary", "performance_score"};
+    auto matrix = Statistics::covariance_matrix(dataset, numeric_columns);
+    
+    // One width for names and cells, wide enough for the longest name
+    size_t width = 8;
+    for (const auto& col : numeric_columns) {
+        width = std::max(width, col.size() + 2);
+    }
+    int cell_width = static_cast<int>(width);
     
     std::cout << "Correlation matrix:" << std::endl;
-    std::cout << std::setw(20) << "";
+    std::cout << std::setw(cell_width) << "";
     for (const auto& col : numeric_columns) {
-        std::cout << std::setw(15) << col;
+        std::cout << std::setw(cell_width) << col;
     }
     std::cout << std::endl;
     
-    for (const auto& col1 : numeric_columns) {
-        std::cout << std::setw(20) << col1;
-        for (const auto& col2 : numeric_columns) {
-            double correlation = Statistics::correlation(dataset, col1, col2);
-            std::cout << std::setw(15) << std::fixed << std::setprecision(3) << correlation;
+    for (size_t i = 0; i < numeric_columns.size(); ++i) {
+        std::cout << std::setw(cell_width) << numeric_columns[i];
+        for (size_t j = 0; j < numeric_columns.size(); ++j) {
+            std::cout << std::setw(cell_width) << std::fixed << std::setprecision(3) << matrix.correlation(i, j);
         }
         std::cout << std::endl;
     }
+    
+    // Most frequent departments from a few counters, with their error bounds
+    HeavyHitters departments = Statistics::heavy_hitters(dataset, "department", 4);
+    std::cout << "\nTop departments (" << departments.capacity() << " counters, "
+              << departments.total() << " rows):" << std::endl;
+    for (const auto& entry : departments.top(3)) {
+        std::cout << "  " << ValueOps::to_string(entry.value) << ": " << entry.count
+                  << " (at most " << entry.error << " over)" << std::endl;
+    }
+    
+    {
+        // Feature screening: 300 columns, the matrix against one
+        // correlation() call per pair of columns
+        const size_t columns = 300, rows = 4096;
+        std::mt19937 gen(23);
+        std::normal_distribution<> noise;
+        std::vector<double> base(rows);
+        for (double& value : base) value = noise(gen);
+        
+        std::vector<std::string> names;
+        std::vector<Column> data;
+        for (size_t i = 0; i < columns; ++i) {
+            std::pmr::vector<double> values(rows);
+            for (size_t row = 0; row < rows; ++row) {
+                values[row] = base[row] * (i % 10) + noise(gen);
+            }
+            names.push_back("f" + std::to_string(i));
+            data.emplace_back(std::move(values));
+        }
+        DataSet features(names, std::move(data));
+        
+        auto start = std::chrono::steady_clock::now();
+        auto wide = Statistics::covariance_matrix(features, names);
+        double matrix_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        start = std::chrono::steady_clock::now();
+        double largest_difference = 0.0;
+        for (size_t i = 0; i < columns; ++i) {
+            for (size_t j = i + 1; j < columns; ++j) {
+                double pairwise = Statistics::correlation(features, names[i], names[j]);
+                largest_difference = std::max(largest_difference, std::abs(pairwise - wide.correlation(i, j)));
+            }
+        }
+        double pairwise_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        ExecutionPolicy policy;
+        policy.morsel_rows = 1024;
+        start = std::chrono::steady_clock::now();
+        auto parallel = Statistics::covariance_matrix(features, names, policy);
+        double parallel_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        
+        std::cout << "\n" << columns << "x" << columns << " correlations over " << rows << " rows: "
+                  << std::fixed << std::setprecision(1) << matrix_ms << " ms as one matrix ("
+                  << parallel_ms << " ms in parallel), " << pairwise_ms << " ms pair by pair; corr(f1, f2) "
+                  << std::setprecision(3) << parallel.correlation(1, 2) << ", largest difference "
+                  << std::scientific << std::setprecision(1) << largest_difference << std::defaultfloat
+                  << std::endl;
+    }
 }
 
 void demonstrate_custom_iterators() {
@@ -247,15 +387,14 @@ void demonstrate_custom_iterators() {
     double total_salary = 0.0;
     int count = 0;
     
-    for (auto it = dataset.filtered_begin(high_performer_filter);
-         it != dataset.filtered_end(high_performer_filter); ++it) {
-        total_salary += ValueOps::to_double((*it)["salary"]);
+    for (const auto& record : dataset.filtered(high_performer_filter)) {
+        total_salary += ValueOps::to_double(record["salary"]);
         ++count;
         
         if (count <= 5) { // Show first 5
-            std::cout << "  " << ValueOps::to_string((*it)["name"]) 
-                      << " - Score: " << ValueOps::to_double((*it)["performance_score"])
-                      << ", Salary: $" << ValueOps::to_double((*it)["salary"]) << std::endl;
+            std::cout << "  " << ValueOps::to_string(record["name"]) 
+                      << " - Score: " << ValueOps::to_double(record["performance_score"])
+                      << ", Salary: $" << ValueOps::to_double(record["salary"]) << std::endl;
         }
     }
     
@@ -265,6 +404,187 @@ void demonstrate_custom_iterators() {
         std::cout << "  Average salary: $" << std::fixed << std::setprecision(0) 
                   << (total_salary / count) << std::endl;
     }
+    
+    // Adaptors compose: the first three high performers, numbered
+    std::cout << "\nFirst three high performers (filter | take | enumerate):" << std::endl;
+    for (auto [index, record] : dataset.filtered(high_performer_filter)
+                                    | lazy::views::take(3) | lazy::views::enumerate) {
+        std::cout << "  " << (index + 1) << ". " << ValueOps::to_string(record["name"]) << std::endl;
+    }
+    
+    // Column buffers split into spans the SIMD kernels consume directly
+    const Column& salaries = dataset.column("salary");
+    double chunked_total = 0.0;
+    size_t blocks = 0;
+    if (salaries.type() == ColumnType::Double) {
+        for (lazy::span<const double> block : salaries.doubles() | lazy::views::chunk(16)) {
+            chunked_total += Kernels::sum(block.data(), block.size());
+            ++blocks;
+        }
+    } else if (salaries.type() == ColumnType::Int64) {
+        for (lazy::span<const int64_t> block : salaries.ints() | lazy::views::chunk(16)) {
+            chunked_total += static_cast<double>(Kernels::sum(block.data(), block.size()));
+            ++blocks;
+        }
+    }
+    if (blocks > 0) {
+        std::cout << "\nSalary total over " << blocks << " chunks of 16: $" << std::fixed
+                  << std::setprecision(0) << chunked_total << std::endl;
+    }
+}
+
+void demonstrate_streaming_pipeline() {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "  Streaming Pipeline Execution" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    StreamingOptions options;
+    options.batch_rows = 16; // Tiny batches to show bounded-memory processing
+    // options.batch_arena (on by default) puts each batch in one rewound arena
+    
+    // Row-local stages stream batch by batch straight into a CSV file
+    Pipeline bonus_pipeline;
+    bonus_pipeline
+        .filter(Filters::column_greater_than("performance_score", 3.0))
+        .add_column("bonus", [](const DataRecord& record) -> DataValue {
+            return ValueOps::to_double(record["salary"]) * 0.05;
+        });
+    
+    CsvBatchReader reader("sample_data.csv");
+    CsvSink csv_sink("streamed_data.csv");
+    bonus_pipeline.execute_streaming(reader, csv_sink, options);
+    std::cout << "Streamed " << csv_sink.rows_written() 
+              << " rows into 'streamed_data.csv'" << std::endl;
+    
+    // A sort stage past its memory budget spills sorted runs and merges
+    // them; a 1 KB budget forces a few runs even on the sample data
+    Pipeline sorted_pipeline;
+    sorted_pipeline
+        .filter(Filters::column_equals("department", std::string("Engineering")))
+        .sort_by("salary", false);
+    
+    StreamingOptions external = options;
+    external.sort_memory_bytes = 1024;
+    CsvBatchReader sorted_reader("sample_data.csv");
+    CollectSink collected;
+    sorted_pipeline.execute_streaming(sorted_reader, collected, external);
+    std::cout << "Engineering staff by salary (external merge sort):" << std::endl;
+    std::cout << collected.result().to_string(5) << std::endl;
+    
+    // top_k keeps only its best rows, however long the input runs
+    Pipeline leaderboard;
+    leaderboard.top_k("performance_score", 3, false).select({"name", "performance_score"});
+    
+    CsvBatchReader leaderboard_reader("sample_data.csv");
+    CollectSink leaders;
+    leaderboard.execute_streaming(leaderboard_reader, leaders, options);
+    std::cout << "Top performers:" << std::endl;
+    std::cout << leaders.result().to_string(3) << std::endl;
+    
+    // Aggregating sink keeps O(1) state no matter how large the input is
+    CsvBatchReader summary_reader("sample_data.csv");
+    NumericSummarySink salary_summary("salary");
+    Pipeline().execute_streaming(summary_reader, salary_summary, options);
+    std::cout << "Salary summary: " << salary_summary.summary().to_string() << std::endl;
+}
+
+void demonstrate_incremental_pipeline() {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "  Incremental Pipeline Refresh" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    
+    // A CSV file that grows between runs: the first 60 rows now, the rest later
+    std::vector<std::string> lines;
+    {
+        std::ifstream sample("sample_data.csv");
+        for (std::string line; std::getline(sample, line);) {
+            lines.push_back(line);
+        }
+    }
+    auto write_lines = [&lines](size_t begin, size_t end, std::ios::openmode mode) {
+        std::ofstream live("live_data.csv", mode);
+        for (size_t i = begin; i < end; ++i) {
+            live << lines[i] << "\n";
+        }
+    };
+    size_t split = std::min<size_t>(61, lines.size());
+    write_lines(0, split, std::ios::trunc);
+    
+    Pipeline bonus_pipeline;
+    bonus_pipeline
+        .filter(Filters::column_greater_than("performance_score", 3.0))
+        .add_column("bonus", [](const DataRecord& record) -> DataValue {
+            return ValueOps::to_double(record["salary"]) * 0.05;
+        });
+    
+    CsvTail live("live_data.csv");
+    IncrementalPipeline bonuses(bonus_pipeline);
+    size_t by_department = bonuses.add_group_by(
+        {"department"}, {{"bonus", Aggregates::Kind::Sum, "total_bonus"}, {"bonus", Aggregates::Kind::Count, "people"}});
+    size_t salary = bonuses.add_statistics("salary");
+    
+    auto report = [&bonuses](const char* when) {
+        const auto& run = bonuses.last_run();
+        std::cout << when << ": " << run.new_rows << " new rows, " << bonuses.result().size()
+                  << " bonuses; steps run on new rows " << run.incremental_steps << ", rerun "
+                  << run.recomputed_steps << ", reused " << run.reused_steps << std::endl;
+    };
+    bonuses.refresh(live);
+    report("First run");
+    write_lines(split, lines.size(), std::ios::app);
+    bonuses.refresh(live);
+    report("After the file grew");
+    bonuses.refresh(live);
+    report("Nothing new");
+    
+    DataSet from_scratch = bonus_pipeline.execute(DataSet::load_from_csv("live_data.csv"));
+    std::cout << "Same rows as a full run: " << std::boolalpha
+              << std::equal(from_scratch.begin(), from_scratch.end(),
+                            bonuses.result().begin(), bonuses.result().end()) << std::endl;
+    std::cout << "Bonus by department (kept between runs):" << std::endl;
+    std::cout << bonuses.group_by(by_department).to_string(6) << std::endl;
+    std::cout << "Salary of bonus earners: " << bonuses.statistics(salary).to_string() << std::endl;
+    
+    // A refresh costs what the new rows cost, however long the history
+    {
+        std::pmr::vector<int64_t> ids;
+        std::pmr::vector<double> amounts;
+        std::mt19937 gen(11);
+        std::uniform_real_distribution<> amount(0.0, 1000.0);
+        for (int row = 0; row < 1010000; ++row) {
+            ids.push_back(row);
+            amounts.push_back(amount(gen));
+        }
+        DataSet history({"id", "amount"}, {Column(std::move(ids)), Column(std::move(amounts))});
+        DataSet today = history.slice(1000000, history.size());
+        history = history.slice(0, 1000000);
+        
+        Pipeline largest;
+        largest.filter(Filters::column_greater_than("amount", 500.0))
+            .add_column("tax", [](const DataRecord& record) -> DataValue {
+                return ValueOps::to_double(record["amount"]) * 0.2;
+            })
+            .top_k("amount", 10, false);
+        
+        IncrementalPipeline incremental(largest);
+        incremental.refresh(history);
+        history.append(today);
+        
+        auto elapsed_ms = [](auto&& work) {
+            auto start = std::chrono::steady_clock::now();
+            work();
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+        DataSet full;
+        double full_ms = elapsed_ms([&] { full = largest.execute(history); });
+        double refresh_ms = elapsed_ms([&] { incremental.refresh(history); });
+        std::cout << "Top 10 of " << history.size() << " rows after " << today.size()
+                  << " new ones: refresh " << std::fixed << std::setprecision(2) << refresh_ms << " ms vs "
+                  << full_ms << " ms for a full run; same rows: " << std::boolalpha
+                  << std::equal(full.begin(), full.end(), incremental.result().begin(), incremental.result().end())
+                  << std::endl;
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
 }
 
 void demonstrate_performance_monitoring() {
@@ -277,6 +597,173 @@ void demonstrate_performance_monitoring() {
         DataSet dataset = DataSet::load_from_csv("sample_data.csv");
     }
     
+    {
+        MONITOR_PERFORMANCE("Parallel data loading");
+        DataSet dataset = DataSet::load_from_csv_parallel("sample_data.csv");
+        std::cout << "Loaded " << dataset.size() << " rows with parallel reader" << std::endl;
+    }
+    
+    {
+        // The same rows as daily shards in a month directory, loaded back
+        // in one call: the directory is crawled and parsed on one pool
+        DataSet dataset = DataSet::load_from_csv("sample_data.csv");
+        const size_t days = 30;
+        std::filesystem::create_directories("csv_shards/2024-01");
+        for (size_t day = 0; day < days; ++day) {
+            std::string name = std::string(day + 1 < 10 ? "0" : "") + std::to_string(day + 1);
+            dataset.slice(dataset.size() * day / days, dataset.size() * (day + 1) / days)
+                .save_to_csv("csv_shards/2024-01/day-" + name + ".csv");
+        }
+        
+        MONITOR_PERFORMANCE("Sharded directory loading");
+        DataSet shards = DataSet::load_from_csv_directory("csv_shards");
+        std::cout << "Loaded " << shards.size() << " rows from " << days << " shards; matches single file: "
+                  << std::boolalpha << std::equal(dataset.begin(), dataset.end(), shards.begin(), shards.end())
+                  << std::endl;
+        std::filesystem::remove_all("csv_shards");
+    }
+    
+    {
+        // Dirty input, one cell in four not a number: the try_ calls report
+        // failures as values, where std::stod throws and unwinds for each
+        std::vector<DataValue> cells;
+        for (int i = 0; i < 200000; ++i) {
+            cells.push_back(i % 4 == 0 ? std::string("n/a") : std::to_string(i) + ".5");
+        }
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        double thrown_sum = 0.0;
+        for (const DataValue& cell : cells) {
+            try {
+                thrown_sum += std::stod(std::string(cell.as_string()));
+            } catch (const std::invalid_argument&) {
+            }
+        }
+        auto middle = std::chrono::high_resolution_clock::now();
+        double expected_sum = 0.0;
+        size_t rejected = 0;
+        for (const DataValue& cell : cells) {
+            ParseResult<double> number = ValueOps::try_to_double(cell);
+            if (number) {
+                expected_sum += *number;
+            } else {
+                ++rejected;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        std::cout << "Parse 200k dirty cells: " << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(middle - start).count() << " ms with stod/catch, "
+                  << std::chrono::duration<double, std::milli>(end - middle).count() << " ms with try_to_double ("
+                  << rejected << " rejected); same sum: " << std::boolalpha << (thrown_sum == expected_sum)
+                  << std::defaultfloat << std::setprecision(6) << std::endl;
+        
+        DataSet dataset = DataSet::load_from_csv("sample_data.csv");
+        Result<DataValue> missing = dataset[0].try_get("bonus_points");
+        Result<DataSet> absent = DataSet::try_load_from_csv("no_such_file.csv");
+        std::cout << "try_get: " << (missing ? "found" : missing.error().message())
+                  << "; try_load_from_csv: " << (absent ? "loaded" : absent.error().message()) << std::endl;
+    }
+    
+    {
+        // A feed whose columns are known at build time: the typed loader
+        // parses each field straight into its column's type, and sums run
+        // over plain arrays with no name lookup or variant per cell
+        const int rows = 500000;
+        {
+            std::ofstream feed("typed_feed.csv");
+            const char* departments[] = {"Engineering", "Marketing", "Sales", "HR", "Finance", "Operations"};
+            feed << "id,department,salary,performance_score\n";
+            for (int i = 0; i < rows; ++i) {
+                feed << i << "," << departments[i % 6] << "," << 40000 + (i * int64_t{7919}) % 110000 << ".5,"
+                     << 1 + (i % 400) / 100.0 << "\n";
+            }
+        }
+        
+        auto ms_since = [](std::chrono::high_resolution_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+        auto start = std::chrono::high_resolution_clock::now();
+        DataSet dynamic = DataSet::load_from_csv("typed_feed.csv");
+        double dynamic_load_ms = ms_since(start);
+        start = std::chrono::high_resolution_clock::now();
+        double dynamic_total = ValueOps::to_double(dynamic.aggregate_column("salary", Aggregates::Sum));
+        auto dynamic_groups = dynamic.group_by_aggregate("department", "salary", Aggregates::Sum);
+        double dynamic_sum_ms = ms_since(start);
+        
+        start = std::chrono::high_resolution_clock::now();
+        FeedRecords typed = FeedRecords::load_from_csv("typed_feed.csv");
+        double typed_load_ms = ms_since(start);
+        start = std::chrono::high_resolution_clock::now();
+        double typed_total = typed.sum<Feed::salary>();
+        auto typed_groups = typed.sum_by<Feed::department, Feed::salary>();
+        double typed_sum_ms = ms_since(start);
+        
+        bool groups_match = typed_groups.size() == dynamic_groups.size();
+        for (const auto& [group, total] : typed_groups) {
+            groups_match = groups_match && ValueOps::to_double(dynamic_groups[group]) == total;
+        }
+        DataSet round_trip = FeedRecords::from_dataset(dynamic).to_dataset();
+        std::cout << "Typed feed (" << rows << " rows): load " << std::fixed << std::setprecision(2)
+                  << typed_load_ms << " ms vs " << dynamic_load_ms << " ms dynamic, sum + sum by department "
+                  << typed_sum_ms << " ms vs " << dynamic_sum_ms << " ms; same totals: " << std::boolalpha
+                  << (typed_total == dynamic_total && groups_match) << ", round trip columns: "
+                  << round_trip.get_columns().size() << " of " << dynamic.get_columns().size()
+                  << std::defaultfloat << std::setprecision(6) << std::endl;
+        std::filesystem::remove("typed_feed.csv");
+    }
+    
+    {
+        // Cache a loaded DataSet in the binary columnar format; reloading it
+        // copies typed chunks instead of re-parsing text
+        DataSet dataset = DataSet::load_from_csv("sample_data.csv");
+        dataset.save_columnar("sample_data.dpcol");
+        {
+            MONITOR_PERFORMANCE("Columnar loading");
+            DataSet cached = DataSet::load_columnar("sample_data.dpcol");
+            std::cout << "Columnar reload matches CSV load: " << std::boolalpha
+                      << std::equal(dataset.begin(), dataset.end(), cached.begin(), cached.end()) << std::endl;
+        }
+        
+        ColumnarFile file("sample_data.dpcol");
+        DataSet salaries = file.read({"salary"});
+        const ColumnChunkInfo& first = file.column_info("salary").chunks.front();
+        std::cout << "Columnar file: " << std::filesystem::file_size("sample_data.dpcol") << " bytes vs "
+                  << std::filesystem::file_size("sample_data.csv") << " bytes of CSV; read "
+                  << salaries.get_columns().size() << " of " << file.columns().size()
+                  << " columns; salary chunk 0 spans " << first.min_val << ".." << first.max_val << std::endl;
+        std::filesystem::remove("sample_data.dpcol");
+    }
+    
+    {
+        MONITOR_PERFORMANCE("Columnar time-range scan");
+        // A day of per-second readings; timestamps ascend, so each chunk's
+        // range covers a distinct stretch of time and a range filter only
+        // has to read the chunks that overlap it
+        const int64_t start = 1700000000;
+        std::pmr::vector<int64_t> timestamps;
+        std::pmr::vector<double> readings;
+        for (int64_t second = 0; second < 86400; ++second) {
+            timestamps.push_back(start + second);
+            readings.push_back(20.0 + static_cast<double>(second % 600) / 100.0);
+        }
+        DataSet series({"timestamp", "reading"}, {Column(std::move(timestamps)), Column(std::move(readings))});
+        ColumnarOptions options;
+        options.chunk_rows = 4096;
+        series.save_columnar("series.dpcol", options);
+        
+        auto last_hour = Filters::logical_and(
+            Filters::column_greater_than("timestamp", start + 82800),
+            Filters::column_less_than("timestamp", start + 86400));
+        ColumnarFile file("series.dpcol");
+        DataSet recent = file.scan(last_hour, {"reading"});
+        std::cout << "Time-range scan " << Filters::expression_of(last_hour)->to_string() << ": "
+                  << recent.size() << " rows from " << file.candidate_chunks(last_hour).size()
+                  << " of " << file.chunk_count() << " chunks; matches full filter: " << std::boolalpha
+                  << (recent.size() == series.filter(last_hour).size()) << std::endl;
+        std::filesystem::remove("series.dpcol");
+    }
+    
     {
         MONITOR_PERFORMANCE("Complex pipeline processing");
         DataSet dataset = DataSet::load_from_csv("sample_data.csv");
@@ -293,7 +780,59 @@ void demonstrate_performance_monitoring() {
             })
             .sort_by("salary", false);
         
+        Tracing::clear();
         auto result = complex_pipeline.execute(dataset);
+        
+        // Same pipeline on a thread pool, in small morsels so the sample
+        // data is split across workers; the output is identical
+        ExecutionPolicy policy;
+        policy.threads = 4;
+        policy.morsel_rows = 16;
+        PipelineCounters counters;
+        policy.counters = &counters;
+        auto parallel_result = complex_pipeline.execute(dataset, policy);
+        std::cout << "Parallel execution matches serial: " << std::boolalpha
+                  << std::equal(result.begin(), result.end(), parallel_result.begin(),
+                                parallel_result.end()) << std::endl;
+        auto morsel_times = counters.morsel_micros.snapshot();
+        std::cout << "Fused passes: " << counters.rows_in.read() << " rows in, " << counters.rows_out.read()
+                  << " out, " << counters.morsels.read() << " morsels; morsel time p50 " << std::fixed
+                  << std::setprecision(1) << morsel_times.percentile(50) << " us, max " << morsel_times.max << " us"
+                  << std::defaultfloat << std::endl;
+        
+        // Both runs were traced: a span per plan step, and per morsel on the
+        // pool threads
+        std::cout << "Traced pipeline steps (both runs):" << std::endl;
+        for (const auto& step : Tracing::summary()) {
+            if (step.category == "pipeline") {
+                std::cout << "  " << step.name << ": " << step.count << "x, " << std::fixed
+                          << std::setprecision(3) << step.total_ms << " ms, " << step.rows
+                          << " rows out, " << step.bytes << " bytes in" << std::endl;
+            }
+        }
+        if (Tracing::write_chrome_trace("pipeline_trace.json")) {
+            std::cout << "Chrome trace of " << Tracing::events().size()
+                      << " spans written to pipeline_trace.json" << std::endl;
+        }
+    }
+    
+    {
+        // What a span costs: two clock reads and one ring buffer write
+        constexpr int spans = 1000000;
+        auto time_spans = [] {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < spans; ++i) {
+                Tracing::Span span("overhead probe", "benchmark");
+                span.set_rows(static_cast<uint64_t>(i));
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / spans;
+        };
+        double traced_ns = time_spans();
+        Tracing::set_enabled(false);
+        double disabled_ns = time_spans();
+        Tracing::set_enabled(true);
+        std::cout << "Tracing cost per span: " << std::fixed << std::setprecision(1) << traced_ns
+                  << " ns recorded, " << disabled_ns << " ns disabled" << std::endl;
     }
     
     {
@@ -305,6 +844,186 @@ void demonstrate_performance_monitoring() {
         auto correlation = Statistics::correlation(dataset, "age", "salary");
         auto freq = Statistics::frequency_count(dataset, "department");
     }
+    
+    {
+        // A composite filter built from Filters is compiled into loops over
+        // the typed columns that narrow a selection vector; the same test as
+        // a lambda runs through DataRecord lookups and variant visits per row
+        std::pmr::vector<int64_t> days;
+        std::pmr::vector<double> amounts;
+        std::pmr::vector<std::pmr::string> regions;
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<> amount(0.0, 1000.0);
+        const char* names[] = {"north", "south", "east", "west"};
+        for (int row = 0; row < 1000000; ++row) {
+            days.push_back(row / 2740);
+            amounts.push_back(amount(gen));
+            regions.emplace_back(names[gen() % 4]);
+        }
+        DataSet orders({"day", "amount", "region"},
+                       {Column(std::move(days)), Column(std::move(amounts)), Column(std::move(regions))});
+        orders.encode_dictionary("region");
+        
+        auto compiled = Filters::logical_and(
+            Filters::logical_and(Filters::column_greater_than("day", 90), Filters::column_less_than("day", 273)),
+            Filters::logical_or(Filters::column_equals("region", std::string("north")),
+                                Filters::column_greater_than("amount", 900.0)));
+        FilterPredicate opaque = [](const DataRecord& record) {
+            double day = ValueOps::to_double(record["day"]);
+            return day > 90 && day < 273 &&
+                   (ValueOps::to_string(record["region"]) == "north" ||
+                    ValueOps::to_double(record["amount"]) > 900.0);
+        };
+        
+        auto time = [](auto&& work) {   // best of three runs
+            double best = 0.0;
+            for (int run = 0; run < 3; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                work();
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                best = run == 0 ? ms : std::min(best, ms);
+            }
+            return best;
+        };
+        DataSet fast, slow;
+        double fast_ms = time([&] { fast = orders.filter(compiled); });
+        double slow_ms = time([&] { slow = orders.filter(opaque); });
+        std::cout << "Compiled filter on 1M rows: " << fast.size() << " rows in " << std::fixed
+                  << std::setprecision(2) << fast_ms << " ms vs " << slow_ms << " ms row at a time ("
+                  << std::setprecision(1) << slow_ms / fast_ms << "x); same rows: " << std::boolalpha
+                  << std::equal(fast.begin(), fast.end(), slow.begin(), slow.end()) << std::endl;
+        
+        // The row-at-a-time filter split by morsel across a pool
+        DataSet pooled;
+        double pooled_ms = time([&] { pooled = orders.filter(opaque, ExecutionPolicy()); });
+        std::cout << "Row-at-a-time filter on " << std::thread::hardware_concurrency() << " threads: "
+                  << std::setprecision(2) << pooled_ms << " ms; same rows: "
+                  << std::equal(pooled.begin(), pooled.end(), slow.begin(), slow.end()) << std::endl;
+        
+        // Multi-key sort: keys are normalized to integers once and radix
+        // sorted, instead of comparing DataValues cell by cell
+        std::vector<SortKey> keys = {{"region", true}, {"amount", false}};
+        std::vector<size_t> radix, compared;
+        double radix_ms = time([&] { radix = orders.sort_order(keys); });
+        double compare_ms = time([&] {
+            compared.resize(orders.size());
+            std::iota(compared.begin(), compared.end(), 0);
+            const Column& region = orders.column("region");
+            const Column& amounts = orders.column("amount");
+            std::stable_sort(compared.begin(), compared.end(), [&](size_t a, size_t b) {
+                DataValue first = region.get(a), second = region.get(b);
+                if (ValueOps::compare_less(first, second)) return true;
+                if (ValueOps::compare_less(second, first)) return false;
+                return ValueOps::compare_less(amounts.get(b), amounts.get(a));
+            });
+        });
+        std::cout << "Sort by region, amount desc on 1M rows: " << std::setprecision(2) << radix_ms
+                  << " ms vs " << compare_ms << " ms comparing values (" << std::setprecision(1)
+                  << compare_ms / radix_ms << "x); same order: " << std::boolalpha << (radix == compared)
+                  << std::endl;
+        
+        // Orders joined to a 1M-row customer dimension: the customer table is
+        // the build side, radix-partitioned so each partition's hash table
+        // stays in cache; the parallel join builds and probes partitions
+        // on the pool
+        std::pmr::vector<int64_t> customer_ids, order_customers;
+        std::pmr::vector<std::pmr::string> tiers;
+        const char* tier_names[] = {"bronze", "silver", "gold"};
+        for (int64_t id = 0; id < 1000000; ++id) {
+            customer_ids.push_back(id * 7);
+            tiers.emplace_back(tier_names[id % 3]);
+        }
+        for (size_t row = 0; row < orders.size(); ++row) {
+            order_customers.push_back(static_cast<int64_t>(gen() % 1200000) * 7);
+        }
+        DataSet customers({"customer", "tier"}, {Column(std::move(customer_ids)), Column(std::move(tiers))});
+        customers.encode_dictionary("tier");
+        orders.set_column("customer", Column(std::move(order_customers)));
+        
+        ExecutionPolicy parallel;
+        DataSet joined, joined_parallel;
+        double join_ms = time([&] { joined = orders.join(customers, {"customer"}); });
+        double parallel_join_ms = time([&] {
+            joined_parallel = orders.join(customers, {"customer"}, {"customer"}, JoinKind::Inner, parallel);
+        });
+        std::cout << "Join 1M orders to 1M customers: " << joined.size() << " rows in " << std::setprecision(2)
+                  << join_ms << " ms, " << parallel_join_ms << " ms parallel; same rows: " << std::boolalpha
+                  << std::equal(joined.begin(), joined.end(), joined_parallel.begin(), joined_parallel.end())
+                  << std::endl;
+        
+        // The ten largest orders: a bounded heap of ten rows, no full sort
+        std::vector<SortKey> largest = {{"amount", false}};
+        DataSet top_ten, all_sorted;
+        double top_ms = time([&] { top_ten = orders.top_k(largest, 10); });
+        double sort_ms = time([&] { all_sorted = orders; all_sorted.sort_by(largest); });
+        DataSet sorted_ten = all_sorted.slice(0, 10);
+        std::cout << "Top 10 by amount of 1M rows: " << std::setprecision(2) << top_ms << " ms vs "
+                  << sort_ms << " ms for a full sort; same rows: " << std::boolalpha
+                  << std::equal(top_ten.begin(), top_ten.end(), sorted_ten.begin(), sorted_ten.end())
+                  << std::endl;
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    
+    {
+        // Aggregates over a typed double column go through the vector kernels
+        Column values(ColumnType::Double);
+        std::mt19937 gen(42);
+        std::normal_distribution<> dist(100.0, 15.0);
+        for (int i = 0; i < 1000000; ++i) {
+            values.append_double(dist(gen));
+        }
+        DataSet measurements({"value"}, {std::move(values)});
+        
+        DataValue sum, std_dev;
+        {
+            MONITOR_PERFORMANCE("Vectorized aggregation (1M doubles)");
+            sum = measurements.aggregate_column("value", Aggregates::Sum);
+            std_dev = measurements.aggregate_column("value", Aggregates::StdDev);
+        }
+        
+        Kernels::Isa best = Kernels::active_isa();
+        Kernels::set_isa(Kernels::Isa::Scalar);
+        bool identical = sum.as_double() == measurements.aggregate_column("value", Aggregates::Sum).as_double() &&
+                         std_dev.as_double() == measurements.aggregate_column("value", Aggregates::StdDev).as_double();
+        Kernels::set_isa(best);
+        
+        std::cout << "Kernels: " << Kernels::isa_name(best) << ", sum " << std::fixed
+                  << std::setprecision(2) << sum.as_double() << ", std dev "
+                  << std_dev.as_double() << ", identical to scalar: " << std::boolalpha
+                  << identical << std::endl;
+        
+        // Exact percentiles select over one copy; the sketch keeps a few
+        // thousand samples no matter how many rows it has seen
+        QuantileSketch sketch = Statistics::sketch_column(measurements, "value");
+        for (double fraction : {0.5, 0.99}) {
+            std::cout << "p" << static_cast<int>(fraction * 100) << " exact "
+                      << Statistics::percentile(measurements, "value", fraction)
+                      << ", sketch " << sketch.quantile(fraction) << std::endl;
+        }
+        std::cout << "Sketch retained " << sketch.retained() << " of " << sketch.count()
+                  << " values" << std::endl;
+    }
+    
+    {
+        // A Mixed column stores DataValues: ids past 2^31 stay integers and
+        // short strings stay inline, so only the long ones allocate
+        Column cells(ColumnType::Mixed);
+        cells.reserve(999999);
+        for (int i = 0; i < 333333; ++i) {
+            cells.append(DataValue(int64_t{4000000000} + i));
+            cells.append(DataValue(i * 0.5));
+            cells.append(DataValue(i % 10 ? "user-" + std::to_string(i)
+                                          : "a much longer comment on user " + std::to_string(i)));
+        }
+        const auto& values = cells.values();
+        size_t allocated = std::count_if(values.begin(), values.end(),
+                                         [](const DataValue& value) { return value.is_long_string(); });
+        std::cout << "Mixed column of " << cells.size() << " cells: " << sizeof(DataValue)
+                  << " bytes a cell (" << sizeof(std::variant<int, double, std::string>)
+                  << " as a variant), first id " << ValueOps::to_string(values.front())
+                  << (values.front().is_int() ? " as an integer" : " as text") << ", "
+                  << allocated << " strings allocated" << std::endl;
+    }
 }
 
 int main() {
@@ -319,6 +1038,8 @@ int main() {
         demonstrate_pipeline_processing();
         demonstrate_correlation_analysis();
         demonstrate_custom_iterators();
+        demonstrate_streaming_pipeline();
+        demonstrate_incremental_pipeline();
         demonstrate_performance_monitoring();
         
         std::cout << "\n" << std::string(60, '=') << std::endl;
@@ -334,7 +1055,7 @@ int main() {
         std::cout << "9. STL algorithms and containers throughout" << std::endl;
         std::cout << "10. Memory-efficient data processing patterns" << std::endl;
         std::cout << std::string(60, '=') << std::endl;
-        
+    
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
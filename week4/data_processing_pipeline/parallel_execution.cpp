@@ -0,0 +1,409 @@
+/*
+ * Data Processing Pipeline - Parallel Execution
+ *
+ * Morsel-driven execution on the week3 ThreadPool: the input is cut into
+ * ranges of ExecutionPolicy::morsel_rows rows, every fused pipeline pass runs
+ * on the morsels independently and the outputs are concatenated in input
+ * order, and so do filter and transform_column. Blocking points merge the
+ * per-morsel work: sort_by runs the sort engine (sorting.hpp) with its
+ * passes split by morsel, top_k keeps a heap per morsel and picks among
+ * their survivors, join (join.hpp) hashes and probes by morsel or builds
+ * and probes its partitions as separate tasks, group_by_aggregate builds
+ * per-morsel groups and merges them one hash partition per task, and
+ * aggregate_column and covariance_matrix combine per-morsel partials.
+ * Sorts are stable and merges keep morsel order, so results match the
+ * serial code exactly (sums, means, deviations and covariances to
+ * rounding: their partials add up in another order).
+ */
+
+#include "data_processor.hpp"
+#include "sorting.hpp"
+#include "join.hpp"
+#include "expressions.hpp"
+#include "simd_kernels.hpp"
+#include "advanced_task_scheduler.hpp"
+
+namespace DataProcessing {
+
+namespace {
+    size_t thread_count(const ExecutionPolicy& policy) {
+        return policy.threads ? policy.threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    // Run work on the pool and hand back its result (or exception) as a future
+    template<typename Work>
+    auto submit(ThreadPool& pool, std::string name, Work work) -> std::future<decltype(work())> {
+        using Result = decltype(work());
+        auto job = std::make_shared<std::packaged_task<Result()>>(std::move(work));
+        auto result = job->get_future();
+        pool.enqueue(std::make_shared<Task<void>>(std::move(name), [job] { (*job)(); }));
+        return result;
+    }
+    
+    // Sorting::RunTasks on a pool: submit every task and wait for all of
+    // them. Each task is traced as a span named span_name.
+    Sorting::RunTasks run_on(ThreadPool& pool, const char* span_name) {
+        return [&pool, span_name](std::vector<std::function<void()>>& tasks) {
+            std::vector<std::future<void>> pending;
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                pending.push_back(submit(pool, "sort-task-" + std::to_string(i), [&task = tasks[i], span_name] {
+                    Tracing::Span span(span_name, "task");
+                    task();
+                }));
+            }
+            for (auto& task : pending) task.get();
+        };
+    }
+    
+    // work(begin, end) for every morsel of rows on the pool, each traced as
+    // a span named span_name; the results come back in morsel order
+    template<typename Work>
+    auto map_morsels(ThreadPool& pool, size_t rows, size_t morsel_rows, const char* span_name, Work work) {
+        using Result = decltype(work(size_t(), size_t()));
+        std::vector<std::future<Result>> pending;
+        for (size_t begin = 0; begin < rows; begin += morsel_rows) {
+            size_t end = std::min(rows, begin + morsel_rows);
+            pending.push_back(submit(pool, std::string(span_name) + "-morsel-" + std::to_string(begin / morsel_rows),
+                [&work, span_name, begin, end] {
+                    Tracing::Span span(span_name, "morsel");
+                    span.set_rows(end - begin);
+                    return work(begin, end);
+                }));
+        }
+        std::vector<Result> results;
+        results.reserve(pending.size());
+        for (auto& part : pending) results.push_back(part.get());
+        return results;
+    }
+}
+
+DataSet DataSet::filter(FilterPredicate predicate, const ExecutionPolicy& policy) const {
+    size_t morsel_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (thread_count(policy) <= 1 || rows_ <= morsel_rows) {
+        return filter(std::move(predicate));
+    }
+    
+    ThreadPool pool(thread_count(policy));
+    auto parts = map_morsels(pool, rows_, morsel_rows, "filter", [this, &predicate](size_t begin, size_t end) {
+        return select_rows(predicate, begin, end);
+    });
+    std::vector<size_t> selected;
+    for (const auto& part : parts) {
+        selected.insert(selected.end(), part.begin(), part.end());
+    }
+    return take(selected);
+}
+
+void DataSet::transform_column(const std::string& column, TransformFunction func, const ExecutionPolicy& policy) {
+    size_t morsel_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (thread_count(policy) <= 1 || rows_ <= morsel_rows) {
+        transform_column(column, std::move(func));
+        return;
+    }
+    const Column& source = this->column(column);
+    size_t index = *find_column(column);
+    ThreadPool pool(thread_count(policy));
+    
+    // Compiled arithmetic: one copy of the program (and its scratch stack)
+    // per morsel, each writing its range of the output buffer
+    if (const auto* numeric = func.target<Expressions::NumericTransform>()) {
+        if (auto compiled = Expressions::CompiledArithmetic::compile(*numeric->node, *this, &source)) {
+            std::pmr::vector<double> values(rows_);
+            map_morsels(pool, rows_, morsel_rows, "transform_column", [&compiled, &values](size_t begin, size_t end) {
+                Expressions::CompiledArithmetic program = *compiled;
+                program.evaluate(begin, end, values.data() + begin);
+                return end - begin;
+            });
+            data_[index] = Column(std::move(values));
+            return;
+        }
+    }
+    
+    // Each morsel builds its part of the column; appending the parts in
+    // order types the result as the serial row-by-row append would
+    auto parts = map_morsels(pool, rows_, morsel_rows, "transform_column", [&source, &func](size_t begin, size_t end) {
+        Column part;
+        part.reserve(end - begin);
+        for (size_t row = begin; row < end; ++row) {
+            part.append(func(source.get(row)));
+        }
+        return part;
+    });
+    Column transformed = std::move(parts[0]);
+    for (size_t i = 1; i < parts.size(); ++i) {
+        transformed.extend(std::move(parts[i]));
+    }
+    data_[index] = std::move(transformed);
+}
+
+DataValue DataSet::aggregate_column(const std::string& column, AggregateFunction func,
+                                    const ExecutionPolicy& policy) const {
+    using Aggregates::Kind;
+    const Column& values = this->column(column);
+    const auto* builtin = func.target<Aggregates::Builtin>();
+    size_t morsel_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (!builtin || builtin->kind == Kind::Count || !values.is_numeric() ||
+        thread_count(policy) <= 1 || rows_ <= morsel_rows) {
+        return aggregate_column(column, std::move(func));
+    }
+    ThreadPool pool(thread_count(policy));
+    
+    if (values.type() == ColumnType::Int64) {
+        const int64_t* ints = values.ints().data();
+        if (builtin->kind == Kind::Min || builtin->kind == Kind::Max) {
+            bool min = builtin->kind == Kind::Min;
+            auto parts = map_morsels(pool, rows_, morsel_rows, "aggregate_column", [ints, min](size_t begin, size_t end) {
+                return min ? Kernels::min(ints + begin, end - begin) : Kernels::max(ints + begin, end - begin);
+            });
+            return min ? *std::min_element(parts.begin(), parts.end())
+                       : *std::max_element(parts.begin(), parts.end());
+        }
+        // Integer sums are exact in any order
+        auto sums = map_morsels(pool, rows_, morsel_rows, "aggregate_column", [ints](size_t begin, size_t end) {
+            return Kernels::sum(ints + begin, end - begin);
+        });
+        double sum = static_cast<double>(std::accumulate(sums.begin(), sums.end(), int64_t(0)));
+        if (builtin->kind == Kind::Sum) return sum;
+        if (builtin->kind == Kind::Mean) return sum / rows_;
+        
+        double mean = sum / rows_;
+        auto squares = map_morsels(pool, rows_, morsel_rows, "aggregate_column", [ints, mean](size_t begin, size_t end) {
+            double total = 0.0;
+            for (size_t row = begin; row < end; ++row) {
+                double deviation = static_cast<double>(ints[row]) - mean;
+                total += deviation * deviation;
+            }
+            return total;
+        });
+        return std::sqrt(std::accumulate(squares.begin(), squares.end(), 0.0) / rows_);
+    }
+    
+    const double* doubles = values.doubles().data();
+    if (builtin->kind == Kind::Min || builtin->kind == Kind::Max) {
+        bool min = builtin->kind == Kind::Min;
+        auto parts = map_morsels(pool, rows_, morsel_rows, "aggregate_column", [doubles, min](size_t begin, size_t end) {
+            return min ? Kernels::min(doubles + begin, end - begin) : Kernels::max(doubles + begin, end - begin);
+        });
+        return min ? *std::min_element(parts.begin(), parts.end()) : *std::max_element(parts.begin(), parts.end());
+    }
+    auto sums = map_morsels(pool, rows_, morsel_rows, "aggregate_column", [doubles](size_t begin, size_t end) {
+        return Kernels::sum(doubles + begin, end - begin);
+    });
+    double sum = std::accumulate(sums.begin(), sums.end(), 0.0);
+    if (builtin->kind == Kind::Sum) return sum;
+    if (builtin->kind == Kind::Mean) return sum / rows_;
+    
+    // StdDev: the two passes of Kernels::variance, each split by morsel
+    double mean = sum / rows_;
+    auto squares = map_morsels(pool, rows_, morsel_rows, "aggregate_column", [doubles, mean](size_t begin, size_t end) {
+        return Kernels::sum_squared_deviations(doubles + begin, end - begin, mean);
+    });
+    return std::sqrt(std::accumulate(squares.begin(), squares.end(), 0.0) / rows_);
+}
+
+void DataSet::sort_by_column(const std::string& column, bool ascending, const ExecutionPolicy& policy) {
+    sort_by({{column, ascending}}, policy);
+}
+
+void DataSet::sort_by(const std::vector<SortKey>& keys, const ExecutionPolicy& policy) {
+    *this = take(sort_order(keys, policy));
+}
+
+DataSet DataSet::top_k(const std::vector<SortKey>& keys, size_t k, const ExecutionPolicy& policy) const {
+    size_t run_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (thread_count(policy) <= 1 || rows_ <= run_rows) {
+        return top_k(keys, k);
+    }
+    
+    ThreadPool pool(thread_count(policy));
+    return take(Sorting::top(*this, keys, k, run_rows, run_on(pool, "top_k")));
+}
+
+DataSet DataSet::join(const DataSet& right, const std::vector<std::string>& left_keys,
+                      const std::vector<std::string>& right_keys, JoinKind kind,
+                      const ExecutionPolicy& policy) const {
+    size_t run_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (thread_count(policy) <= 1 || (rows_ <= run_rows && right.size() < Joins::partition_rows)) {
+        return join(right, left_keys, right_keys, kind);
+    }
+    
+    ThreadPool pool(thread_count(policy));
+    return joined(right, left_keys, right_keys, kind,
+                  Joins::match(*this, right, left_keys, right_keys, kind, run_rows, run_on(pool, "join")));
+}
+
+std::vector<size_t> DataSet::sort_order(const std::vector<SortKey>& keys, const ExecutionPolicy& policy) const {
+    size_t run_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (thread_count(policy) <= 1 || rows_ <= run_rows) {
+        return sort_order(keys);
+    }
+    
+    ThreadPool pool(thread_count(policy));
+    return Sorting::order(*this, keys, run_rows, run_on(pool, "sort_by"));
+}
+
+std::unordered_map<std::string, DataValue> DataSet::group_by_aggregate(
+    const std::string& group_column,
+    const std::string& value_column,
+    AggregateFunction func,
+    const ExecutionPolicy& policy) const {
+    
+    size_t threads = thread_count(policy);
+    size_t morsel_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (threads <= 1 || rows_ <= morsel_rows) {
+        return group_by_aggregate(group_column, value_column, func);
+    }
+    if (!has_column(group_column) || !has_column(value_column)) {
+        throw std::invalid_argument("Column not found");
+    }
+    
+    const Column& keys = column(group_column);
+    const Column& values = column(value_column);
+    using Groups = string_flat_hash_map<std::vector<DataValue>>;
+    
+    // Phase 1: every morsel groups its rows, already split by key hash
+    size_t partitions = threads;
+    size_t morsels = (rows_ + morsel_rows - 1) / morsel_rows;
+    std::vector<std::vector<Groups>> partial(morsels, std::vector<Groups>(partitions));
+    
+    ThreadPool pool(threads);
+    std::vector<std::future<void>> pending;
+    for (size_t morsel = 0; morsel < morsels; ++morsel) {
+        pending.push_back(submit(pool, "group-morsel-" + std::to_string(morsel), [&, morsel] {
+            size_t end = std::min(rows_, (morsel + 1) * morsel_rows);
+            std::hash<std::string> hash;
+            for (size_t row = morsel * morsel_rows; row < end; ++row) {
+                std::string key = ValueOps::to_string(keys.get(row));
+                size_t partition = hash(key) % partitions;
+                partial[morsel][partition][std::move(key)].push_back(values.get(row));
+            }
+        }));
+    }
+    for (auto& task : pending) task.get();
+    
+    // Phase 2: each partition merges its groups in morsel order, so every
+    // group sees its values in row order, and aggregates them
+    std::vector<std::future<std::unordered_map<std::string, DataValue>>> merged;
+    for (size_t partition = 0; partition < partitions; ++partition) {
+        merged.push_back(submit(pool, "group-partition-" + std::to_string(partition), [&, partition] {
+            Groups groups = std::move(partial[0][partition]);
+            for (size_t morsel = 1; morsel < morsels; ++morsel) {
+                for (auto& [key, group_values] : partial[morsel][partition]) {
+                    auto& target = groups[key];
+                    target.insert(target.end(), std::make_move_iterator(group_values.begin()),
+                                  std::make_move_iterator(group_values.end()));
+                }
+            }
+            
+            std::unordered_map<std::string, DataValue> result;
+            for (const auto& [group, group_values] : groups) {
+                result[group] = func(group_values);
+            }
+            return result;
+        }));
+    }
+    
+    std::unordered_map<std::string, DataValue> result;
+    for (auto& part : merged) {
+        result.merge(part.get());
+    }
+    return result;
+}
+
+Statistics::CovarianceMatrix Statistics::covariance_matrix(const DataSet& dataset,
+                                                           const std::vector<std::string>& columns,
+                                                           const ExecutionPolicy& policy) {
+    size_t morsel_rows = std::max<size_t>(policy.morsel_rows, 1);
+    if (thread_count(policy) <= 1 || dataset.size() <= morsel_rows) {
+        return covariance_matrix(dataset, columns);
+    }
+    
+    // A state per morsel, merged in morsel order
+    ThreadPool pool(thread_count(policy));
+    std::vector<std::future<CovarianceMatrix>> parts;
+    for (size_t begin = 0; begin < dataset.size(); begin += morsel_rows) {
+        parts.push_back(submit(pool, "covariance-morsel-" + std::to_string(begin / morsel_rows),
+            [&dataset, &columns, begin, morsel_rows] {
+                Tracing::Span span("covariance_matrix", "morsel");
+                CovarianceMatrix part(columns);
+                part.update(dataset, begin, begin + morsel_rows);
+                span.set_rows(std::min(morsel_rows, dataset.size() - begin));
+                return part;
+            }));
+    }
+    
+    CovarianceMatrix matrix = parts[0].get();
+    for (size_t i = 1; i < parts.size(); ++i) {
+        matrix.merge(parts[i].get());
+    }
+    return matrix;
+}
+
+DataSet Pipeline::execute(DataSet input, const ExecutionPolicy& policy) const {
+    size_t threads = thread_count(policy);
+    if (threads <= 1 && !policy.counters) {
+        return execute(std::move(input));
+    }
+    
+    Tracing::Span span("Pipeline::execute (parallel)");
+    span.add_bytes(input.cell_bytes());
+    size_t morsel_rows = std::max<size_t>(policy.morsel_rows, 1);
+    ThreadPool pool(threads);
+    
+    // Fused pass over rows [begin, end), reported to the policy's counters
+    PipelineCounters* counters = policy.counters;
+    auto run_morsel = [counters](const DataSet& rows, const PlanStep& step, size_t begin, size_t end) {
+        auto start = std::chrono::steady_clock::now();
+        DataSet part = run_fused(rows, step, begin, end);
+        if (counters) {
+            counters->rows_in.add(static_cast<int64_t>(std::min(end, rows.size()) - begin));
+            counters->rows_out.add(static_cast<int64_t>(part.size()));
+            counters->morsels.add();
+            counters->morsel_micros.record(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        return part;
+    };
+    
+    for (const auto& step : plan()) {
+        const char* step_name = step.trace_name();
+        Tracing::Span step_span(step_name);
+        step_span.add_bytes(input.cell_bytes());
+        if ((!step.fused.empty() || step.projection) && input.size() > morsel_rows) {
+            // Fused pass per morsel; outputs are concatenated in input order
+            std::vector<std::future<DataSet>> parts;
+            for (size_t begin = 0; begin < input.size(); begin += morsel_rows) {
+                parts.push_back(submit(pool, "morsel-" + std::to_string(begin / morsel_rows),
+                    [&input, &step, &run_morsel, step_name, begin, morsel_rows] {
+                        Tracing::Span morsel_span(step_name, "morsel");
+                        DataSet part = run_morsel(input, step, begin, begin + morsel_rows);
+                        morsel_span.set_rows(part.size());
+                        return part;
+                    }));
+            }
+            
+            DataSet output;
+            for (auto& part : parts) {
+                output.append(part.get());
+            }
+            input = std::move(output);
+        } else if (!step.fused.empty() || step.projection) {
+            input = run_morsel(input, step, 0, input.size());
+        }
+        
+        if (step.blocking && step.blocking->kind == Stage::Kind::Sort && input.size() > morsel_rows) {
+            input = input.take(Sorting::order(input, step.blocking->keys, morsel_rows, run_on(pool, step_name)));
+        } else if (step.blocking && step.blocking->kind == Stage::Kind::TopK && input.size() > morsel_rows) {
+            input = input.take(Sorting::top(input, step.blocking->keys, step.blocking->limit,
+                                            morsel_rows, run_on(pool, step_name)));
+        } else if (step.blocking) {
+            run_blocking(input, *step.blocking);
+        }
+        step_span.set_rows(input.size());
+    }
+    
+    span.set_rows(input.size());
+    return input;
+}
+
+} // namespace DataProcessing
@@ -0,0 +1,582 @@
+/*
+ * Data Processing Pipeline - Aggregate Kernels Implementation
+ *
+ * Each double kernel exists once per instruction set. The vector versions
+ * keep eight accumulator lanes in registers (one zmm, two ymm or four NEON
+ * q registers) and store them to an array for the shared scalar reduction.
+ */
+
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KERNELS_NEON 1
+#endif
+
+namespace DataProcessing {
+namespace Kernels {
+
+namespace {
+    constexpr size_t LANES = 8;
+    
+    // Lane-wise min/max with the semantics of the x86 minpd/maxpd
+    // instructions (the second operand wins on ties and NaN), which every
+    // implementation reproduces so they agree bit for bit
+    inline double lane_min(double a, double b) { return a < b ? a : b; }
+    inline double lane_max(double a, double b) { return a > b ? a : b; }
+    
+    double reduce_sum(const double* lanes, const double* tail, size_t tail_count) {
+        double result = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                        ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        for (size_t i = 0; i < tail_count; ++i) {
+            result += tail[i];
+        }
+        return result;
+    }
+    
+    double reduce_squares(const double* lanes, const double* tail, size_t tail_count, double mean) {
+        double result = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                        ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        for (size_t i = 0; i < tail_count; ++i) {
+            double deviation = tail[i] - mean;
+            result += deviation * deviation;
+        }
+        return result;
+    }
+    
+    // inline: the dot kernels reduce several accumulators each, and a call
+    // from their AVX code into this SSE-encoded function would pay for a
+    // transition between the two every time
+    inline double reduce_dot(const double* lanes, const double* x_tail, const double* y_tail, size_t tail_count) {
+        double result = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                        ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+        for (size_t i = 0; i < tail_count; ++i) {
+            result += x_tail[i] * y_tail[i];
+        }
+        return result;
+    }
+    
+    template<typename Op>
+    double reduce_extreme(const double* lanes, const double* tail, size_t tail_count, Op op) {
+        double result = lanes[0];
+        for (size_t i = 1; i < LANES; ++i) {
+            result = op(result, lanes[i]);
+        }
+        for (size_t i = 0; i < tail_count; ++i) {
+            result = op(result, tail[i]);
+        }
+        return result;
+    }
+    
+    // Scalar reference implementation
+    namespace scalar {
+        double sum(const double* values, size_t count) {
+            double lanes[LANES] = {};
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    lanes[lane] += values[i + lane];
+                }
+            }
+            return reduce_sum(lanes, values + full, count - full);
+        }
+        
+        double squares(const double* values, size_t count, double mean) {
+            double lanes[LANES] = {};
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    double deviation = values[i + lane] - mean;
+                    lanes[lane] += deviation * deviation;
+                }
+            }
+            return reduce_squares(lanes, values + full, count - full, mean);
+        }
+        
+        template<typename Op>
+        double extreme(const double* values, size_t count, double identity, Op op) {
+            double lanes[LANES];
+            std::fill(lanes, lanes + LANES, identity);
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    lanes[lane] = op(lanes[lane], values[i + lane]);
+                }
+            }
+            return reduce_extreme(lanes, values + full, count - full, op);
+        }
+        
+        void dots(const double* x, const double* const* ys, size_t y_count, size_t count, double* out) {
+            size_t full = count - count % LANES;
+            for (size_t j = 0; j < y_count; ++j) {
+                const double* y = ys[j];
+                double lanes[LANES] = {};
+                for (size_t i = 0; i < full; i += LANES) {
+                    for (size_t lane = 0; lane < LANES; ++lane) {
+                        lanes[lane] += x[i + lane] * y[i + lane];
+                    }
+                }
+                out[j] = reduce_dot(lanes, x + full, y + full, count - full);
+            }
+        }
+    }
+
+#ifdef KERNELS_X86
+    namespace avx2 {
+        __attribute__((target("avx2")))
+        double sum(const double* values, size_t count) {
+            __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                low = _mm256_add_pd(low, _mm256_loadu_pd(values + i));
+                high = _mm256_add_pd(high, _mm256_loadu_pd(values + i + 4));
+            }
+            double lanes[LANES];
+            _mm256_storeu_pd(lanes, low);
+            _mm256_storeu_pd(lanes + 4, high);
+            return reduce_sum(lanes, values + full, count - full);
+        }
+        
+        __attribute__((target("avx2")))
+        double squares(const double* values, size_t count, double mean) {
+            __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+            __m256d center = _mm256_set1_pd(mean);
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(values + i), center);
+                __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(values + i + 4), center);
+                low = _mm256_add_pd(low, _mm256_mul_pd(d0, d0));
+                high = _mm256_add_pd(high, _mm256_mul_pd(d1, d1));
+            }
+            double lanes[LANES];
+            _mm256_storeu_pd(lanes, low);
+            _mm256_storeu_pd(lanes + 4, high);
+            return reduce_squares(lanes, values + full, count - full, mean);
+        }
+        
+        __attribute__((target("avx2")))
+        double min(const double* values, size_t count) {
+            __m256d low = _mm256_set1_pd(std::numeric_limits<double>::infinity()), high = low;
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                low = _mm256_min_pd(low, _mm256_loadu_pd(values + i));
+                high = _mm256_min_pd(high, _mm256_loadu_pd(values + i + 4));
+            }
+            double lanes[LANES];
+            _mm256_storeu_pd(lanes, low);
+            _mm256_storeu_pd(lanes + 4, high);
+            return reduce_extreme(lanes, values + full, count - full, lane_min);
+        }
+        
+        __attribute__((target("avx2")))
+        double max(const double* values, size_t count) {
+            __m256d low = _mm256_set1_pd(-std::numeric_limits<double>::infinity()), high = low;
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                low = _mm256_max_pd(low, _mm256_loadu_pd(values + i));
+                high = _mm256_max_pd(high, _mm256_loadu_pd(values + i + 4));
+            }
+            double lanes[LANES];
+            _mm256_storeu_pd(lanes, low);
+            _mm256_storeu_pd(lanes + 4, high);
+            return reduce_extreme(lanes, values + full, count - full, lane_max);
+        }
+        
+        __attribute__((target("avx2")))
+        void dots(const double* x, const double* const* ys, size_t y_count, size_t count, double* out) {
+            size_t full = count - count % LANES;
+            size_t j = 0;
+            for (; j + 4 <= y_count; j += 4) {
+                const double* y0 = ys[j];
+                const double* y1 = ys[j + 1];
+                const double* y2 = ys[j + 2];
+                const double* y3 = ys[j + 3];
+                __m256d low0 = _mm256_setzero_pd(), high0 = _mm256_setzero_pd();
+                __m256d low1 = _mm256_setzero_pd(), high1 = _mm256_setzero_pd();
+                __m256d low2 = _mm256_setzero_pd(), high2 = _mm256_setzero_pd();
+                __m256d low3 = _mm256_setzero_pd(), high3 = _mm256_setzero_pd();
+                for (size_t i = 0; i < full; i += LANES) {
+                    __m256d x_low = _mm256_loadu_pd(x + i), x_high = _mm256_loadu_pd(x + i + 4);
+                    low0 = _mm256_add_pd(low0, _mm256_mul_pd(x_low, _mm256_loadu_pd(y0 + i)));
+                    high0 = _mm256_add_pd(high0, _mm256_mul_pd(x_high, _mm256_loadu_pd(y0 + i + 4)));
+                    low1 = _mm256_add_pd(low1, _mm256_mul_pd(x_low, _mm256_loadu_pd(y1 + i)));
+                    high1 = _mm256_add_pd(high1, _mm256_mul_pd(x_high, _mm256_loadu_pd(y1 + i + 4)));
+                    low2 = _mm256_add_pd(low2, _mm256_mul_pd(x_low, _mm256_loadu_pd(y2 + i)));
+                    high2 = _mm256_add_pd(high2, _mm256_mul_pd(x_high, _mm256_loadu_pd(y2 + i + 4)));
+                    low3 = _mm256_add_pd(low3, _mm256_mul_pd(x_low, _mm256_loadu_pd(y3 + i)));
+                    high3 = _mm256_add_pd(high3, _mm256_mul_pd(x_high, _mm256_loadu_pd(y3 + i + 4)));
+                }
+                double lanes[LANES];
+                _mm256_storeu_pd(lanes, low0);
+                _mm256_storeu_pd(lanes + 4, high0);
+                out[j] = reduce_dot(lanes, x + full, y0 + full, count - full);
+                _mm256_storeu_pd(lanes, low1);
+                _mm256_storeu_pd(lanes + 4, high1);
+                out[j + 1] = reduce_dot(lanes, x + full, y1 + full, count - full);
+                _mm256_storeu_pd(lanes, low2);
+                _mm256_storeu_pd(lanes + 4, high2);
+                out[j + 2] = reduce_dot(lanes, x + full, y2 + full, count - full);
+                _mm256_storeu_pd(lanes, low3);
+                _mm256_storeu_pd(lanes + 4, high3);
+                out[j + 3] = reduce_dot(lanes, x + full, y3 + full, count - full);
+            }
+            for (; j < y_count; ++j) {
+                const double* y = ys[j];
+                __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+                for (size_t i = 0; i < full; i += LANES) {
+                    low = _mm256_add_pd(low, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+                    high = _mm256_add_pd(high, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+                }
+                double lanes[LANES];
+                _mm256_storeu_pd(lanes, low);
+                _mm256_storeu_pd(lanes + 4, high);
+                out[j] = reduce_dot(lanes, x + full, y + full, count - full);
+            }
+        }
+    }
+    
+    // min/max use the full-mask forms: the unmasked intrinsics trip a false
+    // -Wmaybe-uninitialized in GCC 12's headers
+    namespace avx512 {
+        __attribute__((target("avx512f")))
+        double sum(const double* values, size_t count) {
+            __m512d acc = _mm512_setzero_pd();
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                acc = _mm512_add_pd(acc, _mm512_loadu_pd(values + i));
+            }
+            double lanes[LANES];
+            _mm512_storeu_pd(lanes, acc);
+            return reduce_sum(lanes, values + full, count - full);
+        }
+        
+        __attribute__((target("avx512f")))
+        double squares(const double* values, size_t count, double mean) {
+            __m512d acc = _mm512_setzero_pd();
+            __m512d center = _mm512_set1_pd(mean);
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                __m512d deviation = _mm512_sub_pd(_mm512_loadu_pd(values + i), center);
+                acc = _mm512_add_pd(acc, _mm512_mul_pd(deviation, deviation));
+            }
+            double lanes[LANES];
+            _mm512_storeu_pd(lanes, acc);
+            return reduce_squares(lanes, values + full, count - full, mean);
+        }
+        
+        __attribute__((target("avx512f")))
+        double min(const double* values, size_t count) {
+            __m512d acc = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                acc = _mm512_mask_min_pd(acc, 0xFF, acc, _mm512_loadu_pd(values + i));
+            }
+            double lanes[LANES];
+            _mm512_storeu_pd(lanes, acc);
+            return reduce_extreme(lanes, values + full, count - full, lane_min);
+        }
+        
+        __attribute__((target("avx512f")))
+        double max(const double* values, size_t count) {
+            __m512d acc = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                acc = _mm512_mask_max_pd(acc, 0xFF, acc, _mm512_loadu_pd(values + i));
+            }
+            double lanes[LANES];
+            _mm512_storeu_pd(lanes, acc);
+            return reduce_extreme(lanes, values + full, count - full, lane_max);
+        }
+        
+        __attribute__((target("avx512f")))
+        void dots(const double* x, const double* const* ys, size_t y_count, size_t count, double* out) {
+            size_t full = count - count % LANES;
+            size_t j = 0;
+            for (; j + 4 <= y_count; j += 4) {
+                const double* y0 = ys[j];
+                const double* y1 = ys[j + 1];
+                const double* y2 = ys[j + 2];
+                const double* y3 = ys[j + 3];
+                __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+                __m512d acc2 = _mm512_setzero_pd(), acc3 = _mm512_setzero_pd();
+                for (size_t i = 0; i < full; i += LANES) {
+                    __m512d values = _mm512_loadu_pd(x + i);
+                    acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(values, _mm512_loadu_pd(y0 + i)));
+                    acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(values, _mm512_loadu_pd(y1 + i)));
+                    acc2 = _mm512_add_pd(acc2, _mm512_mul_pd(values, _mm512_loadu_pd(y2 + i)));
+                    acc3 = _mm512_add_pd(acc3, _mm512_mul_pd(values, _mm512_loadu_pd(y3 + i)));
+                }
+                double lanes[LANES];
+                _mm512_storeu_pd(lanes, acc0);
+                out[j] = reduce_dot(lanes, x + full, y0 + full, count - full);
+                _mm512_storeu_pd(lanes, acc1);
+                out[j + 1] = reduce_dot(lanes, x + full, y1 + full, count - full);
+                _mm512_storeu_pd(lanes, acc2);
+                out[j + 2] = reduce_dot(lanes, x + full, y2 + full, count - full);
+                _mm512_storeu_pd(lanes, acc3);
+                out[j + 3] = reduce_dot(lanes, x + full, y3 + full, count - full);
+            }
+            for (; j < y_count; ++j) {
+                const double* y = ys[j];
+                __m512d acc = _mm512_setzero_pd();
+                for (size_t i = 0; i < full; i += LANES) {
+                    acc = _mm512_add_pd(acc, _mm512_mul_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+                }
+                double lanes[LANES];
+                _mm512_storeu_pd(lanes, acc);
+                out[j] = reduce_dot(lanes, x + full, y + full, count - full);
+            }
+        }
+    }
+#endif
+
+#ifdef KERNELS_NEON
+    namespace neon {
+        // Four q registers hold lanes {0,1}, {2,3}, {4,5}, {6,7}
+        struct Accumulator {
+            float64x2_t part[4];
+            
+            explicit Accumulator(double value) {
+                for (auto& p : part) p = vdupq_n_f64(value);
+            }
+            void store(double* lanes) const {
+                for (size_t i = 0; i < 4; ++i) vst1q_f64(lanes + 2 * i, part[i]);
+            }
+        };
+        
+        // minpd/maxpd semantics (vminq_f64 handles NaN and signed zero differently)
+        inline float64x2_t min_pd(float64x2_t a, float64x2_t b) { return vbslq_f64(vcltq_f64(a, b), a, b); }
+        inline float64x2_t max_pd(float64x2_t a, float64x2_t b) { return vbslq_f64(vcgtq_f64(a, b), a, b); }
+        
+        double sum(const double* values, size_t count) {
+            Accumulator acc(0.0);
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t p = 0; p < 4; ++p) {
+                    acc.part[p] = vaddq_f64(acc.part[p], vld1q_f64(values + i + 2 * p));
+                }
+            }
+            double lanes[LANES];
+            acc.store(lanes);
+            return reduce_sum(lanes, values + full, count - full);
+        }
+        
+        double squares(const double* values, size_t count, double mean) {
+            Accumulator acc(0.0);
+            float64x2_t center = vdupq_n_f64(mean);
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t p = 0; p < 4; ++p) {
+                    float64x2_t deviation = vsubq_f64(vld1q_f64(values + i + 2 * p), center);
+                    acc.part[p] = vaddq_f64(acc.part[p], vmulq_f64(deviation, deviation));
+                }
+            }
+            double lanes[LANES];
+            acc.store(lanes);
+            return reduce_squares(lanes, values + full, count - full, mean);
+        }
+        
+        double min(const double* values, size_t count) {
+            Accumulator acc(std::numeric_limits<double>::infinity());
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t p = 0; p < 4; ++p) {
+                    acc.part[p] = min_pd(acc.part[p], vld1q_f64(values + i + 2 * p));
+                }
+            }
+            double lanes[LANES];
+            acc.store(lanes);
+            return reduce_extreme(lanes, values + full, count - full, lane_min);
+        }
+        
+        double max(const double* values, size_t count) {
+            Accumulator acc(-std::numeric_limits<double>::infinity());
+            size_t full = count - count % LANES;
+            for (size_t i = 0; i < full; i += LANES) {
+                for (size_t p = 0; p < 4; ++p) {
+                    acc.part[p] = max_pd(acc.part[p], vld1q_f64(values + i + 2 * p));
+                }
+            }
+            double lanes[LANES];
+            acc.store(lanes);
+            return reduce_extreme(lanes, values + full, count - full, lane_max);
+        }
+        
+        void dots(const double* x, const double* const* ys, size_t y_count, size_t count, double* out) {
+            size_t full = count - count % LANES;
+            for (size_t j = 0; j < y_count; ++j) {
+                Accumulator acc(0.0);
+                for (size_t i = 0; i < full; i += LANES) {
+                    for (size_t p = 0; p < 4; ++p) {
+                        acc.part[p] = vaddq_f64(acc.part[p], vmulq_f64(vld1q_f64(x + i + 2 * p), vld1q_f64(ys[j] + i + 2 * p)));
+                    }
+                }
+                double lanes[LANES];
+                acc.store(lanes);
+                out[j] = reduce_dot(lanes, x + full, ys[j] + full, count - full);
+            }
+        }
+    }
+#endif
+    
+    Isa detect() {
+#if defined(KERNELS_X86) && defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+        if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+#elif defined(KERNELS_NEON)
+        return Isa::Neon;
+#endif
+        return Isa::Scalar;
+    }
+    
+    std::atomic<Isa>& current() {
+        static std::atomic<Isa> isa{detect()};
+        return isa;
+    }
+}
+
+Isa detected_isa() {
+    static const Isa isa = detect();
+    return isa;
+}
+
+Isa active_isa() {
+    return current().load(std::memory_order_relaxed);
+}
+
+Isa set_isa(Isa isa) {
+    auto supported = [best = detected_isa()](Isa candidate) {
+        switch (candidate) {
+            case Isa::Scalar: return true;
+            case Isa::Neon:   return best == Isa::Neon;
+            case Isa::Avx2:   return best == Isa::Avx2 || best == Isa::Avx512;
+            case Isa::Avx512: return best == Isa::Avx512;
+        }
+        return false;
+    };
+    
+    while (!supported(isa)) {
+        isa = (isa == Isa::Avx512) ? Isa::Avx2 : Isa::Scalar;
+    }
+    current().store(isa, std::memory_order_relaxed);
+    return isa;
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Neon:   return "NEON";
+        case Isa::Avx2:   return "AVX2";
+        case Isa::Avx512: return "AVX-512";
+    }
+    return "unknown";
+}
+
+double sum(const double* values, size_t count) {
+    switch (active_isa()) {
+#ifdef KERNELS_X86
+        case Isa::Avx512: return avx512::sum(values, count);
+        case Isa::Avx2:   return avx2::sum(values, count);
+#endif
+#ifdef KERNELS_NEON
+        case Isa::Neon:   return neon::sum(values, count);
+#endif
+        default:          return scalar::sum(values, count);
+    }
+}
+
+double min(const double* values, size_t count) {
+    switch (active_isa()) {
+#ifdef KERNELS_X86
+        case Isa::Avx512: return avx512::min(values, count);
+        case Isa::Avx2:   return avx2::min(values, count);
+#endif
+#ifdef KERNELS_NEON
+        case Isa::Neon:   return neon::min(values, count);
+#endif
+        default:          return scalar::extreme(values, count, std::numeric_limits<double>::infinity(), lane_min);
+    }
+}
+
+double max(const double* values, size_t count) {
+    switch (active_isa()) {
+#ifdef KERNELS_X86
+        case Isa::Avx512: return avx512::max(values, count);
+        case Isa::Avx2:   return avx2::max(values, count);
+#endif
+#ifdef KERNELS_NEON
+        case Isa::Neon:   return neon::max(values, count);
+#endif
+        default:          return scalar::extreme(values, count, -std::numeric_limits<double>::infinity(), lane_max);
+    }
+}
+
+double sum_squared_deviations(const double* values, size_t count, double mean) {
+    switch (active_isa()) {
+#ifdef KERNELS_X86
+        case Isa::Avx512: return avx512::squares(values, count, mean);
+        case Isa::Avx2:   return avx2::squares(values, count, mean);
+#endif
+#ifdef KERNELS_NEON
+        case Isa::Neon:   return neon::squares(values, count, mean);
+#endif
+        default:          return scalar::squares(values, count, mean);
+    }
+}
+
+void dot_products(const double* x, const double* const* ys, size_t y_count, size_t count, double* out) {
+    switch (active_isa()) {
+#ifdef KERNELS_X86
+        case Isa::Avx512: return avx512::dots(x, ys, y_count, count, out);
+        case Isa::Avx2:   return avx2::dots(x, ys, y_count, count, out);
+#endif
+#ifdef KERNELS_NEON
+        case Isa::Neon:   return neon::dots(x, ys, y_count, count, out);
+#endif
+        default:          return scalar::dots(x, ys, y_count, count, out);
+    }
+}
+
+double variance(const double* values, size_t count) {
+    if (count == 0) {
+        return 0.0;
+    }
+    double mean = sum(values, count) / count;
+    return sum_squared_deviations(values, count, mean) / count;
+}
+
+int64_t sum(const int64_t* values, size_t count) {
+    int64_t result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result += values[i];
+    }
+    return result;
+}
+
+int64_t min(const int64_t* values, size_t count) {
+    int64_t result = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < count; ++i) {
+        result = std::min(result, values[i]);
+    }
+    return result;
+}
+
+int64_t max(const int64_t* values, size_t count) {
+    int64_t result = std::numeric_limits<int64_t>::min();
+    for (size_t i = 0; i < count; ++i) {
+        result = std::max(result, values[i]);
+    }
+    return result;
+}
+
+}
+} // namespace DataProcessing
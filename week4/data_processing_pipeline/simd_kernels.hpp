@@ -0,0 +1,52 @@
+/*
+ * Data Processing Pipeline - Aggregate Kernels
+ *
+ * Sum, min, max, squared-deviation and dot-product kernels over contiguous
+ * column buffers. Double kernels have AVX-512, AVX2 and NEON implementations
+ * selected once at runtime from the CPU's features; every implementation
+ * (including the scalar one) accumulates into the same eight interleaved
+ * lanes and reduces them in the same order, so all of them return
+ * bit-identical results. This relies on the compiler not contracting
+ * a * b + c into fused multiply-adds (the default under -std=c++17).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace DataProcessing {
+namespace Kernels {
+    enum class Isa { Scalar, Neon, Avx2, Avx512 };
+    
+    // Best instruction set supported by this CPU
+    Isa detected_isa();
+    
+    // Instruction set the kernels currently use; set_isa falls back to the
+    // best supported one at or below the request and returns what was chosen
+    Isa active_isa();
+    Isa set_isa(Isa isa);
+    const char* isa_name(Isa isa);
+    
+    // Elements are assigned to lane (index % 8); the tail after the last
+    // full group of eight is folded in sequentially after the lane reduction.
+    // Empty input gives 0 for sums, +inf for min and -inf for max.
+    double sum(const double* values, size_t count);
+    double min(const double* values, size_t count);
+    double max(const double* values, size_t count);
+    double sum_squared_deviations(const double* values, size_t count, double mean);
+    
+    // Population variance (two passes: mean, then squared deviations)
+    double variance(const double* values, size_t count);
+    
+    // out[j] = sum of x[i] * ys[j][i] over count elements, for every j below
+    // y_count; each product is summed into its lane like sum() does. The
+    // x86 versions take four ys at a time, sharing each load of x.
+    void dot_products(const double* x, const double* const* ys, size_t y_count, size_t count, double* out);
+    
+    // Integer kernels are plain loops the compiler vectorizes for the build target
+    int64_t sum(const int64_t* values, size_t count);
+    int64_t min(const int64_t* values, size_t count);
+    int64_t max(const int64_t* values, size_t count);
+}
+} // namespace DataProcessing
@@ -0,0 +1,397 @@
+/*
+ * Data Processing Pipeline - Sort Engine Implementation
+ *
+ * Key normalization, the LSD radix sort and the comparison sort described in
+ * sorting.hpp, and the serial DataSet sort entry points on top of them.
+ */
+
+#include "sorting.hpp"
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace DataProcessing {
+namespace Sorting {
+
+namespace {
+    // Below this many rows a comparison sort beats the radix passes
+    constexpr size_t radix_min_rows = 256;
+    
+    constexpr uint64_t sign_bit = uint64_t(1) << 63;
+    
+    // One key column, normalized (see sorting.hpp)
+    struct NormalizedKey {
+        enum class Kind { Fixed, Text, Values };
+        
+        Kind kind = Kind::Fixed;
+        bool ascending = true;
+        std::vector<uint64_t> keys;   // Fixed: whole key; Text: prefix; Values: unused
+        const std::pmr::vector<std::pmr::string>* strings = nullptr;
+        const std::pmr::vector<DataValue>* values = nullptr;
+    };
+    
+    uint64_t normalize(int64_t value) {
+        return static_cast<uint64_t>(value) ^ sign_bit;
+    }
+    
+    uint64_t normalize(double value) {
+        if (std::isnan(value)) return ~uint64_t(0);
+        if (value == 0.0) value = 0.0;   // -0.0 ties with 0.0, as it compares equal
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & sign_bit) ? ~bits : bits | sign_bit;
+    }
+    
+    // First eight bytes, big-endian: compares like std::string (unsigned bytes)
+    uint64_t normalize(std::string_view text) {
+        uint64_t prefix = 0;
+        size_t length = std::min<size_t>(text.size(), 8);
+        for (size_t i = 0; i < length; ++i) {
+            prefix |= uint64_t(static_cast<unsigned char>(text[i])) << (56 - 8 * i);
+        }
+        return prefix;
+    }
+    
+    // Run work(begin, end) over [0, rows) in runs of run_rows, on run_tasks
+    // when given
+    template <typename Work>
+    void for_runs(size_t rows, size_t run_rows, const RunTasks& run_tasks, Work work) {
+        if (!run_tasks || run_rows == 0 || rows <= run_rows) {
+            work(size_t(0), rows);
+            return;
+        }
+        std::vector<std::function<void()>> tasks;
+        for (size_t begin = 0; begin < rows; begin += run_rows) {
+            tasks.push_back([&work, begin, end = std::min(rows, begin + run_rows)] { work(begin, end); });
+        }
+        run_tasks(tasks);
+    }
+    
+    NormalizedKey normalize_column(const Column& column, bool ascending, size_t run_rows,
+                                   const RunTasks& run_tasks) {
+        NormalizedKey key;
+        key.ascending = ascending;
+        size_t rows = column.size();
+        uint64_t flip = ascending ? 0 : ~uint64_t(0);   // descending: reverse the order
+        
+        std::vector<uint32_t> ranks;
+        switch (column.type()) {
+            case ColumnType::String:
+                key.kind = NormalizedKey::Kind::Text;
+                key.strings = &column.strings();
+                break;
+            case ColumnType::Mixed:
+                key.kind = NormalizedKey::Kind::Values;
+                key.values = &column.values();
+                return key;
+            case ColumnType::Dictionary:
+                ranks = column.dictionary().dictionary->sort_ranks();
+                break;
+            default:
+                break;
+        }
+        
+        key.keys.resize(rows);
+        for_runs(rows, run_rows, run_tasks, [&](size_t begin, size_t end) {
+            uint64_t* out = key.keys.data();
+            switch (column.type()) {
+                case ColumnType::Int64: {
+                    const int64_t* cells = column.ints().data();
+                    for (size_t row = begin; row < end; ++row) out[row] = normalize(cells[row]) ^ flip;
+                    break;
+                }
+                case ColumnType::Double: {
+                    const double* cells = column.doubles().data();
+                    for (size_t row = begin; row < end; ++row) out[row] = normalize(cells[row]) ^ flip;
+                    break;
+                }
+                case ColumnType::Dictionary: {
+                    const uint32_t* codes = column.dictionary().codes.data();
+                    for (size_t row = begin; row < end; ++row) out[row] = uint64_t(ranks[codes[row]]) ^ flip;
+                    break;
+                }
+                case ColumnType::String: {
+                    const auto& cells = column.strings();
+                    for (size_t row = begin; row < end; ++row) out[row] = normalize(cells[row]) ^ flip;
+                    break;
+                }
+                case ColumnType::Mixed:
+                    break;
+            }
+        });
+        return key;
+    }
+    
+    std::vector<NormalizedKey> normalize_keys(const DataSet& dataset, const std::vector<SortKey>& keys,
+                                              size_t run_rows, const RunTasks& run_tasks) {
+        std::vector<NormalizedKey> normalized;
+        normalized.reserve(keys.size());
+        for (const SortKey& key : keys) {
+            normalized.push_back(normalize_column(dataset.column(key.column), key.ascending, run_rows, run_tasks));
+        }
+        return normalized;
+    }
+    
+    // Stable LSD radix sort of order by the Fixed keys, least significant
+    // key first. Each key's normalized values travel with the row numbers,
+    // so passes read sequentially; bytes that are equal in every row are
+    // skipped. Passes count and scatter per run, runs keeping their place
+    // within each digit, which keeps the sort stable.
+    void radix_sort(std::vector<size_t>& order, const std::vector<NormalizedKey>& keys,
+                    size_t run_rows, const RunTasks& run_tasks) {
+        size_t rows = order.size();
+        size_t runs = (!run_tasks || run_rows == 0) ? 1 : std::max<size_t>(1, (rows + run_rows - 1) / run_rows);
+        size_t run_size = (rows + runs - 1) / runs;
+        
+        std::vector<uint64_t> values(rows), values_next(rows);
+        std::vector<size_t> order_next(rows);
+        std::vector<std::array<size_t, 256>> counts(runs);
+        
+        for (auto key = keys.rbegin(); key != keys.rend(); ++key) {
+            for (size_t i = 0; i < rows; ++i) {
+                values[i] = key->keys[order[i]];
+            }
+            uint64_t varying = 0;
+            for (size_t i = 0; i < rows; ++i) {
+                varying |= values[i] ^ values[0];
+            }
+            
+            for (int shift = 0; shift < 64; shift += 8) {
+                if (((varying >> shift) & 0xFF) == 0) continue;
+                
+                std::vector<std::function<void()>> tasks;
+                for (size_t run = 0; run < runs; ++run) {
+                    tasks.push_back([&, run, shift] {
+                        auto& count = counts[run];
+                        count.fill(0);
+                        for (size_t i = run * run_size, end = std::min(rows, i + run_size); i < end; ++i) {
+                            ++count[(values[i] >> shift) & 0xFF];
+                        }
+                    });
+                }
+                runs > 1 ? run_tasks(tasks) : tasks.front()();
+                
+                // Turn counts into each run's first position per digit
+                size_t position = 0;
+                for (size_t digit = 0; digit < 256; ++digit) {
+                    for (size_t run = 0; run < runs; ++run) {
+                        size_t count = counts[run][digit];
+                        counts[run][digit] = position;
+                        position += count;
+                    }
+                }
+                
+                tasks.clear();
+                for (size_t run = 0; run < runs; ++run) {
+                    tasks.push_back([&, run, shift] {
+                        auto& next = counts[run];
+                        for (size_t i = run * run_size, end = std::min(rows, i + run_size); i < end; ++i) {
+                            size_t target = next[(values[i] >> shift) & 0xFF]++;
+                            values_next[target] = values[i];
+                            order_next[target] = order[i];
+                        }
+                    });
+                }
+                runs > 1 ? run_tasks(tasks) : tasks.front()();
+                
+                values.swap(values_next);
+                order.swap(order_next);
+            }
+        }
+    }
+    
+    // Row order by all keys; ties on a normalized key are broken by
+    // comparing the full strings (Text) or the values (Values)
+    struct RowLess {
+        const std::vector<NormalizedKey>& keys;
+        
+        bool operator()(size_t a, size_t b) const {
+            for (const NormalizedKey& key : keys) {
+                switch (key.kind) {
+                    case NormalizedKey::Kind::Fixed:
+                        if (key.keys[a] != key.keys[b]) return key.keys[a] < key.keys[b];
+                        break;
+                    case NormalizedKey::Kind::Text: {
+                        if (key.keys[a] != key.keys[b]) return key.keys[a] < key.keys[b];
+                        int compared = std::string_view((*key.strings)[a]).compare((*key.strings)[b]);
+                        if (compared != 0) return key.ascending ? compared < 0 : compared > 0;
+                        break;
+                    }
+                    case NormalizedKey::Kind::Values: {
+                        const DataValue& first = (*key.values)[a];
+                        const DataValue& second = (*key.values)[b];
+                        if (ValueOps::compare_less(first, second)) return key.ascending;
+                        if (ValueOps::compare_less(second, first)) return !key.ascending;
+                        break;
+                    }
+                }
+            }
+            return false;
+        }
+    };
+    
+    // Stable comparison sort by all keys
+    void comparison_sort(std::vector<size_t>& order, const std::vector<NormalizedKey>& keys,
+                         size_t run_rows, const RunTasks& run_tasks) {
+        RowLess less{keys};
+        
+        if (!run_tasks || run_rows == 0 || order.size() <= run_rows) {
+            std::stable_sort(order.begin(), order.end(), less);
+            return;
+        }
+        
+        // Sort runs concurrently, then merge neighbouring runs pairwise
+        // (std::merge prefers the left run on ties, which keeps it stable)
+        std::vector<size_t> bounds;
+        for (size_t begin = 0; begin < order.size(); begin += run_rows) {
+            bounds.push_back(begin);
+        }
+        bounds.push_back(order.size());
+        
+        std::vector<std::function<void()>> tasks;
+        for (size_t run = 0; run + 1 < bounds.size(); ++run) {
+            tasks.push_back([&, run] {
+                std::stable_sort(order.begin() + bounds[run], order.begin() + bounds[run + 1], less);
+            });
+        }
+        run_tasks(tasks);
+        
+        std::vector<size_t> merged(order.size());
+        while (bounds.size() > 2) {
+            tasks.clear();
+            std::vector<size_t> next_bounds;
+            for (size_t run = 0; run + 1 < bounds.size(); run += 2) {
+                size_t begin = bounds[run];
+                size_t middle = bounds[run + 1];
+                size_t end = run + 2 < bounds.size() ? bounds[run + 2] : middle;
+                next_bounds.push_back(begin);
+                tasks.push_back([&, begin, middle, end] {
+                    std::merge(order.begin() + begin, order.begin() + middle,
+                               order.begin() + middle, order.begin() + end,
+                               merged.begin() + begin, less);
+                });
+            }
+            next_bounds.push_back(order.size());
+            run_tasks(tasks);
+            
+            order.swap(merged);
+            bounds = std::move(next_bounds);
+        }
+    }
+}
+
+std::vector<size_t> order(const DataSet& dataset, const std::vector<SortKey>& keys,
+                          size_t run_rows, const RunTasks& run_tasks) {
+    std::vector<NormalizedKey> normalized = normalize_keys(dataset, keys, run_rows, run_tasks);
+    bool fixed = std::all_of(normalized.begin(), normalized.end(), [](const NormalizedKey& key) {
+        return key.kind == NormalizedKey::Kind::Fixed;
+    });
+    
+    std::vector<size_t> rows(dataset.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    if (keys.empty()) {
+        return rows;
+    }
+    if (fixed && rows.size() >= radix_min_rows) {
+        radix_sort(rows, normalized, run_rows, run_tasks);
+    } else {
+        comparison_sort(rows, normalized, run_rows, run_tasks);
+    }
+    return rows;
+}
+
+std::vector<size_t> top(const DataSet& dataset, const std::vector<SortKey>& keys, size_t k,
+                        size_t run_rows, const RunTasks& run_tasks) {
+    k = std::min(k, dataset.size());
+    if (keys.empty() || k == 0) {
+        std::vector<size_t> rows(k);
+        std::iota(rows.begin(), rows.end(), 0);
+        return rows;
+    }
+    
+    std::vector<NormalizedKey> normalized = normalize_keys(dataset, keys, run_rows, run_tasks);
+    RowLess less{normalized};
+    auto before = [&less](size_t a, size_t b) {   // stable: earlier rows win ties
+        return less(a, b) || (a < b && !less(b, a));
+    };
+    
+    // Max-heap of the k best rows offered so far; the worst sits on top
+    auto offer = [&before, k](std::vector<size_t>& heap, size_t row) {
+        if (heap.size() < k) {
+            heap.push_back(row);
+            std::push_heap(heap.begin(), heap.end(), before);
+        } else if (before(row, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), before);
+            heap.back() = row;
+            std::push_heap(heap.begin(), heap.end(), before);
+        }
+    };
+    
+    std::vector<size_t> best;
+    best.reserve(k);
+    if (!run_tasks || run_rows == 0 || dataset.size() <= run_rows) {
+        for (size_t row = 0; row < dataset.size(); ++row) {
+            offer(best, row);
+        }
+    } else {
+        std::vector<std::vector<size_t>> survivors((dataset.size() + run_rows - 1) / run_rows);
+        for_runs(dataset.size(), run_rows, run_tasks, [&](size_t begin, size_t end) {
+            auto& heap = survivors[begin / run_rows];
+            heap.reserve(std::min(k, end - begin));
+            for (size_t row = begin; row < end; ++row) {
+                offer(heap, row);
+            }
+        });
+        for (const auto& heap : survivors) {
+            for (size_t row : heap) {
+                offer(best, row);
+            }
+        }
+    }
+    std::sort_heap(best.begin(), best.end(), before);
+    return best;
+}
+
+int compare_cells(const Column& a, size_t row_a, const Column& b, size_t row_b) {
+    auto three_way = [](const auto& x, const auto& y) { return x < y ? -1 : (y < x ? 1 : 0); };
+    auto text = [](const Column& column, size_t row) -> std::string_view {
+        if (column.type() == ColumnType::Dictionary) return column.dictionary().at(row);
+        return column.strings()[row];
+    };
+    
+    if (a.is_text() && b.is_text()) {
+        int compared = text(a, row_a).compare(text(b, row_b));
+        return compared < 0 ? -1 : (compared > 0 ? 1 : 0);
+    }
+    if (a.type() == b.type() && a.type() == ColumnType::Int64) {
+        return three_way(a.ints()[row_a], b.ints()[row_b]);
+    }
+    if (a.type() == b.type() && a.type() == ColumnType::Double) {
+        return three_way(normalize(a.doubles()[row_a]), normalize(b.doubles()[row_b]));
+    }
+    DataValue first = a.get(row_a);
+    DataValue second = b.get(row_b);
+    if (ValueOps::compare_less(first, second)) return -1;
+    return ValueOps::compare_less(second, first) ? 1 : 0;
+}
+
+}
+
+// DataSet sorting (the ExecutionPolicy overloads are in parallel_execution.cpp)
+std::vector<size_t> DataSet::sort_order(const std::vector<SortKey>& keys) const {
+    return Sorting::order(*this, keys);
+}
+
+void DataSet::sort_by(const std::vector<SortKey>& keys) {
+    *this = take(sort_order(keys));
+}
+
+DataSet DataSet::top_k(const std::vector<SortKey>& keys, size_t k) const {
+    return take(Sorting::top(*this, keys, k));
+}
+
+void DataSet::sort_by_column(const std::string& column, bool ascending) {
+    sort_by({{column, ascending}});
+}
+
+} // namespace DataProcessing
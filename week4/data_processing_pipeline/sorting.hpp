@@ -0,0 +1,55 @@
+/*
+ * Data Processing Pipeline - Sort Engine
+ *
+ * The engine behind DataSet::sort_order, shared with the parallel executor
+ * so that a pipeline's sort runs on the executor's own pool. Sorting never
+ * moves rows: it computes a stable permutation over the key columns, which
+ * DataSet::take then applies with one gather per column.
+ *
+ * Every key cell is first normalized to a 64-bit unsigned integer whose
+ * order is the key's order (direction applied):
+ * - Int64: the value with its sign bit flipped
+ * - Double: the IEEE bits, flipped so that negatives order below positives;
+ *   -0.0 equals 0.0, and NaN sorts after +inf (first when descending)
+ * - Dictionary: the rank of the value among the dictionary's sorted values
+ * - String: the first eight bytes, big-endian and zero-padded; rows whose
+ *   prefixes tie are compared in full
+ * When every key is one of the first three, the rows are ordered by LSD
+ * radix sort, one counting pass per key byte that is not the same in every
+ * row. Otherwise (string or Mixed keys, or few rows) a stable comparison
+ * sort runs on the normalized keys.
+ *
+ * top() finds the first k rows of that order with a bounded heap instead,
+ * and compare_cells() orders cells of different DataSets the same way, for
+ * merging runs that were sorted separately (the external sort in
+ * streaming.cpp).
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+
+namespace DataProcessing {
+namespace Sorting {
+    // Runs every task to completion, possibly concurrently
+    using RunTasks = std::function<void(std::vector<std::function<void()>>& tasks)>;
+    
+    // Stable order of dataset's rows by keys. With run_tasks, the work is
+    // split into runs of run_rows rows: radix passes count and scatter per
+    // run, the comparison sort sorts runs and merges them pairwise.
+    std::vector<size_t> order(const DataSet& dataset, const std::vector<SortKey>& keys,
+                              size_t run_rows = 0, const RunTasks& run_tasks = nullptr);
+    
+    // The first k rows of order(dataset, keys), in that order. Rows are
+    // offered to a max-heap of the k best so far; with run_tasks every run
+    // keeps its own heap and the runs' survivors compete in a last one.
+    std::vector<size_t> top(const DataSet& dataset, const std::vector<SortKey>& keys, size_t k,
+                            size_t run_rows = 0, const RunTasks& run_tasks = nullptr);
+    
+    // Three-way comparison (-1, 0, 1) of two cells, possibly of different
+    // DataSets, in the ascending order order() sorts a key by. Text cells
+    // compare as strings whether dictionary-encoded or not; cells of
+    // otherwise different types compare with ValueOps::compare_less.
+    int compare_cells(const Column& a, size_t row_a, const Column& b, size_t row_b);
+}
+} // namespace DataProcessing
@@ -0,0 +1,556 @@
+/*
+ * Data Processing Pipeline - Multi-Column Statistics and Frequencies
+ *
+ * Statistics::CovarianceMatrix takes its rows in blocks. Each block's cells
+ * are gathered into one double buffer per column; the pairs of columns that
+ * are numeric throughout the block are centred on the block means and get
+ * their co-moments from Kernels::dot_products, one row of the matrix per
+ * call, and every other pair takes a scalar pass over its rows where both
+ * cells are numeric. The block's moments are merged into the running ones
+ * by Chan's formula, which is also how states of separate rows merge.
+ *
+ * frequency_count, CountMinSketch and HeavyHitters count typed cells
+ * without building a string per row: numbers are counted by value,
+ * dictionary columns by code (each distinct code then counts once, with
+ * its number of rows), and text by the characters in the column buffer.
+ */
+
+#include "data_processor.hpp"
+#include "simd_kernels.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace DataProcessing {
+
+namespace {
+    // Rows per block of CovarianceMatrix::update: the centred buffers of a
+    // few hundred columns stay in L2 while the dot products walk them
+    constexpr size_t BLOCK_ROWS = 256;
+    
+    // Gather rows [begin, begin + count) of a column as doubles, flagging the
+    // numeric cells; returns how many there are
+    size_t gather(const Column& column, size_t begin, size_t count, double* cells, uint8_t* numeric) {
+        switch (column.type()) {
+            case ColumnType::Int64: {
+                const int64_t* values = column.ints().data() + begin;
+                for (size_t i = 0; i < count; ++i) cells[i] = static_cast<double>(values[i]);
+                std::memset(numeric, 1, count);
+                return count;
+            }
+            case ColumnType::Double:
+                std::memcpy(cells, column.doubles().data() + begin, count * sizeof(double));
+                std::memset(numeric, 1, count);
+                return count;
+            case ColumnType::String:
+            case ColumnType::Dictionary:
+                std::memset(numeric, 0, count);
+                return 0;
+            case ColumnType::Mixed:
+                break;
+        }
+        size_t found = 0;
+        for (size_t i = 0; i < count; ++i) {
+            auto value = column.numeric_at(begin + i);
+            numeric[i] = value.has_value();
+            cells[i] = value.value_or(0.0);
+            found += numeric[i];
+        }
+        return found;
+    }
+    
+    uint64_t mix(uint64_t value) {
+        // splitmix64 finalizer
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+    
+    // Value hashes for the frequency sketches, tagged by type so that 5,
+    // 5.0 and "5" differ; -0.0 hashes as 0.0 and every NaN alike
+    constexpr uint64_t INT_TAG = 0x1ull;
+    constexpr uint64_t DOUBLE_TAG = 0x2ull << 60;
+    constexpr uint64_t TEXT_TAG = 0x3ull << 60;
+    constexpr uint64_t NULL_TAG = 0x4ull << 60;
+    
+    uint64_t hash_int(int64_t value) {
+        return mix(static_cast<uint64_t>(value) ^ INT_TAG);
+    }
+    
+    uint64_t hash_double(double value) {
+        if (value == 0.0) value = 0.0;
+        if (std::isnan(value)) value = std::numeric_limits<double>::quiet_NaN();
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return mix(bits ^ DOUBLE_TAG);
+    }
+    
+    uint64_t hash_text(std::string_view text) {
+        return mix(std::hash<std::string_view>()(text) ^ TEXT_TAG);
+    }
+    
+    uint64_t hash_value(const DataValue& value) {
+        switch (value.kind()) {
+            case DataValue::Kind::Int:    return hash_int(value.as_int());
+            case DataValue::Kind::Double: return hash_double(value.as_double());
+            case DataValue::Kind::String: return hash_text(value.as_string());
+            case DataValue::Kind::Null:   break;
+        }
+        return mix(NULL_TAG);
+    }
+    
+    // Call f(hash, count, make_value) for every cell with a count of 1, or
+    // once per code of a dictionary column with the code's number of rows;
+    // make_value() builds the DataValue of the cell
+    template<typename F>
+    void for_each_counted(const Column& column, F&& f) {
+        switch (column.type()) {
+            case ColumnType::Int64:
+                for (int64_t value : column.ints()) {
+                    f(hash_int(value), 1, [value] { return DataValue(value); });
+                }
+                break;
+            case ColumnType::Double:
+                for (double value : column.doubles()) {
+                    f(hash_double(value), 1, [value] { return DataValue(value); });
+                }
+                break;
+            case ColumnType::String:
+                for (const auto& value : column.strings()) {
+                    f(hash_text(value), 1, [&value] { return DataValue(std::string(value)); });
+                }
+                break;
+            case ColumnType::Dictionary: {
+                const DictionaryColumn& cells = column.dictionary();
+                std::vector<uint64_t> counts(cells.dictionary->size());
+                for (uint32_t code : cells.codes) {
+                    ++counts[code];
+                }
+                for (uint32_t code = 0; code < counts.size(); ++code) {
+                    if (counts[code] == 0) continue;
+                    const std::string& text = (*cells.dictionary)[code];
+                    f(hash_text(text), counts[code], [&text] { return DataValue(text); });
+                }
+                break;
+            }
+            case ColumnType::Mixed:
+                for (const auto& value : column.values()) {
+                    f(hash_value(value), 1, [&value] { return value; });
+                }
+                break;
+        }
+    }
+}
+
+// Statistics::CovarianceMatrix implementations
+void Statistics::CovarianceMatrix::Moments::merge(const Moments& other) {
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    double own = static_cast<double>(count);
+    double added = static_cast<double>(other.count);
+    double total = own + added;
+    double delta_x = other.mean_x - mean_x;
+    double delta_y = other.mean_y - mean_y;
+    double weight = own * added / total;
+    
+    mean_x += delta_x * added / total;
+    mean_y += delta_y * added / total;
+    m2_x += other.m2_x + delta_x * delta_x * weight;
+    m2_y += other.m2_y + delta_y * delta_y * weight;
+    c_xy += other.c_xy + delta_x * delta_y * weight;
+    count += other.count;
+}
+
+Statistics::CovarianceMatrix::CovarianceMatrix(std::vector<std::string> columns)
+    : columns_(std::move(columns)), pairs_(columns_.size() * (columns_.size() + 1) / 2) {}
+
+size_t Statistics::CovarianceMatrix::pair_index(size_t i, size_t j) const {
+    if (i > j) std::swap(i, j);
+    if (j >= columns_.size()) {
+        throw std::out_of_range("CovarianceMatrix column index out of range");
+    }
+    return i * columns_.size() - i * (i - 1) / 2 + (j - i);
+}
+
+void Statistics::CovarianceMatrix::update(const DataSet& rows) {
+    update(rows, 0, rows.size());
+}
+
+void Statistics::CovarianceMatrix::update(const DataSet& rows, size_t begin, size_t end) {
+    std::vector<const Column*> sources;
+    for (const auto& name : columns_) {
+        if (!rows.has_column(name)) {
+            throw std::invalid_argument("Column not found");
+        }
+        sources.push_back(&rows.column(name));
+    }
+    end = std::min(end, rows.size());
+    
+    size_t columns = columns_.size();
+    std::vector<double> cells(columns * BLOCK_ROWS);
+    std::vector<uint8_t> numeric(columns * BLOCK_ROWS);
+    std::vector<size_t> found(columns);
+    std::vector<double> means(columns), squares(columns), products(columns);
+    std::vector<size_t> complete;            // numeric throughout the block
+    std::vector<const double*> centred;      // their buffers
+    
+    for (size_t block = begin; block < end; block += BLOCK_ROWS) {
+        size_t count = std::min(BLOCK_ROWS, end - block);
+        for (size_t i = 0; i < columns; ++i) {
+            found[i] = gather(*sources[i], block, count, &cells[i * BLOCK_ROWS], &numeric[i * BLOCK_ROWS]);
+        }
+        
+        // Pairs with a column not numeric throughout: scalar two-pass over
+        // the rows where both cells are, on the raw values
+        for (size_t i = 0; i < columns; ++i) {
+            for (size_t j = i; j < columns; ++j) {
+                if (found[i] == 0 || found[j] == 0 || (found[i] == count && found[j] == count)) continue;
+                const double* x = &cells[i * BLOCK_ROWS];
+                const double* y = &cells[j * BLOCK_ROWS];
+                const uint8_t* x_numeric = &numeric[i * BLOCK_ROWS];
+                const uint8_t* y_numeric = &numeric[j * BLOCK_ROWS];
+                
+                Moments moments;
+                double sum_x = 0.0, sum_y = 0.0;
+                for (size_t row = 0; row < count; ++row) {
+                    if (x_numeric[row] && y_numeric[row]) {
+                        ++moments.count;
+                        sum_x += x[row];
+                        sum_y += y[row];
+                    }
+                }
+                if (moments.count == 0) continue;
+                moments.mean_x = sum_x / moments.count;
+                moments.mean_y = sum_y / moments.count;
+                for (size_t row = 0; row < count; ++row) {
+                    if (x_numeric[row] && y_numeric[row]) {
+                        double dx = x[row] - moments.mean_x;
+                        double dy = y[row] - moments.mean_y;
+                        moments.m2_x += dx * dx;
+                        moments.m2_y += dy * dy;
+                        moments.c_xy += dx * dy;
+                    }
+                }
+                pairs_[pair_index(i, j)].merge(moments);
+            }
+        }
+        
+        // Complete columns: centre on the block mean, then one row of
+        // co-moments per column from the dot-product kernel
+        complete.clear();
+        centred.clear();
+        for (size_t i = 0; i < columns; ++i) {
+            if (found[i] != count) continue;
+            double* x = &cells[i * BLOCK_ROWS];
+            means[i] = Kernels::sum(x, count) / count;
+            for (size_t row = 0; row < count; ++row) {
+                x[row] -= means[i];
+            }
+            squares[i] = Kernels::sum_squared_deviations(x, count, 0.0);
+            complete.push_back(i);
+            centred.push_back(x);
+        }
+        for (size_t k = 0; k < complete.size(); ++k) {
+            Kernels::dot_products(centred[k], centred.data() + k, complete.size() - k, count, products.data());
+            size_t i = complete[k];
+            for (size_t m = k; m < complete.size(); ++m) {
+                size_t j = complete[m];
+                Moments moments;
+                moments.count = count;
+                moments.mean_x = means[i];
+                moments.mean_y = means[j];
+                moments.m2_x = squares[i];
+                moments.m2_y = squares[j];
+                moments.c_xy = products[m - k];
+                pairs_[pair_index(i, j)].merge(moments);
+            }
+        }
+    }
+}
+
+void Statistics::CovarianceMatrix::merge(const CovarianceMatrix& other) {
+    if (other.columns_ != columns_) {
+        throw std::invalid_argument("CovarianceMatrix columns differ");
+    }
+    for (size_t i = 0; i < pairs_.size(); ++i) {
+        pairs_[i].merge(other.pairs_[i]);
+    }
+}
+
+double Statistics::CovarianceMatrix::covariance(size_t i, size_t j) const {
+    const Moments& moments = pairs_[pair_index(i, j)];
+    return moments.count ? moments.c_xy / moments.count : 0.0;
+}
+
+double Statistics::CovarianceMatrix::correlation(size_t i, size_t j) const {
+    const Moments& moments = pairs_[pair_index(i, j)];
+    if (moments.count < 2) {
+        return 0.0;
+    }
+    double denominator = std::sqrt(moments.m2_x * moments.m2_y);
+    return (denominator == 0.0) ? 0.0 : moments.c_xy / denominator;
+}
+
+Statistics::CovarianceMatrix Statistics::covariance_matrix(const DataSet& dataset,
+                                                           const std::vector<std::string>& columns) {
+    CovarianceMatrix matrix(columns);
+    matrix.update(dataset);
+    return matrix;
+}
+
+double Statistics::correlation(const DataSet& dataset, const std::string& col1, const std::string& col2) {
+    return covariance_matrix(dataset, {col1, col2}).correlation(0, 1);
+}
+
+std::unordered_map<std::string, size_t> Statistics::frequency_count(
+    const DataSet& dataset, const std::string& column) {
+    
+    const Column& values = dataset.column(column);
+    std::unordered_map<std::string, size_t> frequencies;
+    
+    // Distinct values that format alike (large integers, doubles equal to
+    // six decimals) add up under one key
+    switch (values.type()) {
+        case ColumnType::Int64: {
+            flat_hash_map<int64_t, size_t> counts;
+            for (int64_t value : values.ints()) ++counts[value];
+            for (const auto& [value, count] : counts) {
+                frequencies[ValueOps::to_string(value)] += count;
+            }
+            break;
+        }
+        case ColumnType::Double: {
+            flat_hash_map<uint64_t, size_t> counts;   // by bit pattern
+            for (double value : values.doubles()) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                ++counts[bits];
+            }
+            for (const auto& [bits, count] : counts) {
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                frequencies[ValueOps::to_string(value)] += count;
+            }
+            break;
+        }
+        case ColumnType::String: {
+            flat_hash_map<std::string_view, size_t> counts;   // views of the column's text
+            for (const auto& value : values.strings()) ++counts[value];
+            for (const auto& [text, count] : counts) {
+                frequencies.emplace(std::string(text), count);
+            }
+            break;
+        }
+        case ColumnType::Dictionary: {
+            const DictionaryColumn& cells = values.dictionary();
+            std::vector<size_t> counts(cells.dictionary->size());
+            for (uint32_t code : cells.codes) ++counts[code];
+            for (uint32_t code = 0; code < counts.size(); ++code) {
+                if (counts[code] > 0) frequencies.emplace((*cells.dictionary)[code], counts[code]);
+            }
+            break;
+        }
+        case ColumnType::Mixed:
+            for (const auto& value : values.values()) {
+                ++frequencies[ValueOps::to_string(value)];
+            }
+            break;
+    }
+    
+    return frequencies;
+}
+
+HeavyHitters Statistics::heavy_hitters(const DataSet& dataset, const std::string& column, size_t capacity) {
+    HeavyHitters hitters(capacity);
+    hitters.add(dataset.column(column));
+    return hitters;
+}
+
+// CountMinSketch implementations
+CountMinSketch::CountMinSketch(size_t width, size_t depth)
+    : width_(std::max<size_t>(width, 1)), depth_(std::max<size_t>(depth, 1)), counters_(width_ * depth_) {}
+
+void CountMinSketch::add_hash(uint64_t hash, uint64_t count) {
+    // Row r's counter from hash + r * step (double hashing)
+    uint64_t step = mix(hash) | 1;
+    for (size_t row = 0; row < depth_; ++row) {
+        counters_[row * width_ + (hash + row * step) % width_] += count;
+    }
+    total_ += count;
+}
+
+uint64_t CountMinSketch::estimate_hash(uint64_t hash) const {
+    uint64_t step = mix(hash) | 1;
+    uint64_t estimate = std::numeric_limits<uint64_t>::max();
+    for (size_t row = 0; row < depth_; ++row) {
+        estimate = std::min(estimate, counters_[row * width_ + (hash + row * step) % width_]);
+    }
+    return estimate;
+}
+
+void CountMinSketch::add(const Column& values) {
+    for_each_counted(values, [this](uint64_t hash, uint64_t count, const auto&) { add_hash(hash, count); });
+}
+
+void CountMinSketch::add(const DataValue& value, uint64_t count) {
+    add_hash(hash_value(value), count);
+}
+
+void CountMinSketch::merge(const CountMinSketch& other) {
+    if (other.width_ != width_ || other.depth_ != depth_) {
+        throw std::invalid_argument("CountMinSketch shapes differ");
+    }
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        counters_[i] += other.counters_[i];
+    }
+    total_ += other.total_;
+}
+
+uint64_t CountMinSketch::estimate(const DataValue& value) const {
+    return estimate_hash(hash_value(value));
+}
+
+// HeavyHitters implementations
+HeavyHitters::HeavyHitters(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+// Count a value; returns where to store it when it takes a counter (new
+// or taken over), nullptr when it already had one
+DataValue* HeavyHitters::offer(uint64_t hash, uint64_t count) {
+    total_ += count;
+    auto found = index_.find(hash);
+    if (found != index_.end()) {
+        size_t entry = found->second;
+        entries_[entry].count += count;
+        sift_down(heap_slot_[entry]);
+        return nullptr;
+    }
+    
+    if (entries_.size() < capacity_) {
+        size_t entry = entries_.size();
+        entries_.push_back({DataValue(), count, 0});
+        hashes_.push_back(hash);
+        heap_slot_.push_back(heap_.size());
+        heap_.push_back(entry);
+        index_[hash] = entry;
+        sift_up(heap_.size() - 1);
+        return &entries_[entry].value;
+    }
+    
+    // Take over the smallest counter
+    size_t entry = heap_[0];
+    index_.erase(hashes_[entry]);
+    entries_[entry].error = entries_[entry].count;
+    entries_[entry].count += count;
+    hashes_[entry] = hash;
+    index_[hash] = entry;
+    sift_down(0);
+    return &entries_[entry].value;
+}
+
+void HeavyHitters::sift_up(size_t slot) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (entries_[heap_[parent]].count <= entries_[heap_[slot]].count) break;
+        std::swap(heap_[parent], heap_[slot]);
+        heap_slot_[heap_[parent]] = parent;
+        heap_slot_[heap_[slot]] = slot;
+        slot = parent;
+    }
+}
+
+void HeavyHitters::sift_down(size_t slot) {
+    while (true) {
+        size_t smallest = slot;
+        for (size_t child = 2 * slot + 1; child <= 2 * slot + 2 && child < heap_.size(); ++child) {
+            if (entries_[heap_[child]].count < entries_[heap_[smallest]].count) smallest = child;
+        }
+        if (smallest == slot) break;
+        std::swap(heap_[smallest], heap_[slot]);
+        heap_slot_[heap_[smallest]] = smallest;
+        heap_slot_[heap_[slot]] = slot;
+        slot = smallest;
+    }
+}
+
+void HeavyHitters::rebuild() {
+    heap_.resize(entries_.size());
+    heap_slot_.resize(entries_.size());
+    index_.clear();
+    for (size_t entry = 0; entry < entries_.size(); ++entry) {
+        heap_[entry] = heap_slot_[entry] = entry;
+        index_[hashes_[entry]] = entry;
+    }
+    for (size_t slot = heap_.size() / 2; slot-- > 0;) {
+        sift_down(slot);
+    }
+}
+
+void HeavyHitters::add(const Column& values) {
+    for_each_counted(values, [this](uint64_t hash, uint64_t count, const auto& make_value) {
+        if (DataValue* value = offer(hash, count)) *value = make_value();
+    });
+}
+
+void HeavyHitters::add(const DataValue& value, uint64_t count) {
+    if (DataValue* slot = offer(hash_value(value), count)) *slot = value;
+}
+
+void HeavyHitters::merge(const HeavyHitters& other) {
+    // A value missing from a full summary was seen there at most as often
+    // as its smallest counter
+    uint64_t own_floor = entries_.size() == capacity_ ? entries_[heap_[0]].count : 0;
+    uint64_t other_floor = other.entries_.size() == other.capacity_ ? other.entries_[other.heap_[0]].count : 0;
+    
+    std::vector<Entry> merged;
+    std::vector<uint64_t> merged_hashes;
+    for (size_t entry = 0; entry < entries_.size(); ++entry) {
+        const Entry& own = entries_[entry];
+        merged.push_back({own.value, own.count + other_floor, own.error + other_floor});
+        merged_hashes.push_back(hashes_[entry]);
+    }
+    for (size_t entry = 0; entry < other.entries_.size(); ++entry) {
+        const Entry& theirs = other.entries_[entry];
+        auto found = index_.find(other.hashes_[entry]);
+        if (found != index_.end()) {
+            Entry& combined = merged[found->second];
+            combined.count += theirs.count - other_floor;
+            combined.error += theirs.error - other_floor;
+        } else {
+            merged.push_back({theirs.value, theirs.count + own_floor, theirs.error + own_floor});
+            merged_hashes.push_back(other.hashes_[entry]);
+        }
+    }
+    
+    // Keep the largest counters
+    std::vector<size_t> order(merged.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&merged](size_t a, size_t b) { return merged[a].count > merged[b].count; });
+    order.resize(std::min(order.size(), capacity_));
+    
+    entries_.clear();
+    hashes_.clear();
+    for (size_t entry : order) {
+        entries_.push_back(std::move(merged[entry]));
+        hashes_.push_back(merged_hashes[entry]);
+    }
+    total_ += other.total_;
+    rebuild();
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::top(size_t k) const {
+    std::vector<Entry> result(entries_);
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    result.resize(std::min(result.size(), k));
+    return result;
+}
+
+} // namespace DataProcessing
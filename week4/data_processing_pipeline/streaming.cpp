@@ -0,0 +1,568 @@
+/*
+ * Data Processing Pipeline - Streaming Execution Implementation
+ *
+ * Implements batch sources, sinks, the spill file used by the external sort,
+ * and Pipeline::execute_streaming.
+ */
+
+#include "streaming.hpp"
+#include "sorting.hpp"
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
+#include <unistd.h>
+
+namespace DataProcessing {
+
+// CsvBatchReader implementations
+CsvBatchReader::CsvBatchReader(const std::string& filename) : file_(filename) {
+    remaining_ = file_.view();
+    columns_ = Csv::read_header(remaining_);
+    types_ = Csv::infer_types(remaining_, columns_.size());
+}
+
+bool CsvBatchReader::next_batch(DataSet& batch, size_t max_rows, Column::Allocator alloc) {
+    if (remaining_.empty()) {
+        return false;
+    }
+    
+    // Find the end of the next max_rows lines
+    std::string_view rest = remaining_;
+    for (size_t rows = 0; rows < max_rows && !rest.empty(); ++rows) {
+        Csv::next_line(rest);
+    }
+    std::string_view chunk = remaining_.substr(0, remaining_.size() - rest.size());
+    remaining_ = rest;
+    
+    batch = DataSet(columns_, Csv::parse_rows(chunk, types_, alloc));
+    return true;
+}
+
+// DataSetSource implementations
+bool DataSetSource::next_batch(DataSet& batch, size_t max_rows, Column::Allocator alloc) {
+    if (position_ >= dataset_.size()) {
+        return false;
+    }
+    
+    batch = dataset_.slice(position_, position_ + max_rows, alloc);
+    position_ += batch.size();
+    return true;
+}
+
+// CsvSink implementations
+CsvSink::CsvSink(const std::string& filename) : file_(filename), filename_(filename) {
+    if (!file_.is_open()) {
+        throw std::runtime_error("Cannot create file: " + filename);
+    }
+}
+
+void CsvSink::consume(const DataSet& batch) {
+    batch.write_csv(file_, !header_written_);
+    header_written_ = true;
+    rows_written_ += batch.size();
+}
+
+void CsvSink::finish() {
+    file_.flush();
+    if (!file_) {
+        throw std::runtime_error("Failed writing file: " + filename_);
+    }
+}
+
+// CollectSink implementations
+void CollectSink::consume(const DataSet& batch) {
+    result_.append(batch);
+}
+
+// NumericSummarySink implementations
+std::string NumericSummarySink::Summary::to_string() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "Count: " << count << ", Sum: " << sum << ", Mean: " << mean()
+        << ", Min: " << (count ? min_val : 0.0) << ", Max: " << (count ? max_val : 0.0);
+    return oss.str();
+}
+
+void NumericSummarySink::consume(const DataSet& batch) {
+    const Column& values = batch.column(column_);
+    for (size_t row = 0; row < values.size(); ++row) {
+        if (auto value = values.numeric_at(row)) {
+            ++summary_.count;
+            summary_.sum += *value;
+            summary_.min_val = std::min(summary_.min_val, *value);
+            summary_.max_val = std::max(summary_.max_val, *value);
+        }
+    }
+}
+
+// SpillFile implementations
+namespace {
+    // Spill layout, repeated per batch:
+    //   u64 rows, u64 columns, then per column: u8 ColumnType + payload
+    //   Int64/Double: raw values; String: (u64 length, bytes) per cell;
+    //   Dictionary: u64 entries, each as a String cell, then u32 code per cell;
+    //   Mixed: per cell u8 variant index followed by that alternative
+    template<typename T>
+    void write_pod(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    
+    template<typename T>
+    bool read_pod(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+    
+    void write_string(std::ostream& out, std::string_view value) {
+        write_pod<uint64_t>(out, value.size());
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+    
+    std::string read_string(std::istream& in) {
+        uint64_t length = 0;
+        read_pod(in, length);
+        std::string value(length, '\0');
+        in.read(value.data(), static_cast<std::streamsize>(length));
+        return value;
+    }
+    
+    void write_column(std::ostream& out, const Column& column) {
+        write_pod<uint8_t>(out, static_cast<uint8_t>(column.type()));
+        std::visit([&out](const auto& values) {
+            using V = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<V, DictionaryColumn>) {
+                write_pod<uint64_t>(out, values.dictionary->size());
+                for (size_t code = 0; code < values.dictionary->size(); ++code) {
+                    write_string(out, (*values.dictionary)[static_cast<uint32_t>(code)]);
+                }
+                out.write(reinterpret_cast<const char*>(values.codes.data()),
+                          static_cast<std::streamsize>(values.codes.size() * sizeof(uint32_t)));
+            } else if constexpr (std::is_arithmetic_v<typename V::value_type>) {
+                out.write(reinterpret_cast<const char*>(values.data()),
+                          static_cast<std::streamsize>(values.size() * sizeof(typename V::value_type)));
+            } else if constexpr (std::is_same_v<typename V::value_type, std::pmr::string>) {
+                for (const auto& value : values) write_string(out, value);
+            } else {
+                for (const auto& value : values) {
+                    write_pod<uint8_t>(out, static_cast<uint8_t>(value.index()));
+                    value.visit([&out](auto cell) {
+                        using T = decltype(cell);
+                        if constexpr (std::is_same_v<T, std::string_view>) {
+                            write_string(out, cell);
+                        } else if constexpr (std::is_arithmetic_v<T>) {
+                            write_pod(out, cell);
+                        }
+                    });
+                }
+            }
+        }, column.storage());
+    }
+    
+    Column read_column(std::istream& in, size_t rows) {
+        uint8_t tag = 0;
+        read_pod(in, tag);
+        Column column(static_cast<ColumnType>(tag));
+        column.reserve(rows);
+        
+        std::vector<std::string> dictionary;
+        if (static_cast<ColumnType>(tag) == ColumnType::Dictionary) {
+            uint64_t entries = 0;
+            read_pod(in, entries);
+            for (uint64_t code = 0; code < entries; ++code) {
+                dictionary.push_back(read_string(in));
+            }
+        }
+        
+        for (size_t row = 0; row < rows; ++row) {
+            switch (static_cast<ColumnType>(tag)) {
+                case ColumnType::Int64: {
+                    int64_t value = 0;
+                    read_pod(in, value);
+                    column.append_int64(value);
+                    break;
+                }
+                case ColumnType::Double: {
+                    double value = 0.0;
+                    read_pod(in, value);
+                    column.append_double(value);
+                    break;
+                }
+                case ColumnType::String:
+                    column.append_string(read_string(in));
+                    break;
+                case ColumnType::Dictionary: {
+                    uint32_t code = 0;
+                    read_pod(in, code);
+                    column.append_string(dictionary.at(code));
+                    break;
+                }
+                case ColumnType::Mixed: {
+                    uint8_t index = 0;
+                    read_pod(in, index);
+                    if (index == 0) {
+                        int64_t value = 0;
+                        read_pod(in, value);
+                        column.append(value);
+                    } else if (index == 1) {
+                        double value = 0.0;
+                        read_pod(in, value);
+                        column.append(value);
+                    } else if (index == 2) {
+                        column.append(read_string(in));
+                    } else {
+                        column.append(DataValue());
+                    }
+                    break;
+                }
+            }
+        }
+        return column;
+    }
+    
+    std::string make_spill_path(const std::string& directory) {
+        static std::atomic<size_t> counter{0};
+        std::filesystem::path base = directory.empty()
+            ? std::filesystem::temp_directory_path() : std::filesystem::path(directory);
+        return (base / ("pipeline-spill-" + std::to_string(::getpid()) + "-" +
+                        std::to_string(counter++) + ".bin")).string();
+    }
+}
+
+SpillFile::SpillFile(const std::string& directory)
+    : path_(make_spill_path(directory)), out_(path_, std::ios::binary | std::ios::trunc) {
+    if (!out_.is_open()) {
+        throw std::runtime_error("Cannot create spill file: " + path_);
+    }
+}
+
+SpillFile::~SpillFile() {
+    out_.close();
+    std::error_code ignored;
+    std::filesystem::remove(path_, ignored);
+}
+
+void SpillFile::write(const DataSet& batch) {
+    if (rows_ == 0 && columns_.empty()) {
+        columns_ = batch.get_columns();
+    } else if (batch.get_columns() != columns_) {
+        throw std::invalid_argument("Spilled batches must share the same columns");
+    }
+    
+    write_pod<uint64_t>(out_, batch.size());
+    write_pod<uint64_t>(out_, columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        write_column(out_, batch.column_at(i));
+    }
+    rows_ += batch.size();
+}
+
+DataSet SpillFile::read_all() {
+    Reader batches = reader();
+    DataSet result(columns_, std::vector<Column>(columns_.size()));
+    DataSet batch;
+    while (batches.next(batch)) {
+        result.append(std::move(batch));
+    }
+    return result;
+}
+
+SpillFile::Reader SpillFile::reader() {
+    out_.flush();
+    if (!out_) {
+        throw std::runtime_error("Failed writing spill file: " + path_);
+    }
+    return Reader(path_, columns_);
+}
+
+SpillFile::Reader::Reader(const std::string& path, std::vector<std::string> columns)
+    : in_(path, std::ios::binary), columns_(std::move(columns)) {
+    if (!in_.is_open()) {
+        throw std::runtime_error("Cannot read spill file: " + path);
+    }
+}
+
+bool SpillFile::Reader::next(DataSet& batch) {
+    uint64_t rows = 0, column_count = 0;
+    if (!read_pod(in_, rows) || !read_pod(in_, column_count)) {
+        return false;
+    }
+    std::vector<Column> data;
+    data.reserve(column_count);
+    for (size_t i = 0; i < column_count; ++i) {
+        data.push_back(read_column(in_, rows));
+    }
+    batch = DataSet(columns_, std::move(data));
+    return true;
+}
+
+namespace {
+    // Rough footprint of a batch's cells, for the sort memory budget
+    size_t approximate_bytes(const DataSet& batch) {
+        size_t bytes = 0;
+        for (size_t i = 0; i < batch.get_columns().size(); ++i) {
+            const Column& column = batch.column_at(i);
+            switch (column.type()) {
+                case ColumnType::Int64:
+                case ColumnType::Double:
+                    bytes += column.size() * sizeof(int64_t);
+                    break;
+                case ColumnType::Dictionary:
+                    bytes += column.size() * sizeof(uint32_t);
+                    break;
+                case ColumnType::String:
+                    for (const auto& cell : column.strings()) {
+                        bytes += sizeof(cell) + cell.size();
+                    }
+                    break;
+                case ColumnType::Mixed:
+                    bytes += column.size() * sizeof(DataValue);
+                    break;
+            }
+        }
+        return bytes;
+    }
+    
+    // k-way merge of sorted runs, produced as batches. Each run has one
+    // batch resident; a min-heap of runs, ordered by their current row,
+    // picks the next row. The picks of a run between two batch loads form
+    // one slice (a single take from its batch), and the output batch is
+    // one more take from the concatenated slices, putting picks in order.
+    class RunMerger : public BatchSource {
+    private:
+        struct Run {
+            SpillFile::Reader reader;
+            DataSet batch;
+            std::vector<const Column*> keys;
+            size_t row = 0;
+            std::vector<size_t> picked;   // rows of batch for the current slice
+            size_t slice = 0;
+        };
+        
+        std::vector<SortKey> keys_;
+        std::vector<Run> runs_;
+        std::vector<size_t> heap_;   // runs with rows left
+        
+        bool load(Run& run) {
+            while (run.reader.next(run.batch)) {
+                if (run.batch.empty()) continue;
+                run.keys.clear();
+                for (const SortKey& key : keys_) {
+                    run.keys.push_back(&run.batch.column(key.column));
+                }
+                run.row = 0;
+                return true;
+            }
+            return false;
+        }
+        
+        // Heap order: true when run a's row comes after run b's (ties go
+        // to the earlier run, which keeps the merge stable)
+        bool after(size_t a, size_t b) const {
+            const Run& first = runs_[a];
+            const Run& second = runs_[b];
+            for (size_t i = 0; i < keys_.size(); ++i) {
+                int compared = Sorting::compare_cells(*first.keys[i], first.row, *second.keys[i], second.row);
+                if (compared != 0) return keys_[i].ascending ? compared > 0 : compared < 0;
+            }
+            return a > b;
+        }
+        
+    public:
+        RunMerger(std::vector<SortKey> keys, std::vector<std::unique_ptr<SpillFile>>& files)
+            : keys_(std::move(keys)) {
+            auto after = [this](size_t a, size_t b) { return this->after(a, b); };
+            for (auto& file : files) {
+                runs_.push_back(Run{file->reader(), DataSet(), {}, 0, {}, 0});
+                if (load(runs_.back())) {
+                    heap_.push_back(runs_.size() - 1);
+                    std::push_heap(heap_.begin(), heap_.end(), after);
+                }
+            }
+        }
+        
+        using BatchSource::next_batch;
+        bool next_batch(DataSet& batch, size_t max_rows, Column::Allocator alloc) override {
+            if (heap_.empty()) {
+                return false;
+            }
+            auto after = [this](size_t a, size_t b) { return this->after(a, b); };
+            
+            std::vector<DataSet> slices;
+            std::vector<std::pair<size_t, size_t>> picks;   // (slice, position in slice)
+            auto flush = [&slices](Run& run) {
+                if (!run.picked.empty()) {
+                    slices[run.slice] = run.batch.take(run.picked);
+                    run.picked.clear();
+                }
+            };
+            
+            while (picks.size() < max_rows && !heap_.empty()) {
+                std::pop_heap(heap_.begin(), heap_.end(), after);
+                Run& run = runs_[heap_.back()];
+                if (run.picked.empty()) {
+                    run.slice = slices.size();
+                    slices.emplace_back();
+                }
+                picks.emplace_back(run.slice, run.picked.size());
+                run.picked.push_back(run.row);
+                
+                if (++run.row == run.batch.size()) {
+                    flush(run);
+                    if (!load(run)) {
+                        heap_.pop_back();
+                        continue;
+                    }
+                }
+                std::push_heap(heap_.begin(), heap_.end(), after);
+            }
+            for (Run& run : runs_) {
+                flush(run);
+            }
+            
+            if (slices.size() == 1) {
+                batch = slices.front().slice(0, picks.size(), alloc);
+                return true;
+            }
+            std::vector<size_t> offsets;
+            DataSet merged;
+            for (DataSet& slice : slices) {
+                offsets.push_back(merged.size());
+                merged.append(std::move(slice));
+            }
+            std::vector<size_t> order;
+            order.reserve(picks.size());
+            for (const auto& [slice, position] : picks) {
+                order.push_back(offsets[slice] + position);
+            }
+            batch = merged.take(order, alloc);
+            return true;
+        }
+    };
+}
+
+// Pipeline streaming execution
+void Pipeline::execute_streaming(BatchSource& source, BatchSink& sink) const {
+    execute_streaming(source, sink, StreamingOptions());
+}
+
+void Pipeline::execute_streaming(BatchSource& source, BatchSink& sink,
+                                 const StreamingOptions& options) const {
+    Tracing::Span span("Pipeline::execute_streaming");
+    
+    run_streaming(source, plan(), 0, sink, options);
+    sink.finish();
+}
+
+void Pipeline::run_streaming(BatchSource& source, const std::vector<PlanStep>& steps,
+                             size_t first_step, BatchSink& sink,
+                             const StreamingOptions& options) const {
+    size_t batch_rows = std::max<size_t>(options.batch_rows, 1);
+    
+    // Fused passes and projections up to the next blocking stage run one
+    // batch at a time
+    size_t barrier = first_step;
+    while (barrier < steps.size() && !steps[barrier].blocking) {
+        ++barrier;
+    }
+    size_t last = std::min(barrier + 1, steps.size());
+    std::vector<const char*> step_names;
+    for (const auto& step : steps) {
+        step_names.push_back(step.trace_name());
+    }
+    
+    // Each batch lives in the arena until the next one starts: the previous
+    // batch is dropped first, then the arena is rewound for the new one
+    MonotonicArena arena;
+    Column::Allocator alloc = options.batch_arena ? Column::Allocator(&arena) : Column::Allocator();
+    DataSet batch;
+    auto next = [&] {
+        batch = DataSet();
+        arena.reset();
+        return source.next_batch(batch, batch_rows, alloc);
+    };
+    auto process = [&] {
+        for (size_t i = first_step; i < last; ++i) {
+            if (!steps[i].fused.empty() || steps[i].projection) {
+                Tracing::Span batch_span(step_names[i], "batch");
+                batch_span.add_bytes(batch.cell_bytes());
+                batch = run_fused(batch, steps[i], 0, batch.size(), alloc);
+                batch_span.set_rows(batch.size());
+            }
+        }
+    };
+    
+    if (barrier == steps.size()) {
+        while (next()) {
+            process();
+            sink.consume(batch);
+        }
+        return;
+    }
+    
+    const Stage& blocking = *steps[barrier].blocking;
+    if (blocking.kind == Stage::Kind::TopK) {
+        // Only the best rows so far are kept: each batch's own top rows
+        // (copied out of the arena) compete with them
+        DataSet best;
+        while (next()) {
+            process();
+            best.append(batch.top_k(blocking.keys, blocking.limit));
+            best = best.top_k(blocking.keys, blocking.limit);
+        }
+        batch = DataSet();
+        arena.release();
+        
+        if (best.get_columns().empty()) {
+            return;   // the source produced no batches at all
+        }
+        DataSetSource rest(std::move(best));
+        run_streaming(rest, steps, barrier + 1, sink, options);
+        return;
+    }
+    
+    // Sort: buffer rows up to the memory budget. A buffer that fills up is
+    // sorted and spilled as a run; the runs are merged at the end.
+    DataSet buffer;
+    size_t buffered_bytes = 0;
+    std::vector<std::unique_ptr<SpillFile>> runs;
+    auto spill_run = [&] {
+        Tracing::Span spill_span("sort_by: spill a run", "spill");
+        spill_span.set_rows(buffer.size());
+        spill_span.add_bytes(buffered_bytes);
+        buffer.sort_by(blocking.keys);
+        runs.push_back(std::make_unique<SpillFile>(options.spill_directory));
+        for (size_t begin = 0; begin < buffer.size(); begin += batch_rows) {
+            runs.back()->write(buffer.slice(begin, begin + batch_rows));
+        }
+        buffer = DataSet();
+        buffered_bytes = 0;
+    };
+    while (next()) {
+        process();
+        buffered_bytes += approximate_bytes(batch);
+        buffer.append(batch);   // a copy, off the arena
+        if (buffered_bytes >= options.sort_memory_bytes) {
+            spill_run();
+        }
+    }
+    batch = DataSet();
+    arena.release();
+    
+    if (runs.empty()) {
+        if (buffer.get_columns().empty()) {
+            return;   // the source produced no batches at all
+        }
+        run_blocking(buffer, blocking);
+        DataSetSource rest(std::move(buffer));
+        run_streaming(rest, steps, barrier + 1, sink, options);
+        return;
+    }
+    if (!buffer.empty()) {
+        spill_run();
+    }
+    buffer = DataSet();
+    
+    RunMerger merged(blocking.keys, runs);
+    run_streaming(merged, steps, barrier + 1, sink, options);
+}
+
+} // namespace DataProcessing
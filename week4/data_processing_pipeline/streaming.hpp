@@ -0,0 +1,179 @@
+/*
+ * Data Processing Pipeline - Streaming Execution
+ *
+ * Bounded-memory execution of a Pipeline: a BatchSource produces DataSet
+ * batches of at most StreamingOptions::batch_rows rows, every row-local stage
+ * (filter, transform, add_column, select) runs on one batch at a time in the
+ * pipeline's fused passes and the result is pushed into a BatchSink.
+ * Blocking stages need their whole input:
+ * - top_k keeps only the best k rows seen so far, merging each batch's own
+ *   top k into them
+ * - sort_by buffers up to StreamingOptions::sort_memory_bytes of rows and
+ *   sorts them in memory; past that budget every full buffer is sorted and
+ *   spilled to a temporary file as a run, and the runs are merged batch by
+ *   batch (an external merge sort), so only one batch per run is resident
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+#include "csv_reader.hpp"
+#include <limits>
+
+namespace DataProcessing {
+
+// Tuning knobs for Pipeline::execute_streaming
+struct StreamingOptions {
+    size_t batch_rows = 64 * 1024;
+    std::string spill_directory;   // empty: std::filesystem::temp_directory_path()
+    
+    // Approximate bytes of rows a sort_by stage holds before spilling a run
+    size_t sort_memory_bytes = size_t(256) << 20;
+    
+    // Allocate each batch, and every column derived from it, from one
+    // MonotonicArena that is rewound when the next batch starts. Sinks see
+    // a batch only until consume() returns and must copy what they keep.
+    bool batch_arena = true;
+};
+
+// Produces consecutive batches of rows
+class BatchSource {
+public:
+    virtual ~BatchSource() = default;
+    
+    // Replace batch with up to max_rows new rows, their columns allocated
+    // with alloc; false once exhausted
+    virtual bool next_batch(DataSet& batch, size_t max_rows, Column::Allocator alloc) = 0;
+    
+    bool next_batch(DataSet& batch, size_t max_rows) { return next_batch(batch, max_rows, {}); }
+};
+
+// Consumes the batches coming out of a streaming pipeline
+class BatchSink {
+public:
+    virtual ~BatchSink() = default;
+    
+    virtual void consume(const DataSet& batch) = 0;
+    virtual void finish() {}
+};
+
+// Streams rows out of a CSV file without materializing the whole file
+class CsvBatchReader : public BatchSource {
+private:
+    MappedFile file_;
+    std::string_view remaining_;
+    std::vector<std::string> columns_;
+    std::vector<ColumnType> types_;
+    
+public:
+    explicit CsvBatchReader(const std::string& filename);
+    
+    using BatchSource::next_batch;
+    bool next_batch(DataSet& batch, size_t max_rows, Column::Allocator alloc) override;
+    const std::vector<std::string>& get_columns() const { return columns_; }
+};
+
+// Streams an in-memory DataSet in slices
+class DataSetSource : public BatchSource {
+private:
+    DataSet dataset_;
+    size_t position_ = 0;
+    
+public:
+    explicit DataSetSource(DataSet dataset) : dataset_(std::move(dataset)) {}
+    
+    using BatchSource::next_batch;
+    bool next_batch(DataSet& batch, size_t max_rows, Column::Allocator alloc) override;
+};
+
+// Appends every batch to a CSV file (same format as DataSet::save_to_csv)
+class CsvSink : public BatchSink {
+private:
+    std::ofstream file_;
+    std::string filename_;
+    bool header_written_ = false;
+    size_t rows_written_ = 0;
+    
+public:
+    explicit CsvSink(const std::string& filename);
+    
+    void consume(const DataSet& batch) override;
+    void finish() override;
+    size_t rows_written() const { return rows_written_; }
+};
+
+// Concatenates all batches into one DataSet (for results known to be small)
+class CollectSink : public BatchSink {
+private:
+    DataSet result_;
+    
+public:
+    void consume(const DataSet& batch) override;
+    const DataSet& result() const { return result_; }
+    DataSet take_result() { return std::move(result_); }
+};
+
+// Running count/sum/mean/min/max of one numeric column, in O(1) memory
+class NumericSummarySink : public BatchSink {
+public:
+    struct Summary {
+        size_t count = 0;
+        double sum = 0.0;
+        double min_val = std::numeric_limits<double>::infinity();
+        double max_val = -std::numeric_limits<double>::infinity();
+        
+        double mean() const { return count ? sum / count : 0.0; }
+        std::string to_string() const;
+    };
+    
+private:
+    std::string column_;
+    Summary summary_;
+    
+public:
+    explicit NumericSummarySink(std::string column) : column_(std::move(column)) {}
+    
+    void consume(const DataSet& batch) override;
+    const Summary& summary() const { return summary_; }
+};
+
+// Temporary file holding batches in a lossless binary column layout.
+// The file is removed when the SpillFile is destroyed.
+class SpillFile {
+private:
+    std::string path_;
+    std::ofstream out_;
+    std::vector<std::string> columns_;
+    size_t rows_ = 0;
+    
+public:
+    explicit SpillFile(const std::string& directory = "");
+    ~SpillFile();
+    
+    // Reads the batches back one at a time, as they were written
+    class Reader {
+    private:
+        std::ifstream in_;
+        std::vector<std::string> columns_;
+        
+    public:
+        Reader(const std::string& path, std::vector<std::string> columns);
+        
+        bool next(DataSet& batch);
+    };
+    
+    void write(const DataSet& batch);
+    DataSet read_all();
+    Reader reader();   // flushes what was written so far
+    
+    size_t rows() const { return rows_; }
+    const std::string& path() const { return path_; }
+    
+    // Disable copy and move (owns the temporary file)
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+    SpillFile(SpillFile&&) = delete;
+    SpillFile& operator=(SpillFile&&) = delete;
+};
+
+} // namespace DataProcessing
@@ -0,0 +1,328 @@
+/*
+ * Data Processing Pipeline - Tracing Implementation
+ *
+ * The per-thread event rings, the registry that hands them to threads, the
+ * conversion of span clock ticks to time, and the readers: events(),
+ * summary() and the Chrome trace writer.
+ */
+
+#include "tracing.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_set>
+
+#ifdef DATA_PROCESSING_TRACE_TSC
+#include <cpuid.h>
+#endif
+
+namespace DataProcessing {
+namespace Tracing {
+
+namespace detail {
+    std::atomic<bool> enabled{true};
+    
+    bool invariant_tsc() {
+#ifdef DATA_PROCESSING_TRACE_TSC
+        // CPUID 0x80000007: EDX bit 8, the TSC runs at a constant rate in
+        // every power state and is in step across cores
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+}
+
+namespace {
+    // An event's fields as atomics, so that a reader may copy a slot while
+    // its owner overwrites it (the copy is then discarded)
+    struct Slot {
+        std::atomic<const char*> name{""};
+        std::atomic<const char*> category{""};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<uint64_t> duration_ns{0};
+        std::atomic<uint64_t> rows{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint32_t> thread{0};
+        std::atomic<uint32_t> depth{0};
+    };
+    
+    // Single-writer ring of events. Event i goes to slot i % buffer_events;
+    // started_ counts events whose writing has begun, published_ those
+    // completely written.
+    class Ring {
+    private:
+        std::unique_ptr<Slot[]> slots_ = std::make_unique<Slot[]>(buffer_events);
+        std::atomic<uint64_t> started_{0};
+        std::atomic<uint64_t> published_{0};
+        std::atomic<uint64_t> cleared_{0};   // events before this one were cleared
+        
+    public:
+        // Owner thread only
+        void push(const Event& event) {
+            uint64_t index = published_.load(std::memory_order_relaxed);
+            started_.store(index + 1, std::memory_order_relaxed);
+            // A reader that sees any of the stores below also sees started_
+            std::atomic_thread_fence(std::memory_order_release);
+            
+            Slot& slot = slots_[index % buffer_events];
+            slot.name.store(event.name, std::memory_order_relaxed);
+            slot.category.store(event.category, std::memory_order_relaxed);
+            slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+            slot.duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+            slot.rows.store(event.rows, std::memory_order_relaxed);
+            slot.bytes.store(event.bytes, std::memory_order_relaxed);
+            slot.thread.store(event.thread, std::memory_order_relaxed);
+            slot.depth.store(event.depth, std::memory_order_relaxed);
+            published_.store(index + 1, std::memory_order_release);
+        }
+        
+        // Append the intact events to out; any thread
+        void copy(std::vector<Event>& out) const {
+            uint64_t end = published_.load(std::memory_order_acquire);
+            uint64_t begin = std::max(cleared_.load(std::memory_order_relaxed),
+                                      end > buffer_events ? end - buffer_events : 0);
+            size_t first = out.size();
+            for (uint64_t index = begin; index < end; ++index) {
+                const Slot& slot = slots_[index % buffer_events];
+                Event event;
+                event.name = slot.name.load(std::memory_order_relaxed);
+                event.category = slot.category.load(std::memory_order_relaxed);
+                event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+                event.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+                event.rows = slot.rows.load(std::memory_order_relaxed);
+                event.bytes = slot.bytes.load(std::memory_order_relaxed);
+                event.thread = slot.thread.load(std::memory_order_relaxed);
+                event.depth = slot.depth.load(std::memory_order_relaxed);
+                out.push_back(event);
+            }
+            
+            // Event i's slot is reused by event i + buffer_events: drop the
+            // copies of slots whose reuse had started
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t started = started_.load(std::memory_order_relaxed);
+            uint64_t intact = started > buffer_events ? started - buffer_events : 0;
+            if (intact > begin) {
+                size_t torn = static_cast<size_t>(std::min(intact, end) - begin);
+                out.erase(out.begin() + static_cast<std::ptrdiff_t>(first),
+                          out.begin() + static_cast<std::ptrdiff_t>(first + torn));
+            }
+        }
+        
+        void clear() {
+            cleared_.store(published_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    };
+    
+    // A span clock reading and the steady_clock time it was taken at
+    struct ClockPoint {
+        uint64_t ticks;
+        uint64_t ns;
+        
+        static ClockPoint now() { return {detail::now_ticks(), detail::steady_ns()}; }
+    };
+    
+    // Taken when the first thread starts recording
+    const ClockPoint& origin() {
+        static const ClockPoint point = ClockPoint::now();
+        return point;
+    }
+    
+    // Span clock ticks to steady_clock time, at the tick rate measured from
+    // origin() to now (over at least a millisecond)
+    class TickConverter {
+    private:
+        ClockPoint origin_;
+        double ns_per_tick_ = 1.0;
+        
+    public:
+        TickConverter() : origin_(origin()) {
+            ClockPoint now = ClockPoint::now();
+            while (now.ns - origin_.ns < 1000000 || now.ticks == origin_.ticks) {
+                now = ClockPoint::now();
+            }
+            ns_per_tick_ = static_cast<double>(now.ns - origin_.ns) / static_cast<double>(now.ticks - origin_.ticks);
+        }
+        
+        uint64_t time(uint64_t ticks) const {
+            auto since = static_cast<int64_t>(ticks - origin_.ticks);
+            return origin_.ns + static_cast<uint64_t>(static_cast<int64_t>(since * ns_per_tick_));
+        }
+        uint64_t duration(uint64_t ticks) const { return static_cast<uint64_t>(ticks * ns_per_tick_); }
+    };
+    
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Ring>> rings;
+        std::vector<Ring*> idle;             // rings of finished threads
+        uint32_t threads = 0;
+        std::unordered_set<std::string> names;
+    };
+    
+    // Never destroyed: threads may still record while statics are torn
+    // down at exit
+    Registry& registry() {
+        static Registry* instance = new Registry;
+        return *instance;
+    }
+    
+    // The calling thread's ring, returned to the registry when it exits
+    struct ThreadRing {
+        Ring* ring = nullptr;
+        uint32_t thread = 0;
+        
+        ~ThreadRing() {
+            if (ring) {
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                registry().idle.push_back(ring);
+            }
+        }
+    };
+    thread_local ThreadRing current;
+    
+    void attach(ThreadRing& thread_ring) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        origin();
+        thread_ring.thread = ++reg.threads;
+        if (!reg.idle.empty()) {
+            thread_ring.ring = reg.idle.back();
+            reg.idle.pop_back();
+        } else {
+            reg.rings.push_back(std::make_unique<Ring>());
+            thread_ring.ring = reg.rings.back().get();
+        }
+    }
+    
+    void write_json_string(std::ostream& out, const char* text) {
+        out << '"';
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\' << *c;
+            } else if (static_cast<unsigned char>(*c) < 0x20) {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                    << static_cast<int>(*c) << std::dec << std::setfill(' ');
+            } else {
+                out << *c;
+            }
+        }
+        out << '"';
+    }
+}
+
+namespace detail {
+    void record(const Event& event) {
+        if (!current.ring) {
+            attach(current);
+        }
+        Event stamped = event;
+        stamped.thread = current.thread;
+        current.ring->push(stamped);
+    }
+}
+
+void set_enabled(bool enabled) {
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+const char* intern(const std::string& name) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.names.insert(name).first->c_str();
+}
+
+std::vector<Event> events() {
+    std::vector<Event> result;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto& ring : reg.rings) {
+            ring->copy(result);
+        }
+    }
+    if (!result.empty()) {
+        TickConverter converter;
+        for (Event& event : result) {
+            event.start_ns = converter.time(event.start_ns);
+            event.duration_ns = converter.duration(event.duration_ns);
+        }
+    }
+    std::stable_sort(result.begin(), result.end(), [](const Event& a, const Event& b) {
+        return a.start_ns < b.start_ns;
+    });
+    return result;
+}
+
+std::vector<Summary> summary() {
+    std::map<std::pair<std::string, std::string>, Summary> groups;
+    for (const Event& event : events()) {
+        Summary& group = groups[{event.name, event.category}];
+        double ms = event.duration_ns / 1e6;
+        ++group.count;
+        group.total_ms += ms;
+        group.max_ms = std::max(group.max_ms, ms);
+        group.rows += event.rows;
+        group.bytes += event.bytes;
+    }
+    
+    std::vector<Summary> result;
+    for (auto& [key, group] : groups) {
+        group.name = key.first;
+        group.category = key.second;
+        result.push_back(std::move(group));
+    }
+    std::stable_sort(result.begin(), result.end(), [](const Summary& a, const Summary& b) {
+        return a.total_ms > b.total_ms;
+    });
+    return result;
+}
+
+void clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& ring : reg.rings) {
+        ring->clear();
+    }
+}
+
+void write_chrome_trace(std::ostream& out) {
+    std::vector<Event> all = events();
+    uint64_t origin = all.empty() ? 0 : all.front().start_ns;
+    
+    // Timestamps in microseconds from the first event
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < all.size(); ++i) {
+        const Event& event = all[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":";
+        write_json_string(out, event.name);
+        out << ",\"cat\":";
+        write_json_string(out, event.category);
+        out << ",\"ph\":\"X\",\"ts\":" << (event.start_ns - origin) / 1e3
+            << ",\"dur\":" << event.duration_ns / 1e3
+            << ",\"pid\":1,\"tid\":" << event.thread
+            << ",\"args\":{\"rows\":" << event.rows << ",\"bytes\":" << event.bytes << "}}";
+    }
+    out << "\n]}\n";
+}
+
+bool write_chrome_trace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    write_chrome_trace(file);
+    return static_cast<bool>(file);
+}
+
+}
+} // namespace DataProcessing
@@ -0,0 +1,154 @@
+/*
+ * Data Processing Pipeline - Tracing
+ *
+ * Scoped spans that are cheap enough to leave on. A Span reads the clock
+ * when it opens and when it closes, and then writes one fixed-size event
+ * into a ring buffer owned by its thread. On x86-64 with an invariant TSC
+ * the clock is rdtsc; readers convert its ticks to steady_clock time.
+ * Elsewhere it is steady_clock itself. Spans nest: each event records
+ * how many spans were open around it on its thread. There are no locks and
+ * no allocations on this path, and a disabled tracer costs one relaxed
+ * atomic load per span.
+ *
+ * Each thread that records gets its own ring of buffer_events events. When
+ * the ring is full, the oldest events are overwritten. The buffer of a
+ * finished thread is kept, with its events, and handed to the next thread
+ * that starts recording. Memory is therefore bounded by the number of
+ * threads tracing at once, even with a ThreadPool per parallel execution.
+ * Readers copy events out while writers keep going, and skip any slot that
+ * was overwritten while they copied it.
+ *
+ * Pipeline execution opens a span per plan step, with its output rows and
+ * the bytes of cells it read. The parallel and streaming executors also
+ * open one per morsel, task or batch. The events can be exported as Chrome
+ * trace JSON (chrome://tracing, ui.perfetto.dev) or summed per span name
+ * with summary().
+ *
+ * Span names are const char* that must outlive the trace: string literals,
+ * or intern() for names built at run time.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define DATA_PROCESSING_TRACE_TSC 1
+#endif
+
+namespace DataProcessing {
+namespace Tracing {
+    // Events kept per thread before the oldest are overwritten (about 1 MB)
+    constexpr size_t buffer_events = 16 * 1024;
+    
+    // One closed span
+    struct Event {
+        const char* name = "";
+        const char* category = "";
+        uint64_t start_ns = 0;      // std::chrono::steady_clock time
+        uint64_t duration_ns = 0;
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+        uint32_t thread = 0;        // 1, 2, ... in the order threads first recorded
+        uint32_t depth = 0;         // spans open around this one on its thread
+    };
+    
+    // Events of one span name and category, summed
+    struct Summary {
+        std::string name;
+        std::string category;
+        size_t count = 0;
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+    };
+    
+    // Tracing is on unless turned off; spans opened while it is off are
+    // not recorded
+    void set_enabled(bool enabled);
+    bool enabled();
+    
+    // A copy of name that lives as long as the process, the same pointer
+    // for equal names
+    const char* intern(const std::string& name);
+    
+    // Copy of the recorded events of all threads, ordered by start time
+    std::vector<Event> events();
+    
+    // Events summed per name and category, the largest total time first
+    std::vector<Summary> summary();
+    
+    // Forget the events recorded so far
+    void clear();
+    
+    // Chrome trace event format: one complete ("X") event per span, with
+    // rows and bytes as arguments; returns false if path cannot be written
+    void write_chrome_trace(std::ostream& out);
+    bool write_chrome_trace(const std::string& path);
+    
+    namespace detail {
+        extern std::atomic<bool> enabled;
+        inline thread_local uint32_t depth = 0;
+        
+        bool invariant_tsc();
+        
+        inline uint64_t steady_ns() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+        
+        // Span clock: TSC ticks where invariant_tsc(), else steady_ns()
+        inline uint64_t now_ticks() {
+#ifdef DATA_PROCESSING_TRACE_TSC
+            static const bool tsc = invariant_tsc();
+            if (tsc) return __rdtsc();
+#endif
+            return steady_ns();
+        }
+        
+        // Takes event with start_ns and duration_ns in now_ticks() ticks
+        void record(const Event& event);
+    }
+    
+    // Records the time from construction to destruction as an event
+    class Span {
+    private:
+        Event event_;   // times in ticks until recorded
+        bool active_;
+        
+    public:
+        explicit Span(const char* name, const char* category = "pipeline")
+            : active_(detail::enabled.load(std::memory_order_relaxed)) {
+            if (active_) {
+                event_.name = name;
+                event_.category = category;
+                event_.depth = detail::depth++;
+                event_.start_ns = detail::now_ticks();
+            }
+        }
+        
+        ~Span() {
+            if (active_) {
+                event_.duration_ns = detail::now_ticks() - event_.start_ns;
+                --detail::depth;
+                detail::record(event_);
+            }
+        }
+        
+        void set_rows(uint64_t rows) { event_.rows = rows; }
+        void add_bytes(uint64_t bytes) { event_.bytes += bytes; }
+        
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        Span(Span&&) = delete;
+        Span& operator=(Span&&) = delete;
+    };
+}
+} // namespace DataProcessing
@@ -0,0 +1,413 @@
+/*
+ * Data Processing Pipeline - Typed DataSets
+ *
+ * A DataSet whose schema is fixed when the program is built. Each column
+ * is a type that carries its name and cell type, a Schema lists them, and
+ * TypedDataSet<Schema<...>> stores one typed buffer per column in a tuple:
+ *
+ *   DATA_COLUMN(department, Dict);
+ *   DATA_COLUMN(salary, double);
+ *   using Payroll = TypedDataSet<Schema<department, salary>>;
+ *
+ *   Payroll payroll = Payroll::load_from_csv("sample_data.csv");
+ *   double total = payroll.sum<salary>();
+ *   auto by_department = payroll.sum_by<department, salary>();
+ *
+ * Column access resolves to a tuple element at compile time, so there is
+ * no name lookup and no variant dispatch per cell: the CSV parser converts
+ * each field straight to its column's type, and aggregates run over plain
+ * arrays (the numeric ones through the same kernels as DataSet, giving
+ * identical results). Cell types are int64_t, double, std::string and
+ * Dict (text stored dictionary-encoded). to_dataset and from_dataset
+ * convert to and from a DataSet with the same column names.
+ *
+ * Column names are string_views in the column types rather than string
+ * template arguments, which need C++20. Schema::index_of("salary") still
+ * finds a column by name in a constant expression.
+ */
+
+#pragma once
+
+#include "data_processor.hpp"
+#include "csv_reader.hpp"
+#include "simd_kernels.hpp"
+#include <array>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace DataProcessing {
+
+// Cell type of a column of dictionary-encoded text
+struct Dict {};
+
+// Base of every schema column type; see DATA_COLUMN
+template<typename Cell>
+struct Col {
+    static_assert(std::is_same_v<Cell, int64_t> || std::is_same_v<Cell, double> ||
+                  std::is_same_v<Cell, std::string> || std::is_same_v<Cell, Dict>,
+                  "Column cells are int64_t, double, std::string or Dict");
+    using cell_type = Cell;
+};
+
+// Declare the column type Name, holding Cell values, named "Name" in CSV
+// headers and DataSets. For a name that is not an identifier, derive from
+// Col<Cell> by hand and give the struct a static constexpr name.
+#define DATA_COLUMN(Name, Cell) \
+    struct Name : ::DataProcessing::Col<Cell> { static constexpr std::string_view name = #Name; }
+
+namespace Typed {
+    // Buffer, cell value and DataSet column type of each cell type
+    template<typename Cell>
+    struct Traits;
+    
+    template<>
+    struct Traits<int64_t> {
+        using storage = std::pmr::vector<int64_t>;
+        using value = int64_t;
+    };
+    
+    template<>
+    struct Traits<double> {
+        using storage = std::pmr::vector<double>;
+        using value = double;
+    };
+    
+    template<>
+    struct Traits<std::string> {
+        using storage = std::pmr::vector<std::pmr::string>;
+        using value = std::string_view;
+    };
+    
+    template<>
+    struct Traits<Dict> {
+        using storage = DictionaryColumn;
+        using value = std::string_view;
+    };
+    
+    template<typename Cell>
+    constexpr bool is_numeric_v = std::is_same_v<Cell, int64_t> || std::is_same_v<Cell, double>;
+    
+    inline void reserve(DictionaryColumn& cells, size_t rows) { cells.codes.reserve(rows); }
+    template<typename Vector>
+    void reserve(Vector& cells, size_t rows) { cells.reserve(rows); }
+    
+    inline void push(DictionaryColumn& cells, std::string_view value) { cells.append(value); }
+    template<typename Vector, typename Value>
+    void push(Vector& cells, Value value) { cells.emplace_back(value); }
+    
+    inline std::string_view at(const DictionaryColumn& cells, size_t row) { return cells.at(row); }
+    inline std::string_view at(const std::pmr::vector<std::pmr::string>& cells, size_t row) { return cells[row]; }
+    template<typename Number>
+    Number at(const std::pmr::vector<Number>& cells, size_t row) { return cells[row]; }
+    
+    // Append a CSV field to a column of the given cell type; numbers are
+    // parsed as DataSet::load_from_csv parses them
+    template<typename Cell>
+    ParseResult<void> append_parsed(typename Traits<Cell>::storage& cells, std::string_view field) {
+        if constexpr (is_numeric_v<Cell>) {
+            ParseResult<Cell> value;
+            if constexpr (std::is_same_v<Cell, int64_t>) {
+                value = Csv::try_parse_int(field);
+            } else {
+                value = Csv::try_parse_double(field);
+            }
+            if (!value) return stdx::unexpected(value.error());
+            cells.push_back(*value);
+        } else {
+            push(cells, field);
+        }
+        return {};
+    }
+    
+    // Fill a buffer from a DataSet column; false if a cell does not convert
+    // (text for a number, a fraction for an int64_t, a number for text)
+    template<typename Cell>
+    bool copy_column(const Column& column, typename Traits<Cell>::storage& cells) {
+        if constexpr (std::is_same_v<Cell, int64_t>) {
+            if (column.type() == ColumnType::Int64) {
+                cells.assign(column.ints().begin(), column.ints().end());
+                return true;
+            }
+        } else if constexpr (std::is_same_v<Cell, double>) {
+            if (column.type() == ColumnType::Double) {
+                cells.assign(column.doubles().begin(), column.doubles().end());
+                return true;
+            }
+        } else if constexpr (std::is_same_v<Cell, Dict>) {
+            if (column.type() == ColumnType::Dictionary) {
+                cells = column.dictionary();   // shares the dictionary
+                return true;
+            }
+        }
+        
+        // Anything else converts cell by cell
+        reserve(cells, column.size());
+        for (size_t row = 0; row < column.size(); ++row) {
+            DataValue value = column.get(row);
+            if constexpr (std::is_same_v<Cell, int64_t>) {
+                if (!value.is_int()) {
+                    return false;
+                }
+                cells.push_back(value.as_int());
+            } else if constexpr (is_numeric_v<Cell>) {
+                std::optional<double> number = column.numeric_at(row);
+                if (!number) {
+                    return false;
+                }
+                cells.push_back(static_cast<Cell>(*number));
+            } else {
+                if (!value.is_string()) {
+                    return false;
+                }
+                push(cells, value.as_string());
+            }
+        }
+        return true;
+    }
+}
+
+// The columns of a TypedDataSet, in order. Names must be distinct.
+template<typename... Columns>
+struct Schema {
+    static_assert(sizeof...(Columns) > 0, "A schema needs at least one column");
+    
+    static constexpr size_t size = sizeof...(Columns);
+    static constexpr std::array<std::string_view, size> names = {Columns::name...};
+    
+    // Position of the column called name, or size if there is none
+    static constexpr size_t index_of(std::string_view name) {
+        for (size_t i = 0; i < size; ++i) {
+            if (names[i] == name) return i;
+        }
+        return size;
+    }
+    
+    // Position of a column type, or size if it is not in the schema
+    template<typename Column>
+    static constexpr size_t position() {
+        constexpr bool matches[] = {std::is_same_v<Column, Columns>...};
+        for (size_t i = 0; i < size; ++i) {
+            if (matches[i]) return i;
+        }
+        return size;
+    }
+    
+    static constexpr bool distinct_names() {
+        for (size_t i = 0; i < size; ++i) {
+            if (index_of(names[i]) != i) return false;
+        }
+        return true;
+    }
+    
+    static_assert(distinct_names(), "Schema column names must be distinct");
+};
+
+template<typename Schema>
+class TypedDataSet;
+
+template<typename... Columns>
+class TypedDataSet<Schema<Columns...>> {
+public:
+    using schema = Schema<Columns...>;
+    
+    template<typename Column>
+    using cells_t = typename Typed::Traits<typename Column::cell_type>::storage;
+    template<typename Column>
+    using value_t = typename Typed::Traits<typename Column::cell_type>::value;
+    
+private:
+    std::tuple<cells_t<Columns>...> columns_;
+    size_t rows_ = 0;
+    
+    template<typename Column>
+    static constexpr size_t index() {
+        constexpr size_t position = schema::template position<Column>();
+        static_assert(position < schema::size, "Column is not in this schema");
+        return position;
+    }
+    
+    // Parse one CSV line's fields into every column, stopping at the first
+    // field that fails, whose schema position is left in failed
+    template<size_t... I>
+    ParseResult<void> parse_fields(const std::vector<std::string_view>& fields,
+                                   const std::array<size_t, schema::size>& positions, size_t& failed,
+                                   std::index_sequence<I...>) {
+        ParseResult<void> parsed;
+        ((failed = I,
+          parsed = Typed::append_parsed<typename Columns::cell_type>(
+              std::get<I>(columns_), positions[I] < fields.size() ? fields[positions[I]] : std::string_view()),
+          parsed.has_value()) && ...);
+        return parsed;
+    }
+    
+    template<typename Column>
+    void copy_from(const DataSet& dataset) {
+        if (!Typed::copy_column<typename Column::cell_type>(dataset.column(std::string(Column::name)),
+                                                            std::get<index<Column>()>(columns_))) {
+            throw std::invalid_argument("Column '" + std::string(Column::name) +
+                                        "' does not match its schema type");
+        }
+    }
+    
+public:
+    TypedDataSet() = default;
+    
+    size_t size() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+    
+    void reserve(size_t rows) {
+        std::apply([rows](auto&... cells) { (Typed::reserve(cells, rows), ...); }, columns_);
+    }
+    
+    // Append one row: a value per column, in schema order
+    void append(value_t<Columns>... values) {
+        std::apply([&](auto&... cells) { (Typed::push(cells, values), ...); }, columns_);
+        ++rows_;
+    }
+    
+    // The buffer of a column, by column type or schema position
+    template<typename Column>
+    const cells_t<Column>& column() const { return std::get<index<Column>()>(columns_); }
+    template<size_t I>
+    const auto& column() const { return std::get<I>(columns_); }
+    
+    template<typename Column>
+    value_t<Column> get(size_t row) const { return Typed::at(column<Column>(), row); }
+    
+    // Call f(cell...) for every row, with the cells of the given columns
+    template<typename... Selected, typename Function>
+    void for_each_row(Function&& f) const {
+        for (size_t row = 0; row < rows_; ++row) {
+            f(Typed::at(column<Selected>(), row)...);
+        }
+    }
+    
+    // Numeric aggregates; min and max of no rows are +inf and -inf (or the
+    // int64_t limits), the mean of no rows is 0
+    template<typename Column>
+    typename Column::cell_type sum() const {
+        static_assert(Typed::is_numeric_v<typename Column::cell_type>, "sum needs a numeric column");
+        return Kernels::sum(column<Column>().data(), rows_);
+    }
+    
+    template<typename Column>
+    typename Column::cell_type min() const {
+        static_assert(Typed::is_numeric_v<typename Column::cell_type>, "min needs a numeric column");
+        return Kernels::min(column<Column>().data(), rows_);
+    }
+    
+    template<typename Column>
+    typename Column::cell_type max() const {
+        static_assert(Typed::is_numeric_v<typename Column::cell_type>, "max needs a numeric column");
+        return Kernels::max(column<Column>().data(), rows_);
+    }
+    
+    template<typename Column>
+    double mean() const {
+        return rows_ ? static_cast<double>(sum<Column>()) / static_cast<double>(rows_) : 0.0;
+    }
+    
+    // Sum of a numeric column per distinct value of a Dict column, in order
+    // of first appearance. Each dictionary code indexes its own slot, so
+    // grouping takes no hashing.
+    template<typename Key, typename Value>
+    std::vector<std::pair<std::string, double>> sum_by() const {
+        static_assert(std::is_same_v<typename Key::cell_type, Dict>, "sum_by groups on a Dict column");
+        static_assert(Typed::is_numeric_v<typename Value::cell_type>, "sum_by sums a numeric column");
+        
+        const DictionaryColumn& keys = column<Key>();
+        const cells_t<Value>& values = column<Value>();
+        std::vector<double> sums(keys.dictionary->size(), 0.0);
+        std::vector<size_t> counts(keys.dictionary->size(), 0);
+        for (size_t row = 0; row < rows_; ++row) {
+            sums[keys.codes[row]] += static_cast<double>(values[row]);
+            ++counts[keys.codes[row]];
+        }
+        
+        // A dictionary shared with a larger column may hold values no row uses
+        std::vector<std::pair<std::string, double>> result;
+        for (uint32_t code = 0; code < sums.size(); ++code) {
+            if (counts[code]) {
+                result.emplace_back((*keys.dictionary)[code], sums[code]);
+            }
+        }
+        return result;
+    }
+    
+    // Load the schema's columns from a CSV file by header name (other
+    // columns are skipped and blank lines ignored). Errors: CannotOpenFile,
+    // ColumnNotFound for a schema column missing from the header, and
+    // NotANumber or NumberOutOfRange for a numeric field, naming the
+    // column and line.
+    static Result<TypedDataSet> try_load_from_csv(const std::string& filename) {
+        MappedFile file;
+        if (Result<void> opened = file.open(filename); !opened) {
+            return stdx::unexpected(std::move(opened).error());
+        }
+        std::string_view body = file.view();
+        
+        std::vector<std::string> header = Csv::read_header(body);
+        std::array<size_t, schema::size> positions;
+        for (size_t i = 0; i < schema::size; ++i) {
+            auto found = std::find(header.begin(), header.end(), schema::names[i]);
+            if (found == header.end()) {
+                return stdx::unexpected(Error{ErrorCode::ColumnNotFound, std::string(schema::names[i])});
+            }
+            positions[i] = static_cast<size_t>(found - header.begin());
+        }
+        
+        TypedDataSet result;
+        result.reserve(static_cast<size_t>(std::count(body.begin(), body.end(), '\n')) + 1);
+        std::vector<std::string_view> fields;
+        for (size_t line = 2; !body.empty(); ++line) {
+            Csv::split_line(Csv::next_line(body), fields);
+            if (fields.empty() || (fields.size() == 1 && fields[0].empty())) {
+                continue;
+            }
+            size_t failed = 0;
+            ParseResult<void> parsed = result.parse_fields(fields, positions, failed,
+                                                           std::index_sequence_for<Columns...>());
+            if (!parsed) {
+                return stdx::unexpected(Error{parsed.error(), std::string(schema::names[failed]) +
+                                                                  " on line " + std::to_string(line)});
+            }
+            ++result.rows_;
+        }
+        return result;
+    }
+    
+    static TypedDataSet load_from_csv(const std::string& filename) {
+        Result<TypedDataSet> result = try_load_from_csv(filename);
+        if (!result) {
+            throw std::runtime_error(result.error().message());
+        }
+        return *std::move(result);
+    }
+    
+    // The schema's columns of a DataSet (others are ignored). Throws
+    // std::invalid_argument for a missing column or one whose cells do not
+    // convert to the schema type.
+    static TypedDataSet from_dataset(const DataSet& dataset) {
+        TypedDataSet result;
+        (result.template copy_from<Columns>(dataset), ...);
+        result.rows_ = dataset.size();
+        return result;
+    }
+    
+    // A DataSet with the same columns, in schema order
+    DataSet to_dataset() const& {
+        std::vector<Column> data;
+        std::apply([&](const auto&... cells) { (data.emplace_back(Column::Storage(cells)), ...); }, columns_);
+        return DataSet(std::vector<std::string>(schema::names.begin(), schema::names.end()), std::move(data));
+    }
+    
+    DataSet to_dataset() && {
+        std::vector<Column> data;
+        std::apply([&](auto&... cells) { (data.emplace_back(Column::Storage(std::move(cells))), ...); }, columns_);
+        rows_ = 0;
+        return DataSet(std::vector<std::string>(schema::names.begin(), schema::names.end()), std::move(data));
+    }
+};
+
+} // namespace DataProcessing
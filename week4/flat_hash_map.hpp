@@ -0,0 +1,756 @@
+/*
+ * flat_hash_map / flat_hash_set - Open-Addressing Hash Containers
+ *
+ * Swiss-table style replacement for std::unordered_map/unordered_set on
+ * hot paths. Elements live inline in one slot array (no node per element);
+ * a parallel array of one-byte control words holds 7 bits of each
+ * element's hash, and lookups compare a whole group of 16 control bytes
+ * against the probe hash with one SSE2 instruction (a portable loop
+ * elsewhere), touching a slot only on a 7-bit match.
+ *
+ * - Takes the same Hash / KeyEqual functors as the std containers, so
+ *   custom hashers such as PersonHasher plug in unchanged; the hash is
+ *   remixed internally, so identity hashes (std::hash<int>) are fine
+ * - Heterogeneous lookup when both functors are transparent:
+ *   string_flat_hash_map<V> finds std::string keys by string_view or
+ *   const char* without building a std::string
+ * - reserve() then freeze() builds a read-only lookup table: freeze
+ *   rehashes to a load of at most 1/2 for short probes, after which any
+ *   mutation throws std::logic_error and concurrent readers are safe
+ * - Insertion may rehash and invalidate all iterators and references;
+ *   erase invalidates only the erased element
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Transparent hash for string keys: std::string, string_view and string
+// literals hash alike (pair it with std::equal_to<>)
+struct string_hash {
+    using is_transparent = void;
+    
+    size_t operator()(std::string_view value) const noexcept {
+        return std::hash<std::string_view>()(value);
+    }
+};
+
+namespace flat_hash_detail {
+    using ctrl_t = int8_t;
+    
+    // Full slots hold the low 7 hash bits (0..127); the others are negative
+    constexpr ctrl_t EMPTY = -128;
+    constexpr ctrl_t DELETED = -2;
+    constexpr size_t GROUP_WIDTH = 16;
+    
+    inline uint32_t lowest_bit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+        uint32_t bit = 0;
+        while (!(mask & 1u)) {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+    
+    // The 16 control bytes of one probe group; each match is a bit mask
+    // with bit i set for byte i
+    class group {
+    private:
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128i ctrl_;
+        
+    public:
+        explicit group(const ctrl_t* ctrl)
+            : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+            
+        uint32_t match(ctrl_t h2) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+        }
+        
+        uint32_t match_empty() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(EMPTY), ctrl_)));
+        }
+        
+        // EMPTY and DELETED are exactly the bytes with the sign bit set
+        uint32_t match_non_full() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+        }
+#else
+        const ctrl_t* ctrl_;
+        
+        template<typename Predicate>
+        uint32_t collect(Predicate predicate) const {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                if (predicate(ctrl_[i])) mask |= 1u << i;
+            }
+            return mask;
+        }
+        
+    public:
+        explicit group(const ctrl_t* ctrl) : ctrl_(ctrl) {}
+        
+        uint32_t match(ctrl_t h2) const { return collect([h2](ctrl_t c) { return c == h2; }); }
+        uint32_t match_empty() const { return collect([](ctrl_t c) { return c == EMPTY; }); }
+        uint32_t match_non_full() const { return collect([](ctrl_t c) { return c < 0; }); }
+#endif
+    };
+    
+    // Spread the user hash so both the group index (high bits) and the
+    // 7-bit tag (low bits) are well distributed
+    inline size_t mix(size_t hash) {
+        uint64_t h = static_cast<uint64_t>(hash);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+    
+    template<typename T, typename = void>
+    struct is_transparent : std::false_type {};
+    
+    template<typename T>
+    struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+    
+    // key_arg<K> is K for transparent functors and the key type otherwise.
+    // Written as a member alias of a class chosen by the bool (rather than
+    // std::conditional_t) so that K stays deducible in find(const key_arg<K>&)
+    template<bool Transparent>
+    struct key_arg_impl {
+        template<typename K, typename Key>
+        using type = Key;
+    };
+    
+    template<>
+    struct key_arg_impl<true> {
+        template<typename K, typename Key>
+        using type = K;
+    };
+    
+    struct identity_key {
+        template<typename T>
+        const T& operator()(const T& value) const noexcept { return value; }
+    };
+    
+    struct pair_key {
+        template<typename Pair>
+        const typename Pair::first_type& operator()(const Pair& value) const noexcept { return value.first; }
+    };
+    
+    // Shared table for the map and the set. Slot is what iterators point to
+    // (std::pair<const Key, T> or Key); KeyOf extracts the key from a slot
+    template<typename Key, typename Slot, typename KeyOf, typename Hash, typename KeyEqual>
+    class flat_hash_table {
+    protected:
+        static constexpr bool transparent = is_transparent<Hash>::value && is_transparent<KeyEqual>::value;
+        
+        template<typename K>
+        using key_arg = typename key_arg_impl<transparent>::template type<K, Key>;
+        
+        static constexpr size_t npos = static_cast<size_t>(-1);
+        
+    public:
+        using key_type = Key;
+        using value_type = Slot;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        
+        template<bool Const>
+        class basic_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Slot;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<Const, const Slot&, Slot&>;
+            using pointer = std::conditional_t<Const, const Slot*, Slot*>;
+            
+        private:
+            const ctrl_t* ctrl_ = nullptr;
+            const ctrl_t* end_ = nullptr;
+            pointer slot_ = nullptr;
+            
+            void skip_non_full() {
+                while (ctrl_ != end_ && *ctrl_ < 0) {
+                    ++ctrl_;
+                    ++slot_;
+                }
+            }
+            
+            friend class flat_hash_table;
+            
+        public:
+            basic_iterator() = default;
+            
+            basic_iterator(const ctrl_t* ctrl, const ctrl_t* end, pointer slot)
+                : ctrl_(ctrl), end_(end), slot_(slot) {
+                skip_non_full();
+            }
+            
+            template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+            basic_iterator(const basic_iterator<OtherConst>& other)
+                : ctrl_(other.ctrl_), end_(other.end_), slot_(other.slot_) {}
+                
+            reference operator*() const { return *slot_; }
+            pointer operator->() const { return slot_; }
+            
+            basic_iterator& operator++() {
+                ++ctrl_;
+                ++slot_;
+                skip_non_full();
+                return *this;
+            }
+            
+            basic_iterator operator++(int) {
+                basic_iterator old = *this;
+                ++*this;
+                return old;
+            }
+            
+            friend bool operator==(const basic_iterator& a, const basic_iterator& b) { return a.ctrl_ == b.ctrl_; }
+            friend bool operator!=(const basic_iterator& a, const basic_iterator& b) { return a.ctrl_ != b.ctrl_; }
+            
+            template<bool> friend class basic_iterator;
+        };
+        
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        
+    private:
+        std::unique_ptr<ctrl_t[]> ctrl_;
+        Slot* slots_ = nullptr;
+        size_t capacity_ = 0;      // zero or a power of two >= GROUP_WIDTH
+        size_t size_ = 0;
+        size_t growth_left_ = 0;   // EMPTY slots that may still be filled
+        bool frozen_ = false;
+        Hash hash_;
+        KeyEqual equal_;
+        
+        static size_t max_size_for(size_t capacity) { return capacity - capacity / 8; }
+        
+        static size_t capacity_for(size_t count, size_t max_load_numerator, size_t max_load_denominator) {
+            size_t capacity = GROUP_WIDTH;
+            while (capacity * max_load_numerator / max_load_denominator < count) {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+        
+        template<typename K>
+        size_t hash_of(const K& key) const { return mix(hash_(key)); }
+        
+        template<typename K>
+        size_t find_index(const K& key, size_t hash) const {
+            if (capacity_ == 0) {
+                return npos;
+            }
+            ctrl_t h2 = static_cast<ctrl_t>(hash & 0x7F);
+            size_t group_mask = capacity_ / GROUP_WIDTH - 1;
+            size_t index = (hash >> 7) & group_mask;
+            // Triangular steps visit every group when their count is a power of two
+            for (size_t step = 1;; ++step) {
+                size_t base = index * GROUP_WIDTH;
+                group probe(ctrl_.get() + base);
+                for (uint32_t match = probe.match(h2); match; match &= match - 1) {
+                    size_t slot = base + lowest_bit(match);
+                    if (equal_(KeyOf()(slots_[slot]), key)) {
+                        return slot;
+                    }
+                }
+                if (probe.match_empty()) {
+                    return npos;
+                }
+                index = (index + step) & group_mask;
+            }
+        }
+        
+        // First EMPTY or DELETED slot on the probe sequence of hash
+        size_t find_insert_slot(size_t hash) const {
+            size_t group_mask = capacity_ / GROUP_WIDTH - 1;
+            size_t index = (hash >> 7) & group_mask;
+            for (size_t step = 1;; ++step) {
+                size_t base = index * GROUP_WIDTH;
+                if (uint32_t free = group(ctrl_.get() + base).match_non_full()) {
+                    return base + lowest_bit(free);
+                }
+                index = (index + step) & group_mask;
+            }
+        }
+        
+        void release() noexcept {
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (ctrl_[i] >= 0) slots_[i].~Slot();
+            }
+            if (slots_) {
+                std::allocator<Slot>().deallocate(slots_, capacity_);
+            }
+            ctrl_.reset();
+            slots_ = nullptr;
+            capacity_ = size_ = growth_left_ = 0;
+        }
+        
+        // Rebuild at capacity (also drops tombstones). Elements are moved
+        // when that cannot throw and copied otherwise, so a failure leaves
+        // the table unchanged
+        void resize(size_t capacity) {
+            std::unique_ptr<ctrl_t[]> ctrl(new ctrl_t[capacity]);
+            std::fill(ctrl.get(), ctrl.get() + capacity, EMPTY);
+            Slot* slots = std::allocator<Slot>().allocate(capacity);
+            
+            size_t group_mask = capacity / GROUP_WIDTH - 1;
+            size_t built = 0;
+            try {
+                for (size_t i = 0; i < capacity_; ++i) {
+                    if (ctrl_[i] < 0) continue;
+                    size_t hash = hash_of(KeyOf()(slots_[i]));
+                    size_t index = (hash >> 7) & group_mask;
+                    size_t slot = 0;
+                    for (size_t step = 1;; ++step) {
+                        size_t base = index * GROUP_WIDTH;
+                        if (uint32_t free = group(ctrl.get() + base).match_non_full()) {
+                            slot = base + lowest_bit(free);
+                            break;
+                        }
+                        index = (index + step) & group_mask;
+                    }
+                    new (slots + slot) Slot(std::move_if_noexcept(slots_[i]));
+                    ctrl[slot] = static_cast<ctrl_t>(hash & 0x7F);
+                    ++built;
+                }
+            } catch (...) {
+                for (size_t i = 0; i < capacity && built; ++i) {
+                    if (ctrl[i] >= 0) {
+                        slots[i].~Slot();
+                        --built;
+                    }
+                }
+                std::allocator<Slot>().deallocate(slots, capacity);
+                throw;
+            }
+            
+            size_t size = size_;
+            release();
+            ctrl_ = std::move(ctrl);
+            slots_ = slots;
+            capacity_ = capacity;
+            size_ = size;
+            growth_left_ = max_size_for(capacity) - size;
+        }
+        
+        void prepare_insert() {
+            if (capacity_ == 0) {
+                resize(GROUP_WIDTH);
+            } else if (size_ <= max_size_for(capacity_) / 2) {
+                resize(capacity_);   // mostly tombstones: clean up in place
+            } else {
+                resize(capacity_ * 2);
+            }
+        }
+        
+    protected:
+        void check_mutable() const {
+            if (frozen_) {
+                throw std::logic_error("flat hash container is frozen");
+            }
+        }
+        
+        iterator iterator_at(size_t slot) {
+            return iterator(ctrl_.get() + slot, ctrl_.get() + capacity_, slots_ + slot);
+        }
+        
+        const_iterator iterator_at(size_t slot) const {
+            return const_iterator(ctrl_.get() + slot, ctrl_.get() + capacity_, slots_ + slot);
+        }
+        
+        template<typename K>
+        size_t find_slot(const K& key) const { return find_index(key, hash_of(key)); }
+        
+        // Insert Slot(args...) unless key is present; key must be the key
+        // the slot will hold
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> emplace_with_key(const K& key, Args&&... args) {
+            size_t hash = hash_of(key);
+            size_t found = find_index(key, hash);
+            if (found != npos) {
+                return {iterator_at(found), false};
+            }
+            check_mutable();
+            
+            size_t slot = capacity_ ? find_insert_slot(hash) : npos;
+            if (slot == npos || (growth_left_ == 0 && ctrl_[slot] == EMPTY)) {
+                prepare_insert();
+                slot = find_insert_slot(hash);
+            }
+            new (slots_ + slot) Slot(std::forward<Args>(args)...);
+            if (ctrl_[slot] == EMPTY) {
+                --growth_left_;
+            }
+            ctrl_[slot] = static_cast<ctrl_t>(hash & 0x7F);
+            ++size_;
+            return {iterator_at(slot), true};
+        }
+        
+        void erase_slot(size_t slot) {
+            check_mutable();
+            slots_[slot].~Slot();
+            --size_;
+            // A group that still has an EMPTY byte never ended a probe early
+            // for anyone, so the slot can become EMPTY instead of a tombstone
+            size_t base = slot / GROUP_WIDTH * GROUP_WIDTH;
+            if (group(ctrl_.get() + base).match_empty()) {
+                ctrl_[slot] = EMPTY;
+                ++growth_left_;
+            } else {
+                ctrl_[slot] = DELETED;
+            }
+        }
+        
+        size_t slot_of(const_iterator position) const {
+            return static_cast<size_t>(position.slot_ - slots_);
+        }
+        
+    public:
+        flat_hash_table() = default;
+        
+        explicit flat_hash_table(size_t bucket_count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : hash_(hash), equal_(equal) {
+            reserve(bucket_count);
+        }
+        
+        flat_hash_table(const flat_hash_table& other) : hash_(other.hash_), equal_(other.equal_) {
+            reserve(other.size_);
+            for (size_t i = 0; i < other.capacity_; ++i) {
+                if (other.ctrl_[i] >= 0) {
+                    emplace_with_key(KeyOf()(other.slots_[i]), other.slots_[i]);
+                }
+            }
+            if (other.frozen_) freeze();
+        }
+        
+        flat_hash_table(flat_hash_table&& other) noexcept
+            : ctrl_(std::move(other.ctrl_)), slots_(other.slots_), capacity_(other.capacity_),
+              size_(other.size_), growth_left_(other.growth_left_), frozen_(other.frozen_),
+              hash_(std::move(other.hash_)), equal_(std::move(other.equal_)) {
+            other.slots_ = nullptr;
+            other.capacity_ = other.size_ = other.growth_left_ = 0;
+            other.frozen_ = false;
+        }
+        
+        flat_hash_table& operator=(flat_hash_table other) noexcept {
+            swap(other);
+            return *this;
+        }
+        
+        ~flat_hash_table() { release(); }
+        
+        void swap(flat_hash_table& other) noexcept {
+            using std::swap;
+            swap(ctrl_, other.ctrl_);
+            swap(slots_, other.slots_);
+            swap(capacity_, other.capacity_);
+            swap(size_, other.size_);
+            swap(growth_left_, other.growth_left_);
+            swap(frozen_, other.frozen_);
+            swap(hash_, other.hash_);
+            swap(equal_, other.equal_);
+        }
+        
+        friend void swap(flat_hash_table& a, flat_hash_table& b) noexcept { a.swap(b); }
+        
+        // Iterators
+        iterator begin() { return iterator_at(0); }
+        iterator end() { return iterator_at(capacity_); }
+        const_iterator begin() const { return iterator_at(0); }
+        const_iterator end() const { return iterator_at(capacity_); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+        
+        // Capacity
+        size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        size_t capacity() const noexcept { return capacity_; }
+        float load_factor() const noexcept { return capacity_ ? static_cast<float>(size_) / capacity_ : 0.0f; }
+        static constexpr float max_load_factor() noexcept { return 0.875f; }
+        
+        // Room for count elements without rehashing
+        void reserve(size_t count) {
+            check_mutable();
+            size_t capacity = capacity_for(count, 7, 8);
+            if (count > 0 && capacity > capacity_) {
+                resize(capacity);
+            }
+        }
+        
+        void rehash(size_t count) {
+            check_mutable();
+            size_t capacity = capacity_for(std::max(count, size_), 7, 8);
+            if (capacity != capacity_ && (count > 0 || size_ > 0)) {
+                resize(capacity);
+            }
+        }
+        
+        // Read-only from here on: rehash to a load of at most 1/2 so that
+        // most lookups end in their first group, then reject all mutation
+        void freeze() {
+            if (!frozen_) {
+                if (size_ > 0) {
+                    resize(capacity_for(size_, 1, 2));
+                }
+                frozen_ = true;
+            }
+        }
+        
+        void unfreeze() noexcept { frozen_ = false; }
+        bool frozen() const noexcept { return frozen_; }
+        
+        void clear() {
+            check_mutable();
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (ctrl_[i] >= 0) slots_[i].~Slot();
+                ctrl_[i] = EMPTY;
+            }
+            size_ = 0;
+            growth_left_ = capacity_ ? max_size_for(capacity_) : 0;
+        }
+        
+        // Lookup (heterogeneous when Hash and KeyEqual are transparent)
+        template<typename K = Key>
+        iterator find(const key_arg<K>& key) {
+            size_t slot = find_slot(key);
+            return slot == npos ? end() : iterator_at(slot);
+        }
+        
+        template<typename K = Key>
+        const_iterator find(const key_arg<K>& key) const {
+            size_t slot = find_slot(key);
+            return slot == npos ? end() : iterator_at(slot);
+        }
+        
+        template<typename K = Key>
+        bool contains(const key_arg<K>& key) const { return find_slot(key) != npos; }
+        
+        template<typename K = Key>
+        size_t count(const key_arg<K>& key) const { return contains<K>(key) ? 1 : 0; }
+        
+        // Removal; erase(iterator) returns the next element so erasing
+        // while iterating works as with std::unordered_map
+        template<typename K = Key>
+        size_t erase(const key_arg<K>& key) {
+            size_t slot = find_slot(key);
+            if (slot == npos) {
+                return 0;
+            }
+            erase_slot(slot);
+            return 1;
+        }
+        
+        iterator erase(const_iterator position) {
+            size_t slot = slot_of(position);
+            erase_slot(slot);
+            return iterator_at(slot);   // skips ahead from the now-free slot
+        }
+        
+        iterator erase(iterator position) { return erase(const_iterator(position)); }
+        
+        hasher hash_function() const { return hash_; }
+        key_equal key_eq() const { return equal_; }
+        
+        // Same elements regardless of order, as for the std unordered containers
+        friend bool operator==(const flat_hash_table& a, const flat_hash_table& b) {
+            if (a.size_ != b.size_) {
+                return false;
+            }
+            for (const auto& element : a) {
+                size_t slot = b.find_slot(KeyOf()(element));
+                if (slot == npos || !(b.slots_[slot] == element)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        
+        friend bool operator!=(const flat_hash_table& a, const flat_hash_table& b) { return !(a == b); }
+    };
+}
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_hash_map
+    : public flat_hash_detail::flat_hash_table<Key, std::pair<const Key, T>, flat_hash_detail::pair_key, Hash, KeyEqual> {
+private:
+    using base = flat_hash_detail::flat_hash_table<Key, std::pair<const Key, T>, flat_hash_detail::pair_key, Hash, KeyEqual>;
+    
+    template<typename K>
+    using key_arg = typename base::template key_arg<K>;
+    
+public:
+    using mapped_type = T;
+    using typename base::value_type;
+    using typename base::iterator;
+    using typename base::const_iterator;
+    
+    using base::base;
+    
+    flat_hash_map() = default;
+    
+    flat_hash_map(std::initializer_list<value_type> values) {
+        this->reserve(values.size());
+        insert(values.begin(), values.end());
+    }
+    
+    template<typename InputIt>
+    flat_hash_map(InputIt first, InputIt last) {
+        insert(first, last);
+    }
+    
+    // Insertion
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return this->emplace_with_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return this->emplace_with_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return this->emplace_with_key(value.first, value);
+    }
+    
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return this->emplace_with_key(value.first, std::move(value));
+    }
+    
+    template<typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P&&>>>
+    std::pair<iterator, bool> insert(P&& value) {
+        return emplace(std::forward<P>(value));
+    }
+    
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+    
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return this->emplace_with_key(value.first, std::move(value));
+    }
+    
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& mapped) {
+        auto result = try_emplace(key, std::forward<M>(mapped));
+        if (!result.second) {
+            this->check_mutable();
+            result.first->second = std::forward<M>(mapped);
+        }
+        return result;
+    }
+    
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& mapped) {
+        auto result = try_emplace(std::move(key), std::forward<M>(mapped));
+        if (!result.second) {
+            this->check_mutable();
+            result.first->second = std::forward<M>(mapped);
+        }
+        return result;
+    }
+    
+    // Element access
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+    
+    template<typename K = Key>
+    T& at(const key_arg<K>& key) {
+        auto it = this->template find<K>(key);
+        if (it == this->end()) {
+            throw std::out_of_range("flat_hash_map::at: key not found");
+        }
+        return it->second;
+    }
+    
+    template<typename K = Key>
+    const T& at(const key_arg<K>& key) const {
+        auto it = this->template find<K>(key);
+        if (it == this->end()) {
+            throw std::out_of_range("flat_hash_map::at: key not found");
+        }
+        return it->second;
+    }
+};
+
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_hash_set
+    : public flat_hash_detail::flat_hash_table<Key, Key, flat_hash_detail::identity_key, Hash, KeyEqual> {
+private:
+    using base = flat_hash_detail::flat_hash_table<Key, Key, flat_hash_detail::identity_key, Hash, KeyEqual>;
+    
+public:
+    using typename base::value_type;
+    using typename base::iterator;
+    using typename base::const_iterator;
+    
+    using base::base;
+    
+    flat_hash_set() = default;
+    
+    flat_hash_set(std::initializer_list<Key> values) {
+        this->reserve(values.size());
+        insert(values.begin(), values.end());
+    }
+    
+    template<typename InputIt>
+    flat_hash_set(InputIt first, InputIt last) {
+        insert(first, last);
+    }
+    
+    std::pair<iterator, bool> insert(const Key& key) { return this->emplace_with_key(key, key); }
+    std::pair<iterator, bool> insert(Key&& key) { return this->emplace_with_key(key, std::move(key)); }
+    
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+    
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        return this->emplace_with_key(key, std::move(key));
+    }
+};
+
+// String-keyed containers that look up by std::string, string_view or literal
+template<typename T>
+using string_flat_hash_map = flat_hash_map<std::string, T, string_hash, std::equal_to<>>;
+
+using string_flat_hash_set = flat_hash_set<std::string, string_hash, std::equal_to<>>;
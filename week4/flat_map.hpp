@@ -0,0 +1,466 @@
+/*
+ * flat_map / flat_set - Sorted-Vector Associative Containers
+ *
+ * Ordered replacement for std::map/std::set when lookups and range scans
+ * dominate. Elements live sorted and unique in one std::vector, so a
+ * lookup is a binary search over contiguous memory and a range scan is a
+ * linear walk with no pointer chasing:
+ *
+ *   flat_set<Person, MemberComparator<Person, int>> byAge(
+ *       people.begin(), people.end(), make_member_comparator(&Person::age));
+ *   for (const Person& p : byAge.range(25, 30)) ...   // ages in [25, 30)
+ *
+ * - Takes any strict weak ordering, including stateful comparators such
+ *   as MemberComparator (pass the instance to the constructor)
+ * - Bulk build: the range constructor and insert(first, last) append,
+ *   sort and deduplicate once, O(n log n); sorted_unique skips the sort
+ *   for input that is already ordered
+ * - Single insert and erase shift the tail, O(n); batch them through
+ *   insert(first, last) when loading
+ * - Heterogeneous lower_bound/find/range when Compare::is_transparent
+ *   is defined
+ * - Any insertion or erase invalidates all iterators and references
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Tag for constructors and inserts whose input is already sorted and free
+// of duplicates under the container's comparator
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace flat_sorted_detail {
+    template<typename T, typename = void>
+    struct is_transparent : std::false_type {};
+
+    template<typename T>
+    struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+    struct identity_key {
+        template<typename T>
+        const T& operator()(const T& value) const noexcept { return value; }
+    };
+
+    struct pair_key {
+        template<typename Pair>
+        const typename Pair::first_type& operator()(const Pair& value) const noexcept { return value.first; }
+    };
+
+    // Pair of iterators usable in a range-based for
+    template<typename Iterator>
+    class iterator_range {
+    private:
+        Iterator first_;
+        Iterator last_;
+
+    public:
+        iterator_range(Iterator first, Iterator last) : first_(first), last_(last) {}
+
+        Iterator begin() const { return first_; }
+        Iterator end() const { return last_; }
+        bool empty() const { return first_ == last_; }
+        size_t size() const { return static_cast<size_t>(std::distance(first_, last_)); }
+    };
+
+    // Shared storage for the map and the set: a vector of Value sorted by
+    // KeyOf()(value) under Compare, with no two equivalent keys
+    template<typename Key, typename Value, typename KeyOf, typename Compare>
+    class flat_sorted_vector {
+    protected:
+        template<typename K>
+        using enable_transparent = std::enable_if_t<is_transparent<Compare>::value && std::is_same_v<K, K>>;
+
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using key_compare = Compare;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using container_type = std::vector<Value>;
+        using iterator = typename container_type::iterator;
+        using const_iterator = typename container_type::const_iterator;
+        using reverse_iterator = typename container_type::reverse_iterator;
+        using const_reverse_iterator = typename container_type::const_reverse_iterator;
+
+    private:
+        container_type data_;
+        Compare comp_;
+
+        // Lower bound on a sorted range, written out instead of
+        // std::lower_bound so the comparator sees (element key, probe)
+        template<typename K>
+        size_t lower_index(const K& key) const {
+            size_t first = 0;
+            size_t count = data_.size();
+            while (count > 0) {
+                size_t half = count / 2;
+                if (comp_(KeyOf()(data_[first + half]), key)) {
+                    first += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return first;
+        }
+
+        template<typename K>
+        size_t upper_index(const K& key) const {
+            size_t first = 0;
+            size_t count = data_.size();
+            while (count > 0) {
+                size_t half = count / 2;
+                if (!comp_(key, KeyOf()(data_[first + half]))) {
+                    first += half + 1;
+                    count -= half + 1;
+                } else {
+                    count = half;
+                }
+            }
+            return first;
+        }
+
+        template<typename K>
+        size_t find_index(const K& key) const {
+            size_t index = lower_index(key);
+            if (index != data_.size() && !comp_(key, KeyOf()(data_[index]))) {
+                return index;
+            }
+            return data_.size();
+        }
+
+        bool equivalent(const Value& a, const Value& b) const {
+            return !comp_(KeyOf()(a), KeyOf()(b)) && !comp_(KeyOf()(b), KeyOf()(a));
+        }
+
+        // Sort data_[first..] and merge it into the sorted prefix, keeping
+        // the earliest of each run of equivalent keys (the prefix wins, as
+        // with repeated std::map::insert)
+        void merge_tail(size_t first) {
+            auto by_key = [this](const Value& a, const Value& b) {
+                return comp_(KeyOf()(a), KeyOf()(b));
+            };
+            auto middle = data_.begin() + static_cast<difference_type>(first);
+            std::stable_sort(middle, data_.end(), by_key);
+            std::inplace_merge(data_.begin(), middle, data_.end(), by_key);
+            auto last = std::unique(data_.begin(), data_.end(),
+                                    [this](const Value& a, const Value& b) { return equivalent(a, b); });
+            data_.erase(last, data_.end());
+        }
+
+    protected:
+        // Insert value unless its key is present; key must be the key the
+        // value holds
+        template<typename K, typename V>
+        std::pair<iterator, bool> insert_with_key(const K& key, V&& value) {
+            size_t index = lower_index(key);
+            if (index != data_.size() && !comp_(key, KeyOf()(data_[index]))) {
+                return {data_.begin() + static_cast<difference_type>(index), false};
+            }
+            auto it = data_.insert(data_.begin() + static_cast<difference_type>(index), std::forward<V>(value));
+            return {it, true};
+        }
+
+        // Same, starting the search from a hint: an insert at the end of
+        // ascending input costs one comparison
+        template<typename K, typename V>
+        iterator insert_with_hint(const_iterator hint, const K& key, V&& value) {
+            auto position = data_.begin() + (hint - data_.cbegin());
+            bool after_prev = position == data_.begin() || comp_(KeyOf()(*(position - 1)), key);
+            bool before_hint = position == data_.end() || comp_(key, KeyOf()(*position));
+            if (after_prev && before_hint) {
+                return data_.insert(position, std::forward<V>(value));
+            }
+            return insert_with_key(key, std::forward<V>(value)).first;
+        }
+
+    public:
+        flat_sorted_vector() = default;
+
+        explicit flat_sorted_vector(const Compare& comp) : comp_(comp) {}
+
+        template<typename InputIt>
+        flat_sorted_vector(InputIt first, InputIt last, const Compare& comp = Compare())
+            : comp_(comp) {
+            insert(first, last);
+        }
+
+        // Adopt already ordered, duplicate-free input without sorting
+        template<typename InputIt>
+        flat_sorted_vector(sorted_unique_t, InputIt first, InputIt last, const Compare& comp = Compare())
+            : data_(first, last), comp_(comp) {}
+
+        flat_sorted_vector(sorted_unique_t, container_type data, const Compare& comp = Compare())
+            : data_(std::move(data)), comp_(comp) {}
+
+        flat_sorted_vector(std::initializer_list<Value> values, const Compare& comp = Compare())
+            : comp_(comp) {
+            insert(values.begin(), values.end());
+        }
+
+        // Iterators
+        iterator begin() noexcept { return data_.begin(); }
+        iterator end() noexcept { return data_.end(); }
+        const_iterator begin() const noexcept { return data_.begin(); }
+        const_iterator end() const noexcept { return data_.end(); }
+        const_iterator cbegin() const noexcept { return data_.cbegin(); }
+        const_iterator cend() const noexcept { return data_.cend(); }
+        reverse_iterator rbegin() noexcept { return data_.rbegin(); }
+        reverse_iterator rend() noexcept { return data_.rend(); }
+        const_reverse_iterator rbegin() const noexcept { return data_.rbegin(); }
+        const_reverse_iterator rend() const noexcept { return data_.rend(); }
+
+        // Capacity
+        size_t size() const noexcept { return data_.size(); }
+        bool empty() const noexcept { return data_.empty(); }
+        size_t capacity() const noexcept { return data_.capacity(); }
+        void reserve(size_t count) { data_.reserve(count); }
+        void shrink_to_fit() { data_.shrink_to_fit(); }
+        void clear() noexcept { data_.clear(); }
+
+        // Contiguous access: the elements in key order
+        const Value* data() const noexcept { return data_.data(); }
+        const Value& nth(size_t index) const { return data_[index]; }
+
+        // Bulk insertion: append, then one sort and merge. Keys already
+        // present keep their current value
+        template<typename InputIt>
+        void insert(InputIt first, InputIt last) {
+            size_t old_size = data_.size();
+            data_.insert(data_.end(), first, last);
+            if (data_.size() != old_size) {
+                merge_tail(old_size);
+            }
+        }
+
+        template<typename InputIt>
+        void insert(sorted_unique_t, InputIt first, InputIt last) {
+            size_t old_size = data_.size();
+            data_.insert(data_.end(), first, last);
+            auto by_key = [this](const Value& a, const Value& b) {
+                return comp_(KeyOf()(a), KeyOf()(b));
+            };
+            std::inplace_merge(data_.begin(), data_.begin() + static_cast<difference_type>(old_size),
+                               data_.end(), by_key);
+            auto end = std::unique(data_.begin(), data_.end(),
+                                   [this](const Value& a, const Value& b) { return equivalent(a, b); });
+            data_.erase(end, data_.end());
+        }
+
+        void insert(std::initializer_list<Value> values) { insert(values.begin(), values.end()); }
+
+        // Hand the sorted vector out (leaves the container empty)
+        container_type extract() && { return std::move(data_); }
+
+        // Lookup
+        iterator lower_bound(const Key& key) { return begin() + static_cast<difference_type>(lower_index(key)); }
+        const_iterator lower_bound(const Key& key) const { return begin() + static_cast<difference_type>(lower_index(key)); }
+        iterator upper_bound(const Key& key) { return begin() + static_cast<difference_type>(upper_index(key)); }
+        const_iterator upper_bound(const Key& key) const { return begin() + static_cast<difference_type>(upper_index(key)); }
+        iterator find(const Key& key) { return begin() + static_cast<difference_type>(find_index(key)); }
+        const_iterator find(const Key& key) const { return begin() + static_cast<difference_type>(find_index(key)); }
+        bool contains(const Key& key) const { return find_index(key) != data_.size(); }
+        size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+        std::pair<iterator, iterator> equal_range(const Key& key) {
+            auto first = lower_bound(key);
+            return {first, first == end() || comp_(key, KeyOf()(*first)) ? first : first + 1};
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            auto first = lower_bound(key);
+            return {first, first == end() || comp_(key, KeyOf()(*first)) ? first : first + 1};
+        }
+
+        // Heterogeneous lookup for transparent comparators
+        template<typename K, typename = enable_transparent<K>>
+        iterator lower_bound(const K& key) { return begin() + static_cast<difference_type>(lower_index(key)); }
+        template<typename K, typename = enable_transparent<K>>
+        const_iterator lower_bound(const K& key) const { return begin() + static_cast<difference_type>(lower_index(key)); }
+        template<typename K, typename = enable_transparent<K>>
+        iterator upper_bound(const K& key) { return begin() + static_cast<difference_type>(upper_index(key)); }
+        template<typename K, typename = enable_transparent<K>>
+        const_iterator upper_bound(const K& key) const { return begin() + static_cast<difference_type>(upper_index(key)); }
+        template<typename K, typename = enable_transparent<K>>
+        iterator find(const K& key) { return begin() + static_cast<difference_type>(find_index(key)); }
+        template<typename K, typename = enable_transparent<K>>
+        const_iterator find(const K& key) const { return begin() + static_cast<difference_type>(find_index(key)); }
+        template<typename K, typename = enable_transparent<K>>
+        bool contains(const K& key) const { return find_index(key) != data_.size(); }
+
+        // Range scan over keys in [low, high)
+        iterator_range<const_iterator> range(const Key& low, const Key& high) const {
+            return {lower_bound(low), lower_bound(high)};
+        }
+
+        template<typename K, typename = enable_transparent<K>>
+        iterator_range<const_iterator> range(const K& low, const K& high) const {
+            return {lower_bound(low), lower_bound(high)};
+        }
+
+        // Removal
+        iterator erase(const_iterator position) { return data_.erase(position); }
+        iterator erase(iterator position) { return data_.erase(position); }
+        iterator erase(const_iterator first, const_iterator last) { return data_.erase(first, last); }
+
+        size_t erase(const Key& key) {
+            size_t index = find_index(key);
+            if (index == data_.size()) {
+                return 0;
+            }
+            data_.erase(data_.begin() + static_cast<difference_type>(index));
+            return 1;
+        }
+
+        // Remove every element matching pred in one pass
+        template<typename Predicate>
+        size_t erase_if(Predicate pred) {
+            auto last = std::remove_if(data_.begin(), data_.end(), pred);
+            size_t removed = static_cast<size_t>(data_.end() - last);
+            data_.erase(last, data_.end());
+            return removed;
+        }
+
+        key_compare key_comp() const { return comp_; }
+
+        void swap(flat_sorted_vector& other) noexcept {
+            using std::swap;
+            swap(data_, other.data_);
+            swap(comp_, other.comp_);
+        }
+
+        friend void swap(flat_sorted_vector& a, flat_sorted_vector& b) noexcept { a.swap(b); }
+
+        friend bool operator==(const flat_sorted_vector& a, const flat_sorted_vector& b) { return a.data_ == b.data_; }
+        friend bool operator!=(const flat_sorted_vector& a, const flat_sorted_vector& b) { return !(a == b); }
+    };
+}
+
+// Sorted-vector map. Elements are std::pair<Key, T> (the key is not const,
+// so the vector can shift them); never modify a key through an iterator
+template<typename Key, typename T, typename Compare = std::less<Key>>
+class flat_map
+    : public flat_sorted_detail::flat_sorted_vector<Key, std::pair<Key, T>, flat_sorted_detail::pair_key, Compare> {
+private:
+    using base = flat_sorted_detail::flat_sorted_vector<Key, std::pair<Key, T>, flat_sorted_detail::pair_key, Compare>;
+
+public:
+    using mapped_type = T;
+    using typename base::value_type;
+    using typename base::iterator;
+    using typename base::const_iterator;
+
+    using base::base;
+    using base::insert;
+
+    flat_map() = default;
+
+    // Insertion
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return this->insert_with_key(value.first, value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        return this->insert_with_key(value.first, std::move(value));
+    }
+
+    iterator insert(const_iterator hint, const value_type& value) {
+        return this->insert_with_hint(hint, value.first, value);
+    }
+
+    iterator insert(const_iterator hint, value_type&& value) {
+        return this->insert_with_hint(hint, value.first, std::move(value));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        value_type value(std::forward<Args>(args)...);
+        return this->insert_with_key(value.first, std::move(value));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto it = this->lower_bound(key);
+        if (it != this->end() && !this->key_comp()(key, it->first)) {
+            return {it, false};
+        }
+        return this->insert_with_key(key, value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                                                     std::forward_as_tuple(std::forward<Args>(args)...)));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& mapped) {
+        auto result = try_emplace(key, std::forward<M>(mapped));
+        if (!result.second) {
+            result.first->second = std::forward<M>(mapped);
+        }
+        return result;
+    }
+
+    // Element access
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+
+    T& at(const Key& key) {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            throw std::out_of_range("flat_map::at: key not found");
+        }
+        return it->second;
+    }
+
+    const T& at(const Key& key) const {
+        auto it = this->find(key);
+        if (it == this->end()) {
+            throw std::out_of_range("flat_map::at: key not found");
+        }
+        return it->second;
+    }
+};
+
+// Sorted-vector set; elements are read-only through its iterators
+template<typename Key, typename Compare = std::less<Key>>
+class flat_set
+    : public flat_sorted_detail::flat_sorted_vector<Key, Key, flat_sorted_detail::identity_key, Compare> {
+private:
+    using base = flat_sorted_detail::flat_sorted_vector<Key, Key, flat_sorted_detail::identity_key, Compare>;
+
+public:
+    using typename base::value_type;
+    using iterator = typename base::const_iterator;
+    using const_iterator = typename base::const_iterator;
+
+    using base::base;
+    using base::insert;
+
+    flat_set() = default;
+
+    const_iterator begin() const noexcept { return base::begin(); }
+    const_iterator end() const noexcept { return base::end(); }
+
+    std::pair<const_iterator, bool> insert(const Key& key) { return this->insert_with_key(key, key); }
+    std::pair<const_iterator, bool> insert(Key&& key) { return this->insert_with_key(key, std::move(key)); }
+
+    const_iterator insert(const_iterator hint, const Key& key) { return this->insert_with_hint(hint, key, key); }
+    const_iterator insert(const_iterator hint, Key&& key) { return this->insert_with_hint(hint, key, std::move(key)); }
+
+    template<typename... Args>
+    std::pair<const_iterator, bool> emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        return this->insert_with_key(key, std::move(key));
+    }
+};
@@ -24,6 +24,8 @@
 #include <iomanip>
 #include <algorithm>
 #include <numeric>
+#include <cstring>
+#include "soa_vector.hpp"
 
 // Helper class to track memory allocations
 class MemoryTracker {
@@ -451,6 +453,11 @@ void demonstrateMemoryPool() {
     }
 }
 
+SOA_FIELD(X, int, x);
+SOA_FIELD(Y, int, y);
+SOA_FIELD(Z, int, z);
+SOA_FIELD(Value, double, value);
+
 void demonstrateCacheFriendlyAccess() {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "  Cache-Friendly Data Access Patterns" << std::endl;
@@ -470,20 +477,11 @@ void demonstrateCacheFriendlyAccess() {
         aos[i] = {static_cast<int>(i), static_cast<int>(i * 2), static_cast<int>(i * 3), static_cast<double>(i)};
     }
     
-    // Structure of arrays (SoA)
-    struct SoA {
-        std::vector<int> x, y, z;
-        std::vector<double> value;
-        
-        SoA(size_t n) : x(n), y(n), z(n), value(n) {}
-    };
-    
-    SoA soa(size);
+    // Structure of arrays (SoA): one contiguous array per field
+    soa_vector<X, Y, Z, Value> soa;
+    soa.reserve(size);
     for (size_t i = 0; i < size; ++i) {
-        soa.x[i] = static_cast<int>(i);
-        soa.y[i] = static_cast<int>(i * 2);
-        soa.z[i] = static_cast<int>(i * 3);
-        soa.value[i] = static_cast<double>(i);
+        soa.push_back(static_cast<int>(i), static_cast<int>(i * 2), static_cast<int>(i * 3), static_cast<double>(i));
     }
     
     auto measureTime = [](auto func) {
@@ -507,7 +505,7 @@ void demonstrateCacheFriendlyAccess() {
     double soaTime = measureTime([&]() {
         for (size_t iter = 0; iter < iterations; ++iter) {
             volatile double sum = 0;
-            for (double val : soa.value) {
+            for (double val : soa.column<Value>()) {
                 sum += val;
             }
         }
@@ -532,8 +530,8 @@ void demonstrateCacheFriendlyAccess() {
     double soaAllTime = measureTime([&]() {
         for (size_t iter = 0; iter < iterations; ++iter) {
             volatile double sum = 0;
-            for (size_t i = 0; i < size; ++i) {
-                sum += soa.x[i] + soa.y[i] + soa.z[i] + soa.value[i];
+            for (auto item : soa) {
+                sum += item.x + item.y + item.z + item.value;
             }
         }
     });
@@ -542,6 +540,35 @@ void demonstrateCacheFriendlyAccess() {
     std::cout << "  Array of Structures (AoS): " << aosAllTime << " ms" << std::endl;
     std::cout << "  Structure of Arrays (SoA): " << soaAllTime << " ms" << std::endl;
     std::cout << "  AoS speedup: " << std::setprecision(2) << soaAllTime / aosAllTime << "x" << std::endl;
+    
+    // Test: Two of four fields through a view (only x and value are streamed)
+    double aosPairTime = measureTime([&]() {
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            volatile double sum = 0;
+            for (const auto& item : aos) {
+                sum = sum + item.x * item.value;
+            }
+        }
+    });
+    
+    double soaPairTime = measureTime([&]() {
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            volatile double sum = 0;
+            for (auto item : soa.view<X, Value>()) {
+                sum = sum + item.x * item.value;
+            }
+        }
+    });
+    
+    std::cout << "\nAccessing x and value (" << iterations << " iterations):" << std::endl;
+    std::cout << "  Array of Structures (AoS): " << std::setprecision(3) << aosPairTime << " ms" << std::endl;
+    std::cout << "  SoA view<X, Value>:        " << soaPairTime << " ms" << std::endl;
+    
+    // The proxies work with the usual algorithms
+    std::sort(soa.begin(), soa.end(), [](const auto& a, const auto& b) { return a.value > b.value; });
+    auto firstEven = std::find_if(soa.begin(), soa.end(), [](const auto& item) { return item.x % 2 == 0; });
+    std::cout << "\nAfter std::sort by value (descending): front value = " << std::setprecision(1)
+              << soa.front().value << ", first even x = " << firstEven->x << std::endl;
 }
 
 int main() {
@@ -0,0 +1,657 @@
+/*
+ * range_adaptors.hpp - Lazy, Composable Range Adaptors
+ *
+ * The FilterIterator / TransformIterator idea from custom_iterators.cpp as
+ * one adaptor layer with pipe syntax:
+ *
+ *   using namespace lazy;
+ *   for (auto [i, v] : values | views::filter(is_valid)
+ *                             | views::transform(scale)
+ *                             | views::take(100)
+ *                             | views::enumerate) ...
+ *
+ *   for (span<const double> block : column | views::chunk(4096))
+ *       total += Kernels::sum(block.data(), block.size());
+ *
+ * Nothing runs until the result is iterated, and a chain of adaptors is
+ * one loop: each element is pulled through every stage in turn, with no
+ * intermediate containers.
+ *
+ * - An adaptor stores its function object once; iterators point back at
+ *   their view instead of carrying their own copy of the predicate or
+ *   function. Captureless lambdas cost no space (empty base optimization)
+ * - end() returns a sentinel rather than a second iterator, so filter and
+ *   take never pay for an end position they cannot know up front.
+ *   Range-based for accepts this; for std algorithms that need matching
+ *   types, use to_vector / fold / for_each here
+ * - chunk(n) needs a contiguous range (data() and size()) and yields
+ *   span<T> blocks that can be handed straight to vectorized kernels
+ * - Lvalue ranges are referenced, rvalue ranges are moved into the view;
+ *   a view must outlive its iterators and must not move while iterated
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lazy {
+
+// Non-owning view of count contiguous elements (std::span arrives in C++20)
+template<typename T>
+class span {
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    span() = default;
+    span(T* data, size_t size) : data_(data), size_(size) {}
+
+    template<typename Container, typename = decltype(std::declval<Container&>().data())>
+    span(Container& container) : data_(container.data()), size_(container.size()) {}
+
+    T* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    T& operator[](size_t index) const { return data_[index]; }
+    T* begin() const noexcept { return data_; }
+    T* end() const noexcept { return data_ + size_; }
+};
+
+// Base of every view: cheap to copy, refers to or owns its source. The
+// CRTP parameter gives each view a distinct empty base, so a view holding
+// another view does not need padding between the two
+template<typename Derived>
+struct view_base {};
+
+namespace range_detail {
+    template<typename R>
+    using iterator_t = decltype(std::begin(std::declval<R&>()));
+
+    template<typename R>
+    using sentinel_t = decltype(std::end(std::declval<R&>()));
+
+    template<typename I>
+    using reference_t = decltype(*std::declval<I&>());
+
+    template<typename I>
+    using category_t = typename std::iterator_traits<I>::iterator_category;
+
+    // Forward when the base iterator is at least forward and yields real
+    // references, input otherwise
+    template<typename I, typename Reference>
+    using adapted_category_t = std::conditional_t<
+        std::is_base_of_v<std::forward_iterator_tag, category_t<I>> && std::is_reference_v<Reference>,
+        std::forward_iterator_tag, std::input_iterator_tag>;
+
+    // Holds a function object; empty ones take no space
+    template<typename F, bool Empty = std::is_empty_v<F> && !std::is_final_v<F>>
+    class fn_box : private F {
+    public:
+        explicit fn_box(F fn) : F(std::move(fn)) {}
+        const F& fn() const noexcept { return *this; }
+    };
+
+    template<typename F>
+    class fn_box<F, false> {
+    private:
+        F fn_;
+
+    public:
+        explicit fn_box(F fn) : fn_(std::move(fn)) {}
+        const F& fn() const noexcept { return fn_; }
+    };
+
+    // A view of an lvalue range
+    template<typename R>
+    class ref_view : public view_base<ref_view<R>> {
+    private:
+        R* range_;
+
+    public:
+        explicit ref_view(R& range) : range_(&range) {}
+        auto begin() const { return std::begin(*range_); }
+        auto end() const { return std::end(*range_); }
+    };
+
+    // A view that took ownership of an rvalue range
+    template<typename R>
+    class owning_view : public view_base<owning_view<R>> {
+    private:
+        R range_;
+
+    public:
+        explicit owning_view(R&& range) : range_(std::move(range)) {}
+        auto begin() { return std::begin(range_); }
+        auto end() { return std::end(range_); }
+    };
+
+    template<typename R>
+    auto all(R&& range) {
+        using Plain = std::remove_cv_t<std::remove_reference_t<R>>;
+        if constexpr (std::is_base_of_v<view_base<Plain>, Plain>) {
+            return Plain(std::forward<R>(range));
+        } else if constexpr (std::is_lvalue_reference_v<R>) {
+            return ref_view<std::remove_reference_t<R>>(range);
+        } else {
+            return owning_view<Plain>(std::move(range));
+        }
+    }
+
+    template<typename R>
+    using all_t = decltype(all(std::declval<R>()));
+
+    // Sentinel wrapping the base range's end
+    template<typename S>
+    struct base_sentinel {
+        S end;
+    };
+
+    template<typename F>
+    struct closure;
+
+    template<typename T>
+    struct is_closure : std::false_type {};
+
+    template<typename F>
+    struct is_closure<closure<F>> : std::true_type {};
+
+    template<typename F>
+    closure<F> make_closure(F fn) { return closure<F>{std::move(fn)}; }
+
+    // Right-hand side of range | adaptor; closures also compose with each
+    // other, so an adaptor chain can be named and reused
+    template<typename F>
+    struct closure {
+        F fn;
+
+        template<typename R>
+        auto operator()(R&& range) const { return fn(std::forward<R>(range)); }
+
+        template<typename R, typename = std::enable_if_t<!is_closure<std::decay_t<R>>::value>>
+        friend auto operator|(R&& range, const closure& adaptor) {
+            return adaptor.fn(std::forward<R>(range));
+        }
+
+        template<typename G>
+        friend auto operator|(closure first, closure<G> second) {
+            return make_closure([first = std::move(first), second = std::move(second)](auto&& range) {
+                return second(first(std::forward<decltype(range)>(range)));
+            });
+        }
+    };
+}
+
+// filter: elements for which pred(element) holds
+template<typename V, typename Pred>
+class filter_view : public view_base<filter_view<V, Pred>>, private range_detail::fn_box<Pred> {
+private:
+    using base_iterator = range_detail::iterator_t<V>;
+    using base_sentinel = range_detail::sentinel_t<V>;
+
+    V base_;
+
+    const Pred& pred() const noexcept { return this->fn(); }
+
+public:
+    using sentinel = range_detail::base_sentinel<base_sentinel>;
+
+    class iterator {
+    public:
+        using reference = range_detail::reference_t<base_iterator>;
+        using value_type = std::remove_cv_t<std::remove_reference_t<reference>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using iterator_category = range_detail::adapted_category_t<base_iterator, reference>;
+
+    private:
+        filter_view* parent_ = nullptr;
+        base_iterator current_{};
+        base_sentinel end_{};
+
+        void satisfy() {
+            while (!(current_ == end_) && !std::invoke(parent_->pred(), *current_)) {
+                ++current_;
+            }
+        }
+
+    public:
+        iterator() = default;
+        iterator(filter_view& parent, base_iterator current, base_sentinel end)
+            : parent_(&parent), current_(std::move(current)), end_(std::move(end)) {
+            satisfy();
+        }
+
+        reference operator*() const { return *current_; }
+        const base_iterator& base() const noexcept { return current_; }
+
+        iterator& operator++() {
+            ++current_;
+            satisfy();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.current_ == b.current_; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+        friend bool operator==(const iterator& it, const sentinel& s) { return it.current_ == s.end; }
+        friend bool operator!=(const iterator& it, const sentinel& s) { return !(it == s); }
+        friend bool operator==(const sentinel& s, const iterator& it) { return it == s; }
+        friend bool operator!=(const sentinel& s, const iterator& it) { return !(it == s); }
+    };
+
+    filter_view(V base, Pred pred) : range_detail::fn_box<Pred>(std::move(pred)), base_(std::move(base)) {}
+
+    iterator begin() { return iterator(*this, std::begin(base_), std::end(base_)); }
+    sentinel end() { return sentinel{std::end(base_)}; }
+};
+
+// transform: fn(element) for each element, computed on dereference
+template<typename V, typename F>
+class transform_view : public view_base<transform_view<V, F>>, private range_detail::fn_box<F> {
+private:
+    using base_iterator = range_detail::iterator_t<V>;
+    using base_sentinel = range_detail::sentinel_t<V>;
+
+    V base_;
+
+    const F& function() const noexcept { return this->fn(); }
+
+public:
+    using sentinel = range_detail::base_sentinel<base_sentinel>;
+
+    class iterator {
+    public:
+        using reference = std::invoke_result_t<const F&, range_detail::reference_t<base_iterator>>;
+        using value_type = std::remove_cv_t<std::remove_reference_t<reference>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using iterator_category = range_detail::adapted_category_t<base_iterator, reference>;
+
+    private:
+        transform_view* parent_ = nullptr;
+        base_iterator current_{};
+
+    public:
+        iterator() = default;
+        iterator(transform_view& parent, base_iterator current) : parent_(&parent), current_(std::move(current)) {}
+
+        reference operator*() const { return std::invoke(parent_->function(), *current_); }
+        const base_iterator& base() const noexcept { return current_; }
+
+        iterator& operator++() {
+            ++current_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.current_ == b.current_; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+        friend bool operator==(const iterator& it, const sentinel& s) { return it.current_ == s.end; }
+        friend bool operator!=(const iterator& it, const sentinel& s) { return !(it == s); }
+        friend bool operator==(const sentinel& s, const iterator& it) { return it == s; }
+        friend bool operator!=(const sentinel& s, const iterator& it) { return !(it == s); }
+    };
+
+    transform_view(V base, F fn) : range_detail::fn_box<F>(std::move(fn)), base_(std::move(base)) {}
+
+    iterator begin() { return iterator(*this, std::begin(base_)); }
+    sentinel end() { return sentinel{std::end(base_)}; }
+};
+
+// take: at most the first count elements
+template<typename V>
+class take_view : public view_base<take_view<V>> {
+private:
+    using base_iterator = range_detail::iterator_t<V>;
+    using base_sentinel = range_detail::sentinel_t<V>;
+
+    V base_;
+    size_t count_;
+
+public:
+    using sentinel = range_detail::base_sentinel<base_sentinel>;
+
+    class iterator {
+    public:
+        using reference = range_detail::reference_t<base_iterator>;
+        using value_type = std::remove_cv_t<std::remove_reference_t<reference>>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using iterator_category = range_detail::adapted_category_t<base_iterator, reference>;
+
+    private:
+        base_iterator current_{};
+        size_t remaining_ = 0;
+
+    public:
+        iterator() = default;
+        iterator(base_iterator current, size_t remaining) : current_(std::move(current)), remaining_(remaining) {}
+
+        reference operator*() const { return *current_; }
+
+        iterator& operator++() {
+            ++current_;
+            --remaining_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.remaining_ == b.remaining_; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+        friend bool operator==(const iterator& it, const sentinel& s) {
+            return it.remaining_ == 0 || it.current_ == s.end;
+        }
+        friend bool operator!=(const iterator& it, const sentinel& s) { return !(it == s); }
+        friend bool operator==(const sentinel& s, const iterator& it) { return it == s; }
+        friend bool operator!=(const sentinel& s, const iterator& it) { return !(it == s); }
+    };
+
+    take_view(V base, size_t count) : base_(std::move(base)), count_(count) {}
+
+    iterator begin() { return iterator(std::begin(base_), count_); }
+    sentinel end() { return sentinel{std::end(base_)}; }
+};
+
+// enumerate: (index, element) pairs, index counting from 0
+template<typename V>
+class enumerate_view : public view_base<enumerate_view<V>> {
+private:
+    using base_iterator = range_detail::iterator_t<V>;
+    using base_sentinel = range_detail::sentinel_t<V>;
+
+    V base_;
+
+public:
+    using sentinel = range_detail::base_sentinel<base_sentinel>;
+
+    class iterator {
+    public:
+        using reference = std::pair<size_t, range_detail::reference_t<base_iterator>>;
+        using value_type = reference;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using iterator_category = std::input_iterator_tag;
+
+    private:
+        base_iterator current_{};
+        size_t index_ = 0;
+
+    public:
+        iterator() = default;
+        explicit iterator(base_iterator current) : current_(std::move(current)) {}
+
+        reference operator*() const { return reference(index_, *current_); }
+
+        iterator& operator++() {
+            ++current_;
+            ++index_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.current_ == b.current_; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+        friend bool operator==(const iterator& it, const sentinel& s) { return it.current_ == s.end; }
+        friend bool operator!=(const iterator& it, const sentinel& s) { return !(it == s); }
+        friend bool operator==(const sentinel& s, const iterator& it) { return it == s; }
+        friend bool operator!=(const sentinel& s, const iterator& it) { return !(it == s); }
+    };
+
+    explicit enumerate_view(V base) : base_(std::move(base)) {}
+
+    iterator begin() { return iterator(std::begin(base_)); }
+    sentinel end() { return sentinel{std::end(base_)}; }
+};
+
+// zip: pairs of corresponding elements, as long as the shorter range
+template<typename V1, typename V2>
+class zip_view : public view_base<zip_view<V1, V2>> {
+private:
+    using first_iterator = range_detail::iterator_t<V1>;
+    using second_iterator = range_detail::iterator_t<V2>;
+    using first_sentinel = range_detail::sentinel_t<V1>;
+    using second_sentinel = range_detail::sentinel_t<V2>;
+
+    V1 first_;
+    V2 second_;
+
+public:
+    struct sentinel {
+        first_sentinel first;
+        second_sentinel second;
+    };
+
+    class iterator {
+    public:
+        using reference = std::pair<range_detail::reference_t<first_iterator>,
+                                    range_detail::reference_t<second_iterator>>;
+        using value_type = reference;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using iterator_category = std::input_iterator_tag;
+
+    private:
+        first_iterator first_{};
+        second_iterator second_{};
+
+    public:
+        iterator() = default;
+        iterator(first_iterator first, second_iterator second)
+            : first_(std::move(first)), second_(std::move(second)) {}
+
+        reference operator*() const { return reference(*first_, *second_); }
+
+        iterator& operator++() {
+            ++first_;
+            ++second_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.first_ == b.first_; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+        friend bool operator==(const iterator& it, const sentinel& s) {
+            return it.first_ == s.first || it.second_ == s.second;
+        }
+        friend bool operator!=(const iterator& it, const sentinel& s) { return !(it == s); }
+        friend bool operator==(const sentinel& s, const iterator& it) { return it == s; }
+        friend bool operator!=(const sentinel& s, const iterator& it) { return !(it == s); }
+    };
+
+    zip_view(V1 first, V2 second) : first_(std::move(first)), second_(std::move(second)) {}
+
+    iterator begin() { return iterator(std::begin(first_), std::begin(second_)); }
+    sentinel end() { return sentinel{std::end(first_), std::end(second_)}; }
+};
+
+// chunk: consecutive blocks of size elements (the last may be shorter)
+// over contiguous storage, each a span
+template<typename T>
+class chunk_view : public view_base<chunk_view<T>> {
+private:
+    T* data_;
+    size_t size_;
+    size_t chunk_;
+
+public:
+    struct sentinel {};
+
+    class iterator {
+    public:
+        using reference = span<T>;
+        using value_type = span<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using iterator_category = std::forward_iterator_tag;
+
+    private:
+        T* position_ = nullptr;
+        T* end_ = nullptr;
+        size_t chunk_ = 0;
+
+    public:
+        iterator() = default;
+        iterator(T* position, T* end, size_t chunk) : position_(position), end_(end), chunk_(chunk) {}
+
+        span<T> operator*() const {
+            size_t left = static_cast<size_t>(end_ - position_);
+            return span<T>(position_, left < chunk_ ? left : chunk_);
+        }
+
+        iterator& operator++() {
+            size_t left = static_cast<size_t>(end_ - position_);
+            position_ += left < chunk_ ? left : chunk_;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) { return a.position_ == b.position_; }
+        friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+        friend bool operator==(const iterator& it, sentinel) { return it.position_ == it.end_; }
+        friend bool operator!=(const iterator& it, sentinel s) { return !(it == s); }
+        friend bool operator==(sentinel s, const iterator& it) { return it == s; }
+        friend bool operator!=(sentinel s, const iterator& it) { return !(it == s); }
+    };
+
+    chunk_view(T* data, size_t size, size_t chunk) : data_(data), size_(size), chunk_(chunk ? chunk : 1) {}
+
+    iterator begin() const { return iterator(data_, data_ + size_, chunk_); }
+    sentinel end() const { return {}; }
+    size_t size() const { return (size_ + chunk_ - 1) / chunk_; }
+};
+
+namespace views {
+    template<typename R, typename Pred>
+    auto filter(R&& range, Pred pred) {
+        return filter_view<range_detail::all_t<R>, Pred>(range_detail::all(std::forward<R>(range)), std::move(pred));
+    }
+
+    template<typename Pred>
+    auto filter(Pred pred) {
+        return range_detail::make_closure([pred = std::move(pred)](auto&& range) {
+            return filter(std::forward<decltype(range)>(range), pred);
+        });
+    }
+
+    template<typename R, typename F>
+    auto transform(R&& range, F fn) {
+        return transform_view<range_detail::all_t<R>, F>(range_detail::all(std::forward<R>(range)), std::move(fn));
+    }
+
+    template<typename F>
+    auto transform(F fn) {
+        return range_detail::make_closure([fn = std::move(fn)](auto&& range) {
+            return transform(std::forward<decltype(range)>(range), fn);
+        });
+    }
+
+    template<typename R>
+    auto take(R&& range, size_t count) {
+        return take_view<range_detail::all_t<R>>(range_detail::all(std::forward<R>(range)), count);
+    }
+
+    inline auto take(size_t count) {
+        return range_detail::make_closure([count](auto&& range) {
+            return take(std::forward<decltype(range)>(range), count);
+        });
+    }
+
+    // Blocks of a contiguous range; the range must outlive the view
+    template<typename R, typename = decltype(std::declval<R&>().data())>
+    auto chunk(R& range, size_t size) {
+        using T = std::remove_pointer_t<decltype(range.data())>;
+        return chunk_view<T>(range.data(), range.size(), size);
+    }
+
+    inline auto chunk(size_t size) {
+        return range_detail::make_closure([size](auto& range) { return chunk(range, size); });
+    }
+
+    template<typename R1, typename R2>
+    auto zip(R1&& first, R2&& second) {
+        return zip_view<range_detail::all_t<R1>, range_detail::all_t<R2>>(
+            range_detail::all(std::forward<R1>(first)), range_detail::all(std::forward<R2>(second)));
+    }
+
+    struct enumerate_fn {
+        template<typename R>
+        auto operator()(R&& range) const {
+            return enumerate_view<range_detail::all_t<R>>(range_detail::all(std::forward<R>(range)));
+        }
+
+        template<typename R>
+        friend auto operator|(R&& range, const enumerate_fn& adaptor) {
+            return adaptor(std::forward<R>(range));
+        }
+    };
+
+    inline constexpr enumerate_fn enumerate{};
+}
+
+// Terminal operations that accept iterator/sentinel ranges
+template<typename R, typename F>
+void for_each(R&& range, F fn) {
+    for (auto&& element : range) {
+        fn(std::forward<decltype(element)>(element));
+    }
+}
+
+template<typename R, typename T, typename Op = std::plus<>>
+T fold(R&& range, T init, Op op = Op()) {
+    for (auto&& element : range) {
+        init = op(std::move(init), std::forward<decltype(element)>(element));
+    }
+    return init;
+}
+
+template<typename R>
+auto to_vector(R&& range) {
+    using Value = std::decay_t<decltype(*std::begin(range))>;
+    std::vector<Value> values;
+    for (auto&& element : range) {
+        values.push_back(std::forward<decltype(element)>(element));
+    }
+    return values;
+}
+
+}  // namespace lazy
@@ -0,0 +1,358 @@
+/*
+ * soa_vector - Structure-of-Arrays Container
+ *
+ * Stores each field of a record in its own contiguous array while still
+ * reading like a vector of structs:
+ *
+ *   SOA_FIELD(X, int, x);
+ *   SOA_FIELD(Value, double, value);
+ *
+ *   soa_vector<X, Value> points;
+ *   points.push_back(1, 2.5);
+ *   points[0].value += 1.0;                  // proxy reference
+ *   for (auto p : points.view<Value>()) ...  // streams only the value array
+ *
+ * - Fields are tag types declared with SOA_FIELD; the tag names the member
+ *   that proxies, values and views expose
+ * - operator[] and iterators yield soa_reference proxies whose members are
+ *   references into the field arrays; the iterators are random access and
+ *   work with std::sort, std::find_if, std::accumulate and friends
+ * - view<Tags...>() iterates a subset of the fields, column<Tag>() is the
+ *   raw array of one field
+ */
+
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+// Declares a field tag: its element type, and the named member the proxies
+// and values of a soa_vector carry for it
+#define SOA_FIELD(Tag, Type, name)                                   \
+    struct Tag {                                                     \
+        using type = Type;                                           \
+        template<typename T>                                         \
+        struct member {                                              \
+            T name;                                                  \
+            T& get() noexcept { return name; }                       \
+            const T& get() const noexcept { return name; }           \
+        };                                                           \
+    }
+
+namespace soa_detail {
+    template<typename Tag, typename... Tags>
+    constexpr size_t index_of() {
+        size_t index = 0;
+        bool found = false;
+        ((found = found || std::is_same_v<Tag, Tags>, index += found ? 0 : 1), ...);
+        return index;
+    }
+    
+    template<typename Tag, typename... Tags>
+    constexpr bool contains = (std::is_same_v<Tag, Tags> || ...);
+    
+    template<bool Const, typename T>
+    using pointer_t = std::conditional_t<Const, const T*, T*>;
+    
+    template<bool Const, typename T>
+    using reference_t = std::conditional_t<Const, const T&, T&>;
+}
+
+// One record by value: what an iterator's value_type is
+template<typename... Tags>
+struct soa_value : Tags::template member<typename Tags::type>... {
+    template<typename Tag>
+    typename Tag::type& get() noexcept {
+        return static_cast<typename Tag::template member<typename Tag::type>&>(*this).get();
+    }
+    
+    template<typename Tag>
+    const typename Tag::type& get() const noexcept {
+        return static_cast<const typename Tag::template member<typename Tag::type>&>(*this).get();
+    }
+};
+
+// One record by reference: members alias the elements in the field arrays.
+// Assigning through the proxy writes those elements, as with a T&
+template<bool Const, typename... Tags>
+struct soa_reference : Tags::template member<soa_detail::reference_t<Const, typename Tags::type>>... {
+    using value_type = soa_value<Tags...>;
+    
+    template<typename Tag>
+    soa_detail::reference_t<Const, typename Tag::type> get() const noexcept {
+        using Member = typename Tag::template member<soa_detail::reference_t<Const, typename Tag::type>>;
+        return static_cast<const Member&>(*this).get();
+    }
+    
+    soa_reference& operator=(const soa_reference& other) {
+        ((get<Tags>() = other.template get<Tags>()), ...);
+        return *this;
+    }
+    
+    soa_reference& operator=(const value_type& value) {
+        ((get<Tags>() = value.template get<Tags>()), ...);
+        return *this;
+    }
+    
+    soa_reference& operator=(value_type&& value) {
+        ((get<Tags>() = std::move(value.template get<Tags>())), ...);
+        return *this;
+    }
+    
+    // Always copies: v[i] is itself an rvalue proxy, so moving out of one
+    // would empty the element it refers to
+    operator value_type() const {
+        return value_type{{get<Tags>()}...};
+    }
+    
+    template<bool C = Const, typename = std::enable_if_t<!C>>
+    operator soa_reference<true, Tags...>() const noexcept {
+        return soa_reference<true, Tags...>{{get<Tags>()}...};
+    }
+    
+    friend void swap(soa_reference a, soa_reference b) {
+        using std::swap;
+        (swap(a.template get<Tags>(), b.template get<Tags>()), ...);
+    }
+};
+
+template<bool Const, typename... Tags>
+class soa_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = soa_value<Tags...>;
+    using difference_type = std::ptrdiff_t;
+    using reference = soa_reference<Const, Tags...>;
+    
+    // Holds the proxy so that it->member works
+    struct pointer {
+        reference proxy;
+        reference* operator->() noexcept { return &proxy; }
+    };
+    
+private:
+    std::tuple<soa_detail::pointer_t<Const, typename Tags::type>...> columns_;
+    difference_type index_ = 0;
+    
+    template<bool, typename...> friend class soa_iterator;
+    
+public:
+    soa_iterator() = default;
+    
+    soa_iterator(std::tuple<soa_detail::pointer_t<Const, typename Tags::type>...> columns, difference_type index)
+        : columns_(columns), index_(index) {}
+        
+    template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+    soa_iterator(const soa_iterator<OtherConst, Tags...>& other) : columns_(other.columns_), index_(other.index_) {}
+    
+    reference operator*() const {
+        return std::apply([this](auto*... columns) { return reference{{columns[index_]}...}; }, columns_);
+    }
+    
+    pointer operator->() const { return pointer{**this}; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+    
+    soa_iterator& operator++() { ++index_; return *this; }
+    soa_iterator operator++(int) { soa_iterator old = *this; ++index_; return old; }
+    soa_iterator& operator--() { --index_; return *this; }
+    soa_iterator operator--(int) { soa_iterator old = *this; --index_; return old; }
+    soa_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+    soa_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+    
+    friend soa_iterator operator+(soa_iterator it, difference_type n) { return it += n; }
+    friend soa_iterator operator+(difference_type n, soa_iterator it) { return it += n; }
+    friend soa_iterator operator-(soa_iterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const soa_iterator& a, const soa_iterator& b) { return a.index_ - b.index_; }
+    
+    friend bool operator==(const soa_iterator& a, const soa_iterator& b) { return a.index_ == b.index_; }
+    friend bool operator!=(const soa_iterator& a, const soa_iterator& b) { return a.index_ != b.index_; }
+    friend bool operator<(const soa_iterator& a, const soa_iterator& b) { return a.index_ < b.index_; }
+    friend bool operator>(const soa_iterator& a, const soa_iterator& b) { return a.index_ > b.index_; }
+    friend bool operator<=(const soa_iterator& a, const soa_iterator& b) { return a.index_ <= b.index_; }
+    friend bool operator>=(const soa_iterator& a, const soa_iterator& b) { return a.index_ >= b.index_; }
+};
+
+// Contiguous array of one field
+template<typename T>
+class soa_column {
+private:
+    T* begin_;
+    T* end_;
+    
+public:
+    soa_column(T* begin, T* end) : begin_(begin), end_(end) {}
+    
+    T* begin() const noexcept { return begin_; }
+    T* end() const noexcept { return end_; }
+    T* data() const noexcept { return begin_; }
+    size_t size() const noexcept { return static_cast<size_t>(end_ - begin_); }
+    bool empty() const noexcept { return begin_ == end_; }
+    T& operator[](size_t i) const noexcept { return begin_[i]; }
+};
+
+// A subset of the fields over the same rows. Iterating it touches only
+// those arrays. Invalidated like iterators when the soa_vector reallocates
+template<bool Const, typename... Tags>
+class soa_view {
+public:
+    using iterator = soa_iterator<Const, Tags...>;
+    using reference = soa_reference<Const, Tags...>;
+    using value_type = soa_value<Tags...>;
+    
+private:
+    std::tuple<soa_detail::pointer_t<Const, typename Tags::type>...> columns_;
+    size_t size_;
+    
+public:
+    soa_view(std::tuple<soa_detail::pointer_t<Const, typename Tags::type>...> columns, size_t size)
+        : columns_(columns), size_(size) {}
+        
+    iterator begin() const { return iterator(columns_, 0); }
+    iterator end() const { return iterator(columns_, static_cast<std::ptrdiff_t>(size_)); }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    reference operator[](size_t i) const { return begin()[static_cast<std::ptrdiff_t>(i)]; }
+};
+
+template<typename... Fields>
+class soa_vector {
+    static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+    
+public:
+    using value_type = soa_value<Fields...>;
+    using reference = soa_reference<false, Fields...>;
+    using const_reference = soa_reference<true, Fields...>;
+    using iterator = soa_iterator<false, Fields...>;
+    using const_iterator = soa_iterator<true, Fields...>;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    
+private:
+    std::tuple<std::vector<typename Fields::type>...> columns_;
+    size_t size_ = 0;
+    
+    template<typename Tag>
+    auto& storage() noexcept {
+        static_assert(soa_detail::contains<Tag, Fields...>, "Tag is not a field of this soa_vector");
+        return std::get<soa_detail::index_of<Tag, Fields...>()>(columns_);
+    }
+    
+    template<typename Tag>
+    const auto& storage() const noexcept {
+        static_assert(soa_detail::contains<Tag, Fields...>, "Tag is not a field of this soa_vector");
+        return std::get<soa_detail::index_of<Tag, Fields...>()>(columns_);
+    }
+    
+    template<typename... Tags>
+    auto pointers() noexcept { return std::make_tuple(storage<Tags>().data()...); }
+    
+    template<typename... Tags>
+    auto pointers() const noexcept { return std::make_tuple(storage<Tags>().data()...); }
+    
+public:
+    soa_vector() = default;
+    
+    explicit soa_vector(size_t count) { resize(count); }
+    
+    // Size and capacity
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    size_t capacity() const noexcept { return std::get<0>(columns_).capacity(); }
+    
+    void reserve(size_t count) {
+        (storage<Fields>().reserve(count), ...);
+    }
+    
+    void resize(size_t count) {
+        (storage<Fields>().resize(count), ...);
+        size_ = count;
+    }
+    
+    void clear() noexcept {
+        (storage<Fields>().clear(), ...);
+        size_ = 0;
+    }
+    
+    void shrink_to_fit() {
+        (storage<Fields>().shrink_to_fit(), ...);
+    }
+    
+    // Modifiers: one argument per field, in field order
+    template<typename... Args>
+    void emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+        // Grow all arrays together so they reallocate on the same push
+        if (size_ == capacity()) {
+            reserve(size_ ? size_ * 2 : 8);
+        }
+        (storage<Fields>().emplace_back(std::forward<Args>(args)), ...);
+        ++size_;
+    }
+    
+    void push_back(const typename Fields::type&... values) { emplace_back(values...); }
+    void push_back(const value_type& value) { emplace_back(value.template get<Fields>()...); }
+    void push_back(value_type&& value) { emplace_back(std::move(value.template get<Fields>())...); }
+    
+    void pop_back() {
+        (storage<Fields>().pop_back(), ...);
+        --size_;
+    }
+    
+    iterator erase(const_iterator position) {
+        auto offset = position - cbegin();
+        (storage<Fields>().erase(storage<Fields>().begin() + offset), ...);
+        --size_;
+        return begin() + offset;
+    }
+    
+    // Element access
+    reference operator[](size_t i) { return begin()[static_cast<difference_type>(i)]; }
+    const_reference operator[](size_t i) const { return begin()[static_cast<difference_type>(i)]; }
+    
+    reference at(size_t i) {
+        if (i >= size_) throw std::out_of_range("soa_vector index out of range");
+        return (*this)[i];
+    }
+    
+    const_reference at(size_t i) const {
+        if (i >= size_) throw std::out_of_range("soa_vector index out of range");
+        return (*this)[i];
+    }
+    
+    reference front() { return (*this)[0]; }
+    const_reference front() const { return (*this)[0]; }
+    reference back() { return (*this)[size_ - 1]; }
+    const_reference back() const { return (*this)[size_ - 1]; }
+    
+    // Iterators
+    iterator begin() { return iterator(pointers<Fields...>(), 0); }
+    iterator end() { return iterator(pointers<Fields...>(), static_cast<difference_type>(size_)); }
+    const_iterator begin() const { return const_iterator(pointers<Fields...>(), 0); }
+    const_iterator end() const { return const_iterator(pointers<Fields...>(), static_cast<difference_type>(size_)); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+    
+    // Field access
+    template<typename Tag>
+    soa_column<typename Tag::type> column() {
+        auto& values = storage<Tag>();
+        return {values.data(), values.data() + size_};
+    }
+    
+    template<typename Tag>
+    soa_column<const typename Tag::type> column() const {
+        const auto& values = storage<Tag>();
+        return {values.data(), values.data() + size_};
+    }
+    
+    template<typename... Tags>
+    soa_view<false, Tags...> view() { return {pointers<Tags...>(), size_}; }
+    
+    template<typename... Tags>
+    soa_view<true, Tags...> view() const { return {pointers<Tags...>(), size_}; }
+};
@@ -0,0 +1,164 @@
+/*
+ * Compile-time Math Utilities
+ *
+ * Header-only constexpr versions of the integer-valued Calculator
+ * operations. Called with constant arguments they fold to constants;
+ * called at run time they inline at the call site, so a fixed exponent
+ * like power<3>(x) compiles down to two multiplies. The MathUtils
+ * library's Calculator methods forward to these, so both give identical
+ * results.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace MathUtils {
+namespace CompileTime {
+
+/**
+ * @brief base^N for a fixed integer exponent, by repeated squaring
+ */
+template <int N>
+constexpr double power(double base) {
+    if constexpr (N < 0) {
+        return 1.0 / power<-N>(base);
+    } else if constexpr (N == 0) {
+        return 1.0;
+    } else if constexpr (N == 1) {
+        return base;
+    } else {
+        double half = power<N / 2>(base);
+        if constexpr (N % 2 == 0) {
+            return half * half;
+        } else {
+            return half * half * base;
+        }
+    }
+}
+
+// base^exponent for an exponent known only at run time
+constexpr double power(double base, int exponent) {
+    bool negative = exponent < 0;
+    unsigned remaining = negative ? 0u - static_cast<unsigned>(exponent) : static_cast<unsigned>(exponent);
+    double result = 1.0;
+    while (remaining > 0) {
+        if (remaining & 1u) result *= base;
+        base *= base;
+        remaining >>= 1;
+    }
+    return negative ? 1.0 / result : result;
+}
+
+// n! for n <= 20, every value that fits in 64 bits
+inline constexpr std::array<uint64_t, 21> factorial_table = [] {
+    std::array<uint64_t, 21> table{};
+    table[0] = 1;
+    for (size_t i = 1; i < table.size(); ++i) {
+        table[i] = table[i - 1] * i;
+    }
+    return table;
+}();
+
+// n! as a double, matching Calculator::factorial (inf above 170)
+constexpr double factorial(int n) {
+    if (n < 0) {
+        throw std::invalid_argument("Factorial of negative number");
+    }
+    if (n < static_cast<int>(factorial_table.size())) {
+        return static_cast<double>(factorial_table[n]);
+    }
+    double result = static_cast<double>(factorial_table.back());
+    for (int i = static_cast<int>(factorial_table.size()); i <= n; ++i) {
+        result *= i;
+    }
+    return result;
+}
+
+constexpr int abs(int n) {
+    return n < 0 ? -n : n;
+}
+
+constexpr int gcd(int a, int b) {
+    a = abs(a);
+    b = abs(b);
+    while (b != 0) {
+        int temp = b;
+        b = a % b;
+        a = temp;
+    }
+    return a;
+}
+
+// Divides before multiplying, so lcm does not overflow when a * b would
+constexpr int lcm(int a, int b) {
+    if (a == 0 || b == 0) return 0;
+    return abs(a / gcd(a, b) * b);
+}
+
+/**
+ * @brief Primality of 0..N-1, sieved at compile time
+ */
+template <size_t N>
+constexpr std::array<bool, N> prime_table() {
+    std::array<bool, N> prime{};
+    for (size_t i = 2; i < N; ++i) {
+        prime[i] = true;
+    }
+    for (size_t p = 2; p * p < N; ++p) {
+        if (prime[p]) {
+            for (size_t m = p * p; m < N; m += p) {
+                prime[m] = false;
+            }
+        }
+    }
+    return prime;
+}
+
+inline constexpr auto small_primes = prime_table<1024>();
+
+// Table lookup for small n, 6k +/- 1 trial division above
+constexpr bool is_prime(uint64_t n) {
+    if (n < small_primes.size()) return small_primes[n];
+    if (n % 2 == 0 || n % 3 == 0) return false;
+    for (uint64_t i = 5; i <= n / i; i += 6) {
+        if (n % i == 0 || n % (i + 2) == 0) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Calculator operations usable in constant expressions
+ *
+ * A literal-type counterpart of MathUtils::Calculator for the operations
+ * that can be constexpr (std::pow and std::sqrt are not in C++17).
+ * MathUtils::Calculator itself stays a library class so its ABI does not
+ * change.
+ */
+class Calculator {
+public:
+    constexpr double add(double a, double b) const { return a + b; }
+    constexpr double subtract(double a, double b) const { return a - b; }
+    constexpr double multiply(double a, double b) const { return a * b; }
+    constexpr double divide(double a, double b) const {
+        if ((b < 0 ? -b : b) < 1e-10) {
+            throw std::invalid_argument("Division by zero");
+        }
+        return a / b;
+    }
+    
+    template <int N>
+    constexpr double power(double base) const { return CompileTime::power<N>(base); }
+    constexpr double power(double base, int exponent) const { return CompileTime::power(base, exponent); }
+    constexpr double factorial(int n) const { return CompileTime::factorial(n); }
+    
+    constexpr bool is_prime(int n) const { return n > 1 && CompileTime::is_prime(static_cast<uint64_t>(n)); }
+    constexpr int gcd(int a, int b) const { return CompileTime::gcd(a, b); }
+    constexpr int lcm(int a, int b) const { return CompileTime::lcm(a, b); }
+};
+
+} // namespace CompileTime
+} // namespace MathUtils
@@ -9,9 +9,17 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include "math_constexpr.hpp"
 
 namespace MathUtils {
 
+// M_PI is a POSIX extension and is not declared in strict ISO C++ mode
+constexpr double PI = 3.14159265358979323846;
+
 /**
  * @brief Basic arithmetic operations
  */
@@ -55,6 +63,35 @@ namespace Statistics {
     double median(const std::vector<double>& values);
     double percentile(const std::vector<double>& values, double p);
     
+    // Several percentiles (each in [0, 100], any order) from one copy of
+    // the data, selecting the ranks in ascending order so each selection
+    // only partitions what is left of the previous one
+    std::vector<double> percentiles(const std::vector<double>& values, const std::vector<double>& ps);
+    
+    // Streaming count, mean, variance, min and max (Welford's method).
+    // Accumulators filled on different threads can be combined with merge()
+    class RunningStats {
+    public:
+        void add(double value);
+        void add(const std::vector<double>& values);
+        void merge(const RunningStats& other);
+        
+        size_t count() const { return count_; }
+        // All zero while empty; variance is the population variance
+        double mean() const { return mean_; }
+        double variance() const { return count_ > 0 ? m2_ / count_ : 0.0; }
+        double standard_deviation() const;
+        double min() const { return count_ > 0 ? min_ : 0.0; }
+        double max() const { return count_ > 0 ? max_ : 0.0; }
+        
+    private:
+        size_t count_ = 0;
+        double mean_ = 0.0;
+        double m2_ = 0.0;  // sum of squared deviations from the mean
+        double min_ = 0.0;
+        double max_ = 0.0;
+    };
+    
     struct DescriptiveStats {
         double mean;
         double median;
@@ -66,6 +103,8 @@ namespace Statistics {
         std::string to_string() const;
     };
     
+    // One pass for mean, deviation and extremes plus one selection for
+    // the median
     DescriptiveStats describe(const std::vector<double>& values);
 }
 
@@ -105,14 +144,108 @@ namespace Geometry {
         bool contains(const Point2D& point) const;
         std::string to_string() const;
     };
+    
+    // Points stored as separate x and y arrays, for batch kernels
+    struct PointSet {
+        std::vector<double> xs, ys;
+        
+        void add(const Point2D& point) { xs.push_back(point.x); ys.push_back(point.y); }
+        size_t size() const { return xs.size(); }
+        Point2D operator[](size_t i) const { return Point2D(xs[i], ys[i]); }
+    };
+    
+    // Batch containment: one byte per point, 1 if the shape contains it.
+    // Same boundary rules as contains(); the circle test compares squared
+    // distances, so it can differ from contains() by one rounding step
+    std::vector<uint8_t> contains(const Circle& circle, const PointSet& points);
+    std::vector<uint8_t> contains(const Rectangle& rect, const PointSet& points);
+    
+    /**
+     * @brief Uniform grid over shape bounding boxes
+     *
+     * Each shape is listed in every cell its bounding box overlaps, so a
+     * "which shapes contain this point" query tests only the shapes in the
+     * point's cell. Pick cell_size near the typical shape size: large
+     * shapes in a fine grid occupy many cells.
+     */
+    class ShapeIndex {
+    public:
+        explicit ShapeIndex(double cell_size);
+        
+        // Shape IDs are assigned in insertion order, from 0
+        size_t add(const Circle& circle);
+        size_t add(const Rectangle& rect);
+        size_t size() const { return shapes_.size(); }
+        
+        // IDs of the shapes containing point, ascending
+        std::vector<size_t> containing(const Point2D& point) const;
+        // (point index, shape ID) for every containment, by point
+        std::vector<std::pair<size_t, size_t>> containing(const PointSet& points) const;
+        
+    private:
+        struct Shape {
+            bool is_circle;
+            uint32_t index;  // into circles_ or rects_
+        };
+        
+        double cell_size_;
+        std::vector<Shape> shapes_;
+        std::vector<Circle> circles_;
+        std::vector<Rectangle> rects_;
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+        
+        void insert(uint32_t id, double min_x, double min_y, double max_x, double max_y);
+        bool shape_contains(uint32_t id, const Point2D& point) const;
+    };
+    
+    /**
+     * @brief Uniform grid over a fixed set of points for nearest-neighbour queries
+     *
+     * Points are stored grouped by cell. A k-nearest query scans rings of
+     * cells outward from the query's cell and stops once no unscanned cell
+     * can hold a closer point.
+     */
+    class PointIndex {
+    public:
+        PointIndex(const PointSet& points, double cell_size);
+        
+        size_t size() const { return ids_.size(); }
+        
+        // Indices (into the PointSet) of the k points nearest to query,
+        // nearest first; fewer if the set is smaller than k
+        std::vector<size_t> nearest(const Point2D& query, size_t k) const;
+        
+    private:
+        double cell_size_;
+        std::vector<double> xs_, ys_;  // grouped by cell
+        std::vector<size_t> ids_;      // original index of each stored point
+        std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> cells_;  // [begin, end) into xs_
+        int64_t min_cx_ = 0, min_cy_ = 0, max_cx_ = -1, max_cy_ = -1;
+    };
 }
 
 /**
  * @brief Number theory utilities
  */
 namespace NumberTheory {
+    // Numbers below sieve_limit are answered from a shared smallest-prime-factor
+    // table. The table is sieved lazily, one segment at a time, up to the
+    // largest number queried so far; it is safe to query from several threads.
+    constexpr uint32_t sieve_limit = 1u << 24;
+    
+    // Table lookup below sieve_limit, deterministic Miller-Rabin above
+    bool is_prime(uint64_t n);
+    
+    // Prime factors in ascending order with multiplicity; empty for n < 2
     std::vector<int> prime_factors(int n);
+    // All positive divisors in ascending order; empty for n < 1
     std::vector<int> divisors(int n);
+    
+    // Batch forms for many queries: grow the table once for the largest
+    // value, then answer every value from it
+    std::vector<bool> is_prime(const std::vector<int>& values);
+    std::vector<std::vector<int>> prime_factors_batch(const std::vector<int>& values);
+    
     bool is_perfect_number(int n);
     bool is_palindrome(int n);
     int reverse_digits(int n);
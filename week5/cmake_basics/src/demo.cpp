@@ -10,6 +10,8 @@
 #include <vector>
 #include <random>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
 
 using namespace MathUtils;
 
@@ -37,6 +39,18 @@ void demonstrate_calculator() {
     std::cout << "  Is 15 prime? " << (calc.is_prime(15) ? "Yes" : "No") << std::endl;
     std::cout << "  gcd(48, 18) = " << calc.gcd(48, 18) << std::endl;
     std::cout << "  lcm(12, 15) = " << calc.lcm(12, 15) << std::endl;
+    
+    // Compile-time layer: these are folded to constants by the compiler
+    constexpr CompileTime::Calculator fixed;
+    constexpr double ten_factorial = fixed.factorial(10);
+    constexpr int gcd_value = fixed.gcd(1071, 462);
+    constexpr bool prime_1021 = fixed.is_prime(1021);
+    std::cout << "\nCompile-time:" << std::endl;
+    std::cout << "  10! = " << std::setprecision(0) << ten_factorial << std::endl;
+    std::cout << "  gcd(1071, 462) = " << gcd_value << std::endl;
+    std::cout << "  Is 1021 prime? " << (prime_1021 ? "Yes" : "No") << std::endl;
+    // A fixed exponent compiles to two multiplies
+    std::cout << "  1.5^3 = " << std::setprecision(3) << CompileTime::power<3>(1.5) << std::endl;
 }
 
 void demonstrate_statistics() {
@@ -64,12 +78,23 @@ void demonstrate_statistics() {
     
     // Additional statistics
     std::cout << "\nPercentiles:" << std::endl;
-    std::cout << "  10th percentile: " << std::fixed << std::setprecision(2) 
-              << Statistics::percentile(data, 10) << std::endl;
-    std::cout << "  25th percentile: " << Statistics::percentile(data, 25) << std::endl;
-    std::cout << "  50th percentile: " << Statistics::percentile(data, 50) << std::endl;
-    std::cout << "  75th percentile: " << Statistics::percentile(data, 75) << std::endl;
-    std::cout << "  90th percentile: " << Statistics::percentile(data, 90) << std::endl;
+    std::vector<double> ps = {10, 25, 50, 75, 90};
+    auto quantiles = Statistics::percentiles(data, ps);
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < ps.size(); ++i) {
+        std::cout << "  " << static_cast<int>(ps[i]) << "th percentile: " << quantiles[i] << std::endl;
+    }
+    
+    // Streaming: accumulate two halves separately (as two threads would),
+    // then merge
+    Statistics::RunningStats first_half, second_half;
+    first_half.add(std::vector<double>(data.begin(), data.begin() + 50));
+    for (size_t i = 50; i < data.size(); ++i) {
+        second_half.add(data[i]);
+    }
+    first_half.merge(second_half);
+    std::cout << "\nRunningStats (two halves merged): count=" << first_half.count()
+              << ", mean=" << first_half.mean() << ", std_dev=" << first_half.standard_deviation() << std::endl;
     
     // Show first few values
     std::cout << "\nFirst 10 values: ";
@@ -117,6 +142,41 @@ void demonstrate_geometry() {
     std::cout << "  Contains P1? " << (rect.contains(p1) ? "Yes" : "No") << std::endl;
     std::cout << "  Contains P2? " << (rect.contains(p2) ? "Yes" : "No") << std::endl;
     std::cout << "  Contains P3? " << (rect.contains(p3) ? "Yes" : "No") << std::endl;
+    
+    // Many points against many shapes
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    std::uniform_real_distribution<double> size(1.0, 10.0);
+    Geometry::PointSet points;
+    for (int i = 0; i < 200000; ++i) {
+        points.add(Geometry::Point2D(coord(gen), coord(gen)));
+    }
+    Geometry::ShapeIndex fences(10.0);
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 2 == 0) {
+            fences.add(Geometry::Circle(Geometry::Point2D(coord(gen), coord(gen)), size(gen)));
+        } else {
+            fences.add(Geometry::Rectangle(Geometry::Point2D(coord(gen), coord(gen)), size(gen), size(gen)));
+        }
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    auto matches = fences.containing(points);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\nShapeIndex: " << points.size() << " points x " << fences.size() << " shapes -> "
+              << matches.size() << " containments (" << std::setprecision(1) << elapsed_ms << " ms)" << std::endl;
+    
+    auto inside = Geometry::contains(circle, points);
+    std::cout << "  Points inside " << circle.to_string() << ": "
+              << std::count(inside.begin(), inside.end(), 1) << std::endl;
+    
+    Geometry::PointIndex nearby(points, 10.0);
+    Geometry::Point2D query(500, 500);
+    std::cout << "  3 nearest to " << query.to_string() << ":";
+    for (size_t id : nearby.nearest(query, 3)) {
+        std::cout << " " << points[id].to_string();
+    }
+    std::cout << std::endl;
 }
 
 void demonstrate_number_theory() {
@@ -172,6 +232,27 @@ void demonstrate_number_theory() {
         std::cout << perfect_numbers[i];
     }
     std::cout << std::endl;
+    
+    // Batch queries share one sieve table
+    std::cout << "\nBatch queries over 1..1000000:" << std::endl;
+    std::vector<int> range(1000000);
+    for (size_t i = 0; i < range.size(); ++i) {
+        range[i] = static_cast<int>(i + 1);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto primes = NumberTheory::is_prime(range);
+    auto factorizations = NumberTheory::prime_factors_batch(range);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t prime_count = std::count(primes.begin(), primes.end(), true);
+    size_t factor_count = 0;
+    for (const auto& factors : factorizations) {
+        factor_count += factors.size();
+    }
+    std::cout << "  " << prime_count << " primes, " << factor_count << " prime factors in total ("
+              << std::fixed << std::setprecision(1) << elapsed_ms << " ms)" << std::endl;
+    
+    uint64_t mersenne = (1ULL << 61) - 1;
+    std::cout << "  Is 2^61 - 1 prime? " << (NumberTheory::is_prime(mersenne) ? "Yes" : "No") << std::endl;
 }
 
 void demonstrate_version_info() {
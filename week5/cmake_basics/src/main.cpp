@@ -235,7 +235,14 @@ void number_theory() {
     std::cout << std::endl;
 }
 
-void run_tests() {
+// Checked by the compiler: the constexpr layer folds at compile time
+static_assert(CompileTime::factorial(10) == 3628800.0, "constexpr factorial");
+static_assert(CompileTime::power<10>(2.0) == 1024.0, "constexpr power");
+static_assert(CompileTime::gcd(48, 18) == 6 && CompileTime::lcm(12, 15) == 60, "constexpr gcd/lcm");
+static_assert(CompileTime::Calculator().is_prime(1021) && !CompileTime::Calculator().is_prime(1023),
+              "constexpr is_prime");
+
+bool run_tests() {
     std::cout << "\n--- Running Tests ---" << std::endl;
     
     Calculator calc;
@@ -259,11 +266,18 @@ void run_tests() {
         std::cout << "  FAIL: Mean calculation" << std::endl;
         all_passed = false;
     }
+    auto stats = Statistics::describe({5, 1, 4, 2, 3, 6});
+    auto quartiles = Statistics::percentiles({5, 1, 4, 2, 3}, {75, 25, 50});
+    if (stats.median != 3.5 || stats.min_val != 1 || stats.max_val != 6 ||
+        quartiles != std::vector<double>{4, 2, 3}) {
+        std::cout << "  FAIL: Median/percentile calculation" << std::endl;
+        all_passed = false;
+    }
     
     // Test geometry
     std::cout << "Testing geometry..." << std::endl;
     Geometry::Circle circle({0, 0}, 5);
-    if (std::abs(circle.area() - (M_PI * 25)) > 1e-6) {
+    if (std::abs(circle.area() - (PI * 25)) > 1e-6) {
         std::cout << "  FAIL: Circle area calculation" << std::endl;
         all_passed = false;
     }
@@ -274,19 +288,29 @@ void run_tests() {
         std::cout << "  FAIL: Prime number test" << std::endl;
         all_passed = false;
     }
+    if (NumberTheory::prime_factors(360) != std::vector<int>{2, 2, 2, 3, 3, 5} ||
+        NumberTheory::divisors(28) != std::vector<int>{1, 2, 4, 7, 14, 28}) {
+        std::cout << "  FAIL: Factorization test" << std::endl;
+        all_passed = false;
+    }
+    // 2^61 - 1 is a Mersenne prime; 2^61 + 1 is divisible by 3
+    if (!NumberTheory::is_prime(2305843009213693951ULL) || NumberTheory::is_prime(2305843009213693953ULL)) {
+        std::cout << "  FAIL: 64-bit primality test" << std::endl;
+        all_passed = false;
+    }
     
     if (all_passed) {
         std::cout << "All tests PASSED!" << std::endl;
     } else {
         std::cout << "Some tests FAILED!" << std::endl;
     }
+    return all_passed;
 }
 
 int main(int argc, char* argv[]) {
     // Check for test mode
     if (argc > 1 && std::string(argv[1]) == "--test") {
-        run_tests();
-        return 0;
+        return run_tests() ? 0 : 1;
     }
     
     print_banner();
@@ -12,6 +12,10 @@
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace MathUtils {
 
@@ -29,6 +33,103 @@ const char* COMPILER_INFO =
     "Unknown compiler";
 #endif
 
+namespace {
+    // Reductions over contiguous doubles keep one accumulator per lane.
+    // A single running total is a serial chain of dependent additions that
+    // the compiler may not reorder (that would change rounding); with
+    // independent lanes it can hold them in one SIMD register instead.
+    constexpr size_t lanes = 4;
+    
+    double lane_sum(const double* data, size_t n) {
+        double acc[lanes] = {};
+        size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            for (size_t j = 0; j < lanes; ++j) {
+                acc[j] += data[i + j];
+            }
+        }
+        double total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+        for (; i < n; ++i) {
+            total += data[i];
+        }
+        return total;
+    }
+    
+    // Sum of squared deviations from center
+    double lane_sum_sq_dev(const double* data, size_t n, double center) {
+        double acc[lanes] = {};
+        size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            for (size_t j = 0; j < lanes; ++j) {
+                double diff = data[i + j] - center;
+                acc[j] += diff * diff;
+            }
+        }
+        double total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+        for (; i < n; ++i) {
+            double diff = data[i] - center;
+            total += diff * diff;
+        }
+        return total;
+    }
+    
+    // Mean, sum of squared deviations, min and max in one pass over n > 0
+    // values. Sums are taken of (x - data[0]), which keeps the one-pass
+    // formula for squared deviations from cancelling when the values sit
+    // far from zero
+    struct Moments {
+        double mean;
+        double m2;
+        double min;
+        double max;
+    };
+    
+    Moments fused_moments(const double* data, size_t n) {
+        double shift = data[0];
+        double sum[lanes] = {}, sum_sq[lanes] = {};
+        double lo[lanes], hi[lanes];
+        for (size_t j = 0; j < lanes; ++j) {
+            lo[j] = hi[j] = shift;
+        }
+        size_t i = 0;
+        for (; i + lanes <= n; i += lanes) {
+            for (size_t j = 0; j < lanes; ++j) {
+                double x = data[i + j];
+                double d = x - shift;
+                sum[j] += d;
+                sum_sq[j] += d * d;
+                lo[j] = x < lo[j] ? x : lo[j];
+                hi[j] = x > hi[j] ? x : hi[j];
+            }
+        }
+        double total = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+        double total_sq = (sum_sq[0] + sum_sq[1]) + (sum_sq[2] + sum_sq[3]);
+        double min_val = std::min(std::min(lo[0], lo[1]), std::min(lo[2], lo[3]));
+        double max_val = std::max(std::max(hi[0], hi[1]), std::max(hi[2], hi[3]));
+        for (; i < n; ++i) {
+            double d = data[i] - shift;
+            total += d;
+            total_sq += d * d;
+            min_val = std::min(min_val, data[i]);
+            max_val = std::max(max_val, data[i]);
+        }
+        double m2 = std::max(0.0, total_sq - total * total / n);
+        return {shift + total / n, m2, min_val, max_val};
+    }
+    
+    // Median of a scratch copy, by selection rather than a full sort
+    double select_median(std::vector<double>& scratch) {
+        size_t n = scratch.size();
+        auto mid = scratch.begin() + n / 2;
+        std::nth_element(scratch.begin(), mid, scratch.end());
+        if (n % 2 == 1) {
+            return *mid;
+        }
+        // Everything left of mid is <= *mid; the lower middle is their max
+        return (*std::max_element(scratch.begin(), mid) + *mid) / 2.0;
+    }
+}
+
 // Calculator implementation
 double Calculator::add(double a, double b) const {
     return a + b;
@@ -61,20 +162,11 @@ double Calculator::sqrt(double value) const {
 }
 
 double Calculator::factorial(int n) const {
-    if (n < 0) {
-        throw std::invalid_argument("Factorial of negative number");
-    }
-    if (n == 0 || n == 1) return 1.0;
-    
-    double result = 1.0;
-    for (int i = 2; i <= n; ++i) {
-        result *= i;
-    }
-    return result;
+    return CompileTime::factorial(n);
 }
 
 double Calculator::sum(const std::vector<double>& values) const {
-    return std::accumulate(values.begin(), values.end(), 0.0);
+    return lane_sum(values.data(), values.size());
 }
 
 double Calculator::mean(const std::vector<double>& values) const {
@@ -90,14 +182,7 @@ double Calculator::variance(const std::vector<double>& values) const {
     }
     
     double m = mean(values);
-    double sum_sq_diff = 0.0;
-    
-    for (double value : values) {
-        double diff = value - m;
-        sum_sq_diff += diff * diff;
-    }
-    
-    return sum_sq_diff / values.size();
+    return lane_sum_sq_dev(values.data(), values.size(), m) / values.size();
 }
 
 double Calculator::standard_deviation(const std::vector<double>& values) const {
@@ -105,33 +190,15 @@ double Calculator::standard_deviation(const std::vector<double>& values) const {
 }
 
 bool Calculator::is_prime(int n) const {
-    if (n <= 1) return false;
-    if (n <= 3) return true;
-    if (n % 2 == 0 || n % 3 == 0) return false;
-    
-    for (int i = 5; i * i <= n; i += 6) {
-        if (n % i == 0 || n % (i + 2) == 0) {
-            return false;
-        }
-    }
-    return true;
+    return n > 1 && NumberTheory::is_prime(static_cast<uint64_t>(n));
 }
 
 int Calculator::gcd(int a, int b) const {
-    a = std::abs(a);
-    b = std::abs(b);
-    
-    while (b != 0) {
-        int temp = b;
-        b = a % b;
-        a = temp;
-    }
-    return a;
+    return CompileTime::gcd(a, b);
 }
 
 int Calculator::lcm(int a, int b) const {
-    if (a == 0 || b == 0) return 0;
-    return std::abs(a * b) / gcd(a, b);
+    return CompileTime::lcm(a, b);
 }
 
 std::string Calculator::to_string() const {
@@ -159,38 +226,103 @@ namespace Statistics {
             throw std::invalid_argument("Cannot find median of empty vector");
         }
         
-        std::vector<double> sorted_values = values;
-        std::sort(sorted_values.begin(), sorted_values.end());
-        
-        size_t n = sorted_values.size();
-        if (n % 2 == 0) {
-            return (sorted_values[n/2 - 1] + sorted_values[n/2]) / 2.0;
-        } else {
-            return sorted_values[n/2];
-        }
+        std::vector<double> scratch = values;
+        return select_median(scratch);
     }
     
     double percentile(const std::vector<double>& values, double p) {
+        return percentiles(values, {p})[0];
+    }
+    
+    std::vector<double> percentiles(const std::vector<double>& values, const std::vector<double>& ps) {
         if (values.empty()) {
             throw std::invalid_argument("Cannot find percentile of empty vector");
         }
-        if (p < 0.0 || p > 100.0) {
-            throw std::invalid_argument("Percentile must be between 0 and 100");
+        for (double p : ps) {
+            if (!(p >= 0.0 && p <= 100.0)) {
+                throw std::invalid_argument("Percentile must be between 0 and 100");
+            }
         }
         
-        std::vector<double> sorted_values = values;
-        std::sort(sorted_values.begin(), sorted_values.end());
+        std::vector<size_t> order(ps.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ps[a] < ps[b]; });
         
-        double index = (p / 100.0) * (sorted_values.size() - 1);
-        size_t lower = static_cast<size_t>(std::floor(index));
-        size_t upper = static_cast<size_t>(std::ceil(index));
+        // After selecting rank k, everything right of k is >= it, so the
+        // next (higher) rank only needs to be selected from (k, end)
+        std::vector<double> scratch = values;
+        size_t unselected = 0;
+        auto select = [&](size_t rank) {
+            if (rank >= unselected) {
+                std::nth_element(scratch.begin() + unselected, scratch.begin() + rank, scratch.end());
+                unselected = rank + 1;
+            }
+            return scratch[rank];
+        };
         
-        if (lower == upper) {
-            return sorted_values[lower];
+        std::vector<double> result(ps.size());
+        for (size_t i : order) {
+            double index = (ps[i] / 100.0) * (scratch.size() - 1);
+            size_t lower = static_cast<size_t>(std::floor(index));
+            size_t upper = static_cast<size_t>(std::ceil(index));
+            double lower_value = select(lower);
+            if (lower == upper) {
+                result[i] = lower_value;
+            } else {
+                double weight = index - lower;
+                result[i] = lower_value * (1 - weight) + select(upper) * weight;
+            }
+        }
+        return result;
+    }
+    
+    void RunningStats::add(double value) {
+        if (count_ == 0) {
+            min_ = max_ = value;
         } else {
-            double weight = index - lower;
-            return sorted_values[lower] * (1 - weight) + sorted_values[upper] * weight;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+        ++count_;
+        double delta = value - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (value - mean_);
+    }
+    
+    void RunningStats::add(const std::vector<double>& values) {
+        if (values.empty()) {
+            return;
+        }
+        Moments block = fused_moments(values.data(), values.size());
+        RunningStats other;
+        other.count_ = values.size();
+        other.mean_ = block.mean;
+        other.m2_ = block.m2;
+        other.min_ = block.min;
+        other.max_ = block.max;
+        merge(other);
+    }
+    
+    // Chan et al.'s pairwise combination of two partial results
+    void RunningStats::merge(const RunningStats& other) {
+        if (other.count_ == 0) {
+            return;
+        }
+        if (count_ == 0) {
+            *this = other;
+            return;
         }
+        double total = static_cast<double>(count_ + other.count_);
+        double delta = other.mean_ - mean_;
+        mean_ += delta * other.count_ / total;
+        m2_ += other.m2_ + delta * delta * (static_cast<double>(count_) * other.count_ / total);
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    
+    double RunningStats::standard_deviation() const {
+        return std::sqrt(variance());
     }
     
     std::string DescriptiveStats::to_string() const {
@@ -210,15 +342,16 @@ namespace Statistics {
             return {0.0, 0.0, 0.0, 0.0, 0.0, 0};
         }
         
-        Calculator calc;
-        DescriptiveStats stats;
+        Moments moments = fused_moments(values.data(), values.size());
+        std::vector<double> scratch = values;
         
+        DescriptiveStats stats;
         stats.count = values.size();
-        stats.mean = calc.mean(values);
-        stats.median = median(values);
-        stats.std_dev = calc.standard_deviation(values);
-        stats.min_val = min(values);
-        stats.max_val = max(values);
+        stats.mean = moments.mean;
+        stats.median = select_median(scratch);
+        stats.std_dev = std::sqrt(moments.m2 / values.size());
+        stats.min_val = moments.min;
+        stats.max_val = moments.max;
         
         return stats;
     }
@@ -240,11 +373,11 @@ namespace Geometry {
     }
     
     double Circle::area() const {
-        return M_PI * radius * radius;
+        return PI * radius * radius;
     }
     
     double Circle::circumference() const {
-        return 2 * M_PI * radius;
+        return 2 * PI * radius;
     }
     
     bool Circle::contains(const Point2D& point) const {
@@ -280,43 +413,433 @@ namespace Geometry {
             << ", width=" << width << ", height=" << height << "}";
         return oss.str();
     }
+    
+    std::vector<uint8_t> contains(const Circle& circle, const PointSet& points) {
+        size_t n = points.size();
+        std::vector<uint8_t> inside(n);
+        const double* xs = points.xs.data();
+        const double* ys = points.ys.data();
+        uint8_t* out = inside.data();
+        double cx = circle.center.x, cy = circle.center.y;
+        double r2 = circle.radius * circle.radius;
+        // Branch-free over separate x and y arrays, so it vectorizes
+        for (size_t i = 0; i < n; ++i) {
+            double dx = xs[i] - cx;
+            double dy = ys[i] - cy;
+            out[i] = dx * dx + dy * dy <= r2;
+        }
+        return inside;
+    }
+    
+    std::vector<uint8_t> contains(const Rectangle& rect, const PointSet& points) {
+        size_t n = points.size();
+        std::vector<uint8_t> inside(n);
+        const double* xs = points.xs.data();
+        const double* ys = points.ys.data();
+        uint8_t* out = inside.data();
+        double x0 = rect.top_left.x, x1 = rect.top_left.x + rect.width;
+        double y0 = rect.top_left.y, y1 = rect.top_left.y + rect.height;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = (xs[i] >= x0) & (xs[i] <= x1) & (ys[i] >= y0) & (ys[i] <= y1);
+        }
+        return inside;
+    }
+    
+    namespace {
+        int64_t cell_of(double coordinate, double cell_size) {
+            // Clamped so that far-away coordinates still pack into a key
+            double cell = std::floor(coordinate / cell_size);
+            return static_cast<int64_t>(std::max(-2147483648.0, std::min(2147483647.0, cell)));
+        }
+        
+        uint64_t cell_key(int64_t cx, int64_t cy) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+        }
+    }
+    
+    ShapeIndex::ShapeIndex(double cell_size) : cell_size_(cell_size) {
+        if (!(cell_size > 0)) {
+            throw std::invalid_argument("Cell size must be positive");
+        }
+    }
+    
+    size_t ShapeIndex::add(const Circle& circle) {
+        uint32_t id = static_cast<uint32_t>(shapes_.size());
+        shapes_.push_back({true, static_cast<uint32_t>(circles_.size())});
+        circles_.push_back(circle);
+        insert(id, circle.center.x - circle.radius, circle.center.y - circle.radius,
+               circle.center.x + circle.radius, circle.center.y + circle.radius);
+        return id;
+    }
+    
+    size_t ShapeIndex::add(const Rectangle& rect) {
+        uint32_t id = static_cast<uint32_t>(shapes_.size());
+        shapes_.push_back({false, static_cast<uint32_t>(rects_.size())});
+        rects_.push_back(rect);
+        insert(id, rect.top_left.x, rect.top_left.y, rect.top_left.x + rect.width, rect.top_left.y + rect.height);
+        return id;
+    }
+    
+    void ShapeIndex::insert(uint32_t id, double min_x, double min_y, double max_x, double max_y) {
+        for (int64_t cx = cell_of(min_x, cell_size_); cx <= cell_of(max_x, cell_size_); ++cx) {
+            for (int64_t cy = cell_of(min_y, cell_size_); cy <= cell_of(max_y, cell_size_); ++cy) {
+                cells_[cell_key(cx, cy)].push_back(id);
+            }
+        }
+    }
+    
+    bool ShapeIndex::shape_contains(uint32_t id, const Point2D& point) const {
+        const Shape& shape = shapes_[id];
+        return shape.is_circle ? circles_[shape.index].contains(point) : rects_[shape.index].contains(point);
+    }
+    
+    std::vector<size_t> ShapeIndex::containing(const Point2D& point) const {
+        std::vector<size_t> ids;
+        auto cell = cells_.find(cell_key(cell_of(point.x, cell_size_), cell_of(point.y, cell_size_)));
+        if (cell == cells_.end()) {
+            return ids;
+        }
+        // Cell lists are in insertion order, so matches come out ascending
+        for (uint32_t id : cell->second) {
+            if (shape_contains(id, point)) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+    
+    std::vector<std::pair<size_t, size_t>> ShapeIndex::containing(const PointSet& points) const {
+        std::vector<std::pair<size_t, size_t>> matches;
+        for (size_t i = 0; i < points.size(); ++i) {
+            Point2D point = points[i];
+            auto cell = cells_.find(cell_key(cell_of(point.x, cell_size_), cell_of(point.y, cell_size_)));
+            if (cell == cells_.end()) {
+                continue;
+            }
+            for (uint32_t id : cell->second) {
+                if (shape_contains(id, point)) {
+                    matches.emplace_back(i, id);
+                }
+            }
+        }
+        return matches;
+    }
+    
+    PointIndex::PointIndex(const PointSet& points, double cell_size) : cell_size_(cell_size) {
+        if (!(cell_size > 0)) {
+            throw std::invalid_argument("Cell size must be positive");
+        }
+        
+        // Sort point indices by cell, then lay the points out in that order
+        size_t n = points.size();
+        std::vector<std::pair<uint64_t, size_t>> keyed(n);
+        for (size_t i = 0; i < n; ++i) {
+            int64_t cx = cell_of(points.xs[i], cell_size_);
+            int64_t cy = cell_of(points.ys[i], cell_size_);
+            keyed[i] = {cell_key(cx, cy), i};
+            min_cx_ = i == 0 ? cx : std::min(min_cx_, cx);
+            max_cx_ = i == 0 ? cx : std::max(max_cx_, cx);
+            min_cy_ = i == 0 ? cy : std::min(min_cy_, cy);
+            max_cy_ = i == 0 ? cy : std::max(max_cy_, cy);
+        }
+        std::sort(keyed.begin(), keyed.end());
+        
+        xs_.reserve(n);
+        ys_.reserve(n);
+        ids_.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t id = keyed[i].second;
+            xs_.push_back(points.xs[id]);
+            ys_.push_back(points.ys[id]);
+            ids_.push_back(id);
+            if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+                cells_[keyed[i].first] = {static_cast<uint32_t>(i), static_cast<uint32_t>(i)};
+            }
+            ++cells_[keyed[i].first].second;
+        }
+    }
+    
+    std::vector<size_t> PointIndex::nearest(const Point2D& query, size_t k) const {
+        std::vector<size_t> result;
+        if (k == 0 || ids_.empty()) {
+            return result;
+        }
+        k = std::min(k, ids_.size());
+        
+        // Max-heap of (squared distance, stored position): the worst of the
+        // current k best is on top
+        std::vector<std::pair<double, uint32_t>> best;
+        best.reserve(k + 1);
+        auto scan_cell = [&](int64_t cx, int64_t cy) {
+            auto cell = cells_.find(cell_key(cx, cy));
+            if (cell == cells_.end()) {
+                return;
+            }
+            for (uint32_t i = cell->second.first; i < cell->second.second; ++i) {
+                double dx = xs_[i] - query.x;
+                double dy = ys_[i] - query.y;
+                double d2 = dx * dx + dy * dy;
+                if (best.size() < k) {
+                    best.emplace_back(d2, i);
+                    std::push_heap(best.begin(), best.end());
+                } else if (d2 < best.front().first) {
+                    std::pop_heap(best.begin(), best.end());
+                    best.back() = {d2, i};
+                    std::push_heap(best.begin(), best.end());
+                }
+            }
+        };
+        
+        int64_t qx = cell_of(query.x, cell_size_);
+        int64_t qy = cell_of(query.y, cell_size_);
+        // Rings before first_ring miss the occupied cells entirely, and
+        // there are none beyond last_ring
+        int64_t first_ring = std::max({min_cx_ - qx, qx - max_cx_, min_cy_ - qy, qy - max_cy_, int64_t(0)});
+        int64_t last_ring = std::max({qx - min_cx_, max_cx_ - qx, qy - min_cy_, max_cy_ - qy});
+        for (int64_t ring = first_ring; ring <= last_ring; ++ring) {
+            if (ring == 0) {
+                scan_cell(qx, qy);
+            } else {
+                // The ring's edges, clipped to the occupied cells
+                int64_t x_from = std::max(qx - ring, min_cx_), x_to = std::min(qx + ring, max_cx_);
+                int64_t y_from = std::max(qy - ring + 1, min_cy_), y_to = std::min(qy + ring - 1, max_cy_);
+                for (int64_t cx = x_from; cx <= x_to; ++cx) {
+                    if (qy - ring >= min_cy_) scan_cell(cx, qy - ring);
+                    if (qy + ring <= max_cy_) scan_cell(cx, qy + ring);
+                }
+                for (int64_t cy = y_from; cy <= y_to; ++cy) {
+                    if (qx - ring >= min_cx_) scan_cell(qx - ring, cy);
+                    if (qx + ring <= max_cx_) scan_cell(qx + ring, cy);
+                }
+            }
+            // Any point outside rings 0..ring is at least ring cells away
+            double reach = ring * cell_size_;
+            if (best.size() == k && best.front().first <= reach * reach) {
+                break;
+            }
+        }
+        
+        std::sort_heap(best.begin(), best.end());
+        for (const auto& entry : best) {
+            result.push_back(ids_[entry.second]);
+        }
+        return result;
+    }
 }
 
 // Number theory implementation
 namespace NumberTheory {
-    std::vector<int> prime_factors(int n) {
-        std::vector<int> factors;
+    namespace {
+        // Smallest-prime-factor table for odd numbers below sieve_limit.
+        //
+        // Even numbers are not stored (their smallest factor is 2), and since
+        // a composite n < 2^32 has a factor below 2^16, each entry fits in 16
+        // bits; 0 marks a prime. The table is built in fixed segments that
+        // never move once published, so lookups below covered() need no lock;
+        // growing it takes grow_mutex and publishes the new bound with release
+        // ordering.
+        class SieveTable {
+        public:
+            static SieveTable& instance() {
+                static SieveTable table;
+                return table;
+            }
+            
+            // Numbers below this bound can be looked up
+            uint32_t covered() const { return covered_.load(std::memory_order_acquire); }
+            
+            // Sieves up to and including n (n < sieve_limit)
+            void ensure(uint32_t n) {
+                if (n < covered()) return;
+                std::lock_guard<std::mutex> lock(grow_mutex_);
+                while (covered_.load(std::memory_order_relaxed) <= n) {
+                    add_segment();
+                }
+            }
+            
+            // Smallest prime factor of odd n < covered(), or 0 if n is prime
+            uint16_t smallest_factor(uint32_t n) const {
+                return segments_[n / segment_span][(n % segment_span) / 2];
+            }
+            
+            // Odd primes below 2^16: enough to trial-divide any 32-bit number
+            const std::vector<uint32_t>& base_primes() const { return base_primes_; }
+            
+        private:
+            static constexpr uint32_t segment_span = 1u << 17;  // numbers per segment
+            static constexpr uint32_t segment_count = sieve_limit / segment_span;
+            
+            std::array<std::unique_ptr<uint16_t[]>, segment_count> segments_;
+            std::atomic<uint32_t> covered_{0};
+            std::mutex grow_mutex_;
+            std::vector<uint32_t> base_primes_;
+            
+            SieveTable() {
+                std::lock_guard<std::mutex> lock(grow_mutex_);
+                add_segment();
+            }
+            
+            void add_segment() {
+                uint32_t low = covered_.load(std::memory_order_relaxed);
+                uint32_t high = low + segment_span;
+                auto segment = std::make_unique<uint16_t[]>(segment_span / 2);  // zeroed
+                
+                auto strike = [&](uint32_t p) {
+                    // Odd multiples of p from max(p*p, first one >= low)
+                    uint64_t start = std::max<uint64_t>(uint64_t(p) * p, (uint64_t(low) + p - 1) / p * p);
+                    if (start % 2 == 0) start += p;
+                    for (uint64_t m = start; m < high; m += 2 * p) {
+                        uint16_t& entry = segment[(m - low) / 2];
+                        if (entry == 0) entry = static_cast<uint16_t>(p);
+                    }
+                };
+                
+                if (low == 0) {
+                    // First segment: find its own sieving primes as it goes
+                    for (uint32_t p = 3; p * p < high; p += 2) {
+                        if (segment[p / 2] == 0) strike(p);
+                    }
+                    for (uint32_t n = 3; n < 1u << 16; n += 2) {
+                        if (segment[n / 2] == 0) base_primes_.push_back(n);
+                    }
+                } else {
+                    for (uint32_t p : base_primes_) {
+                        if (uint64_t(p) * p >= high) break;
+                        strike(p);
+                    }
+                }
+                
+                segments_[low / segment_span] = std::move(segment);
+                covered_.store(high, std::memory_order_release);
+            }
+        };
+        
+        uint64_t mul_mod(uint64_t a, uint64_t b, uint64_t m) {
+#ifdef __SIZEOF_INT128__
+            __extension__ typedef unsigned __int128 wide;
+            return static_cast<uint64_t>(static_cast<wide>(a) * b % m);
+#else
+            uint64_t result = 0;
+            a %= m;
+            while (b > 0) {
+                if (b & 1) result = (result >= m - a) ? result - (m - a) : result + a;
+                a = (a >= m - a) ? a - (m - a) : a + a;
+                b >>= 1;
+            }
+            return result;
+#endif
+        }
         
-        // Handle 2 separately
-        while (n % 2 == 0) {
-            factors.push_back(2);
-            n /= 2;
+        uint64_t pow_mod(uint64_t base, uint64_t exponent, uint64_t m) {
+            uint64_t result = 1;
+            base %= m;
+            while (exponent > 0) {
+                if (exponent & 1) result = mul_mod(result, base, m);
+                base = mul_mod(base, base, m);
+                exponent >>= 1;
+            }
+            return result;
         }
         
-        // Check odd factors
-        for (int i = 3; i * i <= n; i += 2) {
-            while (n % i == 0) {
-                factors.push_back(i);
-                n /= i;
+        // Deterministic for all 64-bit n: the first twelve primes are a
+        // sufficient witness set below 3.3 * 10^24. Expects odd n > 37
+        bool miller_rabin(uint64_t n) {
+            uint64_t d = n - 1;
+            int s = 0;
+            while (d % 2 == 0) {
+                d /= 2;
+                ++s;
+            }
+            for (uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+                uint64_t x = pow_mod(a, d, n);
+                if (x == 1 || x == n - 1) continue;
+                bool composite = true;
+                for (int r = 1; r < s && composite; ++r) {
+                    x = mul_mod(x, x, n);
+                    composite = x != n - 1;
+                }
+                if (composite) return false;
             }
+            return true;
         }
         
-        // If n is still greater than 2, it's a prime
-        if (n > 2) {
-            factors.push_back(n);
+        // Assumes table covers n
+        bool is_prime_in_table(const SieveTable& table, uint32_t n) {
+            if (n < 2) return false;
+            if (n % 2 == 0) return n == 2;
+            return table.smallest_factor(n) == 0;
         }
         
+        // Appends the factors of n >= 1, ascending. Uses the table once n is
+        // below covered, trial division by the base primes before that
+        void append_factors(const SieveTable& table, uint32_t n, uint32_t covered, std::vector<int>& factors) {
+            while (n % 2 == 0 && n > 1) {
+                factors.push_back(2);
+                n /= 2;
+            }
+            const auto& primes = table.base_primes();
+            for (size_t i = 0; n >= covered && i < primes.size() && primes[i] * primes[i] <= n; ++i) {
+                while (n % primes[i] == 0) {
+                    factors.push_back(static_cast<int>(primes[i]));
+                    n /= primes[i];
+                }
+            }
+            if (n >= covered) {
+                // No factor up to sqrt(n) left: n is prime
+                factors.push_back(static_cast<int>(n));
+                return;
+            }
+            while (n > 1) {
+                uint32_t p = table.smallest_factor(n);
+                if (p == 0) p = n;
+                factors.push_back(static_cast<int>(p));
+                n /= p;
+            }
+        }
+    }
+    
+    bool is_prime(uint64_t n) {
+        if (n < sieve_limit) {
+            SieveTable& table = SieveTable::instance();
+            table.ensure(static_cast<uint32_t>(n));
+            return is_prime_in_table(table, static_cast<uint32_t>(n));
+        }
+        if (n % 2 == 0) return false;
+        return miller_rabin(n);
+    }
+    
+    std::vector<int> prime_factors(int n) {
+        std::vector<int> factors;
+        if (n < 2) return factors;
+        
+        SieveTable& table = SieveTable::instance();
+        if (static_cast<uint32_t>(n) < sieve_limit) {
+            table.ensure(static_cast<uint32_t>(n));
+        }
+        append_factors(table, static_cast<uint32_t>(n), table.covered(), factors);
         return factors;
     }
     
     std::vector<int> divisors(int n) {
         std::vector<int> divs;
+        if (n < 1) return divs;
         
-        for (int i = 1; i * i <= n; ++i) {
-            if (n % i == 0) {
-                divs.push_back(i);
-                if (i != n / i) {
-                    divs.push_back(n / i);
+        // Every product of prime powers p^0..p^k, built one prime at a time
+        divs.push_back(1);
+        auto factors = prime_factors(n);
+        for (size_t i = 0; i < factors.size();) {
+            int p = factors[i];
+            size_t k = 0;
+            while (i < factors.size() && factors[i] == p) {
+                ++i;
+                ++k;
+            }
+            size_t existing = divs.size();
+            int power = 1;
+            for (size_t e = 0; e < k; ++e) {
+                power *= p;
+                for (size_t j = 0; j < existing; ++j) {
+                    divs.push_back(divs[j] * power);
                 }
             }
         }
@@ -325,6 +848,41 @@ namespace NumberTheory {
         return divs;
     }
     
+    std::vector<bool> is_prime(const std::vector<int>& values) {
+        std::vector<bool> result(values.size());
+        if (values.empty()) return result;
+        
+        SieveTable& table = SieveTable::instance();
+        int largest = *std::max_element(values.begin(), values.end());
+        table.ensure(static_cast<uint32_t>(std::min<int64_t>(std::max(largest, 0), sieve_limit - 1)));
+        uint32_t covered = table.covered();
+        for (size_t i = 0; i < values.size(); ++i) {
+            int n = values[i];
+            if (n >= 0 && static_cast<uint32_t>(n) < covered) {
+                result[i] = is_prime_in_table(table, static_cast<uint32_t>(n));
+            } else {
+                result[i] = n > 0 && is_prime(static_cast<uint64_t>(n));
+            }
+        }
+        return result;
+    }
+    
+    std::vector<std::vector<int>> prime_factors_batch(const std::vector<int>& values) {
+        std::vector<std::vector<int>> result(values.size());
+        if (values.empty()) return result;
+        
+        SieveTable& table = SieveTable::instance();
+        int largest = *std::max_element(values.begin(), values.end());
+        table.ensure(static_cast<uint32_t>(std::min<int64_t>(std::max(largest, 0), sieve_limit - 1)));
+        uint32_t covered = table.covered();
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (values[i] >= 2) {
+                append_factors(table, static_cast<uint32_t>(values[i]), covered, result[i]);
+            }
+        }
+        return result;
+    }
+    
     bool is_perfect_number(int n) {
         if (n <= 1) return false;
         